@@ -8,6 +8,13 @@
 #include "lighter/application/vulkan/aurora/editor/editor.h"
 #include "lighter/application/vulkan/aurora/viewer/viewer.h"
 #include "lighter/application/vulkan/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/strings/str_format.h"
+
+ABSL_FLAG(int, num_frames_in_flight, 2,
+          "Number of frames that can be processed concurrently");
+ABSL_FLAG(bool, frame_pacing, false,
+          "Delay the start of each frame to reduce input latency");
 
 namespace lighter {
 namespace application {
@@ -18,8 +25,6 @@ using namespace renderer::vulkan;
 
 enum class Scene { kNone, kEditor, kViewer };
 
-constexpr int kNumFramesInFlight = 2;
-
 class AuroraApp : public Application {
  public:
   explicit AuroraApp(const WindowContext::Config& config);
@@ -41,7 +46,6 @@ class AuroraApp : public Application {
   // Returns whether the scene has been transitioned after the last frame.
   bool HasTransitionedScene() const { return current_scene_ != last_scene_; }
 
-  int current_frame_ = 0;
   int frame_rate_ = 0;
   Scene last_scene_ = Scene::kNone;
   Scene current_scene_ = Scene::kEditor;
@@ -55,11 +59,13 @@ class AuroraApp : public Application {
 
 AuroraApp::AuroraApp(const WindowContext::Config& window_config)
     : Application{"Aurora Sketcher", window_config} {
-  command_ = std::make_unique<PerFrameCommand>(context(), kNumFramesInFlight);
+  const int num_frames_in_flight = absl::GetFlag(FLAGS_num_frames_in_flight);
+  command_ = std::make_unique<PerFrameCommand>(context(), num_frames_in_flight);
+  command_->set_frame_pacing_enabled(absl::GetFlag(FLAGS_frame_pacing));
   editor_ = std::make_unique<aurora::Editor>(mutable_window_context(),
-                                             kNumFramesInFlight);
+                                             num_frames_in_flight);
   viewer_ = std::make_unique<aurora::Viewer>(
-      mutable_window_context(), kNumFramesInFlight,
+      mutable_window_context(), num_frames_in_flight,
       editor_->GetAuroraPathVertexBuffers());
 }
 
@@ -96,11 +102,22 @@ void AuroraApp::TransitionSceneIfNeeded() {
 }
 
 void AuroraApp::MainLoop() {
+  // Wait for resources of the next frame before sampling inputs, so that inputs
+  // are as recent as possible when the frame is rendered.
+  command_->WaitForNextFrame();
   while (mutable_window_context()->CheckEvents()) {
     timer_.Tick();
     if (timer_.frame_rate() != frame_rate_) {
       frame_rate_ = timer_.frame_rate();
+      const auto& stats = command_->stats();
       LOG_INFO << "Frame rate: " << frame_rate_;
+      LOG_INFO << absl::StreamFormat(
+          "CPU wait time: %.2fms, CPU frame time: %.2fms, "
+          "GPU frame time: %.2fms, pacing delay: %.2fms",
+          stats.average_cpu_wait_time * 1000.0f,
+          stats.average_cpu_frame_time * 1000.0f,
+          stats.average_gpu_frame_time * 1000.0f,
+          stats.pacing_delay * 1000.0f);
     }
 
     auto& scene = GetCurrentScene();
@@ -110,11 +127,11 @@ void AuroraApp::MainLoop() {
     }
 
     const auto draw_result = command_->Run(
-        current_frame_, window_context().swapchain(),
+        window_context().swapchain(),
         [&scene](int frame) { scene.UpdateData(frame); },
-        [this, &scene](const VkCommandBuffer& command_buffer,
-                       uint32_t framebuffer_index) {
-          scene.Draw(command_buffer, framebuffer_index, current_frame_);
+        [&scene](const VkCommandBuffer& command_buffer,
+                 uint32_t framebuffer_index, int frame) {
+          scene.Draw(command_buffer, framebuffer_index, frame);
         });
 
     TransitionSceneIfNeeded();
@@ -125,7 +142,7 @@ void AuroraApp::MainLoop() {
       scene.Recreate();
     }
 
-    current_frame_ = (current_frame_ + 1) % kNumFramesInFlight;
+    command_->WaitForNextFrame();
   }
   mutable_window_context()->OnExit();
 }
@@ -0,0 +1,85 @@
+//
+//  bake_distance_field.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "lighter/common/distance_transform.h"
+#include "lighter/common/image.h"
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/timer.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/types/span.h"
+
+ABSL_FLAG(std::string, paths_image, "",
+          "Path to the one-channel aurora paths image dumped by the viewer");
+ABSL_FLAG(std::string, output, "distance_field.bin",
+          "Path to the baked distance field, which can be passed to "
+          "--baked_distance_field of the viewer");
+ABSL_FLAG(int, num_threads, 0,
+          "Number of threads. If not positive, the number of concurrent "
+          "threads supported by the hardware will be used");
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace aurora {
+namespace {
+
+void Bake() {
+  const std::string paths_image_path = absl::GetFlag(FLAGS_paths_image);
+  ASSERT_TRUE(!paths_image_path.empty(),
+              "Please specify the aurora paths image with --paths_image");
+  const std::string output_path = absl::GetFlag(FLAGS_output);
+
+  const auto paths_image = common::Image::LoadSingleImageFromFile(
+      paths_image_path, /*flip_y=*/false);
+  ASSERT_TRUE(paths_image.channel() == common::image::kBwImageChannel,
+              absl::StrFormat("Expecting one-channel image, while '%s' has %d "
+                              "channels",
+                              paths_image_path, paths_image.channel()));
+  const auto* paths_raster =
+      static_cast<const uint8_t*>(paths_image.GetDataPtrs()[0]);
+  const int width = paths_image.width();
+  const int height = paths_image.height();
+
+  common::ThreadPool thread_pool{absl::GetFlag(FLAGS_num_threads)};
+  const common::BasicTimer timer;
+  const std::vector<float> distances = common::distance_transform::ComputeExact(
+      absl::MakeConstSpan(paths_raster, width * height), width, height,
+      &thread_pool);
+  const float elapsed_time = timer.GetElapsedTimeSinceLaunch();
+
+  common::distance_transform::SaveToFile(output_path, distances, width,
+                                         height);
+  LOG_INFO << absl::StreamFormat(
+      "Distance field of %dx%d pixels written to '%s': %.1f ms", width, height,
+      output_path, elapsed_time * 1E3f);
+}
+
+} /* namespace */
+} /* namespace aurora */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+
+  try {
+    lighter::application::vulkan::aurora::Bake();
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Error: " << e.what();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -56,7 +56,8 @@ ButtonRenderer::ButtonRenderer(
     const SharedBasicContext& context,
     int num_buttons, const button::VerticesInfo& vertices_info,
     std::unique_ptr<OffscreenImage>&& buttons_image)
-    : buttons_image_{std::move(buttons_image)}, pipeline_builder_{context} {
+    : buttons_image_{std::move(buttons_image)},
+      pipeline_builder_{std::make_shared<GraphicsPipelineBuilder>(context)} {
   per_instance_buffer_ = std::make_unique<DynamicPerInstanceBuffer>(
       context, sizeof(draw_button::RenderInfo),
       /*max_num_instances=*/num_buttons * button::kNumStates,
@@ -70,7 +71,7 @@ ButtonRenderer::ButtonRenderer(
 
   descriptor_ = CreateDescriptor(context);
 
-  pipeline_builder_
+  (*pipeline_builder_)
       .SetPipelineName("Draw button")
       .AddVertexInput(
           kPerInstanceBufferBindingPoint,
@@ -122,24 +123,26 @@ std::unique_ptr<StaticDescriptor> ButtonRenderer::CreateDescriptor(
 }
 
 void ButtonRenderer::UpdateFramebuffer(
-    VkSampleCountFlagBits sample_count,
+    PipelineBuildJobs* pipeline_build_jobs, VkSampleCountFlagBits sample_count,
     const RenderPass& render_pass, uint32_t subpass_index,
     const GraphicsPipelineBuilder::ViewportInfo& viewport) {
-  pipeline_ = pipeline_builder_
+  FATAL_IF_NULL(pipeline_build_jobs);
+  (*pipeline_builder_)
       .SetMultisampling(sample_count)
       .SetViewport(GraphicsPipelineBuilder::ViewportInfo{viewport})
       .SetRenderPass(*render_pass, subpass_index)
       .SetColorBlend(
           std::vector<VkPipelineColorBlendAttachmentState>(
               render_pass.num_color_attachments(subpass_index),
-              pipeline::GetColorAlphaBlendState(/*enable_blend=*/true)))
-      .Build();
+              pipeline::GetColorAlphaBlendState(/*enable_blend=*/true)));
+  pipeline_ = pipeline_build_jobs->Add(pipeline_builder_);
 }
 
 void ButtonRenderer::Draw(
     const VkCommandBuffer& command_buffer,
     absl::Span<const draw_button::RenderInfo> buttons_to_render) {
-  ASSERT_NON_NULL(pipeline_, "UpdateFramebuffer() must have been called");
+  ASSERT_TRUE(pipeline_.is_valid(),
+              "UpdateFramebuffer() must have been called");
   per_instance_buffer_->CopyHostData(buttons_to_render);
   pipeline_->Bind(command_buffer);
   per_instance_buffer_->Bind(
@@ -309,12 +312,13 @@ button::VerticesInfo Button::CreateDrawButtonVerticesInfo(
   return vertices_info;
 }
 
-void Button::UpdateFramebuffer(const VkExtent2D& frame_size,
+void Button::UpdateFramebuffer(PipelineBuildJobs* pipeline_build_jobs,
+                               const VkExtent2D& frame_size,
                                VkSampleCountFlagBits sample_count,
                                const RenderPass& render_pass,
                                uint32_t subpass_index) {
   button_renderer_->UpdateFramebuffer(
-      sample_count, render_pass, subpass_index,
+      pipeline_build_jobs, sample_count, render_pass, subpass_index,
       pipeline::GetViewport(frame_size, viewport_aspect_ratio_));
 }
 
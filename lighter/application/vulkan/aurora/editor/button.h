@@ -21,6 +21,7 @@
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
 #include "third_party/vulkan/vulkan.h"
@@ -61,8 +62,10 @@ class ButtonRenderer {
   ButtonRenderer(const ButtonRenderer&) = delete;
   ButtonRenderer& operator=(const ButtonRenderer&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds the graphics pipeline with
+  // 'pipeline_build_jobs'.
   void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
       VkSampleCountFlagBits sample_count,
       const renderer::vulkan::RenderPass& render_pass, uint32_t subpass_index,
       const renderer::vulkan::GraphicsPipelineBuilder::ViewportInfo& viewport);
@@ -86,8 +89,9 @@ class ButtonRenderer {
       per_instance_buffer_;
   std::unique_ptr<renderer::vulkan::UniformBuffer> vertices_uniform_;
   std::unique_ptr<renderer::vulkan::StaticDescriptor> descriptor_;
-  renderer::vulkan::GraphicsPipelineBuilder pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> pipeline_;
+  const std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+      pipeline_builder_;
+  renderer::vulkan::PipelineHandle pipeline_;
 };
 
 // This class is used to render multiple buttons with one render call.
@@ -137,12 +141,13 @@ class Button {
   Button(const Button&) = delete;
   Button& operator=(const Button&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds the graphics pipeline with
+  // 'pipeline_build_jobs'.
   // For simplicity, the render area will be the same to 'frame_size'.
-  void UpdateFramebuffer(const VkExtent2D& frame_size,
-                         VkSampleCountFlagBits sample_count,
-                         const renderer::vulkan::RenderPass& render_pass,
-                         uint32_t subpass_index);
+  void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
+      const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
+      const renderer::vulkan::RenderPass& render_pass, uint32_t subpass_index);
 
   // Renders all buttons. Buttons in 'State::kHidden' will not be rendered.
   // Others will be rendered with color and alpha selected according to states.
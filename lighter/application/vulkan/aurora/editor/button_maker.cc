@@ -16,6 +16,7 @@
 #include "lighter/renderer/vulkan/wrapper/command.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline_util.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 
@@ -113,9 +114,11 @@ std::unique_ptr<RenderPass> CreateRenderPass(
   return render_pass_builder->Build();
 }
 
-// Creates a text renderer for rendering texts on buttons.
+// Creates a text renderer for rendering texts on buttons. Its pipeline is
+// built with 'pipeline_build_jobs'.
 std::unique_ptr<DynamicText> CreateTextRenderer(
-    const SharedBasicContext& context, Text::Font font, int font_height,
+    const SharedBasicContext& context, PipelineBuildJobs* pipeline_build_jobs,
+    Text::Font font, int font_height,
     const Image& target_image, const RenderPass& render_pass,
     absl::Span<const make_button::ButtonInfo> button_infos) {
   std::vector<std::string> texts;
@@ -129,7 +132,7 @@ std::unique_ptr<DynamicText> CreateTextRenderer(
       renderer::vulkan::util::GetAspectRatio(target_image.extent()),
       texts, font, font_height);
   text_renderer->Update(
-      target_image.extent(), target_image.sample_count(),
+      pipeline_build_jobs, target_image.extent(), target_image.sample_count(),
       render_pass, kTextSubpassIndex, /*flip_y=*/false);
 
   constexpr float kTextBaseX = kUvDim / 2.0f;
@@ -186,10 +189,14 @@ std::unique_ptr<OffscreenImage> ButtonMaker::CreateButtonsImage(
 
   const auto render_pass = CreateRenderPass(context, *buttons_image);
 
+  // Both pipelines are built on worker threads.
+  PipelineBuildJobs pipeline_build_jobs{context};
   const auto text_renderer = CreateTextRenderer(
-      context, font, font_height, *buttons_image, *render_pass, button_infos);
+      context, &pipeline_build_jobs, font, font_height, *buttons_image,
+      *render_pass, button_infos);
 
-  const auto pipeline = GraphicsPipelineBuilder{context}
+  auto pipeline_builder = std::make_unique<GraphicsPipelineBuilder>(context);
+  (*pipeline_builder)
       .SetPipelineName("Button background")
       .AddVertexInput(
           kPerInstanceBufferBindingPoint,
@@ -206,8 +213,10 @@ std::unique_ptr<OffscreenImage> ButtonMaker::CreateButtonsImage(
       .SetShader(VK_SHADER_STAGE_VERTEX_BIT,
                  GetShaderBinaryPath("aurora/make_button.vert"))
       .SetShader(VK_SHADER_STAGE_FRAGMENT_BIT,
-                 GetShaderBinaryPath("aurora/make_button.frag"))
-      .Build();
+                 GetShaderBinaryPath("aurora/make_button.frag"));
+  const PipelineHandle pipeline =
+      pipeline_build_jobs.Add(std::move(pipeline_builder));
+  pipeline_build_jobs.Wait();
 
   const std::vector<RenderPass::RenderOp> render_ops{
       [&](const VkCommandBuffer& command_buffer) {
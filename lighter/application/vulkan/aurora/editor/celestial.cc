@@ -105,13 +105,14 @@ Celestial::Celestial(const SharedBasicContext& context,
 }
 
 void Celestial::UpdateFramebuffer(
+    PipelineBuildJobs* pipeline_build_jobs,
     const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
     const RenderPass& render_pass, uint32_t subpass_index) {
   constexpr bool kIsObjectOpaque = true;
-  earth_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                       render_pass, subpass_index);
-  skybox_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                        render_pass, subpass_index);
+  earth_model_->Update(pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                       sample_count, render_pass, subpass_index);
+  skybox_model_->Update(pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                        sample_count, render_pass, subpass_index);
 }
 
 void Celestial::UpdateEarthData(int frame, EarthTextureIndex texture_index,
@@ -13,6 +13,7 @@
 #include "lighter/renderer/vulkan/extension/model.h"
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "third_party/glm/glm.hpp"
 #include "third_party/vulkan/vulkan.h"
@@ -41,9 +42,11 @@ class Celestial {
   Celestial(const Celestial&) = delete;
   Celestial& operator=(const Celestial&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds graphics pipelines with
+  // 'pipeline_build_jobs'.
   // For simplicity, the render area will be the same to 'frame_size'.
   void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
       const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
       const renderer::vulkan::RenderPass& render_pass, uint32_t subpass_index);
 
@@ -255,9 +255,6 @@ void Editor::OnExit() {
 }
 
 void Editor::Recreate() {
-  // Prevent shaders from being auto released.
-  ShaderModule::AutoReleaseShaderPool shader_pool;
-
   render_pass_manager_->RecreateRenderPass();
 
   general_camera_->SetCursorPos(window_context_.window().GetCursorPos());
@@ -265,14 +262,19 @@ void Editor::Recreate() {
 
   const VkExtent2D& frame_size = window_context_.frame_size();
   const VkSampleCountFlagBits sample_count = window_context_.sample_count();
-  celestial_->UpdateFramebuffer(frame_size, sample_count, render_pass(),
-                                kModelSubpassIndex);
-  aurora_path_->UpdateFramebuffer(frame_size, sample_count, render_pass(),
+  PipelineBuildJobs pipeline_build_jobs{window_context_.basic_context()};
+  celestial_->UpdateFramebuffer(&pipeline_build_jobs, frame_size, sample_count,
+                                render_pass(), kModelSubpassIndex);
+  aurora_path_->UpdateFramebuffer(&pipeline_build_jobs, frame_size,
+                                  sample_count, render_pass(),
                                   kAuroraPathSubpassIndex);
-  top_row_buttons_->UpdateFramebuffer(frame_size, sample_count, render_pass(),
+  top_row_buttons_->UpdateFramebuffer(&pipeline_build_jobs, frame_size,
+                                      sample_count, render_pass(),
                                       kButtonSubpassIndex);
-  bottom_row_buttons_->UpdateFramebuffer(frame_size, sample_count,
-                                         render_pass(), kButtonSubpassIndex);
+  bottom_row_buttons_->UpdateFramebuffer(&pipeline_build_jobs, frame_size,
+                                         sample_count, render_pass(),
+                                         kButtonSubpassIndex);
+  pipeline_build_jobs.Wait();
 }
 
 void Editor::UpdateData(int frame) {
@@ -10,6 +10,7 @@
 #include "lighter/application/vulkan/util.h"
 #include "lighter/common/data.h"
 #include "lighter/common/file.h"
+#include "lighter/common/thread_pool.h"
 #include "lighter/renderer/util.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline_util.h"
 #include "third_party/absl/strings/str_format.h"
@@ -74,8 +75,12 @@ inline glm::vec3 TransformPoint(const glm::mat4& transform,
 PathRenderer3D::PathRenderer3D(const SharedBasicContext& context,
                                int num_frames_in_flight, int num_paths)
     : num_paths_{num_paths}, num_control_points_per_path_(num_paths_),
-      control_pipeline_builder_{context}, spline_pipeline_builder_{context},
-      viewpoint_pipeline_builder_{context} {
+      control_pipeline_builder_{
+          std::make_shared<GraphicsPipelineBuilder>(context)},
+      spline_pipeline_builder_{
+          std::make_shared<GraphicsPipelineBuilder>(context)},
+      viewpoint_pipeline_builder_{
+          std::make_shared<GraphicsPipelineBuilder>(context)} {
   using common::Vertex3DPosOnly;
 
   // Prevent shaders from being auto released.
@@ -120,7 +125,7 @@ PathRenderer3D::PathRenderer3D(const SharedBasicContext& context,
       context, sizeof(ViewpointRenderInfo), num_frames_in_flight);
 
   /* Pipeline */
-  control_pipeline_builder_
+  (*control_pipeline_builder_)
       .SetPipelineName("Aurora path control")
       .SetDepthTestEnable(/*enable_test=*/true, /*enable_write=*/false)
       .AddVertexInput(
@@ -141,7 +146,7 @@ PathRenderer3D::PathRenderer3D(const SharedBasicContext& context,
       .SetShader(VK_SHADER_STAGE_FRAGMENT_BIT,
                  GetShaderBinaryPath("aurora/draw_path.frag"));
 
-  spline_pipeline_builder_
+  (*spline_pipeline_builder_)
       .SetPipelineName("Aurora path spline")
       .SetDepthTestEnable(/*enable_test=*/true, /*enable_write=*/false)
       .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_LINE_STRIP)
@@ -163,7 +168,7 @@ PathRenderer3D::PathRenderer3D(const SharedBasicContext& context,
       .SetShader(VK_SHADER_STAGE_FRAGMENT_BIT,
                  GetShaderBinaryPath("aurora/draw_path.frag"));
 
-  viewpoint_pipeline_builder_
+  (*viewpoint_pipeline_builder_)
       .SetPipelineName("User viewpoint")
       .SetDepthTestEnable(/*enable_test=*/true, /*enable_write=*/false)
       .AddVertexInput(
@@ -180,42 +185,43 @@ PathRenderer3D::PathRenderer3D(const SharedBasicContext& context,
                  GetShaderBinaryPath("aurora/draw_path.frag"));
 }
 
-void PathRenderer3D::UpdatePath(int path_index,
-                                absl::Span<const glm::vec3> control_points,
-                                absl::Span<const glm::vec3> spline_points) {
+void PathRenderer3D::UpdatePath(
+    int path_index,
+    absl::Span<const glm::vec3> control_points,
+    absl::Span<const glm::vec3> spline_points,
+    const common::Spline::PointRange& dirty_spline_points) {
   num_control_points_per_path_[path_index] = control_points.size();
   paths_vertex_buffers_[path_index].control_points_buffer->CopyHostData(
       control_points);
+  constexpr size_t kPointSize = sizeof(spline_points[0]);
   paths_vertex_buffers_[path_index].spline_points_buffer->CopyHostData(
       PerVertexBuffer::NoIndicesDataInfo{
           /*per_mesh_vertices=*/{{
               PerVertexBuffer::VertexDataInfo{spline_points},
           }},
-      });
+      },
+      /*dirty_offset=*/kPointSize * dirty_spline_points.begin,
+      /*dirty_size=*/kPointSize *
+          (dirty_spline_points.end - dirty_spline_points.begin));
 }
 
 void PathRenderer3D::UpdateFramebuffer(
-    VkSampleCountFlagBits sample_count,
+    PipelineBuildJobs* pipeline_build_jobs, VkSampleCountFlagBits sample_count,
     const RenderPass& render_pass, uint32_t subpass_index,
     const GraphicsPipelineBuilder::ViewportInfo& viewport) {
-  // Prevent shaders from being auto released.
-  ShaderModule::AutoReleaseShaderPool shader_pool;
-
-  control_pipeline_ = control_pipeline_builder_
-      .SetMultisampling(sample_count)
-      .SetViewport(GraphicsPipelineBuilder::ViewportInfo{viewport})
-      .SetRenderPass(*render_pass, subpass_index)
-      .Build();
-  spline_pipeline_ = spline_pipeline_builder_
-      .SetMultisampling(sample_count)
-      .SetViewport(GraphicsPipelineBuilder::ViewportInfo{viewport})
-      .SetRenderPass(*render_pass, subpass_index)
-      .Build();
-  viewpoint_pipeline_ = viewpoint_pipeline_builder_
-      .SetMultisampling(sample_count)
-      .SetViewport(GraphicsPipelineBuilder::ViewportInfo{viewport})
-      .SetRenderPass(*render_pass, subpass_index)
-      .Build();
+  // Shaders shared by these pipelines are loaded only once by the build jobs.
+  FATAL_IF_NULL(pipeline_build_jobs);
+  for (auto* builder : {control_pipeline_builder_.get(),
+                        spline_pipeline_builder_.get(),
+                        viewpoint_pipeline_builder_.get()}) {
+    (*builder)
+        .SetMultisampling(sample_count)
+        .SetViewport(GraphicsPipelineBuilder::ViewportInfo{viewport})
+        .SetRenderPass(*render_pass, subpass_index);
+  }
+  control_pipeline_ = pipeline_build_jobs->Add(control_pipeline_builder_);
+  spline_pipeline_ = pipeline_build_jobs->Add(spline_pipeline_builder_);
+  viewpoint_pipeline_ = pipeline_build_jobs->Add(viewpoint_pipeline_builder_);
 }
 
 void PathRenderer3D::UpdatePerFrameData(int frame, float control_point_scale,
@@ -334,16 +340,28 @@ AuroraPath::AuroraPath(const SharedBasicContext& context,
         common::CatmullRomSpline::kMinNumControlPoints,
         info.max_num_control_points, info.generate_control_points(path),
         common::CatmullRomSpline::GetOnSphereSpline(
-            info.max_recursion_depth, info.spline_roughness)));
+            info.max_recursion_depth, info.spline_roughness),
+        /*build_spline=*/false));
+  }
+
+  // Paths are independent of each other, hence we build them in parallel.
+  std::vector<common::SplineEditor*> editors;
+  editors.reserve(num_paths_);
+  for (const auto& editor : spline_editors_) {
+    editors.push_back(editor.get());
+  }
+  common::SplineEditor::RebuildAll(editors, common::GetSharedThreadPool());
+  for (int path = 0; path < num_paths_; ++path) {
     UpdatePath(path);
   }
 }
 
 void AuroraPath::UpdateFramebuffer(
+    PipelineBuildJobs* pipeline_build_jobs,
     const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
     const RenderPass& render_pass, uint32_t subpass_index) {
   path_renderer_.UpdateFramebuffer(
-      sample_count, render_pass, subpass_index,
+      pipeline_build_jobs, sample_count, render_pass, subpass_index,
       pipeline::GetViewport(frame_size, viewport_aspect_ratio_));
 }
 
@@ -401,9 +419,10 @@ void AuroraPath::Draw(const VkCommandBuffer& command_buffer, int frame,
 }
 
 void AuroraPath::UpdatePath(int path_index) {
-  path_renderer_.UpdatePath(path_index,
-                            spline_editors_[path_index]->control_points(),
-                            spline_editors_[path_index]->spline_points());
+  const auto& editor = *spline_editors_[path_index];
+  path_renderer_.UpdatePath(path_index, editor.control_points(),
+                            editor.spline_points(),
+                            editor.dirty_spline_points());
 }
 
 std::optional<int> AuroraPath::ProcessClick(
@@ -21,6 +21,7 @@
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
@@ -43,13 +44,18 @@ class PathRenderer3D {
   PathRenderer3D(const PathRenderer3D&) = delete;
   PathRenderer3D& operator=(const PathRenderer3D&) = delete;
 
-  // Updates the vertex data of aurora path at 'path_index'.
+  // Updates the vertex data of aurora path at 'path_index'. Only spline points
+  // within 'dirty_spline_points' will be sent to the device, assuming the rest
+  // are the same as the last time this was called.
   void UpdatePath(int path_index,
                   absl::Span<const glm::vec3> control_points,
-                  absl::Span<const glm::vec3> spline_points);
+                  absl::Span<const glm::vec3> spline_points,
+                  const common::Spline::PointRange& dirty_spline_points);
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds graphics pipelines with
+  // 'pipeline_build_jobs'.
   void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
       VkSampleCountFlagBits sample_count,
       const renderer::vulkan::RenderPass& render_pass, uint32_t subpass_index,
       const renderer::vulkan::GraphicsPipelineBuilder::ViewportInfo& viewport);
@@ -103,12 +109,15 @@ class PathRenderer3D {
   std::unique_ptr<renderer::vulkan::PushConstant> control_render_constant_;
   std::unique_ptr<renderer::vulkan::PushConstant> spline_trans_constant_;
   std::unique_ptr<renderer::vulkan::PushConstant> viewpoint_render_constant_;
-  renderer::vulkan::GraphicsPipelineBuilder control_pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> control_pipeline_;
-  renderer::vulkan::GraphicsPipelineBuilder spline_pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> spline_pipeline_;
-  renderer::vulkan::GraphicsPipelineBuilder viewpoint_pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> viewpoint_pipeline_;
+  const std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+      control_pipeline_builder_;
+  renderer::vulkan::PipelineHandle control_pipeline_;
+  const std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+      spline_pipeline_builder_;
+  renderer::vulkan::PipelineHandle spline_pipeline_;
+  const std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+      viewpoint_pipeline_builder_;
+  renderer::vulkan::PipelineHandle viewpoint_pipeline_;
 };
 
 // This class is used to render aurora paths and the user viewpoint, and handle
@@ -153,9 +162,11 @@ class AuroraPath {
   AuroraPath(const AuroraPath&) = delete;
   AuroraPath& operator=(const AuroraPath&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds graphics pipelines with
+  // 'pipeline_build_jobs'.
   // For simplicity, the render area will be the same to 'frame_size'.
   void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
       const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
       const renderer::vulkan::RenderPass& render_pass, uint32_t subpass_index);
 
@@ -0,0 +1,213 @@
+//
+//  offline_aurora.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "lighter/application/vulkan/aurora/viewer/offline_renderer.h"
+#include "lighter/common/air_transmit.h"
+#include "lighter/common/camera.h"
+#include "lighter/common/distance_transform.h"
+#include "lighter/common/file.h"
+#include "lighter/common/image.h"
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/timer.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/glm/glm.hpp"
+#include "third_party/glm/gtc/matrix_transform.hpp"
+#include "third_party/glm/gtc/packing.hpp"
+
+ABSL_FLAG(std::string, paths_image, "",
+          "Path to the one-channel aurora paths image dumped by the viewer");
+ABSL_FLAG(std::string, distance_field, "",
+          "Path to the distance field baked for --paths_image. If empty, it "
+          "will be computed from --paths_image");
+ABSL_FLAG(float, viewpoint_latitude, 65.0f, "Latitude of viewpoint in degrees");
+ABSL_FLAG(float, viewpoint_longitude, -147.0f,
+          "Longitude of viewpoint in degrees");
+ABSL_FLAG(int, width, 1280, "Width of output frames");
+ABSL_FLAG(int, height, 720, "Height of output frames");
+ABSL_FLAG(int, num_frames, 1,
+          "Number of frames to render. If greater than 1, the camera turns "
+          "around the local vertical axis by a full circle across frames");
+ABSL_FLAG(std::string, output, "aurora_%04d.png",
+          "Path to output frames, formatted with the frame index. Frames are "
+          "written as Radiance HDR images if it ends with '.hdr', otherwise "
+          "PNG images");
+ABSL_FLAG(int, num_threads, 0,
+          "Number of rendering threads. If not positive, the number of "
+          "concurrent threads supported by the hardware will be used");
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace aurora {
+namespace {
+
+/* BEGIN: Consistent with Viewer. */
+
+constexpr common::air_transmit::TableConfig kAirTransmitTableConfig{
+    /*num_cos_angle_samples=*/256, /*num_altitude_samples=*/16};
+constexpr float kCameraFar = 2.0f;
+constexpr float kDumpPathsFieldOfViewY = 40.0f;
+constexpr float kViewAuroraFieldOfViewY = 45.0f;
+
+// Returns the axis of earth model in object space.
+glm::vec3 GetEarthModelAxis() { return {0.0f, 1.0f, 0.0f}; }
+
+/* END: Consistent with Viewer. */
+
+// Returns the position on the earth surface at 'latitude' and 'longitude', in
+// the object space of the earth model.
+glm::vec3 GetViewpointPosition(float latitude, float longitude) {
+  const float theta = glm::radians(latitude);
+  const float phi = glm::radians(longitude);
+  return {glm::cos(theta) * glm::sin(phi), glm::sin(theta),
+          glm::cos(theta) * glm::cos(phi)};
+}
+
+// Returns the projection-view matrix of the camera that dumps aurora paths
+// viewed from 'viewpoint_position'.
+glm::mat4 GetDumpPathsProjView(const glm::vec3& viewpoint_position) {
+  common::Camera::Config config;
+  config.far = kCameraFar;
+  config.up = GetEarthModelAxis();
+  config.position = glm::vec3{0.0f};
+  config.look_at = viewpoint_position;
+  const common::PerspectiveCamera camera{
+      config, common::PerspectiveCamera::FrustumConfig{
+          kDumpPathsFieldOfViewY, /*aspect_ratio=*/1.0f}};
+  return camera.GetProjectionMatrix() * camera.GetViewMatrix();
+}
+
+// Returns the camera standing at 'viewpoint_position', which is rotated around
+// the local vertical axis by 'yaw' radians.
+std::unique_ptr<common::PerspectiveCamera> CreateViewAuroraCamera(
+    const glm::vec3& viewpoint_position, float yaw, float aspect_ratio) {
+  const glm::vec3 up = viewpoint_position;
+  const glm::vec3 right = glm::cross(GetEarthModelAxis(), up);
+  const glm::vec3 north = glm::normalize(glm::cross(up, right));
+  const glm::vec3 front = glm::vec3{
+      glm::rotate(glm::mat4{1.0f}, yaw, up) * glm::vec4{north, 0.0f}};
+
+  common::Camera::Config config;
+  config.far = kCameraFar;
+  config.up = up;
+  config.position = viewpoint_position;
+  config.look_at = viewpoint_position + front;
+  return std::make_unique<common::PerspectiveCamera>(
+      config, common::PerspectiveCamera::FrustumConfig{
+          kViewAuroraFieldOfViewY, aspect_ratio});
+}
+
+void Render() {
+  const std::string paths_image_path = absl::GetFlag(FLAGS_paths_image);
+  ASSERT_TRUE(!paths_image_path.empty(),
+              "Please specify the aurora paths image with --paths_image");
+  const int width = absl::GetFlag(FLAGS_width);
+  const int height = absl::GetFlag(FLAGS_height);
+  const int num_frames = absl::GetFlag(FLAGS_num_frames);
+  ASSERT_TRUE(num_frames > 0, "--num_frames must be positive");
+  const auto output_format = absl::ParsedFormat<'d'>::NewAllowIgnored(
+      absl::GetFlag(FLAGS_output));
+  ASSERT_NON_NULL(output_format,
+                  "--output may only contain one integer conversion");
+
+  common::ThreadPool thread_pool{absl::GetFlag(FLAGS_num_threads)};
+
+  /* Textures */
+  const auto paths_image = common::Image::LoadSingleImageFromFile(
+      paths_image_path, /*flip_y=*/false);
+  const auto* paths_raster =
+      static_cast<const uint8_t*>(paths_image.GetDataPtrs()[0]);
+  const int num_paths_pixels = paths_image.width() * paths_image.height();
+
+  std::vector<float> distance_field;
+  if (const std::string path = absl::GetFlag(FLAGS_distance_field);
+      !path.empty()) {
+    const common::distance_transform::BakedDistanceField baked_field{path};
+    ASSERT_TRUE(baked_field.width() == paths_image.width() &&
+                    baked_field.height() == paths_image.height(),
+                "Size of distance field mismatches with aurora paths image");
+    distance_field.reserve(num_paths_pixels);
+    for (const uint16_t half_distance : baked_field.half_distances()) {
+      distance_field.push_back(glm::unpackHalf1x16(half_distance));
+    }
+  } else {
+    distance_field = common::distance_transform::ComputeExact(
+        absl::MakeConstSpan(paths_raster, num_paths_pixels),
+        paths_image.width(), paths_image.height(), &thread_pool);
+  }
+
+  const glm::vec3 viewpoint_position = GetViewpointPosition(
+      absl::GetFlag(FLAGS_viewpoint_latitude),
+      absl::GetFlag(FLAGS_viewpoint_longitude));
+  const auto aurora_deposition_image = common::Image::LoadSingleImageFromFile(
+      common::file::GetResourcePath("texture/aurora_deposition.jpg"),
+      /*flip_y=*/false);
+  const std::vector<std::string> skybox_files{
+      "PositiveX.jpg", "NegativeX.jpg",
+      "PositiveY.jpg", "NegativeY.jpg",
+      "PositiveZ.jpg", "NegativeZ.jpg",
+  };
+  const auto universe_skybox_image = common::Image::LoadCubemapFromFiles(
+      common::file::GetResourcePath("texture/universe/PositiveX.jpg",
+                                    /*want_directory_path=*/true),
+      skybox_files, /*flip_y=*/false, &thread_pool);
+  const OfflineRenderer renderer{
+      aurora_deposition_image, universe_skybox_image, kAirTransmitTableConfig,
+      OfflineRenderer::PathsTextures{
+          &paths_image, distance_field,
+          GetDumpPathsProjView(viewpoint_position)}};
+
+  /* Frames */
+  const float aspect_ratio =
+      static_cast<float>(width) / static_cast<float>(height);
+  for (int frame_index = 0; frame_index < num_frames; ++frame_index) {
+    const float yaw = glm::radians(360.0f) * frame_index / num_frames;
+    const auto camera =
+        CreateViewAuroraCamera(viewpoint_position, yaw, aspect_ratio);
+
+    const common::BasicTimer timer;
+    const auto frame = renderer.Render(*camera, width, height, &thread_pool);
+    const float elapsed_time = timer.GetElapsedTimeSinceLaunch();
+
+    const std::string output_path =
+        absl::StrFormat(*output_format, frame_index);
+    OfflineRenderer::WriteFrame(frame, output_path);
+    LOG_INFO << absl::StreamFormat(
+        "Frame %d written to '%s': %.1f ms, %.2f Mrays/s", frame_index,
+        output_path, elapsed_time * 1E3f,
+        static_cast<float>(width) * height / elapsed_time / 1E6f);
+  }
+}
+
+} /* namespace */
+} /* namespace aurora */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+  lighter::common::file::EnableRunfileLookup(argv[0]);
+
+  try {
+    lighter::application::vulkan::aurora::Render();
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Error: " << e.what();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -8,25 +8,36 @@
 #ifndef LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_AIR_TRANSMIT_TABLE_H
 #define LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_AIR_TRANSMIT_TABLE_H
 
-#include "lighter/common/file.h"
-#include "lighter/common/image.h"
-#include "third_party/glm/glm.hpp"
+#include <memory>
+
+#include "lighter/common/air_transmit.h"
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/image.h"
 
 namespace lighter {
 namespace application {
 namespace vulkan {
 namespace aurora {
 
-// This code is modified from Dr. Orion Sky Lawlor's implementation.
-// Lawlor, Orion & Genetti, Jon. (2011). Interactive Volume Rendering Aurora on
-// the GPU. Journal of WSCG. 19. 25-32.
+// Formats of texels in the air transmit table image.
+enum class AirTransmitTableFormat {
+  // 8-bit unsigned normalized integers.
+  kUnorm8,
+  // Half-precision floats.
+  kHalfFloat,
+  // Single-precision floats. Note that linear filtering of this format is not
+  // supported by all devices.
+  kFloat,
+};
 
-// Generates an air transmit table texture. Such a texture enables us to look up
-// how much aurora light can penetrate the air and get to our eyes in shaders.
-// The size of the returned image will be [1, floor(1.0 / 'sample_step')].
-// The Y coordinate, after scaled to range [0.0, 1.0], represents the cosine
-// value of the angle between view ray and up vector.
-common::Image GenerateAirTransmitTable(float sample_step);
+// Creates the air transmit table image with 'config', which enables us to look
+// up how much aurora light can penetrate the air and get to our eyes in
+// shaders. See lighter/common/air_transmit.h for the layout of the table. The
+// table is loaded from the cache file if possible.
+std::unique_ptr<renderer::vulkan::TextureImage> CreateAirTransmitTableImage(
+    const renderer::vulkan::SharedBasicContext& context,
+    const common::air_transmit::TableConfig& config,
+    AirTransmitTableFormat format);
 
 } /* namespace aurora */
 } /* namespace vulkan */
@@ -7,14 +7,18 @@
 
 #include "lighter/application/vulkan/aurora/viewer/distance_field.h"
 
-#include <algorithm>
+#include <vector>
 
 #include "lighter/application/vulkan/util.h"
+#include "lighter/common/distance_transform.h"
+#include "lighter/common/jump_flooding.h"
 #include "lighter/common/util.h"
 #include "lighter/renderer/ir/image_usage.h"
 #include "lighter/renderer/util.h"
 #include "lighter/renderer/vulkan/wrapper/image_util.h"
 #include "lighter/renderer/vulkan/wrapper/util.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/glm/glm.hpp"
 
 namespace lighter {
 namespace application {
@@ -25,6 +29,8 @@ namespace {
 using namespace renderer;
 using namespace renderer::vulkan;
 
+namespace jump_flooding = common::jump_flooding;
+
 enum ImageBindingPoint {
   kOriginalImageBindingPoint = 0,
   kOutputImageBindingPoint,
@@ -39,49 +45,83 @@ constexpr uint32_t kWorkGroupSizeY = 16;
 
 /* BEGIN: Consistent with uniform blocks defined in shaders. */
 
+constexpr int kMaxNumTiledSteps = 8;
+
 struct StepWidth {
   ALIGN_SCALAR(int) int value;
 };
 
+struct TiledSteps {
+  ALIGN_SCALAR(int) int num_steps;
+  ALIGN_VEC4 glm::ivec4 step_widths[kMaxNumTiledSteps / 4];
+};
+
 /* END: Consistent with uniform blocks defined in shaders. */
 
+// Seeds are packed into one 32-bit unsigned integer. Unlike two-channel 16-bit
+// formats, this format is guaranteed to support storage images.
+constexpr VkFormat kSeedImageFormat = VK_FORMAT_R32_UINT;
+
 } /* namespace */
 
 DistanceFieldGenerator::DistanceFieldGenerator(
-    const SharedBasicContext& context,
-    const OffscreenImage& input_image, const OffscreenImage& output_image)
+    const SharedBasicContext& context, PipelineBuildJobs* pipeline_build_jobs,
+    const OffscreenImage& input_image, const OffscreenImage& output_image,
+    Mode mode, jump_flooding::Refinement refinement)
     : work_group_count_{renderer::vulkan::util::GetWorkGroupCount(
-          input_image.extent(), {kWorkGroupSizeX, kWorkGroupSizeY})} {
+          input_image.extent(), {kWorkGroupSizeX, kWorkGroupSizeY})},
+      tiled_work_group_count_{renderer::vulkan::util::GetWorkGroupCount(
+          input_image.extent(),
+          {jump_flooding::kTileSize, jump_flooding::kTileSize})} {
   const auto& image_extent = input_image.extent();
   ASSERT_TRUE(output_image.extent().width == image_extent.width &&
                   output_image.extent().height == image_extent.height,
               "Size of input and output images must match");
 
   /* Push constant */
-  const int greatest_dimension = std::max(image_extent.width,
-                                          image_extent.height);
-  std::vector<int> step_widths;
-  int dimension = 1;
-  while (dimension < greatest_dimension) {
-    step_widths.push_back(dimension);
-    dimension *= 2;
+  const std::vector<int> step_widths = jump_flooding::GetStepWidths(
+      image_extent.width, image_extent.height, refinement);
+  num_separate_steps_ = step_widths.size();
+  if (mode == Mode::kTiled) {
+    // Steps with small widths only appear at the end.
+    while (num_separate_steps_ > 0 &&
+           step_widths[num_separate_steps_ - 1] <=
+               jump_flooding::kMaxTiledStepWidth) {
+      --num_separate_steps_;
+    }
   }
-  num_steps_ = step_widths.size();
+  const int num_tiled_steps = step_widths.size() - num_separate_steps_;
+  has_tiled_steps_ = num_tiled_steps > 0;
 
+  // Push constants must not be empty, hence at least one frame is created.
   step_width_constant_ = std::make_unique<PushConstant>(
-      context, sizeof(StepWidth), num_steps_);
-  for (int i = 0; i < num_steps_; ++i) {
+      context, sizeof(StepWidth), std::max(num_separate_steps_, 1));
+  for (int i = 0; i < num_separate_steps_; ++i) {
     step_width_constant_->HostData<StepWidth>(/*frame=*/i)->value =
         step_widths[i];
   }
-  const auto push_constant_range =
-      step_width_constant_->MakePerFrameRange(VK_SHADER_STAGE_COMPUTE_BIT);
+
+  ASSERT_TRUE(num_tiled_steps <= kMaxNumTiledSteps,
+              absl::StrFormat("Too many tiled steps: %d", num_tiled_steps));
+  tiled_steps_constant_ = std::make_unique<PushConstant>(
+      context, sizeof(TiledSteps), /*num_frames_in_flight=*/1);
+  auto& tiled_steps = *tiled_steps_constant_->HostData<TiledSteps>(
+      /*frame=*/0);
+  tiled_steps = {};
+  tiled_steps.num_steps = num_tiled_steps;
+  for (int i = 0; i < num_tiled_steps; ++i) {
+    tiled_steps.step_widths[i / 4][i % 4] =
+        step_widths[num_separate_steps_ + i];
+  }
 
   /* Image */
   const auto image_usage = ImageUsage::GetLinearAccessInComputeShaderUsage(
       ir::AccessType::kReadWrite);
+  ping_image_ = std::make_unique<OffscreenImage>(
+      context, image_extent, kSeedImageFormat,
+      absl::MakeSpan(&image_usage, 1), ImageSampler::Config{});
   pong_image_ = std::make_unique<OffscreenImage>(
-      context, image_extent, output_image.format(),
+      context, image_extent, kSeedImageFormat,
       absl::MakeSpan(&image_usage, 1), ImageSampler::Config{});
 
   /* Descriptor */
@@ -100,8 +140,10 @@ DistanceFieldGenerator::DistanceFieldGenerator(
   const VkImageLayout image_layout = image::GetImageLayout(image_usage);
   const auto input_image_descriptor_info =
       input_image.GetDescriptorInfo(image_layout);
-  const auto ping_image_descriptor_info =
+  const auto output_image_descriptor_info =
       output_image.GetDescriptorInfo(image_layout);
+  const auto ping_image_descriptor_info =
+      ping_image_->GetDescriptorInfo(image_layout);
   const auto pong_image_descriptor_info =
       pong_image_->GetDescriptorInfo(image_layout);
 
@@ -114,59 +156,177 @@ DistanceFieldGenerator::DistanceFieldGenerator(
   image_info_maps_[kPongToPing] = {
       {kOriginalImageBindingPoint, {pong_image_descriptor_info}},
       {kOutputImageBindingPoint, {ping_image_descriptor_info}}};
-  image_info_maps_[kPingToPing] = {
+  image_info_maps_[kPingToOutput] = {
       {kOriginalImageBindingPoint, {ping_image_descriptor_info}},
-      {kOutputImageBindingPoint, {ping_image_descriptor_info}}};
+      {kOutputImageBindingPoint, {output_image_descriptor_info}}};
+  image_info_maps_[kPongToOutput] = {
+      {kOriginalImageBindingPoint, {pong_image_descriptor_info}},
+      {kOutputImageBindingPoint, {output_image_descriptor_info}}};
 
   /* Pipeline */
-  path_to_coord_pipeline_ = ComputePipelineBuilder{context}
-      .SetPipelineName("Path to coordinate")
+  FATAL_IF_NULL(pipeline_build_jobs);
+  auto path_to_seed_builder = std::make_unique<ComputePipelineBuilder>(context);
+  (*path_to_seed_builder)
+      .SetPipelineName("Path to seed")
       .SetPipelineLayout({descriptor_->layout()}, /*push_constant_ranges=*/{})
-      .SetShader(GetShaderBinaryPath("aurora/path_to_coord.comp"))
-      .Build();
+      .SetShader(GetShaderBinaryPath("aurora/path_to_seed.comp"));
+  path_to_seed_pipeline_ =
+      pipeline_build_jobs->Add(std::move(path_to_seed_builder));
 
-  jump_flooding_pipeline_ = ComputePipelineBuilder{context}
+  auto jump_flooding_builder =
+      std::make_unique<ComputePipelineBuilder>(context);
+  (*jump_flooding_builder)
       .SetPipelineName("Jump flooding")
-      .SetPipelineLayout({descriptor_->layout()}, {push_constant_range})
-      .SetShader(GetShaderBinaryPath("aurora/jump_flooding.comp"))
-      .Build();
+      .SetPipelineLayout(
+          {descriptor_->layout()},
+          {step_width_constant_->MakePerFrameRange(
+              VK_SHADER_STAGE_COMPUTE_BIT)})
+      .SetShader(GetShaderBinaryPath("aurora/jump_flooding_seed.comp"));
+  jump_flooding_pipeline_ =
+      pipeline_build_jobs->Add(std::move(jump_flooding_builder));
+
+  auto jump_flooding_tiled_builder =
+      std::make_unique<ComputePipelineBuilder>(context);
+  (*jump_flooding_tiled_builder)
+      .SetPipelineName("Jump flooding tiled")
+      .SetPipelineLayout(
+          {descriptor_->layout()},
+          {tiled_steps_constant_->MakePerFrameRange(
+              VK_SHADER_STAGE_COMPUTE_BIT)})
+      .SetShader(GetShaderBinaryPath("aurora/jump_flooding_tiled.comp"));
+  jump_flooding_tiled_pipeline_ =
+      pipeline_build_jobs->Add(std::move(jump_flooding_tiled_builder));
 
-  coord_to_dist_pipeline_ = ComputePipelineBuilder{context}
-      .SetPipelineName("Coordinate to distance")
+  auto seed_to_dist_builder = std::make_unique<ComputePipelineBuilder>(context);
+  (*seed_to_dist_builder)
+      .SetPipelineName("Seed to distance")
       .SetPipelineLayout({descriptor_->layout()}, /*push_constant_ranges=*/{})
-      .SetShader(GetShaderBinaryPath("aurora/coord_to_dist.comp"))
-      .Build();
+      .SetShader(GetShaderBinaryPath("aurora/seed_to_dist.comp"));
+  seed_to_dist_pipeline_ =
+      pipeline_build_jobs->Add(std::move(seed_to_dist_builder));
 }
 
 void DistanceFieldGenerator::Generate(const VkCommandBuffer& command_buffer) {
-  Dispatch(command_buffer, *path_to_coord_pipeline_, kInputToPing);
+  TransitionSeedImageLayouts(command_buffer);
+  Dispatch(command_buffer, *path_to_seed_pipeline_, kInputToPing,
+           work_group_count_);
+  InsertComputeBarrier(command_buffer);
 
-  Direction direction = kPingToPong;
-  for (int i = 0; i < num_steps_; ++i) {
+  bool is_result_in_ping = true;
+  for (int i = 0; i < num_separate_steps_; ++i) {
     step_width_constant_->Flush(
         command_buffer, jump_flooding_pipeline_->layout(), /*frame=*/i,
         /*target_offset=*/0, VK_SHADER_STAGE_COMPUTE_BIT);
-    Dispatch(command_buffer, *jump_flooding_pipeline_, direction);
-    direction = direction == kPingToPong ? kPongToPing : kPingToPong;
+    Dispatch(command_buffer, *jump_flooding_pipeline_,
+             is_result_in_ping ? kPingToPong : kPongToPing, work_group_count_);
+    InsertComputeBarrier(command_buffer);
+    is_result_in_ping = !is_result_in_ping;
   }
 
-  // Note that the final result has to be stored in the ping image, so
-  // 'direction' may need to be changed.
-  if (direction == kPingToPong) {
-    direction = kPingToPing;
+  if (has_tiled_steps_) {
+    tiled_steps_constant_->Flush(
+        command_buffer, jump_flooding_tiled_pipeline_->layout(), /*frame=*/0,
+        /*target_offset=*/0, VK_SHADER_STAGE_COMPUTE_BIT);
+    Dispatch(command_buffer, *jump_flooding_tiled_pipeline_,
+             is_result_in_ping ? kPingToPong : kPongToPing,
+             tiled_work_group_count_);
+    InsertComputeBarrier(command_buffer);
+    is_result_in_ping = !is_result_in_ping;
   }
-  Dispatch(command_buffer, *coord_to_dist_pipeline_, direction);
+
+  Dispatch(command_buffer, *seed_to_dist_pipeline_,
+           is_result_in_ping ? kPingToOutput : kPongToOutput,
+           work_group_count_);
 }
 
 void DistanceFieldGenerator::Dispatch(
     const VkCommandBuffer& command_buffer,
-    const Pipeline& pipeline, Direction direction) const {
+    const Pipeline& pipeline, Direction direction,
+    const VkExtent2D& work_group_count) const {
   pipeline.Bind(command_buffer);
   descriptor_->PushImageInfos(
       command_buffer, pipeline.layout(), pipeline.binding_point(),
       Image::GetDescriptorTypeForLinearAccess(), image_info_maps_[direction]);
-  vkCmdDispatch(command_buffer, work_group_count_.width,
-                work_group_count_.height, /*groupCountZ=*/1);
+  vkCmdDispatch(command_buffer, work_group_count.width,
+                work_group_count.height, /*groupCountZ=*/1);
+}
+
+void DistanceFieldGenerator::InsertComputeBarrier(
+    const VkCommandBuffer& command_buffer) {
+  const VkMemoryBarrier barrier{
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      /*pNext=*/nullptr,
+      VK_ACCESS_SHADER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(command_buffer,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       /*dependencyFlags=*/0,
+                       /*memoryBarrierCount=*/1, &barrier,
+                       /*bufferMemoryBarrierCount=*/0,
+                       /*pBufferMemoryBarriers=*/nullptr,
+                       /*imageMemoryBarrierCount=*/0,
+                       /*pImageMemoryBarriers=*/nullptr);
+}
+
+void DistanceFieldGenerator::TransitionSeedImageLayouts(
+    const VkCommandBuffer& command_buffer) const {
+  const VkImageLayout layout = image::GetImageLayout(
+      ImageUsage::GetLinearAccessInComputeShaderUsage(
+          ir::AccessType::kReadWrite));
+  std::vector<VkImageMemoryBarrier> barriers;
+  for (const auto* image : {ping_image_.get(), pong_image_.get()}) {
+    // Previous contents are never needed, so the old layout is undefined. The
+    // barrier also waits for the last reads of the previous generation.
+    barriers.push_back(VkImageMemoryBarrier{
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        /*pNext=*/nullptr,
+        /*srcAccessMask=*/0,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        /*oldLayout=*/VK_IMAGE_LAYOUT_UNDEFINED,
+        /*newLayout=*/layout,
+        /*srcQueueFamilyIndex=*/VK_QUEUE_FAMILY_IGNORED,
+        /*dstQueueFamilyIndex=*/VK_QUEUE_FAMILY_IGNORED,
+        image->image(),
+        VkImageSubresourceRange{
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            /*baseMipLevel=*/0,
+            /*levelCount=*/1,
+            /*baseArrayLayer=*/0,
+            /*layerCount=*/1,
+        },
+    });
+  }
+  vkCmdPipelineBarrier(command_buffer,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       /*dependencyFlags=*/0,
+                       /*memoryBarrierCount=*/0,
+                       /*pMemoryBarriers=*/nullptr,
+                       /*bufferMemoryBarrierCount=*/0,
+                       /*pBufferMemoryBarriers=*/nullptr,
+                       barriers.size(), barriers.data());
+}
+
+std::unique_ptr<TextureImage> LoadBakedDistanceField(
+    const SharedBasicContext& context, std::string_view path) {
+  const common::distance_transform::BakedDistanceField baked_field{path};
+  const auto image_usage = ImageUsage::GetSampledInFragmentShaderUsage();
+  const TextureImage::Info image_info{
+      {baked_field.half_distances().data()},
+      VK_FORMAT_R16_SFLOAT,
+      static_cast<uint32_t>(baked_field.width()),
+      static_cast<uint32_t>(baked_field.height()),
+      // Each pixel holds one half-precision float.
+      /*channel=*/sizeof(baked_field.half_distances()[0]),
+      absl::MakeSpan(&image_usage, 1),
+  };
+  return std::make_unique<TextureImage>(
+      context, /*generate_mipmaps=*/false,
+      ImageSampler::Config{VK_FILTER_LINEAR,
+                           VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE},
+      image_info);
 }
 
 } /* namespace aurora */
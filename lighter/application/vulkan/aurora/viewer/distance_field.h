@@ -9,11 +9,14 @@
 #define LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_DISTANCE_FIELD_H
 
 #include <memory>
+#include <string_view>
 
+#include "lighter/common/jump_flooding.h"
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "third_party/vulkan/vulkan.h"
 
 namespace lighter {
@@ -22,15 +25,37 @@ namespace vulkan {
 namespace aurora {
 
 // This class is used to generate distance field using jump flooding algorithm.
-// Internally, it uses the output image as ping buffer to save device memory.
-// The input image will not be modified.
+// Nearest seeds are stored as packed pixel coordinates in two internal images
+// used as ping-pong buffers, and converted to distances in the end. The input
+// image will not be modified. Results are consistent with the CPU reference in
+// lighter/common/jump_flooding.h.
 class DistanceFieldGenerator {
  public:
+  // Ways to perform steps of jump flooding.
+  enum class Mode {
+    // Each step is performed with a separate dispatch.
+    kSeparateDispatches,
+    // Steps with large widths are performed with separate dispatches, while
+    // steps with widths up to jump_flooding::kMaxTiledStepWidth are performed
+    // in one dispatch, where each work group keeps a 32x32 tile of the image
+    // and its apron in shared memory. Each work group loads about 2.1x (or
+    // 2.6x with refinement) as many pixels as it writes, see
+    // jump_flooding::GetTiledLoadFactor(), while separate dispatches would
+    // load and store each pixel 3 (or 5) times.
+    kTiled,
+  };
+
   // 'input_image' and 'output_image' must have the same size. The generated
-  // distance field will be written to 'output_image'.
-  DistanceFieldGenerator(const renderer::vulkan::SharedBasicContext& context,
-                         const renderer::vulkan::OffscreenImage& input_image,
-                         const renderer::vulkan::OffscreenImage& output_image);
+  // distance field will be written to 'output_image'. Pipelines are built with
+  // 'pipeline_build_jobs', and Generate() blocks until they are ready.
+  DistanceFieldGenerator(
+      const renderer::vulkan::SharedBasicContext& context,
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
+      const renderer::vulkan::OffscreenImage& input_image,
+      const renderer::vulkan::OffscreenImage& output_image,
+      Mode mode = Mode::kSeparateDispatches,
+      common::jump_flooding::Refinement refinement =
+          common::jump_flooding::Refinement::kNone);
 
   // This class is neither copyable nor movable.
   DistanceFieldGenerator(const DistanceFieldGenerator&) = delete;
@@ -44,36 +69,59 @@ class DistanceFieldGenerator {
   void Generate(const VkCommandBuffer& command_buffer);
 
  private:
-  // Directions when using ping-pong buffers.
+  // Directions of data flow between images.
   enum Direction {
     kInputToPing = 0,
     kPingToPong,
     kPongToPing,
-    kPingToPing,
+    kPingToOutput,
+    kPongToOutput,
     kNumDirections,
   };
 
-  // Invokes the compute shader.
+  // Invokes the compute shader with 'work_group_count'.
   void Dispatch(const VkCommandBuffer& command_buffer,
                 const renderer::vulkan::Pipeline& pipeline,
-                Direction direction) const;
+                Direction direction, const VkExtent2D& work_group_count) const;
+
+  // Makes writes of the previous dispatch visible to the next dispatch.
+  static void InsertComputeBarrier(const VkCommandBuffer& command_buffer);
 
-  // Number of work groups for invoking compute shaders.
+  // Transitions the layouts of internal images so that they can be linearly
+  // read/write in compute shaders. Their contents are discarded.
+  void TransitionSeedImageLayouts(const VkCommandBuffer& command_buffer) const;
+
+  // Number of work groups for invoking compute shaders. Each work group of the
+  // tiled dispatch handles a larger tile.
   const VkExtent2D work_group_count_;
+  const VkExtent2D tiled_work_group_count_;
+
+  // Number of steps performed with separate dispatches. Each of them uses one
+  // frame of 'step_width_constant_'.
+  int num_separate_steps_ = 0;
 
-  // Step widths increase exponentially: 1, 2, 4, 8, ..., image dimension.
-  int num_steps_ = 0;
+  // Whether the remaining steps are performed in one tiled dispatch.
+  bool has_tiled_steps_ = false;
 
   // Objects used for compute shaders.
   std::unique_ptr<renderer::vulkan::PushConstant> step_width_constant_;
+  std::unique_ptr<renderer::vulkan::PushConstant> tiled_steps_constant_;
+  std::unique_ptr<renderer::vulkan::OffscreenImage> ping_image_;
   std::unique_ptr<renderer::vulkan::OffscreenImage> pong_image_;
   renderer::vulkan::Descriptor::ImageInfoMap image_info_maps_[kNumDirections];
   std::unique_ptr<renderer::vulkan::DynamicDescriptor> descriptor_;
-  std::unique_ptr<renderer::vulkan::Pipeline> path_to_coord_pipeline_;
-  std::unique_ptr<renderer::vulkan::Pipeline> jump_flooding_pipeline_;
-  std::unique_ptr<renderer::vulkan::Pipeline> coord_to_dist_pipeline_;
+  renderer::vulkan::PipelineHandle path_to_seed_pipeline_;
+  renderer::vulkan::PipelineHandle jump_flooding_pipeline_;
+  renderer::vulkan::PipelineHandle jump_flooding_tiled_pipeline_;
+  renderer::vulkan::PipelineHandle seed_to_dist_pipeline_;
 };
 
+// Loads the distance field baked on the CPU with
+// common::distance_transform::SaveToFile(), which can be sampled in place of
+// the output image of DistanceFieldGenerator without recomputing it.
+std::unique_ptr<renderer::vulkan::TextureImage> LoadBakedDistanceField(
+    const renderer::vulkan::SharedBasicContext& context, std::string_view path);
+
 } /* namespace aurora */
 } /* namespace vulkan */
 } /* namespace application */
@@ -0,0 +1,368 @@
+//
+//  offline_renderer.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/application/vulkan/aurora/viewer/offline_renderer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "lighter/common/util.h"
+#include "third_party/absl/strings/match.h"
+#include "third_party/absl/strings/str_format.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "third_party/stb/stb_image_write.h"
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace aurora {
+namespace {
+
+namespace simd = common::simd;
+
+/* BEGIN: Consistent with constants defined in aurora.frag. */
+
+constexpr float kEarthRadius = 6378.1f;
+constexpr float kKm = 1.0f / kEarthRadius;
+constexpr float kAuroraMinHeight = 85.0f * kKm;
+constexpr float kAuroraMaxHeight = 300.0f * kKm;
+constexpr float kMinDt = 2.0f * kKm;
+constexpr float kAuroraScale = kMinDt / (40.0f * kKm);
+constexpr float kMissT = 100.0f;
+constexpr float kAirColorScale = 0.002f;
+constexpr float kAirColor[] = {0.4f * kAirColorScale, 0.5f * kAirColorScale,
+                               0.7f * kAirColorScale};
+constexpr float kGroundReflectance = 0.3f;
+
+/* END: Consistent with constants defined in aurora.frag. */
+
+// Tiles are squares with this side length in pixels.
+constexpr int kTileSize = 32;
+
+// Returns 'v' broadcast to all lanes.
+simd::Vec3 Broadcast(const glm::vec3& v) {
+  return {v.x, v.y, v.z};
+}
+
+// Returns 'if_true' for lanes where 'mask' is set, and 'if_false' otherwise.
+simd::Vec3 Select(const simd::Mask& mask, const simd::Vec3& if_true,
+                  const simd::Vec3& if_false) {
+  return {simd::Select(mask, if_true.x, if_false.x),
+          simd::Select(mask, if_true.y, if_false.y),
+          simd::Select(mask, if_true.z, if_false.z)};
+}
+
+// Returns the greater t value where rays starting from 'start' in 'direction'
+// intersect with the sphere centered at origin with 'radius', or kMissT if
+// rays totally miss. This is equivalent to GetSpanSphere(...).high in shaders.
+simd::Float GetSphereSpanHigh(const simd::Vec3& start,
+                              const simd::Vec3& direction, float radius) {
+  const simd::Float b = 2.0f * simd::Dot(start, direction);
+  const simd::Float c = simd::Dot(start, start) - radius * radius;
+  const simd::Float det = b * b - 4.0f * c;
+  // Lanes with negative 'det' produce NaN here, which are discarded.
+  const simd::Float high = (simd::Sqrt(det) - b) * 0.5f;
+  return simd::Select(det < 0.0f, kMissT, high);
+}
+
+} /* namespace */
+
+OfflineRenderer::Texture::Texture(const common::Image& image, int layer)
+    : width_{image.width()}, height_{image.height()},
+      channel_{image.channel()} {
+  const auto* data = static_cast<const uint8_t*>(image.GetDataPtrs()[layer]);
+  texels_.resize(width_ * height_ * channel_);
+  std::transform(data, data + texels_.size(), texels_.begin(),
+                 [](uint8_t value) { return value / 255.0f; });
+}
+
+OfflineRenderer::Texture::Texture(int width, int height,
+                                  absl::Span<const float> texels)
+    : width_{width}, height_{height}, channel_{1},
+      texels_{texels.begin(), texels.end()} {
+  ASSERT_TRUE(texels_.size() == width * height,
+              absl::StrFormat("Number of texels (%d) mismatches with texture "
+                              "size %dx%d", texels_.size(), width, height));
+}
+
+glm::vec4 OfflineRenderer::Texture::Fetch(int x, int y) const {
+  x = std::clamp(x, 0, width_ - 1);
+  y = std::clamp(y, 0, height_ - 1);
+  const float* texel = texels_.data() + (y * width_ + x) * channel_;
+  glm::vec4 value{0.0f};
+  for (int i = 0; i < channel_; ++i) {
+    value[i] = texel[i];
+  }
+  return value;
+}
+
+glm::vec4 OfflineRenderer::Texture::Sample(const glm::vec2& tex_coord) const {
+  // Texel centers are at half-integer coordinates, as specified by Vulkan.
+  const glm::vec2 coord = tex_coord * glm::vec2{width_, height_} - 0.5f;
+  const glm::vec2 floor_coord = glm::floor(coord);
+  const glm::vec2 weight = coord - floor_coord;
+  const int x = static_cast<int>(floor_coord.x);
+  const int y = static_cast<int>(floor_coord.y);
+  const glm::vec4 top = glm::mix(Fetch(x, y), Fetch(x + 1, y), weight.x);
+  const glm::vec4 bottom =
+      glm::mix(Fetch(x, y + 1), Fetch(x + 1, y + 1), weight.x);
+  return glm::mix(top, bottom, weight.y);
+}
+
+OfflineRenderer::Cubemap::Cubemap(const common::Image& image) {
+  ASSERT_TRUE(image.type() == common::Image::Type::kCubemap,
+              "Skybox image is not a cubemap");
+  faces_.reserve(common::image::kCubemapImageLayer);
+  for (int layer = 0; layer < common::image::kCubemapImageLayer; ++layer) {
+    faces_.push_back(Texture{image, layer});
+  }
+}
+
+glm::vec4 OfflineRenderer::Cubemap::Sample(const glm::vec3& direction) const {
+  // Select the face and compute texture coordinates as specified by Vulkan.
+  const glm::vec3 abs_dir = glm::abs(direction);
+  int face;
+  float sc, tc, ma;
+  if (abs_dir.x >= abs_dir.y && abs_dir.x >= abs_dir.z) {
+    face = direction.x > 0.0f ? 0 : 1;
+    sc = direction.x > 0.0f ? -direction.z : direction.z;
+    tc = -direction.y;
+    ma = abs_dir.x;
+  } else if (abs_dir.y >= abs_dir.z) {
+    face = direction.y > 0.0f ? 2 : 3;
+    sc = direction.x;
+    tc = direction.y > 0.0f ? direction.z : -direction.z;
+    ma = abs_dir.y;
+  } else {
+    face = direction.z > 0.0f ? 4 : 5;
+    sc = direction.z > 0.0f ? direction.x : -direction.x;
+    tc = -direction.y;
+    ma = abs_dir.z;
+  }
+  return faces_[face].Sample(
+      {(sc / ma + 1.0f) * 0.5f, (tc / ma + 1.0f) * 0.5f});
+}
+
+OfflineRenderer::OfflineRenderer(
+    const common::Image& aurora_deposition_image,
+    const common::Image& universe_skybox_image,
+    const common::air_transmit::TableConfig& air_transmit_table_config,
+    const PathsTextures& paths_textures)
+    : aurora_deposition_{aurora_deposition_image, /*layer=*/0},
+      aurora_paths_{*FATAL_IF_NULL(paths_textures.paths_image), /*layer=*/0},
+      distance_field_{paths_textures.paths_image->width(),
+                      paths_textures.paths_image->height(),
+                      paths_textures.distance_field},
+      air_transmit_table_{
+          air_transmit_table_config.num_altitude_samples,
+          air_transmit_table_config.num_cos_angle_samples,
+          common::air_transmit::LoadOrGenerateTable(
+              air_transmit_table_config)},
+      universe_skybox_{universe_skybox_image},
+      dump_paths_proj_view_{paths_textures.dump_paths_proj_view} {
+  ASSERT_TRUE(
+      paths_textures.paths_image->channel() == common::image::kBwImageChannel,
+      absl::StrFormat("Aurora paths image is expected to have one channel, "
+                      "while %d provided",
+                      paths_textures.paths_image->channel()));
+}
+
+OfflineRenderer::Frame OfflineRenderer::Render(
+    const common::PerspectiveCamera& camera, int width, int height,
+    common::ThreadPool* thread_pool) const {
+  ASSERT_TRUE(width > 0 && height > 0,
+              absl::StrFormat("Invalid frame size %dx%d", width, height));
+  Frame frame{width, height, std::vector<glm::vec3>(width * height)};
+  const auto params = camera.GetRayTracingParams();
+  const glm::vec3& camera_pos = camera.position();
+
+  const int num_tiles_x = (width + kTileSize - 1) / kTileSize;
+  const int num_tiles_y = (height + kTileSize - 1) / kTileSize;
+  const auto render_tile = [&](int tile_index) {
+    const int x_begin = tile_index % num_tiles_x * kTileSize;
+    const int y_begin = tile_index / num_tiles_x * kTileSize;
+    RenderTile(params, camera_pos, x_begin,
+               std::min(x_begin + kTileSize, width), y_begin,
+               std::min(y_begin + kTileSize, height), &frame);
+  };
+  const int num_tiles = num_tiles_x * num_tiles_y;
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < num_tiles; ++i) {
+      render_tile(i);
+    }
+  } else {
+    thread_pool->ParallelFor(num_tiles, render_tile);
+  }
+  return frame;
+}
+
+void OfflineRenderer::RenderTile(
+    const common::PerspectiveCamera::RayTracingParams& params,
+    const glm::vec3& camera_pos, int x_begin, int x_end, int y_begin, int y_end,
+    Frame* frame) const {
+  const simd::Vec3 up = Broadcast(params.up);
+  const simd::Vec3 front = Broadcast(params.front);
+  const simd::Vec3 right = Broadcast(params.right);
+
+  float ndc_x[simd::kWidth];
+  float colors[3][simd::kWidth];
+  for (int y = y_begin; y < y_end; ++y) {
+    // The viewport is flipped when presenting, hence the top row of the frame
+    // has NDC y coordinate 1.
+    const float ndc_y =
+        1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / frame->height;
+    for (int x = x_begin; x < x_end; x += simd::kWidth) {
+      for (int i = 0; i < simd::kWidth; ++i) {
+        ndc_x[i] =
+            2.0f * (static_cast<float>(x + i) + 0.5f) / frame->width - 1.0f;
+      }
+      const simd::Vec3 frag_dirs =
+          right * simd::Float::Load(ndc_x) + up * ndc_y + front;
+      const simd::Vec3 packet_colors = ShadePacket(camera_pos, frag_dirs);
+      packet_colors.x.Store(colors[0]);
+      packet_colors.y.Store(colors[1]);
+      packet_colors.z.Store(colors[2]);
+
+      const int num_pixels = std::min(simd::kWidth, x_end - x);
+      for (int i = 0; i < num_pixels; ++i) {
+        frame->pixels[y * frame->width + x + i] =
+            glm::vec3{colors[0][i], colors[1][i], colors[2][i]};
+      }
+    }
+  }
+}
+
+simd::Vec3 OfflineRenderer::ShadePacket(const glm::vec3& camera_pos,
+                                        const simd::Vec3& frag_dirs) const {
+  // Compute intersection with planet itself. If view rays hit ground, create
+  // the reflection effect.
+  const simd::Vec3 normal = Broadcast(glm::normalize(camera_pos));
+  simd::Vec3 dirs = simd::Normalize(frag_dirs);
+  const simd::Float cos_angle = simd::Dot(dirs, normal);
+  const simd::Mask hits_ground = cos_angle < 0.0f;
+  dirs = Select(hits_ground, dirs - normal * (2.0f * cos_angle), dirs);
+
+  // Sample view rays when they travel from 'kAuroraMinHeight' to
+  // 'kAuroraMaxHeight'. Lanes are sampled until all of them finish, and lanes
+  // that have finished stay unchanged.
+  const simd::Vec3 start = Broadcast(camera_pos);
+  const simd::Float min_t =
+      GetSphereSpanHigh(start, dirs, 1.0f + kAuroraMinHeight);
+  const simd::Float max_t =
+      GetSphereSpanHigh(start, dirs, 1.0f + kAuroraMaxHeight);
+  simd::Float t = simd::Max(min_t, 0.0f);
+  simd::Vec3 aurora_color{0.0f, 0.0f, 0.0f};
+
+  const glm::mat4& proj_view = dump_paths_proj_view_;
+  float tex_coords_x[simd::kWidth], tex_coords_y[simd::kWidth];
+  float heights[simd::kWidth];
+  float samples[3][simd::kWidth], half_dists[simd::kWidth];
+  for (simd::Mask active = t < max_t; active.ToBits() != 0;
+       active = active & (t < max_t)) {
+    const simd::Vec3 points = start + dirs * t;
+
+    // Project points to the plane of aurora paths texture. Note that glm
+    // matrices are column-major.
+    const auto project = [&proj_view, &points](int row) {
+      return points.x * proj_view[0][row] + points.y * proj_view[1][row] +
+             points.z * proj_view[2][row] + proj_view[3][row];
+    };
+    const simd::Float projected_w = project(3);
+    ((project(0) / projected_w + 1.0f) * 0.5f).Store(tex_coords_x);
+    ((project(1) / projected_w + 1.0f) * 0.5f).Store(tex_coords_y);
+    // Subtract off radius of planet since deposition texture starts from
+    // ground.
+    (simd::Length(points) - 1.0f).Store(heights);
+
+    // Texture lookups are performed per lane.
+    const int active_bits = active.ToBits();
+    for (int i = 0; i < simd::kWidth; ++i) {
+      if ((active_bits & (1 << i)) == 0) {
+        samples[0][i] = samples[1][i] = samples[2][i] = half_dists[i] = 0.0f;
+        continue;
+      }
+      const glm::vec2 tex_coord{tex_coords_x[i], tex_coords_y[i]};
+      const float paths_intensity = aurora_paths_.Sample(tex_coord).r;
+      const glm::vec4 deposition = aurora_deposition_.Sample(
+          {0.4f, heights[i] / kAuroraMaxHeight});
+      for (int c = 0; c < 3; ++c) {
+        samples[c][i] = deposition[c] * paths_intensity;
+      }
+      half_dists[i] = 0.5f * distance_field_.Sample(tex_coord).r;
+    }
+    aurora_color.x = aurora_color.x + simd::Float::Load(samples[0]);
+    aurora_color.y = aurora_color.y + simd::Float::Load(samples[1]);
+    aurora_color.z = aurora_color.z + simd::Float::Load(samples[2]);
+    const simd::Float dt = simd::Max(simd::Float::Load(half_dists), kMinDt);
+    t = t + simd::Select(active, dt, 0.0f);
+  }
+  aurora_color = aurora_color * kAuroraScale;
+
+  // We need to take atmosphere (i.e. thickness of air) into consideration.
+  const float air_transmit_x = (glm::length(camera_pos) - 1.0f) /
+                               common::air_transmit::kAirMaxHeight;
+  float abs_cos_angles[simd::kWidth];
+  float air_transmits[simd::kWidth];
+  float backgrounds[3][simd::kWidth];
+  float dirs_x[simd::kWidth], dirs_y[simd::kWidth], dirs_z[simd::kWidth];
+  simd::Max(cos_angle, 0.0f - cos_angle).Store(abs_cos_angles);
+  dirs.x.Store(dirs_x);
+  dirs.y.Store(dirs_y);
+  dirs.z.Store(dirs_z);
+  for (int i = 0; i < simd::kWidth; ++i) {
+    air_transmits[i] =
+        air_transmit_table_.Sample({air_transmit_x, abs_cos_angles[i]}).r;
+    const glm::vec4 background =
+        universe_skybox_.Sample({dirs_x[i], dirs_y[i], dirs_z[i]});
+    for (int c = 0; c < 3; ++c) {
+      backgrounds[c][i] = background[c];
+    }
+  }
+
+  const simd::Float air_transmit = simd::Float::Load(air_transmits);
+  const simd::Float air_opacity = 1.0f - air_transmit;
+  const simd::Vec3 foreground =
+      aurora_color * air_transmit +
+      simd::Vec3{kAirColor[0], kAirColor[1], kAirColor[2]} * air_opacity;
+  const simd::Vec3 background{simd::Float::Load(backgrounds[0]),
+                              simd::Float::Load(backgrounds[1]),
+                              simd::Float::Load(backgrounds[2])};
+  const simd::Vec3 color =
+      foreground + background * (1.0f - simd::Length(foreground));
+
+  // Assume reflectance is 0.3.
+  return Select(hits_ground, color * kGroundReflectance, color);
+}
+
+void OfflineRenderer::WriteFrame(const Frame& frame, const std::string& path) {
+  static_assert(sizeof(glm::vec3) == sizeof(float) * 3,
+                "glm::vec3 is expected to be tightly packed");
+  constexpr int kNumChannels = 3;
+  int result;
+  if (absl::EndsWith(path, ".hdr")) {
+    result = stbi_write_hdr(path.c_str(), frame.width, frame.height,
+                            kNumChannels, &frame.pixels[0].x);
+  } else {
+    std::vector<uint8_t> bytes(frame.pixels.size() * kNumChannels);
+    for (int i = 0; i < frame.pixels.size(); ++i) {
+      for (int c = 0; c < kNumChannels; ++c) {
+        bytes[i * kNumChannels + c] = static_cast<uint8_t>(glm::round(
+            glm::clamp(frame.pixels[i][c], 0.0f, 1.0f) * 255.0f));
+      }
+    }
+    result = stbi_write_png(path.c_str(), frame.width, frame.height,
+                            kNumChannels, bytes.data(),
+                            /*stride_in_bytes=*/frame.width * kNumChannels);
+  }
+  ASSERT_TRUE(result != 0, absl::StrFormat("Failed to write '%s'", path));
+}
+
+} /* namespace aurora */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
@@ -0,0 +1,148 @@
+//
+//  offline_renderer.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_OFFLINE_RENDERER_H
+#define LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_OFFLINE_RENDERER_H
+
+#include <string>
+#include <vector>
+
+#include "lighter/common/air_transmit.h"
+#include "lighter/common/camera.h"
+#include "lighter/common/image.h"
+#include "lighter/common/simd.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/absl/types/span.h"
+#include "third_party/glm/glm.hpp"
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace aurora {
+
+// This class renders the aurora viewer scene on the CPU, so that stills and
+// sequences can be rendered without a GPU. It ports the integrator in
+// aurora.frag, and results match the GPU output up to differences of texture
+// filtering precision.
+// The image is divided into tiles, which are rendered on a thread pool with
+// work stealing. Within a tile, rays are traced in packets of
+// common::simd::kWidth, i.e. 8 rays with AVX.
+class OfflineRenderer {
+ public:
+  // Textures that depend on aurora paths.
+  struct PathsTextures {
+    // Aurora paths dumped with 'dump_paths_proj_view', with one channel. Rows
+    // are in the same order as the GPU image memory.
+    const common::Image* paths_image;
+
+    // Distance field of 'paths_image', with the same size and in the same
+    // row order.
+    absl::Span<const float> distance_field;
+
+    // Projection-view matrix of the camera used to dump aurora paths.
+    glm::mat4 dump_paths_proj_view;
+  };
+
+  // Rendered frame in linear RGB.
+  struct Frame {
+    int width;
+    int height;
+    std::vector<glm::vec3> pixels;
+  };
+
+  // 'aurora_deposition_image' and 'universe_skybox_image' are the same
+  // textures used by the viewer. 'air_transmit_table_config' is the same as
+  // the one passed to the viewer.
+  OfflineRenderer(
+      const common::Image& aurora_deposition_image,
+      const common::Image& universe_skybox_image,
+      const common::air_transmit::TableConfig& air_transmit_table_config,
+      const PathsTextures& paths_textures);
+
+  // This class is neither copyable nor movable.
+  OfflineRenderer(const OfflineRenderer&) = delete;
+  OfflineRenderer& operator=(const OfflineRenderer&) = delete;
+
+  // Renders the scene viewed from 'camera' into a frame of 'width' * 'height'
+  // pixels. If 'thread_pool' is not nullptr, tiles will be rendered in
+  // parallel on it.
+  Frame Render(const common::PerspectiveCamera& camera, int width, int height,
+               common::ThreadPool* thread_pool) const;
+
+  // Writes 'frame' to 'path'. If 'path' ends with ".hdr", it is written as a
+  // Radiance HDR image with linear values. Otherwise, it is written as a PNG
+  // image, where values are clamped and quantized in the same way as the
+  // swapchain image. This throws an exception if failed to write.
+  static void WriteFrame(const Frame& frame, const std::string& path);
+
+ private:
+  // A texture sampled with bilinear filtering. Texture coordinates out of
+  // range [0.0, 1.0] are clamped to edge, same as samplers used by the viewer.
+  // Texels are converted to floats in range [0.0, 1.0] in advance.
+  class Texture {
+   public:
+    // Loads the 'layer' of 'image', where each texel has 'image.channel()'
+    // bytes.
+    Texture(const common::Image& image, int layer);
+
+    // Loads texels stored as floats with one channel.
+    Texture(int width, int height, absl::Span<const float> texels);
+
+    // Returns the filtered value at 'tex_coord'. Channels that the texture
+    // does not have are set to 0.
+    glm::vec4 Sample(const glm::vec2& tex_coord) const;
+
+   private:
+    // Returns the texel at ('x', 'y') after clamping to edge.
+    glm::vec4 Fetch(int x, int y) const;
+
+    int width_;
+    int height_;
+    int channel_;
+    std::vector<float> texels_;
+  };
+
+  // A cubemap whose faces are sampled with bilinear filtering.
+  class Cubemap {
+   public:
+    explicit Cubemap(const common::Image& image);
+
+    // Returns the filtered value in 'direction'.
+    glm::vec4 Sample(const glm::vec3& direction) const;
+
+   private:
+    std::vector<Texture> faces_;
+  };
+
+  // Renders pixels in [x_begin, x_end) * [y_begin, y_end) into 'frame'.
+  void RenderTile(const common::PerspectiveCamera::RayTracingParams& params,
+                  const glm::vec3& camera_pos, int x_begin, int x_end,
+                  int y_begin, int y_end, Frame* frame) const;
+
+  // Traces rays starting from 'camera_pos' in 'frag_dirs', which need not be
+  // normalized, and returns colors of them. This is equivalent to the main()
+  // of aurora.frag.
+  common::simd::Vec3 ShadePacket(const glm::vec3& camera_pos,
+                                 const common::simd::Vec3& frag_dirs) const;
+
+  // Textures used by the integrator.
+  const Texture aurora_deposition_;
+  const Texture aurora_paths_;
+  const Texture distance_field_;
+  const Texture air_transmit_table_;
+  const Cubemap universe_skybox_;
+
+  // Projection-view matrix of the camera used to dump aurora paths.
+  const glm::mat4 dump_paths_proj_view_;
+};
+
+} /* namespace aurora */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+#endif /* LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_OFFLINE_RENDERER_H */
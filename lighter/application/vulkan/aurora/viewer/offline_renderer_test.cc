@@ -0,0 +1,418 @@
+//
+//  offline_renderer_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/application/vulkan/aurora/viewer/offline_renderer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lighter/common/air_transmit.h"
+#include "lighter/common/camera.h"
+#include "lighter/common/image.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/absl/flags/declare.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/glm/glm.hpp"
+
+ABSL_DECLARE_FLAG(bool, use_air_transmit_cache);
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace aurora {
+namespace {
+
+/* BEGIN: Consistent with constants defined in aurora.frag. */
+
+constexpr float kEarthRadius = 6378.1f;
+constexpr float kKm = 1.0f / kEarthRadius;
+constexpr float kAuroraMinHeight = 85.0f * kKm;
+constexpr float kAuroraMaxHeight = 300.0f * kKm;
+constexpr float kMinDt = 2.0f * kKm;
+constexpr float kAuroraScale = kMinDt / (40.0f * kKm);
+constexpr float kMissT = 100.0f;
+constexpr float kAirColorScale = 0.002f;
+const glm::vec3 kAirColor{0.4f * kAirColorScale, 0.5f * kAirColorScale,
+                          0.7f * kAirColorScale};
+constexpr float kGroundReflectance = 0.3f;
+
+/* END: Consistent with constants defined in aurora.frag. */
+
+constexpr common::air_transmit::TableConfig kAirTransmitTableConfig{
+    /*num_cos_angle_samples=*/64, /*num_altitude_samples=*/4};
+constexpr int kPathsImageDimension = 64;
+constexpr int kDepositionImageHeight = 32;
+constexpr int kSkyboxImageDimension = 4;
+// Each channel is a multiple of 1/255, so that it is not changed when stored
+// in the image.
+const glm::vec4 kSkyboxColor{13.0f / 255.0f, 26.0f / 255.0f, 51.0f / 255.0f,
+                             1.0f};
+
+// Frame size is intentionally not a multiple of SIMD width or the tile size.
+constexpr int kFrameWidth = 45;
+constexpr int kFrameHeight = 29;
+
+// Maximum difference of each channel between the packet integrator and the
+// scalar reference. Lanes perform almost the same operations as the reference,
+// hence differences only come from rounding, such as the order of operations
+// when glm multiplies matrices.
+constexpr float kReferenceTolerance = 1E-5f;
+
+// Texture sampled with bilinear filtering and clamped to edge, as specified by
+// Vulkan. This is the reference of OfflineRenderer::Texture.
+class ReferenceTexture {
+ public:
+  ReferenceTexture(int width, int height, int channel,
+                   std::vector<float>&& texels)
+      : width_{width}, height_{height}, channel_{channel},
+        texels_{std::move(texels)} {}
+
+  glm::vec4 Sample(const glm::vec2& tex_coord) const {
+    const glm::vec2 coord = tex_coord * glm::vec2{width_, height_} - 0.5f;
+    const glm::vec2 floor_coord = glm::floor(coord);
+    const glm::vec2 weight = coord - floor_coord;
+    const int x = static_cast<int>(floor_coord.x);
+    const int y = static_cast<int>(floor_coord.y);
+    const glm::vec4 top = glm::mix(Fetch(x, y), Fetch(x + 1, y), weight.x);
+    const glm::vec4 bottom =
+        glm::mix(Fetch(x, y + 1), Fetch(x + 1, y + 1), weight.x);
+    return glm::mix(top, bottom, weight.y);
+  }
+
+ private:
+  glm::vec4 Fetch(int x, int y) const {
+    x = std::clamp(x, 0, width_ - 1);
+    y = std::clamp(y, 0, height_ - 1);
+    glm::vec4 value{0.0f};
+    for (int i = 0; i < channel_; ++i) {
+      value[i] = texels_[(y * width_ + x) * channel_ + i];
+    }
+    return value;
+  }
+
+  int width_;
+  int height_;
+  int channel_;
+  std::vector<float> texels_;
+};
+
+// Returns texels of 'image' converted to floats in range [0.0, 1.0].
+std::vector<float> ToFloats(const common::Image& image) {
+  const auto* data = static_cast<const uint8_t*>(image.GetDataPtrs()[0]);
+  std::vector<float> texels(image.width() * image.height() * image.channel());
+  for (int i = 0; i < texels.size(); ++i) {
+    texels[i] = data[i] / 255.0f;
+  }
+  return texels;
+}
+
+// A small scene with synthetic textures. The skybox has one color, so that the
+// reference does not need to sample cubemaps.
+struct TestScene {
+  TestScene()
+      : paths_image{CreatePathsImage()},
+        deposition_image{CreateDepositionImage()},
+        skybox_image{CreateSkyboxImage()} {
+    distance_field = ComputeDistanceField(paths_image);
+
+    const glm::vec3 viewpoint =
+        glm::normalize(glm::vec3{0.3f, 0.9f, 0.3f});
+    const glm::vec3 axis{0.0f, 1.0f, 0.0f};
+    common::Camera::Config dump_config;
+    dump_config.far = 2.0f;
+    dump_config.up = axis;
+    dump_config.position = glm::vec3{0.0f};
+    dump_config.look_at = viewpoint;
+    const common::PerspectiveCamera dump_camera{
+        dump_config, {/*field_of_view_y=*/40.0f, /*aspect_ratio=*/1.0f}};
+    dump_paths_proj_view =
+        dump_camera.GetProjectionMatrix() * dump_camera.GetViewMatrix();
+
+    // Look at the north horizon, so that some rays hit the ground.
+    const glm::vec3 right = glm::cross(axis, viewpoint);
+    const glm::vec3 north = glm::normalize(glm::cross(viewpoint, right));
+    common::Camera::Config view_config;
+    view_config.far = 2.0f;
+    view_config.up = viewpoint;
+    view_config.position = viewpoint;
+    view_config.look_at = viewpoint + north;
+    view_camera = std::make_unique<common::PerspectiveCamera>(
+        view_config, common::PerspectiveCamera::FrustumConfig{
+            /*field_of_view_y=*/45.0f,
+            static_cast<float>(kFrameWidth) / kFrameHeight});
+  }
+
+  // Concentric rings, which are thick enough to be hit by marching rays.
+  static common::Image CreatePathsImage() {
+    std::vector<uint8_t> texels(kPathsImageDimension * kPathsImageDimension);
+    const glm::vec2 center{kPathsImageDimension * 0.5f};
+    for (int y = 0; y < kPathsImageDimension; ++y) {
+      for (int x = 0; x < kPathsImageDimension; ++x) {
+        const float dist = glm::length(glm::vec2{x, y} - center);
+        const bool is_on_path = static_cast<int>(dist) % 12 < 3;
+        texels[y * kPathsImageDimension + x] = is_on_path ? 255 : 0;
+      }
+    }
+    return common::Image::LoadSingleImageFromMemory(
+        {kPathsImageDimension, kPathsImageDimension,
+         common::image::kBwImageChannel},
+        texels.data(), /*flip_y=*/false);
+  }
+
+  // Returns the distance from each pixel to the nearest path pixel, where
+  // coordinates are normalized by image dimensions. This is computed by brute
+  // force, since the image is small.
+  static std::vector<float> ComputeDistanceField(
+      const common::Image& paths_image) {
+    const auto* raster =
+        static_cast<const uint8_t*>(paths_image.GetDataPtrs()[0]);
+    const float dimension = kPathsImageDimension;
+    std::vector<glm::vec2> path_pixels;
+    for (int y = 0; y < kPathsImageDimension; ++y) {
+      for (int x = 0; x < kPathsImageDimension; ++x) {
+        if (raster[y * kPathsImageDimension + x] != 0) {
+          path_pixels.push_back(glm::vec2{x, y} / dimension);
+        }
+      }
+    }
+
+    std::vector<float> distances;
+    distances.reserve(kPathsImageDimension * kPathsImageDimension);
+    for (int y = 0; y < kPathsImageDimension; ++y) {
+      for (int x = 0; x < kPathsImageDimension; ++x) {
+        const glm::vec2 pixel = glm::vec2{x, y} / dimension;
+        float min_distance = std::numeric_limits<float>::max();
+        for (const auto& path_pixel : path_pixels) {
+          min_distance =
+              std::min(min_distance, glm::length(pixel - path_pixel));
+        }
+        distances.push_back(min_distance);
+      }
+    }
+    return distances;
+  }
+
+  // Color varies with height, and it is the same across columns.
+  static common::Image CreateDepositionImage() {
+    constexpr int kWidth = 2;
+    std::vector<uint8_t> texels(kWidth * kDepositionImageHeight *
+                                common::image::kRgbaImageChannel);
+    for (int y = 0; y < kDepositionImageHeight; ++y) {
+      const int intensity = 255 - y * 255 / kDepositionImageHeight;
+      for (int x = 0; x < kWidth; ++x) {
+        uint8_t* texel = &texels[(y * kWidth + x) *
+                                 common::image::kRgbaImageChannel];
+        texel[0] = intensity / 4;
+        texel[1] = intensity;
+        texel[2] = intensity / 2;
+        texel[3] = 255;
+      }
+    }
+    return common::Image::LoadSingleImageFromMemory(
+        {kWidth, kDepositionImageHeight, common::image::kRgbaImageChannel},
+        texels.data(), /*flip_y=*/false);
+  }
+
+  static common::Image CreateSkyboxImage() {
+    std::vector<uint8_t> texels;
+    for (int i = 0; i < kSkyboxImageDimension * kSkyboxImageDimension; ++i) {
+      for (int c = 0; c < common::image::kRgbaImageChannel; ++c) {
+        texels.push_back(
+            static_cast<uint8_t>(glm::round(kSkyboxColor[c] * 255.0f)));
+      }
+    }
+    const std::vector<const void*> faces(common::image::kCubemapImageLayer,
+                                         texels.data());
+    return common::Image::LoadCubemapFromMemory(
+        {kSkyboxImageDimension, kSkyboxImageDimension,
+         common::image::kRgbaImageChannel},
+        faces, /*flip_y=*/false);
+  }
+
+  std::unique_ptr<OfflineRenderer> CreateRenderer() const {
+    return std::make_unique<OfflineRenderer>(
+        deposition_image, skybox_image, kAirTransmitTableConfig,
+        OfflineRenderer::PathsTextures{&paths_image, distance_field,
+                                       dump_paths_proj_view});
+  }
+
+  common::Image paths_image;
+  common::Image deposition_image;
+  common::Image skybox_image;
+  std::vector<float> distance_field;
+  glm::mat4 dump_paths_proj_view;
+  std::unique_ptr<common::PerspectiveCamera> view_camera;
+};
+
+// Returns the greater t value where the ray intersects with the sphere
+// centered at origin with 'radius', or kMissT if it misses.
+float GetSphereSpanHigh(const glm::vec3& start, const glm::vec3& direction,
+                        float radius) {
+  const float b = 2.0f * glm::dot(start, direction);
+  const float c = glm::dot(start, start) - radius * radius;
+  const float det = b * b - 4.0f * c;
+  return det < 0.0f ? kMissT : (glm::sqrt(det) - b) * 0.5f;
+}
+
+// Renders 'scene' one pixel at a time. This is a straightforward port of
+// aurora.frag, which is the reference of the packet integrator.
+class ScalarRenderer {
+ public:
+  explicit ScalarRenderer(const TestScene& scene)
+      : scene_{scene},
+        paths_{kPathsImageDimension, kPathsImageDimension,
+               common::image::kBwImageChannel, ToFloats(scene.paths_image)},
+        distance_field_{kPathsImageDimension, kPathsImageDimension,
+                        /*channel=*/1,
+                        std::vector<float>{scene.distance_field}},
+        deposition_{scene.deposition_image.width(),
+                    scene.deposition_image.height(),
+                    scene.deposition_image.channel(),
+                    ToFloats(scene.deposition_image)},
+        air_transmit_table_{
+            kAirTransmitTableConfig.num_altitude_samples,
+            kAirTransmitTableConfig.num_cos_angle_samples, /*channel=*/1,
+            common::air_transmit::LoadOrGenerateTable(
+                kAirTransmitTableConfig)} {}
+
+  OfflineRenderer::Frame Render() const {
+    const auto& camera = *scene_.view_camera;
+    const auto params = camera.GetRayTracingParams();
+    OfflineRenderer::Frame frame{kFrameWidth, kFrameHeight,
+                                 std::vector<glm::vec3>(kFrameWidth *
+                                                        kFrameHeight)};
+    for (int y = 0; y < kFrameHeight; ++y) {
+      const float ndc_y =
+          1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / kFrameHeight;
+      for (int x = 0; x < kFrameWidth; ++x) {
+        const float ndc_x =
+            2.0f * (static_cast<float>(x) + 0.5f) / kFrameWidth - 1.0f;
+        const glm::vec3 frag_dir =
+            params.right * ndc_x + params.up * ndc_y + params.front;
+        frame.pixels[y * kFrameWidth + x] =
+            ShadePixel(camera.position(), frag_dir);
+      }
+    }
+    return frame;
+  }
+
+ private:
+  glm::vec3 ShadePixel(const glm::vec3& camera_pos,
+                       const glm::vec3& frag_dir) const {
+    const glm::vec3 normal = glm::normalize(camera_pos);
+    glm::vec3 dir = glm::normalize(frag_dir);
+    const float cos_angle = glm::dot(dir, normal);
+    const bool hits_ground = cos_angle < 0.0f;
+    if (hits_ground) {
+      dir = dir - normal * (2.0f * cos_angle);
+    }
+
+    const float min_t =
+        GetSphereSpanHigh(camera_pos, dir, 1.0f + kAuroraMinHeight);
+    const float max_t =
+        GetSphereSpanHigh(camera_pos, dir, 1.0f + kAuroraMaxHeight);
+    glm::vec3 aurora_color{0.0f};
+    for (float t = glm::max(min_t, 0.0f); t < max_t;) {
+      const glm::vec3 point = camera_pos + dir * t;
+      const glm::vec4 projected =
+          scene_.dump_paths_proj_view * glm::vec4{point, 1.0f};
+      const glm::vec2 tex_coord =
+          (glm::vec2{projected} / projected.w + 1.0f) * 0.5f;
+      const float height = glm::length(point) - 1.0f;
+      aurora_color +=
+          glm::vec3{deposition_.Sample({0.4f, height / kAuroraMaxHeight})} *
+          paths_.Sample(tex_coord).r;
+      t += glm::max(0.5f * distance_field_.Sample(tex_coord).r, kMinDt);
+    }
+    aurora_color *= kAuroraScale;
+
+    const float air_transmit = air_transmit_table_.Sample(
+        {(glm::length(camera_pos) - 1.0f) /
+             common::air_transmit::kAirMaxHeight,
+         glm::abs(cos_angle)}).r;
+    const glm::vec3 foreground =
+        aurora_color * air_transmit + kAirColor * (1.0f - air_transmit);
+    const glm::vec3 background{kSkyboxColor};
+    const glm::vec3 color =
+        foreground + background * (1.0f - glm::length(foreground));
+    return hits_ground ? color * kGroundReflectance : color;
+  }
+
+  const TestScene& scene_;
+  const ReferenceTexture paths_;
+  const ReferenceTexture distance_field_;
+  const ReferenceTexture deposition_;
+  const ReferenceTexture air_transmit_table_;
+};
+
+// Expects each channel of 'frame' to be within 'tolerance' of 'expected'.
+void ExpectFramesNear(const OfflineRenderer::Frame& frame,
+                      const OfflineRenderer::Frame& expected,
+                      float tolerance) {
+  ASSERT_EQ(frame.width, expected.width);
+  ASSERT_EQ(frame.height, expected.height);
+  for (int i = 0; i < frame.pixels.size(); ++i) {
+    for (int c = 0; c < 3; ++c) {
+      ASSERT_NEAR(frame.pixels[i][c], expected.pixels[i][c], tolerance)
+          << "Pixel (" << i % frame.width << ", " << i / frame.width
+          << "), channel " << c;
+    }
+  }
+}
+
+class OfflineRendererTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    // The test should not depend on files left by other runs.
+    absl::SetFlag(&FLAGS_use_air_transmit_cache, false);
+  }
+};
+
+TEST_F(OfflineRendererTest, MatchesScalarReference) {
+  const TestScene scene;
+  const auto renderer = scene.CreateRenderer();
+  const auto expected = ScalarRenderer{scene}.Render();
+
+  const auto frame = renderer->Render(*scene.view_camera, kFrameWidth,
+                                      kFrameHeight, /*thread_pool=*/nullptr);
+  ExpectFramesNear(frame, expected, kReferenceTolerance);
+
+  // The scene should cover all branches of the integrator.
+  int num_ground_pixels = 0;
+  int num_aurora_pixels = 0;
+  for (const auto& pixel : expected.pixels) {
+    if (glm::all(glm::lessThan(pixel, glm::vec3{kSkyboxColor} * 0.5f))) {
+      ++num_ground_pixels;
+    } else if (pixel.g > kSkyboxColor.g + 0.01f) {
+      ++num_aurora_pixels;
+    }
+  }
+  EXPECT_GT(num_ground_pixels, 0);
+  EXPECT_GT(num_aurora_pixels, 0);
+}
+
+TEST_F(OfflineRendererTest, ParallelMatchesSerial) {
+  const TestScene scene;
+  const auto renderer = scene.CreateRenderer();
+  common::ThreadPool thread_pool{/*num_threads=*/4};
+  const auto serial = renderer->Render(*scene.view_camera, kFrameWidth,
+                                       kFrameHeight, /*thread_pool=*/nullptr);
+  const auto parallel = renderer->Render(*scene.view_camera, kFrameWidth,
+                                         kFrameHeight, &thread_pool);
+  ExpectFramesNear(parallel, serial, /*tolerance=*/0.0f);
+}
+
+} /* namespace */
+} /* namespace aurora */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
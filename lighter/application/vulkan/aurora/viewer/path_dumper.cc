@@ -25,88 +25,137 @@ namespace {
 using namespace renderer;
 using namespace renderer::vulkan;
 using ir::AccessType;
+using ir::FrameGraph;
 
-// To save device memory, we reuse images in this way:
+// To save device memory, we reuse images of one dump target in this way:
 //   - Render paths: [output] distance_field_image
 //   - Bold paths: [input] distance_field_image
 //                 [output] paths_image
 //   - Generate distance field: [input] paths_image
 //                              [output] distance_field_image
-// Note that 'paths_image_' has one channel, while 'distance_field_image_' has
-// four channels.
-enum SubpassIndex {
-  kBoldPathsSubpassIndex = 0,
-  kGenerateDistanceFieldSubpassIndex,
-  kNumSubpasses,
-};
+// Note that 'paths_image' has one channel, while 'distance_field_image' has
+// four channels. These passes are scheduled by a frame graph, which inserts
+// barriers between them, and hands over images to the consumer (the viewer
+// renderer samples them in fragment shaders) at the end.
 
 } /* namespace */
 
-const std::string PathDumper::paths_image_name_ = "Aurora paths";
-const std::string PathDumper::distance_field_image_name_ = "Distance field";
-
 PathDumper::PathDumper(
     SharedBasicContext context, int paths_image_dimension,
-    std::vector<const PerVertexBuffer*>&& aurora_paths_vertex_buffers)
+    std::vector<const PerVertexBuffer*>&& aurora_paths_vertex_buffers,
+    bool generates_distance_field)
     : context_{std::move(FATAL_IF_NULL(context))} {
   ASSERT_TRUE(common::util::IsPowerOf2(paths_image_dimension),
               absl::StrFormat("'paths_image_dimension' is expected to be power "
                               "of 2, while %d provided",
                               paths_image_dimension));
 
+  /* Frame graph */
+  const auto sampled_usage = ImageUsage::GetSampledInFragmentShaderUsage();
+  const auto render_target_usage =
+      ImageUsage::GetMultisampleResolveTargetUsage();
+  const auto read_usage =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadOnly);
+  const auto write_usage =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+  const auto read_write_usage =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadWrite);
+
+  // Images are sampled by the consumer before and after dumping. Note that the
+  // content is discarded before the first write, hence it doesn't matter if
+  // images have never been sampled.
+  FrameGraph frame_graph;
+  paths_image_handle_ = frame_graph.ImportImage(
+      "Aurora paths", /*initial_usage=*/sampled_usage,
+      /*final_usage=*/sampled_usage);
+  distance_field_image_handle_ = frame_graph.ImportImage(
+      "Distance field", /*initial_usage=*/sampled_usage,
+      /*final_usage=*/sampled_usage);
+  render_paths_pass_ = frame_graph.AddPass(
+      "Render paths",
+      {{distance_field_image_handle_, render_target_usage}});
+  bold_paths_pass_ = frame_graph.AddPass(
+      "Bold paths",
+      {{distance_field_image_handle_, read_usage},
+       {paths_image_handle_, write_usage}});
+  if (generates_distance_field) {
+    generate_distance_field_pass_ = frame_graph.AddPass(
+        "Generate distance field",
+        {{paths_image_handle_, read_usage},
+         {distance_field_image_handle_, read_write_usage}});
+  }
+
+  // Rendering paths must happen on the graphics queue, while compute passes can
+  // be performed on the compute queue, so that they overlap with graphics work
+  // if the compute queue is in a different queue family.
+  const auto& queues = context_->queues();
+  const uint32_t compute_family_index = queues.compute_queue().family_index;
+  FrameGraphExecutor::QueueFamilyIndexMap pass_queue_family_indices{
+      {bold_paths_pass_, compute_family_index},
+  };
+  if (generate_distance_field_pass_.has_value()) {
+    pass_queue_family_indices.insert(
+        {generate_distance_field_pass_.value(), compute_family_index});
+  }
+  frame_graph_executor_ = std::make_unique<FrameGraphExecutor>(
+      frame_graph, queues.graphics_queue().family_index,
+      pass_queue_family_indices);
+  const int num_segments = frame_graph_executor_->num_segments();
+  if (num_segments > 1) {
+    segment_semas_ =
+        std::make_unique<Semaphores>(context_, /*count=*/num_segments - 1);
+  }
+
   /* Image */
   const VkExtent2D paths_image_extent{
       static_cast<uint32_t>(paths_image_dimension),
       static_cast<uint32_t>(paths_image_dimension)};
   const ImageSampler::Config sampler_config{
       VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE};
-
-  // TODO: We still need a high level description, especially when image layouts
-  // change across files.
-  ImageUsageHistory paths_image_usage_history{};
-  paths_image_usage_history
-      .AddUsage(kBoldPathsSubpassIndex,
-                ImageUsage::GetLinearAccessInComputeShaderUsage(
-                    AccessType::kWriteOnly))
-      .AddUsage(kGenerateDistanceFieldSubpassIndex,
-                ImageUsage::GetLinearAccessInComputeShaderUsage(
-                    AccessType::kReadOnly))
-      .SetFinalUsage(ImageUsage::GetSampledInFragmentShaderUsage());
-  paths_image_ = std::make_unique<OffscreenImage>(
-      context_, paths_image_extent, common::image::kBwImageChannel,
-      paths_image_usage_history.GetAllUsages(), sampler_config,
-      /*use_high_precision=*/false);
-
-  ImageUsageHistory distance_field_image_usage_history{
-      /*initial_usage=*/ImageUsage::GetMultisampleResolveTargetUsage()};
-  distance_field_image_usage_history
-      .AddUsage(kBoldPathsSubpassIndex,
-                ImageUsage::GetLinearAccessInComputeShaderUsage(
-                    AccessType::kReadOnly))
-      .AddUsage(kGenerateDistanceFieldSubpassIndex,
-                ImageUsage::GetLinearAccessInComputeShaderUsage(
-                    AccessType::kReadWrite))
-      .SetFinalUsage(ImageUsage::GetSampledInFragmentShaderUsage());
-  distance_field_image_ = std::make_unique<OffscreenImage>(
-      context_, paths_image_extent, common::image::kRgbaImageChannel,
-      distance_field_image_usage_history.GetAllUsages(), sampler_config,
-      /*use_high_precision=*/true);
+  for (auto& target : dump_targets_) {
+    target.paths_image = std::make_unique<OffscreenImage>(
+        context_, paths_image_extent, common::image::kBwImageChannel,
+        /*usages=*/std::vector<ImageUsage>{
+            read_usage, write_usage, sampled_usage},
+        sampler_config, /*use_high_precision=*/false);
+    target.distance_field_image = std::make_unique<OffscreenImage>(
+        context_, paths_image_extent, common::image::kRgbaImageChannel,
+        /*usages=*/std::vector<ImageUsage>{
+            render_target_usage, read_usage, read_write_usage, sampled_usage},
+        sampler_config, /*use_high_precision=*/true);
+  }
 
   /* Graphics and compute pipelines */
-  compute_pass_ = std::make_unique<ComputePass>(kNumSubpasses);
-  (*compute_pass_)
-      .AddImage(paths_image_name_, std::move(paths_image_usage_history))
-      .AddImage(distance_field_image_name_,
-                std::move(distance_field_image_usage_history));
-
-  path_renderer_ = std::make_unique<PathRenderer2D>(
-      context_, /*intermediate_image=*/*distance_field_image_,
-      /*output_image=*/*paths_image_, MultisampleImage::Mode::kBestEffect,
-      std::move(aurora_paths_vertex_buffers));
-
-  distance_field_generator_ = std::make_unique<DistanceFieldGenerator>(
-      context_, /*input_image=*/*paths_image_,
-      /*output_image=*/*distance_field_image_);
+  // Pipelines are built on worker threads, and we only wait for them when
+  // dumping aurora paths for the first time.
+  pipeline_build_jobs_ = std::make_unique<PipelineBuildJobs>(context_);
+  for (auto& target : dump_targets_) {
+    target.path_renderer = std::make_unique<PathRenderer2D>(
+        context_, pipeline_build_jobs_.get(),
+        /*intermediate_image=*/*target.distance_field_image,
+        /*output_image=*/*target.paths_image,
+        MultisampleImage::Mode::kBestEffect,
+        std::vector<const PerVertexBuffer*>{aurora_paths_vertex_buffers});
+
+    if (generates_distance_field) {
+      target.distance_field_generator =
+          std::make_unique<DistanceFieldGenerator>(
+              context_, pipeline_build_jobs_.get(),
+              /*input_image=*/*target.paths_image,
+              /*output_image=*/*target.distance_field_image);
+    }
+  }
+}
+
+PathDumper::~PathDumper() {
+  // Builders refer to render passes and descriptor set layouts owned by dump
+  // targets.
+  if (pipeline_build_jobs_ != nullptr) {
+    pipeline_build_jobs_->Wait();
+  }
+  if (dump_command_.has_value()) {
+    dump_command_->Wait();
+  }
 }
 
 void PathDumper::DumpAuroraPaths(const common::Camera& camera) {
@@ -114,33 +163,106 @@ void PathDumper::DumpAuroraPaths(const common::Camera& camera) {
   const common::BasicTimer timer;
 #endif /* !NDEBUG */
 
-  // TODO: Compute queue and graphics queue might be different queues.
-  const OneTimeCommand command{context_, &context_->queues().graphics_queue()};
-  command.Run([this, &camera](const VkCommandBuffer& command_buffer) {
-    const std::array<ComputePass::ComputeOp, kNumSubpasses> compute_ops{
-        [this, &command_buffer]() {
-          path_renderer_->BoldPaths(command_buffer);
-        },
-        [this, &command_buffer]() {
-          distance_field_generator_->Generate(command_buffer);
-        },
-    };
-    path_renderer_->RenderPaths(command_buffer, camera);
-    compute_pass_->Run(
-        command_buffer, context_->queues().compute_queue().family_index,
-        /*image_map=*/{
-            {paths_image_name_, paths_image_.get()},
-            {distance_field_image_name_, distance_field_image_.get()},
+  // Per-thread pipeline caches are merged into the main cache once all
+  // pipelines are built.
+  if (pipeline_build_jobs_ != nullptr) {
+    pipeline_build_jobs_->Wait();
+    pipeline_build_jobs_.reset();
+  }
+
+  // The last dumping may still be reading the host data that we are going to
+  // update. This is rarely blocking since the user won't switch views that
+  // frequently.
+  if (dump_command_.has_value()) {
+    dump_command_->Wait();
+  }
+
+  // Frames in flight may still be sampling the front buffer, so we write to
+  // the back buffer. The back buffer was the front buffer before the last
+  // dumping, and frames that sampled it were submitted to the graphics queue
+  // before the commands recorded here. Barriers inserted by the frame graph
+  // executor before the first writes, and semaphores between segments, make
+  // sure that those frames are done before we write to it.
+  const int back_index = (front_index_ + 1) % kNumDumpTargets;
+  const auto& target = dump_targets_[back_index];
+  const FrameGraphExecutor::ImageMap image_map{
+      {paths_image_handle_, target.paths_image.get()},
+      {distance_field_image_handle_, target.distance_field_image.get()},
+  };
+  FrameGraphExecutor::PassOpMap pass_ops{
+      {render_paths_pass_,
+       [&target, &camera](const VkCommandBuffer& command_buffer) {
+         target.path_renderer->RenderPaths(command_buffer, camera);
+       }},
+      {bold_paths_pass_,
+       [&target](const VkCommandBuffer& command_buffer) {
+         target.path_renderer->BoldPaths(command_buffer);
+       }},
+  };
+  if (generate_distance_field_pass_.has_value()) {
+    pass_ops.insert(
+        {generate_distance_field_pass_.value(),
+         [&target](const VkCommandBuffer& command_buffer) {
+           target.distance_field_generator->Generate(command_buffer);
+         }});
+  }
+
+  // Each segment is submitted to the queue it runs on. If the compute queue is
+  // in a different queue family, segments are: render paths and release images
+  // on the graphics queue, bold paths and generate distance field on the
+  // compute queue, and acquire images on the graphics queue. The acquire
+  // barriers only block the stages that use these images, hence graphics work
+  // submitted later can still overlap with the compute work.
+  const int num_segments = frame_graph_executor_->num_segments();
+  for (int segment = 0; segment < num_segments; ++segment) {
+    OneTimeCommand::Dependencies dependencies;
+    if (segment > 0) {
+      dependencies.wait_semaphores = {{
+          (*segment_semas_)[segment - 1],
+          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      }};
+    }
+    if (segment < num_segments - 1) {
+      dependencies.signal_semaphores = {{(*segment_semas_)[segment]}};
+    }
+
+    const OneTimeCommand command{
+        context_,
+        &GetQueue(frame_graph_executor_->queue_family_index(segment))};
+    auto submitted_command = command.RunAsync(
+        [&](const VkCommandBuffer& command_buffer) {
+          frame_graph_executor_->RecordSegment(segment, command_buffer,
+                                               image_map, pass_ops);
         },
-        compute_ops);
-  });
+        dependencies);
+    if (segment == num_segments - 1) {
+      dump_command_ = std::move(submitted_command);
+    }
+  }
+
+  // Commands that hand over the back buffer to the graphics queue have been
+  // submitted, so it is safe to sample it in later graphics work.
+  front_index_ = back_index;
+  ++dump_generation_;
 
 #ifndef NDEBUG
-  LOG_INFO << absl::StreamFormat("Elapsed time for dumping aurora paths: %fs",
-                                 timer.GetElapsedTimeSinceLaunch());
+  LOG_INFO << absl::StreamFormat(
+      "Elapsed time for submitting aurora paths dumping: %fs",
+      timer.GetElapsedTimeSinceLaunch());
 #endif /* !NDEBUG */
 }
 
+const Queues::Queue& PathDumper::GetQueue(uint32_t queue_family_index) const {
+  const auto& queues = context_->queues();
+  if (queue_family_index == queues.graphics_queue().family_index) {
+    return queues.graphics_queue();
+  }
+  ASSERT_TRUE(queue_family_index == queues.compute_queue().family_index,
+              absl::StrFormat("Unexpected queue family index %d",
+                              queue_family_index));
+  return queues.compute_queue();
+}
+
 } /* namespace aurora */
 } /* namespace vulkan */
 } /* namespace application */
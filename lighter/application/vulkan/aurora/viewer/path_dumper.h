@@ -8,18 +8,23 @@
 #ifndef LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_PATH_DUMPER_H
 #define LIGHTER_APPLICATION_VULKAN_AURORA_VIEWER_PATH_DUMPER_H
 
+#include <array>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "lighter/application/vulkan/aurora/viewer/distance_field.h"
 #include "lighter/application/vulkan/aurora/viewer/path_renderer.h"
 #include "lighter/common/camera.h"
-#include "lighter/renderer/ir/image_usage.h"
-#include "lighter/renderer/vulkan/extension/compute_pass.h"
+#include "lighter/renderer/ir/frame_graph.h"
+#include "lighter/renderer/vulkan/extension/frame_graph_executor.h"
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
+#include "lighter/renderer/vulkan/wrapper/command.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
+#include "lighter/renderer/vulkan/wrapper/synchronization.h"
 #include "third_party/glm/glm.hpp"
 #include "third_party/vulkan/vulkan.h"
 
@@ -31,46 +36,100 @@ namespace aurora {
 // This class is used to dump aurora paths and generate distance field.
 class PathDumper {
  public:
-  // Note that 'paths_image_dimension' must be power of 2.
+  // Note that 'paths_image_dimension' must be power of 2. If
+  // 'generates_distance_field' is false, only aurora paths are dumped, and the
+  // content of 'distance_field_image()' is undefined, which is useful when the
+  // distance field is baked offline.
   PathDumper(renderer::vulkan::SharedBasicContext context,
              int paths_image_dimension,
              std::vector<const renderer::vulkan::PerVertexBuffer*>&&
-                 aurora_paths_vertex_buffers);
+                 aurora_paths_vertex_buffers,
+             bool generates_distance_field = true);
 
   // This class is neither copyable nor movable.
   PathDumper(const PathDumper&) = delete;
   PathDumper& operator=(const PathDumper&) = delete;
 
+  // Waits for pipeline builds and the last dumping to finish.
+  ~PathDumper();
+
   // Dumps aurora paths and generates distance field. We only care about aurora
   // paths that are visible from the view of 'camera'.
+  // Results are written to the back buffer, so that frames in flight can keep
+  // sampling the front buffer. The buffers are swapped once the commands that
+  // hand over the back buffer to the graphics queue are submitted, hence
+  // commands submitted to the graphics queue afterwards will see the results
+  // through the front buffer. This does not wait for the device to finish. If
+  // the compute queue is in a different queue family, compute passes of the
+  // frame graph are submitted to it, so that they can overlap with graphics
+  // work.
   void DumpAuroraPaths(const common::Camera& camera);
 
-  // Accessors.
+  // Accessors. Images returned by these methods are the front buffer, which
+  // changes whenever 'dump_generation()' changes. The user should update
+  // descriptors that refer to them only when those descriptors are not used
+  // by any frame in flight.
   const renderer::vulkan::SamplableImage& aurora_paths_image() const {
-    return *paths_image_;
+    return *dump_targets_[front_index_].paths_image;
   }
   const renderer::vulkan::SamplableImage& distance_field_image() const {
-    return *distance_field_image_;
+    return *dump_targets_[front_index_].distance_field_image;
   }
+  int dump_generation() const { return dump_generation_; }
 
  private:
+  // Images written by one dumping, and objects that write to them.
+  struct DumpTarget {
+    std::unique_ptr<renderer::vulkan::OffscreenImage> paths_image;
+    std::unique_ptr<renderer::vulkan::OffscreenImage> distance_field_image;
+    // Dumps and bolds aurora paths.
+    std::unique_ptr<PathRenderer2D> path_renderer;
+    // Generates distance field. This is nullptr if distance field is not
+    // generated.
+    std::unique_ptr<DistanceFieldGenerator> distance_field_generator;
+  };
+
+  // Number of buffers of generated images.
+  static constexpr int kNumDumpTargets = 2;
+
+  // Returns the queue of the queue family with 'queue_family_index'.
+  const renderer::vulkan::Queues::Queue& GetQueue(
+      uint32_t queue_family_index) const;
+
   // Pointer to context.
   const renderer::vulkan::SharedBasicContext context_;
 
-  // Generated images.
-  static const std::string paths_image_name_;
-  static const std::string distance_field_image_name_;
-  std::unique_ptr<renderer::vulkan::OffscreenImage> paths_image_;
-  std::unique_ptr<renderer::vulkan::OffscreenImage> distance_field_image_;
+  // Builds pipelines of all dump targets on worker threads. This is reset
+  // once we have waited for all of them.
+  std::unique_ptr<renderer::vulkan::PipelineBuildJobs> pipeline_build_jobs_;
+
+  // Generated images. Each dumping writes to the back buffer, and then makes it
+  // the front buffer.
+  std::array<DumpTarget, kNumDumpTargets> dump_targets_;
+  int front_index_ = 0;
+
+  // Incremented every time the front buffer changes.
+  int dump_generation_ = 0;
+
+  // Handles of images and passes in the frame graph. Images of all dump
+  // targets share the same handles.
+  renderer::ir::FrameGraph::ImageHandle paths_image_handle_;
+  renderer::ir::FrameGraph::ImageHandle distance_field_image_handle_;
+  renderer::ir::FrameGraph::PassHandle render_paths_pass_;
+  renderer::ir::FrameGraph::PassHandle bold_paths_pass_;
+  std::optional<renderer::ir::FrameGraph::PassHandle>
+      generate_distance_field_pass_;
 
-  // Manages transitions for image layouts.
-  std::unique_ptr<renderer::vulkan::ComputePass> compute_pass_;
+  // Records passes and inserts barriers between them.
+  std::unique_ptr<renderer::vulkan::FrameGraphExecutor> frame_graph_executor_;
 
-  // Dumps and bolds aurora paths.
-  std::unique_ptr<PathRenderer2D> path_renderer_;
+  // Used to order submissions of segments of 'frame_graph_executor_', if it
+  // has more than one segment. The semaphore at index i is signaled by
+  // segment i and waited by segment i + 1.
+  std::unique_ptr<renderer::vulkan::Semaphores> segment_semas_;
 
-  // Generates distance field.
-  std::unique_ptr<DistanceFieldGenerator> distance_field_generator_;
+  // Last submitted dumping command, if any.
+  std::optional<renderer::vulkan::SubmittedCommand> dump_command_;
 };
 
 } /* namespace aurora */
@@ -54,7 +54,7 @@ struct Transformation {
 } /* namespace */
 
 PathRenderer2D::PathRenderer2D(
-    const SharedBasicContext& context,
+    const SharedBasicContext& context, PipelineBuildJobs* pipeline_build_jobs,
     const OffscreenImage& intermediate_image,
     const OffscreenImage& output_image,
     MultisampleImage::Mode multisampling_mode,
@@ -133,7 +133,10 @@ PathRenderer2D::PathRenderer2D(
       });
 
   /* Pipeline */
-  render_paths_pipeline_ = GraphicsPipelineBuilder{context}
+  FATAL_IF_NULL(pipeline_build_jobs);
+  auto render_paths_builder =
+      std::make_unique<GraphicsPipelineBuilder>(context);
+  (*render_paths_builder)
       .SetPipelineName("Dump path")
       .SetMultisampling(multisample_image_->sample_count())
       .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_LINE_STRIP)
@@ -152,15 +155,18 @@ PathRenderer2D::PathRenderer2D(
       .SetShader(VK_SHADER_STAGE_VERTEX_BIT,
                  GetShaderBinaryPath("aurora/dump_path.vert"))
       .SetShader(VK_SHADER_STAGE_FRAGMENT_BIT,
-                 GetShaderBinaryPath("aurora/dump_path.frag"))
-      .Build();
+                 GetShaderBinaryPath("aurora/dump_path.frag"));
+  render_paths_pipeline_ =
+      pipeline_build_jobs->Add(std::move(render_paths_builder));
 
-  bold_paths_pipeline_ = ComputePipelineBuilder{context}
+  auto bold_paths_builder = std::make_unique<ComputePipelineBuilder>(context);
+  (*bold_paths_builder)
       .SetPipelineName("Bold paths")
       .SetPipelineLayout({bold_paths_descriptor_->layout()},
                          /*push_constant_ranges=*/{})
-      .SetShader(GetShaderBinaryPath("aurora/bold_path.comp"))
-      .Build();
+      .SetShader(GetShaderBinaryPath("aurora/bold_path.comp"));
+  bold_paths_pipeline_ =
+      pipeline_build_jobs->Add(std::move(bold_paths_builder));
 }
 
 void PathRenderer2D::RenderPaths(const VkCommandBuffer& command_buffer,
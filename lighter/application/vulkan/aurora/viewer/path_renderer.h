@@ -17,6 +17,7 @@
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "third_party/vulkan/vulkan.h"
 
@@ -32,7 +33,10 @@ class PathRenderer2D {
  public:
   // The user should provide 'intermediate_image' that has the same size as
   // 'output_image', so that we can use it to bold rendered aurora paths.
+  // Pipelines are built with 'pipeline_build_jobs', and RenderPaths() and
+  // BoldPaths() block until they are ready.
   PathRenderer2D(const renderer::vulkan::SharedBasicContext& context,
+                 renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
                  const renderer::vulkan::OffscreenImage& intermediate_image,
                  const renderer::vulkan::OffscreenImage& output_image,
                  renderer::vulkan::MultisampleImage::Mode multisampling_mode,
@@ -66,8 +70,8 @@ class PathRenderer2D {
   std::unique_ptr<renderer::vulkan::RenderPass> render_pass_;
   renderer::vulkan::RenderPass::RenderOp render_op_;
   std::unique_ptr<renderer::vulkan::StaticDescriptor> bold_paths_descriptor_;
-  std::unique_ptr<renderer::vulkan::Pipeline> render_paths_pipeline_;
-  std::unique_ptr<renderer::vulkan::Pipeline> bold_paths_pipeline_;
+  renderer::vulkan::PipelineHandle render_paths_pipeline_;
+  renderer::vulkan::PipelineHandle bold_paths_pipeline_;
 };
 
 } /* namespace aurora */
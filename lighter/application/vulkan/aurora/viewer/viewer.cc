@@ -8,13 +8,21 @@
 #include "lighter/application/vulkan/aurora/viewer/viewer.h"
 
 #include <array>
+#include <string>
 
 #include "lighter/application/vulkan/aurora/viewer/air_transmit_table.h"
+#include "lighter/application/vulkan/aurora/viewer/distance_field.h"
 #include "lighter/application/vulkan/util.h"
 #include "lighter/renderer/ir/image_usage.h"
 #include "lighter/renderer/util.h"
 #include "lighter/renderer/vulkan/extension/graphics_pass.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline_util.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_FLAG(std::string, baked_distance_field, "",
+          "Path to the distance field baked offline with bake_distance_field. "
+          "If not empty, it will be sampled instead of running jump flooding "
+          "on the GPU");
 
 namespace lighter {
 namespace application {
@@ -64,11 +72,24 @@ const glm::vec3& GetEarthModelAxis() {
   return *earth_model_axis;
 }
 
+// Loads the distance field specified by --baked_distance_field. Returns nullptr
+// if the flag is not set.
+std::unique_ptr<TextureImage> MaybeLoadBakedDistanceField(
+    const SharedBasicContext& context) {
+  const std::string path = absl::GetFlag(FLAGS_baked_distance_field);
+  if (path.empty()) {
+    return nullptr;
+  }
+  LOG_INFO << "Loading baked distance field from " << path;
+  return LoadBakedDistanceField(context, path);
+}
+
 } /* namespace */
 
 ViewerRenderer::ViewerRenderer(const WindowContext* window_context,
                                int num_frames_in_flight,
-                               float air_transmit_sample_step,
+                               const common::air_transmit::TableConfig&
+                                   air_transmit_table_config,
                                const SamplableImage& aurora_paths_image,
                                const SamplableImage& distance_field_image)
     : window_context_{*FATAL_IF_NULL(window_context)} {
@@ -89,11 +110,8 @@ ViewerRenderer::ViewerRenderer(const WindowContext* window_context,
       context, common::file::GetResourcePath("texture/aurora_deposition.jpg"),
       image_usages, sampler_config);
 
-  const auto air_transmit_table =
-      GenerateAirTransmitTable(air_transmit_sample_step);
-  air_transmit_table_image_ = std::make_unique<TextureImage>(
-      context, /*generate_mipmaps=*/false, air_transmit_table, image_usages,
-      sampler_config);
+  air_transmit_table_image_ = CreateAirTransmitTableImage(
+      context, air_transmit_table_config, AirTransmitTableFormat::kHalfFloat);
 
   const SharedTexture::CubemapPath skybox_path{
       /*directory=*/
@@ -168,7 +186,7 @@ ViewerRenderer::ViewerRenderer(const WindowContext* window_context,
       pipeline::GetVertexAttributes<Vertex2DPosOnly>());
 
   /* Pipeline */
-  pipeline_builder_ = std::make_unique<GraphicsPipelineBuilder>(context);
+  pipeline_builder_ = std::make_shared<GraphicsPipelineBuilder>(context);
   (*pipeline_builder_)
       .SetPipelineName("View aurora")
       .AddVertexInput(
@@ -200,7 +218,8 @@ ViewerRenderer::ViewerRenderer(const WindowContext* window_context,
       /*num_framebuffers=*/window_context_.num_swapchain_images());
 }
 
-void ViewerRenderer::Recreate() {
+void ViewerRenderer::Recreate(PipelineBuildJobs* pipeline_build_jobs) {
+  FATAL_IF_NULL(pipeline_build_jobs);
   render_pass_builder_->UpdateAttachmentImage(
       /*index=*/0,
       [this](int framebuffer_index) -> const Image& {
@@ -213,7 +232,7 @@ void ViewerRenderer::Recreate() {
           window_context_.frame_size(),
           window_context_.original_aspect_ratio()))
       .SetRenderPass(**render_pass_, kViewImageSubpassIndex);
-  pipeline_ = pipeline_builder_->Build();
+  pipeline_ = pipeline_build_jobs->Add(pipeline_builder_);
 }
 
 void ViewerRenderer::UpdateDumpPathsCamera(const common::Camera& camera) {
@@ -227,6 +246,19 @@ void ViewerRenderer::UpdateDumpPathsCamera(const common::Camera& camera) {
   }
 }
 
+void ViewerRenderer::UpdatePathsImages(
+    int frame, const SamplableImage& aurora_paths_image,
+    const SamplableImage& distance_field_image) {
+  descriptors_[frame]->UpdateImageInfos(
+      Image::GetDescriptorTypeForSampling(),
+      /*image_info_map=*/{
+          {kAuroraPathsImageBindingPoint,
+              {aurora_paths_image.GetDescriptorInfoForSampling()}},
+          {kDistanceFieldImageBindingPoint,
+              {distance_field_image.GetDescriptorInfoForSampling()}},
+      });
+}
+
 void ViewerRenderer::UpdateViewAuroraCamera(
     int frame, const common::PerspectiveCamera& camera) {
   render_info_uniform_->HostData<RenderInfo>(frame)->camera_pos =
@@ -261,13 +293,22 @@ Viewer::Viewer(
     WindowContext* window_context, int num_frames_in_flight,
     std::vector<const PerVertexBuffer*>&& aurora_paths_vertex_buffers)
     : window_context_{*FATAL_IF_NULL(window_context)},
+      baked_distance_field_image_{
+          MaybeLoadBakedDistanceField(window_context_.basic_context())},
       path_dumper_{window_context_.basic_context(),
                    /*paths_image_dimension=*/1024,
-                   std::move(aurora_paths_vertex_buffers)},
+                   std::move(aurora_paths_vertex_buffers),
+                   /*generates_distance_field=*/
+                   baked_distance_field_image_ == nullptr},
       viewer_renderer_{window_context, num_frames_in_flight,
-                       /*air_transmit_sample_step=*/0.01f,
+                       /*air_transmit_table_config=*/{
+                           /*num_cos_angle_samples=*/256,
+                           /*num_altitude_samples=*/16,
+                       },
                        path_dumper_.aurora_paths_image(),
-                       path_dumper_.distance_field_image()} {
+                       distance_field_image()},
+      frame_dump_generations_(num_frames_in_flight,
+                              path_dumper_.dump_generation()) {
   common::Camera::Config camera_config;
   camera_config.far = 2.0f;
   camera_config.up = GetEarthModelAxis();
@@ -307,6 +348,17 @@ void Viewer::UpdateAuroraPaths(const glm::vec3& viewpoint_position) {
       });
 }
 
+void Viewer::UpdateData(int frame) {
+  if (frame_dump_generations_[frame] != path_dumper_.dump_generation()) {
+    viewer_renderer_.UpdatePathsImages(frame,
+                                       path_dumper_.aurora_paths_image(),
+                                       distance_field_image());
+    frame_dump_generations_[frame] = path_dumper_.dump_generation();
+  }
+  viewer_renderer_.UpdateViewAuroraCamera(frame,
+                                          view_aurora_camera_->camera());
+}
+
 void Viewer::OnEnter() {
   should_quit_ = false;
   (*window_context_.mutable_window())
@@ -331,7 +383,16 @@ void Viewer::OnExit() {
 
 void Viewer::Recreate() {
   view_aurora_camera_->SetCursorPos(window_context_.window().GetCursorPos());
-  viewer_renderer_.Recreate();
+  PipelineBuildJobs pipeline_build_jobs{window_context_.basic_context()};
+  viewer_renderer_.Recreate(&pipeline_build_jobs);
+  pipeline_build_jobs.Wait();
+}
+
+const SamplableImage& Viewer::distance_field_image() const {
+  if (baked_distance_field_image_ != nullptr) {
+    return *baked_distance_field_image_;
+  }
+  return path_dumper_.distance_field_image();
 }
 
 } /* namespace aurora */
@@ -13,10 +13,12 @@
 
 #include "lighter/application/vulkan/aurora/scene.h"
 #include "lighter/application/vulkan/aurora/viewer/path_dumper.h"
+#include "lighter/common/air_transmit.h"
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "lighter/renderer/vulkan/wrapper/window_context.h"
 #include "third_party/glm/glm.hpp"
@@ -31,7 +33,9 @@ namespace aurora {
 class ViewerRenderer {
  public:
   ViewerRenderer(const renderer::vulkan::WindowContext* window_context,
-                 int num_frames_in_flight, float air_transmit_sample_step,
+                 int num_frames_in_flight,
+                 const common::air_transmit::TableConfig&
+                     air_transmit_table_config,
                  const renderer::vulkan::SamplableImage& aurora_paths_image,
                  const renderer::vulkan::SamplableImage& distance_field_image);
 
@@ -39,12 +43,19 @@ class ViewerRenderer {
   ViewerRenderer(const ViewerRenderer&) = delete;
   ViewerRenderer& operator=(const ViewerRenderer&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
-  void Recreate();
+  // Updates internal states and rebuilds the graphics pipeline with
+  // 'pipeline_build_jobs'.
+  void Recreate(renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs);
 
   // Updates camera parameters used to transform points to aurora paths texture.
   void UpdateDumpPathsCamera(const common::Camera& camera);
 
+  // Makes the descriptor of 'frame' refer to the given images. This should be
+  // called only when 'frame' is not in flight.
+  void UpdatePathsImages(
+      int frame, const renderer::vulkan::SamplableImage& aurora_paths_image,
+      const renderer::vulkan::SamplableImage& distance_field_image);
+
   // Updates camera parameters used for viewing aurora.
   void UpdateViewAuroraCamera(
       int frame, const common::PerspectiveCamera& camera);
@@ -64,8 +75,8 @@ class ViewerRenderer {
   std::unique_ptr<renderer::vulkan::SharedTexture> universe_skybox_image_;
   std::vector<std::unique_ptr<renderer::vulkan::StaticDescriptor>> descriptors_;
   std::unique_ptr<renderer::vulkan::PerVertexBuffer> vertex_buffer_;
-  std::unique_ptr<renderer::vulkan::GraphicsPipelineBuilder> pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> pipeline_;
+  std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder> pipeline_builder_;
+  renderer::vulkan::PipelineHandle pipeline_;
   std::unique_ptr<renderer::vulkan::RenderPassBuilder> render_pass_builder_;
   std::unique_ptr<renderer::vulkan::RenderPass> render_pass_;
 };
@@ -99,10 +110,7 @@ class Viewer : public Scene {
   void OnEnter() override;
   void OnExit() override;
   void Recreate() override;
-  void UpdateData(int frame) override {
-    viewer_renderer_.UpdateViewAuroraCamera(
-        frame, view_aurora_camera_->camera());
-  }
+  void UpdateData(int frame) override;
   void Draw(const VkCommandBuffer& command_buffer,
             uint32_t framebuffer_index, int current_frame) override {
     viewer_renderer_.Draw(command_buffer, framebuffer_index, current_frame);
@@ -110,18 +118,31 @@ class Viewer : public Scene {
   bool ShouldTransitionScene() const override { return should_quit_; }
 
  private:
+  // Returns the distance field image to sample, which is either the baked one
+  // or the one generated by 'path_dumper_'.
+  const renderer::vulkan::SamplableImage& distance_field_image() const;
+
   // Onscreen rendering context.
   renderer::vulkan::WindowContext& window_context_;
 
   // Whether we should quit this scene.
   bool should_quit_ = false;
 
+  // Distance field loaded from the file specified by --baked_distance_field.
+  // If this is not nullptr, 'path_dumper_' only dumps aurora paths.
+  std::unique_ptr<renderer::vulkan::TextureImage> baked_distance_field_image_;
+
   // Dumps aurora paths and generates distance field.
   PathDumper path_dumper_;
 
   // Renderer of aurora seen from the user viewpoint.
   ViewerRenderer viewer_renderer_;
 
+  // Dump generation of images that each frame refers to. Since 'path_dumper_'
+  // writes to a different image than the one that frames in flight sample, we
+  // switch to the new image only when the frame is about to be recorded.
+  std::vector<int> frame_dump_generations_;
+
   // Camera used for dumping aurora paths. We assume that:
   // (1) Aurora paths points are on a unit sphere.
   // (2) The camera is located at the center of sphere.
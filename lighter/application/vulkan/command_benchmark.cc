@@ -0,0 +1,235 @@
+//
+//  command_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/application/vulkan/util.h"
+
+// Measures the CPU time of recording and submitting one frame with many draw
+// calls, either inline in the primary command buffer, or split into secondary
+// command buffers recorded on multiple threads. No window is needed, hence this
+// can run with a software ICD, e.g.:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json \
+//       bazel run -c opt //lighter/application/vulkan:command_benchmark
+// The first argument of BM_RecordInParallel is the number of recording threads.
+// Waiting for the device to finish executing the frame is not measured.
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace {
+
+using namespace renderer;
+using namespace renderer::vulkan;
+
+enum SubpassIndex {
+  kRenderSubpassIndex = 0,
+  kNumSubpasses,
+};
+
+constexpr uint32_t kVertexBufferBindingPoint = 0;
+
+// Number of draw calls in each frame.
+constexpr int kNumDraws = 20000;
+
+// Size of the render target.
+constexpr VkExtent2D kFrameSize{256, 256};
+
+/* BEGIN: Consistent with uniform blocks defined in shaders. */
+
+struct Alpha {
+  ALIGN_SCALAR(float) float value;
+};
+
+/* END: Consistent with uniform blocks defined in shaders. */
+
+// Returns a context without window support.
+SharedBasicContext CreateContext() {
+#ifdef NDEBUG
+  return BasicContext::GetContext(/*window_support=*/std::nullopt);
+#else  /* !NDEBUG */
+  return BasicContext::GetContext(/*window_support=*/std::nullopt,
+                                  DebugCallback::TriggerCondition{});
+#endif /* NDEBUG */
+}
+
+// Renders many triangles to an offscreen image.
+class Scene {
+ public:
+  explicit Scene(SharedBasicContext context);
+
+  // Records draws in range ['begin', 'end') into 'command_buffer'.
+  void Draw(const VkCommandBuffer& command_buffer, int begin, int end) const;
+
+  // Accessors.
+  const SharedBasicContext& context() const { return context_; }
+  const RenderPass& render_pass() const { return *render_pass_; }
+
+ private:
+  const SharedBasicContext context_;
+  std::unique_ptr<OffscreenImage> target_image_;
+  std::unique_ptr<StaticPerVertexBuffer> vertex_buffer_;
+  std::unique_ptr<RenderPass> render_pass_;
+  std::unique_ptr<Pipeline> pipeline_;
+};
+
+Scene::Scene(SharedBasicContext context) : context_{std::move(context)} {
+  using common::Vertex3DWithColor;
+
+  /* Image */
+  ImageUsageHistory usage_history{ImageUsage{}};
+  usage_history.AddUsage(kRenderSubpassIndex,
+                         ImageUsage::GetRenderTargetUsage(0));
+  target_image_ = std::make_unique<OffscreenImage>(
+      context_, kFrameSize, common::image::kRgbaImageChannel,
+      usage_history.GetAllUsages(), ImageSampler::Config{},
+      /*use_high_precision=*/false);
+
+  /* Vertex buffer */
+  const std::array<Vertex3DWithColor, 3> vertex_data{
+      Vertex3DWithColor{/*pos=*/{0.5f, -0.5f, 0.0f},
+                        /*color=*/{1.0f, 0.0f, 0.0f}},
+      Vertex3DWithColor{/*pos=*/{0.0f, 0.5f, 0.0f},
+                        /*color=*/{0.0f, 0.0f, 1.0f}},
+      Vertex3DWithColor{/*pos=*/{-0.5f, -0.5f, 0.0f},
+                        /*color=*/{0.0f, 1.0f, 0.0f}},
+  };
+  const PerVertexBuffer::NoIndicesDataInfo vertex_data_info{
+      /*per_mesh_vertices=*/{{PerVertexBuffer::VertexDataInfo{vertex_data}}}
+  };
+  vertex_buffer_ = std::make_unique<StaticPerVertexBuffer>(
+      context_, vertex_data_info,
+      pipeline::GetVertexAttributes<Vertex3DWithColor>());
+
+  /* Render pass */
+  GraphicsPass graphics_pass{context_, kNumSubpasses};
+  graphics_pass.AddAttachment("Target", std::move(usage_history),
+                              /*get_location=*/[](int subpass) { return 0; });
+  const auto render_pass_builder =
+      graphics_pass.CreateRenderPassBuilder(/*num_framebuffers=*/1);
+  render_pass_builder->UpdateAttachmentImage(
+      /*index=*/0, [this](int framebuffer_index) -> const Image& {
+        return *target_image_;
+      });
+  render_pass_ = render_pass_builder->Build();
+
+  /* Pipeline */
+  pipeline_ = GraphicsPipelineBuilder{context_}
+      .SetPipelineName("Triangles")
+      .AddVertexInput(
+          kVertexBufferBindingPoint,
+          pipeline::GetPerVertexBindingDescription<Vertex3DWithColor>(),
+          vertex_buffer_->GetAttributes(/*start_location=*/0))
+      .SetPipelineLayout(
+          /*descriptor_layouts=*/{},
+          {VkPushConstantRange{VK_SHADER_STAGE_FRAGMENT_BIT, /*offset=*/0,
+                               sizeof(Alpha)}})
+      .SetColorBlend({pipeline::GetColorAlphaBlendState(/*enable_blend=*/true)})
+      .SetViewport(pipeline::GetFullFrameViewport(kFrameSize),
+                   /*flip_y=*/false)
+      .SetRenderPass(**render_pass_, kRenderSubpassIndex)
+      .SetShader(VK_SHADER_STAGE_VERTEX_BIT,
+                 GetShaderBinaryPath("triangle/triangle.vert"))
+      .SetShader(VK_SHADER_STAGE_FRAGMENT_BIT,
+                 GetShaderBinaryPath("triangle/triangle.frag"))
+      .Build();
+}
+
+void Scene::Draw(const VkCommandBuffer& command_buffer,
+                 int begin, int end) const {
+  pipeline_->Bind(command_buffer);
+  for (int i = begin; i < end; ++i) {
+    const Alpha alpha{static_cast<float>(i) / kNumDraws};
+    vkCmdPushConstants(command_buffer, pipeline_->layout(),
+                       VK_SHADER_STAGE_FRAGMENT_BIT, /*offset=*/0,
+                       sizeof(Alpha), &alpha);
+    vertex_buffer_->Draw(command_buffer, kVertexBufferBindingPoint,
+                         /*mesh_index=*/0, /*instance_count=*/1);
+  }
+}
+
+// Records all draws inline in the primary command buffer. This serves as the
+// baseline.
+void BM_RecordInline(benchmark::State& state) {
+  const Scene scene{CreateContext()};
+  const OneTimeCommand command{scene.context(),
+                               &scene.context()->queues().graphics_queue()};
+  for (auto _ : state) {
+    const auto submitted = command.RunAsync(
+        [&scene](const VkCommandBuffer& command_buffer) {
+          scene.render_pass().Run(
+              command_buffer, /*framebuffer_index=*/0, /*render_ops=*/{
+                  [&scene](const VkCommandBuffer& command_buffer) {
+                    scene.Draw(command_buffer, /*begin=*/0, kNumDraws);
+                  },
+              });
+        });
+    state.PauseTiming();
+    submitted.Wait();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDraws);
+}
+
+// Splits draws into secondary command buffers recorded on multiple threads.
+void BM_RecordInParallel(benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const Scene scene{CreateContext()};
+  const OneTimeCommand command{scene.context(),
+                               &scene.context()->queues().graphics_queue()};
+  // The calling thread also records, hence we need one less worker.
+  std::unique_ptr<common::ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool = std::make_unique<common::ThreadPool>(num_threads - 1);
+  }
+  SecondaryCommandRecorder recorder{
+      scene.context(), scene.context()->queues().graphics_queue(),
+      thread_pool.get(), /*num_slices=*/num_threads};
+  const auto draw = [&scene](const VkCommandBuffer& command_buffer,
+                             int begin, int end) {
+    scene.Draw(command_buffer, begin, end);
+  };
+
+  for (auto _ : state) {
+    const auto submitted = command.RunAsync(
+        [&](const VkCommandBuffer& command_buffer) {
+          scene.render_pass().RunWithSecondaryCommands(
+              command_buffer, /*framebuffer_index=*/0, /*record_subpasses=*/{
+                  [&](const VkCommandBufferInheritanceInfo& inheritance_info) {
+                    return recorder.Record(inheritance_info, kNumDraws, draw);
+                  },
+              });
+        });
+    state.PauseTiming();
+    submitted.Wait();
+    recorder.Reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDraws);
+}
+
+BENCHMARK(BM_RecordInline)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RecordInParallel)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} /* namespace */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+int main(int argc, char* argv[]) {
+  using namespace lighter;
+  benchmark::Initialize(&argc, argv);
+  common::file::EnableRunfileLookup(argv[0]);
+  application::vulkan::GlobalInit(common::api::GraphicsApi::kVulkan);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
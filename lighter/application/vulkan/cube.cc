@@ -125,21 +125,21 @@ CubeApp::CubeApp(const WindowContext::Config& window_config)
 }
 
 void CubeApp::Recreate() {
-  // Prevent shaders from being auto released.
-  ModelBuilder::AutoReleaseShaderPool shader_pool;
-
   /* Render pass */
   render_pass_manager_->RecreateRenderPass();
 
   /* Model and text */
   const VkExtent2D& frame_size = window_context().frame_size();
   const VkSampleCountFlagBits sample_count = window_context().sample_count();
-  cube_model_->Update(/*is_object_opaque=*/true, frame_size, sample_count,
-                      render_pass(), kModelSubpassIndex);
-  static_text_->Update(frame_size, sample_count,
+  PipelineBuildJobs pipeline_build_jobs{context()};
+  cube_model_->Update(&pipeline_build_jobs, /*is_object_opaque=*/true,
+                      frame_size, sample_count, render_pass(),
+                      kModelSubpassIndex);
+  static_text_->Update(&pipeline_build_jobs, frame_size, sample_count,
                        render_pass(), kTextSubpassIndex, /*flip_y=*/true);
-  dynamic_text_->Update(frame_size, sample_count,
+  dynamic_text_->Update(&pipeline_build_jobs, frame_size, sample_count,
                         render_pass(), kTextSubpassIndex, /*flip_y=*/true);
+  pipeline_build_jobs.Wait();
 }
 
 void CubeApp::UpdateData(int frame) {
@@ -189,7 +189,7 @@ void CubeApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), update_data,
         [this, &render_ops](const VkCommandBuffer& command_buffer,
-                            uint32_t framebuffer_index) {
+                            uint32_t framebuffer_index, int) {
           render_pass().Run(command_buffer, framebuffer_index, render_ops);
         });
 
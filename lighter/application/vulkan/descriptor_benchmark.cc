@@ -0,0 +1,165 @@
+//
+//  descriptor_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/application/vulkan/util.h"
+
+// Measures how long it takes to allocate descriptor sets, and how many
+// descriptor pools are created for them. No window is needed, hence this can
+// run with a software ICD, e.g.:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json \
+//       bazel run -c opt //lighter/application/vulkan:descriptor_benchmark
+// The "pools" counter reports the number of descriptor pools that exist after
+// allocating all descriptor sets.
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace {
+
+using namespace renderer;
+using namespace renderer::vulkan;
+
+// Number of descriptor sets allocated in each iteration.
+constexpr int kNumDescriptorSets = 10000;
+
+// Returns a context without window support.
+SharedBasicContext CreateContext() {
+#ifdef NDEBUG
+  return BasicContext::GetContext(/*window_support=*/std::nullopt);
+#else  /* !NDEBUG */
+  return BasicContext::GetContext(/*window_support=*/std::nullopt,
+                                  DebugCallback::TriggerCondition{});
+#endif /* NDEBUG */
+}
+
+// Returns the descriptor infos of a typical model, which has a uniform buffer
+// and a few textures.
+std::vector<Descriptor::Info> GetDescriptorInfos() {
+  return {
+      Descriptor::Info{
+          UniformBuffer::GetDescriptorType(),
+          VK_SHADER_STAGE_VERTEX_BIT,
+          /*bindings=*/{{/*binding_point=*/0, /*array_length=*/1}},
+      },
+      Descriptor::Info{
+          Image::GetDescriptorTypeForSampling(),
+          VK_SHADER_STAGE_FRAGMENT_BIT,
+          /*bindings=*/{
+              {/*binding_point=*/1, /*array_length=*/1},
+              {/*binding_point=*/2, /*array_length=*/2},
+          },
+      },
+  };
+}
+
+// Allocates descriptor sets for StaticDescriptor, which are freed individually.
+void BM_StaticDescriptors(benchmark::State& state) {
+  const auto context = CreateContext();
+  const auto descriptor_infos = GetDescriptorInfos();
+  std::vector<std::unique_ptr<StaticDescriptor>> descriptors;
+  descriptors.reserve(kNumDescriptorSets);
+  for (auto _ : state) {
+    for (int i = 0; i < kNumDescriptorSets; ++i) {
+      descriptors.push_back(
+          std::make_unique<StaticDescriptor>(context, descriptor_infos));
+    }
+    state.PauseTiming();
+    state.counters["pools"] =
+        context->descriptor_allocator().GetNumPools();
+    descriptors.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDescriptorSets);
+}
+
+// Allocates descriptor sets that only live in one frame, and frees them by
+// resetting the pool list.
+void BM_PerFrameDescriptorSets(benchmark::State& state) {
+  const auto context = CreateContext();
+  auto& allocator = context->descriptor_allocator();
+  const StaticDescriptor descriptor{context, GetDescriptorInfos()};
+  constexpr DescriptorAllocator::PoolListId kFrame = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kNumDescriptorSets; ++i) {
+      benchmark::DoNotOptimize(allocator.Allocate(kFrame, descriptor.layout()));
+    }
+    state.PauseTiming();
+    state.counters["pools"] = allocator.GetNumPools();
+    state.ResumeTiming();
+    allocator.Reset(kFrame);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDescriptorSets);
+}
+
+// Creates a dedicated descriptor pool for each descriptor set, which is what
+// StaticDescriptor used to do. This serves as the baseline.
+void BM_DedicatedPools(benchmark::State& state) {
+  const auto context = CreateContext();
+  const VkDevice& device = *context->device();
+  const StaticDescriptor descriptor{context, GetDescriptorInfos()};
+  const VkDescriptorPoolSize pool_sizes[]{
+      {UniformBuffer::GetDescriptorType(), /*descriptorCount=*/1},
+      {Image::GetDescriptorTypeForSampling(), /*descriptorCount=*/3},
+  };
+  const VkDescriptorPoolCreateInfo pool_info{
+      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+      /*maxSets=*/1,
+      /*poolSizeCount=*/2,
+      pool_sizes,
+  };
+
+  std::vector<VkDescriptorPool> pools(kNumDescriptorSets);
+  for (auto _ : state) {
+    for (auto& pool : pools) {
+      ASSERT_SUCCESS(vkCreateDescriptorPool(device, &pool_info,
+                                            *context->allocator(), &pool),
+                     "Failed to create descriptor pool");
+      const VkDescriptorSetAllocateInfo set_info{
+          VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+          /*pNext=*/nullptr,
+          pool,
+          /*descriptorSetCount=*/1,
+          &descriptor.layout(),
+      };
+      VkDescriptorSet set;
+      ASSERT_SUCCESS(vkAllocateDescriptorSets(device, &set_info, &set),
+                     "Failed to allocate descriptor set");
+    }
+    state.PauseTiming();
+    state.counters["pools"] = pools.size();
+    for (const auto& pool : pools) {
+      vkDestroyDescriptorPool(device, pool, *context->allocator());
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDescriptorSets);
+}
+
+BENCHMARK(BM_StaticDescriptors)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PerFrameDescriptorSets)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DedicatedPools)->Unit(benchmark::kMillisecond);
+
+} /* namespace */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+int main(int argc, char* argv[]) {
+  using namespace lighter;
+  benchmark::Initialize(&argc, argv);
+  common::file::EnableRunfileLookup(argv[0]);
+  application::vulkan::GlobalInit(common::api::GraphicsApi::kVulkan);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -213,10 +213,12 @@ void NanosuitApp::Recreate() {
   constexpr bool kIsObjectOpaque = true;
   const VkExtent2D& frame_size = window_context().frame_size();
   const VkSampleCountFlagBits sample_count = window_context().sample_count();
-  nanosuit_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                          render_pass(), kModelSubpassIndex);
-  skybox_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                        render_pass(), kModelSubpassIndex);
+  PipelineBuildJobs pipeline_build_jobs{context()};
+  nanosuit_model_->Update(&pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                          sample_count, render_pass(), kModelSubpassIndex);
+  skybox_model_->Update(&pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                        sample_count, render_pass(), kModelSubpassIndex);
+  pipeline_build_jobs.Wait();
 }
 
 void NanosuitApp::UpdateData(int frame) {
@@ -255,7 +257,7 @@ void NanosuitApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), update_data,
         [this](const VkCommandBuffer& command_buffer,
-               uint32_t framebuffer_index) {
+               uint32_t framebuffer_index, int) {
           render_pass().Run(command_buffer, framebuffer_index, /*render_ops=*/{
               [this](const VkCommandBuffer& command_buffer) {
                 nanosuit_model_->Draw(command_buffer, current_frame_,
@@ -0,0 +1,161 @@
+//
+//  pipeline_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/application/vulkan/util.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
+#include "third_party/absl/flags/declare.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_DECLARE_FLAG(bool, use_pipeline_cache);
+
+// Measures how long it takes to create pipelines, with and without the pipeline
+// cache, and serially or on worker threads. No window is needed, hence this can
+// run with a software ICD, e.g.:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json \
+//       bazel run -c opt //lighter/application/vulkan:pipeline_benchmark
+// The first argument of each benchmark is 1 if the cache is used.
+
+namespace lighter {
+namespace application {
+namespace vulkan {
+namespace {
+
+using namespace renderer;
+using namespace renderer::vulkan;
+
+// Compute shaders that read from binding 0 and write to binding 1. Some of
+// them also use push constants.
+constexpr const char* kShaderPaths[] = {
+    "aurora/bold_path.comp",
+    "aurora/jump_flooding_seed.comp",
+    "aurora/jump_flooding_tiled.comp",
+    "aurora/path_to_seed.comp",
+    "aurora/seed_to_dist.comp",
+    "post_effect/sine_wave.comp",
+};
+
+// Returns a context without window support.
+SharedBasicContext CreateContext() {
+#ifdef NDEBUG
+  return BasicContext::GetContext(/*window_support=*/std::nullopt);
+#else  /* !NDEBUG */
+  return BasicContext::GetContext(/*window_support=*/std::nullopt,
+                                  DebugCallback::TriggerCondition{});
+#endif /* NDEBUG */
+}
+
+// Holds objects shared by all pipelines.
+class Pipelines {
+ public:
+  explicit Pipelines(SharedBasicContext context)
+      : context_{std::move(context)},
+        descriptor_{
+            context_, /*infos=*/{
+                Descriptor::Info{
+                    Image::GetDescriptorTypeForLinearAccess(),
+                    VK_SHADER_STAGE_COMPUTE_BIT,
+                    /*bindings=*/{
+                        {/*binding_point=*/0, /*array_length=*/1},
+                        {/*binding_point=*/1, /*array_length=*/1},
+                    },
+                },
+            }
+        } {}
+
+  // Builds all pipelines on the calling thread.
+  std::vector<std::unique_ptr<Pipeline>> BuildSerially() const {
+    std::vector<std::unique_ptr<Pipeline>> pipelines;
+    for (const char* shader_path : kShaderPaths) {
+      pipelines.push_back(CreateBuilder(shader_path)->Build());
+    }
+    return pipelines;
+  }
+
+  // Builds all pipelines on worker threads, and waits for them.
+  std::vector<PipelineHandle> BuildInParallel() const {
+    PipelineBuildJobs jobs{context_};
+    std::vector<PipelineHandle> pipelines;
+    for (const char* shader_path : kShaderPaths) {
+      pipelines.push_back(jobs.Add(CreateBuilder(shader_path)));
+    }
+    jobs.Wait();
+    return pipelines;
+  }
+
+ private:
+  // Returns a builder of the pipeline that uses the shader at 'shader_path'.
+  std::unique_ptr<PipelineBuilder> CreateBuilder(
+      const char* shader_path) const {
+    auto builder = std::make_unique<ComputePipelineBuilder>(context_);
+    (*builder)
+        .SetPipelineName(shader_path)
+        .SetPipelineLayout(
+            {descriptor_.layout()},
+            {VkPushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, /*offset=*/0,
+                                 kMaxPushConstantSize}})
+        .SetShader(GetShaderBinaryPath(shader_path));
+    return builder;
+  }
+
+  const SharedBasicContext context_;
+  const StaticDescriptor descriptor_;
+};
+
+// Simulates launching an application, which creates the context and pipelines
+// from scratch. If the cache is used, it is warmed up by a previous launch.
+void BM_Launch(benchmark::State& state) {
+  absl::SetFlag(&FLAGS_use_pipeline_cache, state.range(0) != 0);
+  Pipelines{CreateContext()}.BuildSerially();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Pipelines{CreateContext()}.BuildSerially());
+  }
+}
+
+// Same as BM_Launch, but builds pipelines on worker threads.
+void BM_LaunchInParallel(benchmark::State& state) {
+  absl::SetFlag(&FLAGS_use_pipeline_cache, state.range(0) != 0);
+  Pipelines{CreateContext()}.BuildInParallel();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Pipelines{CreateContext()}.BuildInParallel());
+  }
+}
+
+// Simulates recreating the swapchain, which rebuilds pipelines with the same
+// context.
+void BM_Rebuild(benchmark::State& state) {
+  absl::SetFlag(&FLAGS_use_pipeline_cache, state.range(0) != 0);
+  const Pipelines pipelines{CreateContext()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pipelines.BuildSerially());
+  }
+}
+
+BENCHMARK(BM_Launch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LaunchInParallel)->Arg(0)->Arg(1)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Rebuild)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} /* namespace */
+} /* namespace vulkan */
+} /* namespace application */
+} /* namespace lighter */
+
+int main(int argc, char* argv[]) {
+  using namespace lighter;
+  benchmark::Initialize(&argc, argv);
+  absl::ParseCommandLine(argc, argv);
+  common::file::EnableRunfileLookup(argv[0]);
+  application::vulkan::GlobalInit(common::api::GraphicsApi::kVulkan);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
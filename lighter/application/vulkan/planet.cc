@@ -260,12 +260,14 @@ void PlanetApp::Recreate() {
   constexpr bool kIsObjectOpaque = true;
   const VkExtent2D& frame_size = window_context().frame_size();
   const VkSampleCountFlagBits sample_count = window_context().sample_count();
-  planet_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                        render_pass(), kModelSubpassIndex);
-  asteroid_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                          render_pass(), kModelSubpassIndex);
-  skybox_model_->Update(kIsObjectOpaque, frame_size, sample_count,
-                        render_pass(), kModelSubpassIndex);
+  PipelineBuildJobs pipeline_build_jobs{context()};
+  planet_model_->Update(&pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                        sample_count, render_pass(), kModelSubpassIndex);
+  asteroid_model_->Update(&pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                          sample_count, render_pass(), kModelSubpassIndex);
+  skybox_model_->Update(&pipeline_build_jobs, kIsObjectOpaque, frame_size,
+                        sample_count, render_pass(), kModelSubpassIndex);
+  pipeline_build_jobs.Wait();
 }
 
 void PlanetApp::GenerateAsteroidModels() {
@@ -345,7 +347,7 @@ void PlanetApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), update_data,
         [this, &render_ops](const VkCommandBuffer& command_buffer,
-                            uint32_t framebuffer_index) {
+                            uint32_t framebuffer_index, int) {
           render_pass().Run(command_buffer, framebuffer_index, render_ops);
         });
 
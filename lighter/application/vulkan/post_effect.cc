@@ -155,7 +155,11 @@ void PostEffectApp::ProcessImageFromFile(const std::string& file_path) {
       .SetShader(GetShaderBinaryPath("post_effect/sine_wave.comp"))
       .Build();
 
-  const OneTimeCommand command{context(), &context()->queues().compute_queue()};
+  // Images are exclusively owned by the graphics queue family, while the
+  // compute queue may be in a different family. Since this only runs once, we
+  // simply use the graphics queue, which also supports compute.
+  const auto& graphics_queue = context()->queues().graphics_queue();
+  const OneTimeCommand command{context(), &graphics_queue};
   command.Run([&](const VkCommandBuffer& command_buffer) {
     const ComputePass::ComputeOp compute_op = [&]() {
       pipeline->Bind(command_buffer);
@@ -169,7 +173,7 @@ void PostEffectApp::ProcessImageFromFile(const std::string& file_path) {
                     /*groupCountZ=*/1);
     };
     compute_pass.Run(
-        command_buffer, context()->queues().compute_queue().family_index,
+        command_buffer, graphics_queue.family_index,
         /*image_map=*/{
             {original_image_name, &original_image},
             {processed_image_name, processed_image_.get()},
@@ -198,7 +202,7 @@ void PostEffectApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), /*update_data=*/nullptr,
         [this, &render_op](const VkCommandBuffer& command_buffer,
-                            uint32_t framebuffer_index) {
+                            uint32_t framebuffer_index, int) {
           render_pass().Run(command_buffer, framebuffer_index,
                             absl::MakeSpan(&render_op, 1));
         });
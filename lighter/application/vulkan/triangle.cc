@@ -149,7 +149,7 @@ void TriangleApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), update_data,
         [this](const VkCommandBuffer& command_buffer,
-               uint32_t framebuffer_index) {
+               uint32_t framebuffer_index, int) {
           render_pass().Run(command_buffer, framebuffer_index, /*render_ops=*/{
               [this](const VkCommandBuffer& command_buffer) {
                 pipeline_->Bind(command_buffer);
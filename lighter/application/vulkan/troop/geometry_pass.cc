@@ -122,7 +122,8 @@ GeometryPass::GeometryPass(const WindowContext* window_context,
       .Build();
 }
 
-void GeometryPass::UpdateFramebuffer(const Image& depth_stencil_image,
+void GeometryPass::UpdateFramebuffer(PipelineBuildJobs* pipeline_build_jobs,
+                                     const Image& depth_stencil_image,
                                      const Image& position_image,
                                      const Image& normal_image,
                                      const Image& diffuse_specular_image) {
@@ -150,7 +151,7 @@ void GeometryPass::UpdateFramebuffer(const Image& depth_stencil_image,
   render_pass_ = render_pass_builder_->Build();
 
   /* Model */
-  nanosuit_model_->Update(/*is_object_opaque=*/true,
+  nanosuit_model_->Update(pipeline_build_jobs, /*is_object_opaque=*/true,
                           depth_stencil_image.extent(), kSingleSample,
                           *render_pass_, kRenderSubpassIndex);
 }
@@ -163,11 +164,20 @@ void GeometryPass::UpdatePerFrameData(int frame, const common::Camera& camera) {
 }
 
 void GeometryPass::Draw(const VkCommandBuffer& command_buffer,
-                        uint32_t framebuffer_index, int current_frame) const {
-  render_pass_->Run(command_buffer, framebuffer_index, /*render_ops=*/{
-          [this, current_frame](const VkCommandBuffer& command_buffer) {
-            nanosuit_model_->Draw(command_buffer, current_frame,
-                                  /*instance_count=*/num_soldiers_);
+                        uint32_t framebuffer_index, int current_frame,
+                        PerFrameCommand* command) const {
+  const auto draw_soldiers = [this, current_frame](
+      const VkCommandBuffer& command_buffer, int begin, int end) {
+    nanosuit_model_->Draw(command_buffer, current_frame,
+                          /*instance_count=*/end - begin,
+                          /*first_instance=*/begin);
+  };
+  render_pass_->RunWithSecondaryCommands(
+      command_buffer, framebuffer_index, /*record_subpasses=*/{
+          [this, command, &draw_soldiers](
+              const VkCommandBufferInheritanceInfo& inheritance_info) {
+            return command->RecordSecondaryCommands(
+                inheritance_info, /*num_draws=*/num_soldiers_, draw_soldiers);
           },
       });
 }
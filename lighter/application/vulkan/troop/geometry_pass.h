@@ -18,7 +18,9 @@
 #include "lighter/renderer/vulkan/extension/graphics_pass.h"
 #include "lighter/renderer/vulkan/extension/model.h"
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
+#include "lighter/renderer/vulkan/wrapper/command.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "lighter/renderer/vulkan/wrapper/window_context.h"
 #include "third_party/absl/types/span.h"
@@ -45,19 +47,24 @@ class GeometryPass {
   GeometryPass(const GeometryPass&) = delete;
   GeometryPass& operator=(const GeometryPass&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
-  void UpdateFramebuffer(const renderer::vulkan::Image& depth_stencil_image,
-                         const renderer::vulkan::Image& position_image,
-                         const renderer::vulkan::Image& normal_image,
-                         const renderer::vulkan::Image& diffuse_specular_image);
+  // Updates internal states and rebuilds the graphics pipeline with
+  // 'pipeline_build_jobs'.
+  void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
+      const renderer::vulkan::Image& depth_stencil_image,
+      const renderer::vulkan::Image& position_image,
+      const renderer::vulkan::Image& normal_image,
+      const renderer::vulkan::Image& diffuse_specular_image);
 
   // Updates per-frame data.
   void UpdatePerFrameData(int frame, const common::Camera& camera);
 
-  // Runs the geometry pass.
+  // Runs the geometry pass. Soldiers are split across recording threads of
+  // 'command', each of which records a secondary command buffer.
   // This should be called when 'command_buffer' is recording commands.
   void Draw(const VkCommandBuffer& command_buffer,
-            uint32_t framebuffer_index, int current_frame) const;
+            uint32_t framebuffer_index, int current_frame,
+            renderer::vulkan::PerFrameCommand* command) const;
 
  private:
   // Used to create and update the render pass builder.
@@ -245,7 +245,7 @@ LightingPass::LightingPass(const WindowContext* window_context,
   /* Pipeline */
   constexpr uint32_t kStencilReference = 0xFF;
   lights_pipeline_builder_ =
-      std::make_unique<GraphicsPipelineBuilder>(context);
+      std::make_shared<GraphicsPipelineBuilder>(context);
   (*lights_pipeline_builder_)
       .SetPipelineName("Lights")
       .SetDepthTestEnable(/*enable_test=*/true, /*enable_write=*/true)
@@ -267,7 +267,7 @@ LightingPass::LightingPass(const WindowContext* window_context,
                  GetShaderBinaryPath("troop/light_cube.frag"));
 
   soldiers_pipeline_builder_ =
-      std::make_unique<GraphicsPipelineBuilder>(context);
+      std::make_shared<GraphicsPipelineBuilder>(context);
   (*soldiers_pipeline_builder_)
       .SetPipelineName("Soldiers")
       .SetStencilTestEnable(true)
@@ -289,6 +289,7 @@ LightingPass::LightingPass(const WindowContext* window_context,
 }
 
 void LightingPass::UpdateFramebuffer(
+    PipelineBuildJobs* pipeline_build_jobs,
     const Image& depth_stencil_image,
     const OffscreenImage& position_image,
     const OffscreenImage& normal_image,
@@ -326,17 +327,18 @@ void LightingPass::UpdateFramebuffer(
   render_pass_ = render_pass_builder_->Build();
 
   /* Pipeline */
+  FATAL_IF_NULL(pipeline_build_jobs);
   const auto viewport =
       pipeline::GetFullFrameViewport(window_context_.frame_size());
   (*lights_pipeline_builder_)
       .SetViewport(viewport)
       .SetRenderPass(**render_pass_, kLightsSubpassIndex);
-  lights_pipeline_ = lights_pipeline_builder_->Build();
+  lights_pipeline_ = pipeline_build_jobs->Add(lights_pipeline_builder_);
 
   (*soldiers_pipeline_builder_)
       .SetViewport(viewport)
       .SetRenderPass(**render_pass_, kSoldiersSubpassIndex);
-  soldiers_pipeline_ = soldiers_pipeline_builder_->Build();
+  soldiers_pipeline_ = pipeline_build_jobs->Add(soldiers_pipeline_builder_);
 }
 
 void LightingPass::UpdatePerFrameData(int frame, const common::Camera& camera,
@@ -17,6 +17,7 @@
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "lighter/renderer/vulkan/wrapper/window_context.h"
 #include "third_party/vulkan/vulkan.h"
@@ -47,8 +48,10 @@ class LightingPass {
   LightingPass(const LightingPass&) = delete;
   LightingPass& operator=(const LightingPass&) = delete;
 
-  // Updates internal states and rebuilds the graphics pipeline.
+  // Updates internal states and rebuilds graphics pipelines with
+  // 'pipeline_build_jobs'.
   void UpdateFramebuffer(
+      renderer::vulkan::PipelineBuildJobs* pipeline_build_jobs,
       const renderer::vulkan::Image& depth_stencil_image,
       const renderer::vulkan::OffscreenImage& position_image,
       const renderer::vulkan::OffscreenImage& normal_image,
@@ -91,12 +94,12 @@ class LightingPass {
       soldiers_descriptors_;
   std::unique_ptr<renderer::vulkan::PerVertexBuffer> cube_vertex_buffer_;
   std::unique_ptr<renderer::vulkan::PerVertexBuffer> squad_vertex_buffer_;
-  std::unique_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+  std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
       lights_pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> lights_pipeline_;
-  std::unique_ptr<renderer::vulkan::GraphicsPipelineBuilder>
+  renderer::vulkan::PipelineHandle lights_pipeline_;
+  std::shared_ptr<renderer::vulkan::GraphicsPipelineBuilder>
       soldiers_pipeline_builder_;
-  std::unique_ptr<renderer::vulkan::Pipeline> soldiers_pipeline_;
+  renderer::vulkan::PipelineHandle soldiers_pipeline_;
   std::unique_ptr<renderer::vulkan::RenderPassBuilder> render_pass_builder_;
   std::unique_ptr<renderer::vulkan::RenderPass> render_pass_;
 };
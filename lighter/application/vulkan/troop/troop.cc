@@ -11,6 +11,10 @@
 #include "lighter/application/vulkan/troop/geometry_pass.h"
 #include "lighter/application/vulkan/troop/lighting_pass.h"
 #include "lighter/application/vulkan/util.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_FLAG(int, num_recording_threads, 1,
+          "Number of threads that record draws of soldiers");
 
 namespace lighter {
 namespace application {
@@ -100,7 +104,9 @@ TroopApp::TroopApp(const WindowContext::Config& window_config)
                                 [this]() { should_quit_ = true; });
 
   /* Command buffer */
-  command_ = std::make_unique<PerFrameCommand>(context(), kNumFramesInFlight);
+  command_ = std::make_unique<PerFrameCommand>(
+      context(), kNumFramesInFlight,
+      absl::GetFlag(FLAGS_num_recording_threads));
 
   /* Render pass */
   geometry_pass_ = std::make_unique<troop::GeometryPass>(
@@ -155,10 +161,14 @@ void TroopApp::Recreate() {
   }
 
   /* Render pass */
-  geometry_pass_->UpdateFramebuffer(*depth_stencil_image_, *position_image_,
-                                    *normal_image_, *diffuse_specular_image_);
-  lighting_pass_->UpdateFramebuffer(*depth_stencil_image_, *position_image_,
-                                    *normal_image_, *diffuse_specular_image_);
+  PipelineBuildJobs pipeline_build_jobs{context()};
+  geometry_pass_->UpdateFramebuffer(&pipeline_build_jobs, *depth_stencil_image_,
+                                    *position_image_, *normal_image_,
+                                    *diffuse_specular_image_);
+  lighting_pass_->UpdateFramebuffer(&pipeline_build_jobs, *depth_stencil_image_,
+                                    *position_image_, *normal_image_,
+                                    *diffuse_specular_image_);
+  pipeline_build_jobs.Wait();
 }
 
 void TroopApp::UpdateData(int frame) {
@@ -177,9 +187,9 @@ void TroopApp::MainLoop() {
     const auto draw_result = command_->Run(
         current_frame_, window_context().swapchain(), update_data,
         [this](const VkCommandBuffer& command_buffer,
-               uint32_t framebuffer_index) {
+               uint32_t framebuffer_index, int) {
           geometry_pass_->Draw(command_buffer, framebuffer_index,
-                               current_frame_);
+                               current_frame_, command_.get());
           lighting_pass_->Draw(command_buffer, framebuffer_index,
                                current_frame_);
         });
@@ -0,0 +1,511 @@
+//
+//  air_transmit.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/air_transmit.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <optional>
+#include <string>
+
+#include "lighter/common/file.h"
+#include "lighter/common/simd.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/glm/glm.hpp"
+
+ABSL_FLAG(bool, use_air_transmit_cache, true,
+          "Cache air transmit tables in binary files");
+ABSL_FLAG(std::string, air_transmit_cache_dir, "",
+          "Directory to store air transmit table cache files. If empty, a "
+          "directory in the system temporary directory will be used");
+
+namespace lighter::common::air_transmit {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// This should be bumped whenever the cache file format or the output of
+// GenerateTable() changes, so that stale cache files are not used.
+constexpr uint32_t kFormatVersion = 1;
+
+// Identifies air transmit table cache files.
+constexpr char kMagic[8] = {'L', 'T', 'R', 'A', 'I', 'R', 'T', '\0'};
+
+// Header of the cache file, which is followed by texels in row-major order.
+struct Header {
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t reserved;
+};
+
+// Number of texels evaluated by each task. This should be a multiple of SIMD
+// width.
+constexpr int kNumTexelsPerTask = 1024;
+
+/* BEGIN: Atmosphere integral approximation. */
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Where atmosphere reaches 1/e thickness (planetary radius units).
+constexpr float kScaleHeight = 8.0f / 6378.1f;
+// Atmosphere density = kRefDensity*exp(-(height-kRefHeight)*kDensityFalloff).
+constexpr float kDensityFalloff = 1.0f / kScaleHeight;
+// Height where density==kRefDensity.
+constexpr float kRefHeight = 1.0f;
+// Atmosphere opacity per planetary radius.
+constexpr float kRefDensity = 100.0f;
+// Normalization constant, i.e. sqrt(pi) / 2.
+constexpr float kNorm = 0.886226925f;
+// Used to find the second matching radius. This is 80% of atmosphere (at any
+// height).
+constexpr float kRadiusDelta = 2.0f / kDensityFalloff;
+// Constant of the approximation to erf.
+constexpr float kErfA = 8.0f * (kPi - 3.0f) / (3.0f * kPi * (4.0f - kPi));
+
+// A 3D ray shooting through space.
+struct Ray {
+  glm::vec3 start;
+  glm::vec3 direction;
+};
+
+// A span of ray t values.
+struct SpanT {
+  float low;
+  float high;
+};
+
+// A 3D earth model.
+struct Sphere {
+  glm::vec3 center;
+  float radius;
+};
+
+// Returns the span of t values at intersection region of 'ray' and 'sphere'.
+SpanT GetSpanSphere(const Ray& ray, const Sphere& sphere) {
+  const glm::vec3 sphere_to_ray = ray.start - sphere.center;
+  const float b = 2.0f * glm::dot(sphere_to_ray, ray.direction);
+  const float c = glm::dot(sphere_to_ray, sphere_to_ray) -
+                  sphere.radius * sphere.radius;
+  const float det = b * b - 4.0f * c;
+  ASSERT_TRUE(det > 0.0f, "we shoot a ray from inside of the sphere");
+  const float sd = glm::sqrt(det);
+  return {/*low=*/(-b - sd) * 0.5f, /*high=*/(-b + sd) * 0.5f};
+}
+
+// Decent little Wikipedia/Winitzki 2003 approximation to erf.
+// Supposedly accurate to within 0.035% relative error.
+float GetErfGuts(float x) {
+  constexpr float a = kErfA;
+  const float x_sqr = x * x;
+  return static_cast<float>(
+      glm::exp(-x_sqr * (4.0f / kPi + a * x_sqr) / (1.0f + a * x_sqr)));
+}
+
+// "Error function": integral of exp(-x*x).
+float GetWinErf(float x) {
+  const float sign = x < 0.0f ? -1.0f : 1.0f;
+  return sign * glm::sqrt(1.0f - GetErfGuts(x));
+}
+
+// erfc = 1.0-erf, but with less round-off.
+float GetWinErfc(float x) {
+  // If x is big, erf(x) is very close to +1.0.
+  // erfc(x)=1-erf(x)=1-sqrt(1-e)=approx +e/2
+  return x > 3.0f ? 0.5f * GetErfGuts(x) : 1.0f - GetWinErf(x);
+}
+
+// Computes the atmosphere's integrated thickness along 'ray' within 'span'.
+// The planet is assumed to be centered at origin, with unit radius.
+// This is an exponential approximation.
+float GetAtmosphereThickness(const Ray& ray, const SpanT& span) {
+  // Step 1: planarize problem from 3D to 2D. Integral is along 'ray'.
+  const float a = glm::dot(ray.direction, ray.direction);
+  const float b = 2.0f * glm::dot(ray.direction, ray.start);
+  const float c = glm::dot(ray.start, ray.start);
+  const float tc = -b / (2.0f * a);  // t value at ray/origin closest approach.
+  const float y = glm::sqrt(tc * tc * a + tc * b + c);
+  float xl = span.low - tc;
+  float xr = span.high - tc;
+  // Integral is along line: from xl to xr at given y.
+  // x==0 is the point of closest approach.
+
+  // Step 2: Find first matching radius r1 -- smallest used radius.
+  const float y_sqr = y * y;
+  const float xl_sqr = xl * xl;
+  const float xr_sqr = xr * xr;
+  float r1_sqr, r1;
+  bool is_cross = false;
+  if (xl * xr < 0.0f) {
+    // Span crosses origin -- use radius of closest approach.
+    r1_sqr = y_sqr;
+    r1 = y;
+    is_cross = true;
+  } else {
+    // Use either left or right endpoint -- whichever is closer to surface.
+    r1_sqr = xl_sqr + y_sqr;
+    if (r1_sqr > xr_sqr + y_sqr) {
+      r1_sqr = xr_sqr + y_sqr;
+    }
+    r1 = glm::sqrt(r1_sqr);
+  }
+
+  // Step 3: Find second matching radius r2.
+  const float r2 = r1 + kRadiusDelta;
+  const float r2_sqr = r2 * r2;
+
+  // Step 4: Find parameters for parabolic approximation to true hyperbolic
+  // distance.
+  // r(x)=sqrt(y^2+x^2), r'(x)=A+Cx^2; r1=r1', r2=r2'
+  // r_sqr = x_sqr + y_sqr, so x_sqr = r_sqr - y_sqr
+  const float x1_sqr = r1_sqr - y_sqr;
+  const float x2_sqr = r2_sqr - y_sqr;
+
+  const float C = (r1 - r2) / (x1_sqr - x2_sqr);
+  const float A = r1 - x1_sqr * C - kRefHeight;
+
+  // Step 5: Compute the integral of exp(-k*(A+Cx^2)) from x==xl to x==xr.
+  // Variable change: z=sqrt(k*C)*x; exp(-z^2)
+  const float sqrt_kC = glm::sqrt(kDensityFalloff * C);
+  float erf_del;
+  if (is_cross) {
+    // xl and xr have opposite signs -- use erf normally.
+    erf_del = GetWinErf(sqrt_kC * xr) - GetWinErf(sqrt_kC * xl);
+  } else {
+    // xl and xr have same sign -- flip to positive half and use erfc.
+    if (xl < 0.0f) {
+      xl = -xl;
+      xr = -xr;
+    }
+    erf_del = GetWinErfc(sqrt_kC * xr) - GetWinErfc(sqrt_kC * xl);
+  }
+  if (glm::abs(erf_del) > 1E-10f) {
+    // Parabolic approximation has acceptable round-off.
+    // From constant term of integral.
+    const float e_scl = glm::exp(-kDensityFalloff * A);
+    return kRefDensity * kNorm * e_scl / sqrt_kC * glm::abs(erf_del);
+  } else {
+    // erf_del==0.0 -> Round-off!
+    // Switch to a linear approximation:
+    //   a.) Create linear approximation r(x) = M*x+B
+    //   b.) Integrate exp(-k*(M*x+B-1.0)) dx, from xl to xr
+    //   integral = (1.0/(-k*M)) * exp(-k*(M*x+B-1.0))
+    const float x1 = glm::sqrt(x1_sqr);
+    const float x2 = glm::sqrt(x2_sqr);
+    // Linear fit at (x1,r1) and (x2,r2).
+    const float M = (r2 - r1) / (x2 - x1);
+    const float B = r1 - M * x1 - 1.0f;
+
+    const float t1 = glm::exp(-kDensityFalloff * (M * xl + B));
+    const float t2 = glm::exp(-kDensityFalloff * (M * xr + B));
+    return glm::abs(kRefDensity * (t2 - t1) / (kDensityFalloff * M));
+  }
+}
+
+// SIMD counterparts of functions above. Branches are replaced with selections,
+// and errors mainly come from simd::Exp().
+
+// Returns the absolute value of each lane.
+simd::Float Abs(const simd::Float& x) {
+  return simd::Max(x, 0.0f - x);
+}
+
+simd::Float GetErfGuts(const simd::Float& x) {
+  const simd::Float x_sqr = x * x;
+  return simd::Exp(0.0f - x_sqr * (static_cast<float>(4.0 / kPi) +
+                                   kErfA * x_sqr) / (1.0f + kErfA * x_sqr));
+}
+
+// Returns erf('x'), where 'guts' is GetErfGuts('x'), so that it can be shared
+// with GetWinErfc().
+simd::Float GetWinErf(const simd::Float& x, const simd::Float& guts) {
+  const simd::Float sign = simd::Select(x < 0.0f, -1.0f, 1.0f);
+  // 'guts' may slightly exceed 1.0 due to the approximation of exp.
+  return sign * simd::Sqrt(simd::Max(1.0f - guts, 0.0f));
+}
+
+// Returns erfc('x'), where 'guts' is GetErfGuts('x').
+simd::Float GetWinErfc(const simd::Float& x, const simd::Float& guts) {
+  return simd::Select(x > 3.0f, 0.5f * guts, 1.0f - GetWinErf(x, guts));
+}
+
+// Returns the ratio of light that penetrates the air along rays starting from
+// 'altitude' with 'cos_angle'. Since the integral is rotationally symmetric,
+// rays are placed in the plane where the up vector is (0, 1).
+simd::Float ComputeTransmitBatch(const simd::Float& cos_angle,
+                                 const simd::Float& altitude) {
+  const simd::Float sin_angle =
+      simd::Sqrt(simd::Max(1.0f - cos_angle * cos_angle, 0.0f));
+  const simd::Float start_y = 1.0f + altitude;
+
+  // Rays start from inside of the atmosphere, hence 'det' is always positive.
+  constexpr float kAirRadius = 1.0f + kAirMaxHeight;
+  const simd::Float dir_dot_start = cos_angle * start_y;
+  const simd::Float start_dot_start = start_y * start_y;
+  const simd::Float b = 2.0f * dir_dot_start;
+  const simd::Float det =
+      b * b - 4.0f * (start_dot_start - kAirRadius * kAirRadius);
+  const simd::Float span_high = (simd::Sqrt(det) - b) * 0.5f;
+
+  // Step 1: planarize problem from 3D to 2D.
+  const simd::Float a = sin_angle * sin_angle + cos_angle * cos_angle;
+  const simd::Float tc = (0.0f - b) / (2.0f * a);
+  const simd::Float y = simd::Sqrt(tc * tc * a + tc * b + start_dot_start);
+  simd::Float xl = 0.0f - tc;
+  simd::Float xr = span_high - tc;
+
+  // Step 2: Find first matching radius r1.
+  const simd::Float y_sqr = y * y;
+  const simd::Mask is_cross = xl * xr < 0.0f;
+  const simd::Float r1_sqr = simd::Select(
+      is_cross, y_sqr, simd::Min(xl * xl + y_sqr, xr * xr + y_sqr));
+  const simd::Float r1 = simd::Select(is_cross, y, simd::Sqrt(r1_sqr));
+
+  // Step 3: Find second matching radius r2.
+  const simd::Float r2 = r1 + kRadiusDelta;
+  const simd::Float r2_sqr = r2 * r2;
+
+  // Step 4: Find parameters for parabolic approximation.
+  const simd::Float x1_sqr = r1_sqr - y_sqr;
+  const simd::Float x2_sqr = r2_sqr - y_sqr;
+  const simd::Float C = (r1 - r2) / (x1_sqr - x2_sqr);
+  const simd::Float A = r1 - x1_sqr * C - kRefHeight;
+
+  // Step 5: Compute the integral. If xl and xr have the same sign, flip to
+  // positive half and use erfc.
+  const simd::Float sqrt_kC = simd::Sqrt(kDensityFalloff * C);
+  const simd::Mask should_flip = (xl < 0.0f) & (xl * xr >= 0.0f);
+  xl = simd::Select(should_flip, 0.0f - xl, xl);
+  xr = simd::Select(should_flip, 0.0f - xr, xr);
+  const simd::Float zl = sqrt_kC * xl;
+  const simd::Float zr = sqrt_kC * xr;
+  const simd::Float guts_l = GetErfGuts(zl);
+  const simd::Float guts_r = GetErfGuts(zr);
+  const simd::Float erf_del = simd::Select(
+      is_cross, GetWinErf(zr, guts_r) - GetWinErf(zl, guts_l),
+      GetWinErfc(zr, guts_r) - GetWinErfc(zl, guts_l));
+
+  const simd::Float e_scl = simd::Exp(0.0f - kDensityFalloff * A);
+  simd::Float air_mass = kRefDensity * kNorm * e_scl / sqrt_kC * Abs(erf_del);
+
+  // The linear approximation is rarely needed, hence it is only evaluated if
+  // any lane suffers from round-off.
+  constexpr int kAllLanes = (1 << simd::kWidth) - 1;
+  const simd::Mask is_parabolic = Abs(erf_del) > 1E-10f;
+  if (is_parabolic.ToBits() != kAllLanes) {
+    const simd::Float x1 = simd::Sqrt(x1_sqr);
+    const simd::Float x2 = simd::Sqrt(x2_sqr);
+    const simd::Float M = (r2 - r1) / (x2 - x1);
+    const simd::Float B = r1 - M * x1 - 1.0f;
+    const simd::Float t1 = simd::Exp(0.0f - kDensityFalloff * (M * xl + B));
+    const simd::Float t2 = simd::Exp(0.0f - kDensityFalloff * (M * xr + B));
+    air_mass = simd::Select(
+        is_parabolic, air_mass,
+        Abs(kRefDensity * (t2 - t1) / (kDensityFalloff * M)));
+  }
+  return simd::Exp(0.0f - air_mass);
+}
+
+/* END: Atmosphere integral approximation. */
+
+// Checks whether 'config' is valid.
+void ValidateConfig(const TableConfig& config) {
+  ASSERT_TRUE(config.num_cos_angle_samples > 0 &&
+                  config.num_altitude_samples > 0,
+              absl::StrFormat("Invalid table size %dx%d",
+                              config.num_altitude_samples,
+                              config.num_cos_angle_samples));
+}
+
+// Returns the cosine value represented by 'row' of a table with 'height' rows.
+float GetCosAngle(int row, int height) {
+  return static_cast<float>(row) / static_cast<float>(height);
+}
+
+// Returns the altitude represented by 'column' of a table with 'width'
+// columns.
+float GetAltitude(int column, int width) {
+  return static_cast<float>(column) / static_cast<float>(width) *
+         kAirMaxHeight;
+}
+
+// Returns a hash of parameters of the atmosphere integral, and the SIMD width,
+// which determines how Exp() is approximated. Tables generated with different
+// parameters or on different platforms are stored in different cache files.
+uint64_t GetIntegrationHash() {
+  const float params[] = {
+      kAirMaxHeight, kScaleHeight, kDensityFalloff, kRefHeight,
+      kRefDensity, kNorm, kRadiusDelta, kErfA,
+  };
+  const uint64_t seed = static_cast<uint64_t>(kFormatVersion) << 32 |
+                        static_cast<uint64_t>(simd::kWidth);
+  return util::HashBytes(params, sizeof(params), seed);
+}
+
+// Returns the path to the cache file of the table with 'config'.
+std::string GetCachePath(const TableConfig& config) {
+  stdfs::path directory{absl::GetFlag(FLAGS_air_transmit_cache_dir)};
+  if (directory.empty()) {
+    directory = stdfs::temp_directory_path() / "lighter_air_transmit_cache";
+  }
+  const std::string file_name = absl::StrFormat(
+      "%dx%d_%016x.air", config.num_altitude_samples,
+      config.num_cos_angle_samples, GetIntegrationHash());
+  return (directory / file_name).string();
+}
+
+// Returns the table loaded from the cache file at 'cache_path' if it is valid
+// and matches with 'config'. Otherwise, returns std::nullopt.
+std::optional<std::vector<float>> LoadFromCacheFile(
+    const std::string& cache_path, const TableConfig& config) {
+  std::error_code error_code;
+  if (!stdfs::is_regular_file(cache_path, error_code)) {
+    return std::nullopt;
+  }
+
+  const MappedData mapped_data{cache_path};
+  const auto* file_data = mapped_data.data<char>();
+  const uint64_t num_texels =
+      static_cast<uint64_t>(config.num_altitude_samples) *
+      config.num_cos_angle_samples;
+  Header header;
+  if (mapped_data.size() != sizeof(header) + num_texels * sizeof(float)) {
+    return std::nullopt;
+  }
+  std::memcpy(&header, file_data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kFormatVersion ||
+      header.width != config.num_altitude_samples ||
+      header.height != config.num_cos_angle_samples) {
+    return std::nullopt;
+  }
+
+  std::vector<float> table(num_texels);
+  std::memcpy(table.data(), file_data + sizeof(header),
+              num_texels * sizeof(float));
+  return table;
+}
+
+// Writes 'table' with 'config' to the cache file at 'cache_path'. Failures are
+// logged and otherwise ignored.
+void WriteCacheFile(const std::string& cache_path, const TableConfig& config,
+                    const std::vector<float>& table) {
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.width = config.num_altitude_samples;
+  header.height = config.num_cos_angle_samples;
+
+  const bool succeeded =
+      file::WriteFileAtomically(cache_path, [&](std::ostream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   table.size() * sizeof(table[0]));
+      });
+  if (!succeeded) {
+    LOG_ERROR << absl::StreamFormat(
+        "Failed to write air transmit table cache file '%s'", cache_path);
+  }
+}
+
+}  // namespace
+
+float ComputeTransmit(float cos_angle, float altitude) {
+  ASSERT_TRUE(cos_angle >= 0.0f && cos_angle <= 1.0f,
+              absl::StrFormat("Cosine value %f out of range", cos_angle));
+  ASSERT_TRUE(altitude >= 0.0f && altitude < kAirMaxHeight,
+              absl::StrFormat("Altitude %f out of range", altitude));
+  const float angle = glm::acos(cos_angle);
+  const Ray ray{/*start=*/{0.0f, 0.0f, 1.0f + altitude},
+                /*direction=*/{glm::sin(angle), 0.0f, glm::cos(angle)}};
+  const Sphere air_layer{/*center=*/glm::vec3{0.0f},
+                         /*radius=*/kAirMaxHeight + 1.0f};
+  const SpanT air_span = GetSpanSphere(ray, air_layer);
+  const float air_mass =
+      GetAtmosphereThickness(ray, SpanT{/*low=*/0.0f, air_span.high});
+  return glm::exp(-air_mass);
+}
+
+std::vector<float> GenerateTable(const TableConfig& config,
+                                 ThreadPool* thread_pool) {
+  ValidateConfig(config);
+  const int width = config.num_altitude_samples;
+  const int height = config.num_cos_angle_samples;
+  const int num_texels = width * height;
+
+  // Coordinates are looked up per lane, hence they are computed in advance.
+  std::vector<float> cos_angles(height);
+  for (int row = 0; row < height; ++row) {
+    cos_angles[row] = GetCosAngle(row, height);
+  }
+  std::vector<float> altitudes(width);
+  for (int col = 0; col < width; ++col) {
+    altitudes[col] = GetAltitude(col, width);
+  }
+
+  // Padded so that every batch can be stored without bound checks.
+  std::vector<float> table(
+      (num_texels + simd::kWidth - 1) / simd::kWidth * simd::kWidth);
+  const auto evaluate = [&](int task_index) {
+    const int begin = task_index * kNumTexelsPerTask;
+    const int end = std::min(begin + kNumTexelsPerTask, num_texels);
+    float batch_cos_angles[simd::kWidth];
+    float batch_altitudes[simd::kWidth];
+    int row = begin / width;
+    int col = begin % width;
+    for (int texel = begin; texel < end; texel += simd::kWidth) {
+      for (int lane = 0; lane < simd::kWidth; ++lane) {
+        // Padding lanes repeat the last texel.
+        batch_cos_angles[lane] = cos_angles[std::min(row, height - 1)];
+        batch_altitudes[lane] = altitudes[col];
+        if (++col == width) {
+          col = 0;
+          ++row;
+        }
+      }
+      ComputeTransmitBatch(simd::Float::Load(batch_cos_angles),
+                           simd::Float::Load(batch_altitudes))
+          .Store(&table[texel]);
+    }
+  };
+
+  const int num_tasks = (num_texels + kNumTexelsPerTask - 1) /
+                        kNumTexelsPerTask;
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < num_tasks; ++i) {
+      evaluate(i);
+    }
+  } else {
+    thread_pool->ParallelFor(num_tasks, evaluate);
+  }
+  table.resize(num_texels);
+  return table;
+}
+
+std::vector<float> LoadOrGenerateTable(const TableConfig& config,
+                                       ThreadPool* thread_pool) {
+  ValidateConfig(config);
+  if (!absl::GetFlag(FLAGS_use_air_transmit_cache)) {
+    return GenerateTable(config, thread_pool);
+  }
+
+  const std::string cache_path = GetCachePath(config);
+  if (auto table = LoadFromCacheFile(cache_path, config)) {
+    return std::move(table).value();
+  }
+  auto table = GenerateTable(config, thread_pool);
+  WriteCacheFile(cache_path, config, table);
+  return table;
+}
+
+}  // namespace lighter::common::air_transmit
@@ -0,0 +1,69 @@
+//
+//  air_transmit.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_AIR_TRANSMIT_H
+#define LIGHTER_COMMON_AIR_TRANSMIT_H
+
+#include <vector>
+
+#include "lighter/common/thread_pool.h"
+
+// Generates air transmit tables. Such a table enables us to look up how much
+// aurora light can penetrate the air and get to our eyes in shaders.
+// This code is modified from Dr. Orion Sky Lawlor's implementation.
+// Lawlor, Orion & Genetti, Jon. (2011). Interactive Volume Rendering Aurora on
+// the GPU. Journal of WSCG. 19. 25-32.
+//
+// The earth radius is used as one unit of length, same as shaders. A table is
+// an image with one float per texel, stored in row-major order. The value at
+// row i and column j is the ratio of light that gets to the viewer at altitude
+// (j / width * kAirMaxHeight), along the view ray whose angle to the up vector
+// has cosine value (i / height). Hence, the Y coordinate, after scaled to range
+// [0.0, 1.0], represents the cosine value, and the X coordinate represents the
+// altitude of viewer.
+namespace lighter::common::air_transmit {
+
+// Height of the top of atmosphere.
+inline constexpr float kAirMaxHeight = 75.0f / 6378.1f;
+
+// Specifies the resolution of table.
+struct TableConfig {
+  // Number of rows, i.e. samples of the cosine value.
+  int num_cos_angle_samples;
+
+  // Number of columns, i.e. samples of the altitude. If this is 1, the viewer
+  // is assumed to be on the ground.
+  int num_altitude_samples = 1;
+};
+
+// Returns the ratio of light that gets to the viewer at 'altitude' along the
+// view ray whose angle to the up vector has cosine value 'cos_angle', which
+// must be in range [0.0, 1.0]. This evaluates the integral one ray at a time,
+// and serves as the reference of GenerateTable().
+float ComputeTransmit(float cos_angle, float altitude);
+
+// Returns the table with 'config'. Texels are evaluated in batches of SIMD
+// width, and results match ComputeTransmit() up to rounding errors. If
+// 'thread_pool' is not nullptr, batches will be evaluated in parallel on it.
+std::vector<float> GenerateTable(const TableConfig& config,
+                                 ThreadPool* thread_pool = nullptr);
+
+// Same as GenerateTable(), except that the table is cached in a binary file
+// named after 'config', and later calls with the same 'config' load the file
+// instead of evaluating the integral again.
+//
+// Cache files are stored in the directory specified by the flag
+// --air_transmit_cache_dir, which defaults to a directory in the system
+// temporary directory. Caching can be disabled with
+// --use_air_transmit_cache=false. If failed to write the cache file, the
+// generated table is still returned.
+std::vector<float> LoadOrGenerateTable(const TableConfig& config,
+                                       ThreadPool* thread_pool = nullptr);
+
+}  // namespace lighter::common::air_transmit
+
+#endif  // LIGHTER_COMMON_AIR_TRANSMIT_H
@@ -0,0 +1,67 @@
+//
+//  air_transmit_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/air_transmit.h"
+#include "lighter/common/thread_pool.h"
+
+namespace lighter::common::air_transmit {
+namespace {
+
+// Returns the config with 'num_cos_angle_samples' rows and 1/16 as many
+// columns.
+TableConfig GetConfig(int num_cos_angle_samples) {
+  return {num_cos_angle_samples,
+          /*num_altitude_samples=*/num_cos_angle_samples / 16};
+}
+
+void BM_ScalarTable(benchmark::State& state) {
+  const TableConfig config = GetConfig(state.range(0));
+  const int width = config.num_altitude_samples;
+  const int height = config.num_cos_angle_samples;
+  std::vector<float> table(width * height);
+  for (auto _ : state) {
+    for (int row = 0; row < height; ++row) {
+      for (int col = 0; col < width; ++col) {
+        table[row * width + col] = ComputeTransmit(
+            static_cast<float>(row) / height,
+            static_cast<float>(col) / width * kAirMaxHeight);
+      }
+    }
+    benchmark::DoNotOptimize(table.data());
+  }
+}
+
+void BM_SimdTable(benchmark::State& state) {
+  const TableConfig config = GetConfig(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GenerateTable(config));
+  }
+}
+
+void BM_SimdTableWithThreadPool(benchmark::State& state) {
+  const TableConfig config = GetConfig(state.range(0));
+  ThreadPool thread_pool;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GenerateTable(config, &thread_pool));
+  }
+}
+
+BENCHMARK(BM_ScalarTable)
+    ->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SimdTable)
+    ->RangeMultiplier(4)->Range(256, 1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SimdTableWithThreadPool)
+    ->RangeMultiplier(4)->Range(256, 1024)->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace lighter::common::air_transmit
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+//
+//  air_transmit_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/air_transmit.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/absl/flags/declare.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_DECLARE_FLAG(bool, use_air_transmit_cache);
+ABSL_DECLARE_FLAG(std::string, air_transmit_cache_dir);
+
+namespace lighter::common::air_transmit {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// Expects 'table' to match ComputeTransmit() up to rounding errors.
+void ExpectMatchesScalar(const std::vector<float>& table,
+                         const TableConfig& config) {
+  const int width = config.num_altitude_samples;
+  const int height = config.num_cos_angle_samples;
+  ASSERT_EQ(table.size(), width * height);
+  for (int row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col) {
+      const float cos_angle = static_cast<float>(row) / height;
+      const float altitude = static_cast<float>(col) / width * kAirMaxHeight;
+      EXPECT_NEAR(table[row * width + col],
+                  ComputeTransmit(cos_angle, altitude), 1E-4f)
+          << "Row " << row << ", column " << col;
+    }
+  }
+}
+
+TEST(AirTransmitTest, MatchesScalar) {
+  // Cover the original one-column table, and sizes that are not multiples of
+  // SIMD width.
+  constexpr TableConfig kConfigs[] = {{100, 1}, {257, 3}, {64, 16}};
+  for (const auto& config : kConfigs) {
+    ExpectMatchesScalar(GenerateTable(config), config);
+  }
+}
+
+TEST(AirTransmitTest, NearlyMonotonic) {
+  // The approximation to erfc switches formulas at some point, which leads to
+  // small discontinuities.
+  constexpr float kTolerance = 1E-3f;
+  constexpr TableConfig kConfig{/*num_cos_angle_samples=*/128,
+                                /*num_altitude_samples=*/8};
+  const auto table = GenerateTable(kConfig);
+  const int width = kConfig.num_altitude_samples;
+  for (int row = 0; row < kConfig.num_cos_angle_samples; ++row) {
+    for (int col = 0; col < width; ++col) {
+      const float transmit = table[row * width + col];
+      EXPECT_GT(transmit, 0.0f);
+      EXPECT_LE(transmit, 1.0f);
+      // Less air is in the way if the view ray is closer to the zenith, or if
+      // the viewer is higher.
+      if (row > 0) {
+        EXPECT_GE(transmit, table[(row - 1) * width + col] - kTolerance);
+      }
+      if (col > 0) {
+        EXPECT_GE(transmit, table[row * width + col - 1] - kTolerance);
+      }
+    }
+  }
+}
+
+TEST(AirTransmitTest, ParallelMatchesSerial) {
+  constexpr TableConfig kConfig{/*num_cos_angle_samples=*/1000,
+                                /*num_altitude_samples=*/7};
+  ThreadPool thread_pool{/*num_threads=*/4};
+  EXPECT_EQ(GenerateTable(kConfig, &thread_pool), GenerateTable(kConfig));
+}
+
+TEST(AirTransmitTest, RejectInvalidConfig) {
+  EXPECT_THROW(GenerateTable({/*num_cos_angle_samples=*/0}),
+               std::runtime_error);
+  EXPECT_THROW(GenerateTable({/*num_cos_angle_samples=*/10,
+                              /*num_altitude_samples=*/-1}),
+               std::runtime_error);
+}
+
+class AirTransmitCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    cache_dir_ = stdfs::temp_directory_path() / "lighter_air_transmit_test";
+    stdfs::remove_all(cache_dir_);
+    absl::SetFlag(&FLAGS_use_air_transmit_cache, true);
+    absl::SetFlag(&FLAGS_air_transmit_cache_dir, cache_dir_.string());
+  }
+
+  void TearDown() override {
+    stdfs::remove_all(cache_dir_);
+    absl::SetFlag(&FLAGS_air_transmit_cache_dir, "");
+  }
+
+  // Returns the number of files in the cache directory.
+  int GetNumCacheFiles() const {
+    return std::distance(stdfs::directory_iterator{cache_dir_},
+                         stdfs::directory_iterator{});
+  }
+
+  stdfs::path cache_dir_;
+};
+
+TEST_F(AirTransmitCacheTest, LoadFromCache) {
+  constexpr TableConfig kConfig{/*num_cos_angle_samples=*/50,
+                                /*num_altitude_samples=*/2};
+  const auto table = LoadOrGenerateTable(kConfig);
+  EXPECT_EQ(table, GenerateTable(kConfig));
+  ASSERT_EQ(GetNumCacheFiles(), 1);
+
+  // Overwrite texels in the cache file, so that we can tell whether the table
+  // is loaded from it.
+  const auto cache_path = stdfs::directory_iterator{cache_dir_}->path();
+  const auto file_size = stdfs::file_size(cache_path);
+  {
+    std::fstream file{cache_path,
+                      std::ios::in | std::ios::out | std::ios::binary};
+    const float texel = 0.5f;
+    file.seekp(file_size - sizeof(texel));
+    file.write(reinterpret_cast<const char*>(&texel), sizeof(texel));
+  }
+  const auto loaded_table = LoadOrGenerateTable(kConfig);
+  EXPECT_EQ(loaded_table.back(), 0.5f);
+
+  // Tables with different configs are cached separately.
+  LoadOrGenerateTable({/*num_cos_angle_samples=*/50,
+                       /*num_altitude_samples=*/3});
+  EXPECT_EQ(GetNumCacheFiles(), 2);
+}
+
+TEST_F(AirTransmitCacheTest, RegenerateIfInvalid) {
+  constexpr TableConfig kConfig{/*num_cos_angle_samples=*/30};
+  LoadOrGenerateTable(kConfig);
+  const auto cache_path = stdfs::directory_iterator{cache_dir_}->path();
+  stdfs::resize_file(cache_path, stdfs::file_size(cache_path) - 1);
+  EXPECT_EQ(LoadOrGenerateTable(kConfig), GenerateTable(kConfig));
+  // The cache file should be rewritten.
+  EXPECT_EQ(LoadOrGenerateTable(kConfig), GenerateTable(kConfig));
+  EXPECT_EQ(stdfs::file_size(cache_path) % sizeof(float), 0);
+}
+
+}  // namespace
+}  // namespace lighter::common::air_transmit
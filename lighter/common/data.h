@@ -19,7 +19,10 @@
 
 namespace lighter::common {
 
-// Holds a contiguous memory block. The memory will be freed when destructed.
+// Holds a contiguous memory block. The memory will be released when
+// destructed, by default with std::free(). Subclasses may specify how to
+// release it, and since the way to release is moved together with the memory,
+// it is safe to move a subclass object into a Data.
 class Data {
  public:
   Data(void* data, size_t size)
@@ -31,16 +34,22 @@ class Data {
   Data(Data&& rhs) noexcept {
     data_ = rhs.data_;
     size_ = rhs.size_;
+    deleter_ = rhs.deleter_;
     rhs.data_ = nullptr;
   }
 
   Data& operator=(Data&& rhs) noexcept {
     std::swap(data_, rhs.data_);
     std::swap(size_, rhs.size_);
+    std::swap(deleter_, rhs.deleter_);
     return *this;
   }
 
-  virtual ~Data() { std::free(data_); }
+  virtual ~Data() {
+    if (data_ != nullptr) {
+      deleter_(data_, size_);
+    }
+  }
 
   // Accessors.
   size_t size() const { return size_; }
@@ -49,9 +58,24 @@ class Data {
   template <typename T>
   const T* data() const { return static_cast<const T*>(data_); }
 
+ protected:
+  // Releases 'data' of 'size' bytes.
+  using Deleter = void (*)(void* data, size_t size);
+
+  // Used by subclasses that allocate 'data' by themselves. It will be released
+  // with 'deleter' if it is not nullptr.
+  Data(void* data, size_t size, Deleter deleter)
+      : data_{data}, size_{size}, deleter_{deleter} {}
+
  private:
+  // Releases memory allocated with std::malloc().
+  static void Free(void* data, size_t size) { std::free(data); }
+
   void* data_;
   size_t size_;
+
+  // Releases 'data_' when destructed.
+  Deleter deleter_ = &Free;
 };
 
 // This is the base class of the classes holding contiguous data chunks.
@@ -0,0 +1,312 @@
+//
+//  distance_transform.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/distance_transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <ostream>
+
+#include "lighter/common/simd.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/functional/function_ref.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/glm/gtc/packing.hpp"
+
+namespace lighter::common::distance_transform {
+namespace {
+
+// This should be bumped whenever the file format changes.
+constexpr uint32_t kFormatVersion = 1;
+
+// Identifies distance field files.
+constexpr char kMagic[8] = {'L', 'T', 'R', 'D', 'I', 'S', 'T', '\0'};
+
+// Header of the distance field file.
+struct Header {
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t reserved;
+};
+
+// Number of columns processed by each task in the column pass. This should be
+// a multiple of SIMD width.
+constexpr int kNumColumnsPerTask = 64;
+
+// Number of rows processed by each task in the row pass.
+constexpr int kNumRowsPerTask = 16;
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// Checks whether 'raster' matches with the image size.
+void ValidateRaster(absl::Span<const uint8_t> raster, int width, int height) {
+  ASSERT_TRUE(width > 0 && height > 0 &&
+                  width < jump_flooding::kMaxImageDimension &&
+                  height < jump_flooding::kMaxImageDimension,
+              absl::StrFormat("Unsupported image size %dx%d", width, height));
+  ASSERT_TRUE(raster.size() == width * height,
+              absl::StrFormat("Raster size (%d) mismatches with image size "
+                              "%dx%d", raster.size(), width, height));
+}
+
+// Calls 'process_range' with ranges [begin, end) of size 'range_size' that
+// cover [0, 'size'). If 'thread_pool' is not nullptr, ranges will be processed
+// in parallel on it.
+void ForEachRange(int size, int range_size, ThreadPool* thread_pool,
+                  absl::FunctionRef<void(int, int)> process_range) {
+  const auto process = [size, range_size, process_range](int range_index) {
+    const int begin = range_index * range_size;
+    process_range(begin, std::min(begin + range_size, size));
+  };
+  const int num_ranges = (size + range_size - 1) / range_size;
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < num_ranges; ++i) {
+      process(i);
+    }
+  } else {
+    thread_pool->ParallelFor(num_ranges, process);
+  }
+}
+
+// Sets 'current'[i] to min('current'[i], 'previous'[i] + 1) for each i in
+// [0, 'count').
+void RelaxFromPreviousRow(const float* previous, float* current, int count) {
+  int i = 0;
+  for (; i + simd::kWidth <= count; i += simd::kWidth) {
+    const simd::Float relaxed = simd::Float::Load(previous + i) + 1.0f;
+    simd::Min(simd::Float::Load(current + i), relaxed).Store(current + i);
+  }
+  for (; i < count; ++i) {
+    current[i] = std::min(current[i], previous[i] + 1.0f);
+  }
+}
+
+// Sets 'squared'[i] to 'distances'[i]^2 * 'scale' for each i in [0, 'count').
+void ScaleSquares(const float* distances, float scale, float* squared,
+                  int count) {
+  int i = 0;
+  for (; i + simd::kWidth <= count; i += simd::kWidth) {
+    const simd::Float distance = simd::Float::Load(distances + i);
+    (distance * distance * scale).Store(squared + i);
+  }
+  for (; i < count; ++i) {
+    squared[i] = distances[i] * distances[i] * scale;
+  }
+}
+
+// Sets 'distances'[x] to sqrt((x - 'root')^2 + 'root_distance') * 'scale' for
+// each x in ['begin', 'end'), i.e. evaluates the parabola rooted at 'root' and
+// converts squared distances to normalized distances.
+void EvaluateParabola(int root, float root_distance, float scale, int begin,
+                      int end, float* distances) {
+  // Lane i holds x = 'begin' + i. All values are integers smaller than 2^24,
+  // hence they are exact in floats.
+  static const auto* lane_offsets = [] {
+    auto* offsets = new float[simd::kWidth];
+    for (int i = 0; i < simd::kWidth; ++i) {
+      offsets[i] = static_cast<float>(i);
+    }
+    return offsets;
+  }();
+
+  int x = begin;
+  simd::Float offset =
+      simd::Float::Load(lane_offsets) + static_cast<float>(begin - root);
+  for (; x + simd::kWidth <= end; x += simd::kWidth) {
+    (simd::Sqrt(offset * offset + root_distance) * scale).Store(distances + x);
+    offset = offset + static_cast<float>(simd::kWidth);
+  }
+  for (; x < end; ++x) {
+    const float scalar_offset = static_cast<float>(x - root);
+    distances[x] =
+        std::sqrt(scalar_offset * scalar_offset + root_distance) * scale;
+  }
+}
+
+// Computes the distance from each pixel in [begin, end) of each column to the
+// nearest seed in the same column, in pixels. Pixels in columns without seeds
+// are set to infinity.
+void ComputeColumnDistances(absl::Span<const uint8_t> raster, int width,
+                            int height, int column_begin, int column_end,
+                            float* distances) {
+  const int count = column_end - column_begin;
+  for (int y = 0; y < height; ++y) {
+    const int offset = y * width + column_begin;
+    for (int i = 0; i < count; ++i) {
+      distances[offset + i] = raster[offset + i] > 0 ? 0.0f : kInfinity;
+    }
+  }
+  for (int y = 1; y < height; ++y) {
+    const int offset = y * width + column_begin;
+    RelaxFromPreviousRow(distances + offset - width, distances + offset, count);
+  }
+  for (int y = height - 2; y >= 0; --y) {
+    const int offset = y * width + column_begin;
+    RelaxFromPreviousRow(distances + offset + width, distances + offset, count);
+  }
+}
+
+// Computes the distance from each pixel of a row to the nearest seed, given
+// squared distances to the nearest seeds in each column, with the lower
+// envelope of parabolas rooted at each column. 'column_distances' are in units
+// of pixels along the x-axis, and results are multiplied by 'scale'. 'roots'
+// and 'boundaries' are used as scratch buffers, whose sizes must be at least
+// 'width' and 'width' + 1. At least one value in 'column_distances' must be
+// finite.
+// Building the envelope is inherently sequential, since each parabola is
+// compared with the ones kept so far. Evaluating it is not: each parabola
+// covers a contiguous range of pixels, which is filled with SIMD instructions.
+void ComputeRowDistances(int width, const float* column_distances, float scale,
+                         int* roots, double* boundaries, float* distances) {
+  // Parabolas rooted at columns without seeds never contribute to the lower
+  // envelope, and they must be skipped to avoid computing with infinity.
+  int num_parabolas = 0;
+  for (int q = 0; q < width; ++q) {
+    if (column_distances[q] == kInfinity) {
+      continue;
+    }
+    const double value = static_cast<double>(column_distances[q]) + q * q;
+    double boundary = -std::numeric_limits<double>::infinity();
+    while (num_parabolas > 0) {
+      const int root = roots[num_parabolas - 1];
+      boundary = (value - (static_cast<double>(column_distances[root]) +
+                           root * root)) / (2.0 * (q - root));
+      if (boundary > boundaries[num_parabolas - 1]) {
+        break;
+      }
+      --num_parabolas;
+      boundary = -std::numeric_limits<double>::infinity();
+    }
+    roots[num_parabolas] = q;
+    boundaries[num_parabolas] = boundary;
+    ++num_parabolas;
+  }
+  ASSERT_TRUE(num_parabolas > 0, "No seed found in any column");
+  boundaries[num_parabolas] = std::numeric_limits<double>::infinity();
+
+  // Pixel x is covered by the first parabola whose right boundary is not less
+  // than x.
+  int begin = 0;
+  for (int parabola = 0; parabola < num_parabolas && begin < width;
+       ++parabola) {
+    const double boundary = boundaries[parabola + 1];
+    const int end = boundary >= width - 1
+                        ? width
+                        : std::max(begin, static_cast<int>(
+                                              std::floor(boundary)) + 1);
+    const int root = roots[parabola];
+    EvaluateParabola(root, column_distances[root], scale, begin, end,
+                     distances);
+    begin = end;
+  }
+}
+
+}  // namespace
+
+std::vector<float> ComputeExact(absl::Span<const uint8_t> raster,
+                                int width, int height,
+                                ThreadPool* thread_pool) {
+  ValidateRaster(raster, width, height);
+  if (std::none_of(raster.begin(), raster.end(),
+                   [](uint8_t pixel) { return pixel > 0; })) {
+    return std::vector<float>(raster.size(),
+                              jump_flooding::kDistanceWithoutSeed);
+  }
+
+  // Distances are computed in units of pixels along the x-axis, and normalized
+  // in the end. Hence, squared distances along the y-axis are scaled.
+  std::vector<float> distances(raster.size());
+  ForEachRange(width, kNumColumnsPerTask, thread_pool,
+               [&](int column_begin, int column_end) {
+    ComputeColumnDistances(raster, width, height, column_begin, column_end,
+                           distances.data());
+  });
+
+  const float y_scale = static_cast<float>(width) / static_cast<float>(height);
+  const float y_scale_squared = y_scale * y_scale;
+  const float normalize_scale = 1.0f / static_cast<float>(width);
+  ForEachRange(height, kNumRowsPerTask, thread_pool,
+               [&](int row_begin, int row_end) {
+    std::vector<float> column_distances(width);
+    std::vector<int> roots(width);
+    std::vector<double> boundaries(width + 1);
+    for (int y = row_begin; y < row_end; ++y) {
+      float* row = distances.data() + y * width;
+      ScaleSquares(row, y_scale_squared, column_distances.data(), width);
+      ComputeRowDistances(width, column_distances.data(), normalize_scale,
+                          roots.data(), boundaries.data(), row);
+    }
+  });
+  return distances;
+}
+
+std::vector<float> ComputeJumpFlooding(absl::Span<const uint8_t> raster,
+                                       int width, int height,
+                                       jump_flooding::Refinement refinement,
+                                       ThreadPool* thread_pool) {
+  const auto nearest_seeds = jump_flooding::FindNearestSeeds(
+      raster, width, height, refinement, thread_pool);
+  return jump_flooding::ComputeDistances(nearest_seeds, width, height);
+}
+
+void SaveToFile(const std::string& path, absl::Span<const float> distances,
+                int width, int height) {
+  ASSERT_TRUE(width > 0 && height > 0 && distances.size() == width * height,
+              absl::StrFormat("Number of distances (%d) mismatches with image "
+                              "size %dx%d", distances.size(), width, height));
+  std::vector<uint16_t> half_distances(distances.size());
+  std::transform(distances.begin(), distances.end(), half_distances.begin(),
+                 [](float distance) { return glm::packHalf1x16(distance); });
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.width = width;
+  header.height = height;
+
+  const bool succeeded = file::WriteFileAtomically(
+      path, [&header, &half_distances](std::ostream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(half_distances.data()),
+                   half_distances.size() * sizeof(half_distances[0]));
+      });
+  ASSERT_TRUE(succeeded, absl::StrFormat(
+      "Failed to write distance field file '%s'", path));
+}
+
+BakedDistanceField::BakedDistanceField(std::string_view path)
+    : mapped_data_{std::make_unique<MappedData>(path)} {
+  const auto* file_data = mapped_data_->data<char>();
+  const size_t file_size = mapped_data_->size();
+
+  Header header;
+  ASSERT_TRUE(file_size >= sizeof(header),
+              absl::StrFormat("Distance field file '%s' is truncated", path));
+  std::memcpy(&header, file_data, sizeof(header));
+  ASSERT_TRUE(std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                  header.version == kFormatVersion,
+              absl::StrFormat("'%s' is not a distance field file of version %d",
+                              path, kFormatVersion));
+  const uint64_t num_pixels =
+      static_cast<uint64_t>(header.width) * header.height;
+  ASSERT_TRUE(num_pixels > 0 &&
+                  file_size == sizeof(header) + num_pixels * sizeof(uint16_t),
+              absl::StrFormat("Size of distance field file '%s' mismatches "
+                              "with image size %dx%d",
+                              path, header.width, header.height));
+
+  width_ = header.width;
+  height_ = header.height;
+  half_distances_ =
+      mapped_data_->GetSpan<uint16_t>(sizeof(header), num_pixels);
+}
+
+}  // namespace lighter::common::distance_transform
@@ -0,0 +1,95 @@
+//
+//  distance_transform.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_DISTANCE_TRANSFORM_H
+#define LIGHTER_COMMON_DISTANCE_TRANSFORM_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lighter/common/file.h"
+#include "lighter/common/jump_flooding.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/absl/types/span.h"
+
+// Generates distance fields of aurora paths on the CPU, so that they can be
+// baked without a GPU. The input is a raster with one byte per pixel, same as
+// the aurora paths image dumped by the viewer, where pixels with non-zero
+// values are on paths. The output holds the distance from each pixel to the
+// nearest path pixel, where coordinates are normalized by image dimensions, in
+// the same way as the GPU generator. If there is no path pixel, all pixels are
+// set to jump_flooding::kDistanceWithoutSeed.
+namespace lighter::common::distance_transform {
+
+// Computes the exact Euclidean distance transform with the separable algorithm
+// described in: Felzenszwalb, P. F., & Huttenlocher, D. P. (2012). Distance
+// Transforms of Sampled Functions. Theory of Computing, 8(19), 415-428.
+// The column pass processes multiple columns at a time with SIMD instructions.
+// In the row pass, the lower envelope of parabolas is built sequentially, and
+// then each parabola is evaluated over its span of pixels with SIMD.
+// If 'thread_pool' is not nullptr, columns and rows will be processed in
+// parallel on it.
+std::vector<float> ComputeExact(absl::Span<const uint8_t> raster,
+                                int width, int height,
+                                ThreadPool* thread_pool = nullptr);
+
+// Computes the distance transform with the jump flooding algorithm. Results
+// are the same as the GPU generator, which may differ from the exact ones for a
+// small portion of pixels. If 'thread_pool' is not nullptr, rows will be
+// processed in parallel on it.
+std::vector<float> ComputeJumpFlooding(absl::Span<const uint8_t> raster,
+                                       int width, int height,
+                                       jump_flooding::Refinement refinement,
+                                       ThreadPool* thread_pool = nullptr);
+
+// Writes 'distances' of an image with 'width' * 'height' pixels to the file at
+// 'path', which can be loaded with BakedDistanceField later. Distances are
+// stored as half-precision floats, which is the same precision as the image
+// written by the GPU generator. This throws an exception if failed to write.
+//
+// The file is in little-endian, and consists of a header, which contains the
+// format version and image dimensions, followed by distances in row-major
+// order. The file is written atomically.
+void SaveToFile(const std::string& path, absl::Span<const float> distances,
+                int width, int height);
+
+// Holds a distance field loaded from a file written by SaveToFile(). The file
+// is memory-mapped, so that distances can be sent to the device without any
+// conversion.
+class BakedDistanceField {
+ public:
+  // Loads the file at 'path'. This throws an exception if the file is invalid.
+  explicit BakedDistanceField(std::string_view path);
+
+  // This class is neither copyable nor movable.
+  BakedDistanceField(const BakedDistanceField&) = delete;
+  BakedDistanceField& operator=(const BakedDistanceField&) = delete;
+
+  // Accessors.
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // Bits of half-precision floats.
+  absl::Span<const uint16_t> half_distances() const { return half_distances_; }
+
+ private:
+  // Mapped file.
+  std::unique_ptr<MappedData> mapped_data_;
+
+  // Dimension of image.
+  int width_;
+  int height_;
+
+  // Distances that refer to 'mapped_data_'.
+  absl::Span<const uint16_t> half_distances_;
+};
+
+}  // namespace lighter::common::distance_transform
+
+#endif  // LIGHTER_COMMON_DISTANCE_TRANSFORM_H
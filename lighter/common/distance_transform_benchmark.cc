@@ -0,0 +1,88 @@
+//
+//  distance_transform_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/distance_transform.h"
+#include "lighter/common/jump_flooding.h"
+#include "lighter/common/thread_pool.h"
+
+namespace lighter::common::distance_transform {
+namespace {
+
+using jump_flooding::Refinement;
+
+// Same as the largest aurora paths image.
+constexpr int kImageDimension = 4096;
+constexpr int kNumPixels = kImageDimension * kImageDimension;
+
+// Returns a raster that looks like aurora paths, i.e. a few thick curves.
+std::vector<uint8_t> GeneratePathsRaster() {
+  constexpr int kNumPaths = 8;
+  constexpr int kHalfThickness = 4;
+  std::vector<uint8_t> raster(kNumPixels, 0);
+  for (int path = 0; path < kNumPaths; ++path) {
+    const int base_y = kImageDimension * (path + 1) / (kNumPaths + 1);
+    for (int x = 0; x < kImageDimension; ++x) {
+      const int center_y = base_y + (x * (path + 1) / 7) % 64;
+      for (int y = center_y - kHalfThickness; y <= center_y + kHalfThickness;
+           ++y) {
+        raster[y * kImageDimension + x] = 255;
+      }
+    }
+  }
+  return raster;
+}
+
+// Reports milliseconds spent per megapixel, which can be compared with
+// timestamps of the GPU generator.
+void SetMillisecondsPerMegapixel(benchmark::State& state) {
+  state.counters["ms_per_megapixel"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kNumPixels / 1E6 / 1E3,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// Returns a thread pool with 'num_threads' threads, or nullptr if it is 1.
+std::unique_ptr<ThreadPool> CreateThreadPool(int num_threads) {
+  return num_threads > 1 ? std::make_unique<ThreadPool>(num_threads) : nullptr;
+}
+
+void BM_ExactDistanceTransform(benchmark::State& state) {
+  const auto raster = GeneratePathsRaster();
+  const auto thread_pool = CreateThreadPool(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeExact(
+        raster, kImageDimension, kImageDimension, thread_pool.get()));
+  }
+  SetMillisecondsPerMegapixel(state);
+}
+
+void BM_JumpFlooding(benchmark::State& state) {
+  const auto raster = GeneratePathsRaster();
+  const auto thread_pool = CreateThreadPool(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeJumpFlooding(
+        raster, kImageDimension, kImageDimension, Refinement::kNone,
+        thread_pool.get()));
+  }
+  SetMillisecondsPerMegapixel(state);
+}
+
+BENCHMARK(BM_ExactDistanceTransform)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JumpFlooding)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace lighter::common::distance_transform
+
+BENCHMARK_MAIN();
@@ -0,0 +1,184 @@
+//
+//  distance_transform_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/distance_transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lighter/common/jump_flooding.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/glm/gtc/packing.hpp"
+
+namespace lighter::common::distance_transform {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+using jump_flooding::Refinement;
+
+// Returns a raster where each pixel is a seed with 'probability'.
+std::vector<uint8_t> GenerateRaster(int width, int height, float probability,
+                                    int seed) {
+  std::mt19937 generator{static_cast<std::mt19937::result_type>(seed)};
+  std::bernoulli_distribution distribution{probability};
+  std::vector<uint8_t> raster(width * height);
+  for (auto& pixel : raster) {
+    pixel = distribution(generator) ? 255 : 0;
+  }
+  return raster;
+}
+
+// Returns the normalized distance from each pixel to its nearest seed found by
+// brute force.
+std::vector<float> ComputeBruteForce(const std::vector<uint8_t>& raster,
+                                     int width, int height) {
+  std::vector<float> distances(raster.size(),
+                               jump_flooding::kDistanceWithoutSeed);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      float best_distance = std::numeric_limits<float>::max();
+      for (int sy = 0; sy < height; ++sy) {
+        for (int sx = 0; sx < width; ++sx) {
+          if (raster[sy * width + sx] > 0) {
+            const float offset_x = static_cast<float>(sx - x) / width;
+            const float offset_y = static_cast<float>(sy - y) / height;
+            best_distance = std::min(
+                best_distance,
+                std::sqrt(offset_x * offset_x + offset_y * offset_y));
+          }
+        }
+      }
+      if (best_distance != std::numeric_limits<float>::max()) {
+        distances[y * width + x] = best_distance;
+      }
+    }
+  }
+  return distances;
+}
+
+// Expects 'actual' to be the same as 'expected' up to rounding errors.
+void ExpectNearlyEqual(const std::vector<float>& actual,
+                       const std::vector<float>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < actual.size(); ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 1E-5f) << "Pixel " << i;
+  }
+}
+
+TEST(DistanceTransformTest, ExactMatchesBruteForce) {
+  // Cover square and non-square images, and widths that are not multiples of
+  // SIMD width.
+  constexpr int kImageSizes[][2] = {{1, 1}, {32, 32}, {37, 21}, {13, 70}};
+  for (const auto& [width, height] : kImageSizes) {
+    const auto raster = GenerateRaster(width, height, /*probability=*/0.01f,
+                                       /*seed=*/width * height);
+    ExpectNearlyEqual(ComputeExact(raster, width, height),
+                      ComputeBruteForce(raster, width, height));
+  }
+}
+
+TEST(DistanceTransformTest, SingleSeed) {
+  constexpr int kWidth = 50, kHeight = 30;
+  std::vector<uint8_t> raster(kWidth * kHeight, 0);
+  raster[kWidth * kHeight - 1] = 255;
+  const auto distances = ComputeExact(raster, kWidth, kHeight);
+  EXPECT_FLOAT_EQ(distances[kWidth * kHeight - 1], 0.0f);
+  EXPECT_NEAR(distances[0],
+              std::sqrt(std::pow(49.0f / 50.0f, 2.0f) +
+                        std::pow(29.0f / 30.0f, 2.0f)),
+              1E-6f);
+}
+
+TEST(DistanceTransformTest, NoSeed) {
+  constexpr int kWidth = 9, kHeight = 4;
+  const std::vector<uint8_t> raster(kWidth * kHeight, 0);
+  for (const float distance : ComputeExact(raster, kWidth, kHeight)) {
+    EXPECT_EQ(distance, jump_flooding::kDistanceWithoutSeed);
+  }
+}
+
+TEST(DistanceTransformTest, ParallelMatchesSerial) {
+  constexpr int kWidth = 300, kHeight = 200;
+  const auto raster = GenerateRaster(kWidth, kHeight, /*probability=*/0.001f,
+                                     /*seed=*/1);
+  ThreadPool thread_pool{/*num_threads=*/4};
+  EXPECT_EQ(ComputeExact(raster, kWidth, kHeight, &thread_pool),
+            ComputeExact(raster, kWidth, kHeight));
+  EXPECT_EQ(ComputeJumpFlooding(raster, kWidth, kHeight, Refinement::kPlusOne,
+                                &thread_pool),
+            ComputeJumpFlooding(raster, kWidth, kHeight, Refinement::kPlusOne));
+}
+
+TEST(DistanceTransformTest, JumpFloodingIsNearlyExact) {
+  constexpr int kWidth = 128, kHeight = 128;
+  const auto raster = GenerateRaster(kWidth, kHeight, /*probability=*/0.005f,
+                                     /*seed=*/2);
+  const auto exact = ComputeExact(raster, kWidth, kHeight);
+  const auto approximate = ComputeJumpFlooding(raster, kWidth, kHeight,
+                                               Refinement::kPlusTwo);
+  int num_errors = 0;
+  for (int i = 0; i < exact.size(); ++i) {
+    // Jump flooding never finds seeds closer than the nearest one.
+    EXPECT_GE(approximate[i], exact[i] - 1E-5f);
+    if (approximate[i] > exact[i] + 1E-5f) {
+      ++num_errors;
+    }
+  }
+  EXPECT_LT(num_errors, kWidth * kHeight / 100);
+}
+
+class BakedDistanceFieldTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = stdfs::temp_directory_path() / "lighter_distance_field_test.bin";
+  }
+
+  void TearDown() override { stdfs::remove(path_); }
+
+  stdfs::path path_;
+};
+
+TEST_F(BakedDistanceFieldTest, SaveAndLoad) {
+  constexpr int kWidth = 20, kHeight = 10;
+  const auto raster = GenerateRaster(kWidth, kHeight, /*probability=*/0.05f,
+                                     /*seed=*/3);
+  const auto distances = ComputeExact(raster, kWidth, kHeight);
+  SaveToFile(path_.string(), distances, kWidth, kHeight);
+
+  const BakedDistanceField baked{path_.string()};
+  EXPECT_EQ(baked.width(), kWidth);
+  EXPECT_EQ(baked.height(), kHeight);
+  ASSERT_EQ(baked.half_distances().size(), distances.size());
+  for (int i = 0; i < distances.size(); ++i) {
+    EXPECT_NEAR(glm::unpackHalf1x16(baked.half_distances()[i]), distances[i],
+                1E-3f);
+  }
+}
+
+TEST_F(BakedDistanceFieldTest, RejectInvalidFile) {
+  {
+    std::ofstream file{path_, std::ios::out | std::ios::binary};
+    file << "Not a distance field file";
+  }
+  EXPECT_THROW(BakedDistanceField{path_.string()}, std::runtime_error);
+
+  const std::vector<float> distances(6, 0.5f);
+  SaveToFile(path_.string(), distances, /*width=*/3, /*height=*/2);
+  stdfs::resize_file(path_, stdfs::file_size(path_) - 1);
+  EXPECT_THROW(BakedDistanceField{path_.string()}, std::runtime_error);
+}
+
+}  // namespace
+}  // namespace lighter::common::distance_transform
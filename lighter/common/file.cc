@@ -7,15 +7,31 @@
 
 #include "lighter/common/file.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
+#include <optional>
+#include <random>
+#include <system_error>
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "lighter/common/thread_pool.h"
 #include "lighter/common/util.h"
 #include "lighter/shader_compiler/util.h"
 #include "third_party/absl/container/flat_hash_map.h"
 #include "third_party/absl/strings/str_format.h"
 #include "third_party/absl/strings/str_replace.h"
-#include "third_party/absl/strings/str_split.h"
 #include "tools/cpp/runfiles/runfiles.h"
 
 namespace lighter::common {
@@ -63,17 +79,230 @@ std::ifstream OpenFile(std::string_view path) {
   return file;
 }
 
-// Splits the given `text` by `delimiter`, while `num_segments` is the expected
-// length of results. An exception will be thrown if the length does not match.
-std::vector<std::string> SplitText(std::string_view text, char delimiter,
-                                   int num_segments) {
-  const std::vector<std::string> segments =
-      absl::StrSplit(text, delimiter, absl::SkipWhitespace{});
-  ASSERT_TRUE(
-      segments.size() == num_segments,
-      absl::StrFormat("Invalid number of segments (expected %d, but get %d)",
-                      num_segments, segments.size()));
-  return segments;
+// Each chunk of .obj file parsed in parallel is at least this large, so that
+// the overhead of scheduling is amortized.
+constexpr size_t kMinObjChunkSize = 1 << 20;
+
+// Maximum number of .obj file chunks per thread. Having more chunks than
+// threads helps balance the workload.
+constexpr int kMaxNumObjChunksPerThread = 4;
+
+// Indices of position, texture coordinates and normal that form a vertex, as
+// they appear in .obj file (i.e. 'index_base' is not subtracted). Vertices are
+// deduplicated with this key.
+struct ObjVertexKey {
+  template <typename H>
+  friend H AbslHashValue(H hash_state, const ObjVertexKey& key) {
+    return H::combine(std::move(hash_state),
+                      key.position, key.tex_coord, key.normal);
+  }
+
+  bool operator==(const ObjVertexKey& other) const {
+    return position == other.position && tex_coord == other.tex_coord &&
+           normal == other.normal;
+  }
+
+  int position;
+  int tex_coord;
+  int normal;
+};
+
+// Describes an error found while parsing .obj file. 'line' refers to the
+// original file content.
+struct ObjParseError {
+  std::string_view line;
+  std::string message;
+};
+
+// Content parsed from a chunk of .obj file.
+struct ObjChunk {
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec2> tex_coords;
+  std::vector<ObjVertexKey> face_vertices;
+
+  // Populated if any error is found. Parsing stops at the first error.
+  std::optional<ObjParseError> error;
+};
+
+// Returns whether 'c' separates tokens in a line of .obj file.
+bool IsObjSeparator(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Removes the next token from 'text' and returns it. Returns an empty string
+// view if there is no more tokens.
+std::string_view NextObjToken(std::string_view& text) {
+  size_t begin = 0;
+  while (begin < text.size() && IsObjSeparator(text[begin])) {
+    ++begin;
+  }
+  size_t end = begin;
+  while (end < text.size() && !IsObjSeparator(text[end])) {
+    ++end;
+  }
+  const std::string_view token = text.substr(begin, end - begin);
+  text.remove_prefix(end);
+  return token;
+}
+
+// Parses a number from the beginning of 'token'. Like std::stof() and
+// std::stoi(), trailing characters that are not part of the number are
+// ignored. Returns whether succeeded.
+bool ParseObjNumber(std::string_view token, int* value) {
+  if (!token.empty() && token[0] == '+') {
+    token.remove_prefix(1);
+  }
+  return std::from_chars(token.data(), token.data() + token.size(),
+                         *value).ec == std::errc{};
+}
+
+bool ParseObjNumber(std::string_view token, float* value) {
+  if (!token.empty() && token[0] == '+') {
+    token.remove_prefix(1);
+  }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  return std::from_chars(token.data(), token.data() + token.size(),
+                         *value).ec == std::errc{};
+#else
+  // Fall back to std::strtof() if std::from_chars() does not support floating
+  // point numbers. It requires a null-terminated string.
+  char buffer[64];
+  if (token.empty() || token.size() >= sizeof(buffer)) {
+    return false;
+  }
+  token.copy(buffer, token.size());
+  buffer[token.size()] = '\0';
+  char* end;
+  *value = std::strtof(buffer, &end);
+  return end != buffer;
+#endif  // __cpp_lib_to_chars
+}
+
+// Parses exactly 'num_values' numbers from 'text'. Returns an error message if
+// failed.
+template <typename T>
+std::optional<std::string> ParseObjNumbers(std::string_view text,
+                                           int num_values, T* values) {
+  int num_parsed = 0;
+  for (std::string_view token = NextObjToken(text); !token.empty();
+       token = NextObjToken(text)) {
+    if (num_parsed == num_values) {
+      return absl::StrFormat("Too many numbers (expected %d)", num_values);
+    }
+    if (!ParseObjNumber(token, &values[num_parsed++])) {
+      return absl::StrFormat("Invalid number '%s'", token);
+    }
+  }
+  if (num_parsed != num_values) {
+    return absl::StrFormat(
+        "Invalid number of numbers (expected %d, but get %d)",
+        num_values, num_parsed);
+  }
+  return std::nullopt;
+}
+
+// Parses a face vertex in the format of "position/tex_coord/normal". Returns
+// an error message if failed.
+std::optional<std::string> ParseObjFaceVertex(std::string_view token,
+                                              ObjVertexKey* key) {
+  int* const indices[] = {&key->position, &key->tex_coord, &key->normal};
+  for (int i = 0; i < 3; ++i) {
+    const size_t end = i < 2 ? token.find('/') : token.size();
+    if (end == std::string_view::npos ||
+        !ParseObjNumber(token.substr(0, end), indices[i])) {
+      return absl::StrFormat("Invalid face vertex '%s'", token);
+    }
+    token.remove_prefix(i < 2 ? end + 1 : end);
+  }
+  return std::nullopt;
+}
+
+// Parses one line of .obj file and appends the result to 'chunk'. Returns an
+// error message if failed.
+std::optional<std::string> ParseObjLine(std::string_view line,
+                                        ObjChunk& chunk) {
+  const std::string_view keyword = NextObjToken(line);
+  if (keyword.empty() || keyword[0] == '#') {
+    // Skip blank lines and comments.
+    return std::nullopt;
+  }
+
+  if (keyword == "v") {
+    glm::vec3& position = chunk.positions.emplace_back();
+    return ParseObjNumbers(line, /*num_values=*/3, &position[0]);
+  }
+  if (keyword == "vn") {
+    glm::vec3& normal = chunk.normals.emplace_back();
+    return ParseObjNumbers(line, /*num_values=*/3, &normal[0]);
+  }
+  if (keyword == "vt") {
+    glm::vec2& tex_coord = chunk.tex_coords.emplace_back();
+    return ParseObjNumbers(line, /*num_values=*/2, &tex_coord[0]);
+  }
+  if (keyword == "f") {
+    int num_vertices = 0;
+    for (std::string_view token = NextObjToken(line); !token.empty();
+         token = NextObjToken(line)) {
+      if (++num_vertices > 3) {
+        return std::string{"Only triangle faces are supported"};
+      }
+      if (auto error = ParseObjFaceVertex(
+              token, &chunk.face_vertices.emplace_back())) {
+        return error;
+      }
+    }
+    if (num_vertices != 3) {
+      return std::string{"Only triangle faces are supported"};
+    }
+    return std::nullopt;
+  }
+  return absl::StrFormat("Unexpected symbol '%s'", keyword);
+}
+
+// Parses 'text', which must consist of complete lines of .obj file, and
+// populates 'chunk'.
+void ParseObjChunk(std::string_view text, ObjChunk& chunk) {
+  while (!text.empty()) {
+    const size_t line_end = std::min(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, line_end);
+    // Files with CRLF line endings must yield the same face vertex keys and
+    // error messages as those with LF, hence '\r' never reaches the tokenizer.
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (auto error = ParseObjLine(line, chunk)) {
+      chunk.error = ObjParseError{line, std::move(error).value()};
+      return;
+    }
+    text.remove_prefix(std::min(line_end + 1, text.size()));
+  }
+}
+
+// Splits 'text' of .obj file into chunks at line boundaries. If 'thread_pool'
+// is nullptr or 'text' is small, only one chunk will be returned.
+std::vector<std::string_view> SplitObjText(std::string_view text,
+                                           const ThreadPool* thread_pool) {
+  int num_chunks = 1;
+  if (thread_pool != nullptr) {
+    num_chunks = static_cast<int>(std::min<size_t>(
+        text.size() / kMinObjChunkSize,
+        (thread_pool->num_threads() + 1) * kMaxNumObjChunksPerThread));
+    num_chunks = std::max(num_chunks, 1);
+  }
+
+  std::vector<std::string_view> chunks;
+  chunks.reserve(num_chunks);
+  size_t begin = 0;
+  for (int i = 1; i <= num_chunks; ++i) {
+    size_t end = text.size();
+    if (i < num_chunks) {
+      end = std::max(begin, text.size() / num_chunks * i);
+      end = std::min(text.find('\n', end), text.size());
+      end = std::min(end + 1, text.size());
+    }
+    chunks.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
 }
 
 }  // namespace
@@ -124,95 +353,194 @@ Data LoadDataFromFile(std::string_view path) {
   return data;
 }
 
+bool WriteFileAtomically(const stdfs::path& path,
+                         absl::FunctionRef<void(std::ostream&)> write) {
+  // Threads of the same process are distinguished by the random number.
+  thread_local std::mt19937_64 generator{std::random_device{}()};
+#ifdef _WIN32
+  const auto process_id = static_cast<uint64_t>(GetCurrentProcessId());
+#else
+  const auto process_id = static_cast<uint64_t>(getpid());
+#endif  // _WIN32
+  stdfs::path temp_path = path;
+  temp_path += absl::StrFormat(".%d.%016x.tmp", process_id, generator());
+
+  std::error_code error_code;
+  if (path.has_parent_path()) {
+    stdfs::create_directories(path.parent_path(), error_code);
+  }
+  {
+    std::ofstream file{temp_path,
+                       std::ios::out | std::ios::binary | std::ios::trunc};
+    if (file) {
+      write(file);
+      file.flush();
+    }
+    if (!file) {
+      file.close();
+      stdfs::remove(temp_path, error_code);
+      return false;
+    }
+  }
+  stdfs::rename(temp_path, path, error_code);
+  if (error_code) {
+    stdfs::remove(temp_path, error_code);
+    return false;
+  }
+  return true;
+}
+
+bool WriteFileAtomically(const stdfs::path& path,
+                         absl::Span<const char> data) {
+  return WriteFileAtomically(path, [data](std::ostream& file) {
+    file.write(data.data(), data.size());
+  });
+}
+
 }  // namespace file
 
-ObjFile::ObjFile(std::string_view path, int index_base) {
-  std::ifstream file = OpenFile(path);
+MappedData::MappedData(std::string_view path) : MappedData{MapFile(path)} {}
+
+MappedData::Mapping MappedData::MapFile(std::string_view path) {
+  const std::string path_str{path};
+#ifdef _WIN32
+  const HANDLE file = CreateFileA(
+      path_str.c_str(), GENERIC_READ, FILE_SHARE_READ, /*lpSecurityAttributes=*/
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+      /*hTemplateFile=*/nullptr);
+  ASSERT_TRUE(file != INVALID_HANDLE_VALUE,
+              absl::StrFormat("Failed to open file '%s'", path));
+  LARGE_INTEGER file_size;
+  ASSERT_TRUE(GetFileSizeEx(file, &file_size),
+              absl::StrFormat("Failed to get size of file '%s'", path));
+  const auto size = static_cast<size_t>(file_size.QuadPart);
+  if (size == 0) {
+    CloseHandle(file);
+    return {nullptr, 0};
+  }
+
+  const HANDLE mapping = CreateFileMappingA(
+      file, /*lpFileMappingAttributes=*/nullptr, PAGE_READONLY,
+      /*dwMaximumSizeHigh=*/0, /*dwMaximumSizeLow=*/0, /*lpName=*/nullptr);
+  CloseHandle(file);
+  ASSERT_NON_NULL(mapping, absl::StrFormat("Failed to map file '%s'", path));
+  // The view keeps the mapping alive after its handle is closed.
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, /*dwFileOffsetHigh=*/0,
+                             /*dwFileOffsetLow=*/0, size);
+  CloseHandle(mapping);
+  ASSERT_NON_NULL(data, absl::StrFormat("Failed to map file '%s'", path));
+#else
+  const int file = open(path_str.c_str(), O_RDONLY);
+  ASSERT_TRUE(file != -1, absl::StrFormat("Failed to open file '%s'", path));
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0) {
+    close(file);
+    FATAL(absl::StrFormat("Failed to get size of file '%s'", path));
+  }
+  const auto size = static_cast<size_t>(file_stat.st_size);
+  if (size == 0) {
+    close(file);
+    return {nullptr, 0};
+  }
+
+  // The mapping stays valid after the file descriptor is closed.
+  void* data = mmap(/*addr=*/nullptr, size, PROT_READ, MAP_PRIVATE, file,
+                    /*offset=*/0);
+  close(file);
+  ASSERT_TRUE(data != MAP_FAILED,
+              absl::StrFormat("Failed to map file '%s'", path));
+  // Files are usually consumed from the beginning to the end right after they
+  // are mapped, so ask the kernel to read ahead aggressively. These are only
+  // hints, hence failures are ignored.
+  madvise(data, size, MADV_SEQUENTIAL);
+  madvise(data, size, MADV_WILLNEED);
+#endif  // _WIN32
+  return {data, size};
+}
+
+void MappedData::UnmapFile(void* data, size_t size) {
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap(data, size);
+#endif  // _WIN32
+}
+
+ObjFile::ObjFile(std::string_view path, int index_base,
+                 ThreadPool* thread_pool) {
+  const MappedData file_data{path};
+  const std::string_view text{file_data.data<char>(), file_data.size()};
+
+  // Parse chunks of the file independently.
+  const std::vector<std::string_view> chunk_texts =
+      SplitObjText(text, thread_pool);
+  const auto num_chunks = static_cast<int>(chunk_texts.size());
+  std::vector<ObjChunk> chunks(num_chunks);
+  const auto parse_chunk = [&](int chunk) {
+    ParseObjChunk(chunk_texts[chunk], chunks[chunk]);
+  };
+  if (thread_pool != nullptr && num_chunks > 1) {
+    thread_pool->ParallelFor(num_chunks, parse_chunk);
+  } else {
+    for (int chunk = 0; chunk < num_chunks; ++chunk) {
+      parse_chunk(chunk);
+    }
+  }
+  for (const auto& chunk : chunks) {
+    if (chunk.error.has_value()) {
+      const ObjParseError& error = chunk.error.value();
+      const size_t offset = error.line.data() - text.data();
+      const auto line_num = 1 + std::count(text.begin(), text.begin() + offset,
+                                           '\n');
+      FATAL(absl::StrFormat("Failed to parse line %d: %s\n%s",
+                            line_num, error.line, error.message));
+    }
+  }
 
+  // Merge chunks.
   std::vector<glm::vec3> positions;
   std::vector<glm::vec3> normals;
   std::vector<glm::vec2> tex_coords;
-  absl::flat_hash_map<std::string, uint32_t> loaded_vertices;
-
-  const auto parse_line = [&](std::string_view line) {
-    const size_t non_space = line.find_first_not_of(' ');
-    if (non_space == std::string::npos || line[0] == '#') {
-      // Skip blank lines and comments.
-      return;
-    }
+  size_t num_face_vertices = 0;
+  for (auto& chunk : chunks) {
+    positions.insert(positions.end(),
+                     chunk.positions.begin(), chunk.positions.end());
+    normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    tex_coords.insert(tex_coords.end(),
+                      chunk.tex_coords.begin(), chunk.tex_coords.end());
+    num_face_vertices += chunk.face_vertices.size();
+  }
 
-    switch (line[non_space]) {
-      case 'v': {
-        // Either position, normal or texture coordinates.
-        switch (line[non_space + 1]) {
-          case ' ': {
-            // Position.
-            const auto nums = SplitText(line.substr(non_space + 2), ' ',
-                                        /*num_segments=*/3);
-            positions.push_back(
-                glm::vec3{stof(nums[0]), stof(nums[1]), stof(nums[2])});
-            break;
-          }
-          case 'n': {
-            // Normal.
-            const auto nums = SplitText(line.substr(non_space + 3), ' ',
-                                        /*num_segments=*/3);
-            normals.push_back(
-                glm::vec3{stof(nums[0]), stof(nums[1]), stof(nums[2])});
-            break;
-          }
-          case 't': {
-            // Texture coordinates.
-            const auto nums = SplitText(line.substr(non_space + 3), ' ',
-                                        /*num_segments=*/2);
-            tex_coords.push_back(glm::vec2{stof(nums[0]), stof(nums[1])});
-            break;
-          }
-          default:
-            FATAL(absl::StrFormat("Unexpected symbol '%c'",
-                                  line[non_space + 1]));
-        }
-        break;
-      }
-      case 'f': {
-        // Face.
-        for (const auto& seg : SplitText(line.substr(non_space + 2), ' ',
-                                         /*num_segments=*/3)) {
-          const auto iter = loaded_vertices.find(seg);
-          if (iter != loaded_vertices.end()) {
-            indices.push_back(iter->second);
-          } else {
-            indices.push_back(vertices.size());
-            loaded_vertices[seg] = vertices.size();
-            const auto idxs = SplitText(seg, '/', /*num_segments=*/3);
-            vertices.push_back(Vertex3DWithTex{
-                positions.at(stoi(idxs[0]) - index_base),
-                normals.at(stoi(idxs[2]) - index_base),
-                tex_coords.at(stoi(idxs[1]) - index_base),
-            });
-          }
-        }
-        break;
-      }
-      default:
-        FATAL(absl::StrFormat("Unexpected symbol '%c'", line[non_space]));
-    }
+  // Deduplicate vertices in the order they first appear in faces.
+  const auto get_element = [index_base](const auto& elements, int index,
+                                        const char* element_name) {
+    const int local_index = index - index_base;
+    ASSERT_TRUE(local_index >= 0 && local_index < elements.size(),
+                absl::StrFormat("Invalid %s index %d, while %d loaded",
+                                element_name, index, elements.size()));
+    return elements[local_index];
   };
-
-  std::string line;
-  int line_num = 1;
-  try {
-    for (; std::getline(file, line); ++line_num) {
-      parse_line(line);
+  absl::flat_hash_map<ObjVertexKey, uint32_t> loaded_vertices;
+  indices.reserve(num_face_vertices);
+  for (const auto& chunk : chunks) {
+    for (const ObjVertexKey& key : chunk.face_vertices) {
+      const auto [iter, inserted] =
+          loaded_vertices.emplace(key, static_cast<uint32_t>(vertices.size()));
+      indices.push_back(iter->second);
+      if (inserted) {
+        vertices.push_back(Vertex3DWithTex{
+            get_element(positions, key.position, "position"),
+            get_element(normals, key.normal, "normal"),
+            get_element(tex_coords, key.tex_coord, "texture coordinates"),
+        });
+      }
     }
-  } catch (const std::exception& e) {
-    FATAL(absl::StrFormat("Failed to parse line %d: %s\n%s",
-                          line_num, line, e.what()));
   }
 }
 
-ObjFilePosOnly::ObjFilePosOnly(std::string_view path, int index_base) {
-  ObjFile file(path, index_base);
+ObjFilePosOnly::ObjFilePosOnly(std::string_view path, int index_base,
+                               ThreadPool* thread_pool) {
+  ObjFile file(path, index_base, thread_pool);
   indices = std::move(file.indices);
   vertices.reserve(file.vertices.size());
   for (const auto& vertex : file.vertices) {
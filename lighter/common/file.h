@@ -9,12 +9,17 @@
 #define LIGHTER_COMMON_FILE_H
 
 #include <filesystem>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "lighter/common/data.h"
 #include "lighter/common/graphics_api.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/functional/function_ref.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
 
 namespace lighter::common {
@@ -42,11 +47,82 @@ std::string GetVulkanSdkPath(std::string_view relative_path);
 // Reads the data from file in `path`.
 Data LoadDataFromFile(std::string_view path);
 
+// Calls `write` to write the content of file in `path`. The content is written
+// to a temporary file next to `path` first, which is then renamed to `path`,
+// hence other threads and processes either see the old file or the complete
+// new file. The temporary file name contains the process ID and a random
+// number, so that concurrent writers never share it. Parent directories are
+// created if they do not exist. Returns false if failed, in which case `path`
+// is left untouched.
+bool WriteFileAtomically(const std::filesystem::path& path,
+                         absl::FunctionRef<void(std::ostream&)> write);
+
+// Writes `data` to file in `path` atomically. See the overload above.
+bool WriteFileAtomically(const std::filesystem::path& path,
+                         absl::Span<const char> data);
+
 }  // namespace file
 
-// Loads Wavefront .obj file.
+// Holds the content of a file that is mapped into memory as read-only. Unlike
+// file::LoadDataFromFile(), this does not copy the file content, and pages are
+// only loaded when they are accessed, hence this should be preferred if the
+// user only needs to read the content once. The memory will be unmapped when
+// destructed, even if this has been moved into a Data.
+class MappedData : public Data {
+ public:
+  explicit MappedData(std::string_view path);
+
+  // This class is only movable.
+  MappedData(MappedData&& rhs) noexcept = default;
+  MappedData& operator=(MappedData&& rhs) noexcept = default;
+
+  // The mapped memory is read-only.
+  template <typename T>
+  T* mut_data() = delete;
+
+  // Returns a view of 'count' elements of type T starting from byte 'offset'.
+  // The view does not own any memory, and it must not outlive this object,
+  // which is the only one that unmaps the file. The range must be within the
+  // file and aligned for T.
+  template <typename T>
+  absl::Span<const T> GetSpan(size_t offset, size_t count) const {
+    ASSERT_TRUE(offset <= size() && count <= (size() - offset) / sizeof(T),
+                absl::StrFormat("Range of %d elements at offset %d exceeds "
+                                "mapped size %d", count, offset, size()));
+    ASSERT_TRUE(offset % alignof(T) == 0,
+                absl::StrFormat("Offset %d is not aligned to %d",
+                                offset, alignof(T)));
+    return absl::MakeConstSpan(
+        reinterpret_cast<const T*>(data<char>() + offset), count);
+  }
+
+ private:
+  // Describes a memory-mapped file.
+  struct Mapping {
+    void* data;
+    size_t size;
+  };
+
+  explicit MappedData(const Mapping& mapping)
+      : Data{mapping.data, mapping.size, &UnmapFile} {}
+
+  // Maps the file in `path` into memory. If the file is empty, the returned
+  // `data` will be nullptr.
+  static Mapping MapFile(std::string_view path);
+
+  // Unmaps the memory returned by MapFile().
+  static void UnmapFile(void* data, size_t size);
+};
+
+class ThreadPool;
+
+// Loads Wavefront .obj file. Only triangle faces with positions, texture
+// coordinates and normals are supported. Vertices are deduplicated, and stored
+// in the order they first appear in faces. If 'thread_pool' is not nullptr,
+// large files will be split into chunks and parsed in parallel.
 struct ObjFile {
-  ObjFile(std::string_view path, int index_base);
+  ObjFile(std::string_view path, int index_base,
+          ThreadPool* thread_pool = nullptr);
 
   // This class is neither copyable nor movable.
   ObjFile(const ObjFile&) = delete;
@@ -59,7 +135,8 @@ struct ObjFile {
 
 // Loads Wavefront .obj file but only preserves vertex positions.
 struct ObjFilePosOnly {
-  ObjFilePosOnly(std::string_view path, int index_base);
+  ObjFilePosOnly(std::string_view path, int index_base,
+                 ThreadPool* thread_pool = nullptr);
 
   // This class is neither copyable nor movable.
   ObjFilePosOnly(const ObjFilePosOnly&) = delete;
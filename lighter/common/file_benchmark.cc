@@ -0,0 +1,192 @@
+//
+//  file_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/data.h"
+#include "lighter/common/file.h"
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/strings/numbers.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/strings/str_split.h"
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+constexpr double kBytesPerMegabyte = 1024.0 * 1024.0;
+
+// Returns paths to all regular files in the resource folder.
+const std::vector<std::string>& GetAllResourcePaths() {
+  static const auto* paths = [] {
+    const stdfs::path root = stdfs::path{file::GetResourcePath(
+        "model/cube.obj", /*want_directory_path=*/true)}.parent_path();
+    auto* paths = new std::vector<std::string>{};
+    for (const auto& entry : stdfs::recursive_directory_iterator{root}) {
+      if (entry.is_regular_file()) {
+        paths->push_back(entry.path().string());
+      }
+    }
+    return paths;
+  }();
+  return *paths;
+}
+
+// Returns the resident memory of this process in bytes, which is populated
+// from /proc/self/status. Only anonymous memory is counted, since file-backed
+// pages can be shared with the page cache and reclaimed at any time. Returns 0
+// if this is not supported on the current platform.
+int64_t GetAnonymousResidentMemory() {
+  std::ifstream status{"/proc/self/status"};
+  std::string line;
+  while (std::getline(status, line)) {
+    const std::vector<std::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipWhitespace{});
+    int64_t kilobytes;
+    if (fields.size() == 3 && fields[0] == "RssAnon:" &&
+        absl::SimpleAtoi(fields[1], &kilobytes)) {
+      return kilobytes * 1024;
+    }
+  }
+  return 0;
+}
+
+// Loads all resources with 'load_data', and keeps all of them in memory like
+// what happens at startup. Every byte is read as consumers would do. Reports
+// the wall time, the throughput, and the increase of anonymous resident memory
+// while holding all resources.
+template <typename DataType, typename LoadData>
+void RunBenchmark(benchmark::State& state, const LoadData& load_data) {
+  const auto& paths = GetAllResourcePaths();
+  int64_t total_size = 0;
+  int64_t peak_memory_increase = 0;
+  for (auto _ : state) {
+    const int64_t memory_before = GetAnonymousResidentMemory();
+    std::vector<DataType> loaded;
+    loaded.reserve(paths.size());
+    uint8_t checksum = 0;
+    total_size = 0;
+    for (const auto& path : paths) {
+      loaded.push_back(load_data(path));
+      const DataType& data = loaded.back();
+      const auto* bytes = data.template data<uint8_t>();
+      for (size_t i = 0; i < data.size(); ++i) {
+        checksum ^= bytes[i];
+      }
+      total_size += data.size();
+    }
+    benchmark::DoNotOptimize(checksum);
+    peak_memory_increase = std::max(
+        peak_memory_increase, GetAnonymousResidentMemory() - memory_before);
+  }
+  state.SetBytesProcessed(total_size * state.iterations());
+  state.counters["files"] = static_cast<double>(paths.size());
+  state.counters["peak_anon_rss_MB"] =
+      static_cast<double>(peak_memory_increase) / kBytesPerMegabyte;
+}
+
+void BM_LoadResourcesByCopy(benchmark::State& state) {
+  RunBenchmark<Data>(state, [](const std::string& path) {
+    return file::LoadDataFromFile(path);
+  });
+}
+
+void BM_LoadResourcesByMapping(benchmark::State& state) {
+  RunBenchmark<MappedData>(state, [](const std::string& path) {
+    return MappedData{path};
+  });
+}
+
+// Writes a synthetic .obj file of a grid mesh with about 'num_triangles'
+// triangles, and returns the path to it. Each grid cell is split into 2
+// triangles, and shares vertices with adjacent cells.
+std::string GenerateObjFile(int num_triangles) {
+  const int num_cells_per_side =
+      static_cast<int>(std::ceil(std::sqrt(num_triangles / 2.0)));
+  const int num_vertices_per_side = num_cells_per_side + 1;
+  const stdfs::path path = stdfs::temp_directory_path() /
+      absl::StrFormat("lighter_benchmark_%d.obj", num_triangles);
+  std::ofstream file{path, std::ios::out | std::ios::binary};
+  ASSERT_TRUE(file, absl::StrFormat("Failed to create '%s'", path.string()));
+
+  std::mt19937 generator{0};
+  std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+  for (int y = 0; y < num_vertices_per_side; ++y) {
+    for (int x = 0; x < num_vertices_per_side; ++x) {
+      file << absl::StrFormat("v %f %f %f\n", static_cast<float>(x),
+                              static_cast<float>(y), distribution(generator));
+    }
+  }
+  for (int y = 0; y < num_vertices_per_side; ++y) {
+    for (int x = 0; x < num_vertices_per_side; ++x) {
+      file << absl::StrFormat("vt %f %f\n",
+                              static_cast<float>(x) / num_cells_per_side,
+                              static_cast<float>(y) / num_cells_per_side);
+    }
+  }
+  file << "vn 0.0 0.0 1.0\n";
+
+  // .obj file indices start from 1.
+  const auto get_vertex = [num_vertices_per_side](int x, int y) {
+    const int index = y * num_vertices_per_side + x + 1;
+    return absl::StrFormat("%d/%d/1", index, index);
+  };
+  for (int y = 0; y < num_cells_per_side; ++y) {
+    for (int x = 0; x < num_cells_per_side; ++x) {
+      file << absl::StrFormat(
+          "f %s %s %s\nf %s %s %s\n",
+          get_vertex(x, y), get_vertex(x + 1, y), get_vertex(x + 1, y + 1),
+          get_vertex(x, y), get_vertex(x + 1, y + 1), get_vertex(x, y + 1));
+    }
+  }
+  return path.string();
+}
+
+// Parses a synthetic .obj file with 1M triangles using the given number of
+// threads. 0 thread means parsing on the calling thread only.
+void BM_ParseObjFile(benchmark::State& state) {
+  static const std::string* path =
+      new std::string{GenerateObjFile(/*num_triangles=*/1'000'000)};
+  const auto num_threads = static_cast<int>(state.range(0));
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (num_threads > 0) {
+    thread_pool = std::make_unique<ThreadPool>(num_threads);
+  }
+  for (auto _ : state) {
+    const ObjFile obj_file{*path, /*index_base=*/1, thread_pool.get()};
+    benchmark::DoNotOptimize(obj_file.vertices.data());
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(stdfs::file_size(*path)) * state.iterations());
+}
+
+BENCHMARK(BM_LoadResourcesByCopy)->UseRealTime();
+BENCHMARK(BM_LoadResourcesByMapping)->UseRealTime();
+BENCHMARK(BM_ParseObjFile)
+    ->Arg(0)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace lighter::common
+
+int main(int argc, char* argv[]) {
+  lighter::common::file::EnableRunfileLookup(argv[0]);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,197 @@
+//
+//  file_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "lighter/common/thread_pool.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/glm/glm.hpp"
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// Writes 'content' to a temporary file and returns the path to it.
+std::string WriteTempFile(std::string_view file_name,
+                          std::string_view content) {
+  const stdfs::path path = stdfs::temp_directory_path() / file_name;
+  std::ofstream file{path, std::ios::out | std::ios::binary};
+  file << content;
+  return path.string();
+}
+
+// Expects two loaded .obj files to be bit-identical.
+void ExpectSameObjFile(const ObjFile& expected, const ObjFile& actual) {
+  EXPECT_EQ(actual.indices, expected.indices);
+  ASSERT_EQ(actual.vertices.size(), expected.vertices.size());
+  for (int i = 0; i < actual.vertices.size(); ++i) {
+    EXPECT_EQ(std::memcmp(&actual.vertices[i], &expected.vertices[i],
+                          sizeof(actual.vertices[i])), 0)
+        << "at index " << i;
+  }
+}
+
+TEST(FileTest, MappedData) {
+  const std::string content = "mapped data\n";
+  const std::string path = WriteTempFile("lighter_mapped_data", content);
+  const MappedData data{path};
+  ASSERT_EQ(data.size(), content.size());
+  EXPECT_EQ(std::string_view(data.data<char>(), data.size()), content);
+
+  const MappedData empty_data{WriteTempFile("lighter_empty_data", "")};
+  EXPECT_EQ(empty_data.size(), 0);
+}
+
+#ifdef __linux__
+// Returns whether 'path' is mapped into memory of this process.
+bool IsFileMapped(const std::string& path) {
+  std::ifstream maps{"/proc/self/maps"};
+  const std::string content{std::istreambuf_iterator<char>{maps},
+                            std::istreambuf_iterator<char>{}};
+  return content.find(stdfs::canonical(path).string()) != std::string::npos;
+}
+
+TEST(FileTest, MappedDataMovedIntoData) {
+  const std::string content = "mapped data\n";
+  const std::string path = WriteTempFile("lighter_mapped_moved", content);
+  {
+    MappedData mapped_data{path};
+    const Data data = std::move(mapped_data);
+    ASSERT_EQ(data.size(), content.size());
+    EXPECT_EQ(std::string_view(data.data<char>(), data.size()), content);
+    EXPECT_TRUE(IsFileMapped(path));
+  }
+  // The mapping is released by Data.
+  EXPECT_FALSE(IsFileMapped(path));
+}
+#endif  // __linux__
+
+TEST(FileTest, MappedDataSpan) {
+  const std::string path = WriteTempFile("lighter_mapped_span", "0123456789");
+  const MappedData data{path};
+  const absl::Span<const char> span = data.GetSpan<char>(/*offset=*/2,
+                                                         /*count=*/5);
+  EXPECT_EQ(span.data(), data.data<char>() + 2);
+  EXPECT_EQ(std::string_view(span.data(), span.size()), "23456");
+  EXPECT_THROW(data.GetSpan<char>(/*offset=*/6, /*count=*/5),
+               std::runtime_error);
+  EXPECT_THROW(data.GetSpan<uint16_t>(/*offset=*/1, /*count=*/1),
+               std::runtime_error);
+}
+
+TEST(FileTest, WriteFileAtomically) {
+  const stdfs::path directory =
+      stdfs::temp_directory_path() / "lighter_write_atomically";
+  stdfs::remove_all(directory);
+  const stdfs::path path = directory / "sub" / "file";
+  ASSERT_TRUE(file::WriteFileAtomically(path, std::string_view{"old"}));
+  ASSERT_TRUE(file::WriteFileAtomically(path, [](std::ostream& file) {
+    file << "new content";
+  }));
+  const MappedData data{path.string()};
+  EXPECT_EQ(std::string_view(data.data<char>(), data.size()), "new content");
+
+  // No temporary file should be left.
+  EXPECT_EQ(std::distance(stdfs::directory_iterator{path.parent_path()},
+                          stdfs::directory_iterator{}), 1);
+
+  // Writing to a path that is a directory fails and leaves it untouched.
+  EXPECT_FALSE(file::WriteFileAtomically(directory / "sub",
+                                         std::string_view{"data"}));
+  EXPECT_TRUE(stdfs::is_directory(directory / "sub"));
+  EXPECT_EQ(std::distance(stdfs::directory_iterator{path.parent_path()},
+                          stdfs::directory_iterator{}), 1);
+  stdfs::remove_all(directory);
+}
+
+TEST(FileTest, ParseObjFile) {
+  const std::string path = WriteTempFile("lighter_parse.obj", R"(# comment
+v 0.0 0.0 0.0
+v 1.0 0.0 0.0
+v 1.0 1.0 -0.5
+v  0.0 1.0 +2.5e-1
+vt 0.0 0.0
+vt 1.0 1.0
+vn 0.0 0.0 1.0
+
+f 1/1/1 2/2/1 3/2/1
+f 1/1/1 3/2/1 4/1/1
+)");
+  const ObjFile obj_file{path, /*index_base=*/1};
+  EXPECT_EQ(obj_file.indices, (std::vector<uint32_t>{0, 1, 2, 0, 2, 3}));
+  ASSERT_EQ(obj_file.vertices.size(), 4);
+  EXPECT_EQ(obj_file.vertices[2].pos, (glm::vec3{1.0f, 1.0f, -0.5f}));
+  EXPECT_EQ(obj_file.vertices[3].pos, (glm::vec3{0.0f, 1.0f, 0.25f}));
+  EXPECT_EQ(obj_file.vertices[1].norm, (glm::vec3{0.0f, 0.0f, 1.0f}));
+  EXPECT_EQ(obj_file.vertices[3].tex_coord, (glm::vec2{0.0f, 0.0f}));
+}
+
+TEST(FileTest, ParseObjFileWithCrlf) {
+  constexpr std::string_view kContent =
+      "v 0.0 0.0 0.0\nv 1.0 0.0 0.0\nv 1.0 1.0 0.0\nvt 0.0 0.0\n"
+      "vn 0.0 0.0 1.0\nf 1/1/1 2/1/1 3/1/1\nf 3/1/1 2/1/1 1/1/1\n";
+  std::string crlf_content;
+  for (const char c : kContent) {
+    if (c == '\n') {
+      crlf_content += '\r';
+    }
+    crlf_content += c;
+  }
+
+  const ObjFile expected{WriteTempFile("lighter_lf.obj", kContent),
+                         /*index_base=*/1};
+  const ObjFile actual{WriteTempFile("lighter_crlf.obj", crlf_content),
+                       /*index_base=*/1};
+  EXPECT_EQ(actual.vertices.size(), 3);
+  ExpectSameObjFile(expected, actual);
+}
+
+TEST(FileTest, ParseObjFileInParallel) {
+  // Generate a file that is large enough to be split into multiple chunks.
+  constexpr int kNumVerticesPerSide = 200;
+  std::string content;
+  for (int y = 0; y < kNumVerticesPerSide; ++y) {
+    for (int x = 0; x < kNumVerticesPerSide; ++x) {
+      content += absl::StrFormat("v %d.5 %d.25 %d\nvt 0.%d 0.%d\n",
+                                 x, y, x * y, x, y);
+    }
+  }
+  content += "vn 0.0 0.0 1.0\nvn 0.0 1.0 0.0\n";
+  const auto get_vertex = [](int x, int y, int normal) {
+    const int index = y * kNumVerticesPerSide + x + 1;
+    return absl::StrFormat("%d/%d/%d", index, index, normal);
+  };
+  for (int y = 0; y + 1 < kNumVerticesPerSide; ++y) {
+    for (int x = 0; x + 1 < kNumVerticesPerSide; ++x) {
+      const int normal = x % 2 + 1;
+      content += absl::StrFormat(
+          "f %s %s %s\nf %s %s %s\n", get_vertex(x, y, normal),
+          get_vertex(x + 1, y, normal), get_vertex(x + 1, y + 1, normal),
+          get_vertex(x, y, normal), get_vertex(x + 1, y + 1, normal),
+          get_vertex(x, y + 1, normal));
+    }
+  }
+  const std::string path = WriteTempFile("lighter_parse_parallel.obj", content);
+
+  ThreadPool thread_pool{/*num_threads=*/4};
+  const ObjFile expected{path, /*index_base=*/1};
+  const ObjFile actual{path, /*index_base=*/1, &thread_pool};
+  ExpectSameObjFile(expected, actual);
+}
+
+}  // namespace
+}  // namespace lighter::common
@@ -7,9 +7,14 @@
 
 #include "lighter/common/image.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
+#include <optional>
 
 #include "lighter/common/file.h"
+#include "lighter/common/pixel.h"
+#include "lighter/common/thread_pool.h"
 #include "lighter/common/util.h"
 #include "third_party/absl/strings/str_cat.h"
 #define STB_IMAGE_IMPLEMENTATION
@@ -26,43 +31,85 @@ struct SingleImage {
   RawChunkedData data;
 };
 
-// Loads one image from 'path'. If the image has 3 channels, reload it with 4
-// channels internally.
-SingleImage LoadSingleImage(std::string_view path, int desired_channels) {
-  const Data file_data = file::LoadDataFromFile(path);
-  int width, height, channel;
-  stbi_uc* data = stbi_load_from_memory(
-      file_data.data<stbi_uc>(), static_cast<int>(file_data.size()),
-      &width, &height, &channel, desired_channels);
-  ASSERT_NON_NULL(
-      data, absl::StrFormat("Failed to read image from '%s'", path));
-
-  // If the image has 3 channels, reload it so that it has 4 channels.
+// Returns the number of channels to store for an image that has 'channel'
+// channels. Images with 3 channels will be stored with 4 channels.
+int GetStoredChannel(int channel, std::string_view path) {
   switch (channel) {
     case image::kBwImageChannel:
     case image::kRgbaImageChannel:
-      break;
+      return channel;
 
-    case image::kRgbImageChannel: {
-      stbi_image_free(data);
-      data = stbi_load_from_memory(
-          file_data.data<stbi_uc>(), static_cast<int>(file_data.size()),
-          &width, &height, &channel, STBI_rgb_alpha);
-      channel = STBI_rgb_alpha;
-      break;
-    }
+    case image::kRgbImageChannel:
+      return image::kRgbaImageChannel;
 
     default:
       FATAL(absl::StrFormat(
           "Unsupported number of channels (%d) when loading from %s",
           channel, path));
   }
+}
 
-  const Image::Dimension dimension{width, height, channel};
-  return {
-      dimension,
-      RawChunkedData{data, dimension.size_per_layer(), /*num_chunks=*/1},
-  };
+// Returns the dimension of image stored in 'file_data', which is read from the
+// header of image without decoding it.
+Image::Dimension GetStoredDimension(const Data& file_data,
+                                    std::string_view path) {
+  int width, height, channel;
+  ASSERT_TRUE(stbi_info_from_memory(
+                  file_data.data<stbi_uc>(), static_cast<int>(file_data.size()),
+                  &width, &height, &channel),
+              absl::StrFormat("Failed to read image info from '%s'", path));
+  return {width, height, GetStoredChannel(channel, path)};
+}
+
+// Loads one image from 'path' with a single decoding pass. If 'channel' is
+// std::nullopt, the number of channels is determined by the image itself, and
+// images with 3 channels will be loaded with 4 channels. Expanding images with
+// 1 or 3 channels to 4 channels is done by vectorized code, while other
+// conversions are left to stb_image. This is thread-safe.
+SingleImage LoadSingleImage(std::string_view path, bool flip_y,
+                            std::optional<int> channel = std::nullopt) {
+  const MappedData file_data{path};
+  int width, height, original_channel;
+  ASSERT_TRUE(stbi_info_from_memory(
+                  file_data.data<stbi_uc>(), static_cast<int>(file_data.size()),
+                  &width, &height, &original_channel),
+              absl::StrFormat("Failed to read image info from '%s'", path));
+  const int desired_channel = channel.has_value()
+                                  ? channel.value()
+                                  : GetStoredChannel(original_channel, path);
+  const bool should_expand =
+      desired_channel == image::kRgbaImageChannel &&
+      (original_channel == image::kBwImageChannel ||
+       original_channel == image::kRgbImageChannel);
+
+  // Rows are flipped after decoding, hence make sure stb_image does not flip
+  // them, regardless of the global setting.
+  stbi_set_flip_vertically_on_load_thread(false);
+  stbi_uc* decoded = stbi_load_from_memory(
+      file_data.data<stbi_uc>(), static_cast<int>(file_data.size()),
+      &width, &height, &original_channel,
+      should_expand ? STBI_default : desired_channel);
+  ASSERT_NON_NULL(
+      decoded, absl::StrFormat("Failed to read image from '%s'", path));
+
+  // Adopt the decoded buffer if no expansion is needed.
+  const Image::Dimension dimension{width, height, desired_channel};
+  RawChunkedData data{should_expand ? nullptr : decoded,
+                      dimension.size_per_layer(), /*num_chunks=*/1};
+  if (should_expand) {
+    const size_t num_pixels = static_cast<size_t>(width) * height;
+    auto* target = reinterpret_cast<uint8_t*>(data.GetMutData(0));
+    if (original_channel == image::kRgbImageChannel) {
+      pixel::ExpandRgbToRgba(decoded, num_pixels, target);
+    } else {
+      pixel::ExpandBwToRgba(decoded, num_pixels, target);
+    }
+    stbi_image_free(decoded);
+  }
+  if (flip_y) {
+    pixel::FlipRows(data.GetMutData(0), width * desired_channel, height);
+  }
+  return {dimension, std::move(data)};
 }
 
 // Concatenates 'directory' and each of 'relative_paths'.
@@ -99,44 +146,80 @@ int GetNumLayers(Type type) {
 }  // namespace image
 
 Image Image::LoadSingleImageFromFile(std::string_view path, bool flip_y) {
-  stbi_set_flip_vertically_on_load(flip_y);
-  SingleImage image = LoadSingleImage(path, STBI_default);
-  stbi_set_flip_vertically_on_load(false);
+  SingleImage image = LoadSingleImage(path, flip_y);
   return {Image::Type::kSingle, image.dimension, std::move(image.data)};
-} 
+}
 
 Image Image::LoadCubemapFromFiles(absl::Span<const std::string> paths,
-                                  bool flip_y) {
+                                  bool flip_y, ThreadPool* thread_pool) {
   ASSERT_TRUE(paths.size() == image::kCubemapImageLayer,
               absl::StrFormat("Length of 'paths' (%d) is not 6", paths.size()));
 
-  stbi_set_flip_vertically_on_load(flip_y);
-  const SingleImage first_image = LoadSingleImage(paths[0], STBI_default);
-  const Dimension& dimension = first_image.dimension;
+  // The dimension of the first image is read from its header, so that all
+  // images can be decoded independently.
+  const Dimension dimension =
+      GetStoredDimension(MappedData{paths[0]}, paths[0]);
   RawChunkedData cubemap_data{dimension.size_per_layer(),
                               image::kCubemapImageLayer};
-  cubemap_data.CopyChunkFrom(first_image.data_ptr(), /*chunk_index=*/0);
-  for (int i = 1; i < paths.size(); ++i) {
-    const std::string& path = paths[i];
-    const SingleImage image = LoadSingleImage(path, dimension.channel);
+  const auto load_layer = [&](int layer) {
+    const std::string& path = paths[layer];
+    const SingleImage image = LoadSingleImage(path, flip_y, dimension.channel);
     ASSERT_TRUE(image.dimension == dimension,
                 absl::StrFormat("Image loaded from %s has different dimension "
                                 "compared with the first image from %s",
                                 path, paths[0]));
-    cubemap_data.CopyChunkFrom(image.data_ptr(), /*chunk_index=*/i);
+    cubemap_data.CopyChunkFrom(image.data_ptr(), /*chunk_index=*/layer);
+  };
+
+  if (thread_pool == nullptr) {
+    for (int layer = 0; layer < paths.size(); ++layer) {
+      load_layer(layer);
+    }
+  } else {
+    // Exceptions must not escape from tasks running on worker threads, hence
+    // they are rethrown on the calling thread.
+    std::vector<std::exception_ptr> exceptions(paths.size());
+    thread_pool->ParallelFor(static_cast<int>(paths.size()), [&](int layer) {
+      try {
+        load_layer(layer);
+      } catch (...) {
+        exceptions[layer] = std::current_exception();
+      }
+    });
+    for (const auto& exception : exceptions) {
+      if (exception != nullptr) {
+        std::rethrow_exception(exception);
+      }
+    }
   }
-  stbi_set_flip_vertically_on_load(false);
 
   return {Image::Type::kCubemap, dimension, std::move(cubemap_data)};
 }
 
 Image Image::LoadCubemapFromFiles(
     std::string_view directory, absl::Span<const std::string> relative_paths,
-    bool flip_y) {
+    bool flip_y, ThreadPool* thread_pool) {
   ASSERT_TRUE(relative_paths.size() == image::kCubemapImageLayer,
               absl::StrFormat("Length of 'relative_paths' (%d) is not 6",
                               relative_paths.size()));
-  return LoadCubemapFromFiles(GetFullPaths(directory, relative_paths), flip_y);
+  return LoadCubemapFromFiles(GetFullPaths(directory, relative_paths), flip_y,
+                              thread_pool);
+}
+
+Image Image::LoadSingleImageFromData(const Dimension& dimension,
+                                     RawChunkedData&& data, bool flip_y) {
+  const int channel = dimension.channel;
+  ASSERT_TRUE(channel == image::kBwImageChannel
+                  || channel == image::kRgbaImageChannel,
+              absl::StrFormat("Unsupported number of channels: %d", channel));
+  ASSERT_TRUE(data.size() == dimension.size_per_layer(),
+              absl::StrFormat("Size of data (%d) does not match dimension "
+                              "(%d)", data.size(), dimension.size_per_layer()));
+  if (flip_y) {
+    pixel::FlipRows(data.GetMutData(0), dimension.width * channel,
+                    dimension.height);
+  }
+  return {Type::kSingle, dimension, std::move(data)};
 }
 
 Image Image::LoadCubemapFromMemory(
@@ -188,6 +271,31 @@ Image Image::LoadImagesFromMemory(
   return {type, dimension, std::move(data)};
 }
 
+std::future<Image> ImageDecoder::DecodeSingleImage(std::string path,
+                                                   bool flip_y) {
+  return thread_pool_.Submit([path = std::move(path), flip_y]() {
+    return Image::LoadSingleImageFromFile(path, flip_y);
+  });
+}
+
+std::vector<std::future<Image>> ImageDecoder::DecodeSingleImages(
+    absl::Span<const std::string> paths, bool flip_y) {
+  std::vector<std::future<Image>> images;
+  images.reserve(paths.size());
+  for (const auto& path : paths) {
+    images.push_back(DecodeSingleImage(path, flip_y));
+  }
+  return images;
+}
+
+std::future<Image> ImageDecoder::DecodeCubemap(std::vector<std::string> paths,
+                                               bool flip_y) {
+  return thread_pool_.Submit(
+      [this, paths = std::move(paths), flip_y]() {
+        return Image::LoadCubemapFromFiles(paths, flip_y, &thread_pool_);
+      });
+}
+
 std::vector<const void*> Image::GetDataPtrs() const {
   std::vector<const void*> data_ptrs(GetNumLayers());
   for (int layer = 0; layer < data_ptrs.size(); ++layer) {
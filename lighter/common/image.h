@@ -8,12 +8,14 @@
 #ifndef LIGHTER_COMMON_IMAGE_H
 #define LIGHTER_COMMON_IMAGE_H
 
+#include <future>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "lighter/common/data.h"
+#include "lighter/common/thread_pool.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
 
@@ -57,17 +59,21 @@ class Image {
 
   // Loads an image from file. The number of channels may be either 1, 3 or 4.
   // If it is 3, we will create the 4th channel internally.
+  // This is thread-safe.
   static Image LoadSingleImageFromFile(std::string_view path, bool flip_y);
 
   // Loads cubemaps from files. All images are expected to have the same width,
   // height and channel. The number of channels may be either 1, 3 or 4. If it
   // is 3, we will create the 4th channel internally.
   // The length of 'paths' and 'relative_paths' must be 6.
+  // If 'thread_pool' is not nullptr, images will be decoded in parallel on it.
+  // This is thread-safe.
   static Image LoadCubemapFromFiles(absl::Span<const std::string> paths,
-                                    bool flip_y);
+                                    bool flip_y,
+                                    ThreadPool* thread_pool = nullptr);
   static Image LoadCubemapFromFiles(
       std::string_view directory, absl::Span<const std::string> relative_paths,
-      bool flip_y);
+      bool flip_y, ThreadPool* thread_pool = nullptr);
 
   // Loads images from the memory. The data will be copied, hence the caller may
   // free the original data once the constructor returns.
@@ -76,6 +82,10 @@ class Image {
       const Dimension& dimension, const void* raw_data, bool flip_y) {
     return LoadImagesFromMemory(dimension, {&raw_data, 1}, flip_y);
   }
+  // Same as above, except that 'data' will be adopted without copying, and
+  // rows will be flipped in place if 'flip_y' is true.
+  static Image LoadSingleImageFromData(const Dimension& dimension,
+                                       RawChunkedData&& data, bool flip_y);
   // The length of 'raw_data_ptrs' must be 6.
   static Image LoadCubemapFromMemory(
       const Dimension& dimension, absl::Span<const void* const> raw_data_ptrs,
@@ -117,6 +127,34 @@ class Image {
   RawChunkedData data_;
 };
 
+// Decodes images on worker threads of a thread pool. Each returned future
+// rethrows the exception if failed to load the image. This class is
+// thread-safe.
+class ImageDecoder {
+ public:
+  explicit ImageDecoder(ThreadPool& thread_pool) : thread_pool_{thread_pool} {}
+
+  // This class is neither copyable nor movable.
+  ImageDecoder(const ImageDecoder&) = delete;
+  ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+  // Decodes a single image from 'path'.
+  std::future<Image> DecodeSingleImage(std::string path, bool flip_y);
+
+  // Decodes single images from 'paths' concurrently.
+  std::vector<std::future<Image>> DecodeSingleImages(
+      absl::Span<const std::string> paths, bool flip_y);
+
+  // Decodes a cubemap from 'paths'. Faces are also decoded concurrently.
+  // The length of 'paths' must be 6.
+  std::future<Image> DecodeCubemap(std::vector<std::string> paths,
+                                   bool flip_y);
+
+ private:
+  // Thread pool to run decoding tasks.
+  ThreadPool& thread_pool_;
+};
+
 }  // namespace lighter::common
 
 #endif  // LIGHTER_COMMON_IMAGE_H
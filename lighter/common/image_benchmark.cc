@@ -0,0 +1,92 @@
+//
+//  image_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/file.h"
+#include "lighter/common/image.h"
+#include "lighter/common/thread_pool.h"
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// Returns paths to faces of the skybox cubemap.
+std::vector<std::string> GetSkyboxPaths() {
+  const std::string directory = file::GetResourcePath(
+      "texture/tidepool/right.tga", /*want_directory_path=*/true);
+  std::vector<std::string> paths;
+  for (const char* file : {"right.tga", "left.tga", "top.tga", "bottom.tga",
+                           "back.tga", "front.tga"}) {
+    paths.push_back((stdfs::path{directory} / file).string());
+  }
+  return paths;
+}
+
+// Returns paths to all textures used by the nanosuit model.
+std::vector<std::string> GetModelTexturePaths() {
+  const std::string directory = file::GetResourcePath(
+      "model/nanosuit/nanosuit.obj", /*want_directory_path=*/true);
+  std::vector<std::string> paths;
+  for (const auto& entry : stdfs::directory_iterator{directory}) {
+    const stdfs::path extension = entry.path().extension();
+    if (extension == ".png" || extension == ".jpg" || extension == ".tga") {
+      paths.push_back(entry.path().string());
+    }
+  }
+  return paths;
+}
+
+// Loads the skybox and all model textures. If range(0) is 0, images are loaded
+// one after another on the calling thread. Otherwise, it is used as the number
+// of threads in the pool.
+void BM_LoadSkyboxAndModelTextures(benchmark::State& state) {
+  const std::vector<std::string> skybox_paths = GetSkyboxPaths();
+  const std::vector<std::string> texture_paths = GetModelTexturePaths();
+  const int num_threads = static_cast<int>(state.range(0));
+
+  for (auto _ : state) {
+    if (num_threads == 0) {
+      benchmark::DoNotOptimize(
+          Image::LoadCubemapFromFiles(skybox_paths, /*flip_y=*/false));
+      for (const auto& path : texture_paths) {
+        benchmark::DoNotOptimize(
+            Image::LoadSingleImageFromFile(path, /*flip_y=*/false));
+      }
+    } else {
+      ThreadPool thread_pool{num_threads};
+      ImageDecoder decoder{thread_pool};
+      std::future<Image> skybox =
+          decoder.DecodeCubemap(skybox_paths, /*flip_y=*/false);
+      std::vector<std::future<Image>> textures =
+          decoder.DecodeSingleImages(texture_paths, /*flip_y=*/false);
+      benchmark::DoNotOptimize(skybox.get());
+      for (auto& texture : textures) {
+        benchmark::DoNotOptimize(texture.get());
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_LoadSkyboxAndModelTextures)
+    ->Arg(0)->RangeMultiplier(2)->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
+}  // namespace lighter::common
+
+int main(int argc, char* argv[]) {
+  lighter::common::file::EnableRunfileLookup(argv[0]);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
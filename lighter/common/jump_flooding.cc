@@ -0,0 +1,267 @@
+//
+//  jump_flooding.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/jump_flooding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "lighter/common/util.h"
+#include "third_party/absl/functional/function_ref.h"
+#include "third_party/absl/strings/str_format.h"
+
+namespace lighter::common::jump_flooding {
+namespace {
+
+// Checks whether the image size is supported.
+void ValidateImageSize(int width, int height) {
+  ASSERT_TRUE(width > 0 && height > 0 && width < kMaxImageDimension &&
+                  height < kMaxImageDimension,
+              absl::StrFormat("Unsupported image size %dx%d", width, height));
+}
+
+// Number of rows processed by each task when running in parallel.
+constexpr int kNumRowsPerTask = 32;
+
+// Calls 'process_rows' with ranges of rows [begin, end) that cover the image.
+// If 'thread_pool' is not nullptr, ranges will be processed in parallel on it.
+void ForEachRowRange(int height, ThreadPool* thread_pool,
+                     absl::FunctionRef<void(int, int)> process_rows) {
+  const auto process_range = [height, process_rows](int range_index) {
+    const int begin = range_index * kNumRowsPerTask;
+    process_rows(begin, std::min(begin + kNumRowsPerTask, height));
+  };
+  const int num_ranges = (height + kNumRowsPerTask - 1) / kNumRowsPerTask;
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < num_ranges; ++i) {
+      process_range(i);
+    }
+  } else {
+    thread_pool->ParallelFor(num_ranges, process_range);
+  }
+}
+
+// Returns the nearest seed to pixel ('x', 'y') among 3x3 neighbors that are
+// 'step_width' away. 'get_seed' returns the seed at a pixel, or 'kNoSeed' if
+// it should be ignored. Consistent with shaders: neighbors are visited in
+// row-major order, and only a strictly nearer seed replaces the current best
+// one.
+template <typename GetSeed>
+uint32_t FindNearestNeighbor(int x, int y, int step_width,
+                             const GetSeed& get_seed) {
+  uint32_t best_seed = kNoSeed;
+  int best_distance = std::numeric_limits<int>::max();
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      const uint32_t seed =
+          get_seed(x + dx * step_width, y + dy * step_width);
+      if (seed == kNoSeed) {
+        continue;
+      }
+      const int offset_x = GetSeedX(seed) - x;
+      const int offset_y = GetSeedY(seed) - y;
+      const int distance = offset_x * offset_x + offset_y * offset_y;
+      if (distance < best_distance) {
+        best_distance = distance;
+        best_seed = seed;
+      }
+    }
+  }
+  return best_seed;
+}
+
+}  // namespace
+
+std::vector<int> GetStepWidths(int width, int height, Refinement refinement) {
+  const int greatest_dimension = std::max(width, height);
+  int step_width = 1;
+  while (step_width * 2 < greatest_dimension) {
+    step_width *= 2;
+  }
+
+  std::vector<int> step_widths;
+  if (greatest_dimension > 1) {
+    for (; step_width >= 1; step_width /= 2) {
+      step_widths.push_back(step_width);
+    }
+  }
+  switch (refinement) {
+    case Refinement::kNone:
+      break;
+    case Refinement::kPlusOne:
+      step_widths.push_back(1);
+      break;
+    case Refinement::kPlusTwo:
+      step_widths.push_back(2);
+      step_widths.push_back(1);
+      break;
+  }
+  return step_widths;
+}
+
+std::vector<uint32_t> InitializeSeeds(absl::Span<const uint8_t> raster,
+                                      int width, int height) {
+  ValidateImageSize(width, height);
+  ASSERT_TRUE(raster.size() == width * height,
+              absl::StrFormat("Raster size (%d) mismatches with image size "
+                              "%dx%d", raster.size(), width, height));
+  std::vector<uint32_t> seeds(raster.size());
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const int index = y * width + x;
+      seeds[index] = raster[index] > 0 ? PackSeed(x, y) : kNoSeed;
+    }
+  }
+  return seeds;
+}
+
+void RunStep(int step_width, int width, int height,
+             absl::Span<const uint32_t> src_seeds,
+             absl::Span<uint32_t> dst_seeds, ThreadPool* thread_pool) {
+  const auto get_seed = [width, height, src_seeds](int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+      return kNoSeed;
+    }
+    return src_seeds[y * width + x];
+  };
+  ForEachRowRange(height, thread_pool, [&](int row_begin, int row_end) {
+    for (int y = row_begin; y < row_end; ++y) {
+      for (int x = 0; x < width; ++x) {
+        dst_seeds[y * width + x] = FindNearestNeighbor(x, y, step_width,
+                                                       get_seed);
+      }
+    }
+  });
+}
+
+float GetTiledLoadFactor(absl::Span<const int> step_widths) {
+  int apron = 0;
+  for (const int step_width : step_widths) {
+    apron += step_width;
+  }
+  const int region_size = kTileSize + apron * 2;
+  return static_cast<float>(region_size * region_size) /
+         (kTileSize * kTileSize);
+}
+
+void RunTiledSteps(absl::Span<const int> step_widths, int width, int height,
+                   absl::Span<const uint32_t> src_seeds,
+                   absl::Span<uint32_t> dst_seeds) {
+  int apron = 0;
+  for (const int step_width : step_widths) {
+    ASSERT_TRUE(step_width <= kMaxTiledStepWidth,
+                absl::StrFormat("Step width %d is too large for tiling",
+                                step_width));
+    apron += step_width;
+  }
+  ASSERT_TRUE(apron <= kMaxTiledApron,
+              absl::StrFormat("Total step width %d is too large for tiling",
+                              apron));
+
+  const int region_size = kTileSize + apron * 2;
+  std::vector<uint32_t> region(region_size * region_size);
+  std::vector<uint32_t> temp_region(region.size());
+  for (int tile_y = 0; tile_y < height; tile_y += kTileSize) {
+    for (int tile_x = 0; tile_x < width; tile_x += kTileSize) {
+      // Pixel coordinates of the top-left corner of the region.
+      const int origin_x = tile_x - apron;
+      const int origin_y = tile_y - apron;
+      const auto is_in_image = [=](int local_x, int local_y) {
+        const int x = origin_x + local_x;
+        const int y = origin_y + local_y;
+        return x >= 0 && x < width && y >= 0 && y < height;
+      };
+
+      for (int y = 0; y < region_size; ++y) {
+        for (int x = 0; x < region_size; ++x) {
+          region[y * region_size + x] =
+              is_in_image(x, y)
+                  ? src_seeds[(origin_y + y) * width + origin_x + x]
+                  : kNoSeed;
+        }
+      }
+
+      // After each step, pixels closer to the region border than 'margin' no
+      // longer hold valid results, but they will not be read anymore. Pixels
+      // outside of the image always hold 'kNoSeed'.
+      int margin = 0;
+      for (const int step_width : step_widths) {
+        margin += step_width;
+        const auto get_seed = [&region, region_size](int x, int y) {
+          return region[y * region_size + x];
+        };
+        for (int y = 0; y < region_size; ++y) {
+          for (int x = 0; x < region_size; ++x) {
+            const int index = y * region_size + x;
+            const bool is_valid = x >= margin && x < region_size - margin &&
+                                  y >= margin && y < region_size - margin &&
+                                  is_in_image(x, y);
+            if (!is_valid) {
+              temp_region[index] = region[index];
+              continue;
+            }
+            // Seeds store pixel coordinates, hence distances must be computed
+            // with pixel coordinates rather than local coordinates.
+            const auto get_local_seed = [&](int pixel_x, int pixel_y) {
+              return get_seed(pixel_x - origin_x, pixel_y - origin_y);
+            };
+            temp_region[index] = FindNearestNeighbor(
+                origin_x + x, origin_y + y, step_width, get_local_seed);
+          }
+        }
+        std::swap(region, temp_region);
+      }
+
+      for (int y = tile_y; y < std::min(tile_y + kTileSize, height); ++y) {
+        for (int x = tile_x; x < std::min(tile_x + kTileSize, width); ++x) {
+          dst_seeds[y * width + x] =
+              region[(y - origin_y) * region_size + x - origin_x];
+        }
+      }
+    }
+  }
+}
+
+std::vector<uint32_t> FindNearestSeeds(absl::Span<const uint8_t> raster,
+                                       int width, int height,
+                                       Refinement refinement,
+                                       ThreadPool* thread_pool) {
+  std::vector<uint32_t> seeds = InitializeSeeds(raster, width, height);
+  std::vector<uint32_t> temp_seeds(seeds.size());
+  for (const int step_width : GetStepWidths(width, height, refinement)) {
+    RunStep(step_width, width, height, seeds, absl::MakeSpan(temp_seeds),
+            thread_pool);
+    std::swap(seeds, temp_seeds);
+  }
+  return seeds;
+}
+
+std::vector<float> ComputeDistances(absl::Span<const uint32_t> nearest_seeds,
+                                    int width, int height) {
+  ValidateImageSize(width, height);
+  std::vector<float> distances(nearest_seeds.size());
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const int index = y * width + x;
+      const uint32_t seed = nearest_seeds[index];
+      if (seed == kNoSeed) {
+        distances[index] = kDistanceWithoutSeed;
+        continue;
+      }
+      const float offset_x =
+          static_cast<float>(GetSeedX(seed) - x) / static_cast<float>(width);
+      const float offset_y =
+          static_cast<float>(GetSeedY(seed) - y) / static_cast<float>(height);
+      distances[index] = std::sqrt(offset_x * offset_x + offset_y * offset_y);
+    }
+  }
+  return distances;
+}
+
+}  // namespace lighter::common::jump_flooding
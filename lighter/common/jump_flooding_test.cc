@@ -0,0 +1,192 @@
+//
+//  jump_flooding_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/jump_flooding.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lighter::common::jump_flooding {
+namespace {
+
+// Returns a raster where each pixel is a seed with 'probability'.
+std::vector<uint8_t> GenerateRaster(int width, int height, float probability,
+                                    int seed) {
+  std::mt19937 generator{static_cast<std::mt19937::result_type>(seed)};
+  std::bernoulli_distribution distribution{probability};
+  std::vector<uint8_t> raster(width * height);
+  for (auto& pixel : raster) {
+    pixel = distribution(generator) ? 255 : 0;
+  }
+  return raster;
+}
+
+// Returns the squared distance from each pixel to its nearest seed found by
+// brute force, or -1 if there is no seed.
+std::vector<int> ComputeExactSquaredDistances(
+    const std::vector<uint8_t>& raster, int width, int height) {
+  std::vector<int> distances(raster.size(), -1);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int best_distance = std::numeric_limits<int>::max();
+      for (int sy = 0; sy < height; ++sy) {
+        for (int sx = 0; sx < width; ++sx) {
+          if (raster[sy * width + sx] > 0) {
+            const int distance = (sx - x) * (sx - x) + (sy - y) * (sy - y);
+            best_distance = std::min(best_distance, distance);
+          }
+        }
+      }
+      if (best_distance != std::numeric_limits<int>::max()) {
+        distances[y * width + x] = best_distance;
+      }
+    }
+  }
+  return distances;
+}
+
+// Returns the number of pixels whose nearest seeds found by JFA are not the
+// nearest ones.
+int CountErrors(const std::vector<uint32_t>& nearest_seeds,
+                const std::vector<int>& exact_distances, int width) {
+  int num_errors = 0;
+  for (int i = 0; i < nearest_seeds.size(); ++i) {
+    const int x = i % width, y = i / width;
+    const uint32_t seed = nearest_seeds[i];
+    const int distance =
+        seed == kNoSeed ? -1
+                        : (GetSeedX(seed) - x) * (GetSeedX(seed) - x) +
+                              (GetSeedY(seed) - y) * (GetSeedY(seed) - y);
+    if (distance != exact_distances[i]) {
+      ++num_errors;
+    }
+  }
+  return num_errors;
+}
+
+TEST(JumpFloodingTest, StepWidths) {
+  EXPECT_EQ(GetStepWidths(/*width=*/1, /*height=*/1, Refinement::kNone),
+            std::vector<int>{});
+  EXPECT_EQ(GetStepWidths(/*width=*/2, /*height=*/1, Refinement::kNone),
+            std::vector<int>{1});
+  EXPECT_EQ(GetStepWidths(/*width=*/16, /*height=*/5, Refinement::kNone),
+            (std::vector<int>{8, 4, 2, 1}));
+  EXPECT_EQ(GetStepWidths(/*width=*/5, /*height=*/17, Refinement::kPlusOne),
+            (std::vector<int>{16, 8, 4, 2, 1, 1}));
+  EXPECT_EQ(GetStepWidths(/*width=*/8, /*height=*/8, Refinement::kPlusTwo),
+            (std::vector<int>{4, 2, 1, 2, 1}));
+}
+
+TEST(JumpFloodingTest, SeedAtOrigin) {
+  // The pixel at the origin must be distinguishable from pixels without seeds.
+  constexpr int kWidth = 7, kHeight = 5;
+  std::vector<uint8_t> raster(kWidth * kHeight, 0);
+  raster[0] = 255;
+  const auto seeds = FindNearestSeeds(raster, kWidth, kHeight,
+                                      Refinement::kNone);
+  for (const uint32_t seed : seeds) {
+    EXPECT_EQ(seed, PackSeed(0, 0));
+  }
+
+  const auto distances = ComputeDistances(seeds, kWidth, kHeight);
+  EXPECT_FLOAT_EQ(distances[0], 0.0f);
+  EXPECT_FLOAT_EQ(distances[kWidth * kHeight - 1],
+                  std::sqrt(std::pow(6.0f / 7.0f, 2.0f) +
+                            std::pow(4.0f / 5.0f, 2.0f)));
+}
+
+TEST(JumpFloodingTest, NoSeed) {
+  constexpr int kWidth = 9, kHeight = 4;
+  const std::vector<uint8_t> raster(kWidth * kHeight, 0);
+  const auto seeds = FindNearestSeeds(raster, kWidth, kHeight,
+                                      Refinement::kPlusTwo);
+  for (const uint32_t seed : seeds) {
+    EXPECT_EQ(seed, kNoSeed);
+  }
+  for (const float distance : ComputeDistances(seeds, kWidth, kHeight)) {
+    EXPECT_EQ(distance, kDistanceWithoutSeed);
+  }
+}
+
+TEST(JumpFloodingTest, RefinementReducesErrors) {
+  constexpr int kWidth = 67, kHeight = 45;
+  const auto raster = GenerateRaster(kWidth, kHeight, /*probability=*/0.01f,
+                                     /*seed=*/0);
+  const auto exact_distances =
+      ComputeExactSquaredDistances(raster, kWidth, kHeight);
+
+  const int num_errors = CountErrors(
+      FindNearestSeeds(raster, kWidth, kHeight, Refinement::kNone),
+      exact_distances, kWidth);
+  const int num_errors_plus_one = CountErrors(
+      FindNearestSeeds(raster, kWidth, kHeight, Refinement::kPlusOne),
+      exact_distances, kWidth);
+  const int num_errors_plus_two = CountErrors(
+      FindNearestSeeds(raster, kWidth, kHeight, Refinement::kPlusTwo),
+      exact_distances, kWidth);
+  EXPECT_LE(num_errors_plus_one, num_errors);
+  EXPECT_LE(num_errors_plus_two, num_errors_plus_one);
+  // JFA is known to be accurate for almost all pixels.
+  EXPECT_LT(num_errors, kWidth * kHeight / 100);
+}
+
+TEST(JumpFloodingTest, TiledStepsMatchSeparateSteps) {
+  // Cover images that are smaller than a tile, and images whose sizes are not
+  // multiples of the tile size.
+  constexpr int kImageSizes[][2] = {{3, 2}, {32, 32}, {37, 21}, {70, 65}};
+  const std::vector<std::vector<int>> kStepWidthsToTest = {
+      {1},
+      {4, 2, 1},
+      {4, 2, 1, 1},
+      {4, 2, 1, 2, 1},
+  };
+  for (const auto& [width, height] : kImageSizes) {
+    const auto raster = GenerateRaster(width, height, /*probability=*/0.02f,
+                                       /*seed=*/width * height);
+    // Start from seeds that are partially propagated, as in the GPU pipeline.
+    std::vector<uint32_t> src_seeds = InitializeSeeds(raster, width, height);
+    std::vector<uint32_t> temp_seeds(src_seeds.size());
+    for (const int step_width : {16, 8}) {
+      RunStep(step_width, width, height, src_seeds,
+              absl::MakeSpan(temp_seeds));
+      src_seeds.swap(temp_seeds);
+    }
+
+    for (const auto& step_widths : kStepWidthsToTest) {
+      std::vector<uint32_t> expected = src_seeds;
+      for (const int step_width : step_widths) {
+        RunStep(step_width, width, height, expected,
+                absl::MakeSpan(temp_seeds));
+        expected.swap(temp_seeds);
+      }
+
+      std::vector<uint32_t> tiled(src_seeds.size());
+      RunTiledSteps(step_widths, width, height, src_seeds,
+                    absl::MakeSpan(tiled));
+      EXPECT_EQ(tiled, expected) << "Image size " << width << "x" << height
+                                 << ", " << step_widths.size() << " steps";
+    }
+  }
+}
+
+TEST(JumpFloodingTest, TiledLoadFactor) {
+  // Separate dispatches load each pixel once per step, so tiling must load
+  // fewer pixels than the number of tiled steps.
+  EXPECT_FLOAT_EQ(GetTiledLoadFactor({1}), 1.1289062f);
+  const std::vector<int> kPlainSteps = {4, 2, 1};
+  EXPECT_LT(GetTiledLoadFactor(kPlainSteps), kPlainSteps.size());
+  const std::vector<int> kRefinedSteps = {4, 2, 1, 2, 1};
+  EXPECT_LT(GetTiledLoadFactor(kRefinedSteps), kRefinedSteps.size());
+}
+
+}  // namespace
+}  // namespace lighter::common::jump_flooding
@@ -0,0 +1,486 @@
+//
+//  mesh_cache.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/mesh_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <type_traits>
+
+#include "lighter/common/model_loader.h"
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/strings/str_format.h"
+
+ABSL_FLAG(bool, use_mesh_cache, true,
+          "Cache meshes loaded from model files in binary files");
+ABSL_FLAG(std::string, mesh_cache_dir, "",
+          "Directory to store mesh cache files. If empty, a directory in the "
+          "system temporary directory will be used");
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// This should be bumped whenever the cache file format or the output of
+// loaders changes, so that stale cache files are not used.
+constexpr uint32_t kFormatVersion = 1;
+
+// Identifies mesh cache files.
+constexpr char kMagic[8] = {'L', 'T', 'R', 'M', 'E', 'S', 'H', '\0'};
+
+// Blobs in the cache file are aligned to this.
+constexpr uint64_t kBlobAlignment = 16;
+
+// Refers to a string in the string table.
+struct StringRef {
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Header of the cache file.
+struct Header {
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t vertex_size;
+  uint64_t key;
+  uint64_t vertices_offset;
+  uint64_t num_vertices;
+  uint64_t indices_offset;
+  uint64_t num_indices;
+  uint64_t meshes_offset;
+  uint64_t num_meshes;
+  uint64_t textures_offset;
+  uint64_t num_textures;
+  uint64_t dependencies_offset;
+  uint64_t num_dependencies;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+};
+
+// Element of the mesh table.
+struct MeshEntry {
+  uint64_t first_vertex;
+  uint64_t num_vertices;
+  uint64_t first_index;
+  uint64_t num_indices;
+  uint64_t first_texture;
+  uint64_t num_textures;
+};
+
+// Element of the texture table.
+struct TextureEntry {
+  StringRef path;
+  int64_t type;
+};
+
+// Element of the dependency table.
+struct DependencyEntry {
+  StringRef path;
+  uint64_t size;
+  uint64_t hash;
+};
+
+static_assert(std::is_trivially_copyable_v<Vertex3DWithTex>,
+              "Vertices must be trivially copyable to be cached");
+
+// Returns whether the host is little-endian. The cache is disabled otherwise.
+bool IsLittleEndian() {
+  const uint16_t value = 1;
+  uint8_t first_byte;
+  std::memcpy(&first_byte, &value, sizeof(first_byte));
+  return first_byte == 1;
+}
+
+// Returns 'value' rounded up to a multiple of 'alignment'.
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Returns the hash of 'text'.
+uint64_t HashString(std::string_view text) {
+  return util::HashBytes(text.data(), text.size(), /*seed=*/kFormatVersion);
+}
+
+// Returns the hash of the file content at 'path' and populates 'size' if the
+// file exists. Otherwise, returns std::nullopt.
+std::optional<uint64_t> HashFile(const std::string& path, uint64_t* size) {
+  std::error_code error_code;
+  if (!stdfs::is_regular_file(path, error_code)) {
+    return std::nullopt;
+  }
+  const MappedData data{path};
+  *size = data.size();
+  return util::HashBytes(data.data<void>(), data.size(),
+                         /*seed=*/kFormatVersion);
+}
+
+// Returns the key of the cache file for loading the model at 'model_path' with
+// loader 'options', or std::nullopt if the cache should not be used.
+std::optional<uint64_t> GetCacheKey(const std::string& model_path,
+                                    std::string_view options) {
+  if (!absl::GetFlag(FLAGS_use_mesh_cache) || !IsLittleEndian()) {
+    return std::nullopt;
+  }
+  uint64_t size;
+  const std::optional<uint64_t> hash = HashFile(model_path, &size);
+  if (!hash.has_value()) {
+    return std::nullopt;
+  }
+  const std::string key_text = absl::StrFormat(
+      "%s|%d|%016x|%d", options, sizeof(Vertex3DWithTex), hash.value(), size);
+  return HashString(key_text);
+}
+
+// Returns the path to the cache file with 'key'.
+std::string GetCachePath(uint64_t key) {
+  stdfs::path directory{absl::GetFlag(FLAGS_mesh_cache_dir)};
+  if (directory.empty()) {
+    directory = stdfs::temp_directory_path() / "lighter_mesh_cache";
+  }
+  return (directory / absl::StrFormat("%016x.mesh", key)).string();
+}
+
+// Returns whether 'num_elements' elements of 'element_size' bytes starting at
+// 'offset' are within a file of 'file_size' bytes.
+bool IsInFile(uint64_t offset, uint64_t num_elements, uint64_t element_size,
+              uint64_t file_size) {
+  return offset <= file_size &&
+         num_elements <= (file_size - offset) / element_size;
+}
+
+// Returns whether the range of 'num_elements' elements starting at 'first' is
+// within 'total' elements.
+bool IsInRange(uint64_t first, uint64_t num_elements, uint64_t total) {
+  return first <= total && num_elements <= total - first;
+}
+
+// Returns whether 'string_ref' is within the string table of 'header'.
+bool IsValidString(const StringRef& string_ref, const Header& header) {
+  return IsInRange(string_ref.offset, string_ref.size, header.strings_size);
+}
+
+// Writes cache file content to a stream, and keeps track of the offset.
+class CacheFileWriter {
+ public:
+  explicit CacheFileWriter(std::ostream& file) : file_{file} {}
+
+  // Appends 'size' bytes of 'data' to the file.
+  void Write(const void* data, uint64_t size) {
+    file_.write(static_cast<const char*>(data), size);
+    offset_ += size;
+  }
+
+  // Appends an instance of trivially copyable 'T' to the file.
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Write(&value, sizeof(T));
+  }
+
+  // Pads the file with zeros until the offset is a multiple of 'alignment'.
+  void Align(uint64_t alignment) {
+    static const char kZeros[kBlobAlignment] = {};
+    Write(kZeros, AlignUp(offset_, alignment) - offset_);
+  }
+
+ private:
+  std::ostream& file_;
+  uint64_t offset_ = 0;
+};
+
+}  // namespace
+
+std::unique_ptr<MeshCache> MeshCache::LoadObjFile(std::string_view path,
+                                                  int index_base) {
+  const std::string model_path{path};
+  const std::optional<uint64_t> key = GetCacheKey(
+      model_path, absl::StrFormat("ObjFile|%d", index_base));
+  if (key.has_value()) {
+    if (auto cache = LoadFromCacheFile(GetCachePath(key.value()),
+                                       key.value())) {
+      cache->is_loaded_from_cache_ = true;
+      return cache;
+    }
+  }
+
+  ObjFile file{path, index_base, &GetSharedThreadPool()};
+  OwnedMeshes owned_meshes;
+  owned_meshes.vertices.push_back(std::move(file.vertices));
+  owned_meshes.indices.push_back(std::move(file.indices));
+  owned_meshes.textures.push_back({});
+  if (!key.has_value()) {
+    return FromOwnedMeshes(std::move(owned_meshes));
+  }
+  return WriteAndLoadCacheFile(GetCachePath(key.value()), key.value(),
+                               std::move(owned_meshes), /*dependencies=*/{});
+}
+
+std::unique_ptr<MeshCache> MeshCache::LoadModel(
+    const std::string& model_path, const std::string& texture_dir) {
+  const std::optional<uint64_t> key = GetCacheKey(
+      model_path, absl::StrFormat("ModelLoader|%s", texture_dir));
+  if (key.has_value()) {
+    if (auto cache = LoadFromCacheFile(GetCachePath(key.value()),
+                                       key.value())) {
+      cache->is_loaded_from_cache_ = true;
+      return cache;
+    }
+  }
+
+  ModelLoader loader{model_path, texture_dir};
+  std::vector<std::string> dependencies;
+  for (const auto& source_path : loader.source_paths()) {
+    std::error_code error_code;
+    if (!stdfs::equivalent(source_path, model_path, error_code)) {
+      dependencies.push_back(source_path);
+    }
+  }
+
+  // ModelLoader only provides const access to mesh data, hence they are copied.
+  OwnedMeshes owned_meshes;
+  for (const auto& mesh_data : loader.mesh_datas()) {
+    owned_meshes.vertices.push_back(mesh_data.vertices);
+    owned_meshes.indices.push_back(mesh_data.indices);
+    auto& textures = owned_meshes.textures.emplace_back();
+    textures.reserve(mesh_data.textures.size());
+    for (const auto& texture : mesh_data.textures) {
+      textures.push_back(
+          Texture{texture.path, static_cast<int>(texture.texture_type)});
+    }
+  }
+  if (!key.has_value()) {
+    return FromOwnedMeshes(std::move(owned_meshes));
+  }
+  return WriteAndLoadCacheFile(GetCachePath(key.value()), key.value(),
+                               std::move(owned_meshes), dependencies);
+}
+
+std::unique_ptr<MeshCache> MeshCache::LoadFromCacheFile(
+    const std::string& cache_path, uint64_t key) {
+  std::error_code error_code;
+  if (!stdfs::is_regular_file(cache_path, error_code)) {
+    return nullptr;
+  }
+
+  auto mapped_data = std::make_unique<MappedData>(cache_path);
+  const auto* file_data = mapped_data->data<char>();
+  const uint64_t file_size = mapped_data->size();
+
+  // Validate the header and tables.
+  Header header;
+  if (file_size < sizeof(header)) {
+    return nullptr;
+  }
+  std::memcpy(&header, file_data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kFormatVersion ||
+      header.vertex_size != sizeof(Vertex3DWithTex) || header.key != key ||
+      header.vertices_offset % alignof(Vertex3DWithTex) != 0 ||
+      header.indices_offset % alignof(uint32_t) != 0 ||
+      !IsInFile(header.vertices_offset, header.num_vertices,
+                sizeof(Vertex3DWithTex), file_size) ||
+      !IsInFile(header.indices_offset, header.num_indices, sizeof(uint32_t),
+                file_size) ||
+      !IsInFile(header.meshes_offset, header.num_meshes, sizeof(MeshEntry),
+                file_size) ||
+      !IsInFile(header.textures_offset, header.num_textures,
+                sizeof(TextureEntry), file_size) ||
+      !IsInFile(header.dependencies_offset, header.num_dependencies,
+                sizeof(DependencyEntry), file_size) ||
+      !IsInFile(header.strings_offset, header.strings_size, /*element_size=*/1,
+                file_size)) {
+    return nullptr;
+  }
+  const auto get_string = [&](const StringRef& string_ref) {
+    return std::string{file_data + header.strings_offset + string_ref.offset,
+                       string_ref.size};
+  };
+
+  // Validate files that the loader has read.
+  for (uint64_t i = 0; i < header.num_dependencies; ++i) {
+    DependencyEntry dependency;
+    std::memcpy(&dependency, file_data + header.dependencies_offset +
+                                 i * sizeof(DependencyEntry),
+                sizeof(dependency));
+    if (!IsValidString(dependency.path, header)) {
+      return nullptr;
+    }
+    uint64_t size;
+    const std::optional<uint64_t> hash =
+        HashFile(get_string(dependency.path), &size);
+    if (!hash.has_value() || hash.value() != dependency.hash ||
+        size != dependency.size) {
+      return nullptr;
+    }
+  }
+
+  // Populate meshes. They only refer to 'mapped_data', which is owned by the
+  // cache.
+  const auto vertices = mapped_data->GetSpan<Vertex3DWithTex>(
+      header.vertices_offset, header.num_vertices);
+  const auto indices = mapped_data->GetSpan<uint32_t>(header.indices_offset,
+                                                      header.num_indices);
+  std::vector<Mesh> meshes;
+  meshes.reserve(header.num_meshes);
+  for (uint64_t i = 0; i < header.num_meshes; ++i) {
+    MeshEntry entry;
+    std::memcpy(&entry, file_data + header.meshes_offset + i * sizeof(entry),
+                sizeof(entry));
+    if (!IsInRange(entry.first_vertex, entry.num_vertices,
+                   header.num_vertices) ||
+        !IsInRange(entry.first_index, entry.num_indices, header.num_indices) ||
+        !IsInRange(entry.first_texture, entry.num_textures,
+                   header.num_textures)) {
+      return nullptr;
+    }
+
+    Mesh& mesh = meshes.emplace_back();
+    mesh.vertices = vertices.subspan(entry.first_vertex, entry.num_vertices);
+    mesh.indices = indices.subspan(entry.first_index, entry.num_indices);
+    mesh.textures.reserve(entry.num_textures);
+    for (uint64_t t = 0; t < entry.num_textures; ++t) {
+      TextureEntry texture;
+      std::memcpy(&texture, file_data + header.textures_offset +
+                                (entry.first_texture + t) * sizeof(texture),
+                  sizeof(texture));
+      if (!IsValidString(texture.path, header)) {
+        return nullptr;
+      }
+      mesh.textures.push_back(Texture{get_string(texture.path),
+                                      static_cast<int>(texture.type)});
+    }
+  }
+
+  auto cache = std::unique_ptr<MeshCache>(new MeshCache);
+  cache->mapped_data_ = std::move(mapped_data);
+  cache->meshes_ = std::move(meshes);
+  return cache;
+}
+
+std::unique_ptr<MeshCache> MeshCache::WriteAndLoadCacheFile(
+    const std::string& cache_path, uint64_t key, OwnedMeshes&& owned_meshes,
+    const std::vector<std::string>& dependencies) {
+  const auto num_meshes = owned_meshes.vertices.size();
+
+  // Build tables.
+  std::string strings;
+  const auto add_string = [&strings](std::string_view text) {
+    const StringRef string_ref{strings.size(), text.size()};
+    strings.append(text);
+    return string_ref;
+  };
+  std::vector<MeshEntry> mesh_entries;
+  std::vector<TextureEntry> texture_entries;
+  std::vector<DependencyEntry> dependency_entries;
+  uint64_t num_vertices = 0;
+  uint64_t num_indices = 0;
+  for (int i = 0; i < num_meshes; ++i) {
+    mesh_entries.push_back(MeshEntry{
+        num_vertices, owned_meshes.vertices[i].size(),
+        num_indices, owned_meshes.indices[i].size(),
+        texture_entries.size(), owned_meshes.textures[i].size(),
+    });
+    num_vertices += owned_meshes.vertices[i].size();
+    num_indices += owned_meshes.indices[i].size();
+    for (const auto& texture : owned_meshes.textures[i]) {
+      texture_entries.push_back(
+          TextureEntry{add_string(texture.path), texture.type});
+    }
+  }
+  for (const auto& dependency : dependencies) {
+    uint64_t size;
+    const std::optional<uint64_t> hash = HashFile(dependency, &size);
+    if (!hash.has_value()) {
+      // The loader has read a file that is not accessible anymore.
+      return FromOwnedMeshes(std::move(owned_meshes));
+    }
+    dependency_entries.push_back(
+        DependencyEntry{add_string(dependency), size, hash.value()});
+  }
+
+  // Compute the layout.
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.vertex_size = sizeof(Vertex3DWithTex);
+  header.key = key;
+  header.vertices_offset = AlignUp(sizeof(Header), kBlobAlignment);
+  header.num_vertices = num_vertices;
+  header.indices_offset = AlignUp(
+      header.vertices_offset + num_vertices * sizeof(Vertex3DWithTex),
+      kBlobAlignment);
+  header.num_indices = num_indices;
+  header.meshes_offset = AlignUp(
+      header.indices_offset + num_indices * sizeof(uint32_t), kBlobAlignment);
+  header.num_meshes = mesh_entries.size();
+  header.textures_offset =
+      header.meshes_offset + mesh_entries.size() * sizeof(MeshEntry);
+  header.num_textures = texture_entries.size();
+  header.dependencies_offset =
+      header.textures_offset + texture_entries.size() * sizeof(TextureEntry);
+  header.num_dependencies = dependency_entries.size();
+  header.strings_offset = header.dependencies_offset +
+                          dependency_entries.size() * sizeof(DependencyEntry);
+  header.strings_size = strings.size();
+
+  const bool succeeded =
+      file::WriteFileAtomically(cache_path, [&](std::ostream& file) {
+        CacheFileWriter writer{file};
+        writer.Write(header);
+        writer.Align(kBlobAlignment);
+        for (const auto& vertices : owned_meshes.vertices) {
+          writer.Write(vertices.data(), vertices.size() * sizeof(vertices[0]));
+        }
+        writer.Align(kBlobAlignment);
+        for (const auto& indices : owned_meshes.indices) {
+          writer.Write(indices.data(), indices.size() * sizeof(indices[0]));
+        }
+        writer.Align(kBlobAlignment);
+        for (const auto& entry : mesh_entries) {
+          writer.Write(entry);
+        }
+        for (const auto& entry : texture_entries) {
+          writer.Write(entry);
+        }
+        for (const auto& entry : dependency_entries) {
+          writer.Write(entry);
+        }
+        writer.Write(strings.data(), strings.size());
+      });
+  if (!succeeded) {
+    LOG_ERROR << absl::StreamFormat("Failed to write mesh cache file '%s'",
+                                    cache_path);
+    return FromOwnedMeshes(std::move(owned_meshes));
+  }
+
+  if (auto cache = LoadFromCacheFile(cache_path, key)) {
+    return cache;
+  }
+  return FromOwnedMeshes(std::move(owned_meshes));
+}
+
+std::unique_ptr<MeshCache> MeshCache::FromOwnedMeshes(
+    OwnedMeshes&& owned_meshes) {
+  auto cache = std::unique_ptr<MeshCache>(new MeshCache);
+  cache->owned_meshes_ = std::move(owned_meshes);
+  const OwnedMeshes& meshes = cache->owned_meshes_.value();
+  cache->meshes_.reserve(meshes.vertices.size());
+  for (int i = 0; i < meshes.vertices.size(); ++i) {
+    cache->meshes_.push_back(Mesh{
+        absl::MakeConstSpan(meshes.vertices[i]),
+        absl::MakeConstSpan(meshes.indices[i]),
+        meshes.textures[i],
+    });
+  }
+  return cache;
+}
+
+}  // namespace lighter::common
@@ -0,0 +1,130 @@
+//
+//  mesh_cache.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_MESH_CACHE_H
+#define LIGHTER_COMMON_MESH_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lighter/common/data.h"
+#include "lighter/common/file.h"
+#include "third_party/absl/types/span.h"
+
+namespace lighter::common {
+
+// Holds meshes loaded from a model file. The first time a model file is loaded,
+// it is parsed with ObjFile or ModelLoader, and the result is written to a
+// binary cache file. Later loads memory-map the cache file instead of parsing,
+// so that vertex data can be sent to the device without any conversion.
+//
+// Cache files are named after a hash of the content of the model file and the
+// loader options, hence a cache file is automatically invalidated when the
+// model file changes. Other files read by the loader, such as material
+// libraries, are recorded in the cache file and validated as well.
+//
+// Cache files are stored in the directory specified by the flag
+// --mesh_cache_dir, which defaults to a directory in the system temporary
+// directory. Caching can be disabled with --use_mesh_cache=false.
+//
+// The cache file is in little-endian, and consists of:
+//   - a header, which contains the format version and offsets of other parts,
+//   - a vertex blob, containing vertices of all meshes,
+//   - an index blob, containing indices of all meshes,
+//   - a mesh table, describing which vertices, indices and textures each mesh
+//     uses,
+//   - a texture table, containing texture types and paths,
+//   - a dependency table, containing paths and hashes of other files read by
+//     the loader,
+//   - a string table, holding all paths.
+class MeshCache {
+ public:
+  // Information about a texture.
+  struct Texture {
+    // Path to the texture.
+    std::string path;
+
+    // Texture type. This is opaque to this class, and ModelLoader uses
+    // ModelLoader::TextureType.
+    int type;
+  };
+
+  // Vertex data and textures information for one mesh.
+  struct Mesh {
+    absl::Span<const Vertex3DWithTex> vertices;
+    absl::Span<const uint32_t> indices;
+    std::vector<Texture> textures;
+  };
+
+  // Loads one mesh from the Wavefront .obj file at 'path' with ObjFile.
+  static std::unique_ptr<MeshCache> LoadObjFile(std::string_view path,
+                                                int index_base);
+
+  // Loads the model from 'model_path' and textures from 'texture_dir' with
+  // ModelLoader.
+  static std::unique_ptr<MeshCache> LoadModel(const std::string& model_path,
+                                              const std::string& texture_dir);
+
+  // This class is neither copyable nor movable.
+  MeshCache(const MeshCache&) = delete;
+  MeshCache& operator=(const MeshCache&) = delete;
+
+  // Accessors.
+  const std::vector<Mesh>& meshes() const { return meshes_; }
+  bool is_loaded_from_cache() const { return is_loaded_from_cache_; }
+
+ private:
+  // Source of meshes that is not backed by a cache file.
+  struct OwnedMeshes {
+    std::vector<std::vector<Vertex3DWithTex>> vertices;
+    std::vector<std::vector<uint32_t>> indices;
+    std::vector<std::vector<Texture>> textures;
+  };
+
+  MeshCache() = default;
+
+  // Returns meshes loaded from the cache file at 'cache_path' if it is valid.
+  // Otherwise, returns nullptr.
+  static std::unique_ptr<MeshCache> LoadFromCacheFile(
+      const std::string& cache_path, uint64_t key);
+
+  // Writes 'owned_meshes' to the cache file at 'cache_path', and then loads
+  // from it. 'dependencies' are paths to files that the loader has read,
+  // except for the model file itself. If failed to write the cache file,
+  // returns meshes backed by 'owned_meshes' instead.
+  static std::unique_ptr<MeshCache> WriteAndLoadCacheFile(
+      const std::string& cache_path, uint64_t key,
+      OwnedMeshes&& owned_meshes,
+      const std::vector<std::string>& dependencies);
+
+  // Returns meshes backed by 'owned_meshes'.
+  static std::unique_ptr<MeshCache> FromOwnedMeshes(OwnedMeshes&& owned_meshes);
+
+  // Mapped cache file. This is nullptr if meshes are backed by
+  // 'owned_meshes_'.
+  std::unique_ptr<MappedData> mapped_data_;
+
+  // Holds meshes if they are not loaded from cache.
+  std::optional<OwnedMeshes> owned_meshes_;
+
+  // Meshes that refer to either 'mapped_data_' or 'owned_meshes_'.
+  std::vector<Mesh> meshes_;
+
+  // Whether meshes are loaded from a cache file that existed before loading,
+  // i.e. the model file is not parsed. Meshes may still refer to
+  // 'mapped_data_' if this is false, since a newly written cache file is
+  // mapped as well.
+  bool is_loaded_from_cache_ = false;
+};
+
+}  // namespace lighter::common
+
+#endif  // LIGHTER_COMMON_MESH_CACHE_H
@@ -0,0 +1,90 @@
+//
+//  mesh_cache_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <filesystem>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/file.h"
+#include "lighter/common/mesh_cache.h"
+#include "third_party/absl/flags/declare.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_DECLARE_FLAG(std::string, mesh_cache_dir);
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// Returns the directory used for storing cache files in this benchmark.
+const stdfs::path& GetCacheDirectory() {
+  static const auto* directory =
+      new stdfs::path{stdfs::temp_directory_path() /
+                      "lighter_mesh_cache_benchmark"};
+  return *directory;
+}
+
+// Loads the model at 'relative_path' in the resource folder. If 'is_warm' is
+// true, the cache file is created before timing, otherwise cache files are
+// removed before each iteration.
+void LoadModel(benchmark::State& state, std::string_view relative_path,
+               bool is_warm) {
+  absl::SetFlag(&FLAGS_mesh_cache_dir, GetCacheDirectory().string());
+  const std::string model_path = file::GetResourcePath(relative_path);
+  const std::string texture_dir =
+      file::GetResourcePath(relative_path, /*want_directory_path=*/true);
+  stdfs::remove_all(GetCacheDirectory());
+  if (is_warm) {
+    MeshCache::LoadModel(model_path, texture_dir);
+  }
+
+  for (auto _ : state) {
+    if (!is_warm) {
+      state.PauseTiming();
+      stdfs::remove_all(GetCacheDirectory());
+      state.ResumeTiming();
+    }
+    const auto mesh_cache = MeshCache::LoadModel(model_path, texture_dir);
+    benchmark::DoNotOptimize(mesh_cache->meshes().data());
+    if (is_warm && !mesh_cache->is_loaded_from_cache()) {
+      state.SkipWithError("Cache file is not used");
+    }
+  }
+  stdfs::remove_all(GetCacheDirectory());
+}
+
+void BM_LoadNanosuitCold(benchmark::State& state) {
+  LoadModel(state, "model/nanosuit/nanosuit.obj", /*is_warm=*/false);
+}
+
+void BM_LoadNanosuitWarm(benchmark::State& state) {
+  LoadModel(state, "model/nanosuit/nanosuit.obj", /*is_warm=*/true);
+}
+
+void BM_LoadRockCold(benchmark::State& state) {
+  LoadModel(state, "model/rock/rock.obj", /*is_warm=*/false);
+}
+
+void BM_LoadRockWarm(benchmark::State& state) {
+  LoadModel(state, "model/rock/rock.obj", /*is_warm=*/true);
+}
+
+BENCHMARK(BM_LoadNanosuitCold)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadNanosuitWarm)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadRockCold)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadRockWarm)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace lighter::common
+
+int main(int argc, char* argv[]) {
+  lighter::common::file::EnableRunfileLookup(argv[0]);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,126 @@
+//
+//  mesh_cache_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/mesh_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "lighter/common/file.h"
+#include "third_party/absl/flags/declare.h"
+#include "third_party/absl/flags/flag.h"
+
+ABSL_DECLARE_FLAG(std::string, mesh_cache_dir);
+
+namespace lighter::common {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+constexpr std::string_view kObjFileContent = R"(v 0.0 0.0 0.0
+v 1.0 0.0 0.0
+v 1.0 1.0 0.0
+vt 0.0 0.0
+vn 0.0 0.0 1.0
+f 1/1/1 2/1/1 3/1/1
+)";
+
+class MeshCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = stdfs::temp_directory_path() / "lighter_mesh_cache_test";
+    stdfs::remove_all(directory_);
+    stdfs::create_directories(directory_);
+    absl::SetFlag(&FLAGS_mesh_cache_dir, (directory_ / "cache").string());
+  }
+
+  void TearDown() override { stdfs::remove_all(directory_); }
+
+  // Writes 'content' to the .obj file and returns the path to it.
+  std::string WriteObjFile(std::string_view content) {
+    const stdfs::path path = directory_ / "model.obj";
+    std::ofstream file{path, std::ios::out | std::ios::binary};
+    file << content;
+    return path.string();
+  }
+
+  // Expects meshes in 'mesh_cache' to be the same as what ObjFile loads.
+  void ExpectSameAsObjFile(const MeshCache& mesh_cache,
+                           const std::string& path) {
+    const ObjFile obj_file{path, /*index_base=*/1};
+    ASSERT_EQ(mesh_cache.meshes().size(), 1);
+    const MeshCache::Mesh& mesh = mesh_cache.meshes()[0];
+    EXPECT_EQ(std::vector<uint32_t>(mesh.indices.begin(), mesh.indices.end()),
+              obj_file.indices);
+    ASSERT_EQ(mesh.vertices.size(), obj_file.vertices.size());
+    EXPECT_EQ(std::memcmp(mesh.vertices.data(), obj_file.vertices.data(),
+                          sizeof(obj_file.vertices[0]) * mesh.vertices.size()),
+              0);
+  }
+
+  stdfs::path directory_;
+};
+
+TEST_F(MeshCacheTest, WriteAndLoad) {
+  const std::string path = WriteObjFile(kObjFileContent);
+  const auto cold = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_FALSE(cold->is_loaded_from_cache());
+  ExpectSameAsObjFile(*cold, path);
+
+  const auto warm = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_TRUE(warm->is_loaded_from_cache());
+  ExpectSameAsObjFile(*warm, path);
+}
+
+TEST_F(MeshCacheTest, LoadFromCacheOnlyAfterWritten) {
+  ASSERT_FALSE(stdfs::exists(directory_ / "cache"));
+  const std::string path = WriteObjFile(kObjFileContent);
+  const auto cold = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_FALSE(cold->is_loaded_from_cache());
+  ASSERT_TRUE(stdfs::exists(directory_ / "cache"));
+  EXPECT_FALSE(stdfs::is_empty(directory_ / "cache"));
+
+  const auto warm = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_TRUE(warm->is_loaded_from_cache());
+}
+
+TEST_F(MeshCacheTest, InvalidateWhenSourceChanges) {
+  const std::string path = WriteObjFile(kObjFileContent);
+  MeshCache::LoadObjFile(path, /*index_base=*/1);
+
+  WriteObjFile(std::string{kObjFileContent} + "v 0.0 1.0 0.0\n"
+                                              "f 1/1/1 3/1/1 4/1/1\n");
+  const auto mesh_cache = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_FALSE(mesh_cache->is_loaded_from_cache());
+  ExpectSameAsObjFile(*mesh_cache, path);
+  EXPECT_EQ(mesh_cache->meshes()[0].indices.size(), 6);
+
+  // The cache file of the modified model is reused.
+  const auto warm = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_TRUE(warm->is_loaded_from_cache());
+  ExpectSameAsObjFile(*warm, path);
+}
+
+TEST_F(MeshCacheTest, IgnoreCorruptedCacheFile) {
+  const std::string path = WriteObjFile(kObjFileContent);
+  MeshCache::LoadObjFile(path, /*index_base=*/1);
+
+  // Truncate all cache files.
+  for (const auto& entry : stdfs::directory_iterator{directory_ / "cache"}) {
+    stdfs::resize_file(entry.path(), stdfs::file_size(entry.path()) / 2);
+  }
+  const auto mesh_cache = MeshCache::LoadObjFile(path, /*index_base=*/1);
+  EXPECT_FALSE(mesh_cache->is_loaded_from_cache());
+  ExpectSameAsObjFile(*mesh_cache, path);
+}
+
+}  // namespace
+}  // namespace lighter::common
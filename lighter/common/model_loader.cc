@@ -7,14 +7,38 @@
 
 #include "lighter/common/model_loader.h"
 
+#include <algorithm>
+
 #include "lighter/common/util.h"
 #include "third_party/absl/strings/str_format.h"
+#include "third_party/assimp/DefaultIOSystem.h"
 #include "third_party/assimp/Importer.hpp"
 #include "third_party/assimp/postprocess.h"
 
 namespace lighter::common {
 namespace {
 
+// Records paths to all files that Assimp opens.
+class RecordingIOSystem : public Assimp::DefaultIOSystem {
+ public:
+  explicit RecordingIOSystem(std::vector<std::string>* opened_files)
+      : opened_files_{*FATAL_IF_NULL(opened_files)} {}
+
+  // Overrides.
+  Assimp::IOStream* Open(const char* file, const char* mode) override {
+    Assimp::IOStream* stream = DefaultIOSystem::Open(file, mode);
+    if (stream != nullptr &&
+        std::find(opened_files_.begin(), opened_files_.end(), file) ==
+            opened_files_.end()) {
+      opened_files_.push_back(file);
+    }
+    return stream;
+  }
+
+ private:
+  std::vector<std::string>& opened_files_;
+};
+
 // Translates the resource type we defined to its counterpart in Assimp.
 aiTextureType TextureTypeToAssimpType(ModelLoader::TextureType type) {
   using TextureType = ModelLoader::TextureType;
@@ -40,6 +64,8 @@ ModelLoader::ModelLoader(const std::string& model_path,
                                      | aiProcess_FlipUVs;
 
   Assimp::Importer importer;
+  // The importer takes the ownership of the IO system.
+  importer.SetIOHandler(new RecordingIOSystem{&source_paths_});
   const aiScene* scene = importer.ReadFile(model_path, flags);
   ASSERT_FALSE(scene == nullptr || scene->mRootNode == nullptr ||
                (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE),
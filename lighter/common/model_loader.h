@@ -65,6 +65,9 @@ class ModelLoader {
 
   // Accessors.
   const std::vector<MeshData>& mesh_datas() const { return mesh_datas_; }
+  const std::vector<std::string>& source_paths() const {
+    return source_paths_;
+  }
 
  private:
   // Processes the 'node' in Assimp scene graph. This adds all the data of
@@ -87,6 +90,10 @@ class ModelLoader {
 
   // Holds the data of all meshes in one model.
   std::vector<MeshData> mesh_datas_;
+
+  // Paths to all files read by Assimp while loading the model, including the
+  // model file itself and others it refers to, such as material libraries.
+  std::vector<std::string> source_paths_;
 };
 
 }  // namespace lighter::common
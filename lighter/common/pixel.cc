@@ -0,0 +1,219 @@
+//
+//  pixel.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/pixel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "lighter/common/simd.h"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define LIGHTER_PIXEL_SSSE3
+#endif
+
+#if defined(LIGHTER_SIMD_AVX) || defined(LIGHTER_SIMD_SSE)
+#define LIGHTER_PIXEL_SSE2
+#endif
+
+namespace lighter::common::pixel {
+namespace {
+
+constexpr int kNumColorChannels = 3;
+constexpr int kRgbaChannel = 4;
+constexpr uint8_t kOpaqueAlpha = 255;
+
+// Maps each 8-bit value to another.
+using LookupTable = std::array<uint8_t, 256>;
+
+// Returns a lookup table that maps each 8-bit value x to
+// round(255 * 'convert'(x / 255)).
+template <typename Convert>
+LookupTable BuildLookupTable(Convert&& convert) {
+  LookupTable table;
+  for (int i = 0; i < table.size(); ++i) {
+    const double value = convert(i / 255.0);
+    table[i] = static_cast<uint8_t>(
+        std::lround(std::clamp(value, 0.0, 1.0) * 255.0));
+  }
+  return table;
+}
+
+const LookupTable& GetSrgbToLinearTable() {
+  static const LookupTable table = BuildLookupTable([](double value) {
+    return value <= 0.04045 ? value / 12.92
+                            : std::pow((value + 0.055) / 1.055, 2.4);
+  });
+  return table;
+}
+
+const LookupTable& GetLinearToSrgbTable() {
+  static const LookupTable table = BuildLookupTable([](double value) {
+    return value <= 0.0031308 ? value * 12.92
+                              : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+  });
+  return table;
+}
+
+// Converts color channels of 'num_pixels' RGBA pixels with 'table'.
+void ConvertColorChannels(const LookupTable& table,
+                          uint8_t* pixels, size_t num_pixels) {
+  for (size_t i = 0; i < num_pixels; ++i) {
+    uint8_t* pixel = pixels + i * kRgbaChannel;
+    for (int c = 0; c < kNumColorChannels; ++c) {
+      pixel[c] = table[pixel[c]];
+    }
+  }
+}
+
+// Returns round('color' * 'alpha' / 255) without division.
+inline uint8_t MultiplyAlpha(uint8_t color, uint8_t alpha) {
+  const uint32_t product = uint32_t{color} * alpha + 128;
+  return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+#ifdef LIGHTER_PIXEL_SSE2
+// Premultiplies alpha of 2 RGBA pixels, whose channels are widened to 16 bits.
+inline __m128i PremultiplyWidenedPixels(__m128i pixels) {
+  // Broadcast alpha to all channels, except for alpha itself which is
+  // multiplied by 255, so that the same rounding keeps it unchanged.
+  const __m128i keep_color = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i opaque_alpha = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+  __m128i alpha = _mm_shufflehi_epi16(
+      _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_or_si128(_mm_and_si128(alpha, keep_color), opaque_alpha);
+
+  // Same as MultiplyAlpha(). None of these overflows 16 bits.
+  __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha),
+                                  _mm_set1_epi16(128));
+  product = _mm_add_epi16(product, _mm_srli_epi16(product, 8));
+  return _mm_srli_epi16(product, 8);
+}
+#endif  // LIGHTER_PIXEL_SSE2
+
+}  // namespace
+
+void ExpandRgbToRgba(const uint8_t* source, size_t num_pixels,
+                     uint8_t* destination) {
+  size_t i = 0;
+#if defined(LIGHTER_PIXEL_SSSE3)
+  // Each iteration loads 16 bytes but only consumes 4 pixels (12 bytes), hence
+  // stop early to avoid reading past the end.
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+                                        6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  for (; i + 6 <= num_pixels; i += 4) {
+    const __m128i rgb = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(source + i * kNumColorChannels));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(destination + i * kRgbaChannel),
+        _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+  }
+#elif defined(LIGHTER_PIXEL_SSE2)
+  // x86 is little-endian, hence 4 pixels can be assembled from 3 words.
+  constexpr uint32_t kAlpha = 0xFF000000;
+  for (; i + 4 <= num_pixels; i += 4) {
+    uint32_t words[3];
+    std::memcpy(words, source + i * kNumColorChannels, sizeof(words));
+    const uint32_t rgba[] = {
+        words[0] | kAlpha,
+        (words[0] >> 24) | (words[1] << 8) | kAlpha,
+        (words[1] >> 16) | (words[2] << 16) | kAlpha,
+        (words[2] >> 8) | kAlpha,
+    };
+    std::memcpy(destination + i * kRgbaChannel, rgba, sizeof(rgba));
+  }
+#endif
+  for (; i < num_pixels; ++i) {
+    const uint8_t* rgb = source + i * kNumColorChannels;
+    uint8_t* rgba = destination + i * kRgbaChannel;
+    rgba[0] = rgb[0];
+    rgba[1] = rgb[1];
+    rgba[2] = rgb[2];
+    rgba[3] = kOpaqueAlpha;
+  }
+}
+
+void ExpandBwToRgba(const uint8_t* source, size_t num_pixels,
+                    uint8_t* destination) {
+  size_t i = 0;
+#ifdef LIGHTER_PIXEL_SSE2
+  const __m128i alpha = _mm_set1_epi8(static_cast<char>(kOpaqueAlpha));
+  for (; i + 16 <= num_pixels; i += 16) {
+    const __m128i bw =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+    // Interleave to (x, x) and (x, alpha), and then to (x, x, x, alpha).
+    const __m128i bw_bw_lo = _mm_unpacklo_epi8(bw, bw);
+    const __m128i bw_bw_hi = _mm_unpackhi_epi8(bw, bw);
+    const __m128i bw_alpha_lo = _mm_unpacklo_epi8(bw, alpha);
+    const __m128i bw_alpha_hi = _mm_unpackhi_epi8(bw, alpha);
+    auto* target = reinterpret_cast<__m128i*>(destination + i * kRgbaChannel);
+    _mm_storeu_si128(target + 0, _mm_unpacklo_epi16(bw_bw_lo, bw_alpha_lo));
+    _mm_storeu_si128(target + 1, _mm_unpackhi_epi16(bw_bw_lo, bw_alpha_lo));
+    _mm_storeu_si128(target + 2, _mm_unpacklo_epi16(bw_bw_hi, bw_alpha_hi));
+    _mm_storeu_si128(target + 3, _mm_unpackhi_epi16(bw_bw_hi, bw_alpha_hi));
+  }
+#endif  // LIGHTER_PIXEL_SSE2
+  for (; i < num_pixels; ++i) {
+    uint8_t* rgba = destination + i * kRgbaChannel;
+    rgba[0] = rgba[1] = rgba[2] = source[i];
+    rgba[3] = kOpaqueAlpha;
+  }
+}
+
+void ConvertSrgbToLinear(uint8_t* pixels, size_t num_pixels) {
+  ConvertColorChannels(GetSrgbToLinearTable(), pixels, num_pixels);
+}
+
+void ConvertLinearToSrgb(uint8_t* pixels, size_t num_pixels) {
+  ConvertColorChannels(GetLinearToSrgbTable(), pixels, num_pixels);
+}
+
+void PremultiplyAlpha(uint8_t* pixels, size_t num_pixels) {
+  size_t i = 0;
+#ifdef LIGHTER_PIXEL_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= num_pixels; i += 4) {
+    auto* target = reinterpret_cast<__m128i*>(pixels + i * kRgbaChannel);
+    const __m128i rgba = _mm_loadu_si128(target);
+    _mm_storeu_si128(target, _mm_packus_epi16(
+        PremultiplyWidenedPixels(_mm_unpacklo_epi8(rgba, zero)),
+        PremultiplyWidenedPixels(_mm_unpackhi_epi8(rgba, zero))));
+  }
+#endif  // LIGHTER_PIXEL_SSE2
+  for (; i < num_pixels; ++i) {
+    uint8_t* rgba = pixels + i * kRgbaChannel;
+    for (int c = 0; c < kNumColorChannels; ++c) {
+      rgba[c] = MultiplyAlpha(rgba[c], rgba[3]);
+    }
+  }
+}
+
+void FlipRows(void* data, size_t row_size, int num_rows) {
+  auto* bytes = static_cast<uint8_t*>(data);
+  for (int top = 0, bottom = num_rows - 1; top < bottom; ++top, --bottom) {
+    uint8_t* top_row = bytes + row_size * top;
+    uint8_t* bottom_row = bytes + row_size * bottom;
+    size_t i = 0;
+#ifdef LIGHTER_PIXEL_SSE2
+    for (; i + 16 <= row_size; i += 16) {
+      auto* top_target = reinterpret_cast<__m128i*>(top_row + i);
+      auto* bottom_target = reinterpret_cast<__m128i*>(bottom_row + i);
+      const __m128i top_value = _mm_loadu_si128(top_target);
+      _mm_storeu_si128(top_target, _mm_loadu_si128(bottom_target));
+      _mm_storeu_si128(bottom_target, top_value);
+    }
+#endif  // LIGHTER_PIXEL_SSE2
+    std::swap_ranges(top_row + i, top_row + row_size, bottom_row + i);
+  }
+}
+
+}  // namespace lighter::common::pixel
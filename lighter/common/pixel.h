@@ -0,0 +1,44 @@
+//
+//  pixel.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_PIXEL_H
+#define LIGHTER_COMMON_PIXEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// This file provides conversions of 8-bit pixels. They are vectorized with SSE
+// when available, and produce the same results as the scalar code otherwise.
+
+namespace lighter::common::pixel {
+
+// Expands 'num_pixels' RGB pixels in 'source' to RGBA pixels in 'destination',
+// setting alpha to 255. 'source' and 'destination' must not overlap.
+void ExpandRgbToRgba(const uint8_t* source, size_t num_pixels,
+                     uint8_t* destination);
+
+// Expands 'num_pixels' single channel pixels in 'source' to RGBA pixels in
+// 'destination', where each color channel has the same value and alpha is 255.
+// 'source' and 'destination' must not overlap.
+void ExpandBwToRgba(const uint8_t* source, size_t num_pixels,
+                    uint8_t* destination);
+
+// Converts color channels of 'num_pixels' RGBA pixels in place, from sRGB to
+// linear and vice versa. Alpha is not changed.
+void ConvertSrgbToLinear(uint8_t* pixels, size_t num_pixels);
+void ConvertLinearToSrgb(uint8_t* pixels, size_t num_pixels);
+
+// Multiplies color channels of 'num_pixels' RGBA pixels by alpha in place,
+// rounding to the nearest integer.
+void PremultiplyAlpha(uint8_t* pixels, size_t num_pixels);
+
+// Flips 'num_rows' rows of 'row_size' bytes each in place vertically.
+void FlipRows(void* data, size_t row_size, int num_rows);
+
+}  // namespace lighter::common::pixel
+
+#endif  // LIGHTER_COMMON_PIXEL_H
@@ -0,0 +1,85 @@
+//
+//  pixel_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/pixel.h"
+
+namespace lighter::common::pixel {
+namespace {
+
+// Same as a 2K texture.
+constexpr int kImageWidth = 2048;
+constexpr int kImageHeight = 2048;
+constexpr int kNumPixels = kImageWidth * kImageHeight;
+
+// Reports throughput in megapixels per second.
+void SetMegapixelsProcessed(benchmark::State& state) {
+  state.counters["megapixels"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kNumPixels / 1E6,
+      benchmark::Counter::kIsRate);
+}
+
+void BM_ExpandRgbToRgba(benchmark::State& state) {
+  const std::vector<uint8_t> source(kNumPixels * 3, 128);
+  std::vector<uint8_t> destination(kNumPixels * 4);
+  for (auto _ : state) {
+    ExpandRgbToRgba(source.data(), kNumPixels, destination.data());
+    benchmark::ClobberMemory();
+  }
+  SetMegapixelsProcessed(state);
+}
+
+void BM_ExpandBwToRgba(benchmark::State& state) {
+  const std::vector<uint8_t> source(kNumPixels, 128);
+  std::vector<uint8_t> destination(kNumPixels * 4);
+  for (auto _ : state) {
+    ExpandBwToRgba(source.data(), kNumPixels, destination.data());
+    benchmark::ClobberMemory();
+  }
+  SetMegapixelsProcessed(state);
+}
+
+void BM_ConvertSrgbToLinear(benchmark::State& state) {
+  std::vector<uint8_t> pixels(kNumPixels * 4, 128);
+  for (auto _ : state) {
+    ConvertSrgbToLinear(pixels.data(), kNumPixels);
+    benchmark::ClobberMemory();
+  }
+  SetMegapixelsProcessed(state);
+}
+
+void BM_PremultiplyAlpha(benchmark::State& state) {
+  std::vector<uint8_t> pixels(kNumPixels * 4, 128);
+  for (auto _ : state) {
+    PremultiplyAlpha(pixels.data(), kNumPixels);
+    benchmark::ClobberMemory();
+  }
+  SetMegapixelsProcessed(state);
+}
+
+void BM_FlipRows(benchmark::State& state) {
+  std::vector<uint8_t> pixels(kNumPixels * 4, 128);
+  for (auto _ : state) {
+    FlipRows(pixels.data(), kImageWidth * 4, kImageHeight);
+    benchmark::ClobberMemory();
+  }
+  SetMegapixelsProcessed(state);
+}
+
+BENCHMARK(BM_ExpandRgbToRgba);
+BENCHMARK(BM_ExpandBwToRgba);
+BENCHMARK(BM_ConvertSrgbToLinear);
+BENCHMARK(BM_PremultiplyAlpha);
+BENCHMARK(BM_FlipRows);
+
+}  // namespace
+}  // namespace lighter::common::pixel
+
+BENCHMARK_MAIN();
@@ -0,0 +1,136 @@
+//
+//  pixel_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/pixel.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lighter::common::pixel {
+namespace {
+
+// Covers both vectorized loops and scalar tails.
+constexpr int kNumPixelsToTest[] = {0, 1, 3, 4, 5, 6, 7, 15, 16, 17, 33, 1000};
+
+// Returns 'size' random bytes.
+std::vector<uint8_t> GenerateBytes(size_t size, int seed) {
+  std::mt19937 generator{static_cast<std::mt19937::result_type>(seed)};
+  std::uniform_int_distribution<int> distribution{0, 255};
+  std::vector<uint8_t> bytes(size);
+  for (auto& byte : bytes) {
+    byte = static_cast<uint8_t>(distribution(generator));
+  }
+  return bytes;
+}
+
+TEST(PixelTest, ExpandRgbToRgba) {
+  for (int num_pixels : kNumPixelsToTest) {
+    const std::vector<uint8_t> rgb = GenerateBytes(num_pixels * 3, num_pixels);
+    std::vector<uint8_t> rgba(num_pixels * 4);
+    ExpandRgbToRgba(rgb.data(), num_pixels, rgba.data());
+    for (int i = 0; i < num_pixels; ++i) {
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(rgba[i * 4 + c], rgb[i * 3 + c]) << "at pixel " << i;
+      }
+      ASSERT_EQ(rgba[i * 4 + 3], 255) << "at pixel " << i;
+    }
+  }
+}
+
+TEST(PixelTest, ExpandBwToRgba) {
+  for (int num_pixels : kNumPixelsToTest) {
+    const std::vector<uint8_t> bw = GenerateBytes(num_pixels, num_pixels);
+    std::vector<uint8_t> rgba(num_pixels * 4);
+    ExpandBwToRgba(bw.data(), num_pixels, rgba.data());
+    for (int i = 0; i < num_pixels; ++i) {
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_EQ(rgba[i * 4 + c], bw[i]) << "at pixel " << i;
+      }
+      ASSERT_EQ(rgba[i * 4 + 3], 255) << "at pixel " << i;
+    }
+  }
+}
+
+TEST(PixelTest, ConvertSrgbAndLinear) {
+  std::vector<uint8_t> pixels(256 * 4);
+  for (int i = 0; i < 256; ++i) {
+    pixels[i * 4 + 0] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = i;
+    pixels[i * 4 + 3] = 255 - i;
+  }
+  std::vector<uint8_t> linear = pixels;
+  ConvertSrgbToLinear(linear.data(), 256);
+  EXPECT_EQ(linear[0], 0);
+  EXPECT_EQ(linear[188 * 4], 128);
+  EXPECT_EQ(linear[255 * 4], 255);
+  for (int i = 0; i < 256; ++i) {
+    ASSERT_EQ(linear[i * 4 + 3], 255 - i) << "at pixel " << i;
+    if (i > 0) {
+      ASSERT_GE(linear[i * 4], linear[(i - 1) * 4]) << "at pixel " << i;
+    }
+  }
+
+  std::vector<uint8_t> srgb = pixels;
+  ConvertLinearToSrgb(srgb.data(), 256);
+  EXPECT_EQ(srgb[0], 0);
+  EXPECT_EQ(srgb[128 * 4], 188);
+  EXPECT_EQ(srgb[255 * 4], 255);
+  for (int i = 0; i < 256; ++i) {
+    ASSERT_EQ(srgb[i * 4 + 3], 255 - i) << "at pixel " << i;
+  }
+}
+
+TEST(PixelTest, PremultiplyAlpha) {
+  // Test all combinations of color and alpha.
+  std::vector<uint8_t> pixels;
+  for (int alpha = 0; alpha < 256; ++alpha) {
+    for (int color = 0; color < 256; ++color) {
+      pixels.insert(pixels.end(), {static_cast<uint8_t>(color),
+                                   static_cast<uint8_t>(255 - color),
+                                   static_cast<uint8_t>(color / 2),
+                                   static_cast<uint8_t>(alpha)});
+    }
+  }
+  // Leave one pixel for the scalar code.
+  const std::vector<uint8_t> original = pixels;
+  PremultiplyAlpha(pixels.data(), pixels.size() / 4 - 1);
+  PremultiplyAlpha(pixels.data() + pixels.size() - 4, 1);
+
+  for (int i = 0; i < pixels.size(); i += 4) {
+    const int alpha = original[i + 3];
+    for (int c = 0; c < 3; ++c) {
+      const auto expected = static_cast<uint8_t>(
+          std::lround(original[i + c] * alpha / 255.0));
+      ASSERT_EQ(pixels[i + c], expected) << "at pixel " << i / 4;
+    }
+    ASSERT_EQ(pixels[i + 3], alpha) << "at pixel " << i / 4;
+  }
+}
+
+TEST(PixelTest, FlipRows) {
+  for (int row_size : {1, 15, 16, 17, 40}) {
+    for (int num_rows : {0, 1, 2, 5, 8}) {
+      const std::vector<uint8_t> original =
+          GenerateBytes(row_size * num_rows, row_size + num_rows);
+      std::vector<uint8_t> flipped = original;
+      FlipRows(flipped.data(), row_size, num_rows);
+      for (int row = 0; row < num_rows; ++row) {
+        for (int i = 0; i < row_size; ++i) {
+          ASSERT_EQ(flipped[row * row_size + i],
+                    original[(num_rows - 1 - row) * row_size + i])
+              << "at row " << row << ", byte " << i;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace lighter::common::pixel
@@ -0,0 +1,311 @@
+//
+//  simd.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_SIMD_H
+#define LIGHTER_COMMON_SIMD_H
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LIGHTER_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LIGHTER_SIMD_SSE
+#endif
+
+#include <cmath>
+
+// This file provides thin wrappers of SIMD registers, so that the same piece of
+// code can process multiple floats at a time with AVX or SSE, or fall back to
+// scalar code on platforms without them. Except for Exp(), each operation maps
+// to exactly one IEEE-754 operation per lane, hence results are bit-identical
+// to the scalar code that performs the same operations in the same order.
+
+namespace lighter::common::simd {
+
+#if defined(LIGHTER_SIMD_AVX)
+inline constexpr int kWidth = 8;
+#elif defined(LIGHTER_SIMD_SSE)
+inline constexpr int kWidth = 4;
+#else
+inline constexpr int kWidth = 1;
+#endif
+
+// Holds the result of per-lane comparisons.
+class Mask {
+ public:
+#if defined(LIGHTER_SIMD_AVX)
+  using NativeType = __m256;
+#elif defined(LIGHTER_SIMD_SSE)
+  using NativeType = __m128;
+#else
+  using NativeType = bool;
+#endif
+
+  explicit Mask(NativeType value) : value_{value} {}
+
+  // Returns a bitmask, where bit i is set if lane i is true.
+  int ToBits() const {
+#if defined(LIGHTER_SIMD_AVX)
+    return _mm256_movemask_ps(value_);
+#elif defined(LIGHTER_SIMD_SSE)
+    return _mm_movemask_ps(value_);
+#else
+    return value_ ? 1 : 0;
+#endif
+  }
+
+  friend Mask operator&(const Mask& lhs, const Mask& rhs) {
+#if defined(LIGHTER_SIMD_AVX)
+    return Mask{_mm256_and_ps(lhs.value_, rhs.value_)};
+#elif defined(LIGHTER_SIMD_SSE)
+    return Mask{_mm_and_ps(lhs.value_, rhs.value_)};
+#else
+    return Mask{lhs.value_ && rhs.value_};
+#endif
+  }
+
+  friend Mask operator|(const Mask& lhs, const Mask& rhs) {
+#if defined(LIGHTER_SIMD_AVX)
+    return Mask{_mm256_or_ps(lhs.value_, rhs.value_)};
+#elif defined(LIGHTER_SIMD_SSE)
+    return Mask{_mm_or_ps(lhs.value_, rhs.value_)};
+#else
+    return Mask{lhs.value_ || rhs.value_};
+#endif
+  }
+
+  // Accessors.
+  NativeType value() const { return value_; }
+
+ private:
+  NativeType value_;
+};
+
+// Holds 'kWidth' floats.
+class Float {
+ public:
+#if defined(LIGHTER_SIMD_AVX)
+  using NativeType = __m256;
+#elif defined(LIGHTER_SIMD_SSE)
+  using NativeType = __m128;
+#else
+  using NativeType = float;
+#endif
+
+  Float() = default;
+
+  // Broadcasts 'value' to all lanes. This is intentionally implicit so that
+  // scalar constants can be used in expressions.
+  Float(float value)
+#if defined(LIGHTER_SIMD_AVX)
+      : value_{_mm256_set1_ps(value)} {}
+#elif defined(LIGHTER_SIMD_SSE)
+      : value_{_mm_set1_ps(value)} {}
+#else
+      : value_{value} {}
+#endif
+
+  explicit Float(NativeType value, int) : value_{value} {}
+
+  // Loads 'kWidth' floats from 'src', which need not be aligned.
+  static Float Load(const float* src) {
+#if defined(LIGHTER_SIMD_AVX)
+    return Float{_mm256_loadu_ps(src), 0};
+#elif defined(LIGHTER_SIMD_SSE)
+    return Float{_mm_loadu_ps(src), 0};
+#else
+    return Float{*src, 0};
+#endif
+  }
+
+  // Stores 'kWidth' floats to 'dst', which need not be aligned.
+  void Store(float* dst) const {
+#if defined(LIGHTER_SIMD_AVX)
+    _mm256_storeu_ps(dst, value_);
+#elif defined(LIGHTER_SIMD_SSE)
+    _mm_storeu_ps(dst, value_);
+#else
+    *dst = value_;
+#endif
+  }
+
+#if defined(LIGHTER_SIMD_AVX)
+#define LIGHTER_SIMD_BINARY_OP(op, func)                          \
+  friend Float operator op(const Float& lhs, const Float& rhs) {  \
+    return Float{_mm256_##func##_ps(lhs.value_, rhs.value_), 0};  \
+  }
+#define LIGHTER_SIMD_COMPARE_OP(op, predicate)                             \
+  friend Mask operator op(const Float& lhs, const Float& rhs) {            \
+    return Mask{_mm256_cmp_ps(lhs.value_, rhs.value_, _CMP_##predicate)};  \
+  }
+#elif defined(LIGHTER_SIMD_SSE)
+#define LIGHTER_SIMD_BINARY_OP(op, func)                          \
+  friend Float operator op(const Float& lhs, const Float& rhs) {  \
+    return Float{_mm_##func##_ps(lhs.value_, rhs.value_), 0};     \
+  }
+#define LIGHTER_SIMD_COMPARE_OP(op, predicate)                   \
+  friend Mask operator op(const Float& lhs, const Float& rhs) {  \
+    return Mask{_mm_cmp##predicate##_ps(lhs.value_, rhs.value_)}; \
+  }
+#else
+#define LIGHTER_SIMD_BINARY_OP(op, func)                          \
+  friend Float operator op(const Float& lhs, const Float& rhs) {  \
+    return Float{lhs.value_ op rhs.value_, 0};                    \
+  }
+#define LIGHTER_SIMD_COMPARE_OP(op, predicate)                   \
+  friend Mask operator op(const Float& lhs, const Float& rhs) {  \
+    return Mask{lhs.value_ op rhs.value_};                       \
+  }
+#endif
+
+  LIGHTER_SIMD_BINARY_OP(+, add)
+  LIGHTER_SIMD_BINARY_OP(-, sub)
+  LIGHTER_SIMD_BINARY_OP(*, mul)
+  LIGHTER_SIMD_BINARY_OP(/, div)
+
+#if defined(LIGHTER_SIMD_AVX)
+  // Ordered comparisons, so that NaN always compares false like scalar code.
+  LIGHTER_SIMD_COMPARE_OP(<, LT_OQ)
+  LIGHTER_SIMD_COMPARE_OP(<=, LE_OQ)
+  LIGHTER_SIMD_COMPARE_OP(>, GT_OQ)
+  LIGHTER_SIMD_COMPARE_OP(>=, GE_OQ)
+#else
+  LIGHTER_SIMD_COMPARE_OP(<, lt)
+  LIGHTER_SIMD_COMPARE_OP(<=, le)
+  LIGHTER_SIMD_COMPARE_OP(>, gt)
+  LIGHTER_SIMD_COMPARE_OP(>=, ge)
+#endif
+
+#undef LIGHTER_SIMD_BINARY_OP
+#undef LIGHTER_SIMD_COMPARE_OP
+
+  // Accessors.
+  NativeType value() const { return value_; }
+
+ private:
+  NativeType value_;
+};
+
+// Returns the square root of each lane.
+inline Float Sqrt(const Float& x) {
+#if defined(LIGHTER_SIMD_AVX)
+  return Float{_mm256_sqrt_ps(x.value()), 0};
+#elif defined(LIGHTER_SIMD_SSE)
+  return Float{_mm_sqrt_ps(x.value()), 0};
+#else
+  return Float{std::sqrt(x.value()), 0};
+#endif
+}
+
+// Returns 'if_true' for lanes where 'mask' is set, and 'if_false' otherwise.
+inline Float Select(const Mask& mask, const Float& if_true,
+                    const Float& if_false) {
+#if defined(LIGHTER_SIMD_AVX)
+  return Float{_mm256_blendv_ps(if_false.value(), if_true.value(),
+                                mask.value()), 0};
+#elif defined(LIGHTER_SIMD_SSE)
+  return Float{_mm_or_ps(_mm_and_ps(mask.value(), if_true.value()),
+                         _mm_andnot_ps(mask.value(), if_false.value())), 0};
+#else
+  return mask.value() ? if_true : if_false;
+#endif
+}
+
+// Returns the smaller/larger value of each lane.
+inline Float Min(const Float& lhs, const Float& rhs) {
+  return Select(lhs < rhs, lhs, rhs);
+}
+inline Float Max(const Float& lhs, const Float& rhs) {
+  return Select(lhs > rhs, lhs, rhs);
+}
+
+// Returns e raised to the power of each lane. Unlike other operations, with AVX
+// or SSE this is approximated with the range reduction and polynomial used by
+// Cephes, whose relative error is within 2E-7, hence results may slightly
+// differ from std::exp(). Inputs are clamped to [-87.0, 88.0] before the range
+// reduction, so that results are normal.
+inline Float Exp(const Float& x) {
+#if defined(LIGHTER_SIMD_AVX) || defined(LIGHTER_SIMD_SSE)
+  const Float clamped = Min(Max(x, -87.0f), 88.0f);
+
+  // Express e^x as 2^n * e^r, where n is an integer and |r| <= ln(2) / 2.
+  // Conversions round to the nearest integer by default.
+  const Float scaled = clamped * 1.44269504088896341f;
+#if defined(LIGHTER_SIMD_AVX)
+  const __m256i n = _mm256_cvtps_epi32(scaled.value());
+  const Float n_float{_mm256_cvtepi32_ps(n), 0};
+  // Build 2^n from exponent bits. 256-bit integer operations require AVX2,
+  // hence each half is processed with SSE2.
+  const __m128i bias = _mm_set1_epi32(127);
+  const __m128i low = _mm_slli_epi32(
+      _mm_add_epi32(_mm256_castsi256_si128(n), bias), 23);
+  const __m128i high = _mm_slli_epi32(
+      _mm_add_epi32(_mm256_extractf128_si256(n, 1), bias), 23);
+  const Float pow2_n{_mm256_castsi256_ps(_mm256_insertf128_si256(
+      _mm256_castsi128_si256(low), high, 1)), 0};
+#else
+  const __m128i n = _mm_cvtps_epi32(scaled.value());
+  const Float n_float{_mm_cvtepi32_ps(n), 0};
+  const Float pow2_n{_mm_castsi128_ps(
+      _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23)), 0};
+#endif
+
+  // ln(2) is split into two parts to reduce rounding errors.
+  const Float r = clamped - n_float * 0.693359375f + n_float * 2.12194440E-4f;
+  Float p = 1.9875691500E-4f;
+  p = p * r + 1.3981999507E-3f;
+  p = p * r + 8.3334519073E-3f;
+  p = p * r + 4.1665795894E-2f;
+  p = p * r + 1.6666665459E-1f;
+  p = p * r + 5.0000001201E-1f;
+  p = p * (r * r) + r + 1.0f;
+  return p * pow2_n;
+#else
+  return Float{std::exp(x.value()), 0};
+#endif
+}
+
+// Holds 'kWidth' 3D vectors in the structure-of-arrays layout. Functions below
+// follow the order of operations used by glm, so that results match glm
+// bit-by-bit.
+struct Vec3 {
+  Float x;
+  Float y;
+  Float z;
+};
+
+inline Vec3 operator+(const Vec3& lhs, const Vec3& rhs) {
+  return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+}
+
+inline Vec3 operator-(const Vec3& lhs, const Vec3& rhs) {
+  return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+}
+
+inline Vec3 operator*(const Vec3& lhs, const Float& rhs) {
+  return {lhs.x * rhs, lhs.y * rhs, lhs.z * rhs};
+}
+
+// Equivalent to glm::dot().
+inline Float Dot(const Vec3& lhs, const Vec3& rhs) {
+  const Vec3 product{lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z};
+  return product.x + product.y + product.z;
+}
+
+// Equivalent to glm::length().
+inline Float Length(const Vec3& v) {
+  return Sqrt(Dot(v, v));
+}
+
+// Equivalent to glm::normalize().
+inline Vec3 Normalize(const Vec3& v) {
+  return v * (Float{1.0f} / Sqrt(Dot(v, v)));
+}
+
+}  // namespace lighter::common::simd
+
+#endif  // LIGHTER_COMMON_SIMD_H
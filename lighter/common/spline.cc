@@ -8,12 +8,348 @@
 #include "lighter/common/spline.h"
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include "lighter/common/util.h"
 #include "third_party/absl/strings/str_format.h"
-#include "third_party/glm/gtx/vector_angle.hpp"
 
 namespace lighter::common {
+namespace {
+
+// Returns the distance from 'point' to the line segment between 'p0' and 'p1'.
+float DistanceToSegment(const glm::vec3& point,
+                        const glm::vec3& p0, const glm::vec3& p1) {
+  const glm::vec3 segment = p1 - p0;
+  const float length_squared = glm::dot(segment, segment);
+  if (length_squared == 0.0f) {
+    return glm::distance(point, p0);
+  }
+  const float t = glm::clamp(glm::dot(point - p0, segment) / length_squared,
+                             0.0f, 1.0f);
+  return glm::distance(point, p0 + segment * t);
+}
+
+// Returns the point at 'distance' along the polyline formed by 'points', where
+// 'arc_lengths' are cumulative arc lengths of 'points'. The search for the
+// polyline edge starts from 'first_point', which must not be after the edge
+// that contains the point. Returns the index of the start of that edge via
+// 'edge_index'.
+glm::vec3 InterpolateAtDistance(absl::Span<const glm::vec3> points,
+                                absl::Span<const float> arc_lengths,
+                                float distance, int first_point,
+                                int* edge_index) {
+  const auto num_points = static_cast<int>(points.size());
+  const auto iter = std::upper_bound(arc_lengths.begin() + first_point,
+                                     arc_lengths.end(), distance);
+  // 'index' is the start of the edge, which is in range [0, num_points - 2].
+  const int index = std::clamp(
+      static_cast<int>(iter - arc_lengths.begin()) - 1, 0, num_points - 2);
+  *edge_index = index;
+
+  const float edge_length = arc_lengths[index + 1] - arc_lengths[index];
+  if (edge_length <= 0.0f) {
+    return points[index];
+  }
+  const float t = std::clamp((distance - arc_lengths[index]) / edge_length,
+                             0.0f, 1.0f);
+  return glm::mix(points[index], points[index + 1], t);
+}
+
+// Returns points that evenly divide the polyline formed by 'points' into
+// 'num_intervals' intervals, where 'arc_lengths' are cumulative arc lengths of
+// 'points'. If 'max_error' is not nullptr, it will be populated with the
+// maximum distance between 'points' and the chord of the interval that contains
+// them.
+std::vector<glm::vec3> ResamplePolyline(absl::Span<const glm::vec3> points,
+                                        absl::Span<const float> arc_lengths,
+                                        int num_intervals, float* max_error) {
+  const auto num_points = static_cast<int>(points.size());
+  const float total_length = arc_lengths.back();
+  std::vector<glm::vec3> samples(num_intervals + 1);
+  samples.front() = points.front();
+  samples.back() = points.back();
+  int edge_index = 0;
+  for (int i = 1; i < num_intervals; ++i) {
+    samples[i] = InterpolateAtDistance(
+        points, arc_lengths, total_length * i / num_intervals, edge_index,
+        &edge_index);
+  }
+
+  if (max_error != nullptr) {
+    *max_error = 0.0f;
+    int interval = 0;
+    for (int i = 1; i < num_points - 1; ++i) {
+      while (interval < num_intervals - 1 &&
+             arc_lengths[i] > total_length * (interval + 1) / num_intervals) {
+        ++interval;
+      }
+      *max_error = std::max(*max_error,
+                            DistanceToSegment(points[i], samples[interval],
+                                              samples[interval + 1]));
+    }
+  }
+  return samples;
+}
+
+}  // namespace
+
+std::vector<float> Spline::GetArcLengths() const {
+  std::vector<float> arc_lengths(spline_points_.size());
+  int begin = 0;
+  for (int segment = 0; segment < segment_sizes_.size(); ++segment) {
+    const int end = begin + segment_sizes_.value(segment);
+    const float segment_arc_length = segment_lengths_.GetPrefixSum(segment);
+    for (int i = begin; i < end; ++i) {
+      arc_lengths[i] = segment_arc_length + local_arc_lengths_[i];
+    }
+    begin = end;
+  }
+  if (!arc_lengths.empty()) {
+    arc_lengths.back() = GetLength();
+  }
+  return arc_lengths;
+}
+
+glm::vec3 Spline::PointAtDistance(float distance) const {
+  ASSERT_NON_EMPTY(spline_points_, "Spline has not been built");
+  if (spline_points_.size() == 1) {
+    return spline_points_[0];
+  }
+  distance = std::clamp(distance, 0.0f, GetLength());
+
+  // Find the segment that contains the point first, and then the edge within
+  // that segment. Empty segments share arc lengths with the next segment, hence
+  // GetMaxCount() never lands on them.
+  const int segment = std::clamp(segment_lengths_.GetMaxCount(distance),
+                                 0, segment_sizes_.size() - 1);
+  const int begin = segment_sizes_.GetPrefixSum(segment);
+  const int end = begin + segment_sizes_.value(segment);
+  if (begin == end) {
+    return spline_points_[begin];
+  }
+
+  const float segment_arc_length = segment_lengths_.GetPrefixSum(segment);
+  const float local_distance = distance - segment_arc_length;
+  const auto edge_iter =
+      std::upper_bound(local_arc_lengths_.begin() + begin,
+                       local_arc_lengths_.begin() + end, local_distance);
+  // 'index' is the start of the edge, which is in range [begin, end - 1].
+  const int index = std::clamp(
+      static_cast<int>(edge_iter - local_arc_lengths_.begin()) - 1,
+      begin, end - 1);
+  // Compute the length of the last edge from prefix sums, so that it is
+  // consistent with 'local_distance'.
+  const float edge_end_length =
+      index + 1 < end
+          ? local_arc_lengths_[index + 1]
+          : segment_lengths_.GetPrefixSum(segment + 1) - segment_arc_length;
+  const float edge_length = edge_end_length - local_arc_lengths_[index];
+  if (edge_length <= 0.0f) {
+    return spline_points_[index];
+  }
+  const float t = std::clamp(
+      (local_distance - local_arc_lengths_[index]) / edge_length, 0.0f, 1.0f);
+  return glm::mix(spline_points_[index], spline_points_[index + 1], t);
+}
+
+std::vector<glm::vec3> Spline::ResampleUniform(float max_error) const {
+  ASSERT_TRUE(max_error > 0.0f,
+              absl::StrFormat("Max error must be positive, while %f provided",
+                              max_error));
+  if (spline_points_.size() <= 2) {
+    return spline_points_;
+  }
+
+  // The chord error of an interval is bounded by half of its arc length, hence
+  // this number of intervals always meets the requirement.
+  int max_num_intervals = static_cast<int>(
+      std::ceil(GetLength() / (2.0f * max_error)));
+  max_num_intervals = std::max(max_num_intervals, 1);
+
+  const std::vector<float> arc_lengths = GetArcLengths();
+  int min_num_intervals = 1;
+  float error;
+  while (min_num_intervals < max_num_intervals) {
+    const int num_intervals =
+        min_num_intervals + (max_num_intervals - min_num_intervals) / 2;
+    ResamplePolyline(spline_points_, arc_lengths, num_intervals, &error);
+    if (error <= max_error) {
+      max_num_intervals = num_intervals;
+    } else {
+      min_num_intervals = num_intervals + 1;
+    }
+  }
+  return ResamplePolyline(spline_points_, arc_lengths, max_num_intervals,
+                          /*max_error=*/nullptr);
+}
+
+std::vector<glm::vec3> Spline::ResampleAdaptive(float max_error) const {
+  ASSERT_TRUE(max_error > 0.0f,
+              absl::StrFormat("Max error must be positive, while %f provided",
+                              max_error));
+  const auto num_points = static_cast<int>(spline_points_.size());
+  if (num_points <= 2) {
+    return spline_points_;
+  }
+
+  // Returns whether all spline points between 'begin' and 'end' are within
+  // 'max_error' from the chord between them.
+  const auto is_within_error = [this, max_error](int begin, int end) {
+    for (int i = begin + 1; i < end; ++i) {
+      if (DistanceToSegment(spline_points_[i], spline_points_[begin],
+                            spline_points_[end]) > max_error) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<glm::vec3> samples{spline_points_.front()};
+  int begin = 0;
+  while (begin < num_points - 1) {
+    int end = begin + 1;
+    while (end + 1 < num_points && is_within_error(begin, end + 1)) {
+      ++end;
+    }
+    samples.push_back(spline_points_[end]);
+    begin = end;
+  }
+  return samples;
+}
+
+void Spline::UpdateArcLengths(absl::Span<const int> segment_offsets) {
+  const auto num_points = static_cast<int>(spline_points_.size());
+  std::vector<int> segment_sizes;
+  if (segment_offsets.empty()) {
+    segment_sizes = {std::max(num_points - 1, 0)};
+  } else {
+    ASSERT_TRUE(segment_offsets.back() == num_points - 1,
+                absl::StrFormat("Last segment offset (%d) must be the index of "
+                                "the last spline point (%d)",
+                                segment_offsets.back(), num_points - 1));
+    segment_sizes.resize(segment_offsets.size() - 1);
+    for (int i = 0; i < segment_sizes.size(); ++i) {
+      segment_sizes[i] = segment_offsets[i + 1] - segment_offsets[i];
+    }
+  }
+  segment_sizes_.Reset(segment_sizes);
+
+  local_arc_lengths_.resize(num_points);
+  std::vector<float> segment_lengths(segment_sizes.size(), 0.0f);
+  if (num_points == 0) {
+    segment_lengths_.Reset(segment_lengths);
+    return;
+  }
+  int begin = 0;
+  for (int segment = 0; segment < segment_sizes.size(); ++segment) {
+    const int end = begin + segment_sizes[segment];
+    UpdateLocalArcLengths(begin, end);
+    segment_lengths[segment] = GetSegmentLength(begin, end);
+    begin = end;
+  }
+  local_arc_lengths_.back() = 0.0f;
+  segment_lengths_.Reset(segment_lengths);
+}
+
+Spline::PointRange Spline::ReplaceSegments(
+    int first_segment, absl::Span<const glm::vec3> points,
+    absl::Span<const int> num_points_per_segment) {
+  const int num_segments = segment_sizes_.size();
+  const auto num_replaced = static_cast<int>(num_points_per_segment.size());
+  ASSERT_TRUE(first_segment >= 0 &&
+                  first_segment + num_replaced <= num_segments,
+              absl::StrFormat("Segments [%d, %d) out of range [0, %d)",
+                              first_segment, first_segment + num_replaced,
+                              num_segments));
+  ASSERT_TRUE(std::accumulate(num_points_per_segment.begin(),
+                              num_points_per_segment.end(), 0) == points.size(),
+              "Number of points does not match with number of points per "
+              "segment");
+
+  const int begin = segment_sizes_.GetPrefixSum(first_segment);
+  const int old_end = segment_sizes_.GetPrefixSum(first_segment + num_replaced);
+  const int new_end = begin + static_cast<int>(points.size());
+  const int diff = new_end - old_end;
+
+  // Only shift the following points if the number of points changes. Local
+  // arc lengths of those points are relative to their segments, hence they
+  // stay valid after shifting.
+  if (diff > 0) {
+    spline_points_.insert(spline_points_.begin() + old_end, diff, glm::vec3{});
+    local_arc_lengths_.insert(local_arc_lengths_.begin() + old_end, diff, 0.0f);
+  } else if (diff < 0) {
+    spline_points_.erase(spline_points_.begin() + new_end,
+                         spline_points_.begin() + old_end);
+    local_arc_lengths_.erase(local_arc_lengths_.begin() + new_end,
+                             local_arc_lengths_.begin() + old_end);
+  }
+  std::copy(points.begin(), points.end(), spline_points_.begin() + begin);
+
+  // The last point closes the spline.
+  if (first_segment == 0) {
+    spline_points_.back() = spline_points_.front();
+  }
+
+  int offset = begin;
+  for (int i = 0; i < num_replaced; ++i) {
+    const int segment = first_segment + i;
+    const int end = offset + num_points_per_segment[i];
+    segment_sizes_.Set(segment, num_points_per_segment[i]);
+    UpdateLocalArcLengths(offset, end);
+    segment_lengths_.Set(segment, GetSegmentLength(offset, end));
+    offset = end;
+  }
+
+  // The length of the segment before the replaced ones depends on the first
+  // replaced point. If that is the first spline point, the segment before is
+  // the last one, which ends with the point that closes the spline.
+  if (first_segment > 0) {
+    UpdateSegmentLength(first_segment - 1);
+  } else if (num_replaced < num_segments) {
+    UpdateSegmentLength(num_segments - 1);
+  }
+  return {begin, new_end};
+}
+
+void Spline::InsertEmptySegment(int index) {
+  segment_sizes_.Insert(index, 0);
+  segment_lengths_.Insert(index, 0.0f);
+}
+
+void Spline::RemoveEmptySegment(int index) {
+  ASSERT_TRUE(segment_sizes_.value(index) == 0,
+              absl::StrFormat("Segment %d is not empty", index));
+  segment_sizes_.Erase(index);
+  segment_lengths_.Erase(index);
+}
+
+void Spline::UpdateLocalArcLengths(int begin, int end) {
+  if (begin == end) {
+    return;
+  }
+  local_arc_lengths_[begin] = 0.0f;
+  for (int i = begin + 1; i < end; ++i) {
+    local_arc_lengths_[i] = local_arc_lengths_[i - 1] +
+                            glm::distance(spline_points_[i - 1],
+                                          spline_points_[i]);
+  }
+}
+
+float Spline::GetSegmentLength(int begin, int end) const {
+  if (begin == end) {
+    return 0.0f;
+  }
+  // Include the edge that connects to the first point of the next segment.
+  return local_arc_lengths_[end - 1] +
+         glm::distance(spline_points_[end - 1], spline_points_[end]);
+}
+
+void Spline::UpdateSegmentLength(int index) {
+  const int begin = segment_sizes_.GetPrefixSum(index);
+  const int end = begin + segment_sizes_.value(index);
+  segment_lengths_.Set(index, GetSegmentLength(begin, end));
+}
 
 BezierSpline::BezierSpline(int max_recursion_depth,
                            GetMiddlePoint&& get_middle_point,
@@ -49,54 +385,19 @@ const int CatmullRomSpline::kMinNumControlPoints = 3;
 
 std::unique_ptr<Spline> CatmullRomSpline::GetOnSphereSpline(
     int max_recursion_depth, float roughness) {
-  BezierSpline::GetMiddlePoint get_middle_point =
-      [](const glm::vec3& p0, const glm::vec3& p1) {
-        return glm::normalize(p0 + p1) * glm::length(p0);
-      };
-
-  BezierSpline::IsSmooth is_smooth = [roughness](const glm::vec3& p0,
-                                                 const glm::vec3& p1,
-                                                 const glm::vec3& p2,
-                                                 const glm::vec3& p3) {
-    const glm::vec3 p0p1 = glm::normalize(p0 - p1);
-    const glm::vec3 p1p2 = glm::normalize(p1 - p2);
-    const glm::vec3 p2p3 = glm::normalize(p2 - p3);
-    return glm::angle(p0p1, p1p2) <= roughness &&
-           glm::angle(p1p2, p2p3) <= roughness;
-  };
-
-  return std::make_unique<CatmullRomSpline>(
-      max_recursion_depth, std::move(get_middle_point), std::move(is_smooth));
+  using OnSphereSpline = BatchCatmullRomSpline<spline::OnSphereMiddlePoint,
+                                               spline::OnSphereSmoothness>;
+  return std::make_unique<OnSphereSpline>(
+      max_recursion_depth, spline::OnSphereMiddlePoint{},
+      spline::OnSphereSmoothness{roughness});
 }
 
 void CatmullRomSpline::Tessellate(const glm::vec3& p0,
                                   const glm::vec3& p1,
                                   const glm::vec3& p2,
                                   const glm::vec3& p3) {
-  static const glm::mat4* catmull_rom_to_bezier = nullptr;
-  if (catmull_rom_to_bezier == nullptr) {
-    const glm::mat4 catmull_rom_coeff{
-        -0.5f,  1.5f, -1.5f,  0.5f,
-         1.0f, -2.5f,  2.0f, -0.5f,
-        -0.5f,  0.0f,  0.5f,  0.0f,
-         0.0f,  1.0f,  0.0f,  0.0f
-    };
-    const glm::mat4 bezier_coeff{
-        -1.0f,  3.0f, -3.0f,  1.0f,
-         3.0f, -6.0f,  3.0f,  0.0f,
-        -3.0f,  3.0f,  0.0f,  0.0f,
-         1.0f,  0.0f,  0.0f,  0.0f,
-    };
-    catmull_rom_to_bezier =
-        new glm::mat4{catmull_rom_coeff * glm::inverse(bezier_coeff)};
-  }
-  const glm::mat4 catmull_rom_points{
-      glm::vec4{p0, 0.0f},
-      glm::vec4{p1, 0.0f},
-      glm::vec4{p2, 0.0f},
-      glm::vec4{p3, 0.0f},
-  };
-  const glm::mat4 bezier_points = catmull_rom_points * (*catmull_rom_to_bezier);
+  const spline::BezierSegment bezier_points =
+      spline::ConvertCatmullRomToBezier(p0, p1, p2, p3);
   BezierSpline::Tessellate(bezier_points[0],
                            bezier_points[1],
                            bezier_points[2],
@@ -120,17 +421,29 @@ void CatmullRomSpline::BuildSpline(absl::Span<const glm::vec3> control_points) {
   }
   // Close the spline.
   mutable_splines()->push_back(spline_points()[0]);
+  UpdateArcLengths();
 }
 
 SplineEditor::SplineEditor(int min_num_control_points,
                            int max_num_control_points,
                            std::vector<glm::vec3>&& initial_control_points,
-                           std::unique_ptr<Spline>&& spline)
+                           std::unique_ptr<Spline>&& spline,
+                           bool build_spline)
     : min_num_control_points_{min_num_control_points},
       max_num_control_points_{max_num_control_points},
       control_points_{std::move(initial_control_points)},
-      spline_{std::move(spline)} {
-  RebuildSpline();
+      spline_{std::move(spline)},
+      dirty_spline_points_{0, 0} {
+  if (build_spline) {
+    RebuildSpline(/*thread_pool=*/nullptr);
+  }
+}
+
+void SplineEditor::RebuildAll(absl::Span<SplineEditor* const> editors,
+                              ThreadPool& thread_pool) {
+  thread_pool.ParallelFor(static_cast<int>(editors.size()), [&](int index) {
+    editors[index]->RebuildSpline(&thread_pool);
+  });
 }
 
 bool SplineEditor::CanInsertControlPoint() const {
@@ -143,13 +456,13 @@ bool SplineEditor::InsertControlPoint(int index, const glm::vec3& position) {
   }
 
   control_points_.insert(control_points_.begin() + index, position);
-  RebuildSpline();
+  UpdateSpline({spline::ControlPointChange::Type::kInsert, index});
   return true;
 }
 
 void SplineEditor::UpdateControlPoint(int index, const glm::vec3& position) {
   control_points_.at(index) = position;
-  RebuildSpline();
+  UpdateSpline({spline::ControlPointChange::Type::kUpdate, index});
 }
 
 bool SplineEditor::RemoveControlPoint(int index) {
@@ -158,12 +471,22 @@ bool SplineEditor::RemoveControlPoint(int index) {
   }
 
   control_points_.erase(control_points_.begin() + index);
-  RebuildSpline();
+  UpdateSpline({spline::ControlPointChange::Type::kRemove, index});
   return true;
 }
 
-void SplineEditor::RebuildSpline() {
-  spline_->BuildSpline(control_points_);
+void SplineEditor::UpdateSpline(const spline::ControlPointChange& change) {
+  dirty_spline_points_ = spline_->UpdateSpline(control_points_, change);
+}
+
+void SplineEditor::RebuildSpline(ThreadPool* thread_pool) {
+  if (thread_pool != nullptr) {
+    spline_->BuildSplineInParallel(control_points_, *thread_pool);
+  } else {
+    spline_->BuildSpline(control_points_);
+  }
+  dirty_spline_points_ = {
+      0, static_cast<int>(spline_->spline_points().size())};
 }
 
 }  // namespace lighter::common
@@ -8,10 +8,16 @@
 #ifndef LIGHTER_COMMON_SPLINE_H
 #define LIGHTER_COMMON_SPLINE_H
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
 
+#include "lighter/common/spline_util.h"
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/strings/str_format.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
 
@@ -22,6 +28,12 @@ namespace lighter::common {
 // splines using control points, but do not own control points.
 class Spline {
  public:
+  // Range of spline points [begin, end).
+  struct PointRange {
+    int begin;
+    int end;
+  };
+
   // This class is neither copyable nor movable.
   Spline(const Spline&) = delete;
   Spline& operator=(const Spline&) = delete;
@@ -32,18 +44,131 @@ class Spline {
   // Previous content of 'spline_points_' will be discarded.
   virtual void BuildSpline(absl::Span<const glm::vec3> control_points) = 0;
 
+  // Same as BuildSpline(), but may use 'thread_pool' to build parts of the
+  // spline in parallel. By default, this simply builds the spline on the
+  // calling thread.
+  virtual void BuildSplineInParallel(absl::Span<const glm::vec3> control_points,
+                                     ThreadPool& thread_pool) {
+    BuildSpline(control_points);
+  }
+
+  // Updates 'spline_points_' after a single control point has changed as
+  // described by 'change', where 'control_points' are control points after the
+  // change. Returns the range of spline points that may have changed. Spline
+  // points outside of this range are guaranteed to be unchanged. By default,
+  // this simply rebuilds the entire spline.
+  virtual PointRange UpdateSpline(absl::Span<const glm::vec3> control_points,
+                                  const spline::ControlPointChange& change) {
+    BuildSpline(control_points);
+    return {0, static_cast<int>(spline_points_.size())};
+  }
+
+  // Returns the arc length of the spline, i.e. the length of the polyline
+  // formed by spline points.
+  float GetLength() const {
+    return segment_lengths_.GetPrefixSum(segment_lengths_.size());
+  }
+
+  // Returns the arc length from the first spline point to each spline point.
+  // This takes O(n) time, where n is the number of spline points.
+  std::vector<float> GetArcLengths() const;
+
+  // Returns the point at 'distance' along the spline, measured from the first
+  // spline point. 'distance' will be clamped to [0, GetLength()]. This takes
+  // O(log n) time, where n is the number of spline points.
+  glm::vec3 PointAtDistance(float distance) const;
+
+  // Returns points that are evenly spaced along the spline, including the first
+  // and the last spline points, such that no spline point deviates from the
+  // chord between adjacent returned points by more than 'max_error'. The number
+  // of intervals is found by bisection between 1 and a number that always
+  // meets the bound. Since the chord error does not necessarily decrease as the
+  // number of intervals increases, the result is the fewest uniform intervals
+  // found by bisection, which is not guaranteed to be the minimum. This is
+  // meant for animating along the spline at a stable pace.
+  std::vector<glm::vec3> ResampleUniform(float max_error) const;
+
+  // Returns a subset of spline points, including the first and the last ones,
+  // such that no spline point deviates from the chord between adjacent
+  // returned points by more than 'max_error'. Each chord is greedily extended
+  // along the spline until the next spline point would break the bound, so
+  // flat regions are covered by long chords and curly regions by short ones.
+  // This takes O(n * k) time, where k is the maximum number of spline points
+  // covered by one chord. The result is not guaranteed to be the minimum, since
+  // extending a chord may make the bound hold again, but it usually has much
+  // fewer points than ResampleUniform() when the curvature varies.
+  std::vector<glm::vec3> ResampleAdaptive(float max_error) const;
+
   // Accessors.
   const std::vector<glm::vec3>& spline_points() const { return spline_points_; }
 
  protected:
   Spline() = default;
 
+  // Recomputes arc lengths after all spline points are rebuilt. Segment i
+  // consists of spline points in range [segment_offsets[i],
+  // segment_offsets[i + 1]), and the last element of 'segment_offsets' must be
+  // the index of the last spline point, which closes the spline. If
+  // 'segment_offsets' is empty, all spline points are considered as one
+  // segment. Derived classes must call this whenever they finish rebuilding
+  // spline points through mutable_splines().
+  void UpdateArcLengths(absl::Span<const int> segment_offsets = {});
+
+  // Replaces spline points of 'num_points_per_segment.size()' segments starting
+  // from 'first_segment' with 'points', where each segment takes the number of
+  // points specified by 'num_points_per_segment'. Returns the range of spline
+  // points that belong to replaced segments after replacement.
+  // Arc lengths are only recomputed for replaced points, and prefix sums of
+  // segments are updated in O(log m) time per replaced segment, where m is the
+  // number of segments. Spline points after these segments are shifted only if
+  // the number of points changes, which is a single O(n) memmove, where n is
+  // the number of spline points. They are kept contiguous since the user
+  // uploads them to the device as is, where they need to be moved anyway.
+  PointRange ReplaceSegments(int first_segment,
+                             absl::Span<const glm::vec3> points,
+                             absl::Span<const int> num_points_per_segment);
+
+  // Inserts an empty segment before the segment at 'index'. The segment should
+  // be populated by ReplaceSegments(). This takes O(m log m) time.
+  void InsertEmptySegment(int index);
+
+  // Removes the segment at 'index', which must have been emptied by
+  // ReplaceSegments(). This takes O(m log m) time.
+  void RemoveEmptySegment(int index);
+
   // Accessors.
   std::vector<glm::vec3>* mutable_splines() { return &spline_points_; }
 
  private:
+  // Recomputes arc lengths of spline points in range [begin, end), which form
+  // a segment, measured from the first point of that segment.
+  void UpdateLocalArcLengths(int begin, int end);
+
+  // Returns the length of the segment that consists of spline points in range
+  // [begin, end), including the edge that connects to the first point of the
+  // next segment. Local arc lengths of the segment must be up to date.
+  float GetSegmentLength(int begin, int end) const;
+
+  // Recomputes the length of the segment at 'index'.
+  void UpdateSegmentLength(int index);
+
   // Positions of spline points.
   std::vector<glm::vec3> spline_points_;
+
+  // Value i is the number of spline points in segment i, hence segment i
+  // consists of spline points starting from the prefix sum of the first i
+  // values. The point that closes the spline does not belong to any segment.
+  spline::PrefixSumTree<int> segment_sizes_;
+
+  // Value i is the length of segment i, hence the prefix sum of the first i
+  // values is the arc length from the first spline point to the first point
+  // of segment i.
+  spline::PrefixSumTree<float> segment_lengths_;
+
+  // Element i is the arc length from the first point of the segment that
+  // contains spline point i to that point. The element for the point that
+  // closes the spline is 0.
+  std::vector<float> local_arc_lengths_;
 };
 
 // This class provides functions to build a bezier spline recursively:
@@ -98,7 +223,9 @@ class CatmullRomSpline : public BezierSpline {
   // We cannot build the spline with less than 3 control points.
   static const int kMinNumControlPoints;
 
-  // Returns a Catmull-Rom spline on sphere.
+  // Returns a Catmull-Rom spline on sphere. The returned spline is a
+  // BatchCatmullRomSpline, which builds exactly the same spline points as a
+  // CatmullRomSpline with the same middle point and smoothness functions.
   static std::unique_ptr<Spline> GetOnSphereSpline(
       int max_recursion_depth, float roughness);
 
@@ -121,20 +248,314 @@ class CatmullRomSpline : public BezierSpline {
                   const glm::vec3& p3);
 };
 
+// This class builds the same Catmull-Rom splines as CatmullRomSpline, but uses
+// spline::BezierTessellator for tessellation, which avoids recursion and
+// std::function, and processes multiple segments at a time with SIMD.
+// See spline::BezierTessellator for requirements on the policies. Besides,
+// policies must be copyable, since each chunk of segments built in parallel
+// uses its own tessellator.
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+class BatchCatmullRomSpline : public Spline {
+ public:
+  BatchCatmullRomSpline(int max_recursion_depth,
+                        MiddlePointPolicy middle_point_policy,
+                        SmoothnessPolicy smoothness_policy)
+      : max_recursion_depth_{max_recursion_depth},
+        middle_point_policy_{std::move(middle_point_policy)},
+        smoothness_policy_{std::move(smoothness_policy)},
+        tessellator_{max_recursion_depth_, middle_point_policy_,
+                     smoothness_policy_} {}
+
+  // This class is neither copyable nor movable.
+  BatchCatmullRomSpline(const BatchCatmullRomSpline&) = delete;
+  BatchCatmullRomSpline& operator=(const BatchCatmullRomSpline&) = delete;
+
+  // Overrides.
+  void BuildSpline(absl::Span<const glm::vec3> control_points) override;
+
+  // Overrides. Only segments affected by 'change' will be rebuilt, and the
+  // newly generated spline points are spliced with the unchanged ones.
+  PointRange UpdateSpline(absl::Span<const glm::vec3> control_points,
+                          const spline::ControlPointChange& change) override;
+
+  // Overrides. Segments are split into chunks, which are tessellated in
+  // parallel, and then copied to preallocated slices of 'spline_points_'.
+  void BuildSplineInParallel(absl::Span<const glm::vec3> control_points,
+                             ThreadPool& thread_pool) override;
+
+ private:
+  using Tessellator =
+      spline::BezierTessellator<MiddlePointPolicy, SmoothnessPolicy>;
+
+  // Each chunk built in parallel contains at least this number of segments, so
+  // that the overhead of scheduling is amortized.
+  static constexpr int kMinNumSegmentsPerChunk = 32;
+
+  // Maximum number of chunks per thread. Having more chunks than threads helps
+  // balance the workload, since some segments are subdivided more than others.
+  static constexpr int kMaxNumChunksPerThread = 4;
+  // Validates the number of control points.
+  static void ValidateNumControlPoints(int num_control_points) {
+    ASSERT_TRUE(num_control_points >= CatmullRomSpline::kMinNumControlPoints,
+                absl::StrFormat(
+                    "Must have at least %d control points, while %d provided",
+                    CatmullRomSpline::kMinNumControlPoints,
+                    num_control_points));
+  }
+
+  // Converts Catmull-Rom control points to bezier control points of the segment
+  // at 'index'.
+  static spline::BezierSegment ConvertSegment(
+      absl::Span<const glm::vec3> control_points, int index) {
+    const auto num_control_points = static_cast<int>(control_points.size());
+    return spline::ConvertCatmullRomToBezier(
+        control_points[(index + 0) % num_control_points],
+        control_points[(index + 1) % num_control_points],
+        control_points[(index + 2) % num_control_points],
+        control_points[(index + 3) % num_control_points]);
+  }
+
+  // Converts the number of points per segment stored in the first
+  // 'offsets.size() - 1' elements of 'offsets' to offsets in place. The last
+  // element will be the total number of points.
+  static void ConvertToOffsets(absl::Span<int> offsets) {
+    const int num_segments = static_cast<int>(offsets.size()) - 1;
+    int offset = 0;
+    for (int i = 0; i <= num_segments; ++i) {
+      const int num_points = i < num_segments ? offsets[i] : 0;
+      offsets[i] = offset;
+      offset += num_points;
+    }
+  }
+
+  // Returns the sum of the first 'count' elements of 'values'.
+  static int Sum(absl::Span<const int> values, int count) {
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+      sum += values[i];
+    }
+    return sum;
+  }
+
+  // Used for constructing tessellators for chunks.
+  const int max_recursion_depth_;
+  const MiddlePointPolicy middle_point_policy_;
+  const SmoothnessPolicy smoothness_policy_;
+
+  // Bezier segments converted from Catmull-Rom control points. This is kept as
+  // a member to avoid allocating memory every time we rebuild the spline.
+  std::vector<spline::BezierSegment> segments_;
+
+  // Segment i generates spline points in range
+  // [segment_offsets_[i], segment_offsets_[i + 1]) when the entire spline is
+  // built. This is only used as a scratch buffer, since UpdateSpline() keeps
+  // segment sizes in the base class up to date.
+  std::vector<int> segment_offsets_;
+
+  // Scratch buffers used by UpdateSpline() for tessellating dirty segments.
+  std::vector<spline::BezierSegment> dirty_segments_;
+  std::vector<int> dirty_num_points_;
+  std::vector<glm::vec3> dirty_spline_points_;
+
+  // Tessellates bezier segments.
+  Tessellator tessellator_;
+
+  // Tessellators and output buffers of chunks, used by BuildSplineInParallel().
+  std::vector<std::unique_ptr<Tessellator>> chunk_tessellators_;
+  std::vector<std::vector<glm::vec3>> chunk_spline_points_;
+};
+
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+void BatchCatmullRomSpline<MiddlePointPolicy, SmoothnessPolicy>::BuildSpline(
+    absl::Span<const glm::vec3> control_points) {
+  const auto num_control_points = static_cast<int>(control_points.size());
+  ValidateNumControlPoints(num_control_points);
+
+  segments_.resize(num_control_points);
+  for (int i = 0; i < num_control_points; ++i) {
+    segments_[i] = ConvertSegment(control_points, i);
+  }
+
+  // Number of points per segment is first written to 'segment_offsets_', and
+  // then converted to offsets in place.
+  segment_offsets_.resize(num_control_points + 1);
+  mutable_splines()->clear();
+  tessellator_.Tessellate(
+      segments_, *mutable_splines(),
+      absl::MakeSpan(segment_offsets_.data(), num_control_points));
+  ConvertToOffsets(absl::MakeSpan(segment_offsets_));
+
+  // Close the spline.
+  mutable_splines()->push_back(spline_points()[0]);
+  UpdateArcLengths(segment_offsets_);
+}
+
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+Spline::PointRange
+BatchCatmullRomSpline<MiddlePointPolicy, SmoothnessPolicy>::UpdateSpline(
+    absl::Span<const glm::vec3> control_points,
+    const spline::ControlPointChange& change) {
+  using ChangeType = spline::ControlPointChange::Type;
+
+  const auto num_control_points = static_cast<int>(control_points.size());
+  ValidateNumControlPoints(num_control_points);
+
+  const spline::AffectedSegments affected{change, num_control_points};
+  if (affected.num_old_segments() != static_cast<int>(segments_.size())) {
+    // The previous spline was not built from control points before the change.
+    BuildSpline(control_points);
+    return {0, static_cast<int>(spline_points().size())};
+  }
+
+  // Make segments before and after the change share indices, so that spline
+  // points can be replaced in place. An inserted segment starts empty. A
+  // removed segment is emptied together with dirty segments, and erased
+  // afterwards. It always follows dirty segments.
+  const bool is_removal = change.type == ChangeType::kRemove;
+  if (change.type == ChangeType::kInsert) {
+    segments_.insert(segments_.begin() + change.index, spline::BezierSegment{});
+    InsertEmptySegment(change.index);
+  }
+  const int num_slots = static_cast<int>(segments_.size());
+  const int num_dirty_segments = affected.num_dirty_segments();
+  const int num_replaced_slots = num_dirty_segments + (is_removal ? 1 : 0);
+  const int first_slot =
+      is_removal ? (change.index - 3 + num_slots) % num_slots
+                 : affected.first_dirty_segment();
+
+  // Tessellate dirty segments.
+  dirty_segments_.resize(num_dirty_segments);
+  for (int i = 0; i < num_dirty_segments; ++i) {
+    const int index =
+        (affected.first_dirty_segment() + i) % affected.num_segments();
+    dirty_segments_[i] = ConvertSegment(control_points, index);
+    segments_[(first_slot + i) % num_slots] = dirty_segments_[i];
+  }
+  dirty_num_points_.resize(num_replaced_slots);
+  dirty_spline_points_.clear();
+  tessellator_.Tessellate(
+      dirty_segments_, dirty_spline_points_,
+      absl::MakeSpan(dirty_num_points_.data(), num_dirty_segments));
+  if (is_removal) {
+    dirty_num_points_.back() = 0;
+  }
+
+  // Replaced slots may wrap around, in which case they are split into a tail
+  // run and a head run, and the entire spline is considered dirty.
+  const int num_old_points = static_cast<int>(spline_points().size());
+  const int num_tail_slots =
+      std::min(num_replaced_slots, num_slots - first_slot);
+  const int num_tail_points = Sum(dirty_num_points_, num_tail_slots);
+  PointRange dirty_range = ReplaceSegments(
+      first_slot,
+      absl::MakeConstSpan(dirty_spline_points_).subspan(0, num_tail_points),
+      absl::MakeConstSpan(dirty_num_points_).subspan(0, num_tail_slots));
+  if (num_tail_slots < num_replaced_slots) {
+    ReplaceSegments(
+        /*first_segment=*/0,
+        absl::MakeConstSpan(dirty_spline_points_).subspan(num_tail_points),
+        absl::MakeConstSpan(dirty_num_points_).subspan(num_tail_slots));
+    dirty_range.begin = 0;
+  }
+  if (is_removal) {
+    segments_.erase(segments_.begin() + change.index);
+    RemoveEmptySegment(change.index);
+  }
+
+  // If the first spline point is replaced, so is the point that closes the
+  // spline. If the number of points changes, all later points are moved.
+  const auto num_points = static_cast<int>(spline_points().size());
+  if (dirty_range.begin == 0 || num_points != num_old_points) {
+    dirty_range.end = num_points;
+  }
+  return dirty_range;
+}
+
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+void BatchCatmullRomSpline<MiddlePointPolicy, SmoothnessPolicy>::
+    BuildSplineInParallel(absl::Span<const glm::vec3> control_points,
+                          ThreadPool& thread_pool) {
+  const auto num_control_points = static_cast<int>(control_points.size());
+  ValidateNumControlPoints(num_control_points);
+
+  const int num_chunks = std::min(
+      (num_control_points + kMinNumSegmentsPerChunk - 1) /
+          kMinNumSegmentsPerChunk,
+      (thread_pool.num_threads() + 1) * kMaxNumChunksPerThread);
+  if (num_chunks <= 1) {
+    BuildSpline(control_points);
+    return;
+  }
+
+  while (chunk_tessellators_.size() < num_chunks) {
+    chunk_tessellators_.push_back(std::make_unique<Tessellator>(
+        max_recursion_depth_, middle_point_policy_, smoothness_policy_));
+  }
+  if (chunk_spline_points_.size() < num_chunks) {
+    chunk_spline_points_.resize(num_chunks);
+  }
+
+  // Chunk i contains segments in range
+  // [get_chunk_begin(i), get_chunk_begin(i + 1)).
+  const auto get_chunk_begin = [num_control_points, num_chunks](int chunk) {
+    return static_cast<int>(static_cast<int64_t>(num_control_points) * chunk /
+                            num_chunks);
+  };
+
+  // Number of points per segment is first written to 'segment_offsets_', and
+  // then converted to offsets in place.
+  segments_.resize(num_control_points);
+  segment_offsets_.resize(num_control_points + 1);
+  thread_pool.ParallelFor(num_chunks, [&](int chunk) {
+    const int begin = get_chunk_begin(chunk);
+    const int num_segments = get_chunk_begin(chunk + 1) - begin;
+    for (int i = begin; i < begin + num_segments; ++i) {
+      segments_[i] = ConvertSegment(control_points, i);
+    }
+    auto& points = chunk_spline_points_[chunk];
+    points.clear();
+    chunk_tessellators_[chunk]->Tessellate(
+        absl::MakeConstSpan(segments_).subspan(begin, num_segments), points,
+        absl::MakeSpan(segment_offsets_).subspan(begin, num_segments));
+  });
+  ConvertToOffsets(absl::MakeSpan(segment_offsets_));
+
+  // Copy spline points of each chunk to its slice, and close the spline.
+  auto& spline_points = *mutable_splines();
+  spline_points.resize(segment_offsets_[num_control_points] + 1);
+  thread_pool.ParallelFor(num_chunks, [&](int chunk) {
+    const auto& points = chunk_spline_points_[chunk];
+    std::copy(points.begin(), points.end(),
+              spline_points.begin() + segment_offsets_[get_chunk_begin(chunk)]);
+  });
+  spline_points.back() = spline_points[0];
+  UpdateArcLengths(segment_offsets_);
+}
+
 // This class is used to handle user interactions with control points. The user
 // can build any kind of splines and pass to this class, and manipulate the
 // spline through it.
 class SplineEditor {
  public:
+  // If 'build_spline' is false, the spline will not be built until
+  // RebuildAll() is called with this editor, so that the user can build splines
+  // of multiple editors in parallel.
   SplineEditor(int min_num_control_points,
                int max_num_control_points,
                std::vector<glm::vec3>&& initial_control_points,
-               std::unique_ptr<Spline>&& spline);
+               std::unique_ptr<Spline>&& spline,
+               bool build_spline = true);
 
   // This class is neither copyable nor movable.
   SplineEditor(const SplineEditor&) = delete;
   SplineEditor& operator=(const SplineEditor&) = delete;
 
+  // Rebuilds splines of all 'editors' from their control points. Splines of
+  // different editors, as well as independent segments of each spline, are
+  // built in parallel on 'thread_pool'.
+  static void RebuildAll(absl::Span<SplineEditor* const> editors,
+                         ThreadPool& thread_pool);
+
   // Returns whether we can insert any more control points.
   bool CanInsertControlPoint() const;
 
@@ -154,11 +575,19 @@ class SplineEditor {
   const std::vector<glm::vec3>& spline_points() const {
     return spline_->spline_points();
   }
+  const Spline::PointRange& dirty_spline_points() const {
+    return dirty_spline_points_;
+  }
+  const Spline& spline() const { return *spline_; }
 
  private:
-  // Re-generates all spline points. This should be called whenever any control
-  // point changes.
-  void RebuildSpline();
+  // Re-generates spline points after a control point changes as described by
+  // 'change'. Only spline points affected by the change may be regenerated,
+  // depending on the type of spline.
+  void UpdateSpline(const spline::ControlPointChange& change);
+
+  // Rebuilds the entire spline, using 'thread_pool' if it is not nullptr.
+  void RebuildSpline(ThreadPool* thread_pool);
 
   // Minimum/maximum number of control points.
   const int min_num_control_points_;
@@ -169,6 +598,10 @@ class SplineEditor {
 
   // Determines how to build the spline from control points.
   std::unique_ptr<Spline> spline_;
+
+  // Range of spline points that may have changed since the last time control
+  // points changed.
+  Spline::PointRange dirty_spline_points_;
 };
 
 }  // namespace lighter::common
@@ -0,0 +1,141 @@
+//
+//  spline_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/spline.h"
+#include "third_party/glm/glm.hpp"
+#include "third_party/glm/gtx/vector_angle.hpp"
+
+namespace lighter::common {
+namespace {
+
+// Same as the settings used by the aurora editor.
+constexpr int kMaxRecursionDepth = 20;
+constexpr float kSplineRoughness = 1E-2;
+
+// Returns a CatmullRomSpline on sphere, which builds splines recursively and
+// calls policies through std::function.
+std::unique_ptr<Spline> GetRecursiveOnSphereSpline() {
+  BezierSpline::GetMiddlePoint get_middle_point =
+      [](const glm::vec3& p0, const glm::vec3& p1) {
+        return glm::normalize(p0 + p1) * glm::length(p0);
+      };
+
+  BezierSpline::IsSmooth is_smooth = [](const glm::vec3& p0,
+                                        const glm::vec3& p1,
+                                        const glm::vec3& p2,
+                                        const glm::vec3& p3) {
+    const glm::vec3 p0p1 = glm::normalize(p0 - p1);
+    const glm::vec3 p1p2 = glm::normalize(p1 - p2);
+    const glm::vec3 p2p3 = glm::normalize(p2 - p3);
+    return glm::angle(p0p1, p1p2) <= kSplineRoughness &&
+           glm::angle(p1p2, p2p3) <= kSplineRoughness;
+  };
+
+  return std::make_unique<CatmullRomSpline>(
+      kMaxRecursionDepth, std::move(get_middle_point), std::move(is_smooth));
+}
+
+// Returns 'num_points' control points on a unit sphere. Adjacent points are
+// close to each other, like paths drawn by the user.
+std::vector<glm::vec3> GenerateControlPoints(int num_points) {
+  std::mt19937 generator{0};
+  std::uniform_real_distribution<float> distribution{-0.1f, 0.1f};
+  std::vector<glm::vec3> points(num_points);
+  const float step = glm::radians(360.0f) / num_points;
+  for (int i = 0; i < num_points; ++i) {
+    const float theta = step * i;
+    points[i] = glm::normalize(glm::vec3{
+        glm::cos(theta), glm::sin(theta), distribution(generator)});
+  }
+  return points;
+}
+
+// Builds the spline repeatedly and reports the number of generated spline
+// points per second.
+void RunBenchmark(benchmark::State& state, Spline& spline) {
+  const auto control_points =
+      GenerateControlPoints(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    spline.BuildSpline(control_points);
+    benchmark::DoNotOptimize(spline.spline_points().data());
+  }
+  state.counters["points"] = benchmark::Counter(
+      static_cast<double>(spline.spline_points().size()) * state.iterations(),
+      benchmark::Counter::kIsRate);
+}
+
+void BM_RecursiveOnSphereSpline(benchmark::State& state) {
+  const auto spline = GetRecursiveOnSphereSpline();
+  RunBenchmark(state, *spline);
+}
+
+void BM_BatchOnSphereSpline(benchmark::State& state) {
+  const auto spline = CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth,
+                                                          kSplineRoughness);
+  RunBenchmark(state, *spline);
+}
+
+// Moves one control point back and forth on a spline with the given number of
+// control points. The cost per edit should not grow with the path length.
+void BM_EditOnSphereSpline(benchmark::State& state) {
+  const auto num_control_points = static_cast<int>(state.range(0));
+  SplineEditor editor{
+      CatmullRomSpline::kMinNumControlPoints, num_control_points,
+      GenerateControlPoints(num_control_points),
+      CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth,
+                                          kSplineRoughness)};
+  const int index = num_control_points / 2;
+  const glm::vec3 original = editor.control_points()[index];
+  const glm::vec3 moved =
+      glm::normalize(original + glm::vec3{0.0f, 0.0f, 0.1f});
+  bool use_moved = true;
+  for (auto _ : state) {
+    editor.UpdateControlPoint(index, use_moved ? moved : original);
+    use_moved = !use_moved;
+    benchmark::DoNotOptimize(editor.dirty_spline_points());
+  }
+}
+
+// Rebuilds 32 paths with 1000 control points each on a thread pool with the
+// given number of threads.
+void BM_RebuildAllOnSphereSplines(benchmark::State& state) {
+  constexpr int kNumPaths = 32;
+  constexpr int kNumControlPoints = 1000;
+  std::vector<std::unique_ptr<SplineEditor>> editors;
+  std::vector<SplineEditor*> editor_ptrs;
+  for (int i = 0; i < kNumPaths; ++i) {
+    editors.push_back(std::make_unique<SplineEditor>(
+        CatmullRomSpline::kMinNumControlPoints, kNumControlPoints,
+        GenerateControlPoints(kNumControlPoints),
+        CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth,
+                                            kSplineRoughness),
+        /*build_spline=*/false));
+    editor_ptrs.push_back(editors.back().get());
+  }
+
+  ThreadPool thread_pool{static_cast<int>(state.range(0))};
+  for (auto _ : state) {
+    SplineEditor::RebuildAll(editor_ptrs, thread_pool);
+  }
+}
+
+BENCHMARK(BM_RecursiveOnSphereSpline)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_BatchOnSphereSpline)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_EditOnSphereSpline)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_RebuildAllOnSphereSplines)
+    ->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+}  // namespace
+}  // namespace lighter::common
+
+BENCHMARK_MAIN();
@@ -0,0 +1,348 @@
+//
+//  spline_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/spline.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "third_party/glm/glm.hpp"
+#include "third_party/glm/gtx/vector_angle.hpp"
+
+namespace lighter::common {
+namespace {
+
+// Returns a CatmullRomSpline on sphere, which uses std::function and recursion
+// to build splines. This is what CatmullRomSpline::GetOnSphereSpline() used to
+// return, and is used as the reference implementation.
+std::unique_ptr<Spline> GetReferenceOnSphereSpline(int max_recursion_depth,
+                                                   float roughness) {
+  BezierSpline::GetMiddlePoint get_middle_point =
+      [](const glm::vec3& p0, const glm::vec3& p1) {
+        return glm::normalize(p0 + p1) * glm::length(p0);
+      };
+
+  BezierSpline::IsSmooth is_smooth = [roughness](const glm::vec3& p0,
+                                                 const glm::vec3& p1,
+                                                 const glm::vec3& p2,
+                                                 const glm::vec3& p3) {
+    const glm::vec3 p0p1 = glm::normalize(p0 - p1);
+    const glm::vec3 p1p2 = glm::normalize(p1 - p2);
+    const glm::vec3 p2p3 = glm::normalize(p2 - p3);
+    return glm::angle(p0p1, p1p2) <= roughness &&
+           glm::angle(p1p2, p2p3) <= roughness;
+  };
+
+  return std::make_unique<CatmullRomSpline>(
+      max_recursion_depth, std::move(get_middle_point), std::move(is_smooth));
+}
+
+// Returns 'num_points' random points on a unit sphere.
+std::vector<glm::vec3> GenerateControlPoints(int num_points, int seed) {
+  std::mt19937 generator{static_cast<std::mt19937::result_type>(seed)};
+  std::normal_distribution<float> distribution;
+  std::vector<glm::vec3> points(num_points);
+  for (auto& point : points) {
+    point = glm::normalize(glm::vec3{distribution(generator),
+                                     distribution(generator),
+                                     distribution(generator)});
+  }
+  return points;
+}
+
+// Expects 'spline_points' to be bit-identical to 'expected_points'.
+void ExpectSamePoints(const std::vector<glm::vec3>& expected_points,
+                      const std::vector<glm::vec3>& spline_points) {
+  ASSERT_EQ(spline_points.size(), expected_points.size());
+  for (int i = 0; i < spline_points.size(); ++i) {
+    EXPECT_EQ(spline_points[i], expected_points[i]) << "at index " << i;
+  }
+}
+
+TEST(SplineTest, OnSphereSplineMatchesReference) {
+  for (int max_recursion_depth : {1, 5, 20}) {
+    for (float roughness : {0.001f, 0.01f, 0.1f, 1.0f, 4.0f}) {
+      for (int num_control_points : {3, 4, 17, 100}) {
+        const auto control_points =
+            GenerateControlPoints(num_control_points, /*seed=*/
+                                  num_control_points + max_recursion_depth);
+        const auto reference =
+            GetReferenceOnSphereSpline(max_recursion_depth, roughness);
+        const auto spline = CatmullRomSpline::GetOnSphereSpline(
+            max_recursion_depth, roughness);
+        reference->BuildSpline(control_points);
+        spline->BuildSpline(control_points);
+        ExpectSamePoints(reference->spline_points(), spline->spline_points());
+      }
+    }
+  }
+}
+
+TEST(SplineTest, RebuildWithSameSpline) {
+  const auto spline = CatmullRomSpline::GetOnSphereSpline(
+      /*max_recursion_depth=*/20, /*roughness=*/0.01f);
+  const auto reference = GetReferenceOnSphereSpline(
+      /*max_recursion_depth=*/20, /*roughness=*/0.01f);
+  for (int num_control_points : {50, 10, 30}) {
+    const auto control_points =
+        GenerateControlPoints(num_control_points, /*seed=*/0);
+    reference->BuildSpline(control_points);
+    spline->BuildSpline(control_points);
+    ExpectSamePoints(reference->spline_points(), spline->spline_points());
+  }
+}
+
+TEST(SplineTest, RebuildAllMatchesSerialBuild) {
+  constexpr int kMaxRecursionDepth = 20;
+  constexpr float kRoughness = 0.01f;
+  constexpr int kMaxNumControlPoints = 10000;
+  const std::vector<int> num_control_points_per_editor{3, 100, 1000, 5000};
+
+  std::vector<std::unique_ptr<SplineEditor>> editors;
+  std::vector<SplineEditor*> editor_ptrs;
+  for (int i = 0; i < num_control_points_per_editor.size(); ++i) {
+    editors.push_back(std::make_unique<SplineEditor>(
+        CatmullRomSpline::kMinNumControlPoints, kMaxNumControlPoints,
+        GenerateControlPoints(num_control_points_per_editor[i], /*seed=*/i),
+        CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth, kRoughness),
+        /*build_spline=*/false));
+    editor_ptrs.push_back(editors.back().get());
+  }
+
+  ThreadPool thread_pool{/*num_threads=*/4};
+  SplineEditor::RebuildAll(editor_ptrs, thread_pool);
+  const auto reference =
+      CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth, kRoughness);
+  for (const auto& editor : editors) {
+    reference->BuildSpline(editor->control_points());
+    ExpectSamePoints(reference->spline_points(), editor->spline_points());
+    EXPECT_EQ(editor->dirty_spline_points().begin, 0);
+    EXPECT_EQ(editor->dirty_spline_points().end,
+              editor->spline_points().size());
+  }
+}
+
+TEST(SplineTest, ArcLength) {
+  const auto spline = CatmullRomSpline::GetOnSphereSpline(
+      /*max_recursion_depth=*/20, /*roughness=*/0.01f);
+  spline->BuildSpline(GenerateControlPoints(/*num_points=*/20, /*seed=*/0));
+  const auto& spline_points = spline->spline_points();
+  const std::vector<float> arc_lengths = spline->GetArcLengths();
+  ASSERT_EQ(arc_lengths.size(), spline_points.size());
+  for (int i = 1; i < spline_points.size(); ++i) {
+    EXPECT_NEAR(arc_lengths[i] - arc_lengths[i - 1],
+                glm::distance(spline_points[i - 1], spline_points[i]), 1E-5f)
+        << "at index " << i;
+  }
+
+  const float length = spline->GetLength();
+  EXPECT_EQ(spline->PointAtDistance(-1.0f), spline_points.front());
+  EXPECT_EQ(spline->PointAtDistance(length + 1.0f), spline_points.back());
+  for (int i = 0; i < spline_points.size(); ++i) {
+    EXPECT_LT(glm::distance(spline->PointAtDistance(arc_lengths[i]),
+                            spline_points[i]), 1E-5f) << "at index " << i;
+  }
+
+  constexpr float kMaxError = 1E-2f;
+  const std::vector<glm::vec3> samples = spline->ResampleUniform(kMaxError);
+  ASSERT_GE(samples.size(), 2);
+  EXPECT_LT(samples.size(), spline_points.size());
+  EXPECT_EQ(samples.front(), spline_points.front());
+  EXPECT_EQ(samples.back(), spline_points.back());
+  const float interval = length / (samples.size() - 1);
+  for (int i = 1; i < samples.size(); ++i) {
+    EXPECT_LE(glm::distance(samples[i - 1], samples[i]), interval * 1.001f)
+        << "at index " << i;
+  }
+}
+
+TEST(SplineTest, ResampleAdaptive) {
+  const auto spline = CatmullRomSpline::GetOnSphereSpline(
+      /*max_recursion_depth=*/20, /*roughness=*/0.01f);
+  spline->BuildSpline(GenerateControlPoints(/*num_points=*/20, /*seed=*/0));
+  const auto& spline_points = spline->spline_points();
+
+  constexpr float kMaxError = 1E-2f;
+  const std::vector<glm::vec3> samples = spline->ResampleAdaptive(kMaxError);
+  ASSERT_GE(samples.size(), 2);
+  EXPECT_LE(samples.size(), spline->ResampleUniform(kMaxError).size());
+  EXPECT_EQ(samples.front(), spline_points.front());
+  EXPECT_EQ(samples.back(), spline_points.back());
+
+  // Samples are spline points in order, and every spline point in between is
+  // close to the chord.
+  int sample = 0;
+  for (int i = 0; i < spline_points.size(); ++i) {
+    if (sample + 1 < samples.size() &&
+        spline_points[i] == samples[sample + 1]) {
+      ++sample;
+      continue;
+    }
+    ASSERT_LT(sample + 1, samples.size()) << "at index " << i;
+    const glm::vec3& p0 = samples[sample];
+    const glm::vec3& p1 = samples[sample + 1];
+    const float t = glm::clamp(
+        glm::dot(spline_points[i] - p0, p1 - p0) / glm::dot(p1 - p0, p1 - p0),
+        0.0f, 1.0f);
+    EXPECT_LE(glm::distance(spline_points[i], p0 + (p1 - p0) * t),
+              kMaxError * 1.001f) << "at index " << i;
+  }
+  EXPECT_EQ(sample, samples.size() - 1);
+}
+
+TEST(SplineTest, AffectedSegments) {
+  using Type = spline::ControlPointChange::Type;
+
+  const spline::AffectedSegments update{{Type::kUpdate, /*index=*/1},
+                                        /*num_control_points=*/10};
+  EXPECT_EQ(update.num_old_segments(), 10);
+  EXPECT_EQ(update.first_dirty_segment(), 8);
+  EXPECT_EQ(update.num_dirty_segments(), 4);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(update.IsDirty(i), i <= 1 || i >= 8) << "at index " << i;
+  }
+
+  const spline::AffectedSegments insert{{Type::kInsert, /*index=*/5},
+                                        /*num_control_points=*/10};
+  EXPECT_EQ(insert.num_old_segments(), 9);
+  EXPECT_EQ(insert.first_dirty_segment(), 2);
+  EXPECT_EQ(insert.num_dirty_segments(), 4);
+  EXPECT_EQ(insert.GetOldIndex(1), 1);
+  EXPECT_EQ(insert.GetOldIndex(6), 5);
+
+  const spline::AffectedSegments remove{{Type::kRemove, /*index=*/5},
+                                        /*num_control_points=*/10};
+  EXPECT_EQ(remove.num_old_segments(), 11);
+  EXPECT_EQ(remove.first_dirty_segment(), 2);
+  EXPECT_EQ(remove.num_dirty_segments(), 3);
+  EXPECT_EQ(remove.GetOldIndex(1), 1);
+  EXPECT_EQ(remove.GetOldIndex(5), 6);
+
+  const spline::AffectedSegments few_points{{Type::kUpdate, /*index=*/0},
+                                            /*num_control_points=*/3};
+  EXPECT_EQ(few_points.num_dirty_segments(), 3);
+}
+
+TEST(SplineTest, PrefixSumTree) {
+  std::mt19937 generator{0};
+  std::uniform_real_distribution<float> distribution{0.1f, 1.0f};
+  std::vector<float> values(37);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+
+  spline::PrefixSumTree<float> tree;
+  tree.Reset(values);
+  for (int step = 0; step < 200; ++step) {
+    const int index = static_cast<int>(generator() % values.size());
+    switch (generator() % 3) {
+      case 0:
+        values[index] = distribution(generator);
+        tree.Set(index, values[index]);
+        break;
+      case 1:
+        values.insert(values.begin() + index, 0.0f);
+        tree.Insert(index, 0.0f);
+        break;
+      case 2:
+        values.erase(values.begin() + index);
+        tree.Erase(index);
+        break;
+    }
+    ASSERT_EQ(tree.size(), values.size());
+
+    // Prefix sums only depend on current values.
+    spline::PrefixSumTree<float> rebuilt;
+    rebuilt.Reset(values);
+    float sum = 0.0f;
+    for (int count = 0; count <= values.size(); ++count) {
+      EXPECT_EQ(tree.GetPrefixSum(count), rebuilt.GetPrefixSum(count));
+      EXPECT_NEAR(tree.GetPrefixSum(count), sum, 1E-4f);
+      if (count < values.size()) {
+        sum += values[count];
+      }
+    }
+
+    // Inserted values are 0, and the others are large enough that rounding
+    // errors do not matter.
+    for (int count = 0; count < values.size(); ++count) {
+      if (values[count] > 0.0f) {
+        EXPECT_EQ(tree.GetMaxCount(tree.GetPrefixSum(count) +
+                                   values[count] / 2.0f), count);
+      }
+    }
+    EXPECT_EQ(tree.GetMaxCount(-1.0f), 0);
+    EXPECT_EQ(tree.GetMaxCount(sum + 1.0f), values.size());
+  }
+}
+
+TEST(SplineTest, IncrementalEditMatchesRebuild) {
+  constexpr int kMaxRecursionDepth = 20;
+  constexpr float kRoughness = 0.01f;
+  constexpr int kMaxNumControlPoints = 40;
+  std::mt19937 generator{0};
+  const auto random_point = [&generator]() {
+    return GenerateControlPoints(/*num_points=*/1,
+                                 /*seed=*/static_cast<int>(generator()))[0];
+  };
+
+  SplineEditor editor{
+      CatmullRomSpline::kMinNumControlPoints, kMaxNumControlPoints,
+      GenerateControlPoints(/*num_control_points=*/10, /*seed=*/0),
+      CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth, kRoughness)};
+  const auto reference =
+      GetReferenceOnSphereSpline(kMaxRecursionDepth, kRoughness);
+  const auto rebuilt =
+      CatmullRomSpline::GetOnSphereSpline(kMaxRecursionDepth, kRoughness);
+  for (int step = 0; step < 500; ++step) {
+    const std::vector<glm::vec3> old_points = editor.spline_points();
+    const int num_control_points =
+        static_cast<int>(editor.control_points().size());
+    switch (generator() % 3) {
+      case 0:
+        editor.UpdateControlPoint(generator() % num_control_points,
+                                  random_point());
+        break;
+      case 1:
+        editor.InsertControlPoint(generator() % (num_control_points + 1),
+                                  random_point());
+        break;
+      case 2:
+        editor.RemoveControlPoint(generator() % num_control_points);
+        break;
+    }
+
+    reference->BuildSpline(editor.control_points());
+    ExpectSamePoints(reference->spline_points(), editor.spline_points());
+    // Arc lengths are accumulated per segment, so they must exactly match with
+    // those of a spline built from scratch.
+    rebuilt->BuildSpline(editor.control_points());
+    EXPECT_EQ(editor.spline().GetArcLengths(), rebuilt->GetArcLengths());
+    EXPECT_NEAR(editor.spline().GetLength(), reference->GetLength(),
+                reference->GetLength() * 1E-5f);
+
+    // Points outside of the dirty range must be unchanged.
+    const auto& new_points = editor.spline_points();
+    const Spline::PointRange& dirty_range = editor.dirty_spline_points();
+    ASSERT_LE(0, dirty_range.begin);
+    ASSERT_LE(dirty_range.begin, dirty_range.end);
+    ASSERT_LE(dirty_range.end, new_points.size());
+    if (dirty_range.end < new_points.size()) {
+      ASSERT_EQ(new_points.size(), old_points.size());
+    }
+    for (int i = 0; i < new_points.size(); ++i) {
+      if (i < dirty_range.begin || i >= dirty_range.end) {
+        EXPECT_EQ(new_points[i], old_points[i]) << "at index " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace lighter::common
@@ -0,0 +1,124 @@
+//
+//  spline_util.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/spline_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lighter::common::spline {
+namespace {
+
+// Returns the matrix that converts Catmull-Rom control points to bezier control
+// points.
+const glm::mat4& GetCatmullRomToBezierMatrix() {
+  static const glm::mat4 catmull_rom_to_bezier = [] {
+    const glm::mat4 catmull_rom_coeff{
+        -0.5f,  1.5f, -1.5f,  0.5f,
+         1.0f, -2.5f,  2.0f, -0.5f,
+        -0.5f,  0.0f,  0.5f,  0.0f,
+         0.0f,  1.0f,  0.0f,  0.0f
+    };
+    const glm::mat4 bezier_coeff{
+        -1.0f,  3.0f, -3.0f,  1.0f,
+         3.0f, -6.0f,  3.0f,  0.0f,
+        -3.0f,  3.0f,  0.0f,  0.0f,
+         1.0f,  0.0f,  0.0f,  0.0f,
+    };
+    return catmull_rom_coeff * glm::inverse(bezier_coeff);
+  }();
+  return catmull_rom_to_bezier;
+}
+
+// Returns the smallest float 'x' such that std::acos(x) <= 'angle', where 'x'
+// is first clamped to [-1.0, 1.0] like glm::angle() does. Since acos() is
+// monotonically decreasing, for any non-NaN 'x', std::acos(clamp(x)) <= 'angle'
+// is equivalent to 'x' >= the returned value.
+float ComputeMinCosine(float angle) {
+  constexpr float kInfinity = std::numeric_limits<float>::infinity();
+  if (std::acos(1.0f) > angle) {
+    return kInfinity;
+  }
+  if (std::acos(-1.0f) <= angle) {
+    return -kInfinity;
+  }
+
+  // std::cos() gives a good initial guess. Adjust it by ULPs.
+  float cosine = std::clamp(std::cos(angle), -1.0f, 1.0f);
+  while (std::acos(cosine) > angle) {
+    cosine = std::nextafter(cosine, 1.0f);
+  }
+  while (true) {
+    const float smaller = std::nextafter(cosine, -1.0f);
+    if (std::acos(smaller) > angle) {
+      break;
+    }
+    cosine = smaller;
+  }
+  return cosine;
+}
+
+}  // namespace
+
+BezierSegment ConvertCatmullRomToBezier(const glm::vec3& p0,
+                                        const glm::vec3& p1,
+                                        const glm::vec3& p2,
+                                        const glm::vec3& p3) {
+  const glm::mat4 catmull_rom_points{
+      glm::vec4{p0, 0.0f},
+      glm::vec4{p1, 0.0f},
+      glm::vec4{p2, 0.0f},
+      glm::vec4{p3, 0.0f},
+  };
+  const glm::mat4 bezier_points =
+      catmull_rom_points * GetCatmullRomToBezierMatrix();
+  return {bezier_points[0], bezier_points[1], bezier_points[2],
+          bezier_points[3]};
+}
+
+AffectedSegments::AffectedSegments(const ControlPointChange& change,
+                                   int num_control_points)
+    : change_{change}, num_segments_{num_control_points} {
+  ASSERT_TRUE(num_segments_ > 0, "No control point provided");
+
+  // For update and insertion, the dirty segments are those that contain the
+  // changed control point. For removal, they are those that contain both
+  // neighbors of the removed control point.
+  int num_dirty_segments = 4;
+  switch (change_.type) {
+    case ControlPointChange::Type::kUpdate:
+      num_old_segments_ = num_segments_;
+      break;
+    case ControlPointChange::Type::kInsert:
+      num_old_segments_ = num_segments_ - 1;
+      break;
+    case ControlPointChange::Type::kRemove:
+      num_old_segments_ = num_segments_ + 1;
+      num_dirty_segments = 3;
+      break;
+  }
+  first_dirty_segment_ =
+      ((change_.index - 3) % num_segments_ + num_segments_) % num_segments_;
+  num_dirty_segments_ = std::min(num_dirty_segments, num_segments_);
+}
+
+int AffectedSegments::GetOldIndex(int index) const {
+  switch (change_.type) {
+    case ControlPointChange::Type::kUpdate:
+      return index;
+    case ControlPointChange::Type::kInsert:
+      return index < change_.index ? index : index - 1;
+    case ControlPointChange::Type::kRemove:
+      return index < change_.index ? index : index + 1;
+  }
+}
+
+OnSphereSmoothness::OnSphereSmoothness(float roughness)
+    : min_cosine_{ComputeMinCosine(roughness)} {}
+
+}  // namespace lighter::common::spline
@@ -0,0 +1,443 @@
+//
+//  spline_util.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_SPLINE_UTIL_H
+#define LIGHTER_COMMON_SPLINE_UTIL_H
+
+#include <array>
+#include <vector>
+
+#include "lighter/common/simd.h"
+#include "lighter/common/util.h"
+#include "third_party/absl/types/span.h"
+#include "third_party/glm/glm.hpp"
+
+namespace lighter::common::spline {
+
+// Control points of a cubic bezier segment.
+using BezierSegment = std::array<glm::vec3, 4>;
+
+// Converts 4 consecutive Catmull-Rom control points to control points of the
+// bezier segment that goes from 'p1' to 'p2'.
+BezierSegment ConvertCatmullRomToBezier(const glm::vec3& p0,
+                                        const glm::vec3& p1,
+                                        const glm::vec3& p2,
+                                        const glm::vec3& p3);
+
+// Describes a change of a single control point.
+struct ControlPointChange {
+  enum class Type { kUpdate, kInsert, kRemove };
+
+  Type type;
+
+  // Index of the control point that is updated, inserted or removed. For
+  // insertion, this is the index of the new control point after insertion.
+  // For removal, this is the index of the removed control point before removal.
+  int index;
+};
+
+// Describes which segments of a closed Catmull-Rom spline need to be rebuilt
+// after a control point change. Segment i is built from control points i to
+// i + 3 (wrapping around), hence each control point only affects 4 segments.
+// Segments that do not need to be rebuilt keep their relative order.
+class AffectedSegments {
+ public:
+  // 'num_control_points' is the number of control points after the change.
+  AffectedSegments(const ControlPointChange& change, int num_control_points);
+
+  // This class provides copy constructor and move constructor.
+  AffectedSegments(AffectedSegments&&) noexcept = default;
+  AffectedSegments(const AffectedSegments&) = default;
+
+  // Returns whether the segment at 'index' needs to be rebuilt. 'index' refers
+  // to the list of segments after the change.
+  bool IsDirty(int index) const {
+    return (index - first_dirty_segment_ + num_segments_) % num_segments_ <
+           num_dirty_segments_;
+  }
+
+  // Returns the index of segment before the change, for a segment at 'index'
+  // after the change that does not need to be rebuilt.
+  int GetOldIndex(int index) const;
+
+  // Accessors.
+  int num_old_segments() const { return num_old_segments_; }
+  int num_segments() const { return num_segments_; }
+  int first_dirty_segment() const { return first_dirty_segment_; }
+  int num_dirty_segments() const { return num_dirty_segments_; }
+
+ private:
+  // Control point change.
+  const ControlPointChange change_;
+
+  // Number of segments before and after the change.
+  int num_old_segments_;
+  const int num_segments_;
+
+  // Dirty segments start from 'first_dirty_segment_' and wrap around.
+  int first_dirty_segment_;
+  int num_dirty_segments_;
+};
+
+// Maintains prefix sums of non-negative values with a Fenwick tree, so that
+// setting a value and querying a prefix sum both take O(log n) time, where n is
+// the number of values. Each node is recomputed from its children instead of
+// being adjusted by the difference, hence prefix sums of floating point values
+// only depend on the current values, no matter how they were reached. Inserting
+// or erasing a value rebuilds the tree.
+template <typename T>
+class PrefixSumTree {
+ public:
+  // Replaces all values with 'values'.
+  void Reset(absl::Span<const T> values) {
+    values_.assign(values.begin(), values.end());
+    Rebuild();
+  }
+
+  // Sets the value at 'index'.
+  void Set(int index, T value) {
+    values_[index] = value;
+    for (int node = index + 1; node <= size(); node += node & -node) {
+      UpdateNode(node);
+    }
+  }
+
+  // Inserts 'value' before the value at 'index'. This takes O(n log n) time.
+  void Insert(int index, T value) {
+    values_.insert(values_.begin() + index, value);
+    Rebuild();
+  }
+
+  // Erases the value at 'index'. This takes O(n log n) time.
+  void Erase(int index) {
+    values_.erase(values_.begin() + index);
+    Rebuild();
+  }
+
+  // Returns the sum of the first 'count' values.
+  T GetPrefixSum(int count) const {
+    T sum{};
+    int node = 0;
+    for (int step = max_step_; step > 0; step >>= 1) {
+      if ((count & step) != 0) {
+        node += step;
+        sum += tree_[node];
+      }
+    }
+    return sum;
+  }
+
+  // Returns the largest 'count' such that GetPrefixSum(count) <= 'sum'. Nodes
+  // are accumulated in the same order as GetPrefixSum(), so the result is
+  // consistent with it.
+  int GetMaxCount(T sum) const {
+    int count = 0;
+    T prefix_sum{};
+    for (int step = max_step_; step > 0; step >>= 1) {
+      const int node = count + step;
+      if (node <= size() && prefix_sum + tree_[node] <= sum) {
+        count = node;
+        prefix_sum += tree_[node];
+      }
+    }
+    return count;
+  }
+
+  // Accessors.
+  int size() const { return static_cast<int>(values_.size()); }
+  T value(int index) const { return values_[index]; }
+
+ private:
+  // Recomputes the node at 'node' (1-based) from the value it ends with and its
+  // children, which must be up to date.
+  void UpdateNode(int node) {
+    T sum = values_[node - 1];
+    for (int step = 1; step < (node & -node); step <<= 1) {
+      sum += tree_[node - step];
+    }
+    tree_[node] = sum;
+  }
+
+  // Rebuilds all nodes from 'values_'.
+  void Rebuild() {
+    tree_.resize(size() + 1);
+    for (int node = 1; node <= size(); ++node) {
+      UpdateNode(node);
+    }
+    max_step_ = size() == 0 ? 0 : 1;
+    while (max_step_ * 2 <= size()) {
+      max_step_ *= 2;
+    }
+  }
+
+  // Values to sum up.
+  std::vector<T> values_;
+
+  // Node i (1-based) holds the sum of values in range [i - lowbit(i), i).
+  // Element 0 is not used.
+  std::vector<T> tree_;
+
+  // Largest power of 2 that is no larger than the number of values, or 0 if
+  // there is no value.
+  int max_step_ = 0;
+};
+
+// Returns the middle point of 2 points on a sphere centered at the origin.
+// This matches the policy used by CatmullRomSpline::GetOnSphereSpline().
+struct OnSphereMiddlePoint {
+  simd::Vec3 operator()(const simd::Vec3& p0, const simd::Vec3& p1) const {
+    return simd::Normalize(p0 + p1) * simd::Length(p0);
+  }
+};
+
+// Considers the bezier segment smooth if the angle between each pair of
+// adjacent edges of the control polygon is no larger than 'roughness'. Instead
+// of calling acos() per test, the angle test is done by comparing dot products
+// with a precomputed threshold, which gives exactly the same results as
+// comparing glm::angle() with 'roughness'.
+class OnSphereSmoothness {
+ public:
+  explicit OnSphereSmoothness(float roughness);
+
+  simd::Mask operator()(const simd::Vec3& p0, const simd::Vec3& p1,
+                        const simd::Vec3& p2, const simd::Vec3& p3) const {
+    const simd::Vec3 p0p1 = simd::Normalize(p0 - p1);
+    const simd::Vec3 p1p2 = simd::Normalize(p1 - p2);
+    const simd::Vec3 p2p3 = simd::Normalize(p2 - p3);
+    return (simd::Dot(p0p1, p1p2) >= min_cosine_) &
+           (simd::Dot(p1p2, p2p3) >= min_cosine_);
+  }
+
+ private:
+  // The smallest cosine value whose angle is no larger than roughness.
+  float min_cosine_;
+};
+
+// This class tessellates bezier segments the same way as
+// BezierSpline::Tessellate(), but without recursion or std::function:
+// - Each segment is subdivided using an explicit stack.
+// - 'MiddlePointPolicy' and 'SmoothnessPolicy' are template parameters, so that
+//   they can be inlined. They should be invocable with simd::Vec3, and
+//   'SmoothnessPolicy' should return simd::Mask.
+// - simd::kWidth segments are subdivided in lockstep, one per SIMD lane. When
+//   a lane finishes its segment, it picks up the next pending one.
+// Scratch buffers are kept across calls, hence tessellating the same amount of
+// data again will not allocate memory.
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+class BezierTessellator {
+ public:
+  // If the depth of subdivision reaches 'max_recursion_depth', or if
+  // 'smoothness_policy' returns true, the subdivision will stop.
+  BezierTessellator(int max_recursion_depth,
+                    MiddlePointPolicy middle_point_policy,
+                    SmoothnessPolicy smoothness_policy)
+      : max_recursion_depth_{max_recursion_depth},
+        middle_point_policy_{std::move(middle_point_policy)},
+        smoothness_policy_{std::move(smoothness_policy)} {}
+
+  // This class is neither copyable nor movable.
+  BezierTessellator(const BezierTessellator&) = delete;
+  BezierTessellator& operator=(const BezierTessellator&) = delete;
+
+  // Tessellates 'segments' and appends the first point of each piece to
+  // 'spline_points', in order of segments. If 'num_points_per_segment' is not
+  // empty, the number of points generated for each segment will be written to
+  // it, and its length must match with 'segments'.
+  void Tessellate(absl::Span<const BezierSegment> segments,
+                  std::vector<glm::vec3>& spline_points,
+                  absl::Span<int> num_points_per_segment = {});
+
+ private:
+  // Number of floats needed to hold 4 control points.
+  static constexpr int kNumFloats = 4 * 3;
+
+  // Number of middle points needed for building sub-pieces.
+  static constexpr int kNumStoredMiddlePoints = 5;
+
+  // A piece of bezier segment that is pending subdivision.
+  struct Piece {
+    BezierSegment points;
+    int depth;
+  };
+
+  // Records where points of a segment are stored.
+  struct SegmentRecord {
+    int lane;
+    int begin;
+    int end;
+  };
+
+  // Subdivides one piece per lane. 'active_bits' has bit i set if lane i holds
+  // a valid piece in 'pieces'.
+  void Subdivide(const std::array<Piece, simd::kWidth>& pieces,
+                 int active_bits);
+
+  // Maximum depth of subdivision.
+  const int max_recursion_depth_;
+
+  // Policies used for subdivision.
+  const MiddlePointPolicy middle_point_policy_;
+  const SmoothnessPolicy smoothness_policy_;
+
+  // Stacks of pending pieces, one per lane.
+  std::array<std::vector<Piece>, simd::kWidth> lane_stacks_;
+
+  // Spline points generated by each lane.
+  std::array<std::vector<glm::vec3>, simd::kWidth> lane_points_;
+
+  // Records of segments of the current call to Tessellate().
+  std::vector<SegmentRecord> segment_records_;
+
+  // Control points in structure-of-arrays layout. These are only used in
+  // Subdivide(), but kept as members to avoid reinitializing them.
+  alignas(32) float soa_[kNumFloats][simd::kWidth] = {};
+  alignas(32) float middle_soa_[kNumStoredMiddlePoints][3][simd::kWidth] = {};
+};
+
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+void BezierTessellator<MiddlePointPolicy, SmoothnessPolicy>::Tessellate(
+    absl::Span<const BezierSegment> segments,
+    std::vector<glm::vec3>& spline_points,
+    absl::Span<int> num_points_per_segment) {
+  ASSERT_TRUE(num_points_per_segment.empty() ||
+                  num_points_per_segment.size() == segments.size(),
+              "Length of 'num_points_per_segment' must match with segments");
+
+  const int num_segments = static_cast<int>(segments.size());
+  segment_records_.resize(num_segments);
+  for (int lane = 0; lane < simd::kWidth; ++lane) {
+    lane_stacks_[lane].clear();
+    lane_points_[lane].clear();
+  }
+
+  std::array<int, simd::kWidth> lane_segments;
+  lane_segments.fill(-1);
+  std::array<Piece, simd::kWidth> pieces;
+  int next_segment = 0;
+  while (true) {
+    int active_bits = 0;
+    for (int lane = 0; lane < simd::kWidth; ++lane) {
+      auto& stack = lane_stacks_[lane];
+      if (stack.empty()) {
+        // Close the segment that this lane has finished, and pick up the next.
+        if (lane_segments[lane] != -1) {
+          segment_records_[lane_segments[lane]].end =
+              static_cast<int>(lane_points_[lane].size());
+          lane_segments[lane] = -1;
+        }
+        if (next_segment == num_segments) {
+          continue;
+        }
+        lane_segments[lane] = next_segment;
+        segment_records_[next_segment] = {
+            lane, static_cast<int>(lane_points_[lane].size()), /*end=*/-1};
+        stack.push_back({segments[next_segment], /*depth=*/0});
+        ++next_segment;
+      }
+      pieces[lane] = stack.back();
+      stack.pop_back();
+      active_bits |= 1 << lane;
+    }
+    if (active_bits == 0) {
+      break;
+    }
+    Subdivide(pieces, active_bits);
+  }
+
+  int total_num_points = 0;
+  for (const auto& record : segment_records_) {
+    total_num_points += record.end - record.begin;
+  }
+  spline_points.reserve(spline_points.size() + total_num_points);
+  for (int i = 0; i < num_segments; ++i) {
+    const SegmentRecord& record = segment_records_[i];
+    const auto& points = lane_points_[record.lane];
+    spline_points.insert(spline_points.end(), points.begin() + record.begin,
+                         points.begin() + record.end);
+    if (!num_points_per_segment.empty()) {
+      num_points_per_segment[i] = record.end - record.begin;
+    }
+  }
+}
+
+template <typename MiddlePointPolicy, typename SmoothnessPolicy>
+void BezierTessellator<MiddlePointPolicy, SmoothnessPolicy>::Subdivide(
+    const std::array<Piece, simd::kWidth>& pieces, int active_bits) {
+  constexpr float kMinDistBetweenPoints = 1E-2;
+
+  // Transpose to the structure-of-arrays layout. Data of inactive lanes is
+  // stale, and results of those lanes will be ignored.
+  for (int lane = 0; lane < simd::kWidth; ++lane) {
+    if (active_bits & (1 << lane)) {
+      for (int p = 0; p < 4; ++p) {
+        for (int c = 0; c < 3; ++c) {
+          soa_[p * 3 + c][lane] = pieces[lane].points[p][c];
+        }
+      }
+    }
+  }
+  const auto load_point = [this](int p) {
+    return simd::Vec3{simd::Float::Load(soa_[p * 3 + 0]),
+                      simd::Float::Load(soa_[p * 3 + 1]),
+                      simd::Float::Load(soa_[p * 3 + 2])};
+  };
+  const simd::Vec3 p0 = load_point(0);
+  const simd::Vec3 p1 = load_point(1);
+  const simd::Vec3 p2 = load_point(2);
+  const simd::Vec3 p3 = load_point(3);
+
+  // Same as glm::distance(p0, p3) < kMinDistBetweenPoints.
+  const int stop_bits =
+      ((simd::Length(p3 - p0) < simd::Float{kMinDistBetweenPoints}) |
+       smoothness_policy_(p0, p1, p2, p3)).ToBits();
+
+  const simd::Vec3 p10 = middle_point_policy_(p0, p1);
+  const simd::Vec3 p11 = middle_point_policy_(p1, p2);
+  const simd::Vec3 p12 = middle_point_policy_(p2, p3);
+  const simd::Vec3 p20 = middle_point_policy_(p10, p11);
+  const simd::Vec3 p21 = middle_point_policy_(p11, p12);
+  const simd::Vec3 p30 = middle_point_policy_(p20, p21);
+  // 'p11' is only needed for computing other middle points.
+  const std::array<const simd::Vec3*, kNumStoredMiddlePoints> middle_points{
+      &p10, &p12, &p20, &p21, &p30};
+  for (int i = 0; i < kNumStoredMiddlePoints; ++i) {
+    middle_points[i]->x.Store(middle_soa_[i][0]);
+    middle_points[i]->y.Store(middle_soa_[i][1]);
+    middle_points[i]->z.Store(middle_soa_[i][2]);
+  }
+
+  for (int lane = 0; lane < simd::kWidth; ++lane) {
+    if (!(active_bits & (1 << lane))) {
+      continue;
+    }
+    const Piece& piece = pieces[lane];
+    const int depth = piece.depth + 1;
+    if (depth == max_recursion_depth_ || (stop_bits & (1 << lane))) {
+      lane_points_[lane].push_back(piece.points[0]);
+      continue;
+    }
+
+    const auto get_middle_point = [this, lane](int index) {
+      return glm::vec3{middle_soa_[index][0][lane],
+                       middle_soa_[index][1][lane],
+                       middle_soa_[index][2][lane]};
+    };
+    const glm::vec3 m10 = get_middle_point(0);
+    const glm::vec3 m12 = get_middle_point(1);
+    const glm::vec3 m20 = get_middle_point(2);
+    const glm::vec3 m21 = get_middle_point(3);
+    const glm::vec3 m30 = get_middle_point(4);
+    // Push the second half first, so that the first half is processed first.
+    auto& stack = lane_stacks_[lane];
+    stack.push_back({{m30, m21, m12, piece.points[3]}, depth});
+    stack.push_back({{piece.points[0], m10, m20, m30}, depth});
+  }
+}
+
+}  // namespace lighter::common::spline
+
+#endif  // LIGHTER_COMMON_SPLINE_UTIL_H
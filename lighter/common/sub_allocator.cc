@@ -0,0 +1,381 @@
+//
+//  sub_allocator.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/sub_allocator.h"
+
+#include <algorithm>
+
+#include "lighter/common/util.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+namespace lighter::common {
+namespace {
+
+// Returns the index of the most significant set bit. 'value' must be non-zero.
+inline int FindLastSet(uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(value);
+#endif  // _MSC_VER
+}
+
+// Returns the index of the least significant set bit. 'value' must be
+// non-zero.
+inline int FindFirstSet(uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(value);
+#endif  // _MSC_VER
+}
+
+// Rounds 'value' up to a multiple of 'alignment', which is a power of two.
+inline uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+TlsfAllocator::TlsfAllocator(uint64_t block_size) : block_size_{block_size} {
+  ASSERT_TRUE(block_size > 0, "Block size must be positive");
+  for (auto& lists : free_lists_) {
+    lists.fill(kNullNode);
+  }
+  InsertFreeNode(CreateNode(/*offset=*/0, block_size_));
+}
+
+std::optional<TlsfAllocator::Range> TlsfAllocator::Allocate(
+    uint64_t size, uint64_t alignment) {
+  ASSERT_TRUE(alignment > 0 && (alignment & (alignment - 1)) == 0,
+              absl::StrFormat("Alignment must be a power of two, while %d "
+                              "provided", alignment));
+  size = std::max<uint64_t>(size, 1);
+  if (size > block_size_) {
+    return std::nullopt;
+  }
+
+  // The first range found may not be able to hold 'size' bytes after aligning
+  // the offset. In that case, search again with the worst case padding.
+  const auto fits = [this, size, alignment](uint32_t node) {
+    const Node& range = nodes_[node];
+    return AlignUp(range.offset, alignment) + size <= range.offset + range.size;
+  };
+  uint32_t node = FindFreeNode(size);
+  if (node == kNullNode || !fits(node)) {
+    if (alignment > 1 && size <= block_size_ - (alignment - 1)) {
+      node = FindFreeNode(size + alignment - 1);
+    } else {
+      node = kNullNode;
+    }
+  }
+  if (node == kNullNode) {
+    // Lists searched above only contain ranges that are large enough, while
+    // the list that 'size' maps to may still have some range that fits.
+    const ListIndex index = GetListIndex(size);
+    for (uint32_t candidate = free_lists_[index.first_level]
+                                         [index.second_level];
+         candidate != kNullNode; candidate = nodes_[candidate].next_free) {
+      if (fits(candidate)) {
+        node = candidate;
+        break;
+      }
+    }
+  }
+  if (node == kNullNode) {
+    return std::nullopt;
+  }
+  RemoveFreeNode(node);
+
+  // Split the leading padding into a free range. The range physically before
+  // 'node' must be in use, otherwise they would have been merged.
+  const uint64_t aligned_offset = AlignUp(nodes_[node].offset, alignment);
+  const uint64_t padding = aligned_offset - nodes_[node].offset;
+  if (padding > 0) {
+    const uint32_t front = CreateNode(nodes_[node].offset, padding);
+    nodes_[front].prev_physical = nodes_[node].prev_physical;
+    nodes_[front].next_physical = node;
+    if (nodes_[front].prev_physical != kNullNode) {
+      nodes_[nodes_[front].prev_physical].next_physical = front;
+    }
+    nodes_[node].prev_physical = front;
+    nodes_[node].offset = aligned_offset;
+    nodes_[node].size -= padding;
+    InsertFreeNode(front);
+  }
+  SplitTail(node, nodes_[node].size - size);
+
+  nodes_[node].is_free = false;
+  bytes_in_use_ += size;
+  ++num_allocations_;
+  return Range{node, aligned_offset};
+}
+
+void TlsfAllocator::Free(Handle handle) {
+  ASSERT_TRUE(handle < nodes_.size() && !nodes_[handle].is_free,
+              absl::StrFormat("Invalid handle %d", handle));
+  bytes_in_use_ -= nodes_[handle].size;
+  --num_allocations_;
+  nodes_[handle].is_free = true;
+
+  uint32_t node = handle;
+  const uint32_t next = nodes_[node].next_physical;
+  if (next != kNullNode && nodes_[next].is_free) {
+    RemoveFreeNode(next);
+    MergeWithNext(node, next);
+  }
+  const uint32_t prev = nodes_[node].prev_physical;
+  if (prev != kNullNode && nodes_[prev].is_free) {
+    RemoveFreeNode(prev);
+    MergeWithNext(prev, node);
+    node = prev;
+  }
+  InsertFreeNode(node);
+}
+
+uint64_t TlsfAllocator::GetLargestFreeRangeSize() const {
+  if (first_level_bitmap_ == 0) {
+    return 0;
+  }
+  const int first_level = FindLastSet(first_level_bitmap_);
+  const int second_level = FindLastSet(second_level_bitmaps_[first_level]);
+  uint64_t largest_size = 0;
+  for (uint32_t node = free_lists_[first_level][second_level];
+       node != kNullNode; node = nodes_[node].next_free) {
+    largest_size = std::max(largest_size, nodes_[node].size);
+  }
+  return largest_size;
+}
+
+TlsfAllocator::ListIndex TlsfAllocator::GetListIndex(uint64_t size) {
+  if (size < kSmallSize) {
+    return {/*first_level=*/0, /*second_level=*/static_cast<int>(size)};
+  }
+  const int last_set = FindLastSet(size);
+  return {
+      /*first_level=*/last_set - kSecondLevelBits + 1,
+      /*second_level=*/static_cast<int>(
+          (size >> (last_set - kSecondLevelBits)) - kNumSecondLevels),
+  };
+}
+
+uint32_t TlsfAllocator::CreateNode(uint64_t offset, uint64_t size) {
+  const Node node{offset, size, /*is_free=*/true, kNullNode, kNullNode,
+                  kNullNode, kNullNode};
+  if (!recycled_nodes_.empty()) {
+    const uint32_t index = recycled_nodes_.back();
+    recycled_nodes_.pop_back();
+    nodes_[index] = node;
+    return index;
+  }
+  nodes_.push_back(node);
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TlsfAllocator::InsertFreeNode(uint32_t node) {
+  const ListIndex index = GetListIndex(nodes_[node].size);
+  uint32_t& head = free_lists_[index.first_level][index.second_level];
+  nodes_[node].prev_free = kNullNode;
+  nodes_[node].next_free = head;
+  if (head != kNullNode) {
+    nodes_[head].prev_free = node;
+  }
+  head = node;
+  first_level_bitmap_ |= uint64_t{1} << index.first_level;
+  second_level_bitmaps_[index.first_level] |= 1U << index.second_level;
+}
+
+void TlsfAllocator::RemoveFreeNode(uint32_t node) {
+  const Node& range = nodes_[node];
+  if (range.next_free != kNullNode) {
+    nodes_[range.next_free].prev_free = range.prev_free;
+  }
+  if (range.prev_free != kNullNode) {
+    nodes_[range.prev_free].next_free = range.next_free;
+    return;
+  }
+
+  // 'node' is the head of its list.
+  const ListIndex index = GetListIndex(range.size);
+  uint32_t& head = free_lists_[index.first_level][index.second_level];
+  head = range.next_free;
+  if (head == kNullNode) {
+    uint32_t& second_level_bitmap = second_level_bitmaps_[index.first_level];
+    second_level_bitmap &= ~(1U << index.second_level);
+    if (second_level_bitmap == 0) {
+      first_level_bitmap_ &= ~(uint64_t{1} << index.first_level);
+    }
+  }
+}
+
+uint32_t TlsfAllocator::FindFreeNode(uint64_t size) const {
+  // Round up 'size' to the next list boundary, so that any range in the list
+  // found is large enough.
+  if (size >= kSmallSize) {
+    const uint64_t round_up =
+        (uint64_t{1} << (FindLastSet(size) - kSecondLevelBits)) - 1;
+    if (size > UINT64_MAX - round_up) {
+      return kNullNode;
+    }
+    size += round_up;
+  }
+  ListIndex index = GetListIndex(size);
+
+  uint32_t second_level_bitmap = second_level_bitmaps_[index.first_level] &
+                                 (~0U << index.second_level);
+  if (second_level_bitmap == 0) {
+    if (index.first_level + 1 >= kNumFirstLevels) {
+      return kNullNode;
+    }
+    const uint64_t first_level_bitmap =
+        first_level_bitmap_ & (~uint64_t{0} << (index.first_level + 1));
+    if (first_level_bitmap == 0) {
+      return kNullNode;
+    }
+    index.first_level = FindFirstSet(first_level_bitmap);
+    second_level_bitmap = second_level_bitmaps_[index.first_level];
+  }
+  index.second_level = FindFirstSet(second_level_bitmap);
+  return free_lists_[index.first_level][index.second_level];
+}
+
+void TlsfAllocator::SplitTail(uint32_t node, uint64_t size) {
+  if (size == 0) {
+    return;
+  }
+  nodes_[node].size -= size;
+  const uint32_t tail =
+      CreateNode(nodes_[node].offset + nodes_[node].size, size);
+  nodes_[tail].prev_physical = node;
+  nodes_[tail].next_physical = nodes_[node].next_physical;
+  if (nodes_[tail].next_physical != kNullNode) {
+    nodes_[nodes_[tail].next_physical].prev_physical = tail;
+  }
+  nodes_[node].next_physical = tail;
+  InsertFreeNode(tail);
+}
+
+void TlsfAllocator::MergeWithNext(uint32_t node, uint32_t next) {
+  nodes_[node].size += nodes_[next].size;
+  nodes_[node].next_physical = nodes_[next].next_physical;
+  if (nodes_[node].next_physical != kNullNode) {
+    nodes_[nodes_[node].next_physical].prev_physical = node;
+  }
+  recycled_nodes_.push_back(next);
+}
+
+BlockSubAllocator::BlockSubAllocator(uint64_t default_block_size,
+                                     CreateBlock&& create_block,
+                                     DestroyBlock&& destroy_block)
+    : default_block_size_{default_block_size},
+      create_block_{std::move(create_block)},
+      destroy_block_{std::move(destroy_block)} {
+  ASSERT_TRUE(default_block_size_ > 0, "Block size must be positive");
+}
+
+BlockSubAllocator::~BlockSubAllocator() {
+  for (int i = 0; i < blocks_.size(); ++i) {
+    if (blocks_[i] != nullptr) {
+      destroy_block_(i);
+    }
+  }
+}
+
+BlockSubAllocator::Allocation BlockSubAllocator::Allocate(uint64_t size,
+                                                          uint64_t alignment) {
+  // Sizes larger than the default block size always get a dedicated block.
+  if (size <= default_block_size_) {
+    for (int i = 0; i < blocks_.size(); ++i) {
+      if (blocks_[i] == nullptr ||
+          blocks_[i]->block_size() - blocks_[i]->bytes_in_use() < size) {
+        continue;
+      }
+      if (const auto range = blocks_[i]->Allocate(size, alignment);
+          range.has_value()) {
+        return Allocation{i, range->handle, range->offset};
+      }
+    }
+  }
+
+  // Offset 0 satisfies any alignment, so allocating from a new block would
+  // never fail.
+  const int block_index = AddBlock(std::max(size, default_block_size_));
+  const auto range = blocks_[block_index]->Allocate(size, alignment);
+  ASSERT_HAS_VALUE(range, "Failed to allocate from new block");
+  return Allocation{block_index, range->handle, range->offset};
+}
+
+void BlockSubAllocator::Free(const Allocation& allocation) {
+  ASSERT_TRUE(allocation.block_index < blocks_.size() &&
+                  blocks_[allocation.block_index] != nullptr,
+              absl::StrFormat("Invalid block index %d",
+                              allocation.block_index));
+  TlsfAllocator& block = *blocks_[allocation.block_index];
+  block.Free(allocation.handle);
+  if (!block.empty()) {
+    return;
+  }
+
+  bool should_destroy = block.block_size() != default_block_size_;
+  if (!should_destroy) {
+    for (int i = 0; i < blocks_.size(); ++i) {
+      if (i != allocation.block_index && blocks_[i] != nullptr &&
+          blocks_[i]->empty() &&
+          blocks_[i]->block_size() == default_block_size_) {
+        should_destroy = true;
+        break;
+      }
+    }
+  }
+  if (should_destroy) {
+    destroy_block_(allocation.block_index);
+    blocks_[allocation.block_index].reset();
+  }
+}
+
+BlockSubAllocator::Stats BlockSubAllocator::GetStats() const {
+  Stats stats;
+  for (const auto& block : blocks_) {
+    if (block == nullptr) {
+      continue;
+    }
+    ++stats.num_blocks;
+    stats.num_allocations += block->num_allocations();
+    stats.bytes_reserved += block->block_size();
+    stats.bytes_in_use += block->bytes_in_use();
+    stats.largest_free_range = std::max(stats.largest_free_range,
+                                        block->GetLargestFreeRangeSize());
+  }
+  const uint64_t bytes_free = stats.bytes_reserved - stats.bytes_in_use;
+  if (bytes_free > 0) {
+    stats.fragmentation =
+        1.0f - static_cast<float>(stats.largest_free_range) / bytes_free;
+  }
+  return stats;
+}
+
+int BlockSubAllocator::AddBlock(uint64_t block_size) {
+  int block_index = 0;
+  while (block_index < blocks_.size() && blocks_[block_index] != nullptr) {
+    ++block_index;
+  }
+  if (block_index == blocks_.size()) {
+    blocks_.emplace_back();
+  }
+  blocks_[block_index] = std::make_unique<TlsfAllocator>(block_size);
+  create_block_(block_index, block_size);
+  return block_index;
+}
+
+}  // namespace lighter::common
@@ -0,0 +1,231 @@
+//
+//  sub_allocator.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_SUB_ALLOCATOR_H
+#define LIGHTER_COMMON_SUB_ALLOCATOR_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace lighter::common {
+
+// This class manages ranges within one block of 'block_size' bytes with the
+// two-level segregated fit (TLSF) algorithm. It never touches the memory it
+// manages, and only deals with offsets, hence it can manage any kind of memory,
+// such as device memory that is not visible to the host.
+// Both allocation and deallocation take constant time. Free ranges are kept in
+// segregated lists, indexed by the position of the highest set bit of the size
+// (first level) and the next few bits (second level). Free ranges that are
+// adjacent to each other are always merged.
+class TlsfAllocator {
+ public:
+  // Identifies an allocated range.
+  using Handle = uint32_t;
+
+  // Allocated range.
+  struct Range {
+    Handle handle;
+    uint64_t offset;
+  };
+
+  explicit TlsfAllocator(uint64_t block_size);
+
+  // This class is neither copyable nor movable.
+  TlsfAllocator(const TlsfAllocator&) = delete;
+  TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+  // Allocates a range of 'size' bytes, whose offset is a multiple of
+  // 'alignment'. 'alignment' must be a power of two. Returns std::nullopt if
+  // there is no free range large enough.
+  std::optional<Range> Allocate(uint64_t size, uint64_t alignment);
+
+  // Frees the range identified by 'handle'.
+  void Free(Handle handle);
+
+  // Returns the size of the largest free range.
+  uint64_t GetLargestFreeRangeSize() const;
+
+  // Accessors.
+  uint64_t block_size() const { return block_size_; }
+  uint64_t bytes_in_use() const { return bytes_in_use_; }
+  int num_allocations() const { return num_allocations_; }
+  bool empty() const { return num_allocations_ == 0; }
+
+ private:
+  // Number of bits used for the second level index.
+  static constexpr int kSecondLevelBits = 4;
+  static constexpr int kNumSecondLevels = 1 << kSecondLevelBits;
+
+  // Sizes smaller than this are all put in the first level 0.
+  static constexpr uint64_t kSmallSize = kNumSecondLevels;
+
+  // Enough for any 64-bit size.
+  static constexpr int kNumFirstLevels = 64 - kSecondLevelBits + 1;
+
+  // Indicates the absence of a node.
+  static constexpr uint32_t kNullNode = UINT32_MAX;
+
+  // Free or allocated range. Ranges are kept in a doubly linked list in the
+  // order of offsets, and free ranges are also linked to ranges in the same
+  // segregated list.
+  struct Node {
+    uint64_t offset;
+    uint64_t size;
+    bool is_free;
+    uint32_t prev_physical;
+    uint32_t next_physical;
+    uint32_t prev_free;
+    uint32_t next_free;
+  };
+
+  // Index of a segregated list.
+  struct ListIndex {
+    int first_level;
+    int second_level;
+  };
+
+  // Returns the index of the list that a free range of 'size' belongs to.
+  static ListIndex GetListIndex(uint64_t size);
+
+  // Returns a node that is not linked to any list, reusing a recycled one if
+  // possible.
+  uint32_t CreateNode(uint64_t offset, uint64_t size);
+
+  // Inserts the free range 'node' to the corresponding segregated list.
+  void InsertFreeNode(uint32_t node);
+
+  // Removes the free range 'node' from its segregated list.
+  void RemoveFreeNode(uint32_t node);
+
+  // Returns the first node in the first non-empty list, whose ranges are all
+  // no less than 'size'. Returns kNullNode if there is no such list.
+  uint32_t FindFreeNode(uint64_t size) const;
+
+  // Splits the trailing 'size' bytes of 'node' into a new free range if 'size'
+  // is positive.
+  void SplitTail(uint32_t node, uint64_t size);
+
+  // Merges 'node' with 'next', which must be physically after it. 'next' is
+  // recycled.
+  void MergeWithNext(uint32_t node, uint32_t next);
+
+  // Total size of the block.
+  const uint64_t block_size_;
+
+  // Number of bytes in allocated ranges.
+  uint64_t bytes_in_use_ = 0;
+
+  // Number of allocated ranges.
+  int num_allocations_ = 0;
+
+  // Storage of all nodes. Handles are indices into this.
+  std::vector<Node> nodes_;
+
+  // Indices of nodes that can be reused.
+  std::vector<uint32_t> recycled_nodes_;
+
+  // Bit i is set if any list on first level i is non-empty.
+  uint64_t first_level_bitmap_ = 0;
+
+  // Bit j of element i is set if list (i, j) is non-empty.
+  std::array<uint32_t, kNumFirstLevels> second_level_bitmaps_{};
+
+  // Heads of segregated lists.
+  std::array<std::array<uint32_t, kNumSecondLevels>, kNumFirstLevels>
+      free_lists_;
+};
+
+// This class manages a pool of blocks, and sub-allocates ranges from them with
+// TlsfAllocator. The actual memory of blocks is owned by the user, who is
+// notified whenever a block should be created or destroyed. Blocks are
+// identified by indices, which may be reused after a block is destroyed.
+// If a requested size is larger than the default block size, a dedicated block
+// of that size will be created.
+// This class is not thread-safe.
+class BlockSubAllocator {
+ public:
+  // Called when a block at 'block_index' with 'block_size' bytes should be
+  // created.
+  using CreateBlock = std::function<void(int block_index, uint64_t block_size)>;
+
+  // Called when the block at 'block_index' should be destroyed.
+  using DestroyBlock = std::function<void(int block_index)>;
+
+  // Allocated range.
+  struct Allocation {
+    int block_index;
+    TlsfAllocator::Handle handle;
+    uint64_t offset;
+  };
+
+  // Statistics of the pool.
+  struct Stats {
+    // Number of blocks that have been created and not yet destroyed.
+    int num_blocks = 0;
+
+    // Number of allocated ranges.
+    int num_allocations = 0;
+
+    // Total size of all blocks.
+    uint64_t bytes_reserved = 0;
+
+    // Total size of allocated ranges.
+    uint64_t bytes_in_use = 0;
+
+    // Size of the largest free range among all blocks.
+    uint64_t largest_free_range = 0;
+
+    // Ratio between free bytes that can not be used for the largest possible
+    // allocation and all free bytes, in range [0, 1]. 0 means all free bytes
+    // are contiguous.
+    float fragmentation = 0.0f;
+  };
+
+  BlockSubAllocator(uint64_t default_block_size,
+                    CreateBlock&& create_block, DestroyBlock&& destroy_block);
+
+  // This class is neither copyable nor movable.
+  BlockSubAllocator(const BlockSubAllocator&) = delete;
+  BlockSubAllocator& operator=(const BlockSubAllocator&) = delete;
+
+  // Destroys all remaining blocks.
+  ~BlockSubAllocator();
+
+  // Allocates a range of 'size' bytes, whose offset is a multiple of
+  // 'alignment'. 'alignment' must be a power of two. A new block is created if
+  // no existing block can hold it.
+  Allocation Allocate(uint64_t size, uint64_t alignment);
+
+  // Frees 'allocation'. If the block becomes empty, it is destroyed unless it
+  // is the only empty block of default size, which is kept for reuse.
+  void Free(const Allocation& allocation);
+
+  // Returns statistics of the pool.
+  Stats GetStats() const;
+
+ private:
+  // Returns the index of a new block of 'block_size' bytes.
+  int AddBlock(uint64_t block_size);
+
+  // Default size of blocks.
+  const uint64_t default_block_size_;
+
+  // Notifies the user of block creation and destruction.
+  const CreateBlock create_block_;
+  const DestroyBlock destroy_block_;
+
+  // Blocks indexed by block index. Destroyed blocks are set to nullptr.
+  std::vector<std::unique_ptr<TlsfAllocator>> blocks_;
+};
+
+}  // namespace lighter::common
+
+#endif  // LIGHTER_COMMON_SUB_ALLOCATOR_H
@@ -0,0 +1,90 @@
+//
+//  sub_allocator_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/common/sub_allocator.h"
+
+namespace lighter::common {
+namespace {
+
+// Same as the default block size of device memory.
+constexpr uint64_t kBlockSize = uint64_t{64} << 20;
+
+// Sizes and alignments of allocations, similar to those of vertex buffers,
+// uniform buffers and textures.
+struct Request {
+  uint64_t size;
+  uint64_t alignment;
+};
+
+std::vector<Request> GenerateRequests(int num_requests) {
+  std::mt19937 generator{0};
+  std::vector<Request> requests(num_requests);
+  for (auto& request : requests) {
+    request.size = 256 + generator() % (1 << 20);
+    request.alignment = uint64_t{1} << (8 + generator() % 9);
+  }
+  return requests;
+}
+
+// Allocates and then frees all allocations in the order of allocation.
+void BM_AllocateAndFree(benchmark::State& state) {
+  const auto requests = GenerateRequests(state.range(0));
+  std::vector<BlockSubAllocator::Allocation> allocations;
+  allocations.reserve(requests.size());
+  BlockSubAllocator allocator{kBlockSize, [](int, uint64_t) {}, [](int) {}};
+  for (auto _ : state) {
+    for (const auto& request : requests) {
+      allocations.push_back(
+          allocator.Allocate(request.size, request.alignment));
+    }
+    for (const auto& allocation : allocations) {
+      allocator.Free(allocation);
+    }
+    allocations.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_AllocateAndFree)->Arg(1 << 6)->Arg(1 << 10)->Arg(1 << 14);
+
+// Keeps a number of live allocations, and randomly frees one and allocates
+// another, which is the typical pattern when resources are streamed.
+void BM_RandomReplacement(benchmark::State& state) {
+  const int num_live_allocations = state.range(0);
+  const auto requests = GenerateRequests(num_live_allocations * 2);
+  BlockSubAllocator allocator{kBlockSize, [](int, uint64_t) {}, [](int) {}};
+  std::vector<BlockSubAllocator::Allocation> allocations;
+  for (int i = 0; i < num_live_allocations; ++i) {
+    allocations.push_back(
+        allocator.Allocate(requests[i].size, requests[i].alignment));
+  }
+
+  std::mt19937 generator{0};
+  int request_index = 0;
+  for (auto _ : state) {
+    const int index = generator() % num_live_allocations;
+    allocator.Free(allocations[index]);
+    const auto& request = requests[request_index];
+    allocations[index] = allocator.Allocate(request.size, request.alignment);
+    request_index = (request_index + 1) % requests.size();
+  }
+
+  const auto stats = allocator.GetStats();
+  state.counters["blocks"] = stats.num_blocks;
+  state.counters["fragmentation"] = stats.fragmentation;
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomReplacement)->Arg(1 << 6)->Arg(1 << 10)->Arg(1 << 14);
+
+}  // namespace
+}  // namespace lighter::common
+
+BENCHMARK_MAIN();
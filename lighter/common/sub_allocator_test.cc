@@ -0,0 +1,170 @@
+//
+//  sub_allocator_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/sub_allocator.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lighter::common {
+namespace {
+
+// Expects no pair of ranges in 'ranges' overlaps. Keys are offsets, and values
+// are sizes.
+void ExpectNoOverlap(const std::map<uint64_t, uint64_t>& ranges) {
+  uint64_t end = 0;
+  for (const auto& [offset, size] : ranges) {
+    EXPECT_GE(offset, end) << "at offset " << offset;
+    end = offset + size;
+  }
+}
+
+TEST(TlsfAllocatorTest, AllocateAndFree) {
+  TlsfAllocator allocator{/*block_size=*/1024};
+  const auto first = allocator.Allocate(/*size=*/100, /*alignment=*/1);
+  const auto second = allocator.Allocate(/*size=*/200, /*alignment=*/1);
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(first->offset, 0);
+  EXPECT_EQ(second->offset, 100);
+  EXPECT_EQ(allocator.bytes_in_use(), 300);
+  EXPECT_EQ(allocator.num_allocations(), 2);
+  EXPECT_EQ(allocator.GetLargestFreeRangeSize(), 724);
+
+  allocator.Free(first->handle);
+  EXPECT_EQ(allocator.bytes_in_use(), 200);
+  EXPECT_EQ(allocator.GetLargestFreeRangeSize(), 724);
+
+  // Free ranges should be merged.
+  allocator.Free(second->handle);
+  EXPECT_TRUE(allocator.empty());
+  EXPECT_EQ(allocator.GetLargestFreeRangeSize(), 1024);
+  const auto whole = allocator.Allocate(/*size=*/1024, /*alignment=*/1);
+  ASSERT_TRUE(whole.has_value());
+  EXPECT_EQ(whole->offset, 0);
+  EXPECT_FALSE(allocator.Allocate(/*size=*/1, /*alignment=*/1).has_value());
+}
+
+TEST(TlsfAllocatorTest, Alignment) {
+  TlsfAllocator allocator{/*block_size=*/4096};
+  ASSERT_TRUE(allocator.Allocate(/*size=*/3, /*alignment=*/1).has_value());
+  const auto aligned = allocator.Allocate(/*size=*/256, /*alignment=*/256);
+  ASSERT_TRUE(aligned.has_value());
+  EXPECT_EQ(aligned->offset, 256);
+
+  // The padding before 'aligned' should still be usable.
+  const auto padding = allocator.Allocate(/*size=*/200, /*alignment=*/4);
+  ASSERT_TRUE(padding.has_value());
+  EXPECT_EQ(padding->offset, 4);
+
+  EXPECT_FALSE(allocator.Allocate(/*size=*/4096, /*alignment=*/1).has_value());
+  EXPECT_THROW(allocator.Allocate(/*size=*/1, /*alignment=*/3),
+               std::runtime_error);
+}
+
+TEST(TlsfAllocatorTest, RandomOperations) {
+  constexpr uint64_t kBlockSize = 1 << 20;
+  TlsfAllocator allocator{kBlockSize};
+  std::mt19937 generator{0};
+  std::map<uint64_t, uint64_t> ranges;
+  std::vector<std::pair<TlsfAllocator::Range, uint64_t>> allocations;
+  uint64_t bytes_in_use = 0;
+
+  for (int step = 0; step < 20000; ++step) {
+    if (allocations.empty() || generator() % 5 < 3) {
+      const uint64_t size = 1 + generator() % 4096;
+      const uint64_t alignment = uint64_t{1} << (generator() % 9);
+      const auto range = allocator.Allocate(size, alignment);
+      if (!range.has_value()) {
+        continue;
+      }
+      EXPECT_EQ(range->offset % alignment, 0);
+      EXPECT_LE(range->offset + size, kBlockSize);
+      ranges[range->offset] = size;
+      allocations.push_back({range.value(), size});
+      bytes_in_use += size;
+    } else {
+      const int index = generator() % allocations.size();
+      const auto [range, size] = allocations[index];
+      allocator.Free(range.handle);
+      ranges.erase(range.offset);
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+      bytes_in_use -= size;
+    }
+    ASSERT_EQ(allocator.bytes_in_use(), bytes_in_use) << "at step " << step;
+  }
+  ExpectNoOverlap(ranges);
+
+  for (const auto& [range, size] : allocations) {
+    allocator.Free(range.handle);
+  }
+  EXPECT_TRUE(allocator.empty());
+  EXPECT_EQ(allocator.GetLargestFreeRangeSize(), kBlockSize);
+}
+
+TEST(BlockSubAllocatorTest, CreateAndDestroyBlocks) {
+  constexpr uint64_t kBlockSize = 1024;
+  std::map<int, uint64_t> blocks;
+  {
+    BlockSubAllocator allocator{
+        kBlockSize,
+        [&blocks](int block_index, uint64_t block_size) {
+          EXPECT_EQ(blocks.count(block_index), 0);
+          blocks[block_index] = block_size;
+        },
+        [&blocks](int block_index) {
+          EXPECT_EQ(blocks.erase(block_index), 1);
+        },
+    };
+
+    const auto first = allocator.Allocate(/*size=*/800, /*alignment=*/1);
+    const auto second = allocator.Allocate(/*size=*/800, /*alignment=*/1);
+    EXPECT_NE(first.block_index, second.block_index);
+    EXPECT_EQ(blocks.size(), 2);
+
+    // Large allocations get dedicated blocks.
+    const auto large = allocator.Allocate(/*size=*/4000, /*alignment=*/256);
+    EXPECT_EQ(large.offset, 0);
+    EXPECT_EQ(blocks.at(large.block_index), 4000);
+
+    auto stats = allocator.GetStats();
+    EXPECT_EQ(stats.num_blocks, 3);
+    EXPECT_EQ(stats.num_allocations, 3);
+    EXPECT_EQ(stats.bytes_reserved, kBlockSize * 2 + 4000);
+    EXPECT_EQ(stats.bytes_in_use, 800 * 2 + 4000);
+    EXPECT_EQ(stats.largest_free_range, 224);
+    EXPECT_FLOAT_EQ(stats.fragmentation, 0.5f);
+
+    // Dedicated blocks are destroyed once freed, and one empty block of default
+    // size is kept.
+    allocator.Free(large);
+    EXPECT_EQ(blocks.size(), 2);
+    allocator.Free(first);
+    EXPECT_EQ(blocks.size(), 2);
+    allocator.Free(second);
+    EXPECT_EQ(blocks.size(), 1);
+    stats = allocator.GetStats();
+    EXPECT_EQ(stats.num_blocks, 1);
+    EXPECT_EQ(stats.bytes_in_use, 0);
+    EXPECT_FLOAT_EQ(stats.fragmentation, 0.0f);
+
+    // The remaining block should be reused.
+    const auto reused = allocator.Allocate(/*size=*/1024, /*alignment=*/1);
+    EXPECT_EQ(blocks.size(), 1);
+    EXPECT_EQ(blocks.count(reused.block_index), 1);
+  }
+  EXPECT_TRUE(blocks.empty());
+}
+
+}  // namespace
+}  // namespace lighter::common
@@ -0,0 +1,173 @@
+//
+//  thread_pool.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/common/thread_pool.h"
+
+#include <algorithm>
+
+namespace lighter::common {
+namespace {
+
+// Identifies the pool and worker that the current thread belongs to.
+struct WorkerIdentity {
+  const ThreadPool* pool = nullptr;
+  int worker_index = 0;
+};
+
+thread_local WorkerIdentity current_worker;
+
+// Shared by the calling thread and helper tasks of ParallelFor(). Helper tasks
+// may outlive the call, hence this is reference counted.
+struct ParallelForState {
+  explicit ParallelForState(int num_tasks) : num_tasks{num_tasks} {}
+
+  // Runs tasks until all indices have been claimed.
+  void RunTasks(absl::FunctionRef<void(int)> task) {
+    while (true) {
+      const int index = next_index.fetch_add(1);
+      if (index >= num_tasks) {
+        return;
+      }
+      task(index);
+      if (num_done_tasks.fetch_add(1) + 1 == num_tasks) {
+        const std::lock_guard<std::mutex> lock{mutex};
+        done_cv.notify_all();
+      }
+    }
+  }
+
+  const int num_tasks;
+  std::atomic<int> next_index{0};
+  std::atomic<int> num_done_tasks{0};
+  std::mutex mutex;
+  std::condition_variable done_cv;
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  queues_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::RunWorker, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::lock_guard<std::mutex> lock{sleep_mutex_};
+    should_quit_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()>&& task) {
+  const std::optional<int> worker_index = GetCurrentWorkerIndex();
+  const int queue_index =
+      worker_index.has_value()
+          ? worker_index.value()
+          : static_cast<int>(next_queue_index_.fetch_add(1) % queues_.size());
+  // Increment the counter first so that it never goes negative.
+  ++num_pending_tasks_;
+  {
+    TaskQueue& queue = *queues_[queue_index];
+    const std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    // Hold the lock so that the notification cannot fall between a worker
+    // checking the predicate and going to sleep.
+    const std::lock_guard<std::mutex> lock{sleep_mutex_};
+  }
+  sleep_cv_.notify_one();
+}
+
+void ThreadPool::ParallelFor(int num_tasks, absl::FunctionRef<void(int)> task) {
+  if (num_tasks <= 0) {
+    return;
+  }
+
+  // 'task' is only called after claiming an index, which means this function
+  // has not returned yet, hence it is safe for helpers to refer to it.
+  const auto state = std::make_shared<ParallelForState>(num_tasks);
+  const int num_helpers = std::min(num_threads(), num_tasks - 1);
+  for (int i = 0; i < num_helpers; ++i) {
+    Schedule([state, task]() { state->RunTasks(task); });
+  }
+  state->RunTasks(task);
+
+  std::unique_lock<std::mutex> lock{state->mutex};
+  state->done_cv.wait(lock, [&state]() {
+    return state->num_done_tasks.load() == state->num_tasks;
+  });
+}
+
+std::optional<std::function<void()>> ThreadPool::PopTask(int worker_index) {
+  const int num_queues = static_cast<int>(queues_.size());
+  for (int i = 0; i < num_queues; ++i) {
+    const bool is_own_queue = i == 0;
+    TaskQueue& queue = *queues_[(worker_index + i) % num_queues];
+    const std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    std::function<void()> task;
+    if (is_own_queue) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    --num_pending_tasks_;
+    return task;
+  }
+  return std::nullopt;
+}
+
+void ThreadPool::RunWorker(int worker_index) {
+  current_worker = {this, worker_index};
+  while (true) {
+    if (auto task = PopTask(worker_index); task.has_value()) {
+      task.value()();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    sleep_cv_.wait(lock, [this]() {
+      return should_quit_ || num_pending_tasks_.load() > 0;
+    });
+    // Finish all pending tasks before quitting.
+    if (should_quit_ && num_pending_tasks_.load() == 0) {
+      return;
+    }
+  }
+}
+
+std::optional<int> ThreadPool::GetCurrentWorkerIndex() const {
+  if (current_worker.pool != this) {
+    return std::nullopt;
+  }
+  return current_worker.worker_index;
+}
+
+ThreadPool& GetSharedThreadPool() {
+  // Leaked intentionally, so that no task outlives the pool.
+  static auto* thread_pool = new ThreadPool{};
+  return *thread_pool;
+}
+
+}  // namespace lighter::common
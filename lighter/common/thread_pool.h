@@ -0,0 +1,116 @@
+//
+//  thread_pool.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_COMMON_THREAD_POOL_H
+#define LIGHTER_COMMON_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "third_party/absl/functional/function_ref.h"
+
+namespace lighter::common {
+
+// This class maintains a fixed number of worker threads to run CPU-bound tasks.
+// Each worker owns a task queue. Tasks scheduled from a worker thread are
+// pushed to its own queue, and others are distributed in a round-robin manner.
+// A worker takes tasks from the back of its own queue first, and steals tasks
+// from the front of other queues when its own queue is empty.
+// Tasks may schedule more tasks or call ParallelFor() on the same pool, since
+// the calling thread always participates in the work it waits for.
+class ThreadPool {
+ public:
+  // If 'num_threads' is not positive, the number of concurrent threads
+  // supported by the hardware will be used.
+  explicit ThreadPool(int num_threads = 0);
+
+  // This class is neither copyable nor movable.
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Waits for all scheduled tasks to finish and joins worker threads.
+  ~ThreadPool();
+
+  // Schedules 'task' to run on a worker thread, and returns a future of its
+  // result.
+  template <typename Task>
+  std::future<std::invoke_result_t<Task>> Submit(Task&& task) {
+    using ResultType = std::invoke_result_t<Task>;
+    auto packaged_task = std::make_shared<std::packaged_task<ResultType()>>(
+        std::forward<Task>(task));
+    std::future<ResultType> future = packaged_task->get_future();
+    Schedule([packaged_task]() { (*packaged_task)(); });
+    return future;
+  }
+
+  // Schedules 'task' to run on a worker thread.
+  void Schedule(std::function<void()>&& task);
+
+  // Calls 'task' with each index in range [0, 'num_tasks'), and blocks until
+  // all of them are done. The calling thread also runs tasks, so this can be
+  // called from a task running on this pool.
+  void ParallelFor(int num_tasks, absl::FunctionRef<void(int)> task);
+
+  // Accessors.
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  // Task queue owned by each worker.
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // Pops a task from the queue of worker at 'worker_index', or steals one from
+  // other workers. Returns std::nullopt if all queues are empty.
+  std::optional<std::function<void()>> PopTask(int worker_index);
+
+  // Main loop of worker at 'worker_index'.
+  void RunWorker(int worker_index);
+
+  // Returns the index of worker if the calling thread is a worker of this
+  // pool. Otherwise, returns std::nullopt.
+  std::optional<int> GetCurrentWorkerIndex() const;
+
+  // Task queues, one per worker.
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+
+  // Worker threads.
+  std::vector<std::thread> workers_;
+
+  // Number of tasks that have been scheduled but not yet picked up.
+  std::atomic<int> num_pending_tasks_{0};
+
+  // Used for choosing a queue when scheduling from non-worker threads.
+  std::atomic<unsigned int> next_queue_index_{0};
+
+  // Used for putting idle workers to sleep.
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool should_quit_ = false;
+};
+
+// Returns the thread pool shared by the whole program, which uses the number of
+// concurrent threads supported by the hardware. Worker threads are created on
+// first use and live until the program exits, so that tasks scheduled by
+// static objects never outlive the pool. Code that does not need a dedicated
+// pool should use this one rather than creating its own.
+ThreadPool& GetSharedThreadPool();
+
+}  // namespace lighter::common
+
+#endif  // LIGHTER_COMMON_THREAD_POOL_H
@@ -8,6 +8,7 @@
 #include "lighter/common/util.h"
 
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
@@ -28,4 +29,36 @@ std::string GetCurrentTime() {
   return stream.str();
 }
 
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+  constexpr uint64_t kMultiplier = 0xc6a4a7935bd1e995ULL;
+  constexpr int kShift = 47;
+
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = seed ^ (size * kMultiplier);
+  const size_t num_blocks = size / sizeof(uint64_t);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    uint64_t block;
+    std::memcpy(&block, bytes + i * sizeof(uint64_t), sizeof(block));
+    block *= kMultiplier;
+    block ^= block >> kShift;
+    block *= kMultiplier;
+    hash ^= block;
+    hash *= kMultiplier;
+  }
+
+  const unsigned char* tail = bytes + num_blocks * sizeof(uint64_t);
+  const size_t tail_size = size % sizeof(uint64_t);
+  if (tail_size > 0) {
+    for (size_t i = tail_size; i > 0; --i) {
+      hash ^= static_cast<uint64_t>(tail[i - 1]) << (8 * (i - 1));
+    }
+    hash *= kMultiplier;
+  }
+
+  hash ^= hash >> kShift;
+  hash *= kMultiplier;
+  hash ^= hash >> kShift;
+  return hash;
+}
+
 }  // namespace lighter::common::util
@@ -9,6 +9,7 @@
 #define LIGHTER_COMMON_UTIL_H
 
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <iterator>
@@ -75,6 +76,11 @@ namespace lighter::common::util {
 // Returns the current time in "YYYY-MM-DD HH:MM:SS.fff" format.
 std::string GetCurrentTime();
 
+// Returns a 64-bit hash of 'size' bytes of 'data', computed with MurmurHash64A.
+// Unlike absl::Hash, this is stable across runs, hence it can be used to name
+// cache files.
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed);
+
 // This class simply wraps a std::ostream. When an instance of it gets
 // destructed, it will append std::endl to the end;
 class Logger {
@@ -0,0 +1,456 @@
+//
+//  frame_graph.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/ir/frame_graph.h"
+
+#include <algorithm>
+#include <set>
+
+#include "lighter/common/util.h"
+#include "third_party/absl/strings/str_format.h"
+
+namespace lighter::renderer::ir {
+namespace {
+
+using ImageHandle = FrameGraph::ImageHandle;
+using PassHandle = FrameGraph::PassHandle;
+
+// Returns 'value' rounded up to a multiple of 'alignment'.
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Returns true if 'usage' only reads the image.
+bool IsReadOnly(const ImageUsage& usage) {
+  return usage.access_type() == AccessType::kReadOnly;
+}
+
+// Returns true if a barrier is needed between two consecutive accesses.
+bool NeedBarrier(const ImageUsage& prev_usage, const ImageUsage& curr_usage) {
+  return !(IsReadOnly(prev_usage) && prev_usage == curr_usage);
+}
+
+// Inclusive range of indices of scheduled passes that access an image.
+struct Lifetime {
+  bool Overlaps(const Lifetime& other) const {
+    return first <= other.last && other.first <= last;
+  }
+
+  int first;
+  int last;
+};
+
+// Range of memory in the shared heap.
+struct MemoryRange {
+  bool Overlaps(const MemoryRange& other) const {
+    return begin < other.end && other.begin < end;
+  }
+
+  uint64_t begin;
+  uint64_t end;
+};
+
+// Accumulates accesses to images across subpasses of a render pass.
+class RenderPassAccessBuilder {
+ public:
+  // Records an access with 'usage'. The image is read only if 'reads' is true
+  // and this is the first access to it.
+  void AddAccess(ImageHandle image, const ImageUsage& usage, bool reads) {
+    const auto iter = access_map_.find(image);
+    if (iter == access_map_.end()) {
+      access_map_.insert({image, FrameGraph::ImageAccess{
+          image, /*first_usage=*/usage, /*last_usage=*/usage, reads,
+          /*writes=*/true}});
+    } else {
+      iter->second.last_usage = usage;
+    }
+  }
+
+  std::vector<FrameGraph::ImageAccess> Build() const {
+    std::vector<FrameGraph::ImageAccess> accesses;
+    accesses.reserve(access_map_.size());
+    for (const auto& [image, access] : access_map_) {
+      accesses.push_back(access);
+    }
+    return accesses;
+  }
+
+ private:
+  absl::flat_hash_map<ImageHandle, FrameGraph::ImageAccess> access_map_;
+};
+
+}  // namespace
+
+FrameGraph::ImageAccess::ImageAccess(ImageHandle image,
+                                     const ImageUsage& usage)
+    : image{image}, first_usage{usage}, last_usage{usage} {
+  const AccessType access_type = usage.access_type();
+  ASSERT_FALSE(access_type == AccessType::kDontCare,
+               "Must specify access type");
+  reads = access_type == AccessType::kReadOnly ||
+          access_type == AccessType::kReadWrite;
+  writes = access_type == AccessType::kWriteOnly ||
+           access_type == AccessType::kReadWrite;
+}
+
+FrameGraph::ImageHandle FrameGraph::AddTransientImage(std::string_view name,
+                                                      uint64_t size,
+                                                      uint64_t alignment) {
+  ASSERT_TRUE(alignment > 0,
+              absl::StrFormat("Alignment of image %s must be positive", name));
+  ImageInfo info;
+  info.name = std::string{name};
+  info.size = size;
+  info.alignment = alignment;
+  images_.push_back(std::move(info));
+  return num_images() - 1;
+}
+
+FrameGraph::ImageHandle FrameGraph::ImportImage(
+    std::string_view name, const ImageUsage& initial_usage,
+    std::optional<ImageUsage> final_usage) {
+  ImageInfo info;
+  info.name = std::string{name};
+  info.is_imported = true;
+  info.initial_usage = initial_usage;
+  info.final_usage = std::move(final_usage);
+  images_.push_back(std::move(info));
+  return num_images() - 1;
+}
+
+FrameGraph::PassHandle FrameGraph::AddPass(std::string_view name,
+                                           std::vector<ImageAccess> accesses,
+                                           bool has_side_effect) {
+  std::sort(accesses.begin(), accesses.end(),
+            [](const ImageAccess& lhs, const ImageAccess& rhs) {
+              return lhs.image < rhs.image;
+            });
+  for (int i = 0; i < accesses.size(); ++i) {
+    const ImageHandle image = accesses[i].image;
+    ASSERT_TRUE(image >= 0 && image < num_images(),
+                absl::StrFormat("Invalid image handle %d in pass %s",
+                                image, name));
+    ASSERT_FALSE(i > 0 && accesses[i - 1].image == image,
+                 absl::StrFormat("Image %s is accessed more than once in pass "
+                                 "%s", images_[image].name, name));
+  }
+  passes_.push_back({std::string{name}, std::move(accesses), has_side_effect});
+  return num_passes() - 1;
+}
+
+FrameGraph::PassHandle FrameGraph::AddRenderPass(
+    std::string_view name, const RenderPassDescriptor& descriptor,
+    const ImageHandleMap& image_handle_map, bool has_side_effect) {
+  RenderPassAccessBuilder builder;
+  for (const auto& subpass : descriptor.subpass_descriptors) {
+    for (int i = 0; i < subpass.color_attachments.size(); ++i) {
+      const Image* image = subpass.color_attachments[i];
+      const auto iter = descriptor.color_ops_map.find(image);
+      const bool is_loaded = iter != descriptor.color_ops_map.end() &&
+                             iter->second.load_op == AttachmentLoadOp::kLoad;
+      builder.AddAccess(GetImageHandle(image, image_handle_map),
+                        ImageUsage::GetRenderTargetUsage(i), is_loaded);
+    }
+
+    for (const auto& resolve : subpass.multisample_resolves) {
+      builder.AddAccess(GetImageHandle(resolve.target_image, image_handle_map),
+                        ImageUsage::GetMultisampleResolveTargetUsage(),
+                        /*reads=*/false);
+    }
+
+    if (subpass.depth_stencil_attachment != nullptr) {
+      const Image* image = subpass.depth_stencil_attachment;
+      const auto iter = descriptor.depth_stencil_ops_map.find(image);
+      const bool is_loaded =
+          iter != descriptor.depth_stencil_ops_map.end() &&
+          (iter->second.depth_ops.load_op == AttachmentLoadOp::kLoad ||
+           iter->second.stencil_ops.load_op == AttachmentLoadOp::kLoad);
+      builder.AddAccess(GetImageHandle(image, image_handle_map),
+                        ImageUsage::GetDepthStencilUsage(
+                            AccessType::kReadWrite),
+                        is_loaded);
+    }
+  }
+  return AddPass(name, builder.Build(), has_side_effect);
+}
+
+FrameGraph::PassHandle FrameGraph::AddComputePass(
+    std::string_view name, const ComputePassDescriptor& descriptor,
+    const ImageHandleMap& image_handle_map, bool has_side_effect) {
+  std::vector<ImageAccess> accesses;
+  accesses.reserve(descriptor.image_usages.size());
+  for (const auto& [image, usage] : descriptor.image_usages) {
+    accesses.push_back({GetImageHandle(image, image_handle_map), usage});
+  }
+  return AddPass(name, std::move(accesses), has_side_effect);
+}
+
+FrameGraph::CompiledGraph FrameGraph::Compile() const {
+  CompiledGraph compiled_graph;
+  const std::vector<PassHandle> order = SortPasses(CullPasses());
+  compiled_graph.passes.reserve(order.size());
+  for (const PassHandle pass : order) {
+    compiled_graph.passes.push_back({pass, /*barriers=*/{}});
+  }
+  const auto aliased_images = AliasTransientImages(order, &compiled_graph);
+  ComputeBarriers(aliased_images, &compiled_graph);
+  return compiled_graph;
+}
+
+std::vector<bool> FrameGraph::CullPasses() const {
+  // A pass reading an image depends on the last pass writing it before.
+  std::vector<std::vector<PassHandle>> producers(num_passes());
+  std::vector<std::optional<PassHandle>> last_writers(num_images());
+  for (PassHandle pass = 0; pass < num_passes(); ++pass) {
+    for (const auto& access : passes_[pass].accesses) {
+      const auto& last_writer = last_writers[access.image];
+      if (access.reads && last_writer.has_value()) {
+        producers[pass].push_back(last_writer.value());
+      }
+    }
+    for (const auto& access : passes_[pass].accesses) {
+      if (access.writes) {
+        last_writers[access.image] = pass;
+      }
+    }
+  }
+
+  // Producers are always added before consumers, hence we can propagate in
+  // reverse order.
+  std::vector<bool> is_kept(num_passes(), false);
+  for (PassHandle pass = num_passes() - 1; pass >= 0; --pass) {
+    const PassInfo& info = passes_[pass];
+    if (!is_kept[pass]) {
+      is_kept[pass] = info.has_side_effect ||
+          std::any_of(info.accesses.begin(), info.accesses.end(),
+                      [this](const ImageAccess& access) {
+                        return access.writes &&
+                               images_[access.image].is_imported;
+                      });
+    }
+    if (is_kept[pass]) {
+      for (const PassHandle producer : producers[pass]) {
+        is_kept[producer] = true;
+      }
+    }
+  }
+  return is_kept;
+}
+
+std::vector<FrameGraph::PassHandle> FrameGraph::SortPasses(
+    const std::vector<bool>& is_kept) const {
+  // Build dependency edges among kept passes. Read-after-write edges are also
+  // recorded separately, so that we can prefer scheduling consumers right
+  // after producers.
+  std::vector<std::vector<PassHandle>> successors(num_passes());
+  std::vector<std::vector<PassHandle>> raw_successors(num_passes());
+  std::vector<int> num_predecessors(num_passes(), 0);
+  const auto add_edge = [&](PassHandle from, PassHandle to) {
+    successors[from].push_back(to);
+    ++num_predecessors[to];
+  };
+
+  std::vector<std::optional<PassHandle>> last_writers(num_images());
+  std::vector<std::vector<PassHandle>> readers_since_write(num_images());
+  for (PassHandle pass = 0; pass < num_passes(); ++pass) {
+    if (!is_kept[pass]) {
+      continue;
+    }
+    for (const auto& access : passes_[pass].accesses) {
+      auto& last_writer = last_writers[access.image];
+      auto& readers = readers_since_write[access.image];
+      if (access.reads && last_writer.has_value()) {
+        add_edge(last_writer.value(), pass);
+        raw_successors[last_writer.value()].push_back(pass);
+      }
+      if (access.writes) {
+        for (const PassHandle reader : readers) {
+          add_edge(reader, pass);
+        }
+        if (!access.reads && last_writer.has_value()) {
+          add_edge(last_writer.value(), pass);
+        }
+        last_writer = pass;
+        readers.clear();
+      } else if (access.reads) {
+        readers.push_back(pass);
+      }
+    }
+  }
+
+  std::set<PassHandle> ready_passes;
+  for (PassHandle pass = 0; pass < num_passes(); ++pass) {
+    if (is_kept[pass] && num_predecessors[pass] == 0) {
+      ready_passes.insert(pass);
+    }
+  }
+
+  std::vector<PassHandle> order;
+  std::optional<PassHandle> last_scheduled;
+  while (!ready_passes.empty()) {
+    std::optional<PassHandle> next;
+    if (last_scheduled.has_value()) {
+      for (const PassHandle consumer : raw_successors[last_scheduled.value()]) {
+        if (ready_passes.count(consumer) > 0 &&
+            (!next.has_value() || consumer < next.value())) {
+          next = consumer;
+        }
+      }
+    }
+    if (!next.has_value()) {
+      next = *ready_passes.begin();
+    }
+
+    const PassHandle pass = next.value();
+    ready_passes.erase(pass);
+    order.push_back(pass);
+    last_scheduled = pass;
+    for (const PassHandle successor : successors[pass]) {
+      if (--num_predecessors[successor] == 0) {
+        ready_passes.insert(successor);
+      }
+    }
+  }
+
+  ASSERT_TRUE(order.size() == std::count(is_kept.begin(), is_kept.end(), true),
+              "Dependency cycle detected");
+  return order;
+}
+
+std::vector<std::vector<FrameGraph::ImageHandle>>
+FrameGraph::AliasTransientImages(const std::vector<PassHandle>& order,
+                                 CompiledGraph* compiled_graph) const {
+  std::vector<std::optional<Lifetime>> lifetimes(num_images());
+  for (int index = 0; index < order.size(); ++index) {
+    for (const auto& access : passes_[order[index]].accesses) {
+      auto& lifetime = lifetimes[access.image];
+      if (lifetime.has_value()) {
+        lifetime->last = index;
+      } else {
+        lifetime = Lifetime{index, index};
+      }
+    }
+  }
+
+  std::vector<ImageHandle> transient_images;
+  for (ImageHandle image = 0; image < num_images(); ++image) {
+    if (!images_[image].is_imported && lifetimes[image].has_value()) {
+      transient_images.push_back(image);
+    }
+  }
+
+  // Place larger images first, since they are harder to fit into gaps. Each
+  // image takes the lowest offset that does not overlap with any placed image
+  // whose lifetime overlaps with it.
+  std::stable_sort(transient_images.begin(), transient_images.end(),
+                   [this](ImageHandle lhs, ImageHandle rhs) {
+                     return images_[lhs].size > images_[rhs].size;
+                   });
+
+  auto& offsets = compiled_graph->transient_image_offsets;
+  offsets.assign(num_images(), std::nullopt);
+  std::vector<MemoryRange> memory_ranges(num_images());
+  std::vector<ImageHandle> placed_images;
+  std::vector<MemoryRange> conflicts;
+  for (const ImageHandle image : transient_images) {
+    const ImageInfo& info = images_[image];
+    conflicts.clear();
+    for (const ImageHandle placed : placed_images) {
+      if (lifetimes[placed]->Overlaps(lifetimes[image].value())) {
+        conflicts.push_back(memory_ranges[placed]);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const MemoryRange& lhs, const MemoryRange& rhs) {
+                return lhs.begin < rhs.begin;
+              });
+
+    uint64_t offset = 0;
+    for (const auto& conflict : conflicts) {
+      if (offset + info.size <= conflict.begin) {
+        break;
+      }
+      offset = std::max(offset, AlignUp(conflict.end, info.alignment));
+    }
+
+    offsets[image] = offset;
+    memory_ranges[image] = {offset, offset + info.size};
+    placed_images.push_back(image);
+    compiled_graph->transient_memory_size =
+        std::max(compiled_graph->transient_memory_size, offset + info.size);
+  }
+
+  // Images sharing memory with an image, and accessed entirely before it.
+  std::vector<std::vector<ImageHandle>> aliased_images(num_images());
+  std::sort(transient_images.begin(), transient_images.end());
+  uint64_t size_without_aliasing = 0;
+  for (const ImageHandle image : transient_images) {
+    size_without_aliasing =
+        AlignUp(size_without_aliasing, images_[image].alignment) +
+        images_[image].size;
+    for (const ImageHandle other : transient_images) {
+      if (lifetimes[other]->last < lifetimes[image]->first &&
+          memory_ranges[other].Overlaps(memory_ranges[image])) {
+        aliased_images[image].push_back(other);
+      }
+    }
+  }
+  compiled_graph->transient_memory_size_without_aliasing =
+      size_without_aliasing;
+  return aliased_images;
+}
+
+void FrameGraph::ComputeBarriers(
+    const std::vector<std::vector<ImageHandle>>& aliased_images,
+    CompiledGraph* compiled_graph) const {
+  // Content of transient images is undefined before the first access.
+  std::vector<ImageUsage> curr_usages(num_images());
+  std::vector<bool> is_accessed(num_images(), false);
+  for (ImageHandle image = 0; image < num_images(); ++image) {
+    if (images_[image].is_imported) {
+      curr_usages[image] = images_[image].initial_usage;
+    }
+  }
+
+  for (auto& scheduled_pass : compiled_graph->passes) {
+    for (const auto& access : passes_[scheduled_pass.pass].accesses) {
+      const ImageHandle image = access.image;
+      const ImageUsage& prev_usage = curr_usages[image];
+      const bool is_first_transient_access =
+          !is_accessed[image] && !images_[image].is_imported;
+      if (is_first_transient_access ||
+          NeedBarrier(prev_usage, access.first_usage)) {
+        Barrier barrier{image, prev_usage, access.first_usage,
+                        /*aliased_images=*/{}};
+        if (is_first_transient_access) {
+          barrier.aliased_images = aliased_images[image];
+        }
+        scheduled_pass.barriers.push_back(std::move(barrier));
+      }
+      curr_usages[image] = access.last_usage;
+      is_accessed[image] = true;
+    }
+  }
+
+  for (ImageHandle image = 0; image < num_images(); ++image) {
+    const auto& final_usage = images_[image].final_usage;
+    if (final_usage.has_value() && !(curr_usages[image] == *final_usage)) {
+      compiled_graph->final_barriers.push_back(
+          {image, curr_usages[image], *final_usage, /*aliased_images=*/{}});
+    }
+  }
+}
+
+FrameGraph::ImageHandle FrameGraph::GetImageHandle(
+    const Image* image, const ImageHandleMap& image_handle_map) const {
+  const auto iter = image_handle_map.find(image);
+  ASSERT_TRUE(iter != image_handle_map.end(),
+              "Image is not registered in frame graph");
+  return iter->second;
+}
+
+}  // namespace lighter::renderer::ir
@@ -0,0 +1,213 @@
+//
+//  frame_graph.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_IR_FRAME_GRAPH_H
+#define LIGHTER_RENDERER_IR_FRAME_GRAPH_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lighter/renderer/ir/image.h"
+#include "lighter/renderer/ir/image_usage.h"
+#include "lighter/renderer/ir/pass.h"
+#include "third_party/absl/container/flat_hash_map.h"
+
+namespace lighter::renderer::ir {
+
+// This class schedules passes that declare which images they read and write.
+// Compile() does the following without talking to any graphics API:
+//   (1) Culls passes whose outputs are never consumed. A pass is kept if it has
+//       side effects, writes an imported image, or produces an image that is
+//       read by a kept pass.
+//   (2) Topologically sorts the remaining passes. Dependencies are derived from
+//       the order in which passes are added (read-after-write, write-after-read
+//       and write-after-write). Among passes that are ready, consumers of the
+//       last scheduled pass are preferred, which shortens lifetimes of
+//       transient images.
+//   (3) Assigns transient images offsets in one shared memory heap. Images
+//       whose lifetimes don't overlap may alias each other.
+//   (4) Computes image usage transitions before each pass. No barrier is
+//       emitted between two read-only accesses with the same usage.
+// Backends translate the result into device memory, image layouts and
+// pipeline barriers.
+class FrameGraph {
+ public:
+  using ImageHandle = int;
+  using PassHandle = int;
+
+  // Describes how a pass accesses an image.
+  struct ImageAccess {
+    // Deduces whether the image is read or written from 'usage'.
+    ImageAccess(ImageHandle image, const ImageUsage& usage);
+
+    ImageAccess(ImageHandle image, const ImageUsage& first_usage,
+                const ImageUsage& last_usage, bool reads, bool writes)
+        : image{image}, first_usage{first_usage}, last_usage{last_usage},
+          reads{reads}, writes{writes} {}
+
+    ImageHandle image;
+
+    // Usages when the pass starts and finishes accessing the image. They are
+    // different if the usage changes within the pass, e.g. across subpasses.
+    ImageUsage first_usage;
+    ImageUsage last_usage;
+
+    // Whether the pass depends on the previous content of the image, and
+    // whether it modifies the image.
+    bool reads;
+    bool writes;
+  };
+
+  // Transition of image usage.
+  struct Barrier {
+    ImageHandle image;
+    ImageUsage prev_usage;
+    ImageUsage curr_usage;
+
+    // Only set for the first access to a transient image. These images used to
+    // occupy overlapping memory, and accesses to them must finish before the
+    // memory is reused.
+    std::vector<ImageHandle> aliased_images;
+  };
+
+  // A pass to execute, and barriers to insert before executing it.
+  struct ScheduledPass {
+    PassHandle pass;
+    std::vector<Barrier> barriers;
+  };
+
+  // Result of compilation.
+  struct CompiledGraph {
+    // Passes that are not culled, in execution order.
+    std::vector<ScheduledPass> passes;
+
+    // Barriers to insert after all passes, which transition imported images to
+    // their final usages.
+    std::vector<Barrier> final_barriers;
+
+    // Offsets of transient images in the shared memory heap, indexed by image
+    // handles. This does not have value for imported images, and transient
+    // images that are not used by any scheduled pass.
+    std::vector<std::optional<uint64_t>> transient_image_offsets;
+
+    // Size of the shared memory heap.
+    uint64_t transient_memory_size = 0;
+
+    // Size of memory needed if transient images don't alias each other.
+    uint64_t transient_memory_size_without_aliasing = 0;
+  };
+
+  // Maps images referenced in pass descriptors to handles.
+  using ImageHandleMap = absl::flat_hash_map<const Image*, ImageHandle>;
+
+  FrameGraph() = default;
+
+  // This class is only movable.
+  FrameGraph(FrameGraph&&) noexcept = default;
+  FrameGraph& operator=(FrameGraph&&) noexcept = default;
+
+  // Adds an image that only lives within this graph. It takes 'size' bytes of
+  // memory with 'alignment', and its content is undefined before the first
+  // write.
+  ImageHandle AddTransientImage(std::string_view name, uint64_t size,
+                                uint64_t alignment);
+
+  // Adds an image that lives outside this graph, such as swapchain images or
+  // images consumed by later frames. It is in 'initial_usage' before this graph
+  // executes. If 'final_usage' is specified, it will be transitioned to that
+  // usage at the end.
+  ImageHandle ImportImage(std::string_view name,
+                          const ImageUsage& initial_usage,
+                          std::optional<ImageUsage> final_usage = std::nullopt);
+
+  // Adds a pass that accesses images in 'accesses'. Each image can appear at
+  // most once. If 'has_side_effect' is true, the pass will never be culled.
+  PassHandle AddPass(std::string_view name, std::vector<ImageAccess> accesses,
+                     bool has_side_effect = false);
+
+  // Adds a render pass described by 'descriptor'. Images referenced in it must
+  // be in 'image_handle_map'. Color attachments are read only if they are
+  // loaded.
+  PassHandle AddRenderPass(std::string_view name,
+                           const RenderPassDescriptor& descriptor,
+                           const ImageHandleMap& image_handle_map,
+                           bool has_side_effect = false);
+
+  // Adds a compute pass described by 'descriptor'. Images referenced in it
+  // must be in 'image_handle_map'.
+  PassHandle AddComputePass(std::string_view name,
+                            const ComputePassDescriptor& descriptor,
+                            const ImageHandleMap& image_handle_map,
+                            bool has_side_effect = false);
+
+  // Schedules passes. See class comments for details.
+  CompiledGraph Compile() const;
+
+  // Accessors.
+  const std::string& image_name(ImageHandle image) const {
+    return images_.at(image).name;
+  }
+  const std::string& pass_name(PassHandle pass) const {
+    return passes_.at(pass).name;
+  }
+  const std::vector<ImageAccess>& pass_accesses(PassHandle pass) const {
+    return passes_.at(pass).accesses;
+  }
+  int num_images() const { return static_cast<int>(images_.size()); }
+  int num_passes() const { return static_cast<int>(passes_.size()); }
+
+ private:
+  struct ImageInfo {
+    std::string name;
+
+    // Only used for transient images.
+    uint64_t size = 0;
+    uint64_t alignment = 1;
+
+    // Only used for imported images.
+    bool is_imported = false;
+    ImageUsage initial_usage;
+    std::optional<ImageUsage> final_usage;
+  };
+
+  struct PassInfo {
+    std::string name;
+    std::vector<ImageAccess> accesses;
+    bool has_side_effect;
+  };
+
+  // Returns whether each pass should be kept, indexed by pass handles.
+  std::vector<bool> CullPasses() const;
+
+  // Returns kept passes in execution order.
+  std::vector<PassHandle> SortPasses(const std::vector<bool>& is_kept) const;
+
+  // Populates offsets of transient images in 'compiled_graph', and returns
+  // aliased images of each transient image, indexed by image handles.
+  std::vector<std::vector<ImageHandle>> AliasTransientImages(
+      const std::vector<PassHandle>& order,
+      CompiledGraph* compiled_graph) const;
+
+  // Populates barriers in 'compiled_graph'.
+  void ComputeBarriers(
+      const std::vector<std::vector<ImageHandle>>& aliased_images,
+      CompiledGraph* compiled_graph) const;
+
+  // Returns the handle of 'image' in 'image_handle_map'.
+  ImageHandle GetImageHandle(const Image* image,
+                             const ImageHandleMap& image_handle_map) const;
+
+  std::vector<ImageInfo> images_;
+  std::vector<PassInfo> passes_;
+};
+
+}  // namespace lighter::renderer::ir
+
+#endif  // LIGHTER_RENDERER_IR_FRAME_GRAPH_H
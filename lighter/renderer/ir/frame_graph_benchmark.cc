@@ -0,0 +1,85 @@
+//
+//  frame_graph_benchmark.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "lighter/renderer/ir/frame_graph.h"
+
+namespace lighter::renderer::ir {
+namespace {
+
+// Each pass reads a few images produced by recent passes and writes one new
+// image, which resembles chains of post-processing passes. Every eighth pass
+// also writes to an imported image, and a quarter of passes are never consumed
+// and should be culled.
+FrameGraph BuildGraph(int num_passes) {
+  constexpr int kNumInputsPerPass = 3;
+  constexpr int kWindowSize = 16;
+
+  const auto write_usage =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+  const auto read_usage = ImageUsage::GetSampledInFragmentShaderUsage();
+
+  std::mt19937 generator{0};
+  FrameGraph graph;
+  const auto output = graph.ImportImage(
+      "output", ImageUsage{}, ImageUsage::GetPresentationUsage());
+  std::vector<FrameGraph::ImageHandle> consumable_images;
+  for (int i = 0; i < num_passes; ++i) {
+    const auto image = graph.AddTransientImage(
+        "image", /*size=*/(1 + generator() % 64) << 16,
+        /*alignment=*/uint64_t{1} << 16);
+    std::vector<FrameGraph::ImageAccess> accesses{{image, write_usage}};
+    if (!consumable_images.empty()) {
+      const int window = std::min<int>(kWindowSize, consumable_images.size());
+      for (int j = 0; j < kNumInputsPerPass; ++j) {
+        const auto input =
+            consumable_images[consumable_images.size() - 1 -
+                              generator() % window];
+        const bool is_duplicate = std::any_of(
+            accesses.begin(), accesses.end(),
+            [input](const FrameGraph::ImageAccess& access) {
+              return access.image == input;
+            });
+        if (!is_duplicate) {
+          accesses.push_back({input, read_usage});
+        }
+      }
+    }
+    if (i % 8 == 7) {
+      accesses.push_back({output, write_usage});
+    }
+    graph.AddPass("pass", std::move(accesses));
+    if (generator() % 4 != 0) {
+      consumable_images.push_back(image);
+    }
+  }
+  return graph;
+}
+
+void BM_Compile(benchmark::State& state) {
+  const FrameGraph graph = BuildGraph(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph.Compile());
+  }
+  state.SetItemsProcessed(state.iterations() * graph.num_passes());
+
+  const auto compiled_graph = graph.Compile();
+  state.counters["kept_passes"] = compiled_graph.passes.size();
+  state.counters["memory_saving"] =
+      1.0 - static_cast<double>(compiled_graph.transient_memory_size) /
+                compiled_graph.transient_memory_size_without_aliasing;
+}
+BENCHMARK(BM_Compile)->Arg(1 << 6)->Arg(1 << 9)->Arg(1 << 12);
+
+}  // namespace
+}  // namespace lighter::renderer::ir
+
+BENCHMARK_MAIN();
@@ -0,0 +1,255 @@
+//
+//  frame_graph_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/ir/frame_graph.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lighter::renderer::ir {
+namespace {
+
+using ImageAccess = FrameGraph::ImageAccess;
+
+const ImageUsage kComputeWrite =
+    ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+const ImageUsage kComputeRead =
+    ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadOnly);
+const ImageUsage kSampled = ImageUsage::GetSampledInFragmentShaderUsage();
+
+// Image that only provides identity for pass descriptors.
+class FakeImage : public Image {
+ public:
+  explicit FakeImage(std::string_view name)
+      : Image{name, LayerType::kSingle, /*extent=*/{1, 1},
+              /*mip_levels=*/1} {}
+};
+
+// Returns passes in 'compiled_graph' in execution order.
+std::vector<FrameGraph::PassHandle> GetOrder(
+    const FrameGraph::CompiledGraph& compiled_graph) {
+  std::vector<FrameGraph::PassHandle> order;
+  for (const auto& scheduled_pass : compiled_graph.passes) {
+    order.push_back(scheduled_pass.pass);
+  }
+  return order;
+}
+
+TEST(FrameGraphTest, CullUnusedPasses) {
+  FrameGraph graph;
+  const auto unused = graph.AddTransientImage("unused", /*size=*/16,
+                                              /*alignment=*/1);
+  const auto temp = graph.AddTransientImage("temp", /*size=*/16,
+                                            /*alignment=*/1);
+  const auto output = graph.ImportImage("output", ImageUsage{});
+
+  graph.AddPass("write_unused", {{unused, kComputeWrite}});
+  const auto write_temp = graph.AddPass("write_temp", {{temp, kComputeWrite}});
+  const auto write_output = graph.AddPass(
+      "write_output", {{temp, kComputeRead}, {output, kComputeWrite}});
+  const auto side_effect = graph.AddPass("side_effect", {},
+                                         /*has_side_effect=*/true);
+  graph.AddPass("read_unused", {{unused, kComputeRead}});
+
+  const auto compiled_graph = graph.Compile();
+  EXPECT_EQ(GetOrder(compiled_graph),
+            (std::vector<int>{write_temp, write_output, side_effect}));
+  EXPECT_FALSE(compiled_graph.transient_image_offsets[unused].has_value());
+  EXPECT_TRUE(compiled_graph.transient_image_offsets[temp].has_value());
+  EXPECT_FALSE(compiled_graph.transient_image_offsets[output].has_value());
+}
+
+TEST(FrameGraphTest, ScheduleConsumersAfterProducers) {
+  FrameGraph graph;
+  const auto first = graph.AddTransientImage("first", /*size=*/16,
+                                             /*alignment=*/1);
+  const auto second = graph.AddTransientImage("second", /*size=*/16,
+                                              /*alignment=*/1);
+  const auto output = graph.ImportImage("output", ImageUsage{});
+
+  const auto write_first = graph.AddPass("write_first",
+                                         {{first, kComputeWrite}});
+  const auto write_second = graph.AddPass("write_second",
+                                          {{second, kComputeWrite}});
+  const auto read_first = graph.AddPass(
+      "read_first", {{first, kComputeRead}, {output, kComputeWrite}});
+  const auto read_second = graph.AddPass(
+      "read_second", {{second, kComputeRead}, {output, kComputeWrite}});
+
+  // 'read_first' should run right after 'write_first', so that 'first' and
+  // 'second' can share memory.
+  const auto compiled_graph = graph.Compile();
+  EXPECT_EQ(GetOrder(compiled_graph),
+            (std::vector<int>{write_first, read_first, write_second,
+                              read_second}));
+  EXPECT_EQ(compiled_graph.transient_image_offsets[first],
+            compiled_graph.transient_image_offsets[second]);
+  EXPECT_EQ(compiled_graph.transient_memory_size, 16);
+  EXPECT_EQ(compiled_graph.transient_memory_size_without_aliasing, 32);
+}
+
+TEST(FrameGraphTest, RespectWriteAfterRead) {
+  FrameGraph graph;
+  const auto image = graph.ImportImage("image", ImageUsage{});
+  const auto output = graph.ImportImage("output", ImageUsage{});
+
+  const auto read = graph.AddPass(
+      "read", {{image, kComputeRead}, {output, kComputeWrite}});
+  const auto write = graph.AddPass("write", {{image, kComputeWrite}});
+
+  EXPECT_EQ(GetOrder(graph.Compile()), (std::vector<int>{read, write}));
+}
+
+TEST(FrameGraphTest, KeepImagesWithOverlappingLifetimesApart) {
+  FrameGraph graph;
+  const auto large = graph.AddTransientImage("large", /*size=*/100,
+                                             /*alignment=*/64);
+  const auto small = graph.AddTransientImage("small", /*size=*/10,
+                                             /*alignment=*/64);
+  const auto alive = graph.AddTransientImage("alive", /*size=*/50,
+                                             /*alignment=*/64);
+  const auto output = graph.ImportImage("output", ImageUsage{});
+
+  graph.AddPass("pass0", {{large, kComputeWrite}, {alive, kComputeWrite}});
+  graph.AddPass("pass1", {{large, kComputeRead}, {small, kComputeWrite}});
+  graph.AddPass("pass2", {{small, kComputeRead}, {alive, kComputeRead},
+                          {output, kComputeWrite}});
+
+  // 'large' and 'small' overlap at 'pass1', while 'large' and 'alive' overlap
+  // at 'pass0'. 'small' can reuse memory of 'large' only if they don't overlap.
+  const auto compiled_graph = graph.Compile();
+  const auto& offsets = compiled_graph.transient_image_offsets;
+  EXPECT_EQ(offsets[large], 0);
+  EXPECT_EQ(offsets[alive], 128);
+  EXPECT_EQ(offsets[small], 192);
+  EXPECT_EQ(compiled_graph.transient_memory_size, 202);
+  EXPECT_EQ(compiled_graph.transient_memory_size_without_aliasing, 242);
+}
+
+TEST(FrameGraphTest, ReportAliasedImages) {
+  FrameGraph graph;
+  const auto first = graph.AddTransientImage("first", /*size=*/16,
+                                             /*alignment=*/1);
+  const auto second = graph.AddTransientImage("second", /*size=*/16,
+                                              /*alignment=*/1);
+  const auto output = graph.ImportImage("output", ImageUsage{});
+
+  graph.AddPass("write_first", {{first, kComputeWrite}});
+  graph.AddPass("read_first", {{first, kComputeRead}, {output, kComputeWrite}});
+  graph.AddPass("write_second", {{second, kComputeWrite}});
+  graph.AddPass("read_second",
+                {{second, kComputeRead}, {output, kComputeWrite}});
+
+  const auto compiled_graph = graph.Compile();
+  ASSERT_EQ(compiled_graph.passes.size(), 4);
+  const auto& first_barriers = compiled_graph.passes[0].barriers;
+  ASSERT_EQ(first_barriers.size(), 1);
+  EXPECT_EQ(first_barriers[0].image, first);
+  EXPECT_TRUE(first_barriers[0].aliased_images.empty());
+
+  const auto& second_barriers = compiled_graph.passes[2].barriers;
+  ASSERT_EQ(second_barriers.size(), 1);
+  EXPECT_EQ(second_barriers[0].image, second);
+  EXPECT_EQ(second_barriers[0].prev_usage, ImageUsage{});
+  EXPECT_EQ(second_barriers[0].aliased_images, std::vector<int>{first});
+}
+
+TEST(FrameGraphTest, SkipBarriersBetweenSameReads) {
+  FrameGraph graph;
+  const auto texture = graph.ImportImage("texture", kSampled);
+  const auto output = graph.ImportImage("output", kComputeWrite);
+
+  graph.AddPass("read0", {{texture, kSampled}, {output, kComputeWrite}});
+  graph.AddPass("read1", {{texture, kSampled}, {output, kComputeWrite}});
+
+  const auto compiled_graph = graph.Compile();
+  ASSERT_EQ(compiled_graph.passes.size(), 2);
+  for (const auto& scheduled_pass : compiled_graph.passes) {
+    // Only the write-after-write to 'output' needs a barrier.
+    ASSERT_EQ(scheduled_pass.barriers.size(), 1);
+    EXPECT_EQ(scheduled_pass.barriers[0].image, output);
+  }
+  EXPECT_TRUE(compiled_graph.final_barriers.empty());
+}
+
+TEST(FrameGraphTest, TransitionToFinalUsage) {
+  FrameGraph graph;
+  const auto swapchain = graph.ImportImage(
+      "swapchain", ImageUsage{}, ImageUsage::GetPresentationUsage());
+  const auto render_target = ImageUsage::GetRenderTargetUsage(0);
+  const auto draw = graph.AddPass(
+      "draw", {{swapchain, render_target, render_target, /*reads=*/false,
+                /*writes=*/true}});
+
+  const auto compiled_graph = graph.Compile();
+  ASSERT_EQ(GetOrder(compiled_graph), std::vector<int>{draw});
+  ASSERT_EQ(compiled_graph.final_barriers.size(), 1);
+  const auto& barrier = compiled_graph.final_barriers[0];
+  EXPECT_EQ(barrier.image, swapchain);
+  EXPECT_EQ(barrier.prev_usage, render_target);
+  EXPECT_EQ(barrier.curr_usage, ImageUsage::GetPresentationUsage());
+}
+
+TEST(FrameGraphTest, AddPassesFromDescriptors) {
+  const FakeImage color_image{"color"}, depth_image{"depth"},
+      swapchain_image{"swapchain"};
+  FrameGraph graph;
+  const auto color = graph.AddTransientImage("color", /*size=*/16,
+                                             /*alignment=*/1);
+  const auto depth = graph.AddTransientImage("depth", /*size=*/16,
+                                             /*alignment=*/1);
+  const auto swapchain = graph.ImportImage(
+      "swapchain", ImageUsage{}, ImageUsage::GetPresentationUsage());
+  const FrameGraph::ImageHandleMap image_handle_map{
+      {&color_image, color},
+      {&depth_image, depth},
+      {&swapchain_image, swapchain},
+  };
+
+  RenderPassDescriptor::ColorLoadStoreOps color_ops;
+  color_ops.load_op = AttachmentLoadOp::kClear;
+  color_ops.store_op = AttachmentStoreOp::kStore;
+  RenderPassDescriptor render_pass;
+  render_pass
+      .AddAttachment(&color_image, color_ops)
+      .AddAttachment(&depth_image,
+                     RenderPassDescriptor::DepthStencilLoadStoreOps{})
+      .AddSubpass(std::move(SubpassDescriptor{}
+                                .AddColorAttachment(&color_image)
+                                .SetDepthStencilAttachment(&depth_image)));
+  const auto render =
+      graph.AddRenderPass("render", render_pass, image_handle_map);
+
+  ComputePassDescriptor compute_pass;
+  compute_pass.AddImageUsage(&color_image, kComputeRead)
+      .AddImageUsage(&swapchain_image, kComputeWrite);
+  const auto compute =
+      graph.AddComputePass("compute", compute_pass, image_handle_map);
+
+  const auto compiled_graph = graph.Compile();
+  ASSERT_EQ(GetOrder(compiled_graph), (std::vector<int>{render, compute}));
+
+  const auto& render_barriers = compiled_graph.passes[0].barriers;
+  ASSERT_EQ(render_barriers.size(), 2);
+  EXPECT_EQ(render_barriers[0].curr_usage,
+            ImageUsage::GetRenderTargetUsage(0));
+  EXPECT_EQ(render_barriers[1].curr_usage,
+            ImageUsage::GetDepthStencilUsage(AccessType::kReadWrite));
+
+  const auto& compute_barriers = compiled_graph.passes[1].barriers;
+  ASSERT_EQ(compute_barriers.size(), 2);
+  EXPECT_EQ(compute_barriers[0].image, color);
+  EXPECT_EQ(compute_barriers[0].prev_usage,
+            ImageUsage::GetRenderTargetUsage(0));
+  EXPECT_EQ(compute_barriers[0].curr_usage, kComputeRead);
+  EXPECT_EQ(compute_barriers[1].image, swapchain);
+  EXPECT_EQ(compiled_graph.final_barriers.size(), 1);
+}
+
+}  // namespace
+}  // namespace lighter::renderer::ir
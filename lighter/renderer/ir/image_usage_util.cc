@@ -0,0 +1,76 @@
+//
+//  image_usage_util.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/ir/image_usage_util.h"
+
+#include <algorithm>
+
+namespace lighter::renderer::ir::image {
+namespace {
+
+// Sorts 'transitions' by image names.
+void SortByImageName(std::vector<UsageTransition>& transitions) {
+  std::sort(transitions.begin(), transitions.end(),
+            [](const UsageTransition& lhs, const UsageTransition& rhs) {
+              return lhs.image_name < rhs.image_name;
+            });
+}
+
+}  // namespace
+
+bool NeedSynchronization(const ImageUsage& prev_usage,
+                         const ImageUsage& curr_usage) {
+  // RAR.
+  if (curr_usage == prev_usage &&
+      curr_usage.access_type() == AccessType::kReadOnly) {
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::vector<UsageTransition>> GetSubpassBarriers(
+    const ImageUsageHistoryMap& history_map, int num_subpasses,
+    bool transfers_ownership) {
+  constexpr int kInitialSubpass = -1;
+  std::vector<std::vector<UsageTransition>> barriers(num_subpasses + 1);
+
+  for (const auto& [image_name, history] : history_map) {
+    int prev_usage_subpass = kInitialSubpass;
+    const ImageUsage* prev_usage = &history.initial_usage();
+    const auto add_transition = [&](int subpass,
+                                    const ImageUsage& curr_usage) {
+      const bool transfers_at_boundary =
+          transfers_ownership && (prev_usage_subpass == kInitialSubpass ||
+                                  subpass == num_subpasses);
+      if (!transfers_at_boundary &&
+          !NeedSynchronization(*prev_usage, curr_usage)) {
+        return;
+      }
+      barriers[subpass].push_back(UsageTransition{
+          image_name, prev_usage_subpass, *prev_usage, curr_usage});
+    };
+
+    const auto& usage_map = history.usage_at_subpass_map();
+    for (auto iter = usage_map.lower_bound(0);
+         iter != usage_map.end() && iter->first < num_subpasses; ++iter) {
+      add_transition(/*subpass=*/iter->first, /*curr_usage=*/iter->second);
+      prev_usage_subpass = iter->first;
+      prev_usage = &iter->second;
+    }
+    if (history.final_usage().has_value()) {
+      add_transition(/*subpass=*/num_subpasses,
+                     /*curr_usage=*/history.final_usage().value());
+    }
+  }
+
+  for (auto& transitions : barriers) {
+    SortByImageName(transitions);
+  }
+  return barriers;
+}
+
+}  // namespace lighter::renderer::ir::image
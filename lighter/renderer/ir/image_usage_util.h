@@ -0,0 +1,59 @@
+//
+//  image_usage_util.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_IR_IMAGE_USAGE_UTIL_H
+#define LIGHTER_RENDERER_IR_IMAGE_USAGE_UTIL_H
+
+#include <string>
+#include <vector>
+
+#include "lighter/renderer/ir/image_usage.h"
+#include "third_party/absl/container/flat_hash_map.h"
+
+namespace lighter::renderer::ir::image {
+
+// Maps image names to usage histories.
+using ImageUsageHistoryMap =
+    absl::flat_hash_map<std::string, ImageUsageHistory>;
+
+// Describes how the usage of one image changes at a subpass boundary.
+struct UsageTransition {
+  std::string image_name;
+
+  // Subpass where the image is previously used, or -1 if the previous usage is
+  // the initial usage.
+  int prev_usage_subpass;
+
+  ImageUsage prev_usage;
+  ImageUsage curr_usage;
+};
+
+// Returns true if memory accesses with 'prev_usage' must be synchronized with
+// later accesses with 'curr_usage'. Only read-after-read with the same usage
+// does not need synchronization.
+bool NeedSynchronization(const ImageUsage& prev_usage,
+                         const ImageUsage& curr_usage);
+
+// Returns usage transitions at each subpass boundary of a pass that has
+// 'num_subpasses' subpasses. The element at index i holds transitions before
+// subpass i, and the last element holds transitions to final usages after the
+// last subpass. All transitions at one boundary are meant to be performed by
+// one barrier command, and they are sorted by image names. Transitions that
+// don't need synchronization are skipped.
+// If 'transfers_ownership' is true, transitions from initial usages and to
+// final usages are always included in pipeline barriers, since they also
+// transfer the queue family ownership of images.
+// Only usages at subpasses in range [0, 'num_subpasses') are read from
+// 'usage_at_subpass_map()' of each history, and the initial and final usages
+// are read from 'initial_usage()' and 'final_usage()'.
+std::vector<std::vector<UsageTransition>> GetSubpassBarriers(
+    const ImageUsageHistoryMap& history_map, int num_subpasses,
+    bool transfers_ownership);
+
+}  // namespace lighter::renderer::ir::image
+
+#endif  // LIGHTER_RENDERER_IR_IMAGE_USAGE_UTIL_H
@@ -0,0 +1,178 @@
+//
+//  image_usage_util_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/ir/image_usage_util.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace lighter::renderer::ir::image {
+namespace {
+
+const ImageUsage kComputeRead =
+    ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadOnly);
+const ImageUsage kComputeWrite =
+    ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+const ImageUsage kComputeReadWrite =
+    ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadWrite);
+const ImageUsage kSampled = ImageUsage::GetSampledInFragmentShaderUsage();
+
+// Returns the number of transitions at each subpass boundary.
+std::vector<int> GetNumTransitions(
+    const std::vector<std::vector<UsageTransition>>& barriers) {
+  std::vector<int> num_transitions;
+  for (const auto& transitions : barriers) {
+    num_transitions.push_back(transitions.size());
+  }
+  return num_transitions;
+}
+
+// Returns names of images transitioned by 'transitions'.
+std::vector<std::string> GetImageNames(
+    const std::vector<UsageTransition>& transitions) {
+  std::vector<std::string> image_names;
+  for (const auto& transition : transitions) {
+    image_names.push_back(transition.image_name);
+  }
+  return image_names;
+}
+
+TEST(ImageUsageUtilTest, NeedSynchronization) {
+  EXPECT_FALSE(NeedSynchronization(kComputeRead, kComputeRead));
+  EXPECT_FALSE(NeedSynchronization(kSampled, kSampled));
+  EXPECT_TRUE(NeedSynchronization(kComputeRead, kSampled));
+  EXPECT_TRUE(NeedSynchronization(kComputeWrite, kComputeWrite));
+  EXPECT_TRUE(NeedSynchronization(kComputeReadWrite, kComputeReadWrite));
+  EXPECT_TRUE(NeedSynchronization(ImageUsage{}, kComputeRead));
+}
+
+TEST(ImageUsageUtilTest, BatchTransitionsAtSameBoundary) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"ping", std::move(ImageUsageHistory{}
+                                            .AddUsage(0, kComputeWrite)
+                                            .AddUsage(1, kComputeRead))});
+  history_map.insert({"pong", std::move(ImageUsageHistory{}
+                                            .AddUsage(0, kComputeWrite)
+                                            .AddUsage(1, kComputeRead))});
+  history_map.insert({"output", std::move(ImageUsageHistory{}
+                                              .AddUsage(1, kComputeWrite)
+                                              .SetFinalUsage(kSampled))});
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/2,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{2, 3, 1}));
+  EXPECT_EQ(GetImageNames(barriers[0]),
+            (std::vector<std::string>{"ping", "pong"}));
+  EXPECT_EQ(GetImageNames(barriers[1]),
+            (std::vector<std::string>{"output", "ping", "pong"}));
+  EXPECT_EQ(GetImageNames(barriers[2]),
+            std::vector<std::string>{"output"});
+}
+
+TEST(ImageUsageUtilTest, SkipReadAfterRead) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"texture", std::move(ImageUsageHistory{kComputeRead}
+                                               .AddUsage(0, 2, kComputeRead)
+                                               .SetFinalUsage(kComputeRead))});
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/3,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{0, 0, 0, 0}));
+}
+
+TEST(ImageUsageUtilTest, SkipReadAfterReadInBatch) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"texture", std::move(ImageUsageHistory{kComputeRead}
+                                               .AddUsage(0, 1, kComputeRead))});
+  history_map.insert({"output", std::move(ImageUsageHistory{}
+                                              .AddUsage(0, 1, kComputeWrite))});
+
+  // Write-after-write of "output" needs a barrier at subpass 1, while
+  // read-after-read of "texture" is skipped.
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/2,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{1, 1, 0}));
+  EXPECT_EQ(GetImageNames(barriers[0]), std::vector<std::string>{"output"});
+  EXPECT_EQ(GetImageNames(barriers[1]), std::vector<std::string>{"output"});
+}
+
+TEST(ImageUsageUtilTest, TransitionAcrossSubpasses) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"early", std::move(ImageUsageHistory{}
+                                             .AddUsage(0, kComputeWrite)
+                                             .AddUsage(2, kComputeRead))});
+  history_map.insert({"middle", std::move(ImageUsageHistory{}
+                                              .AddUsage(1, kComputeWrite))});
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/3,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{1, 1, 1, 0}));
+  ASSERT_EQ(barriers[2].size(), 1);
+  const auto& transition = barriers[2][0];
+  EXPECT_EQ(transition.image_name, "early");
+  EXPECT_EQ(transition.prev_usage_subpass, 0);
+  EXPECT_EQ(transition.prev_usage, kComputeWrite);
+  EXPECT_EQ(transition.curr_usage, kComputeRead);
+}
+
+TEST(ImageUsageUtilTest, BatchTransitionsFromDifferentSubpasses) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"early", std::move(ImageUsageHistory{}
+                                             .AddUsage(0, kComputeWrite)
+                                             .AddUsage(2, kComputeRead))});
+  history_map.insert({"late", std::move(ImageUsageHistory{}
+                                            .AddUsage(1, kComputeWrite)
+                                            .AddUsage(2, kComputeRead))});
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/3,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{1, 1, 2, 0}));
+  EXPECT_EQ(GetImageNames(barriers[2]),
+            (std::vector<std::string>{"early", "late"}));
+}
+
+TEST(ImageUsageUtilTest, TransferOwnership) {
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"texture", std::move(ImageUsageHistory{kComputeRead}
+                                               .AddUsage(2, kComputeRead)
+                                               .SetFinalUsage(kComputeRead))});
+
+  // Without ownership transfer, no barrier is needed.
+  EXPECT_EQ(GetNumTransitions(GetSubpassBarriers(
+                history_map, /*num_subpasses=*/3,
+                /*transfers_ownership=*/false)),
+            (std::vector<int>{0, 0, 0, 0}));
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/3,
+                                           /*transfers_ownership=*/true);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{0, 0, 1, 1}));
+  ASSERT_EQ(barriers[2].size(), 1);
+  EXPECT_EQ(barriers[2][0].prev_usage_subpass, -1);
+  ASSERT_EQ(barriers[3].size(), 1);
+  EXPECT_EQ(barriers[3][0].prev_usage_subpass, 2);
+}
+
+TEST(ImageUsageUtilTest, IgnoreVirtualSubpasses) {
+  // Passes may store initial and final usages at subpass -1 and
+  // 'num_subpasses' respectively.
+  auto history = ImageUsageHistory{kSampled};
+  history.AddUsage(0, kComputeWrite).SetFinalUsage(kSampled);
+  history.AddUsage(-1, history.initial_usage())
+      .AddUsage(1, history.final_usage().value());
+  ImageUsageHistoryMap history_map;
+  history_map.insert({"image", std::move(history)});
+
+  const auto barriers = GetSubpassBarriers(history_map, /*num_subpasses=*/1,
+                                           /*transfers_ownership=*/false);
+  EXPECT_EQ(GetNumTransitions(barriers), (std::vector<int>{1, 1}));
+  EXPECT_EQ(barriers[0][0].prev_usage, kSampled);
+  EXPECT_EQ(barriers[1][0].prev_usage, kComputeWrite);
+}
+
+}  // namespace
+}  // namespace lighter::renderer::ir::image
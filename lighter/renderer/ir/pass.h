@@ -13,6 +13,7 @@
 
 #include "lighter/common/util.h"
 #include "lighter/renderer/ir/image.h"
+#include "lighter/renderer/ir/image_usage.h"
 #include "lighter/renderer/ir/pipeline.h"
 #include "lighter/renderer/ir/type.h"
 #include "third_party/absl/container/flat_hash_map.h"
@@ -100,10 +101,13 @@ struct RenderPassDescriptor {
 };
 
 struct ComputePassDescriptor {
- public:
-  // This class provides copy constructor and move constructor.
-  ComputePassDescriptor(ComputePassDescriptor&&) noexcept = default;
-  ComputePassDescriptor(const ComputePassDescriptor&) = default;
+  ComputePassDescriptor& AddImageUsage(const Image* image,
+                                       const ImageUsage& usage) {
+    image_usages.insert({FATAL_IF_NULL(image), usage});
+    return *this;
+  }
+
+  absl::flat_hash_map<const Image*, ImageUsage> image_usages;
 };
 
 class RenderPass {
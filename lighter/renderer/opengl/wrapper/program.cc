@@ -49,7 +49,7 @@ std::optional<std::vector<char>> CheckStatus(GLuint source, GLenum target,
 
 Shader::Shader(GLenum shader_type, const std::string& file_path)
     : shader_type_{shader_type}, shader_{glCreateShader(shader_type)} {
-  const common::Data file_data = common::file::LoadDataFromFile(file_path);
+  const common::MappedData file_data{file_path};
   glShaderBinary(/*count=*/1, &shader_, GL_SHADER_BINARY_FORMAT_SPIR_V,
                  file_data.data<char>(), file_data.size());
   glSpecializeShader(shader_, "main", /*numSpecializationConstants=*/0,
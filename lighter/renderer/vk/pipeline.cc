@@ -265,7 +265,7 @@ intl::PipelineColorBlendStateCreateInfo GetColorBlendStateCreateInfo(
 ShaderModule::ShaderModule(const SharedContext& context,
                            std::string_view file_path)
     : WithSharedContext{context} {
-  const common::Data file_data = common::file::LoadDataFromFile(file_path);
+  const common::MappedData file_data{file_path};
   const auto shader_module_create_info = intl::ShaderModuleCreateInfo{}
       .setCodeSize(file_data.size())
       .setPCode(file_data.data<uint32_t>());
@@ -83,25 +83,30 @@ const ImageUsage* BasePass::GetImageUsage(const std::string& image_name,
   return iter != history.usage_at_subpass_map().end() ? &iter->second : nullptr;
 }
 
-std::optional<BasePass::ImageUsagesInfo>
-BasePass::GetImageUsagesIfNeedSynchronization(
+std::optional<BasePass::ImageUsagesInfo> BasePass::GetImageUsages(
     const std::string& image_name, int subpass) const {
   ValidateSubpass(subpass, image_name, /*include_virtual_subpasses=*/true);
   const ImageUsageHistory& history = GetUsageHistory(image_name);
   const auto curr_usage_iter = history.usage_at_subpass_map().find(subpass);
-  if (curr_usage_iter == history.usage_at_subpass_map().end()) {
+  if (curr_usage_iter == history.usage_at_subpass_map().end() ||
+      curr_usage_iter == history.usage_at_subpass_map().begin()) {
     return std::nullopt;
   }
   const auto prev_usage_iter = std::prev(curr_usage_iter);
+  return ImageUsagesInfo{/*prev_usage_subpass=*/prev_usage_iter->first,
+                         &prev_usage_iter->second, &curr_usage_iter->second};
+}
 
-  const ImageUsage& prev_usage = prev_usage_iter->second;
-  const ImageUsage& curr_usage = curr_usage_iter->second;
-  if (!image::NeedSynchronization(prev_usage, curr_usage)) {
+std::optional<BasePass::ImageUsagesInfo>
+BasePass::GetImageUsagesIfNeedSynchronization(
+    const std::string& image_name, int subpass) const {
+  auto usages_info = GetImageUsages(image_name, subpass);
+  if (!usages_info.has_value() ||
+      !image::NeedSynchronization(usages_info->prev_usage,
+                                  usages_info->curr_usage)) {
     return std::nullopt;
   }
-
-  const int prev_usage_subpass = prev_usage_iter->first;
-  return ImageUsagesInfo{prev_usage_subpass, &prev_usage, &curr_usage};
+  return usages_info;
 }
 
 void BasePass::ValidateSubpass(int subpass,
@@ -83,6 +83,11 @@ class BasePass {
   const ImageUsage* GetImageUsage(const std::string& image_name,
                                   int subpass) const;
 
+  // Returns previous and current image usages info if the image is used at
+  // 'subpass'.
+  std::optional<ImageUsagesInfo> GetImageUsages(const std::string& image_name,
+                                                int subpass) const;
+
   // Returns previous and current image usages info if the image is used at
   // 'subpass' and synchronization on image memory access is needed,
   std::optional<ImageUsagesInfo> GetImageUsagesIfNeedSynchronization(
@@ -11,6 +11,7 @@
 #include <string>
 
 #include "lighter/common/util.h"
+#include "lighter/renderer/ir/image_usage_util.h"
 #include "lighter/renderer/vulkan/wrapper/image_util.h"
 #include "third_party/absl/strings/str_format.h"
 
@@ -27,44 +28,69 @@ ComputePass& ComputePass::AddImage(std::string&& image_name,
 
 void ComputePass::Run(
     const VkCommandBuffer& command_buffer, uint32_t queue_family_index,
-    const absl::flat_hash_map<std::string, const Image*>& image_map,
-    absl::Span<const ComputeOp> compute_ops) const {
+    const ImageMap& image_map, absl::Span<const ComputeOp> compute_ops,
+    std::optional<uint32_t> owner_queue_family_index) const {
   ASSERT_TRUE(compute_ops.size() == num_subpasses_,
               absl::StrFormat("Size of 'compute_ops' (%d) mismatches with the "
                               "number of subpasses (%d)",
                               compute_ops.size(), num_subpasses_));
 
-  // Run all subpasses and insert memory barriers. Note that even if the image
-  // usage does not change, we still need to insert a memory barrier if not RAR.
+  const bool transfers_ownership =
+      owner_queue_family_index.has_value() &&
+      owner_queue_family_index.value() != queue_family_index;
+  if (transfers_ownership) {
+    for (const auto& pair : image_usage_history_map()) {
+      ASSERT_HAS_VALUE(
+          pair.second.final_usage(),
+          absl::StrFormat("Final usage must be specified for image '%s' to "
+                          "transfer queue family ownership",
+                          pair.first));
+    }
+  }
+
+  // Note that even if the image usage does not change, we still need to insert
+  // a memory barrier if not RAR, or if the queue family ownership is
+  // transferred.
   ASSERT_TRUE(virtual_final_subpass_index() == num_subpasses_,
               "Assumption of the following loop is broken");
+  const auto subpass_barriers = ir::image::GetSubpassBarriers(
+      image_usage_history_map(), num_subpasses_, transfers_ownership);
+
   for (int subpass = 0; subpass <= num_subpasses_; ++subpass) {
-    for (const auto& pair : image_usage_history_map()) {
-      const std::string& image_name = pair.first;
-      const auto usages_info =
-          GetImageUsagesIfNeedSynchronization(image_name, subpass);
-      if (!usages_info.has_value()) {
-        continue;
+    // Ownership is acquired at the first usage in this pass, and released at
+    // the final usage.
+    image::BarrierBatch batch;
+    for (const auto& transition : subpass_barriers[subpass]) {
+      uint32_t src_queue_family_index = queue_family_index;
+      uint32_t dst_queue_family_index = queue_family_index;
+      if (transfers_ownership) {
+        if (transition.prev_usage_subpass == virtual_initial_subpass_index() &&
+            NeedTransferBeforePass(transition.image_name)) {
+          src_queue_family_index = owner_queue_family_index.value();
+        } else if (subpass == virtual_final_subpass_index()) {
+          dst_queue_family_index = owner_queue_family_index.value();
+        }
       }
-
-      const auto iter = image_map.find(image_name);
-      ASSERT_FALSE(iter == image_map.end(),
-                   absl::StrFormat("Image '%s' not provided in image map",
-                                   image_name));
-      InsertMemoryBarrier(command_buffer, queue_family_index, **iter->second,
-                          usages_info.value().prev_usage,
-                          usages_info.value().curr_usage);
+      image::AddMemoryBarrier(queue_family_index, src_queue_family_index,
+                              dst_queue_family_index,
+                              *GetImage(image_map, transition.image_name),
+                              transition.prev_usage, transition.curr_usage,
+                              &batch);
+    }
+    InsertPipelineBarrier(command_buffer, batch);
 
 #ifndef NDEBUG
+    const int num_barriers = batch.image_barriers.size();
+    if (num_barriers > 0) {
       const std::string log_suffix =
           subpass == virtual_final_subpass_index()
               ? "after compute pass"
               : absl::StrFormat("before subpass %d", subpass);
-      LOG_INFO << absl::StreamFormat("Inserted memory barrier for image '%s' ",
-                                     image_name)
+      LOG_INFO << absl::StreamFormat("Inserted %d image memory barriers ",
+                                     num_barriers)
                << log_suffix;
-#endif /* !NDEBUG */
     }
+#endif /* !NDEBUG */
 
     if (subpass < num_subpasses_) {
       compute_ops[subpass]();
@@ -72,40 +98,78 @@ void ComputePass::Run(
   }
 }
 
-void ComputePass::InsertMemoryBarrier(
-    const VkCommandBuffer& command_buffer, uint32_t queue_family_index,
-    const VkImage& image, const ImageUsage& prev_usage,
-    const ImageUsage& curr_usage) const {
-  const VkImageMemoryBarrier barrier{
-      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-      /*pNext=*/nullptr,
-      /*srcAccessMask=*/image::GetAccessFlags(prev_usage),
-      /*dstAccessMask=*/image::GetAccessFlags(curr_usage),
-      /*oldLayout=*/image::GetImageLayout(prev_usage),
-      /*newLayout=*/image::GetImageLayout(curr_usage),
-      /*srcQueueFamilyIndex=*/queue_family_index,
-      /*dstQueueFamilyIndex=*/queue_family_index,
-      image,
-      VkImageSubresourceRange{
-          VK_IMAGE_ASPECT_COLOR_BIT,
-          /*baseMipLevel=*/0,
-          /*levelCount=*/1,
-          /*baseArrayLayer=*/0,
-          /*layerCount=*/1,
-      },
-  };
+void ComputePass::ReleaseImagesBeforePass(
+    const VkCommandBuffer& command_buffer, uint32_t owner_queue_family_index,
+    uint32_t queue_family_index, const ImageMap& image_map) const {
+  image::BarrierBatch batch;
+  for (const auto& pair : image_usage_history_map()) {
+    const std::string& image_name = pair.first;
+    if (!NeedTransferBeforePass(image_name)) {
+      continue;
+    }
+    const int first_subpass =
+        std::next(pair.second.usage_at_subpass_map().begin())->first;
+    const auto usages_info = GetImageUsages(image_name, first_subpass);
+    image::AddMemoryBarrier(
+        owner_queue_family_index, owner_queue_family_index,
+        queue_family_index, *GetImage(image_map, image_name),
+        usages_info->prev_usage, usages_info->curr_usage, &batch);
+  }
+  InsertPipelineBarrier(command_buffer, batch);
+}
+
+void ComputePass::AcquireImagesAfterPass(
+    const VkCommandBuffer& command_buffer, uint32_t owner_queue_family_index,
+    uint32_t queue_family_index, const ImageMap& image_map) const {
+  image::BarrierBatch batch;
+  for (const auto& pair : image_usage_history_map()) {
+    const std::string& image_name = pair.first;
+    const auto usages_info =
+        GetImageUsages(image_name, virtual_final_subpass_index());
+    ASSERT_HAS_VALUE(
+        usages_info,
+        absl::StrFormat("Final usage must be specified for image '%s' to "
+                        "transfer queue family ownership",
+                        image_name));
+    image::AddMemoryBarrier(
+        owner_queue_family_index, queue_family_index,
+        owner_queue_family_index, *GetImage(image_map, image_name),
+        usages_info->prev_usage, usages_info->curr_usage, &batch);
+  }
+  InsertPipelineBarrier(command_buffer, batch);
+}
 
+void ComputePass::InsertPipelineBarrier(const VkCommandBuffer& command_buffer,
+                                        const image::BarrierBatch& batch) {
+  if (batch.image_barriers.empty()) {
+    return;
+  }
   vkCmdPipelineBarrier(
       command_buffer,
-      /*srcStageMask=*/image::GetPipelineStageFlags(prev_usage),
-      /*dstStageMask=*/image::GetPipelineStageFlags(curr_usage),
+      batch.src_stage_flags,
+      batch.dst_stage_flags,
       /*dependencyFlags=*/0,
       /*memoryBarrierCount=*/0,
       /*pMemoryBarriers=*/nullptr,
       /*bufferMemoryBarrierCount=*/0,
       /*pBufferMemoryBarriers=*/nullptr,
-      /*imageMemoryBarrierCount=*/1,
-      &barrier);
+      CONTAINER_SIZE(batch.image_barriers),
+      batch.image_barriers.data());
+}
+
+bool ComputePass::NeedTransferBeforePass(const std::string& image_name) const {
+  // Content is discarded if the initial layout is undefined.
+  return image::GetImageLayout(GetUsageHistory(image_name).initial_usage()) !=
+         VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+const Image& ComputePass::GetImage(const ImageMap& image_map,
+                                   const std::string& image_name) const {
+  const auto iter = image_map.find(image_name);
+  ASSERT_FALSE(iter == image_map.end(),
+               absl::StrFormat("Image '%s' not provided in image map",
+                               image_name));
+  return *iter->second;
 }
 
 void ComputePass::ValidateUsageHistory(
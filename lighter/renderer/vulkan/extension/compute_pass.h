@@ -9,11 +9,15 @@
 #define LIGHTER_RENDERER_VULKAN_EXTENSION_COMPUTE_PASS_H
 
 #include <functional>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "lighter/renderer/ir/image_usage.h"
 #include "lighter/renderer/vulkan/extension/base_pass.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
+#include "lighter/renderer/vulkan/wrapper/image_util.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
 #include "third_party/absl/container/flat_hash_map.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/vulkan/vulkan.h"
@@ -26,6 +30,22 @@ namespace vulkan {
 // compute shader invocations, so that we can insert memory barriers to
 // transition image layouts whenever necessary. One subpass may contain several
 // compute shader invocations, and we won't insert barriers in the middle.
+//
+// Images are created with exclusive ownership of one queue family. If this pass
+// runs on a different queue family (e.g. a dedicated compute queue) from the
+// one that uses images before and after it (the owner queue family), the user
+// should transfer the ownership of images in this way:
+//   (1) Call ReleaseImagesBeforePass() with a command buffer of the owner
+//       queue.
+//   (2) Call Run() with a command buffer of the compute queue, and specify the
+//       owner queue family. The submission should wait for (1) via semaphore.
+//   (3) Call AcquireImagesAfterPass() with a command buffer of the owner queue.
+//       The submission should wait for (2) via semaphore.
+// Images whose initial usage does not preserve content are not released in
+// (1), and all images must have final usages specified.
+//
+// All transitions needed at one subpass boundary are recorded with one barrier
+// command.
 class ComputePass : public BasePass {
  public:
   // Specifies compute operations to perform in one subpass.
@@ -45,23 +65,53 @@ class ComputePass : public BasePass {
     return AddImage(std::string{image_name}, std::move(history));
   }
 
+  // Maps image names to images.
+  using ImageMap = absl::flat_hash_map<std::string, const Image*>;
+
   // Runs 'compute_ops' and inserts memory barriers internally for transitioning
   // image layouts using the queue with 'queue_family_index'.
   // 'image_map' should include all images used in this compute pass.
   // The size of 'compute_ops' must be equal to the number of subpasses.
+  // If 'owner_queue_family_index' is specified and different from
+  // 'queue_family_index', the ownership of images is acquired from it before
+  // the first subpass, and released to it after the last subpass.
   // This should be called when 'command_buffer' is recording commands.
-  // TODO: Handle queue transfer
   void Run(const VkCommandBuffer& command_buffer, uint32_t queue_family_index,
-           const absl::flat_hash_map<std::string, const Image*>& image_map,
-           absl::Span<const ComputeOp> compute_ops) const;
+           const ImageMap& image_map, absl::Span<const ComputeOp> compute_ops,
+           std::optional<uint32_t> owner_queue_family_index =
+               std::nullopt) const;
+
+  // Releases the ownership of images from the queue with
+  // 'owner_queue_family_index' to the queue with 'queue_family_index', which
+  // will run this compute pass. This should be called when 'command_buffer' of
+  // the owner queue is recording commands.
+  void ReleaseImagesBeforePass(const VkCommandBuffer& command_buffer,
+                               uint32_t owner_queue_family_index,
+                               uint32_t queue_family_index,
+                               const ImageMap& image_map) const;
+
+  // Acquires the ownership of images from the queue with 'queue_family_index',
+  // which has run this compute pass, for the queue with
+  // 'owner_queue_family_index'. This should be called when 'command_buffer' of
+  // the owner queue is recording commands.
+  void AcquireImagesAfterPass(const VkCommandBuffer& command_buffer,
+                              uint32_t owner_queue_family_index,
+                              uint32_t queue_family_index,
+                              const ImageMap& image_map) const;
 
  private:
-  // Inserts a memory barrier for transitioning the layout of 'image' using the
-  // queue with 'queue_family_index'.
-  void InsertMemoryBarrier(const VkCommandBuffer& command_buffer,
-                           uint32_t queue_family_index, const VkImage& image,
-                           const ImageUsage& prev_usage,
-                           const ImageUsage& curr_usage) const;
+  // Records all barriers in 'batch' with one pipeline barrier. This does
+  // nothing if 'batch' is empty.
+  static void InsertPipelineBarrier(const VkCommandBuffer& command_buffer,
+                                    const image::BarrierBatch& batch);
+
+  // Returns whether the content of image needs to be preserved when its
+  // ownership is transferred before this pass.
+  bool NeedTransferBeforePass(const std::string& image_name) const;
+
+  // Returns the image with 'image_name' in 'image_map'.
+  const Image& GetImage(const ImageMap& image_map,
+                        const std::string& image_name) const;
 
   // Checks whether image usages recorded in 'history' (excluding initial and
   // final usages) can be handled by this compute pass.
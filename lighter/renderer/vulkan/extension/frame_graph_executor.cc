@@ -0,0 +1,259 @@
+//
+//  frame_graph_executor.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/extension/frame_graph_executor.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "lighter/common/util.h"
+#include "lighter/renderer/vulkan/wrapper/image_util.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+#include "third_party/absl/strings/str_format.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+FrameGraphExecutor::FrameGraphExecutor(
+    const ir::FrameGraph& graph, uint32_t owner_queue_family_index,
+    const QueueFamilyIndexMap& pass_queue_family_indices) {
+  const ir::FrameGraph::CompiledGraph compiled_graph = graph.Compile();
+  ASSERT_TRUE(std::none_of(compiled_graph.transient_image_offsets.begin(),
+                           compiled_graph.transient_image_offsets.end(),
+                           [](const std::optional<uint64_t>& offset) {
+                             return offset.has_value();
+                           }),
+              "Transient images are not supported");
+
+  const auto get_queue_family_index = [&](PassHandle pass) {
+    const auto iter = pass_queue_family_indices.find(pass);
+    return iter == pass_queue_family_indices.end() ? owner_queue_family_index
+                                                   : iter->second;
+  };
+
+  // The first segment is always on the owner queue family, so that images can
+  // be released from it before passes on other queue families. It will be
+  // removed in the end if there is nothing to record.
+  segments_.push_back(Segment{owner_queue_family_index});
+
+  // Segments that last accessed each image. Imported images are regarded as
+  // accessed in the first segment before this graph.
+  std::vector<int> last_segments(graph.num_images(), 0);
+
+  for (const auto& scheduled_pass : compiled_graph.passes) {
+    const uint32_t queue_family_index =
+        get_queue_family_index(scheduled_pass.pass);
+    if (segments_.back().queue_family_index != queue_family_index) {
+      segments_.push_back(Segment{queue_family_index});
+    }
+    const int segment = num_segments() - 1;
+
+    absl::flat_hash_map<ImageHandle, const ir::FrameGraph::Barrier*>
+        barrier_map;
+    for (const auto& barrier : scheduled_pass.barriers) {
+      barrier_map.insert({barrier.image, &barrier});
+    }
+
+    Step step{scheduled_pass.pass};
+    for (const auto& access : graph.pass_accesses(scheduled_pass.pass)) {
+      const ImageHandle image = access.image;
+      const auto iter = barrier_map.find(image);
+      const bool needs_transition = iter != barrier_map.end();
+      // If no transition is needed, the usage does not change.
+      const ir::ImageUsage& prev_usage =
+          needs_transition ? iter->second->prev_usage : access.first_usage;
+
+      const int last_segment = last_segments[image];
+      if (segments_[last_segment].queue_family_index == queue_family_index) {
+        if (needs_transition) {
+          step.barriers.push_back(MakeBarrier(image, prev_usage,
+                                              access.first_usage,
+                                              access.reads));
+        }
+      } else if (access.reads) {
+        AddOwnershipTransfer(image, prev_usage, access.first_usage,
+                             last_segment, segment, &step.barriers);
+      } else {
+        // Previous accesses on the other queue family are ordered before this
+        // one by semaphores, and the content is discarded, so we don't need to
+        // transfer the ownership or wait for any stage.
+        Barrier barrier = MakeBarrier(image, prev_usage, access.first_usage,
+                                      /*preserves_content=*/false);
+        barrier.src_access_flags = kNullAccessFlag;
+        barrier.src_stage_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        step.barriers.push_back(barrier);
+      }
+      last_segments[image] = segment;
+    }
+    segments_.back().steps.push_back(std::move(step));
+  }
+
+  // Return images to the owner queue family and transition them to final
+  // usages.
+  absl::flat_hash_map<ImageHandle, const ir::FrameGraph::Barrier*>
+      final_barrier_map;
+  for (const auto& barrier : compiled_graph.final_barriers) {
+    final_barrier_map.insert({barrier.image, &barrier});
+  }
+  if (segments_.back().queue_family_index != owner_queue_family_index) {
+    segments_.push_back(Segment{owner_queue_family_index});
+  }
+  const int final_segment = num_segments() - 1;
+  for (ImageHandle image = 0; image < graph.num_images(); ++image) {
+    const auto iter = final_barrier_map.find(image);
+    const int last_segment = last_segments[image];
+    if (segments_[last_segment].queue_family_index ==
+        owner_queue_family_index) {
+      if (iter != final_barrier_map.end()) {
+        segments_[final_segment].trailing_barriers.push_back(MakeBarrier(
+            image, iter->second->prev_usage, iter->second->curr_usage,
+            /*preserves_content=*/true));
+      }
+      continue;
+    }
+
+    // If the usage does not change, we still need to transfer the ownership.
+    // Since we don't track the usage here, find it in the last pass that
+    // accessed this image.
+    std::optional<ir::ImageUsage> last_usage;
+    for (const auto& step : segments_[last_segment].steps) {
+      for (const auto& access : graph.pass_accesses(step.pass)) {
+        if (access.image == image) {
+          last_usage = access.last_usage;
+        }
+      }
+    }
+    ASSERT_HAS_VALUE(last_usage, "Failed to find the last usage of image");
+    AddOwnershipTransfer(
+        image, last_usage.value(),
+        iter != final_barrier_map.end() ? iter->second->curr_usage
+                                        : last_usage.value(),
+        last_segment, final_segment,
+        &segments_[final_segment].trailing_barriers);
+  }
+
+  segments_.erase(
+      std::remove_if(segments_.begin(), segments_.end(),
+                     [](const Segment& segment) {
+                       return segment.steps.empty() &&
+                              segment.trailing_barriers.empty();
+                     }),
+      segments_.end());
+}
+
+void FrameGraphExecutor::RecordSegment(int segment_index,
+                                       const VkCommandBuffer& command_buffer,
+                                       const ImageMap& image_map,
+                                       const PassOpMap& pass_ops) const {
+  const Segment& segment = segments_.at(segment_index);
+  for (const auto& step : segment.steps) {
+    InsertPipelineBarrier(command_buffer, image_map, step.barriers);
+    const auto iter = pass_ops.find(step.pass);
+    ASSERT_FALSE(iter == pass_ops.end(),
+                 absl::StrFormat("Operation of pass %d not provided",
+                                 step.pass));
+    iter->second(command_buffer);
+  }
+  InsertPipelineBarrier(command_buffer, image_map, segment.trailing_barriers);
+}
+
+FrameGraphExecutor::Barrier FrameGraphExecutor::MakeBarrier(
+    ImageHandle image, const ir::ImageUsage& prev_usage,
+    const ir::ImageUsage& curr_usage, bool preserves_content) {
+  return Barrier{
+      image,
+      image::GetAccessFlags(prev_usage),
+      image::GetAccessFlags(curr_usage),
+      image::GetPipelineStageFlags(prev_usage),
+      image::GetPipelineStageFlags(curr_usage),
+      /*old_layout=*/preserves_content ? image::GetImageLayout(prev_usage)
+                                       : VK_IMAGE_LAYOUT_UNDEFINED,
+      /*new_layout=*/image::GetImageLayout(curr_usage),
+      /*src_queue_family_index=*/VK_QUEUE_FAMILY_IGNORED,
+      /*dst_queue_family_index=*/VK_QUEUE_FAMILY_IGNORED,
+  };
+}
+
+void FrameGraphExecutor::AddOwnershipTransfer(
+    ImageHandle image, const ir::ImageUsage& prev_usage,
+    const ir::ImageUsage& curr_usage, int src_segment, int dst_segment,
+    std::vector<Barrier>* acquire_barriers) {
+  Barrier barrier = MakeBarrier(image, prev_usage, curr_usage,
+                                /*preserves_content=*/true);
+  barrier.src_queue_family_index = segments_[src_segment].queue_family_index;
+  barrier.dst_queue_family_index = segments_[dst_segment].queue_family_index;
+
+  // The release half only needs to make previous writes available, and the
+  // acquire half only needs to make them visible. Stages of the other half may
+  // not be supported by this queue, and the semaphore that orders the two
+  // halves provides the dependency.
+  Barrier release_barrier = barrier;
+  release_barrier.dst_access_flags = kNullAccessFlag;
+  release_barrier.dst_stage_flags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  segments_[src_segment].trailing_barriers.push_back(release_barrier);
+
+  Barrier acquire_barrier = barrier;
+  acquire_barrier.src_access_flags = kNullAccessFlag;
+  acquire_barrier.src_stage_flags = acquire_barrier.dst_stage_flags;
+  acquire_barriers->push_back(acquire_barrier);
+}
+
+void FrameGraphExecutor::InsertPipelineBarrier(
+    const VkCommandBuffer& command_buffer, const ImageMap& image_map,
+    const std::vector<Barrier>& barriers) {
+  if (barriers.empty()) {
+    return;
+  }
+
+  std::vector<VkImageMemoryBarrier> image_barriers;
+  image_barriers.reserve(barriers.size());
+  VkPipelineStageFlags src_stage_flags = nullflag;
+  VkPipelineStageFlags dst_stage_flags = nullflag;
+  for (const auto& barrier : barriers) {
+    const auto iter = image_map.find(barrier.image);
+    ASSERT_FALSE(iter == image_map.end(),
+                 absl::StrFormat("Image %d not provided in image map",
+                                 barrier.image));
+    image_barriers.push_back(VkImageMemoryBarrier{
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        /*pNext=*/nullptr,
+        barrier.src_access_flags,
+        barrier.dst_access_flags,
+        barrier.old_layout,
+        barrier.new_layout,
+        barrier.src_queue_family_index,
+        barrier.dst_queue_family_index,
+        **iter->second,
+        VkImageSubresourceRange{
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            /*baseMipLevel=*/0,
+            /*levelCount=*/1,
+            /*baseArrayLayer=*/0,
+            /*layerCount=*/1,
+        },
+    });
+    src_stage_flags |= barrier.src_stage_flags;
+    dst_stage_flags |= barrier.dst_stage_flags;
+  }
+
+  vkCmdPipelineBarrier(
+      command_buffer,
+      src_stage_flags,
+      dst_stage_flags,
+      /*dependencyFlags=*/0,
+      /*memoryBarrierCount=*/0,
+      /*pMemoryBarriers=*/nullptr,
+      /*bufferMemoryBarrierCount=*/0,
+      /*pBufferMemoryBarriers=*/nullptr,
+      CONTAINER_SIZE(image_barriers),
+      image_barriers.data());
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
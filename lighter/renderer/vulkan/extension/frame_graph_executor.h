@@ -0,0 +1,145 @@
+//
+//  frame_graph_executor.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_EXTENSION_FRAME_GRAPH_EXECUTOR_H
+#define LIGHTER_RENDERER_VULKAN_EXTENSION_FRAME_GRAPH_EXECUTOR_H
+
+#include <functional>
+#include <vector>
+
+#include "lighter/renderer/ir/frame_graph.h"
+#include "lighter/renderer/ir/image_usage.h"
+#include "lighter/renderer/vulkan/wrapper/image.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// This class records passes scheduled by ir::FrameGraph, and translates usage
+// transitions computed by it into image memory barriers.
+//
+// Each pass runs on a queue family. Consecutive scheduled passes on the same
+// queue family form a segment. The user should record each segment into a
+// command buffer of that queue family, and submit segments in order, where
+// each submission waits for the previous one via semaphore. If the content of
+// an image is needed on a different queue family, the ownership is released at
+// the end of the segment that last accessed it, and acquired before the pass
+// that needs it. Otherwise, the content is discarded when the image moves to
+// another queue family.
+//
+// Imported images are owned by the owner queue family before and after the
+// graph. If the last segment is not on that queue family, an extra segment
+// without passes is appended to acquire images back and transition them to
+// their final usages. Transient images are not supported yet, since this class
+// does not allocate memory for them.
+class FrameGraphExecutor {
+ public:
+  using ImageHandle = ir::FrameGraph::ImageHandle;
+  using PassHandle = ir::FrameGraph::PassHandle;
+
+  // Records commands of one pass.
+  using PassOp = std::function<void(const VkCommandBuffer& command_buffer)>;
+
+  // Maps image handles to images.
+  using ImageMap = absl::flat_hash_map<ImageHandle, const Image*>;
+
+  // Maps pass handles to operations.
+  using PassOpMap = absl::flat_hash_map<PassHandle, PassOp>;
+
+  // Maps pass handles to indices of queue families that run them.
+  using QueueFamilyIndexMap = absl::flat_hash_map<PassHandle, uint32_t>;
+
+  // Compiles 'graph'. Passes not in 'pass_queue_family_indices' run on the
+  // queue family with 'owner_queue_family_index'.
+  FrameGraphExecutor(const ir::FrameGraph& graph,
+                     uint32_t owner_queue_family_index,
+                     const QueueFamilyIndexMap& pass_queue_family_indices = {});
+
+  // This class is only movable.
+  FrameGraphExecutor(FrameGraphExecutor&&) noexcept = default;
+  FrameGraphExecutor& operator=(FrameGraphExecutor&&) noexcept = default;
+
+  // Records passes in the segment with 'segment_index', and barriers around
+  // them. 'image_map' should include all images used in the graph, and
+  // 'pass_ops' should include all passes that are not culled.
+  // This should be called when 'command_buffer' of the queue family returned by
+  // queue_family_index() is recording commands.
+  void RecordSegment(int segment_index, const VkCommandBuffer& command_buffer,
+                     const ImageMap& image_map,
+                     const PassOpMap& pass_ops) const;
+
+  // Accessors.
+  int num_segments() const { return static_cast<int>(segments_.size()); }
+  uint32_t queue_family_index(int segment_index) const {
+    return segments_.at(segment_index).queue_family_index;
+  }
+
+ private:
+  // Image memory barrier to record, which refers to an image handle.
+  struct Barrier {
+    ImageHandle image;
+    VkAccessFlags src_access_flags;
+    VkAccessFlags dst_access_flags;
+    VkPipelineStageFlags src_stage_flags;
+    VkPipelineStageFlags dst_stage_flags;
+    VkImageLayout old_layout;
+    VkImageLayout new_layout;
+    uint32_t src_queue_family_index;
+    uint32_t dst_queue_family_index;
+  };
+
+  // A pass to record, and barriers to insert before it.
+  struct Step {
+    PassHandle pass;
+    std::vector<Barrier> barriers;
+  };
+
+  // Passes recorded into one command buffer.
+  struct Segment {
+    uint32_t queue_family_index;
+    std::vector<Step> steps;
+
+    // Barriers to insert after all steps, which release images to other queue
+    // families, or transition images to their final usages.
+    std::vector<Barrier> trailing_barriers;
+  };
+
+  // Returns a barrier that transitions 'image' from 'prev_usage' to
+  // 'curr_usage' within one queue family. If 'preserves_content' is false, the
+  // image layout is transitioned from undefined.
+  static Barrier MakeBarrier(ImageHandle image,
+                             const ir::ImageUsage& prev_usage,
+                             const ir::ImageUsage& curr_usage,
+                             bool preserves_content);
+
+  // Adds barriers that transfer the ownership of 'image' from the queue family
+  // of segment 'src_segment' to that of segment 'dst_segment', and transition
+  // it from 'prev_usage' to 'curr_usage'. The release half is appended to
+  // trailing barriers of 'src_segment', and the acquire half is appended to
+  // 'acquire_barriers'.
+  void AddOwnershipTransfer(ImageHandle image, const ir::ImageUsage& prev_usage,
+                            const ir::ImageUsage& curr_usage, int src_segment,
+                            int dst_segment,
+                            std::vector<Barrier>* acquire_barriers);
+
+  // Records all 'barriers' with one pipeline barrier. This does nothing if
+  // 'barriers' is empty.
+  static void InsertPipelineBarrier(const VkCommandBuffer& command_buffer,
+                                    const ImageMap& image_map,
+                                    const std::vector<Barrier>& barriers);
+
+  // Segments in submission order.
+  std::vector<Segment> segments_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_EXTENSION_FRAME_GRAPH_EXECUTOR_H */
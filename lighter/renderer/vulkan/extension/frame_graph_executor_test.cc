@@ -0,0 +1,103 @@
+//
+//  frame_graph_executor_test.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/extension/frame_graph_executor.h"
+
+#include "gtest/gtest.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+using ir::AccessType;
+using ir::FrameGraph;
+using ir::ImageUsage;
+
+constexpr uint32_t kGraphicsFamilyIndex = 0;
+constexpr uint32_t kComputeFamilyIndex = 1;
+
+// Builds a graph like the one used for generating distance field: a render
+// pass on the graphics queue, followed by two compute passes, and the results
+// are sampled in fragment shaders afterwards.
+struct RasterThenCompute {
+  RasterThenCompute() {
+    const auto sampled_usage = ImageUsage::GetSampledInFragmentShaderUsage();
+    const auto read_usage =
+        ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadOnly);
+    const auto write_usage =
+        ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+    const auto read_write_usage =
+        ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadWrite);
+    const auto paths = graph.ImportImage("paths", sampled_usage, sampled_usage);
+    const auto field = graph.ImportImage("field", sampled_usage, sampled_usage);
+    render = graph.AddPass(
+        "render", {{field, ImageUsage::GetMultisampleResolveTargetUsage()}});
+    bold = graph.AddPass("bold", {{field, read_usage}, {paths, write_usage}});
+    generate = graph.AddPass("generate",
+                             {{paths, read_usage}, {field, read_write_usage}});
+  }
+
+  FrameGraph graph;
+  FrameGraph::PassHandle render;
+  FrameGraph::PassHandle bold;
+  FrameGraph::PassHandle generate;
+};
+
+TEST(FrameGraphExecutorTest, SingleQueueFamily) {
+  const RasterThenCompute graph;
+  const FrameGraphExecutor executor{graph.graph, kGraphicsFamilyIndex};
+  ASSERT_EQ(executor.num_segments(), 1);
+  EXPECT_EQ(executor.queue_family_index(0), kGraphicsFamilyIndex);
+}
+
+TEST(FrameGraphExecutorTest, SameFamilyForComputePasses) {
+  const RasterThenCompute graph;
+  const FrameGraphExecutor executor{
+      graph.graph, kGraphicsFamilyIndex,
+      {{graph.bold, kGraphicsFamilyIndex},
+       {graph.generate, kGraphicsFamilyIndex}}};
+  EXPECT_EQ(executor.num_segments(), 1);
+}
+
+TEST(FrameGraphExecutorTest, AsyncCompute) {
+  const RasterThenCompute graph;
+  const FrameGraphExecutor executor{
+      graph.graph, kGraphicsFamilyIndex,
+      {{graph.bold, kComputeFamilyIndex},
+       {graph.generate, kComputeFamilyIndex}}};
+
+  // Images are acquired back by the graphics queue in the last segment.
+  ASSERT_EQ(executor.num_segments(), 3);
+  EXPECT_EQ(executor.queue_family_index(0), kGraphicsFamilyIndex);
+  EXPECT_EQ(executor.queue_family_index(1), kComputeFamilyIndex);
+  EXPECT_EQ(executor.queue_family_index(2), kGraphicsFamilyIndex);
+}
+
+TEST(FrameGraphExecutorTest, DropEmptySegments) {
+  FrameGraph graph;
+  const auto image = graph.ImportImage(
+      "image", ImageUsage::GetSampledInFragmentShaderUsage());
+  const auto pass = graph.AddPass(
+      "write",
+      {{image, ImageUsage::GetLinearAccessInComputeShaderUsage(
+                   AccessType::kWriteOnly)}});
+  const FrameGraphExecutor executor{graph, kGraphicsFamilyIndex,
+                                    {{pass, kComputeFamilyIndex}}};
+
+  // The content is not read, hence nothing is released on the graphics queue
+  // before the compute pass. The ownership is still returned afterwards.
+  ASSERT_EQ(executor.num_segments(), 2);
+  EXPECT_EQ(executor.queue_family_index(0), kComputeFamilyIndex);
+  EXPECT_EQ(executor.queue_family_index(1), kGraphicsFamilyIndex);
+}
+
+} /* namespace */
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
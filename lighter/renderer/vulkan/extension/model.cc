@@ -8,6 +8,7 @@
 #include "lighter/renderer/vulkan/extension/model.h"
 
 #include "lighter/common/file.h"
+#include "lighter/common/mesh_cache.h"
 #include "lighter/renderer/ir/image_usage.h"
 #include "third_party/absl/strings/str_format.h"
 
@@ -139,11 +140,13 @@ void SetPipelineVertexInput(
 
 void ModelBuilder::SingleMeshResource::LoadMesh(ModelBuilder* builder) const {
   // Load indices and vertices.
-  const common::ObjFile file{obj_file_path_, obj_file_index_base_};
+  const auto mesh_cache = common::MeshCache::LoadObjFile(obj_file_path_,
+                                                         obj_file_index_base_);
+  const common::MeshCache::Mesh& mesh = mesh_cache->meshes()[0];
   VertexInfo vertex_info{
       /*per_mesh_infos=*/{{
-          PerVertexBuffer::VertexDataInfo{file.indices},
-          PerVertexBuffer::VertexDataInfo{file.vertices},
+          PerVertexBuffer::VertexDataInfo{mesh.indices},
+          PerVertexBuffer::VertexDataInfo{mesh.vertices},
       }},
   };
   builder->vertex_buffer_ = std::make_unique<StaticPerVertexBuffer>(
@@ -166,31 +169,42 @@ void ModelBuilder::SingleMeshResource::LoadMesh(ModelBuilder* builder) const {
 
 void ModelBuilder::MultiMeshResource::LoadMesh(ModelBuilder* builder) const {
   // Load indices and vertices.
-  const common::ModelLoader loader{model_path_, texture_dir_};
+  const auto mesh_cache = common::MeshCache::LoadModel(model_path_,
+                                                       texture_dir_);
   std::vector<VertexInfo::PerMeshInfo> per_mesh_infos;
-  per_mesh_infos.reserve(loader.mesh_datas().size());
-  for (const auto& mesh_data : loader.mesh_datas()) {
+  per_mesh_infos.reserve(mesh_cache->meshes().size());
+  for (const auto& mesh : mesh_cache->meshes()) {
     per_mesh_infos.push_back(VertexInfo::PerMeshInfo{
-        PerVertexBuffer::VertexDataInfo{mesh_data.indices},
-        PerVertexBuffer::VertexDataInfo{mesh_data.vertices},
+        PerVertexBuffer::VertexDataInfo{mesh.indices},
+        PerVertexBuffer::VertexDataInfo{mesh.vertices},
     });
   }
   builder->vertex_buffer_ = std::make_unique<StaticPerVertexBuffer>(
       builder->context_, VertexInfo{std::move(per_mesh_infos)},
       pipeline::GetVertexAttributes<Vertex3DWithTex>());
 
-  // Load textures.
+  // Load textures of all meshes together, so that images are decoded
+  // concurrently.
+  std::vector<SharedTexture::SourcePath> texture_paths;
+  for (const auto& mesh : mesh_cache->meshes()) {
+    for (const auto& texture : mesh.textures) {
+      texture_paths.push_back(texture.path);
+    }
+  }
   const auto image_usages = {ImageUsage::GetSampledInFragmentShaderUsage()};
+  std::vector<SharedTexture> textures = SharedTexture::LoadTextures(
+      builder->context_, texture_paths, image_usages, ImageSampler::Config{});
+
   auto& mesh_textures = builder->mesh_textures_;
-  mesh_textures.reserve(loader.mesh_datas().size());
-  for (const auto& mesh_data : loader.mesh_datas()) {
+  mesh_textures.reserve(mesh_cache->meshes().size());
+  int texture_index = 0;
+  for (const auto& mesh : mesh_cache->meshes()) {
     mesh_textures.push_back({});
-    for (const auto& texture : mesh_data.textures) {
-      const auto type_index = static_cast<int>(texture.texture_type);
+    for (const auto& texture : mesh.textures) {
+      const auto type_index = texture.type;
       mesh_textures.back()[type_index].push_back(
           std::make_unique<SharedTexture>(
-              builder->context_, texture.path, image_usages,
-              ImageSampler::Config{}));
+              std::move(textures[texture_index++])));
     }
   }
 }
@@ -331,11 +345,13 @@ std::unique_ptr<Model> ModelBuilder::Build() {
       std::move(descriptors), std::move(pipeline_builder_)}};
 }
 
-void Model::Update(bool is_object_opaque, const VkExtent2D& frame_size,
+void Model::Update(PipelineBuildJobs* pipeline_build_jobs,
+                   bool is_object_opaque, const VkExtent2D& frame_size,
                    VkSampleCountFlagBits sample_count,
                    const RenderPass& render_pass, uint32_t subpass_index,
                    bool flip_viewport_y) {
-  pipeline_ = (*pipeline_builder_)
+  FATAL_IF_NULL(pipeline_build_jobs);
+  (*pipeline_builder_)
       .SetDepthTestEnable(/*enable_test=*/true,
                           /*enable_write=*/is_object_opaque)
       .SetMultisampling(sample_count)
@@ -346,17 +362,19 @@ void Model::Update(bool is_object_opaque, const VkExtent2D& frame_size,
           std::vector<VkPipelineColorBlendAttachmentState>(
               render_pass.num_color_attachments(subpass_index),
               pipeline::GetColorAlphaBlendState(
-                  /*enable_blend=*/!is_object_opaque)))
-      .Build();
+                  /*enable_blend=*/!is_object_opaque)));
+  pipeline_ = pipeline_build_jobs->Add(pipeline_builder_);
 }
 
 void Model::Draw(const VkCommandBuffer& command_buffer,
-                 int frame, uint32_t instance_count) const {
-  ASSERT_NON_NULL(pipeline_, "Update() must have been called");
+                 int frame, uint32_t instance_count,
+                 uint32_t first_instance) const {
+  ASSERT_TRUE(pipeline_.is_valid(), "Update() must have been called");
   pipeline_->Bind(command_buffer);
   for (int i = 0; i < per_instance_buffers_.size(); ++i) {
     per_instance_buffers_[i]->Bind(
-        command_buffer, kPerInstanceBufferBindingPointBase + i, /*offset=*/0);
+        command_buffer, kPerInstanceBufferBindingPointBase + i,
+        /*offset=*/static_cast<int>(first_instance));
   }
   if (push_constant_info_.has_value()) {
     for (const auto& info : push_constant_info_->infos) {
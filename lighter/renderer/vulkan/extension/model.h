@@ -23,6 +23,7 @@
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/image.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline_util.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "third_party/absl/container/flat_hash_map.h"
@@ -254,15 +255,20 @@ class Model {
   // If 'flip_viewport_y' is true, point (0, 0) will be located at the upper
   // left corner, which is appropriate for presenting to the screen. The user
   // can choose whether or not to do the flipping for offscreen rendering.
-  void Update(bool is_object_opaque,
+  // The pipeline is built with 'pipeline_build_jobs', and Draw() blocks until
+  // it is ready. This must not be called again before that.
+  void Update(PipelineBuildJobs* pipeline_build_jobs, bool is_object_opaque,
               const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
               const RenderPass& render_pass, uint32_t subpass_index,
               bool flip_viewport_y = true);
 
-  // Renders the model.
+  // Renders the model. Instances before 'first_instance' are skipped, so that
+  // the user can render instances in different ranges with different command
+  // buffers.
   // This should be called when 'command_buffer' is recording commands.
   void Draw(const VkCommandBuffer& command_buffer,
-            int frame, uint32_t instance_count) const;
+            int frame, uint32_t instance_count,
+            uint32_t first_instance = 0) const;
 
  private:
   friend std::unique_ptr<Model> ModelBuilder::Build();
@@ -316,11 +322,11 @@ class Model {
   const std::vector<DescriptorsPerFrame> descriptors_;
 
   // The pipeline builder is preserved, so that the user may update it without
-  // rebuilding the entire model.
-  std::unique_ptr<GraphicsPipelineBuilder> pipeline_builder_;
+  // rebuilding the entire model. It is shared with pipeline build jobs.
+  const std::shared_ptr<GraphicsPipelineBuilder> pipeline_builder_;
 
   // Wrapper of VkPipeline.
-  std::unique_ptr<Pipeline> pipeline_;
+  PipelineHandle pipeline_;
 };
 
 } /* namespace vulkan */
@@ -90,8 +90,8 @@ Text::Text(const SharedBasicContext& context,
       vertex_buffer_{context, text::GetVertexDataSize(/*num_rects=*/1),
                      pipeline::GetVertexAttributes<Vertex2D>()},
       uniform_buffer_{context, sizeof(TextRenderInfo), num_frames_in_flight},
-      pipeline_builder_{context} {
-  pipeline_builder_
+      pipeline_builder_{std::make_shared<GraphicsPipelineBuilder>(context)} {
+  (*pipeline_builder_)
       .SetPipelineName(std::move(pipeline_name))
       .AddVertexInput(kVertexBufferBindingPoint,
                       pipeline::GetPerVertexBindingDescription<Vertex2D>(),
@@ -104,11 +104,13 @@ Text::Text(const SharedBasicContext& context,
                      "text/text.frag", common::api::GraphicsApi::kVulkan));
 }
 
-void Text::Update(const VkExtent2D& frame_size,
+void Text::Update(PipelineBuildJobs* pipeline_build_jobs,
+                  const VkExtent2D& frame_size,
                   VkSampleCountFlagBits sample_count,
                   const RenderPass& render_pass, uint32_t subpass_index,
                   bool flip_y) {
-  pipeline_ = pipeline_builder_
+  FATAL_IF_NULL(pipeline_build_jobs);
+  (*pipeline_builder_)
       .SetMultisampling(sample_count)
       .SetViewport(
           pipeline::GetViewport(frame_size, viewport_aspect_ratio_), flip_y)
@@ -116,8 +118,8 @@ void Text::Update(const VkExtent2D& frame_size,
       .SetColorBlend(
           std::vector<VkPipelineColorBlendAttachmentState>(
               render_pass.num_color_attachments(subpass_index),
-              pipeline::GetColorAlphaBlendState(/*enable_blend=*/true)))
-      .Build();
+              pipeline::GetColorAlphaBlendState(/*enable_blend=*/true)));
+  pipeline_ = pipeline_build_jobs->Add(pipeline_builder_);
 }
 
 int Text::UpdateBuffers(int frame, const glm::vec3& color, float alpha) {
@@ -140,7 +142,7 @@ int Text::UpdateBuffers(int frame, const glm::vec3& color, float alpha) {
 }
 
 void Text::SetPipelineLayout(const VkDescriptorSetLayout& layout) {
-  pipeline_builder_.SetPipelineLayout({layout}, /*push_constant_ranges=*/{});
+  pipeline_builder_->SetPipelineLayout({layout}, /*push_constant_ranges=*/{});
 }
 
 VkDescriptorBufferInfo Text::GetUniformBufferDescriptorInfo(int frame) const {
@@ -20,6 +20,7 @@
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 #include "lighter/renderer/vulkan/wrapper/descriptor.h"
 #include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
 #include "lighter/renderer/vulkan/wrapper/render_pass.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/glm/glm.hpp"
@@ -50,7 +51,10 @@ class Text {
   // If 'flip_y' is true, point (0, 0) will be located at the upper left corner,
   // which is appropriate for presenting to the screen. The user can choose
   // whether or not to do the flipping for offscreen rendering.
-  void Update(const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
+  // The pipeline is built with 'pipeline_build_jobs', and Draw() blocks until
+  // it is ready. This must not be called again before that.
+  void Update(PipelineBuildJobs* pipeline_build_jobs,
+              const VkExtent2D& frame_size, VkSampleCountFlagBits sample_count,
               const RenderPass& render_pass, uint32_t subpass_index,
               bool flip_y);
 
@@ -81,7 +85,7 @@ class Text {
   float viewport_aspect_ratio() const { return viewport_aspect_ratio_; }
   const PerVertexBuffer& vertex_buffer() const { return vertex_buffer_; }
   const Pipeline& pipeline() const {
-    ASSERT_NON_NULL(pipeline_, "Update() must have been called");
+    ASSERT_TRUE(pipeline_.is_valid(), "Update() must have been called");
     return *pipeline_;
   }
   std::vector<common::Vertex2D>* mutable_vertices() {
@@ -102,9 +106,9 @@ class Text {
   // Sends color and alpha to the shader.
   UniformBuffer uniform_buffer_;
 
-  // Graphics pipeline.
-  GraphicsPipelineBuilder pipeline_builder_;
-  std::unique_ptr<Pipeline> pipeline_;
+  // Graphics pipeline. The builder is shared with pipeline build jobs.
+  const std::shared_ptr<GraphicsPipelineBuilder> pipeline_builder_;
+  PipelineHandle pipeline_;
 };
 
 // This class renders each elements of 'texts' to one texture, so that later
@@ -17,6 +17,11 @@
 #include "lighter/common/ref_count.h"
 #include "lighter/common/util.h"
 #include "lighter/renderer/vulkan/wrapper/basic_object.h"
+#include "lighter/renderer/vulkan/wrapper/command_recycler.h"
+#include "lighter/renderer/vulkan/wrapper/descriptor_allocator.h"
+#include "lighter/renderer/vulkan/wrapper/device_memory.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline_cache.h"
+#include "lighter/renderer/vulkan/wrapper/uploader.h"
 #ifndef NDEBUG
 #include "lighter/renderer/vulkan/wrapper/validation.h"
 #endif /* !NDEBUG */
@@ -129,11 +134,23 @@ class BasicContext : public std::enable_shared_from_this<BasicContext> {
   const QueueFamilyIndices& queue_family_indices() const {
     return physical_device_.queue_family_indices();
   }
+  const VkPhysicalDeviceProperties& physical_device_properties() const {
+    return physical_device_.physical_device_properties();
+  }
   const VkPhysicalDeviceLimits& physical_device_limits() const {
     return physical_device_.physical_device_limits();
   }
   const Device& device() const { return device_; }
   const Queues& queues() const { return queues_; }
+  DeviceMemoryAllocator& device_memory_allocator() const {
+    return device_memory_allocator_;
+  }
+  StagingUploader& staging_uploader() const { return staging_uploader_; }
+  CommandRecycler& command_recycler() const { return command_recycler_; }
+  PipelineCache& pipeline_cache() const { return pipeline_cache_; }
+  DescriptorAllocator& descriptor_allocator() const {
+    return descriptor_allocator_;
+  }
 
  private:
   explicit BasicContext(
@@ -148,7 +165,12 @@ class BasicContext : public std::enable_shared_from_this<BasicContext> {
 #endif /* !NDEBUG */
         physical_device_{this, window_support},
         device_{this, window_support},
-        queues_{*this, queue_family_indices()} {}
+        queues_{*this, queue_family_indices()},
+        device_memory_allocator_{this},
+        staging_uploader_{this},
+        command_recycler_{this},
+        pipeline_cache_{this},
+        descriptor_allocator_{this} {}
 
   // Wrapper of VkAllocationCallbacks.
   const HostMemoryAllocator allocator_;
@@ -170,6 +192,28 @@ class BasicContext : public std::enable_shared_from_this<BasicContext> {
   // Wrapper of VkQueue.
   const Queues queues_;
 
+  // Sub-allocates VkDeviceMemory for buffers and images. This is internally
+  // synchronized, hence it can be used through a const context.
+  mutable DeviceMemoryAllocator device_memory_allocator_;
+
+  // Transfers data to device local buffers and images. This must be destructed
+  // before 'device_memory_allocator_', since it holds device memory. It is also
+  // internally synchronized.
+  mutable StagingUploader staging_uploader_;
+
+  // Recycles command buffers and fences used by one-time commands. This is
+  // internally synchronized.
+  mutable CommandRecycler command_recycler_;
+
+  // Pipeline cache shared by all pipelines. This is loaded from disk when the
+  // context is constructed, and written back when it is destructed. It is
+  // internally synchronized.
+  mutable PipelineCache pipeline_cache_;
+
+  // Allocates descriptor sets from shared descriptor pools, and caches
+  // descriptor set layouts. This is internally synchronized.
+  mutable DescriptorAllocator descriptor_allocator_;
+
   // Ops that are delayed to be executed until the graphics device becomes idle.
   std::vector<ReleaseExpiredResourceOp> release_expired_rsrc_ops_;
 
@@ -8,14 +8,20 @@
 #include "lighter/renderer/vulkan/wrapper/basic_object.h"
 
 #include <functional>
+#include <string>
 #include <vector>
 
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
 #ifndef NDEBUG
 #include "lighter/renderer/vulkan/wrapper/validation.h"
 #endif /* !NDEBUG */
+#include "third_party/absl/flags/flag.h"
 #include "third_party/absl/strings/str_cat.h"
 
+ABSL_FLAG(bool, use_timeline_semaphore, true,
+          "Use a timeline semaphore to track frames in flight if the device "
+          "supports VK_KHR_timeline_semaphore");
+
 namespace lighter {
 namespace renderer {
 namespace vulkan {
@@ -103,6 +109,50 @@ bool HasSwapchainSupport(const VkPhysicalDevice& physical_device,
   return format_count && mode_count;
 }
 
+// Returns whether 'physical_device' supports timeline semaphores.
+bool HasTimelineSemaphoreSupport(const VkInstance& instance,
+                                 const VkPhysicalDevice& physical_device) {
+  LOG_INFO << "Checking timeline semaphore support...";
+  LOG_INFO;
+
+  // Query support for the device extension.
+  const std::vector<std::string> required{
+      VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+  };
+  const auto extensions = util::QueryAttribute<VkExtensionProperties>(
+      [&physical_device](uint32_t* count, VkExtensionProperties* properties) {
+        return vkEnumerateDeviceExtensionProperties(
+            physical_device, /*pLayerName=*/nullptr, count, properties);
+      }
+  );
+  const auto get_name = [](const VkExtensionProperties& property) {
+    return property.extensionName;
+  };
+  const auto unsupported = util::FindUnsupported<VkExtensionProperties>(
+      required, extensions, get_name);
+  if (unsupported.has_value()) {
+    LOG_INFO << "Unsupported: " << unsupported.value();
+    return false;
+  }
+
+  // The extension may be exposed without the feature being supported.
+  const auto get_features =
+      util::LoadInstanceFunction<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+          instance, "vkGetPhysicalDeviceFeatures2KHR");
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features{
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+      /*pNext=*/nullptr,
+      /*timelineSemaphore=*/VK_FALSE,
+  };
+  VkPhysicalDeviceFeatures2KHR features{
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+      &timeline_features,
+      /*features=*/{},
+  };
+  get_features(physical_device, &features);
+  return timeline_features.timelineSemaphore == VK_TRUE;
+}
+
 // Finds family indices of queues we need. If any queue is not found in the
 // given 'physical_device', returns std::nullopt.
 // The graphics queue will also be used as transfer queue.
@@ -149,12 +199,24 @@ std::optional<QueueFamilyIndices> FindDeviceQueues(
         static_cast<uint32_t>(graphics_queue_index.value());
   }
 
+  // Prefer a queue family that supports compute but not graphics, so that
+  // compute work can run asynchronously with graphics work.
   const auto has_compute_support = [](const VkQueueFamilyProperties& family) {
     return family.queueCount && (family.queueFlags & VK_QUEUE_COMPUTE_BIT);
   };
-  const auto compute_queue_index =
+  const auto has_async_compute_support =
+      [&has_compute_support](const VkQueueFamilyProperties& family) {
+        return has_compute_support(family) &&
+               !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+      };
+  auto compute_queue_index =
       common::util::FindIndexOfFirstIf<VkQueueFamilyProperties>(
-          families, has_compute_support);
+          families, has_async_compute_support);
+  if (!compute_queue_index.has_value()) {
+    compute_queue_index =
+        common::util::FindIndexOfFirstIf<VkQueueFamilyProperties>(
+            families, has_compute_support);
+  }
   if (!compute_queue_index.has_value()) {
     return std::nullopt;
   } else {
@@ -291,13 +353,13 @@ PhysicalDevice::PhysicalDevice(
       physical_device_ = candidate;
       queue_family_indices_ = indices.value();
 
-      // Query physical device limits.
-      VkPhysicalDeviceProperties properties;
-      vkGetPhysicalDeviceProperties(physical_device_, &properties);
-      physical_device_limits_ = properties.limits;
+      // Query physical device properties.
+      vkGetPhysicalDeviceProperties(physical_device_,
+                                    &physical_device_properties_);
 
       // Prefer discrete GPUs.
-      if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
+      if (physical_device_properties_.deviceType ==
+              VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
         LOG_INFO << "Use this discrete GPU";
         return;
       } else {
@@ -313,7 +375,7 @@ PhysicalDevice::PhysicalDevice(
 
 Device::Device(const BasicContext* context,
                const std::optional<WindowSupport>& window_support)
-    : context_{FATAL_IF_NULL(context)} {
+    : context_{FATAL_IF_NULL(context)}, timeline_semaphore_enabled_{false} {
   if (window_support.has_value()) {
     ASSERT_HAS_VALUE(context_->queue_family_indices().present,
                      "Presentation queue is not properly set up");
@@ -335,6 +397,19 @@ Device::Device(const BasicContext* context,
         window_support->swapchain_extensions.begin(),
         window_support->swapchain_extensions.end());
   }
+  // Request support for timeline semaphores if available, which are used to
+  // track frames in flight. Otherwise, we fall back to fences.
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features{
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+      /*pNext=*/nullptr,
+      /*timelineSemaphore=*/VK_TRUE,
+  };
+  if (absl::GetFlag(FLAGS_use_timeline_semaphore) &&
+      HasTimelineSemaphoreSupport(*context_->instance(),
+                                  *context_->physical_device())) {
+    device_extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    timeline_semaphore_enabled_ = true;
+  }
 
   // Specify which queue we want to use.
   std::vector<VkDeviceQueueCreateInfo> queue_infos;
@@ -353,7 +428,7 @@ Device::Device(const BasicContext* context,
 
   const VkDeviceCreateInfo device_info{
       VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-      /*pNext=*/nullptr,
+      timeline_semaphore_enabled_ ? &timeline_features : nullptr,
       /*flags=*/nullflag,
       CONTAINER_SIZE(queue_infos),
       queue_infos.data(),
@@ -391,10 +466,26 @@ Queues::Queues(const BasicContext& context,
 }
 
 void Queues::SetQueue(const VkDevice& device, uint32_t family_index,
-                      Queue* queue) const {
+                      Queue* queue) {
   constexpr int kQueueIndex = 0;
   queue->family_index = family_index;
   vkGetDeviceQueue(device, family_index, kQueueIndex, &queue->queue);
+  auto& mutex = queue_mutexes_[family_index];
+  if (mutex == nullptr) {
+    mutex = std::make_unique<std::mutex>();
+  }
+  queue->mutex = mutex.get();
+}
+
+VkResult Queues::Queue::Submit(const VkSubmitInfo& submit_info,
+                               VkFence fence) const {
+  const std::lock_guard<std::mutex> lock{*mutex};
+  return vkQueueSubmit(queue, /*submitCount=*/1, &submit_info, fence);
+}
+
+VkResult Queues::Queue::Present(const VkPresentInfoKHR& present_info) const {
+  const std::lock_guard<std::mutex> lock{*mutex};
+  return vkQueuePresentKHR(queue, &present_info);
 }
 
 } /* namespace vulkan */
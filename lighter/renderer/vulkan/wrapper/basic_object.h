@@ -8,10 +8,13 @@
 #ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_BASIC_OBJECT_H
 #define LIGHTER_RENDERER_VULKAN_WRAPPER_BASIC_OBJECT_H
 
+#include <memory>
+#include <mutex>
 #include <optional>
 
 #include "lighter/common/util.h"
 #include "lighter/renderer/vulkan/wrapper/util.h"
+#include "third_party/absl/container/flat_hash_map.h"
 #include "third_party/vulkan/vulkan.h"
 
 namespace lighter {
@@ -103,8 +106,11 @@ struct PhysicalDevice {
   const QueueFamilyIndices& queue_family_indices() const {
     return queue_family_indices_;
   }
+  const VkPhysicalDeviceProperties& physical_device_properties() const {
+    return physical_device_properties_;
+  }
   const VkPhysicalDeviceLimits& physical_device_limits() const {
-    return physical_device_limits_;
+    return physical_device_properties_.limits;
   }
 
  private:
@@ -117,8 +123,8 @@ struct PhysicalDevice {
   // Family indices for the queues we need.
   QueueFamilyIndices queue_family_indices_;
 
-  // Limits of the physical device.
-  VkPhysicalDeviceLimits physical_device_limits_;
+  // Properties of the physical device, including its limits.
+  VkPhysicalDeviceProperties physical_device_properties_;
 };
 
 // VkDevice interfaces with the physical device.
@@ -139,21 +145,42 @@ struct Device {
   // Overloads.
   const VkDevice& operator*() const { return device_; }
 
+  // Accessors.
+  bool timeline_semaphore_enabled() const {
+    return timeline_semaphore_enabled_;
+  }
+
  private:
   // Pointer to context.
   const BasicContext* context_;
 
   // Opaque device object.
   VkDevice device_;
+
+  // Whether VK_KHR_timeline_semaphore is enabled on 'device_'.
+  bool timeline_semaphore_enabled_;
 };
 
 // VkQueue is the queue associated with the logical device.
 class Queues {
  public:
-  // Holds an opaque queue object and its family index.
+  // Holds an opaque queue object and its family index. Since we use the first
+  // queue in each family, queues for different purposes may share the same
+  // VkQueue, which must be externally synchronized. Hence, all submissions and
+  // presentations should go through Submit() and Present(), which are
+  // thread-safe.
   struct Queue {
+    // Submits 'submit_info' to 'queue', and signals 'fence' when it finishes.
+    VkResult Submit(const VkSubmitInfo& submit_info, VkFence fence) const;
+
+    // Queues 'present_info' for presentation on 'queue'.
+    VkResult Present(const VkPresentInfoKHR& present_info) const;
+
     VkQueue queue;
     uint32_t family_index;
+
+    // Guards access to 'queue'. This is shared by all queues in the family.
+    std::mutex* mutex;
   };
 
   Queues(const BasicContext& context,
@@ -189,8 +216,11 @@ class Queues {
 
  private:
   // Populates 'queue' with the first queue in the family with 'family_index'.
-  void SetQueue(const VkDevice& device, uint32_t family_index,
-                Queue* queue) const;
+  void SetQueue(const VkDevice& device, uint32_t family_index, Queue* queue);
+
+  // Maps queue family indices to mutexes that guard the first queue in each
+  // family.
+  absl::flat_hash_map<uint32_t, std::unique_ptr<std::mutex>> queue_mutexes_;
 
   // Graphics queue.
   Queue graphics_queue_;
@@ -7,9 +7,10 @@
 
 #include "lighter/renderer/vulkan/wrapper/buffer.h"
 
+#include <algorithm>
 #include <cstring>
 
-#include "lighter/renderer/vulkan/wrapper/command.h"
+#include "lighter/renderer/vulkan/wrapper/uploader.h"
 #include "third_party/absl/strings/str_format.h"
 
 namespace lighter {
@@ -40,78 +41,65 @@ VkBuffer CreateBuffer(const BasicContext& context,
   return buffer;
 }
 
-// Allocates device memory for 'buffer' with 'memory_properties'.
-VkDeviceMemory CreateBufferMemory(const BasicContext& context,
-                                  const VkBuffer& buffer,
-                                  VkMemoryPropertyFlags memory_properties) {
+// Allocates device memory for 'buffer' with 'memory_properties', and binds it
+// with 'buffer'.
+DeviceMemoryAllocation CreateBufferMemory(
+    const BasicContext& context, const VkBuffer& buffer,
+    VkMemoryPropertyFlags memory_properties) {
   const VkDevice& device = *context.device();
 
   VkMemoryRequirements memory_requirements;
   vkGetBufferMemoryRequirements(device, buffer, &memory_requirements);
 
-  const VkMemoryAllocateInfo memory_info{
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-      /*pNext=*/nullptr,
-      /*allocationSize=*/memory_requirements.size,
-      util::FindMemoryTypeIndex(*context.physical_device(),
-                                memory_requirements.memoryTypeBits,
-                                memory_properties),
-  };
-
-  VkDeviceMemory memory;
-  ASSERT_SUCCESS(vkAllocateMemory(device, &memory_info,
-                                  *context.allocator(), &memory),
-                 "Failed to allocate buffer memory");
-
-  // Bind the allocated memory with 'buffer'. If this memory is used for
-  // multiple buffers, the memory offset should be re-calculated and
-  // VkMemoryRequirements.alignment should be considered.
-  vkBindBufferMemory(device, buffer, memory, /*memoryOffset=*/0);
-  return memory;
+  const DeviceMemoryAllocation allocation =
+      context.device_memory_allocator().Allocate(
+          memory_requirements, memory_properties,
+          DeviceMemoryAllocator::ResourceType::kBuffer);
+  vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+  return allocation;
 }
 
-// Maps device memory with the given 'map_offset' and 'map_size', and copies
-// data from the host according to 'copy_infos'.
-void CopyHostToBuffer(const BasicContext& context,
-                      VkDeviceSize map_offset,
-                      VkDeviceSize map_size,
-                      const VkDeviceMemory& device_memory,
+// Copies data from the host to 'device_memory' starting at 'map_offset',
+// according to 'copy_infos'. 'device_memory' must be host visible.
+void CopyHostToBuffer(VkDeviceSize map_offset,
+                      const DeviceMemoryAllocation& device_memory,
                       const std::vector<Buffer::CopyInfo>& copy_infos) {
-  // Data transfer may not happen immediately, for example, because it is only
-  // written to cache and not yet to device. We can either flush host writes
-  // with vkFlushMappedMemoryRanges and vkInvalidateMappedMemoryRanges, or
-  // use VK_MEMORY_PROPERTY_HOST_COHERENT_BIT (a little less efficient).
-  void* dst;
-  vkMapMemory(*context.device(), device_memory, map_offset, map_size,
-              /*flags=*/0, &dst);
+  // Host visible memory stays mapped. Data transfer may not happen
+  // immediately, for example, because it is only written to cache and not yet
+  // to device. We can either flush host writes with vkFlushMappedMemoryRanges
+  // and vkInvalidateMappedMemoryRanges, or use
+  // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT (a little less efficient).
+  char* dst =
+      static_cast<char*>(FATAL_IF_NULL(device_memory.mapped_data)) + map_offset;
   for (const auto& info : copy_infos) {
-    std::memcpy(static_cast<char*>(dst) + info.offset, info.data, info.size);
+    std::memcpy(dst + info.offset, info.data, info.size);
   }
-  vkUnmapMemory(*context.device(), device_memory);
 }
 
-} /* namespace */
-
-StagingBuffer::StagingBuffer(SharedBasicContext context,
-                             const CopyInfos& copy_infos)
-    : DataBuffer{std::move(FATAL_IF_NULL(context))},
-      data_size_{copy_infos.total_size} {
-  set_buffer(CreateBuffer(*context_, data_size_,
-                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          context_->queues().GetTransferQueueUsage()));
-  set_device_memory(CreateBufferMemory(
-      *context_, buffer(), kHostVisibleMemory));
-  CopyHostToBuffer(*context_, /*map_offset=*/0, /*map_size=*/data_size_,
-                   device_memory(), copy_infos.copy_infos);
+// Transfers data described by 'copy_infos' to 'target', which is only visible
+// to the device, via the staging uploader.
+void UploadToBuffer(const BasicContext& context,
+                    const Buffer::CopyInfos& copy_infos,
+                    const VkBuffer& target) {
+  context.staging_uploader().Upload(
+      copy_infos.total_size,
+      [&copy_infos](void* dst) { copy_infos.CopyToHostMemory(dst); },
+      [&copy_infos, &target](const VkCommandBuffer& command_buffer,
+                             const VkBuffer& staging_buffer,
+                             VkDeviceSize staging_offset) {
+        const VkBufferCopy region{staging_offset, /*dstOffset=*/0,
+                                  copy_infos.total_size};
+        vkCmdCopyBuffer(command_buffer, staging_buffer, target,
+                        /*regionCount=*/1, &region);
+      });
 }
 
-void StagingBuffer::CopyToBuffer(const VkBuffer& target) const {
-  const OneTimeCommand command{context_, &context_->queues().transfer_queue()};
-  command.Run([&](const VkCommandBuffer& command_buffer) {
-    const VkBufferCopy region{/*srcOffset=*/0, /*dstOffset=*/0, data_size_};
-    vkCmdCopyBuffer(command_buffer, buffer(), target,
-                    /*regionCount=*/1, &region);
-  });
+} /* namespace */
+
+void Buffer::CopyInfos::CopyToHostMemory(void* dst) const {
+  for (const auto& info : copy_infos) {
+    std::memcpy(static_cast<char*>(dst) + info.offset, info.data, info.size);
+  }
 }
 
 std::vector<VkVertexInputAttributeDescription> VertexBuffer::GetAttributes(
@@ -173,7 +161,7 @@ void DynamicBuffer::Reserve(size_t size) {
     vertex_buffer_->AddReleaseExpiredResourceOp(
         [buffer, device_memory](const BasicContext& context) {
           vkDestroyBuffer(*context.device(), buffer, *context.allocator());
-          vkFreeMemory(*context.device(), device_memory, *context.allocator());
+          context.device_memory_allocator().Free(device_memory);
         });
   }
   buffer_size_ = size;
@@ -316,15 +304,50 @@ StaticPerVertexBuffer::StaticPerVertexBuffer(
   const CopyInfos copy_infos = info.CreateCopyInfos(this);
   CreateBufferAndMemory(copy_infos.total_size, /*is_dynamic=*/false,
                         info.has_index_data());
-  const StagingBuffer staging_buffer(context_, copy_infos);
-  staging_buffer.CopyToBuffer(buffer());
+  UploadToBuffer(*context_, copy_infos, buffer());
 }
 
 void DynamicPerVertexBuffer::CopyHostData(const BufferDataInfo& info) {
   const CopyInfos copy_infos = info.CreateCopyInfos(this);
   Reserve(copy_infos.total_size);
-  CopyHostToBuffer(*context_, /*map_offset=*/0, /*map_size=*/buffer_size(),
-                   device_memory(), copy_infos.copy_infos);
+  CopyHostToBuffer(/*map_offset=*/0, device_memory(), copy_infos.copy_infos);
+}
+
+void DynamicPerVertexBuffer::CopyHostData(const BufferDataInfo& info,
+                                          VkDeviceSize dirty_offset,
+                                          VkDeviceSize dirty_size) {
+  const CopyInfos copy_infos = info.CreateCopyInfos(this);
+  const VkDeviceSize prev_buffer_size = buffer_size();
+  Reserve(copy_infos.total_size);
+  if (buffer_size() != prev_buffer_size) {
+    CopyHostToBuffer(/*map_offset=*/0, device_memory(), copy_infos.copy_infos);
+    return;
+  }
+
+  const VkDeviceSize dirty_end =
+      std::min(dirty_offset + dirty_size, copy_infos.total_size);
+  if (dirty_offset >= dirty_end) {
+    return;
+  }
+
+  // Only keep the part of each copy that falls into the dirty range. Offsets
+  // are relative to 'dirty_offset', since we only copy to that part of memory.
+  std::vector<CopyInfo> dirty_copy_infos;
+  dirty_copy_infos.reserve(copy_infos.copy_infos.size());
+  for (const auto& copy_info : copy_infos.copy_infos) {
+    const VkDeviceSize begin = std::max(copy_info.offset, dirty_offset);
+    const VkDeviceSize end =
+        std::min(copy_info.offset + copy_info.size, dirty_end);
+    if (begin < end) {
+      dirty_copy_infos.push_back(CopyInfo{
+          static_cast<const char*>(copy_info.data) + (begin - copy_info.offset),
+          /*size=*/end - begin,
+          /*offset=*/begin - dirty_offset,
+      });
+    }
+  }
+  CopyHostToBuffer(/*map_offset=*/dirty_offset, device_memory(),
+                   dirty_copy_infos);
 }
 
 void PerInstanceBuffer::Bind(const VkCommandBuffer& command_buffer,
@@ -346,8 +369,7 @@ StaticPerInstanceBuffer::StaticPerInstanceBuffer(
 
   const CopyInfos copy_infos{
       total_size, /*copy_infos=*/{CopyInfo{data, total_size, /*offset=*/0}}};
-  const StagingBuffer staging_buffer(context_, copy_infos);
-  staging_buffer.CopyToBuffer(buffer());
+  UploadToBuffer(*context_, copy_infos, buffer());
 }
 
 void DynamicPerInstanceBuffer::CopyHostData(
@@ -357,8 +379,7 @@ void DynamicPerInstanceBuffer::CopyHostData(
       total_size, /*copy_infos=*/{CopyInfo{data, total_size, /*offset=*/0}},
   };
   Reserve(total_size);
-  CopyHostToBuffer(*context_, /*map_offset=*/0, /*map_size=*/buffer_size(),
-                   device_memory(), copy_infos.copy_infos);
+  CopyHostToBuffer(/*map_offset=*/0, device_memory(), copy_infos.copy_infos);
 }
 
 UniformBuffer::UniformBuffer(SharedBasicContext context,
@@ -382,9 +403,8 @@ void UniformBuffer::Flush(int chunk_index) const {
   ValidateChunkIndex(chunk_index);
   const VkDeviceSize src_offset = chunk_data_size_ * chunk_index;
   const VkDeviceSize dst_offset = chunk_memory_size_ * chunk_index;
-  CopyHostToBuffer(
-      *context_, dst_offset, chunk_data_size_, device_memory(),
-      {{data_ + src_offset, chunk_data_size_, /*offset=*/0}});
+  CopyHostToBuffer(dst_offset, device_memory(),
+                   {{data_ + src_offset, chunk_data_size_, /*offset=*/0}});
 }
 
 void UniformBuffer::Flush(int chunk_index, VkDeviceSize data_size,
@@ -392,9 +412,8 @@ void UniformBuffer::Flush(int chunk_index, VkDeviceSize data_size,
   ValidateChunkIndex(chunk_index);
   const VkDeviceSize src_offset = chunk_data_size_ * chunk_index + offset;
   const VkDeviceSize dst_offset = chunk_memory_size_ * chunk_index + offset;
-  CopyHostToBuffer(
-      *context_, dst_offset, data_size, device_memory(),
-      {{data_ + src_offset, data_size, /*offset=*/0}});
+  CopyHostToBuffer(dst_offset, device_memory(),
+                   {{data_ + src_offset, data_size, /*offset=*/0}});
 }
 
 VkDescriptorBufferInfo UniformBuffer::GetDescriptorInfo(
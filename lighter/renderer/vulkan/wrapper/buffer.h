@@ -13,6 +13,7 @@
 
 #include "lighter/common/util.h"
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/device_memory.h"
 #include "lighter/renderer/vulkan/wrapper/util.h"
 #include "third_party/vulkan/vulkan.h"
 
@@ -22,8 +23,10 @@ namespace vulkan {
 
 // This is the base class of all buffer classes. The user should use it through
 // derived classes. Since all buffers need VkDeviceMemory, which is the handle
-// to the data stored in the device memory, it will be held and destroyed by
-// this base class, and initialized by derived classes.
+// to the data stored in the device memory, a range of it will be held and freed
+// by this base class, and initialized by derived classes. The range is
+// sub-allocated by DeviceMemoryAllocator, hence the memory may be shared with
+// other buffers.
 class Buffer {
  public:
   // Information we need to copy one chunk of memory from host to device.
@@ -39,6 +42,9 @@ class Buffer {
 
   // Information we need to copy multiple chunks of memory from host to device.
   struct CopyInfos {
+    // Copies all chunks to 'dst', which points to host visible memory.
+    void CopyToHostMemory(void* dst) const;
+
     VkDeviceSize total_size;
     std::vector<CopyInfo> copy_infos;
   };
@@ -48,7 +54,7 @@ class Buffer {
   Buffer& operator=(const Buffer&) = delete;
 
   virtual ~Buffer() {
-    vkFreeMemory(*context_->device(), device_memory_, *context_->allocator());
+    context_->device_memory_allocator().Free(device_memory_);
   }
 
  protected:
@@ -62,19 +68,21 @@ class Buffer {
   }
 
   // Modifiers.
-  void set_device_memory(const VkDeviceMemory& device_memory) {
+  void set_device_memory(const DeviceMemoryAllocation& device_memory) {
     device_memory_ = device_memory;
   }
 
   // Accessors.
-  const VkDeviceMemory& device_memory() const { return device_memory_; }
+  const DeviceMemoryAllocation& device_memory() const {
+    return device_memory_;
+  }
 
   // Pointer to context.
   const SharedBasicContext context_;
 
  private:
-  // Opaque device memory object.
-  VkDeviceMemory device_memory_;
+  // Range of device memory bound to this buffer.
+  DeviceMemoryAllocation device_memory_;
 };
 
 // This is the base class of the buffers that are used to store one dimensional
@@ -106,26 +114,6 @@ class DataBuffer : public Buffer {
   VkBuffer buffer_;
 };
 
-// This class creates a chunk of memory that is visible to both host and device,
-// used for transferring data from the host to some memory that is only visible
-// to the device. When construction is done, the data is already sent from the
-// host to the underlying buffer object.
-class StagingBuffer : public DataBuffer {
- public:
-  StagingBuffer(SharedBasicContext context, const CopyInfos& copy_infos);
-
-  // This class is neither copyable nor movable.
-  StagingBuffer(const StagingBuffer&) = delete;
-  StagingBuffer& operator=(const StagingBuffer&) = delete;
-
-  // Copies data from this buffer to the targeted buffer.
-  void CopyToBuffer(const VkBuffer& target) const;
-
- private:
-  // Size of data stored in this buffer.
-  const VkDeviceSize data_size_;
-};
-
 // This is the base class of vertex buffers, and provides shared utility
 // functions. The user should use it through derived classes.
 class VertexBuffer : public DataBuffer {
@@ -162,7 +150,7 @@ class VertexBuffer : public DataBuffer {
   // same buffer, hence only total size is needed.
   // If 'is_dynamic' is true, the buffer will be visible to the host, which can
   // be used for dynamic text rendering. Otherwise, the buffer will be only
-  // visible to the device, and we will use staging buffers to transfer data.
+  // visible to the device, and we will use StagingUploader to transfer data.
   void CreateBufferAndMemory(VkDeviceSize total_size, bool is_dynamic,
                              bool has_index_data);
 
@@ -346,7 +334,8 @@ class PerVertexBuffer : public VertexBuffer {
 };
 
 // This class creates a vertex buffer that stores static data, which will be
-// transferred to the device via the staging buffer.
+// transferred to the device via StagingUploader. The transfer is submitted no
+// later than the next command that may use this buffer.
 class StaticPerVertexBuffer : public PerVertexBuffer {
  public:
   StaticPerVertexBuffer(SharedBasicContext context, const BufferDataInfo& info,
@@ -381,6 +370,13 @@ class DynamicPerVertexBuffer : public PerVertexBuffer, public DynamicBuffer {
   // Copies host data to device. If the device buffer allocated previously is
   // not large enough to hold the new data, it will be recreated internally.
   void CopyHostData(const BufferDataInfo& info);
+
+  // Same as CopyHostData() above, but only copies data within
+  // [dirty_offset, dirty_offset + dirty_size) bytes of the buffer, assuming the
+  // rest of data is the same as the last time we copied. If the device buffer
+  // has to be recreated, all data will be copied.
+  void CopyHostData(const BufferDataInfo& info,
+                    VkDeviceSize dirty_offset, VkDeviceSize dirty_size);
 };
 
 // This is the base class of buffers storing per-instance data. The user should
@@ -411,7 +407,8 @@ class PerInstanceBuffer : public VertexBuffer {
 };
 
 // This class creates a vertex buffer that stores static data, which will be
-// transferred to the device via the staging buffer.
+// transferred to the device via StagingUploader. The transfer is submitted no
+// later than the next command that may use this buffer.
 class StaticPerInstanceBuffer : public PerInstanceBuffer {
  public:
   StaticPerInstanceBuffer(
@@ -7,7 +7,10 @@
 
 #include "lighter/renderer/vulkan/wrapper/command.h"
 
+#include <algorithm>
+#include <iterator>
 #include <limits>
+#include <thread>
 
 #include "lighter/renderer/vulkan/wrapper/util.h"
 #include "third_party/absl/strings/str_format.h"
@@ -19,6 +22,29 @@ namespace {
 
 constexpr auto kTimeoutForever = std::numeric_limits<uint64_t>::max();
 
+// Weight of the latest sample in moving averages of frame timing.
+constexpr float kStatsSmoothingFactor = 0.1f;
+
+// Frame pacing aims to submit commands this long (in seconds) before the device
+// becomes idle, so that small variations of CPU frame time don't stall it.
+constexpr float kPacingMargin = 0.001f;
+
+// Returns the length of interval between two time points in seconds.
+float TimeInterval(const std::chrono::steady_clock::time_point& t1,
+                   const std::chrono::steady_clock::time_point& t2) {
+  return std::chrono::duration<float>{t2 - t1}.count();
+}
+
+// Updates exponential moving average 'average' with 'sample'. If 'average' is
+// 0, it is initialized to 'sample'.
+void UpdateAverage(float sample, float* average) {
+  if (*average == 0.0f) {
+    *average = sample;
+  } else {
+    *average += (sample - *average) * kStatsSmoothingFactor;
+  }
+}
+
 // Creates a command pool on 'queue'. If 'is_transient' is true, the command
 // pool is expected to have a short lifetime.
 VkCommandPool CreateCommandPool(const BasicContext& context,
@@ -41,15 +67,16 @@ VkCommandPool CreateCommandPool(const BasicContext& context,
   return pool;
 }
 
-// Allocates command buffers of 'count' from 'command_pool'.
+// Allocates command buffers of 'count' and 'level' from 'command_pool'.
 std::vector<VkCommandBuffer> AllocateCommandBuffers(
     const BasicContext& context,
-    const VkCommandPool& command_pool, uint32_t count) {
+    const VkCommandPool& command_pool, uint32_t count,
+    VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
   const VkCommandBufferAllocateInfo buffer_info{
       VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
       /*pNext=*/nullptr,
       command_pool,
-      VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      level,
       count,
   };
 
@@ -60,16 +87,18 @@ std::vector<VkCommandBuffer> AllocateCommandBuffers(
   return buffers;
 }
 
-// Uses 'command_buffer' to record commands.
+// Uses 'command_buffer' to record commands. 'inheritance_info' must not be
+// nullptr if 'command_buffer' is a secondary command buffer.
 void RecordCommands(
     const VkCommandBuffer& command_buffer,
     VkCommandBufferUsageFlags usage_flags,
-    const std::function<void(const VkCommandBuffer&)>& on_record) {
+    const std::function<void(const VkCommandBuffer&)>& on_record,
+    const VkCommandBufferInheritanceInfo* inheritance_info = nullptr) {
   const VkCommandBufferBeginInfo begin_info{
       VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
       /*pNext=*/nullptr,
       usage_flags,
-      /*pInheritanceInfo=*/nullptr,
+      inheritance_info,
   };
   ASSERT_SUCCESS(vkBeginCommandBuffer(command_buffer, &begin_info),
                  "Failed to begin recording command buffer");
@@ -98,49 +127,270 @@ std::optional<VkResult> CheckResult(VkResult result) {
   }
 }
 
+// Submits uploads recorded by the staging uploader, so that commands submitted
+// to 'queue' afterwards can use the uploaded data. If 'queue' is the transfer
+// queue, the submission order is enough. Otherwise, we wait for uploads to
+// finish.
+void SubmitPendingUploads(const BasicContext& context,
+                          const Queues::Queue& queue) {
+  if (queue.queue == context.queues().transfer_queue().queue) {
+    context.staging_uploader().Submit();
+  } else {
+    context.staging_uploader().Flush();
+  }
+}
+
 } /* namespace */
 
-OneTimeCommand::OneTimeCommand(SharedBasicContext context,
-                               const Queues::Queue* queue)
-    : Command{std::move(context)}, queue_{FATAL_IF_NULL(queue)} {
-  const auto command_pool = CreateCommandPool(*context_, *queue_,
-                                              /*is_transient=*/true);
-  set_command_pool(command_pool);
-  command_buffer_ =
-      AllocateCommandBuffers(*context_, command_pool, /*count=*/1)[0];
+bool SubmittedCommand::IsComplete() const {
+  return vkGetFenceStatus(*context_->device(), fence()) == VK_SUCCESS;
 }
 
-void OneTimeCommand::Run(const OnRecord& on_record) const {
-  RecordCommands(command_buffer_, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-                 on_record);
+void SubmittedCommand::Wait() const {
+  vkWaitForFences(*context_->device(), /*fenceCount=*/1, &fence(),
+                  /*waitAll=*/VK_TRUE, kTimeoutForever);
+}
+
+void SubmittedCommand::Release() {
+  if (resources_.has_value()) {
+    context_->command_recycler().Release(queue_family_index_,
+                                         resources_.value(),
+                                         /*is_submitted=*/true);
+    resources_.reset();
+  }
+}
+
+SubmittedCommand OneTimeCommand::RunAsync(
+    const OnRecord& on_record, const Dependencies& dependencies) const {
+  auto& recycler = context_->command_recycler();
+  const auto resources = recycler.Acquire(queue_->family_index);
+  try {
+    RecordCommands(resources.command_buffer,
+                   VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, on_record);
+  } catch (...) {
+    recycler.Release(queue_->family_index, resources, /*is_submitted=*/false);
+    throw;
+  }
+  SubmitPendingUploads(*context_, *queue_);
+
+  std::vector<VkSemaphore> wait_semaphores;
+  std::vector<VkPipelineStageFlags> wait_stages;
+  std::vector<uint64_t> wait_values;
+  wait_semaphores.reserve(dependencies.wait_semaphores.size());
+  wait_stages.reserve(dependencies.wait_semaphores.size());
+  wait_values.reserve(dependencies.wait_semaphores.size());
+  for (const auto& wait_info : dependencies.wait_semaphores) {
+    wait_semaphores.push_back(wait_info.semaphore);
+    wait_stages.push_back(wait_info.stage);
+    wait_values.push_back(wait_info.value);
+  }
+
+  std::vector<VkSemaphore> signal_semaphores;
+  std::vector<uint64_t> signal_values;
+  signal_semaphores.reserve(dependencies.signal_semaphores.size());
+  signal_values.reserve(dependencies.signal_semaphores.size());
+  for (const auto& signal_info : dependencies.signal_semaphores) {
+    signal_semaphores.push_back(signal_info.semaphore);
+    signal_values.push_back(signal_info.value);
+  }
+
+  // Values are ignored for binary semaphores, hence it is fine to always pass
+  // them as long as the device supports timeline semaphores.
+  const bool use_timeline = context_->device().timeline_semaphore_enabled();
+  if (!use_timeline) {
+    const auto has_value = [](const auto& info) { return info.value != 0; };
+    ASSERT_TRUE(
+        std::none_of(dependencies.wait_semaphores.begin(),
+                     dependencies.wait_semaphores.end(), has_value) &&
+            std::none_of(dependencies.signal_semaphores.begin(),
+                         dependencies.signal_semaphores.end(), has_value),
+        "Timeline semaphore values are provided, but timeline semaphores are "
+        "not enabled");
+  }
+  const VkTimelineSemaphoreSubmitInfoKHR timeline_info{
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+      /*pNext=*/nullptr,
+      CONTAINER_SIZE(wait_values),
+      wait_values.data(),
+      CONTAINER_SIZE(signal_values),
+      signal_values.data(),
+  };
+
   const VkSubmitInfo submit_info{
       VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      /*pNext=*/nullptr,
-      /*waitSemaphoreCount=*/0,
-      /*pWaitSemaphores=*/nullptr,
-      /*pWaitDstStageMask=*/nullptr,
+      use_timeline ? &timeline_info : nullptr,
+      CONTAINER_SIZE(wait_semaphores),
+      wait_semaphores.data(),
+      wait_stages.data(),
       /*commandBufferCount=*/1,
-      &command_buffer_,
-      /*signalSemaphoreCount=*/0,
-      /*pSignalSemaphores=*/nullptr,
+      &resources.command_buffer,
+      CONTAINER_SIZE(signal_semaphores),
+      signal_semaphores.data(),
+  };
+  ASSERT_SUCCESS(queue_->Submit(submit_info, resources.fence),
+                 "Failed to submit command buffer");
+  return SubmittedCommand{context_, queue_->family_index, resources};
+}
+
+SecondaryCommandRecorder::SecondaryCommandRecorder(
+    SharedBasicContext context, const Queues::Queue& queue,
+    common::ThreadPool* thread_pool, int num_slices)
+    : context_{std::move(FATAL_IF_NULL(context))}, thread_pool_{thread_pool} {
+  ASSERT_TRUE(num_slices > 0, "Number of slices must be positive");
+  slices_.resize(num_slices);
+  for (auto& slice : slices_) {
+    slice.command_pool =
+        CreateCommandPool(*context_, queue, /*is_transient=*/true);
+  }
+}
+
+SecondaryCommandRecorder::~SecondaryCommandRecorder() {
+  // Command buffers are implicitly freed with the pool.
+  for (const auto& slice : slices_) {
+    vkDestroyCommandPool(*context_->device(), slice.command_pool,
+                         *context_->allocator());
+  }
+}
+
+std::vector<VkCommandBuffer> SecondaryCommandRecorder::Record(
+    const VkCommandBufferInheritanceInfo& inheritance_info, int num_draws,
+    const OnRecordRange& on_record_range) {
+  const int num_slices = std::min(static_cast<int>(slices_.size()), num_draws);
+  std::vector<VkCommandBuffer> command_buffers(num_slices);
+  const auto record_slice = [&](int slice_index) {
+    const int begin = num_draws * slice_index / num_slices;
+    const int end = num_draws * (slice_index + 1) / num_slices;
+    const VkCommandBuffer& command_buffer =
+        GetCommandBuffer(&slices_[slice_index]);
+    RecordCommands(
+        command_buffer,
+        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        [&on_record_range, begin, end](const VkCommandBuffer& command_buffer) {
+          on_record_range(command_buffer, begin, end);
+        },
+        &inheritance_info);
+    command_buffers[slice_index] = command_buffer;
   };
-  vkQueueSubmit(queue_->queue, /*submitCount=*/1, &submit_info,
-                /*fence=*/VK_NULL_HANDLE);
-  vkQueueWaitIdle(queue_->queue);
+
+  if (thread_pool_ == nullptr) {
+    for (int i = 0; i < num_slices; ++i) {
+      record_slice(i);
+    }
+  } else {
+    thread_pool_->ParallelFor(num_slices, record_slice);
+  }
+  return command_buffers;
+}
+
+void SecondaryCommandRecorder::Reset() {
+  for (auto& slice : slices_) {
+    if (slice.num_used_command_buffers > 0) {
+      vkResetCommandPool(*context_->device(), slice.command_pool,
+                         /*flags=*/nullflag);
+      slice.num_used_command_buffers = 0;
+    }
+  }
+}
+
+const VkCommandBuffer& SecondaryCommandRecorder::GetCommandBuffer(
+    Slice* slice) const {
+  if (slice->num_used_command_buffers == slice->command_buffers.size()) {
+    slice->command_buffers.push_back(
+        AllocateCommandBuffers(*context_, slice->command_pool, /*count=*/1,
+                               VK_COMMAND_BUFFER_LEVEL_SECONDARY)[0]);
+  }
+  return slice->command_buffers[slice->num_used_command_buffers++];
 }
 
 PerFrameCommand::PerFrameCommand(const SharedBasicContext& context,
-                                 int num_frames_in_flight)
+                                 int num_frames_in_flight,
+                                 int num_recording_threads)
     : Command{context},
+      num_frames_in_flight_{num_frames_in_flight},
+      num_recording_threads_{num_recording_threads},
+      submitted_frame_numbers_(num_frames_in_flight, 0),
       present_finished_semas_{context, num_frames_in_flight},
-      render_finished_semas_{context, num_frames_in_flight},
-      in_flight_fences_{context, num_frames_in_flight,
-                        /*is_signaled=*/true} {
+      render_finished_semas_{context, num_frames_in_flight} {
+  ASSERT_TRUE(num_frames_in_flight > 0,
+              "Number of frames in flight must be positive");
   const auto command_pool = CreateCommandPool(
       *context_, context_->queues().graphics_queue(), /*is_transient=*/false);
   set_command_pool(command_pool);
   command_buffers_ = AllocateCommandBuffers(
       *context_, command_pool, static_cast<uint32_t>(num_frames_in_flight));
+
+  // The timeline semaphore is signaled with the frame number once each frame
+  // finishes, hence frames that have not been submitted are never waited for.
+  // Fences are initialized to the signaled state for the same reason.
+  if (context_->device().timeline_semaphore_enabled()) {
+    timeline_semaphore_ =
+        std::make_unique<TimelineSemaphore>(context_, /*initial_value=*/0);
+  } else {
+    in_flight_fences_ = std::make_unique<Fences>(
+        context_, num_frames_in_flight, /*is_signaled=*/true);
+  }
+
+  ASSERT_TRUE(num_recording_threads > 0,
+              "Number of recording threads must be positive");
+  // The thread that calls Run() also records, hence we need one less worker.
+  if (num_recording_threads > 1) {
+    thread_pool_ =
+        std::make_unique<common::ThreadPool>(num_recording_threads - 1);
+  }
+  secondary_recorders_.reserve(num_frames_in_flight);
+  for (int i = 0; i < num_frames_in_flight; ++i) {
+    secondary_recorders_.push_back(std::make_unique<SecondaryCommandRecorder>(
+        context_, context_->queues().graphics_queue(), thread_pool_.get(),
+        /*num_slices=*/num_recording_threads));
+  }
+}
+
+void PerFrameCommand::WaitForNextFrame() {
+  if (waited_frame_ == current_frame_) {
+    return;
+  }
+  const auto wait_start_time = Clock::now();
+
+  // Resources of 'current_frame_' can be reused once the last frame submitted
+  // with them finishes. With frame pacing, we instead wait for the frame before
+  // the last submitted one, so that at most one frame is queued on the device,
+  // and inputs sampled for the next frame are shown sooner.
+  uint64_t frame_to_wait = submitted_frame_numbers_[current_frame_];
+  const bool should_pace = frame_pacing_enabled_ && num_submitted_frames_ > 0;
+  if (should_pace) {
+    frame_to_wait = std::max(frame_to_wait, num_submitted_frames_ - 1);
+  }
+  WaitForFrame(frame_to_wait);
+
+  // If the host just blocked until that frame finished, the device starts
+  // executing the last submitted frame now, and becomes idle after one device
+  // frame time. We only need to submit the next frame right before that.
+  stats_.pacing_delay = 0.0f;
+  if (should_pace && frame_to_wait + 1 == num_submitted_frames_ &&
+      last_finished_frame_.has_value() &&
+      last_finished_frame_->first == frame_to_wait) {
+    const float delay = stats_.average_gpu_frame_time -
+                        stats_.average_cpu_frame_time - kPacingMargin;
+    if (delay > 0.0f) {
+      std::this_thread::sleep_for(std::chrono::duration<float>{delay});
+      stats_.pacing_delay = delay;
+    }
+  }
+
+  frame_start_time_ = Clock::now();
+  stats_.cpu_wait_time = TimeInterval(wait_start_time, frame_start_time_);
+  UpdateAverage(stats_.cpu_wait_time, &stats_.average_cpu_wait_time);
+
+  // Secondary command buffers of this frame are no longer in use.
+  secondary_recorders_[current_frame_]->Reset();
+  waited_frame_ = current_frame_;
+}
+
+std::optional<VkResult> PerFrameCommand::Run(const VkSwapchainKHR& swapchain,
+                                             const UpdateData& update_data,
+                                             const OnRecord& on_record) {
+  return Run(current_frame_, swapchain, update_data, on_record);
 }
 
 std::optional<VkResult> PerFrameCommand::Run(int current_frame,
@@ -157,13 +407,13 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
   //   |  Signal  | Present finished |  Render finished |        -        |
   //   |------------------------------------------------------------------|
   //              ^                                     ^
-  //        Wait for fence                         Signal fence
-
-  // Fences are initialized to the signaled state, hence waiting for them at the
-  // beginning is fine.
-  const VkDevice& device = *context_->device();
-  vkWaitForFences(device, /*fenceCount=*/1, &in_flight_fences_[current_frame],
-                  /*waitAll=*/VK_TRUE, kTimeoutForever);
+  //        Wait for frame                         Signal frame
+  // The host waits for the frame to finish with either the timeline semaphore
+  // or the fence, and the device signals it in the same way.
+  ASSERT_TRUE(current_frame >= 0 && current_frame < num_frames_in_flight_,
+              absl::StrFormat("Frame index %d out of range", current_frame));
+  current_frame_ = current_frame;
+  WaitForNextFrame();
 
   // Update per-frame data.
   if (update_data != nullptr) {
@@ -171,6 +421,7 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
   }
 
   // Acquire the next available swapchain image.
+  const VkDevice& device = *context_->device();
   uint32_t image_index;
   const auto acquire_result = CheckResult(vkAcquireNextImageKHR(
       device, swapchain, kTimeoutForever,
@@ -181,12 +432,32 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
   }
 
   // Record operations.
+  recording_frame_ = current_frame;
   RecordCommands(
       command_buffers_[current_frame],
       VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-      [&on_record, image_index](const VkCommandBuffer& command_buffer) {
-        on_record(command_buffer, image_index);
+      [&on_record, image_index, current_frame](
+          const VkCommandBuffer& command_buffer) {
+        on_record(command_buffer, image_index, current_frame);
       });
+  recording_frame_.reset();
+
+  // If the timeline semaphore is used, it is signaled together with the binary
+  // semaphore. The value for the binary semaphore is ignored.
+  const uint64_t frame_number = num_submitted_frames_ + 1;
+  const VkSemaphore timeline_signal_semas[]{
+      render_finished_semas_[current_frame],
+      timeline_semaphore_ != nullptr ? **timeline_semaphore_ : VK_NULL_HANDLE,
+  };
+  const uint64_t timeline_signal_values[]{0, frame_number};
+  const VkTimelineSemaphoreSubmitInfoKHR timeline_info{
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+      /*pNext=*/nullptr,
+      /*waitSemaphoreValueCount=*/0,
+      /*pWaitSemaphoreValues=*/nullptr,
+      /*signalSemaphoreValueCount=*/2,
+      timeline_signal_values,
+  };
 
   // We can start the pipeline without waiting, until we need to write to the
   // swapchain image, since that image may still being presented on the screen.
@@ -194,7 +465,7 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
   const VkSubmitInfo submit_info{
       VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      /*pNext=*/nullptr,
+      timeline_semaphore_ != nullptr ? &timeline_info : nullptr,
       /*waitSemaphoreCount=*/1,
       /*pWaitSemaphores=*/&present_finished_semas_[current_frame],
       // One semaphore waits for one stage, hence there is no need to pass
@@ -202,19 +473,29 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
       &kWaitStage,
       /*commandBufferCount=*/1,
       &command_buffers_[current_frame],
-      /*signalSemaphoreCount=*/1,
-      /*pSignalSemaphores=*/&render_finished_semas_[current_frame],
+      /*signalSemaphoreCount=*/timeline_semaphore_ != nullptr ? 2U : 1U,
+      /*pSignalSemaphores=*/timeline_signal_semas,
   };
 
   // Reset the fence to the unsignaled state. Note that we don't need to do this
   // for semaphores.
-  vkResetFences(device, /*fenceCount=*/1, &in_flight_fences_[current_frame]);
+  VkFence fence = VK_NULL_HANDLE;
+  if (in_flight_fences_ != nullptr) {
+    fence = (*in_flight_fences_)[current_frame];
+    vkResetFences(device, /*fenceCount=*/1, &fence);
+  }
+  SubmitPendingUploads(*context_, context_->queues().graphics_queue());
   ASSERT_SUCCESS(
-      vkQueueSubmit(context_->queues().graphics_queue().queue,
-                    /*submitCount=*/1, &submit_info,
-                    in_flight_fences_[current_frame]),
+      context_->queues().graphics_queue().Submit(submit_info, fence),
       "Failed to submit command buffer");
 
+  num_submitted_frames_ = frame_number;
+  submitted_frame_numbers_[current_frame] = frame_number;
+  UpdateAverage(TimeInterval(frame_start_time_, Clock::now()),
+                &stats_.average_cpu_frame_time);
+  waited_frame_.reset();
+  current_frame_ = (current_frame + 1) % num_frames_in_flight_;
+
   // Present the swapchain image to screen.
   const VkPresentInfoKHR present_info{
       VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -227,8 +508,66 @@ std::optional<VkResult> PerFrameCommand::Run(int current_frame,
       // May use 'pResults' to check if each swapchain rendered successfully.
       /*pResults=*/nullptr,
   };
-  return CheckResult(vkQueuePresentKHR(
-      context_->queues().present_queue().queue, &present_info));
+  return CheckResult(
+      context_->queues().present_queue().Present(present_info));
+}
+
+std::vector<VkCommandBuffer> PerFrameCommand::RecordSecondaryCommands(
+    const VkCommandBufferInheritanceInfo& inheritance_info, int num_draws,
+    const SecondaryCommandRecorder::OnRecordRange& on_record_range) {
+  ASSERT_HAS_VALUE(recording_frame_,
+                   "Must be called when recording the primary command buffer");
+  return secondary_recorders_[recording_frame_.value()]->Record(
+      inheritance_info, num_draws, on_record_range);
+}
+
+bool PerFrameCommand::IsFrameFinished(uint64_t frame_number) const {
+  ASSERT_TRUE(frame_number <= num_submitted_frames_,
+              absl::StrFormat("Frame %d has not been submitted", frame_number));
+  if (timeline_semaphore_ != nullptr) {
+    return timeline_semaphore_->GetValue() >= frame_number;
+  }
+
+  // A fence is reused only after the frame previously submitted with it
+  // finishes, hence if no fence holds 'frame_number', that frame has finished.
+  const auto iter = std::find(submitted_frame_numbers_.begin(),
+                              submitted_frame_numbers_.end(), frame_number);
+  if (frame_number == 0 || iter == submitted_frame_numbers_.end()) {
+    return true;
+  }
+  const int frame = std::distance(submitted_frame_numbers_.begin(), iter);
+  return vkGetFenceStatus(*context_->device(), (*in_flight_fences_)[frame]) ==
+         VK_SUCCESS;
+}
+
+void PerFrameCommand::WaitForFrame(uint64_t frame_number) {
+  // If the frame has already finished, we don't know when it finished, hence
+  // the device frame time can't be sampled.
+  if (IsFrameFinished(frame_number)) {
+    last_finished_frame_.reset();
+    return;
+  }
+
+  if (timeline_semaphore_ != nullptr) {
+    timeline_semaphore_->Wait(frame_number);
+  } else {
+    const auto iter = std::find(submitted_frame_numbers_.begin(),
+                                submitted_frame_numbers_.end(), frame_number);
+    const int frame = std::distance(submitted_frame_numbers_.begin(), iter);
+    vkWaitForFences(*context_->device(), /*fenceCount=*/1,
+                    &(*in_flight_fences_)[frame], /*waitAll=*/VK_TRUE,
+                    kTimeoutForever);
+  }
+
+  // If the host has also blocked until the previous frame finished, the
+  // interval between them is the time the device spent on this frame.
+  const auto now = Clock::now();
+  if (last_finished_frame_.has_value() &&
+      last_finished_frame_->first + 1 == frame_number) {
+    UpdateAverage(TimeInterval(last_finished_frame_->second, now),
+                  &stats_.average_gpu_frame_time);
+  }
+  last_finished_frame_.emplace(frame_number, now);
 }
 
 } /* namespace vulkan */
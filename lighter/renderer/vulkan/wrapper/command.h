@@ -8,12 +8,18 @@
 #ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_COMMAND_H
 #define LIGHTER_RENDERER_VULKAN_WRAPPER_COMMAND_H
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include "lighter/common/thread_pool.h"
 #include "lighter/common/util.h"
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/command_recycler.h"
 #include "lighter/renderer/vulkan/wrapper/synchronization.h"
 #include "third_party/vulkan/vulkan.h"
 
@@ -26,9 +32,9 @@ namespace vulkan {
 // Both primary level and secondary level command buffers can record commands,
 // but only the primary can be submitted to the queue. The secondary can be
 // built in different threads and executed in different primary command buffers.
-// This is the base class of all command classes. The user should use it through
-// derived classes. Since all commands need VkCommandPool, which allocates
-// command buffers, it will be held and destroyed by this base class, and
+// This is the base class of command classes that own VkCommandPool. The user
+// should use it through derived classes. The command pool, which allocates
+// command buffers, will be held and destroyed by this base class, and
 // initialized by derived classes.
 class Command {
  public:
@@ -58,70 +64,345 @@ class Command {
   VkCommandPool command_pool_;
 };
 
+// Handle of a command that has been submitted to a queue, which can be used to
+// check or wait for its completion. Destructing this does not wait, and the
+// command buffer will be recycled after the command finishes.
+class SubmittedCommand {
+ public:
+  SubmittedCommand(SharedBasicContext context, uint32_t queue_family_index,
+                   const CommandRecycler::Resources& resources)
+      : context_{std::move(FATAL_IF_NULL(context))},
+        queue_family_index_{queue_family_index}, resources_{resources} {}
+
+  // This class is only movable.
+  SubmittedCommand(SubmittedCommand&& rhs) noexcept
+      : context_{std::move(rhs.context_)},
+        queue_family_index_{rhs.queue_family_index_},
+        resources_{std::move(rhs.resources_)} {
+    rhs.resources_.reset();
+  }
+
+  SubmittedCommand& operator=(SubmittedCommand&& rhs) noexcept {
+    Release();
+    context_ = std::move(rhs.context_);
+    queue_family_index_ = rhs.queue_family_index_;
+    resources_ = std::move(rhs.resources_);
+    rhs.resources_.reset();
+    return *this;
+  }
+
+  ~SubmittedCommand() { Release(); }
+
+  // Returns true if the command has finished executing.
+  bool IsComplete() const;
+
+  // Blocks until the command finishes executing.
+  void Wait() const;
+
+  // Accessors.
+  const VkFence& fence() const { return resources_.value().fence; }
+
+ private:
+  // Gives the command buffer and fence back to the command recycler.
+  void Release();
+
+  // Pointer to context.
+  SharedBasicContext context_;
+
+  // Queue family that the command is submitted to.
+  uint32_t queue_family_index_;
+
+  // Command buffer and fence used by the command. This does not have value if
+  // it is moved to another instance.
+  std::optional<CommandRecycler::Resources> resources_;
+};
+
 // This class creates a command that is meant to be executed for only once.
-class OneTimeCommand : public Command {
+// Command buffers and fences are recycled by CommandRecycler, hence creating
+// instances of this class is cheap.
+class OneTimeCommand {
  public:
   // Specifies which operations should be performed.
   using OnRecord = std::function<void(const VkCommandBuffer& command_buffer)>;
 
+  // Dependencies between this command and other submissions. Semaphores can
+  // be either binary or timeline semaphores. Values are only used for timeline
+  // semaphores, which requires Device::timeline_semaphore_enabled(). Each
+  // binary semaphore in 'signal_semaphores' should be waited on by exactly one
+  // later submission.
+  struct Dependencies {
+    // A semaphore to wait on, and the pipeline stage that waits for it. For a
+    // timeline semaphore, the wait finishes once its counter reaches 'value'.
+    struct WaitInfo {
+      VkSemaphore semaphore;
+      VkPipelineStageFlags stage;
+      uint64_t value = 0;
+    };
+
+    // A semaphore to signal. For a timeline semaphore, its counter will be set
+    // to 'value'.
+    struct SignalInfo {
+      VkSemaphore semaphore;
+      uint64_t value = 0;
+    };
+
+    std::vector<WaitInfo> wait_semaphores;
+    std::vector<SignalInfo> signal_semaphores;
+  };
+
   // The recorded operations will be submitted to 'queue'.
-  OneTimeCommand(SharedBasicContext context, const Queues::Queue* queue);
+  OneTimeCommand(SharedBasicContext context, const Queues::Queue* queue)
+      : context_{std::move(FATAL_IF_NULL(context))},
+        queue_{FATAL_IF_NULL(queue)} {}
 
   // This class is neither copyable nor movable.
   OneTimeCommand(const OneTimeCommand&) = delete;
   OneTimeCommand& operator=(const OneTimeCommand&) = delete;
 
+  // Records operations and submits them without waiting for completion.
+  // Resources used by the recorded operations must be kept alive until the
+  // returned command finishes.
+  SubmittedCommand RunAsync(const OnRecord& on_record,
+                            const Dependencies& dependencies = {}) const;
+
   // Executes the command once and waits for completion.
-  void Run(const OnRecord& on_record) const;
+  void Run(const OnRecord& on_record) const { RunAsync(on_record).Wait(); }
 
  private:
+  // Pointer to context.
+  const SharedBasicContext context_;
+
   // Used to execute the command.
   const Queues::Queue* queue_;
+};
+
+// This class records secondary command buffers on multiple threads. Draws are
+// split into slices, and each slice is recorded into its own secondary command
+// buffer. Each slice index owns a command pool, and is only used by one thread
+// at a time, hence recording needs no locks. Command buffers are recycled when
+// Reset() is called, so the user must make sure that the device has finished
+// executing them by then.
+class SecondaryCommandRecorder {
+ public:
+  // Records draws in range ['begin', 'end') into 'command_buffer'. This may be
+  // called on multiple threads simultaneously, with different ranges.
+  using OnRecordRange = std::function<void(
+      const VkCommandBuffer& command_buffer, int begin, int end)>;
+
+  // Command buffers will be executed by primary command buffers submitted to
+  // 'queue'. Draws are split into at most 'num_slices' slices. If 'thread_pool'
+  // is nullptr, all slices are recorded on the calling thread. Otherwise, it
+  // must outlive this recorder.
+  SecondaryCommandRecorder(SharedBasicContext context,
+                           const Queues::Queue& queue,
+                           common::ThreadPool* thread_pool, int num_slices);
+
+  // This class is neither copyable nor movable.
+  SecondaryCommandRecorder(const SecondaryCommandRecorder&) = delete;
+  SecondaryCommandRecorder& operator=(const SecondaryCommandRecorder&) = delete;
+
+  ~SecondaryCommandRecorder();
+
+  // Splits 'num_draws' draws into slices, records each slice with
+  // 'on_record_range' into a secondary command buffer that inherits
+  // 'inheritance_info', and blocks until all slices are recorded. The calling
+  // thread also records slices. Command buffers are returned in the order of
+  // slices, and they stay valid until Reset() is called.
+  std::vector<VkCommandBuffer> Record(
+      const VkCommandBufferInheritanceInfo& inheritance_info, int num_draws,
+      const OnRecordRange& on_record_range);
+
+  // Recycles all command buffers returned by Record().
+  void Reset();
+
+ private:
+  // Command pool and command buffers used by one slice index.
+  struct Slice {
+    VkCommandPool command_pool;
+
+    // Command buffers allocated from 'command_pool'.
+    std::vector<VkCommandBuffer> command_buffers;
 
-  // Opaque command buffer object.
-  VkCommandBuffer command_buffer_;
+    // Number of elements of 'command_buffers' that have been used since the
+    // last Reset().
+    int num_used_command_buffers = 0;
+  };
+
+  // Returns a command buffer of 'slice' that has not been used since the last
+  // Reset().
+  const VkCommandBuffer& GetCommandBuffer(Slice* slice) const;
+
+  // Pointer to context.
+  const SharedBasicContext context_;
+
+  // Runs recording tasks. This can be nullptr.
+  common::ThreadPool* thread_pool_;
+
+  // Each element is used by the slice with the same index.
+  std::vector<Slice> slices_;
 };
 
 // This classes creates a command that will be executed in every frame.
 // It assumes that the user is doing onscreen rendering, and handles the
 // synchronization internally.
+// If the user wants to split draws across threads, RecordSecondaryCommands()
+// can be called during the recording of the primary command buffer. Each frame
+// owns command pools for secondary command buffers, which are recycled when the
+// same frame is run again.
 class PerFrameCommand : public Command {
  public:
   // Specifies which operations should be performed. Since the swapchain holds
   // several images, 'framebuffer_index' will be the index of the swapchain
-  // image used in this recording.
+  // image used in this recording. 'current_frame' is the same as the one passed
+  // to UpdateData.
   using OnRecord = std::function<void(const VkCommandBuffer& command_buffer,
-                                      uint32_t framebuffer_index)>;
+                                      uint32_t framebuffer_index,
+                                      int current_frame)>;
 
   // The user may want to do multiple buffering. 'current_frame' refers to which
   // "buffer" are we rendering to.
   using UpdateData = std::function<void(int current_frame)>;
 
-  // Our rendering is 'num_frames_in_flight'-buffered.
-  PerFrameCommand(const SharedBasicContext& context, int num_frames_in_flight);
+  // Timing of recent frames in seconds. Averages are exponential moving
+  // averages over recent frames.
+  struct FrameStats {
+    // Time the host spent in WaitForNextFrame() for the last frame, including
+    // 'pacing_delay'.
+    float cpu_wait_time = 0.0f;
+    float average_cpu_wait_time = 0.0f;
+
+    // Time from the end of WaitForNextFrame() to the submission of commands.
+    float average_cpu_frame_time = 0.0f;
+
+    // Interval between completions of consecutive frames on the device. This
+    // is only sampled when the host has to wait for those frames, i.e. when the
+    // device is the bottleneck.
+    float average_gpu_frame_time = 0.0f;
+
+    // Time the host slept for frame pacing in the last frame.
+    float pacing_delay = 0.0f;
+  };
+
+  // Our rendering is 'num_frames_in_flight'-buffered. Secondary command buffers
+  // are recorded on 'num_recording_threads' threads, including the thread that
+  // calls Run(). Submitted frames are tracked with a timeline semaphore if the
+  // device enables it, otherwise with one fence per frame.
+  PerFrameCommand(const SharedBasicContext& context, int num_frames_in_flight,
+                  int num_recording_threads = 1);
 
   // This class is neither copyable nor movable.
   PerFrameCommand(const PerFrameCommand&) = delete;
   PerFrameCommand& operator=(const PerFrameCommand&) = delete;
 
-  // Records operations for a new frame and submits to the graphics queue,
-  // without waiting for completion. The return value can be:
+  // Blocks host until resources of current_frame() are no longer used by the
+  // device. If frame pacing is enabled, this may additionally sleep, so that
+  // commands of the next frame are submitted right before the device becomes
+  // idle. The user should call this before sampling inputs to minimize latency.
+  // Otherwise, Run() will call it internally.
+  void WaitForNextFrame();
+
+  // Records operations for current_frame() and submits to the graphics queue,
+  // without waiting for completion. If commands are submitted, current_frame()
+  // advances to the next frame. The return value can be:
   //   - std::nullopt, if the swapchain can be kept using, or
   //   - otherwise, if the swapchain need to be rebuilt.
   // If any unexpected error occurs, a runtime exception will be thrown.
+  std::optional<VkResult> Run(const VkSwapchainKHR& swapchain,
+                              const UpdateData& update_data,
+                              const OnRecord& on_record);
+
+  // Same as above, but records operations for 'current_frame' specified by the
+  // user, who is responsible for cycling through frames.
   std::optional<VkResult> Run(int current_frame,
                               const VkSwapchainKHR& swapchain,
                               const UpdateData& update_data,
                               const OnRecord& on_record);
 
+  // Records draws into secondary command buffers on recording threads, and
+  // returns them. See SecondaryCommandRecorder::Record() for details. This must
+  // only be called within 'on_record' passed to Run(), and returned command
+  // buffers must be executed by the primary command buffer being recorded.
+  std::vector<VkCommandBuffer> RecordSecondaryCommands(
+      const VkCommandBufferInheritanceInfo& inheritance_info, int num_draws,
+      const SecondaryCommandRecorder::OnRecordRange& on_record_range);
+
+  // Modifiers.
+  void set_frame_pacing_enabled(bool enabled) {
+    frame_pacing_enabled_ = enabled;
+  }
+
+  // Accessors.
+  int num_frames_in_flight() const { return num_frames_in_flight_; }
+  int num_recording_threads() const { return num_recording_threads_; }
+  int current_frame() const { return current_frame_; }
+  const FrameStats& stats() const { return stats_; }
+
  private:
+  using Clock = std::chrono::steady_clock;
+
+  // Returns whether the device has finished executing the frame numbered
+  // 'frame_number'. Frames are numbered from 1 in the order of submission, and
+  // frame 0 is considered finished.
+  bool IsFrameFinished(uint64_t frame_number) const;
+
+  // Blocks host until the device finishes executing the frame numbered
+  // 'frame_number', and updates the estimated device frame time.
+  void WaitForFrame(uint64_t frame_number);
+
+  // Number of frames that can be processed concurrently.
+  const int num_frames_in_flight_;
+
+  // Number of threads that record secondary command buffers.
+  const int num_recording_threads_;
+
+  // Thread pool used to record secondary command buffers. This is nullptr if
+  // only one recording thread is requested.
+  std::unique_ptr<common::ThreadPool> thread_pool_;
+
+  // Each element records secondary command buffers for the frame with the same
+  // index.
+  std::vector<std::unique_ptr<SecondaryCommandRecorder>> secondary_recorders_;
+
+  // Frame whose primary command buffer is being recorded. This only has value
+  // during Run().
+  std::optional<int> recording_frame_;
+
+  // Frame to be recorded by the next call to Run().
+  int current_frame_ = 0;
+
+  // Frame that WaitForNextFrame() has waited for, which is reset once commands
+  // of that frame are submitted.
+  std::optional<int> waited_frame_;
+
+  // Whether to delay the start of frames to reduce latency.
+  bool frame_pacing_enabled_ = false;
+
+  // Number of frames that have been submitted.
+  uint64_t num_submitted_frames_ = 0;
+
+  // Each element is the number of the last frame submitted with the same index,
+  // or 0 if no frame has been submitted with that index.
+  std::vector<uint64_t> submitted_frame_numbers_;
+
+  // The last frame that the host waited for and the time it finished. This only
+  // has value if the host actually blocked, hence the time is accurate.
+  std::optional<std::pair<uint64_t, Clock::time_point>> last_finished_frame_;
+
+  // Time when WaitForNextFrame() returned for the frame being prepared.
+  Clock::time_point frame_start_time_;
+
+  // Timing of recent frames.
+  FrameStats stats_;
+
   // Opaque command buffer objects.
   std::vector<VkCommandBuffer> command_buffers_;
 
-  // Used for synchronization. See comments in Run() for details.
+  // Used for synchronization. See comments in Run() for details. Only one of
+  // 'timeline_semaphore_' and 'in_flight_fences_' is created.
   Semaphores present_finished_semas_;
   Semaphores render_finished_semas_;
-  Fences in_flight_fences_;
+  std::unique_ptr<TimelineSemaphore> timeline_semaphore_;
+  std::unique_ptr<Fences> in_flight_fences_;
 };
 
 } /* namespace vulkan */
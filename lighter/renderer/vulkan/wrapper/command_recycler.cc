@@ -0,0 +1,149 @@
+//
+//  command_recycler.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/command_recycler.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+constexpr auto kTimeoutForever = std::numeric_limits<uint64_t>::max();
+
+} /* namespace */
+
+CommandRecycler::CommandRecycler(const BasicContext* context)
+    : context_{FATAL_IF_NULL(context)} {}
+
+CommandRecycler::~CommandRecycler() {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const VkDevice& device = *context_->device();
+  for (auto& [key, pool] : pools_) {
+    for (const auto& resources : pool.pending_resources) {
+      vkWaitForFences(device, /*fenceCount=*/1, &resources.fence,
+                      /*waitAll=*/VK_TRUE, kTimeoutForever);
+      vkDestroyFence(device, resources.fence, *context_->allocator());
+    }
+    for (const auto* resources_list :
+             {&pool.free_resources, &pool.unsubmitted_resources}) {
+      for (const auto& resources : *resources_list) {
+        vkDestroyFence(device, resources.fence, *context_->allocator());
+      }
+    }
+    // Command buffers are implicitly freed with the pool.
+    vkDestroyCommandPool(device, pool.command_pool, *context_->allocator());
+  }
+}
+
+CommandRecycler::Resources CommandRecycler::Acquire(
+    uint32_t queue_family_index) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const VkDevice& device = *context_->device();
+
+  const PoolKey key{std::this_thread::get_id(), queue_family_index};
+  auto iter = pools_.find(key);
+  if (iter == pools_.end()) {
+    const VkCommandPoolCreateInfo pool_info{
+        VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        /*pNext=*/nullptr,
+        VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        queue_family_index,
+    };
+    Pool pool;
+    ASSERT_SUCCESS(vkCreateCommandPool(device, &pool_info,
+                                       *context_->allocator(),
+                                       &pool.command_pool),
+                   "Failed to create command pool");
+    iter = pools_.insert({key, std::move(pool)}).first;
+  }
+  Pool& pool = iter->second;
+
+  RecyclePendingResources(&pool);
+  if (!pool.free_resources.empty()) {
+    const Resources resources = pool.free_resources.back();
+    pool.free_resources.pop_back();
+    return resources;
+  }
+
+  Resources resources;
+  resources.thread_id = key.first;
+  const VkCommandBufferAllocateInfo buffer_info{
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      /*pNext=*/nullptr,
+      pool.command_pool,
+      VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      /*commandBufferCount=*/1,
+  };
+  ASSERT_SUCCESS(vkAllocateCommandBuffers(device, &buffer_info,
+                                          &resources.command_buffer),
+                 "Failed to allocate command buffer");
+
+  const VkFenceCreateInfo fence_info{
+      VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+  };
+  ASSERT_SUCCESS(vkCreateFence(device, &fence_info, *context_->allocator(),
+                               &resources.fence),
+                 "Failed to create fence");
+  return resources;
+}
+
+void CommandRecycler::Release(uint32_t queue_family_index,
+                              const Resources& resources, bool is_submitted) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const auto iter = pools_.find({resources.thread_id, queue_family_index});
+  ASSERT_TRUE(iter != pools_.end(),
+              absl::StrFormat("No command pool for queue family %d",
+                              queue_family_index));
+  // Command buffers are not reset here, since the owning thread may be
+  // recording into another command buffer allocated from the same pool.
+  if (is_submitted) {
+    iter->second.pending_resources.push_back(resources);
+  } else {
+    iter->second.unsubmitted_resources.push_back(resources);
+  }
+}
+
+void CommandRecycler::RecyclePendingResources(Pool* pool) const {
+  auto& pending = pool->pending_resources;
+  const auto first_finished = std::partition(
+      pending.begin(), pending.end(), [this](const Resources& resources) {
+        return vkGetFenceStatus(*context_->device(), resources.fence) !=
+               VK_SUCCESS;
+      });
+  for (auto iter = first_finished; iter != pending.end(); ++iter) {
+    ResetResources(*iter, /*is_submitted=*/true);
+    pool->free_resources.push_back(*iter);
+  }
+  pending.erase(first_finished, pending.end());
+
+  for (const auto& resources : pool->unsubmitted_resources) {
+    ResetResources(resources, /*is_submitted=*/false);
+    pool->free_resources.push_back(resources);
+  }
+  pool->unsubmitted_resources.clear();
+}
+
+void CommandRecycler::ResetResources(const Resources& resources,
+                                     bool is_submitted) const {
+  vkResetCommandBuffer(resources.command_buffer, /*flags=*/0);
+  if (is_submitted) {
+    vkResetFences(*context_->device(), /*fenceCount=*/1, &resources.fence);
+  }
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
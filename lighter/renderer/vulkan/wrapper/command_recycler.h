@@ -0,0 +1,114 @@
+//
+//  command_recycler.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_COMMAND_RECYCLER_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_COMMAND_RECYCLER_H
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Forward declarations.
+class BasicContext;
+
+// This class recycles command buffers and fences used by one-time commands, so
+// that we don't need to create and destroy a command pool for each submission.
+// Since command pools need external synchronization, there is one command pool
+// per thread and queue family, which is created when first used. Command
+// buffers are only allocated and reset on the thread that owns the pool, so
+// that one thread never touches a pool while another thread is recording into
+// a command buffer allocated from it.
+// Each command buffer comes with a fence, which should be signaled when the
+// commands finish executing. Released resources are reused once the fence is
+// signaled, when the owning thread acquires resources next time.
+// Acquiring and releasing are thread-safe, and resources can be released on
+// any thread. However, the command buffer must be recorded on the thread that
+// acquired it.
+class CommandRecycler {
+ public:
+  // A command buffer and the fence to signal when it finishes executing.
+  struct Resources {
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+
+    // Thread that acquired these resources, which owns the command pool.
+    std::thread::id thread_id;
+  };
+
+  explicit CommandRecycler(const BasicContext* context);
+
+  // This class is neither copyable nor movable.
+  CommandRecycler(const CommandRecycler&) = delete;
+  CommandRecycler& operator=(const CommandRecycler&) = delete;
+
+  // Waits for all released resources that are still in use, and destroys all
+  // command pools and fences.
+  ~CommandRecycler();
+
+  // Returns a command buffer in the initial state and an unsignaled fence. The
+  // command buffer can be submitted to queues with 'queue_family_index', and
+  // must be recorded on the calling thread.
+  Resources Acquire(uint32_t queue_family_index);
+
+  // Gives 'resources' back. If 'is_submitted' is true, the fence must have been
+  // passed to a queue submission, and 'resources' will not be reused until it
+  // is signaled. This may be called on any thread. The command buffer is reset
+  // later by the thread that acquired it.
+  void Release(uint32_t queue_family_index, const Resources& resources,
+               bool is_submitted);
+
+ private:
+  // Identifies a pool by the owning thread and the queue family index.
+  using PoolKey = std::pair<std::thread::id, uint32_t>;
+
+  // Resources of one thread and one queue family.
+  struct Pool {
+    VkCommandPool command_pool;
+
+    // Resources that can be reused immediately.
+    std::vector<Resources> free_resources;
+
+    // Resources that were released without being submitted, which need to be
+    // reset before reuse.
+    std::vector<Resources> unsubmitted_resources;
+
+    // Resources whose fences may not have been signaled yet.
+    std::vector<Resources> pending_resources;
+  };
+
+  // Moves resources whose fences have been signaled from 'pending_resources',
+  // and all 'unsubmitted_resources', to 'free_resources' of 'pool'. This must
+  // be called on the thread that owns 'pool'.
+  void RecyclePendingResources(Pool* pool) const;
+
+  // Resets the command buffer and fence in 'resources'.
+  void ResetResources(const Resources& resources, bool is_submitted) const;
+
+  // Pointer to context.
+  const BasicContext* context_;
+
+  // Maps owning threads and queue family indices to pools.
+  absl::flat_hash_map<PoolKey, Pool> pools_;
+
+  // Guards 'pools_'.
+  std::mutex mutex_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_COMMAND_RECYCLER_H */
@@ -16,48 +16,9 @@ namespace renderer {
 namespace vulkan {
 namespace {
 
-// Creates a descriptor pool, assuming it will only be used to allocate memory
-// for one descriptor set.
-VkDescriptorPool CreateDescriptorPool(
-    const BasicContext& context,
-    absl::Span<const Descriptor::Info> descriptor_infos) {
-  absl::flat_hash_map<VkDescriptorType, uint32_t> pool_size_map;
-  for (const auto& info : descriptor_infos) {
-    uint32_t total_length = 0;
-    for (const auto& binding : info.bindings) {
-      total_length += binding.array_length;
-    }
-    pool_size_map[info.descriptor_type] += total_length;
-  }
-
-  std::vector<VkDescriptorPoolSize> pool_sizes;
-  pool_sizes.reserve(pool_size_map.size());
-  for (const auto& pair : pool_size_map) {
-    pool_sizes.push_back(VkDescriptorPoolSize{
-        /*type=*/pair.first,
-        /*descriptorCount=*/pair.second,
-    });
-  }
-
-  const VkDescriptorPoolCreateInfo pool_info{
-      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-      /*pNext=*/nullptr,
-      /*flags=*/nullflag,
-      /*maxSets=*/1,
-      CONTAINER_SIZE(pool_sizes),
-      pool_sizes.data(),
-  };
-
-  VkDescriptorPool pool;
-  ASSERT_SUCCESS(vkCreateDescriptorPool(*context.device(), &pool_info,
-                                        *context.allocator(), &pool),
-                 "Failed to create descriptor pool");
-  return pool;
-}
-
-// Creates a descriptor set layout. If 'is_dynamic' is true, the layout will be
-// ready for pushing descriptors.
-VkDescriptorSetLayout CreateDescriptorSetLayout(
+// Returns a descriptor set layout from the layout cache. If 'is_dynamic' is
+// true, the layout will be ready for pushing descriptors.
+VkDescriptorSetLayout GetDescriptorSetLayout(
     const BasicContext& context,
     absl::Span<const Descriptor::Info> descriptor_infos,
     bool is_dynamic) {
@@ -80,40 +41,11 @@ VkDescriptorSetLayout CreateDescriptorSetLayout(
     }
   }
 
-  const VkDescriptorSetLayoutCreateInfo layout_info{
-      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-      /*pNext=*/nullptr,
+  return context.descriptor_allocator().GetLayout(
+      layout_bindings,
       /*flags=*/
       is_dynamic ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
-                 : nullflag,
-      CONTAINER_SIZE(layout_bindings),
-      layout_bindings.data(),
-  };
-
-  VkDescriptorSetLayout layout;
-  ASSERT_SUCCESS(vkCreateDescriptorSetLayout(*context.device(), &layout_info,
-                                             *context.allocator(), &layout),
-                 "Failed to create descriptor set layout");
-  return layout;
-}
-
-// Allocates one descriptor set from 'pool' with the given 'layout'.
-VkDescriptorSet AllocateDescriptorSet(const BasicContext& context,
-                                      const VkDescriptorPool& pool,
-                                      const VkDescriptorSetLayout& layout) {
-  const VkDescriptorSetAllocateInfo desc_set_info{
-      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-      /*pNext=*/nullptr,
-      pool,
-      /*descriptorSetCount=*/1,
-      &layout,
-  };
-
-  VkDescriptorSet set;
-  ASSERT_SUCCESS(
-      vkAllocateDescriptorSets(*context.device(), &desc_set_info, &set),
-      "Failed to allocate descriptor set");
-  return set;
+                 : nullflag);
 }
 
 // Creates a vector of VkWriteDescriptorSet for updating descriptor sets.
@@ -156,25 +88,27 @@ std::vector<VkWriteDescriptorSet> CreateWriteDescriptorSets(
 StaticDescriptor::StaticDescriptor(SharedBasicContext context,
                                    absl::Span<const Info> infos)
     : Descriptor{std::move(context)} {
-  pool_ = CreateDescriptorPool(*context_, infos);
-  const auto layout = CreateDescriptorSetLayout(*context_, infos,
-                                                /*is_dynamic=*/false);
+  const auto layout = GetDescriptorSetLayout(*context_, infos,
+                                             /*is_dynamic=*/false);
   set_layout(layout);
-  set_ = AllocateDescriptorSet(*context_, pool_, layout);
+  allocation_ = context_->descriptor_allocator().Allocate(
+      DescriptorAllocator::kPersistentPoolList, layout);
 }
 
 const StaticDescriptor& StaticDescriptor::UpdateBufferInfos(
     VkDescriptorType descriptor_type,
     const BufferInfoMap& buffer_info_map) const {
   return UpdateDescriptorSets(
-      CreateWriteDescriptorSets(set_, descriptor_type, buffer_info_map));
+      CreateWriteDescriptorSets(allocation_.set, descriptor_type,
+                                buffer_info_map));
 }
 
 const StaticDescriptor& StaticDescriptor::UpdateImageInfos(
     VkDescriptorType descriptor_type,
     const ImageInfoMap& image_info_map) const {
   return UpdateDescriptorSets(
-      CreateWriteDescriptorSets(set_, descriptor_type, image_info_map));
+      CreateWriteDescriptorSets(allocation_.set, descriptor_type,
+                                image_info_map));
 }
 
 const StaticDescriptor& StaticDescriptor::UpdateDescriptorSets(
@@ -191,14 +125,14 @@ void StaticDescriptor::Bind(const VkCommandBuffer& command_buffer,
                             VkPipelineBindPoint pipeline_binding_point) const {
   vkCmdBindDescriptorSets(
       command_buffer, pipeline_binding_point, pipeline_layout,
-      /*firstSet=*/0, /*descriptorSetCount=*/1, &set_, /*dynamicOffsetCount=*/0,
-      /*pDynamicOffsets=*/nullptr);
+      /*firstSet=*/0, /*descriptorSetCount=*/1, &allocation_.set,
+      /*dynamicOffsetCount=*/0, /*pDynamicOffsets=*/nullptr);
 }
 
 DynamicDescriptor::DynamicDescriptor(SharedBasicContext context,
                                      absl::Span<const Info> infos)
     : Descriptor{std::move(context)} {
-  set_layout(CreateDescriptorSetLayout(*context_, infos, /*is_dynamic=*/true));
+  set_layout(GetDescriptorSetLayout(*context_, infos, /*is_dynamic=*/true));
   push_descriptor_sets_func_ =
       util::LoadDeviceFunction<PFN_vkCmdPushDescriptorSetKHR>(
           *context_->device(), "vkCmdPushDescriptorSetKHR");
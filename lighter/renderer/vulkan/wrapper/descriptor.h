@@ -30,8 +30,10 @@ namespace vulkan {
 // advantage of Vulkan.
 // This is the base class of all descriptor classes. The user should use it
 // through derived classes. Since all descriptors need VkDescriptorSetLayout,
-// which declares resources used in each binding point, it will be held and
-// destroyed by this base class, and initialized by derived classes.
+// which declares resources used in each binding point, it will be held by this
+// base class, and initialized by derived classes. Layouts are cached and owned
+// by the descriptor allocator of the context, hence descriptors with the same
+// bindings share one layout.
 class Descriptor {
  public:
   using TextureType = common::ModelLoader::TextureType;
@@ -60,10 +62,7 @@ class Descriptor {
   Descriptor(const Descriptor&) = delete;
   Descriptor& operator=(const Descriptor&) = delete;
 
-  virtual ~Descriptor() {
-    vkDestroyDescriptorSetLayout(*context_->device(), layout_,
-                                 *context_->allocator());
-  }
+  virtual ~Descriptor() = default;
 
   // Accessors.
   const VkDescriptorSetLayout& layout() const { return layout_; }
@@ -86,6 +85,8 @@ class Descriptor {
 // This class creates descriptors that are updated only once during command
 // buffer recording. UpdateBufferInfos() and UpdateImageInfos() should be called
 // to relate the actual data to the descriptor before draw calls.
+// Descriptor sets are allocated from descriptor pools shared by all static
+// descriptors (see DescriptorAllocator), instead of a dedicated pool for each.
 class StaticDescriptor : public Descriptor {
  public:
   // Declares the resources that are used in shaders and specified by 'infos'.
@@ -97,8 +98,8 @@ class StaticDescriptor : public Descriptor {
   StaticDescriptor& operator=(const StaticDescriptor&) = delete;
 
   ~StaticDescriptor() override {
-    // Descriptor sets are implicitly cleaned up with the descriptor pool.
-    vkDestroyDescriptorPool(*context_->device(), pool_, *context_->allocator());
+    context_->descriptor_allocator().Free(
+        DescriptorAllocator::kPersistentPoolList, allocation_);
   }
 
   // Relates the buffer data to this descriptor.
@@ -121,11 +122,8 @@ class StaticDescriptor : public Descriptor {
   const StaticDescriptor& UpdateDescriptorSets(
       const std::vector<VkWriteDescriptorSet>& write_descriptor_sets) const;
 
-  // Opaque descriptor pool object.
-  VkDescriptorPool pool_;
-
-  // Opaque descriptor set object.
-  VkDescriptorSet set_;
+  // Opaque descriptor set object and the pool it is allocated from.
+  DescriptorAllocator::Allocation allocation_;
 };
 
 // This class creates descriptors that can be updated multiple times during the
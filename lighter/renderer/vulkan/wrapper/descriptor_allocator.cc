@@ -0,0 +1,264 @@
+//
+//  descriptor_allocator.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/descriptor_allocator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+// Maximum number of descriptor sets of the first pool in each list. Each time a
+// new pool is appended to the list, this number is doubled, until it reaches
+// kMaxSetsPerPool.
+constexpr uint32_t kInitialMaxSetsPerPool = 64;
+constexpr uint32_t kMaxSetsPerPool = 4096;
+
+// Average number of descriptors of each type per descriptor set, which is used
+// to determine pool sizes. If a descriptor set needs more descriptors than the
+// pool can provide, a new pool will be created for it.
+constexpr std::pair<VkDescriptorType, float> kDescriptorsPerSet[] = {
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 0.5f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 0.5f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0.5f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 0.5f},
+    {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f},
+};
+
+// Returns whether 'result' indicates that the pool has no space left for the
+// requested descriptor set.
+bool IsOutOfPoolMemory(VkResult result) {
+  return result == VK_ERROR_OUT_OF_POOL_MEMORY ||
+         result == VK_ERROR_FRAGMENTED_POOL;
+}
+
+} /* namespace */
+
+DescriptorAllocator::DescriptorAllocator(const BasicContext* context)
+    : context_{FATAL_IF_NULL(context)} {}
+
+DescriptorAllocator::~DescriptorAllocator() {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const VkDevice& device = *context_->device();
+  for (const auto& [pool_list_id, pool_list] : pool_lists_) {
+    // Descriptor sets are implicitly cleaned up with the descriptor pool.
+    for (const auto& pool : pool_list.pools) {
+      vkDestroyDescriptorPool(device, pool.pool, *context_->allocator());
+    }
+  }
+  for (const auto& [key, layout] : layout_cache_) {
+    vkDestroyDescriptorSetLayout(device, layout, *context_->allocator());
+  }
+}
+
+VkDescriptorSetLayout DescriptorAllocator::GetLayout(
+    absl::Span<const VkDescriptorSetLayoutBinding> bindings,
+    VkDescriptorSetLayoutCreateFlags flags) {
+  LayoutKey key{flags, /*bindings=*/{}};
+  key.bindings.reserve(bindings.size());
+  for (const auto& binding : bindings) {
+    ASSERT_TRUE(binding.pImmutableSamplers == nullptr,
+                "Immutable samplers are not supported");
+    key.bindings.push_back({binding.binding, binding.descriptorType,
+                            binding.descriptorCount, binding.stageFlags});
+  }
+  std::sort(key.bindings.begin(), key.bindings.end());
+
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const auto iter = layout_cache_.find(key);
+  if (iter != layout_cache_.end()) {
+    return iter->second;
+  }
+
+  const VkDescriptorSetLayoutCreateInfo layout_info{
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      /*pNext=*/nullptr,
+      flags,
+      CONTAINER_SIZE(bindings),
+      bindings.data(),
+  };
+  VkDescriptorSetLayout layout;
+  ASSERT_SUCCESS(vkCreateDescriptorSetLayout(*context_->device(), &layout_info,
+                                             *context_->allocator(), &layout),
+                 "Failed to create descriptor set layout");
+
+  absl::flat_hash_map<VkDescriptorType, uint32_t> pool_size_map;
+  for (const auto& binding : bindings) {
+    pool_size_map[binding.descriptorType] += binding.descriptorCount;
+  }
+  std::vector<VkDescriptorPoolSize> pool_sizes;
+  pool_sizes.reserve(pool_size_map.size());
+  for (const auto& pair : pool_size_map) {
+    pool_sizes.push_back(VkDescriptorPoolSize{
+        /*type=*/pair.first,
+        /*descriptorCount=*/pair.second,
+    });
+  }
+
+  layout_cache_.insert({std::move(key), layout});
+  layout_pool_sizes_.insert({layout, std::move(pool_sizes)});
+  return layout;
+}
+
+DescriptorAllocator::Allocation DescriptorAllocator::Allocate(
+    PoolListId pool_list_id, const VkDescriptorSetLayout& layout) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const auto pool_sizes_iter = layout_pool_sizes_.find(layout);
+  ASSERT_TRUE(pool_sizes_iter != layout_pool_sizes_.end(),
+              "Descriptor set layout is not created by this allocator");
+
+  const VkDevice& device = *context_->device();
+  VkDescriptorSetAllocateInfo set_info{
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      /*pNext=*/nullptr,
+      /*descriptorPool=*/VK_NULL_HANDLE,
+      /*descriptorSetCount=*/1,
+      &layout,
+  };
+  Allocation allocation;
+
+  // Usually only the last pool is not exhausted, unless some pools have been
+  // reset, hence this loop is short.
+  PoolList& pool_list =
+      pool_lists_.try_emplace(pool_list_id,
+                              PoolList{/*pools=*/{}, kInitialMaxSetsPerPool})
+          .first->second;
+  for (auto& pool : pool_list.pools) {
+    if (pool.is_exhausted) {
+      continue;
+    }
+    set_info.descriptorPool = pool.pool;
+    const VkResult result =
+        vkAllocateDescriptorSets(device, &set_info, &allocation.set);
+    if (result == VK_SUCCESS) {
+      ++pool.num_live_sets;
+      allocation.pool = pool.pool;
+      return allocation;
+    }
+    ASSERT_TRUE(IsOutOfPoolMemory(result),
+                absl::StrFormat("Errno %d: Failed to allocate descriptor set",
+                                result));
+    pool.is_exhausted = true;
+  }
+
+  // All pools are exhausted, hence we need a new one.
+  const VkDescriptorPool new_pool =
+      CreatePool(pool_list.next_max_sets, pool_sizes_iter->second);
+  pool_list.next_max_sets =
+      std::min(pool_list.next_max_sets * 2, kMaxSetsPerPool);
+  pool_list.pools.push_back(Pool{new_pool, /*num_live_sets=*/1,
+                                 /*is_exhausted=*/false});
+
+  set_info.descriptorPool = new_pool;
+  ASSERT_SUCCESS(vkAllocateDescriptorSets(device, &set_info, &allocation.set),
+                 "Failed to allocate descriptor set");
+  allocation.pool = new_pool;
+  return allocation;
+}
+
+void DescriptorAllocator::Free(PoolListId pool_list_id,
+                               const Allocation& allocation) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  Pool& pool = FindPool(pool_list_id, allocation.pool);
+  ASSERT_TRUE(pool.num_live_sets > 0, "Descriptor set is freed twice");
+  if (--pool.num_live_sets == 0) {
+    vkResetDescriptorPool(*context_->device(), pool.pool, /*flags=*/0);
+    pool.is_exhausted = false;
+  }
+}
+
+void DescriptorAllocator::Reset(PoolListId pool_list_id) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  const auto iter = pool_lists_.find(pool_list_id);
+  if (iter == pool_lists_.end()) {
+    return;
+  }
+  for (auto& pool : iter->second.pools) {
+    if (pool.num_live_sets > 0 || pool.is_exhausted) {
+      vkResetDescriptorPool(*context_->device(), pool.pool, /*flags=*/0);
+      pool.num_live_sets = 0;
+      pool.is_exhausted = false;
+    }
+  }
+}
+
+int DescriptorAllocator::GetNumPools() const {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  int num_pools = 0;
+  for (const auto& [pool_list_id, pool_list] : pool_lists_) {
+    num_pools += pool_list.pools.size();
+  }
+  return num_pools;
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(
+    uint32_t max_sets,
+    const std::vector<VkDescriptorPoolSize>& set_pool_sizes) const {
+  absl::flat_hash_map<VkDescriptorType, uint32_t> pool_size_map;
+  for (const auto& [type, descriptors_per_set] : kDescriptorsPerSet) {
+    pool_size_map[type] =
+        static_cast<uint32_t>(std::ceil(descriptors_per_set * max_sets));
+  }
+  for (const auto& pool_size : set_pool_sizes) {
+    uint32_t& count = pool_size_map[pool_size.type];
+    count = std::max(count, pool_size.descriptorCount);
+  }
+
+  std::vector<VkDescriptorPoolSize> pool_sizes;
+  pool_sizes.reserve(pool_size_map.size());
+  for (const auto& pair : pool_size_map) {
+    pool_sizes.push_back(VkDescriptorPoolSize{
+        /*type=*/pair.first,
+        /*descriptorCount=*/pair.second,
+    });
+  }
+
+  const VkDescriptorPoolCreateInfo pool_info{
+      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+      max_sets,
+      CONTAINER_SIZE(pool_sizes),
+      pool_sizes.data(),
+  };
+
+  VkDescriptorPool pool;
+  ASSERT_SUCCESS(vkCreateDescriptorPool(*context_->device(), &pool_info,
+                                        *context_->allocator(), &pool),
+                 "Failed to create descriptor pool");
+  return pool;
+}
+
+DescriptorAllocator::Pool& DescriptorAllocator::FindPool(
+    PoolListId pool_list_id, const VkDescriptorPool& pool) {
+  const auto iter = pool_lists_.find(pool_list_id);
+  ASSERT_TRUE(iter != pool_lists_.end(),
+              absl::StrFormat("No pool list with ID %d", pool_list_id));
+  // Each list only has a few pools, since they grow geometrically.
+  for (auto& candidate : iter->second.pools) {
+    if (candidate.pool == pool) {
+      return candidate;
+    }
+  }
+  FATAL("Descriptor pool is not in the pool list");
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
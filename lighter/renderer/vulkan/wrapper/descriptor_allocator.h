@@ -0,0 +1,158 @@
+//
+//  descriptor_allocator.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_DESCRIPTOR_ALLOCATOR_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_DESCRIPTOR_ALLOCATOR_H
+
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/types/span.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Forward declarations.
+class BasicContext;
+
+// This class allocates descriptor sets from lists of large descriptor pools, so
+// that we don't need to create a pool for each descriptor set. Descriptor sets
+// with similar lifetimes should be allocated from the same list. When all pools
+// in a list are exhausted, a larger pool is appended to it. Pools are never
+// destroyed until this class is destructed. Instead, a pool is reset and reused
+// once all descriptor sets allocated from it are freed, or when the whole list
+// is reset.
+// This class also caches descriptor set layouts, so that descriptors with the
+// same bindings share one layout. Layouts are destroyed with this class.
+// All methods are thread-safe. The user is responsible for making sure that
+// the device is no longer using descriptor sets when freeing them.
+class DescriptorAllocator {
+ public:
+  // Identifies a list of pools. Descriptor sets that live across frames and are
+  // freed individually, such as those owned by StaticDescriptor, should be
+  // allocated from kPersistentPoolList. Descriptor sets that only live in one
+  // frame should be allocated from the list identified by the frame index, and
+  // that list should be reset once the frame finishes executing on the device.
+  using PoolListId = int;
+  static constexpr PoolListId kPersistentPoolList = -1;
+
+  // A descriptor set and the pool it is allocated from.
+  struct Allocation {
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+  };
+
+  explicit DescriptorAllocator(const BasicContext* context);
+
+  // This class is neither copyable nor movable.
+  DescriptorAllocator(const DescriptorAllocator&) = delete;
+  DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+  // Destroys all descriptor pools and cached descriptor set layouts.
+  ~DescriptorAllocator();
+
+  // Returns a descriptor set layout with 'bindings' and 'flags'. The layout is
+  // created only if no layout with the same description has been created. The
+  // order of 'bindings' does not matter. Immutable samplers are not supported.
+  VkDescriptorSetLayout GetLayout(
+      absl::Span<const VkDescriptorSetLayoutBinding> bindings,
+      VkDescriptorSetLayoutCreateFlags flags);
+
+  // Allocates a descriptor set with 'layout', which must be returned by
+  // GetLayout(), from the list of pools identified by 'pool_list'.
+  Allocation Allocate(PoolListId pool_list,
+                      const VkDescriptorSetLayout& layout);
+
+  // Frees a descriptor set allocated from 'pool_list'. The memory is reclaimed
+  // once all descriptor sets allocated from the same pool are freed.
+  void Free(PoolListId pool_list, const Allocation& allocation);
+
+  // Frees all descriptor sets allocated from 'pool_list' at once, and keeps
+  // pools in the list for future allocations.
+  void Reset(PoolListId pool_list);
+
+  // Returns the number of descriptor pools in all lists.
+  int GetNumPools() const;
+
+ private:
+  // Description of a descriptor set layout, which is used as the key of the
+  // layout cache. Each binding consists of the binding point, descriptor type,
+  // array length and shader stages, and bindings are sorted by binding points.
+  struct LayoutKey {
+    using Binding =
+        std::tuple<uint32_t, VkDescriptorType, uint32_t, VkShaderStageFlags>;
+
+    bool operator==(const LayoutKey& other) const {
+      return flags == other.flags && bindings == other.bindings;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H hash_state, const LayoutKey& key) {
+      return H::combine(std::move(hash_state), key.flags, key.bindings);
+    }
+
+    VkDescriptorSetLayoutCreateFlags flags;
+    std::vector<Binding> bindings;
+  };
+
+  // A descriptor pool and its usage.
+  struct Pool {
+    VkDescriptorPool pool;
+
+    // Number of descriptor sets that have been allocated and not been freed.
+    int num_live_sets;
+
+    // Whether the last allocation failed because the pool ran out of memory.
+    bool is_exhausted;
+  };
+
+  // Pools that serve one type of descriptor set lifetime.
+  struct PoolList {
+    std::vector<Pool> pools;
+
+    // Maximum number of descriptor sets of the next pool to create.
+    uint32_t next_max_sets;
+  };
+
+  // Creates a pool that can hold at least 'max_sets' descriptor sets, including
+  // at least one with 'set_pool_sizes'.
+  VkDescriptorPool CreatePool(
+      uint32_t max_sets,
+      const std::vector<VkDescriptorPoolSize>& set_pool_sizes) const;
+
+  // Returns the pool in 'pool_list' that 'pool' refers to.
+  Pool& FindPool(PoolListId pool_list, const VkDescriptorPool& pool);
+
+  // Pointer to context.
+  const BasicContext* context_;
+
+  // Maps layout descriptions to cached layouts.
+  absl::flat_hash_map<LayoutKey, VkDescriptorSetLayout> layout_cache_;
+
+  // Maps cached layouts to the number of descriptors of each type that one
+  // descriptor set with the layout needs.
+  absl::flat_hash_map<VkDescriptorSetLayout, std::vector<VkDescriptorPoolSize>>
+      layout_pool_sizes_;
+
+  // Maps pool list IDs to pool lists.
+  absl::flat_hash_map<PoolListId, PoolList> pool_lists_;
+
+  // Guards all members above.
+  mutable std::mutex mutex_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_DESCRIPTOR_ALLOCATOR_H */
@@ -0,0 +1,170 @@
+//
+//  device_memory.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/device_memory.h"
+
+#include <algorithm>
+
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+using common::BlockSubAllocator;
+
+// Default size of device memory blocks.
+constexpr VkDeviceSize kDefaultBlockSize = VkDeviceSize{64} << 20;
+
+// Heaps no larger than this are considered small, and use smaller blocks.
+constexpr VkDeviceSize kSmallHeapSize = VkDeviceSize{1} << 30;
+
+// Returns the size of blocks allocated from 'heap'.
+VkDeviceSize GetBlockSize(const VkMemoryHeap& heap) {
+  return heap.size <= kSmallHeapSize ? std::max<VkDeviceSize>(heap.size / 8, 1)
+                                     : kDefaultBlockSize;
+}
+
+// Returns the index of pool for 'memory_type_index' and 'resource_type'.
+int GetPoolIndex(uint32_t memory_type_index,
+                 DeviceMemoryAllocator::ResourceType resource_type) {
+  return static_cast<int>(memory_type_index) * 2 +
+         (resource_type == DeviceMemoryAllocator::ResourceType::kImage ? 1 : 0);
+}
+
+} /* namespace */
+
+DeviceMemoryAllocator::DeviceMemoryAllocator(const BasicContext* context)
+    : context_{FATAL_IF_NULL(context)} {
+  vkGetPhysicalDeviceMemoryProperties(*context_->physical_device(),
+                                      &memory_properties_);
+}
+
+DeviceMemoryAllocator::~DeviceMemoryAllocator() {
+#ifndef NDEBUG
+  const BlockSubAllocator::Stats stats = GetStats();
+  if (stats.num_allocations > 0) {
+    LOG_INFO << absl::StrFormat("%d device memory allocations are leaked",
+                                stats.num_allocations);
+  }
+#endif  /* !NDEBUG */
+}
+
+DeviceMemoryAllocation DeviceMemoryAllocator::Allocate(
+    const VkMemoryRequirements& memory_requirements,
+    VkMemoryPropertyFlags memory_properties, ResourceType resource_type) {
+  const uint32_t memory_type_index = util::FindMemoryTypeIndex(
+      *context_->physical_device(), memory_requirements.memoryTypeBits,
+      memory_properties);
+  const int pool_index = GetPoolIndex(memory_type_index, resource_type);
+
+  const std::lock_guard<std::mutex> lock{mutex_};
+  auto& pool = pools_[pool_index];
+  if (pool == nullptr) {
+    pool = CreatePool(memory_type_index);
+  }
+  const BlockSubAllocator::Allocation range = pool->sub_allocator->Allocate(
+      memory_requirements.size, memory_requirements.alignment);
+
+  DeviceMemoryAllocation allocation;
+  allocation.memory = pool->blocks[range.block_index];
+  allocation.offset = range.offset;
+  if (void* mapped_data = pool->mapped_data[range.block_index];
+      mapped_data != nullptr) {
+    allocation.mapped_data = static_cast<char*>(mapped_data) + range.offset;
+  }
+  allocation.pool_index = pool_index;
+  allocation.range = range;
+  return allocation;
+}
+
+void DeviceMemoryAllocator::Free(const DeviceMemoryAllocation& allocation) {
+  if (allocation.pool_index < 0) {
+    return;
+  }
+  const std::lock_guard<std::mutex> lock{mutex_};
+  pools_[allocation.pool_index]->sub_allocator->Free(allocation.range);
+}
+
+BlockSubAllocator::Stats DeviceMemoryAllocator::GetStats() const {
+  BlockSubAllocator::Stats stats;
+  const std::lock_guard<std::mutex> lock{mutex_};
+  for (const auto& pool : pools_) {
+    if (pool == nullptr) {
+      continue;
+    }
+    const BlockSubAllocator::Stats pool_stats =
+        pool->sub_allocator->GetStats();
+    stats.num_blocks += pool_stats.num_blocks;
+    stats.num_allocations += pool_stats.num_allocations;
+    stats.bytes_reserved += pool_stats.bytes_reserved;
+    stats.bytes_in_use += pool_stats.bytes_in_use;
+    stats.largest_free_range =
+        std::max(stats.largest_free_range, pool_stats.largest_free_range);
+  }
+  const VkDeviceSize bytes_free = stats.bytes_reserved - stats.bytes_in_use;
+  if (bytes_free > 0) {
+    stats.fragmentation =
+        1.0f - static_cast<float>(stats.largest_free_range) / bytes_free;
+  }
+  return stats;
+}
+
+std::unique_ptr<DeviceMemoryAllocator::Pool> DeviceMemoryAllocator::CreatePool(
+    uint32_t memory_type_index) {
+  const VkMemoryType& memory_type =
+      memory_properties_.memoryTypes[memory_type_index];
+  const bool is_host_visible =
+      memory_type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+  auto pool = std::make_unique<Pool>();
+  Pool* pool_ptr = pool.get();
+  auto create_block = [this, pool_ptr, memory_type_index, is_host_visible](
+      int block_index, uint64_t block_size) {
+    const VkMemoryAllocateInfo memory_info{
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        /*pNext=*/nullptr,
+        /*allocationSize=*/block_size,
+        memory_type_index,
+    };
+    VkDeviceMemory memory;
+    ASSERT_SUCCESS(vkAllocateMemory(*context_->device(), &memory_info,
+                                    *context_->allocator(), &memory),
+                   "Failed to allocate device memory");
+
+    void* mapped_data = nullptr;
+    if (is_host_visible) {
+      ASSERT_SUCCESS(vkMapMemory(*context_->device(), memory, /*offset=*/0,
+                                 VK_WHOLE_SIZE, /*flags=*/0, &mapped_data),
+                     "Failed to map device memory");
+    }
+
+    if (block_index >= pool_ptr->blocks.size()) {
+      pool_ptr->blocks.resize(block_index + 1, VK_NULL_HANDLE);
+      pool_ptr->mapped_data.resize(block_index + 1, nullptr);
+    }
+    pool_ptr->blocks[block_index] = memory;
+    pool_ptr->mapped_data[block_index] = mapped_data;
+  };
+  auto destroy_block = [this, pool_ptr](int block_index) {
+    // Mapped memory is implicitly unmapped when freed.
+    vkFreeMemory(*context_->device(), pool_ptr->blocks[block_index],
+                 *context_->allocator());
+    pool_ptr->blocks[block_index] = VK_NULL_HANDLE;
+    pool_ptr->mapped_data[block_index] = nullptr;
+  };
+  pool->sub_allocator = std::make_unique<BlockSubAllocator>(
+      GetBlockSize(memory_properties_.memoryHeaps[memory_type.heapIndex]),
+      std::move(create_block), std::move(destroy_block));
+  return pool;
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
@@ -0,0 +1,112 @@
+//
+//  device_memory.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_DEVICE_MEMORY_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_DEVICE_MEMORY_H
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lighter/common/sub_allocator.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Forward declarations.
+class BasicContext;
+
+// A range of device memory that can be bound to a buffer or an image.
+struct DeviceMemoryAllocation {
+  // Device memory block that contains this range.
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+
+  // Offset of this range within 'memory'.
+  VkDeviceSize offset = 0;
+
+  // Host pointer to the start of this range. This is nullptr if the memory is
+  // not host visible.
+  void* mapped_data = nullptr;
+
+  // Used by DeviceMemoryAllocator to free this range.
+  int pool_index = -1;
+  common::BlockSubAllocator::Allocation range{};
+};
+
+// Calling vkAllocateMemory() for each buffer and image is slow, and the number
+// of allocations is limited by 'maxMemoryAllocationCount'. Instead, this class
+// allocates large blocks of device memory, and sub-allocates ranges from them
+// with common::BlockSubAllocator. There is one pool of blocks per memory type.
+// Buffers and images are put in different pools, so that we never need to
+// consider 'bufferImageGranularity'. Blocks of host visible memory are mapped
+// once they are created, and stay mapped until destroyed.
+// This class is thread-safe.
+class DeviceMemoryAllocator {
+ public:
+  // Kind of resources that the memory is bound to.
+  enum class ResourceType { kBuffer, kImage };
+
+  explicit DeviceMemoryAllocator(const BasicContext* context);
+
+  // This class is neither copyable nor movable.
+  DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+  DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+  // Frees all blocks. All allocations should have been freed before this.
+  ~DeviceMemoryAllocator();
+
+  // Allocates a range of device memory that meets 'memory_requirements' and
+  // has 'memory_properties'.
+  DeviceMemoryAllocation Allocate(
+      const VkMemoryRequirements& memory_requirements,
+      VkMemoryPropertyFlags memory_properties, ResourceType resource_type);
+
+  // Frees 'allocation'. Nothing happens if it is not allocated.
+  void Free(const DeviceMemoryAllocation& allocation);
+
+  // Returns statistics of all pools.
+  common::BlockSubAllocator::Stats GetStats() const;
+
+ private:
+  // Blocks of one memory type for one type of resources.
+  struct Pool {
+    // Device memory blocks indexed by block index.
+    std::vector<VkDeviceMemory> blocks;
+
+    // Mapped host pointers of 'blocks', if they are host visible.
+    std::vector<void*> mapped_data;
+
+    // This must be destructed before other members, since it destroys all
+    // remaining blocks.
+    std::unique_ptr<common::BlockSubAllocator> sub_allocator;
+  };
+
+  // Returns a new pool for 'memory_type_index'.
+  std::unique_ptr<Pool> CreatePool(uint32_t memory_type_index);
+
+  // Pointer to context.
+  const BasicContext* context_;
+
+  // Memory types and heaps of the physical device.
+  VkPhysicalDeviceMemoryProperties memory_properties_;
+
+  // Pools indexed by memory type index and resource type. Pools are created
+  // when first used.
+  std::array<std::unique_ptr<Pool>, VK_MAX_MEMORY_TYPES * 2> pools_;
+
+  // Guards 'pools_'.
+  mutable std::mutex mutex_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_DEVICE_MEMORY_H */
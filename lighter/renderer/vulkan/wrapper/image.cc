@@ -8,9 +8,14 @@
 #include "lighter/renderer/vulkan/wrapper/image.h"
 
 #include <algorithm>
+#include <future>
+#include <string>
 
-#include "lighter/renderer/vulkan/wrapper/command.h"
+#include "lighter/common/thread_pool.h"
 #include "lighter/renderer/vulkan/wrapper/image_util.h"
+#include "lighter/renderer/vulkan/wrapper/uploader.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/strings/str_cat.h"
 #include "third_party/absl/strings/str_format.h"
 
 namespace lighter {
@@ -182,34 +187,24 @@ VkImage CreateImage(const BasicContext& context,
   return image;
 }
 
-// Allocates device memory for 'image' with 'memory_properties'.
-VkDeviceMemory CreateImageMemory(const BasicContext& context,
-                                 const VkImage& image,
-                                 VkMemoryPropertyFlags memory_properties) {
+// Allocates device memory for 'image' with 'memory_properties', and binds it
+// with 'image'.
+DeviceMemoryAllocation CreateImageMemory(
+    const BasicContext& context, const VkImage& image,
+    VkMemoryPropertyFlags memory_properties) {
   const VkDevice& device = *context.device();
 
   VkMemoryRequirements memory_requirements;
   vkGetImageMemoryRequirements(device, image, &memory_requirements);
 
-  const VkMemoryAllocateInfo memory_info{
-      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-      /*pNext=*/nullptr,
-      /*allocationSize=*/memory_requirements.size,
-      util::FindMemoryTypeIndex(*context.physical_device(),
-                                memory_requirements.memoryTypeBits,
-                                memory_properties),
-  };
-
-  VkDeviceMemory memory;
-  ASSERT_SUCCESS(vkAllocateMemory(device, &memory_info,
-                                  *context.allocator(), &memory),
-                 "Failed to allocate image memory");
-
-  // Bind the allocated memory with 'image'. If this memory is used for
-  // multiple images, the memory offset should be re-calculated and
-  // VkMemoryRequirements.alignment should be considered.
-  vkBindImageMemory(device, image, memory, /*memoryOffset=*/0);
-  return memory;
+  // All images created here use VK_IMAGE_TILING_OPTIMAL, and they are kept in
+  // different pools from buffers, so 'bufferImageGranularity' is not a concern.
+  const DeviceMemoryAllocation allocation =
+      context.device_memory_allocator().Allocate(
+          memory_requirements, memory_properties,
+          DeviceMemoryAllocator::ResourceType::kImage);
+  vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+  return allocation;
 }
 
 // Inserts a pipeline barrier for transitioning the image layout.
@@ -234,37 +229,34 @@ void WaitForImageMemoryBarrier(
       &barrier);
 }
 
-// Transitions image layout using the transfer queue.
+// Records commands to transition image layout into 'command_buffer', which
+// will be submitted to the queue with 'queue_family_index'.
 void TransitionImageLayout(
-    const SharedBasicContext& context,
+    const VkCommandBuffer& command_buffer, uint32_t queue_family_index,
     const VkImage& image, const ImageConfig& image_config,
     VkImageAspectFlags image_aspect,
     const std::array<VkImageLayout, 2>& image_layouts,
     const std::array<VkAccessFlags, 2>& access_flags,
     const std::array<VkPipelineStageFlags, 2>& pipeline_stages) {
-  const auto& transfer_queue = context->queues().transfer_queue();
-  const OneTimeCommand command{context, &transfer_queue};
-  command.Run([&](const VkCommandBuffer& command_buffer) {
-    const VkImageMemoryBarrier barrier{
-        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        /*pNext=*/nullptr,
-        access_flags[0],
-        access_flags[1],
-        image_layouts[0],
-        image_layouts[1],
-        /*srcQueueFamilyIndex=*/transfer_queue.family_index,
-        /*dstQueueFamilyIndex=*/transfer_queue.family_index,
-        image,
-        VkImageSubresourceRange{
-            image_aspect,
-            /*baseMipLevel=*/0,
-            image_config.mip_levels,
-            /*baseArrayLayer=*/0,
-            image_config.layer_count,
-        },
-    };
-    WaitForImageMemoryBarrier(barrier, command_buffer, pipeline_stages);
-  });
+  const VkImageMemoryBarrier barrier{
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      /*pNext=*/nullptr,
+      access_flags[0],
+      access_flags[1],
+      image_layouts[0],
+      image_layouts[1],
+      /*srcQueueFamilyIndex=*/queue_family_index,
+      /*dstQueueFamilyIndex=*/queue_family_index,
+      image,
+      VkImageSubresourceRange{
+          image_aspect,
+          /*baseMipLevel=*/0,
+          image_config.mip_levels,
+          /*baseArrayLayer=*/0,
+          image_config.layer_count,
+      },
+  };
+  WaitForImageMemoryBarrier(barrier, command_buffer, pipeline_stages);
 }
 
 // Converts 2D dimension to 3D offset, where the expanded dimension is set to 1.
@@ -295,104 +287,103 @@ std::vector<VkExtent2D> GenerateMipmapExtents(const VkExtent3D& image_extent) {
   return mipmap_extents;
 }
 
-// Generates mipmaps for 'image' using the transfer queue.
-void GenerateMipmaps(const SharedBasicContext& context,
+// Records commands to generate mipmaps for 'image' into 'command_buffer', which
+// will be submitted to the queue with 'queue_family_index'.
+void GenerateMipmaps(const BasicContext& context,
+                     const VkCommandBuffer& command_buffer,
+                     uint32_t queue_family_index,
                      const VkImage& image, VkFormat image_format,
                      const VkExtent3D& image_extent,
                      const std::vector<VkExtent2D>& mipmap_extents) {
   VkFormatProperties properties;
-  vkGetPhysicalDeviceFormatProperties(*context->physical_device(),
+  vkGetPhysicalDeviceFormatProperties(*context.physical_device(),
                                       image_format, &properties);
   ASSERT_TRUE(properties.optimalTilingFeatures &
                   VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT,
               "Image format does not support linear blitting");
 
-  const auto& transfer_queue = context->queues().transfer_queue();
-  const OneTimeCommand command{context, &transfer_queue};
-  command.Run([&](const VkCommandBuffer& command_buffer) {
-    VkImageMemoryBarrier barrier{
-        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        /*pNext=*/nullptr,
-        /*srcAccessMask=*/0,  // To be updated.
-        /*dstAccessMask=*/0,  // To be updated.
-        /*oldLayout=*/VK_IMAGE_LAYOUT_UNDEFINED,  // To be updated.
-        /*newLayout=*/VK_IMAGE_LAYOUT_UNDEFINED,  // To be updated.
-        /*srcQueueFamilyIndex=*/transfer_queue.family_index,
-        /*dstQueueFamilyIndex=*/transfer_queue.family_index,
-        image,
-        VkImageSubresourceRange{
+  VkImageMemoryBarrier barrier{
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      /*pNext=*/nullptr,
+      /*srcAccessMask=*/0,  // To be updated.
+      /*dstAccessMask=*/0,  // To be updated.
+      /*oldLayout=*/VK_IMAGE_LAYOUT_UNDEFINED,  // To be updated.
+      /*newLayout=*/VK_IMAGE_LAYOUT_UNDEFINED,  // To be updated.
+      /*srcQueueFamilyIndex=*/queue_family_index,
+      /*dstQueueFamilyIndex=*/queue_family_index,
+      image,
+      VkImageSubresourceRange{
+          VK_IMAGE_ASPECT_COLOR_BIT,
+          /*baseMipLevel=*/0,  // To be updated.
+          /*levelCount=*/1,
+          /*baseArrayLayer=*/0,
+          /*layerCount=*/1,
+      },
+  };
+
+  uint32_t dst_level = 1;
+  VkExtent2D prev_extent{image_extent.width, image_extent.height};
+  for (const auto& extent : mipmap_extents) {
+    const uint32_t src_level = dst_level - 1;
+
+    // Transition the layout of previous layer to TRANSFER_SRC_OPTIMAL.
+    barrier.subresourceRange.baseMipLevel = src_level;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    WaitForImageMemoryBarrier(barrier, command_buffer,
+                              {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT});
+
+    // Blit the previous level to next level after transitioning is done.
+    const VkImageBlit image_blit{
+        /*srcSubresource=*/VkImageSubresourceLayers{
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            /*mipLevel=*/src_level,
+            /*baseArrayLayer=*/0,
+            /*layerCount=*/1,
+        },
+        /*srcOffsets=*/{
+            VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
+            ExtentToOffset(prev_extent),
+        },
+        /*dstSubresource=*/VkImageSubresourceLayers{
             VK_IMAGE_ASPECT_COLOR_BIT,
-            /*baseMipLevel=*/0,  // To be updated.
-            /*levelCount=*/1,
+            /*mipLevel=*/dst_level,
             /*baseArrayLayer=*/0,
             /*layerCount=*/1,
         },
+        /*dstOffsets=*/{
+            VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
+            ExtentToOffset(extent),
+        },
     };
 
-    uint32_t dst_level = 1;
-    VkExtent2D prev_extent{image_extent.width, image_extent.height};
-    for (const auto& extent : mipmap_extents) {
-      const uint32_t src_level = dst_level - 1;
-
-      // Transition the layout of previous layer to TRANSFER_SRC_OPTIMAL.
-      barrier.subresourceRange.baseMipLevel = src_level;
-      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-      WaitForImageMemoryBarrier(barrier, command_buffer,
-                                {VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT});
-
-      // Blit the previous level to next level after transitioning is done.
-      const VkImageBlit image_blit{
-          /*srcSubresource=*/VkImageSubresourceLayers{
-              VK_IMAGE_ASPECT_COLOR_BIT,
-              /*mipLevel=*/src_level,
-              /*baseArrayLayer=*/0,
-              /*layerCount=*/1,
-          },
-          /*srcOffsets=*/{
-              VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
-              ExtentToOffset(prev_extent),
-          },
-          /*dstSubresource=*/VkImageSubresourceLayers{
-              VK_IMAGE_ASPECT_COLOR_BIT,
-              /*mipLevel=*/dst_level,
-              /*baseArrayLayer=*/0,
-              /*layerCount=*/1,
-          },
-          /*dstOffsets=*/{
-              VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
-              ExtentToOffset(extent),
-          },
-      };
-
-      vkCmdBlitImage(command_buffer,
-                     /*srcImage=*/image,
-                     /*srcImageLayout=*/VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                     /*dstImage=*/image,
-                     /*dstImageLayout=*/VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                     /*regionCount=*/1, &image_blit, VK_FILTER_LINEAR);
-
-      ++dst_level;
-      prev_extent = extent;
-    }
+    vkCmdBlitImage(command_buffer,
+                   /*srcImage=*/image,
+                   /*srcImageLayout=*/VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   /*dstImage=*/image,
+                   /*dstImageLayout=*/VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   /*regionCount=*/1, &image_blit, VK_FILTER_LINEAR);
 
-    // Transition the layout of all levels to SHADER_READ_ONLY_OPTIMAL.
-    for (uint32_t level = 0; level < mipmap_extents.size() + 1; ++level) {
-      barrier.subresourceRange.baseMipLevel = level;
-      barrier.oldLayout = level == mipmap_extents.size()
-                              ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-                              : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-      barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-      WaitForImageMemoryBarrier(barrier, command_buffer,
-                                {VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT});
-    }
-  });
+    ++dst_level;
+    prev_extent = extent;
+  }
+
+  // Transition the layout of all levels to SHADER_READ_ONLY_OPTIMAL.
+  for (uint32_t level = 0; level < mipmap_extents.size() + 1; ++level) {
+    barrier.subresourceRange.baseMipLevel = level;
+    barrier.oldLayout = level == mipmap_extents.size()
+                            ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                            : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    WaitForImageMemoryBarrier(barrier, command_buffer,
+                              {VK_PIPELINE_STAGE_TRANSFER_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT});
+  }
 }
 
 // Creates an image view to specify the usage of image data.
@@ -479,34 +470,54 @@ VkSampler CreateSampler(const BasicContext& context,
   return sampler;
 }
 
-} /* namespace */
+// Returns the decoder shared by all textures, which runs on the shared thread
+// pool.
+common::ImageDecoder& GetImageDecoder() {
+  static auto* decoder =
+      new common::ImageDecoder{common::GetSharedThreadPool()};
+  return *decoder;
+}
 
-void ImageStagingBuffer::CopyToImage(const VkImage& target,
-                                     const VkExtent3D& image_extent,
-                                     uint32_t image_layer_count) const {
-  const OneTimeCommand command{context_, &context_->queues().transfer_queue()};
-  command.Run([&](const VkCommandBuffer& command_buffer) {
-    const VkBufferImageCopy region{
-        // First three parameters specify pixels layout in buffer.
-        // Setting all of them to 0 means pixels are tightly packed.
-        /*bufferOffset=*/0,
-        /*bufferRowLength=*/0,
-        /*bufferImageHeight=*/0,
-        VkImageSubresourceLayers{
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            /*mipLevel=*/0,
-            /*baseArrayLayer=*/0,
-            image_layer_count,
-        },
-        VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
-        image_extent,
-    };
-    vkCmdCopyBufferToImage(command_buffer, buffer(), target,
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                           /*regionCount=*/1, &region);
-  });
+// Returns the identifier of texture loaded from 'source_path'.
+const std::string& GetTextureIdentifier(
+    const SharedTexture::SourcePath& source_path) {
+  if (const auto* single_tex_path =
+          std::get_if<SharedTexture::SingleTexPath>(&source_path);
+      single_tex_path != nullptr) {
+    return *single_tex_path;
+  } else if (const auto* cubemap_path =
+                 std::get_if<SharedTexture::CubemapPath>(&source_path);
+             cubemap_path != nullptr) {
+    return cubemap_path->directory;
+  } else {
+    FATAL("Unrecognized variant type");
+  }
+}
+
+// Starts decoding the image from 'source_path' on worker threads.
+std::future<common::Image> DecodeImage(
+    const SharedTexture::SourcePath& source_path) {
+  if (const auto* single_tex_path =
+          std::get_if<SharedTexture::SingleTexPath>(&source_path);
+      single_tex_path != nullptr) {
+    return GetImageDecoder().DecodeSingleImage(*single_tex_path,
+                                               /*flip_y=*/false);
+  } else if (const auto* cubemap_path =
+                 std::get_if<SharedTexture::CubemapPath>(&source_path);
+             cubemap_path != nullptr) {
+    std::vector<std::string> paths;
+    paths.reserve(cubemap_path->files.size());
+    for (const auto& file : cubemap_path->files) {
+      paths.push_back(absl::StrCat(cubemap_path->directory, "/", file));
+    }
+    return GetImageDecoder().DecodeCubemap(std::move(paths), /*flip_y=*/false);
+  } else {
+    FATAL("Unrecognized variant type");
+  }
 }
 
+} /* namespace */
+
 ImageSampler::ImageSampler(SharedBasicContext context,
                            int mip_levels, const Config& config)
     : context_{std::move(FATAL_IF_NULL(context))},
@@ -582,63 +593,121 @@ TextureImage::TextureBuffer::TextureBuffer(
   set_device_memory(CreateImageMemory(
       *context_, image(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
 
-  // Copy data from host to image buffer via staging buffer.
-  TransitionImageLayout(
-      context_, image(), image_config, VK_IMAGE_ASPECT_COLOR_BIT,
-      {VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL},
-      {kNullAccessFlag, VK_ACCESS_TRANSFER_WRITE_BIT},
-      {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT});
+  // Copy data from host to image buffer via the staging uploader. Commands are
+  // recorded into the current batch of the uploader, which will be submitted
+  // before any command that may use this image.
+  StagingUploader& uploader = context_->staging_uploader();
+  const uint32_t queue_family_index =
+      context_->queues().transfer_queue().family_index;
+  const VkImage& target = image();
+  uploader.Record([&](const VkCommandBuffer& command_buffer) {
+    TransitionImageLayout(
+        command_buffer, queue_family_index, target, image_config,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        {VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL},
+        {kNullAccessFlag, VK_ACCESS_TRANSFER_WRITE_BIT},
+        {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT});
+  });
 
-  const ImageStagingBuffer staging_buffer{context_, info.GetCopyInfos()};
-  staging_buffer.CopyToImage(image(), image_extent, image_config.layer_count);
+  const Buffer::CopyInfos copy_infos = info.GetCopyInfos();
+  uploader.Upload(
+      copy_infos.total_size,
+      [&copy_infos](void* dst) { copy_infos.CopyToHostMemory(dst); },
+      [&](const VkCommandBuffer& command_buffer, const VkBuffer& staging_buffer,
+          VkDeviceSize staging_offset) {
+        const VkBufferImageCopy region{
+            // First three parameters specify pixels layout in buffer.
+            // Setting the last two of them to 0 means pixels are tightly
+            // packed.
+            /*bufferOffset=*/staging_offset,
+            /*bufferRowLength=*/0,
+            /*bufferImageHeight=*/0,
+            VkImageSubresourceLayers{
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                /*mipLevel=*/0,
+                /*baseArrayLayer=*/0,
+                image_config.layer_count,
+            },
+            VkOffset3D{/*x=*/0, /*y=*/0, /*z=*/0},
+            image_extent,
+        };
+        vkCmdCopyBufferToImage(command_buffer, staging_buffer, target,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               /*regionCount=*/1, &region);
+      });
+
+  uploader.Record([&](const VkCommandBuffer& command_buffer) {
+    if (generate_mipmaps) {
+      GenerateMipmaps(*context_, command_buffer, queue_family_index, target,
+                      info.format, image_extent, mipmap_extents);
+    } else {
+      TransitionImageLayout(
+          command_buffer, queue_family_index, target, image_config,
+          VK_IMAGE_ASPECT_COLOR_BIT,
+          {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+          {VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT},
+          {VK_PIPELINE_STAGE_TRANSFER_BIT,
+           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT});
+    }
+  });
+}
 
-  if (generate_mipmaps) {
-    GenerateMipmaps(context_, image(), info.format,
-                    image_extent, mipmap_extents);
-  } else {
-    TransitionImageLayout(
-        context_, image(), image_config, VK_IMAGE_ASPECT_COLOR_BIT,
-        {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
-        {VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT},
-        {VK_PIPELINE_STAGE_TRANSFER_BIT,
-         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT});
+std::vector<SharedTexture> SharedTexture::LoadTextures(
+    const SharedBasicContext& context,
+    absl::Span<const SourcePath> source_paths,
+    absl::Span<const ImageUsage> usages,
+    const ImageSampler::Config& sampler_config) {
+  // Decode all images before waiting for any of them. Each image is decoded
+  // only once even if multiple textures share it.
+  absl::flat_hash_map<std::string, std::future<common::Image>> image_futures;
+  for (const auto& source_path : source_paths) {
+    const std::string& identifier = GetTextureIdentifier(source_path);
+    if (!image_futures.contains(identifier)) {
+      image_futures.insert({identifier, DecodeImage(source_path)});
+    }
   }
+
+  // Device resources are created on the calling thread.
+  absl::flat_hash_map<std::string, common::Image> images;
+  std::vector<SharedTexture> textures;
+  textures.reserve(source_paths.size());
+  for (const auto& source_path : source_paths) {
+    const std::string& identifier = GetTextureIdentifier(source_path);
+    auto iter = images.find(identifier);
+    if (iter == images.end()) {
+      iter = images.insert({identifier, image_futures[identifier].get()}).first;
+    }
+    textures.push_back(SharedTexture{GetTexture(
+        context, source_path, iter->second, usages, sampler_config)});
+  }
+  return textures;
+}
+
+SharedTexture::RefCountedTexture SharedTexture::GetTexture(
+    const SharedBasicContext& context,
+    const SourcePath& source_path,
+    absl::Span<const ImageUsage> usages,
+    const ImageSampler::Config& sampler_config) {
+  return GetTexture(context, source_path, DecodeImage(source_path).get(),
+                    usages, sampler_config);
 }
 
 SharedTexture::RefCountedTexture SharedTexture::GetTexture(
     const SharedBasicContext& context,
     const SourcePath& source_path,
+    const common::Image& image,
     absl::Span<const ImageUsage> usages,
     const ImageSampler::Config& sampler_config) {
   FATAL_IF_NULL(context);
   context->RegisterAutoReleasePool<SharedTexture::RefCountedTexture>("texture");
 
-  bool generate_mipmaps;
-  const std::string* identifier;
-  std::unique_ptr<common::Image> image;
-
-  if (const auto* single_tex_path = std::get_if<SingleTexPath>(&source_path);
-      single_tex_path != nullptr) {
-    generate_mipmaps = true;
-    identifier = single_tex_path;
-    image = std::make_unique<common::Image>(
-        common::Image::LoadSingleImageFromFile(*single_tex_path,
-                                               /*flip_y=*/false));
-  } else if (const auto* cubemap_path = std::get_if<CubemapPath>(&source_path);
-             cubemap_path != nullptr) {
-    generate_mipmaps = false;
-    identifier = &cubemap_path->directory;
-    image = std::make_unique<common::Image>(
-        common::Image::LoadCubemapFromFiles(
-            cubemap_path->directory, cubemap_path->files, /*flip_y=*/false));
-  } else {
-    FATAL("Unrecognized variant type");
-  }
-
+  // Mipmaps will be generated for single images, not for cubemaps.
+  const bool generate_mipmaps =
+      std::holds_alternative<SingleTexPath>(source_path);
   return RefCountedTexture::Get(
-      *identifier, context, generate_mipmaps, sampler_config,
-      CreateTextureBufferInfo(*context, *image, usages));
+      GetTextureIdentifier(source_path), context, generate_mipmaps,
+      sampler_config, CreateTextureBufferInfo(*context, image, usages));
 }
 
 OffscreenImage::OffscreenImage(SharedBasicContext context,
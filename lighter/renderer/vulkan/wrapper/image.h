@@ -31,25 +31,6 @@ namespace vulkan {
 
 using ir::ImageUsage;
 
-// This class creates a chunk of memory that is visible to both host and device,
-// used for transferring image data from the host to some memory that is only
-// visible to the device. When construction is done, the data is already sent
-// from the host to the underlying buffer object.
-class ImageStagingBuffer : public StagingBuffer {
- public:
-  // Inherits constructor.
-  using StagingBuffer::StagingBuffer;
-
-  // This class is neither copyable nor movable.
-  ImageStagingBuffer(const ImageStagingBuffer&) = delete;
-  ImageStagingBuffer& operator=(const ImageStagingBuffer&) = delete;
-
-  // Copies image data from this buffer to the targeted image, assuming the
-  // layout of 'target' is TRANSFER_DST_OPTIMAL.
-  void CopyToImage(const VkImage& target, const VkExtent3D& image_extent,
-                   uint32_t image_layer_count) const;
-};
-
 // This is the base class of buffers storing images. The user should use it
 // through derived classes. Since all buffers of this kind need VkImage,
 // which configures how do we use the device memory to store multidimensional
@@ -196,8 +177,9 @@ class SamplableImage {
   }
 };
 
-// This class copies a texture image on the host to device via a staging buffer,
-// and generates mipmaps if requested.
+// This class copies a texture image on the host to device via StagingUploader,
+// and generates mipmaps if requested. The transfer is submitted no later than
+// the next command that may use this image.
 // If the image is loaded from a file, the user should not directly instantiate
 // this class, but use SharedTexture which avoids loading the same file twice.
 class TextureImage : public Image, public SamplableImage {
@@ -300,6 +282,15 @@ class SharedTexture : public SamplableImage {
   SharedTexture(SharedTexture&&) noexcept = default;
   SharedTexture& operator=(SharedTexture&&) noexcept = default;
 
+  // Returns textures loaded from each of 'source_paths'. Images are decoded
+  // concurrently on worker threads, while device resources are created on the
+  // calling thread.
+  static std::vector<SharedTexture> LoadTextures(
+      const SharedBasicContext& context,
+      absl::Span<const SourcePath> source_paths,
+      absl::Span<const ImageUsage> usages,
+      const ImageSampler::Config& sampler_config);
+
   // Overrides.
   VkDescriptorImageInfo GetDescriptorInfo(VkImageLayout layout) const override {
     return texture_->GetDescriptorInfo(layout);
@@ -312,6 +303,9 @@ class SharedTexture : public SamplableImage {
   // Reference counted texture.
   using RefCountedTexture = common::RefCountedObject<TextureImage>;
 
+  explicit SharedTexture(RefCountedTexture&& texture)
+      : texture_{std::move(texture)} {}
+
   // Returns a reference to a reference counted texture image. If this image has
   // no other holder, it will be loaded from the file. Otherwise, this returns
   // a reference to an existing resource on the device.
@@ -321,6 +315,14 @@ class SharedTexture : public SamplableImage {
       absl::Span<const ImageUsage> usages,
       const ImageSampler::Config& sampler_config);
 
+  // Same as above, except that 'image' has been loaded from 'source_path'.
+  static RefCountedTexture GetTexture(
+      const SharedBasicContext& context,
+      const SourcePath& source_path,
+      const common::Image& image,
+      absl::Span<const ImageUsage> usages,
+      const ImageSampler::Config& sampler_config);
+
   // Reference counted texture image.
   RefCountedTexture texture_;
 };
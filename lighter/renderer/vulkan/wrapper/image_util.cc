@@ -8,6 +8,7 @@
 #include "lighter/renderer/vulkan/wrapper/image_util.h"
 
 #include "lighter/common/util.h"
+#include "lighter/renderer/ir/image_usage_util.h"
 #include "lighter/renderer/vulkan/wrapper/util.h"
 
 namespace lighter {
@@ -209,12 +210,56 @@ VkImageUsageFlags GetImageUsageFlags(absl::Span<const ImageUsage> usages) {
 
 bool NeedSynchronization(const ImageUsage& prev_usage,
                          const ImageUsage& curr_usage) {
-  // RAR.
-  if (curr_usage == prev_usage &&
-      curr_usage.access_type() == AccessType::kReadOnly) {
-    return false;
+  return ir::image::NeedSynchronization(prev_usage, curr_usage);
+}
+
+void AddMemoryBarrier(uint32_t recording_queue_family_index,
+                      uint32_t src_queue_family_index,
+                      uint32_t dst_queue_family_index, const VkImage& image,
+                      const ImageUsage& prev_usage,
+                      const ImageUsage& curr_usage, BarrierBatch* batch) {
+  VkAccessFlags src_access_flags = GetAccessFlags(prev_usage);
+  VkAccessFlags dst_access_flags = GetAccessFlags(curr_usage);
+  VkPipelineStageFlags src_stage_flags = GetPipelineStageFlags(prev_usage);
+  VkPipelineStageFlags dst_stage_flags = GetPipelineStageFlags(curr_usage);
+
+  // For queue family ownership transfers, the release half only needs to make
+  // previous writes available, and the acquire half only needs to make them
+  // visible. Stages of the other half may not be supported by this queue, and
+  // the semaphore that orders the two halves provides the dependency.
+  if (src_queue_family_index != dst_queue_family_index) {
+    if (recording_queue_family_index == src_queue_family_index) {
+      dst_access_flags = kNullAccessFlag;
+      dst_stage_flags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    } else {
+      ASSERT_TRUE(recording_queue_family_index == dst_queue_family_index,
+                  "Barrier must be recorded on the source or destination "
+                  "queue of ownership transfer");
+      src_access_flags = kNullAccessFlag;
+      src_stage_flags = dst_stage_flags;
+    }
   }
-  return true;
+
+  batch->image_barriers.push_back(VkImageMemoryBarrier{
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      /*pNext=*/nullptr,
+      src_access_flags,
+      dst_access_flags,
+      /*oldLayout=*/GetImageLayout(prev_usage),
+      /*newLayout=*/GetImageLayout(curr_usage),
+      src_queue_family_index,
+      dst_queue_family_index,
+      image,
+      VkImageSubresourceRange{
+          VK_IMAGE_ASPECT_COLOR_BIT,
+          /*baseMipLevel=*/0,
+          /*levelCount=*/1,
+          /*baseArrayLayer=*/0,
+          /*layerCount=*/1,
+      },
+  });
+  batch->src_stage_flags |= src_stage_flags;
+  batch->dst_stage_flags |= dst_stage_flags;
 }
 
 } /* namespace image */
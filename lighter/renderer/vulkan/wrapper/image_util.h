@@ -8,7 +8,10 @@
 #ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_IMAGE_UTIL_H
 #define LIGHTER_RENDERER_VULKAN_WRAPPER_IMAGE_UTIL_H
 
+#include <vector>
+
 #include "lighter/renderer/ir/image_usage.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/vulkan/vulkan.h"
 
@@ -43,6 +46,26 @@ VkImageUsageFlags GetImageUsageFlags(absl::Span<const ImageUsage> usages);
 bool NeedSynchronization(const ImageUsage& prev_usage,
                          const ImageUsage& curr_usage);
 
+// Image memory barriers to record with one pipeline barrier command. Stage
+// masks are unions of stage masks of all barriers.
+struct BarrierBatch {
+  std::vector<VkImageMemoryBarrier> image_barriers;
+  VkPipelineStageFlags src_stage_flags = nullflag;
+  VkPipelineStageFlags dst_stage_flags = nullflag;
+};
+
+// Adds a memory barrier to 'batch' for transitioning the layout of 'image'
+// from 'prev_usage' to 'curr_usage', recorded on the queue with
+// 'recording_queue_family_index'. If 'src_queue_family_index' and
+// 'dst_queue_family_index' are different, this is the release half (if
+// recorded on the source queue) or the acquire half (if recorded on the
+// destination queue) of a queue family ownership transfer.
+void AddMemoryBarrier(uint32_t recording_queue_family_index,
+                      uint32_t src_queue_family_index,
+                      uint32_t dst_queue_family_index, const VkImage& image,
+                      const ImageUsage& prev_usage,
+                      const ImageUsage& curr_usage, BarrierBatch* batch);
+
 } /* namespace image */
 } /* namespace vulkan */
 } /* namespace renderer */
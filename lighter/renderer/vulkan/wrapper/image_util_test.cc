@@ -7,7 +7,12 @@
 
 #include "lighter/renderer/vulkan/wrapper/image_util.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "lighter/renderer/ir/image_usage_util.h"
 #include "third_party/vulkan/vulkan.h"
 
 // Tests are written according to:
@@ -43,6 +48,110 @@ TEST(ImageUsageTest, SampleInFragmentShader) {
   EXPECT_EQ(GetImageLayout(usage), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
+// Returns the barrier batch that performs 'transitions' on one queue.
+BarrierBatch CreateBatch(
+    const std::vector<ir::image::UsageTransition>& transitions) {
+  constexpr uint32_t kQueueFamilyIndex = 0;
+  BarrierBatch batch;
+  for (const auto& transition : transitions) {
+    AddMemoryBarrier(kQueueFamilyIndex, kQueueFamilyIndex, kQueueFamilyIndex,
+                     /*image=*/VK_NULL_HANDLE, transition.prev_usage,
+                     transition.curr_usage, &batch);
+  }
+  return batch;
+}
+
+TEST(BarrierBatchTest, MergeStageMasks) {
+  const ImageUsage compute_read =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kReadOnly);
+  const ImageUsage compute_write =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+  const ImageUsage sampled = ImageUsage::GetSampledInFragmentShaderUsage();
+
+  ir::image::ImageUsageHistoryMap history_map;
+  history_map.insert({"input", std::move(ir::ImageUsageHistory{sampled}
+                                             .AddUsage(0, 1, compute_read))});
+  history_map.insert({"output", std::move(ir::ImageUsageHistory{}
+                                              .AddUsage(0, compute_write)
+                                              .AddUsage(1, compute_read)
+                                              .SetFinalUsage(sampled))});
+  const auto barriers = ir::image::GetSubpassBarriers(
+      history_map, /*num_subpasses=*/2, /*transfers_ownership=*/false);
+  ASSERT_EQ(barriers.size(), 3);
+
+  // Both images are transitioned before subpass 0.
+  const BarrierBatch first_batch = CreateBatch(barriers[0]);
+  ASSERT_EQ(first_batch.image_barriers.size(), 2);
+  EXPECT_EQ(first_batch.src_stage_flags,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT |
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  EXPECT_EQ(first_batch.dst_stage_flags, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  // "input".
+  EXPECT_EQ(first_batch.image_barriers[0].srcAccessMask,
+            VK_ACCESS_SHADER_READ_BIT);
+  EXPECT_EQ(first_batch.image_barriers[0].dstAccessMask,
+            VK_ACCESS_SHADER_READ_BIT);
+  // "output".
+  EXPECT_EQ(first_batch.image_barriers[1].srcAccessMask, kNullAccessFlag);
+  EXPECT_EQ(first_batch.image_barriers[1].dstAccessMask,
+            VK_ACCESS_SHADER_WRITE_BIT);
+
+  // Read-after-read of "input" is skipped before subpass 1.
+  const BarrierBatch second_batch = CreateBatch(barriers[1]);
+  ASSERT_EQ(second_batch.image_barriers.size(), 1);
+  EXPECT_EQ(second_batch.src_stage_flags,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  EXPECT_EQ(second_batch.dst_stage_flags,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  EXPECT_EQ(second_batch.image_barriers[0].srcAccessMask,
+            VK_ACCESS_SHADER_WRITE_BIT);
+  EXPECT_EQ(second_batch.image_barriers[0].dstAccessMask,
+            VK_ACCESS_SHADER_READ_BIT);
+
+  // Only "output" has the final usage.
+  const BarrierBatch final_batch = CreateBatch(barriers[2]);
+  ASSERT_EQ(final_batch.image_barriers.size(), 1);
+  EXPECT_EQ(final_batch.src_stage_flags, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  EXPECT_EQ(final_batch.dst_stage_flags,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  EXPECT_EQ(final_batch.image_barriers[0].newLayout,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+TEST(BarrierBatchTest, TransferOwnership) {
+  constexpr uint32_t kOwnerQueueFamilyIndex = 0;
+  constexpr uint32_t kComputeQueueFamilyIndex = 1;
+  const ImageUsage compute_write =
+      ImageUsage::GetLinearAccessInComputeShaderUsage(AccessType::kWriteOnly);
+  const ImageUsage sampled = ImageUsage::GetSampledInFragmentShaderUsage();
+
+  // The release half only makes writes available.
+  BarrierBatch release_batch;
+  AddMemoryBarrier(kComputeQueueFamilyIndex, kComputeQueueFamilyIndex,
+                   kOwnerQueueFamilyIndex, /*image=*/VK_NULL_HANDLE,
+                   compute_write, sampled, &release_batch);
+  EXPECT_EQ(release_batch.src_stage_flags,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  EXPECT_EQ(release_batch.dst_stage_flags,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+  EXPECT_EQ(release_batch.image_barriers[0].srcAccessMask,
+            VK_ACCESS_SHADER_WRITE_BIT);
+  EXPECT_EQ(release_batch.image_barriers[0].dstAccessMask, kNullAccessFlag);
+
+  // The acquire half only makes them visible.
+  BarrierBatch acquire_batch;
+  AddMemoryBarrier(kOwnerQueueFamilyIndex, kComputeQueueFamilyIndex,
+                   kOwnerQueueFamilyIndex, /*image=*/VK_NULL_HANDLE,
+                   compute_write, sampled, &acquire_batch);
+  EXPECT_EQ(acquire_batch.src_stage_flags,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  EXPECT_EQ(acquire_batch.dst_stage_flags,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  EXPECT_EQ(acquire_batch.image_barriers[0].srcAccessMask, kNullAccessFlag);
+  EXPECT_EQ(acquire_batch.image_barriers[0].dstAccessMask,
+            VK_ACCESS_SHADER_READ_BIT);
+}
+
 } /* namespace */
 } /* namespace image */
 } /* namespace vulkan */
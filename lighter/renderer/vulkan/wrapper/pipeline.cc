@@ -68,45 +68,27 @@ VkPipelineVertexInputStateCreateInfo CreateVertexInputInfo(
   };
 }
 
-// Contains a loaded shader 'module' that will be used at 'stage'.
-struct ShaderStage {
-  VkShaderStageFlagBits stage;
-  ShaderModule::RefCountedShaderModule module;
-};
-
-// Loads shaders in 'shader_file_path_map'.
-std::vector<ShaderStage> CreateShaderStages(
-    const SharedBasicContext& context,
-    const absl::flat_hash_map<VkShaderStageFlagBits, std::string>&
-        shader_file_path_map) {
-  std::vector<ShaderStage> shader_stages;
-  shader_stages.reserve(shader_file_path_map.size());
-  for (const auto& pair : shader_file_path_map) {
-    const auto& file_path = pair.second;
-    shader_stages.push_back(ShaderStage{
-        /*stage=*/pair.first,
-        ShaderModule::RefCountedShaderModule::Get(
-            /*identifier=*/file_path, context, file_path),
-    });
-  }
-  return shader_stages;
-}
-
-// Extracts shader stage infos, assuming the entry point of each shader is a
-// main() function. The user is responsible for keeping the existence of
-// 'shader_stages' until the returned value is no longer used.
+// Extracts shader stage infos of shaders in 'shader_file_path_map', whose
+// modules are looked up in 'shader_modules'. We assume the entry point of each
+// shader is a main() function. The user is responsible for keeping the
+// existence of shader modules until the returned value is no longer used.
 std::vector<VkPipelineShaderStageCreateInfo> CreateShaderStageInfos(
-    const std::vector<ShaderStage>& shader_stages) {
+    const absl::flat_hash_map<VkShaderStageFlagBits, std::string>&
+        shader_file_path_map,
+    const PipelineBuilder::ShaderModuleMap& shader_modules) {
   static constexpr char kShaderEntryPoint[] = "main";
   std::vector<VkPipelineShaderStageCreateInfo> shader_stage_infos;
-  shader_stage_infos.reserve(shader_stages.size());
-  for (const auto& stage : shader_stages) {
+  shader_stage_infos.reserve(shader_file_path_map.size());
+  for (const auto& [stage, file_path] : shader_file_path_map) {
+    const auto iter = shader_modules.find(file_path);
+    ASSERT_TRUE(iter != shader_modules.end(),
+                absl::StrFormat("Shader '%s' is not loaded", file_path));
     shader_stage_infos.push_back(VkPipelineShaderStageCreateInfo{
         VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
         /*pNext=*/nullptr,
         /*flags=*/nullflag,
-        stage.stage,
-        **stage.module,
+        stage,
+        **iter->second,
         /*pName=*/kShaderEntryPoint,
         // May use 'pSpecializationInfo' to specify shader constants.
         /*pSpecializationInfo=*/nullptr,
@@ -122,7 +104,7 @@ ShaderModule::ShaderModule(SharedBasicContext context,
     : context_{std::move(FATAL_IF_NULL(context))} {
   context_->RegisterAutoReleasePool<RefCountedShaderModule>("shader");
 
-  const common::Data file_data = common::file::LoadDataFromFile(file_path);
+  const common::MappedData file_data{file_path};
   const VkShaderModuleCreateInfo module_info{
       VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
       /*pNext=*/nullptr,
@@ -135,20 +117,18 @@ ShaderModule::ShaderModule(SharedBasicContext context,
                  "Failed to create shader module");
 }
 
-PipelineBuilder::PipelineBuilder(SharedBasicContext context,
-                                 std::optional<int> max_cache_size)
-    : context_{std::move(FATAL_IF_NULL(context))} {
-  const VkPipelineCacheCreateInfo cache_info{
-      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
-      /*pNext=*/nullptr,
-      /*flags=*/nullflag,
-      /*initialDataSize=*/static_cast<size_t>(max_cache_size.value_or(0)),
-      /*pInitialData=*/nullptr,
-  };
-  ASSERT_SUCCESS(
-      vkCreatePipelineCache(*context_->device(), &cache_info,
-                            *context_->allocator(), &pipeline_cache_),
-      "Failed to create pipeline cache");
+std::unique_ptr<Pipeline> PipelineBuilder::Build() const {
+  // Shader modules can be destroyed to save the host memory after the pipeline
+  // is created.
+  std::vector<ShaderModule::RefCountedShaderModule> ref_counted_modules;
+  ShaderModuleMap shader_modules;
+  for (const auto& file_path : GetShaderFilePaths()) {
+    auto module = ShaderModule::RefCountedShaderModule::Get(
+        /*identifier=*/file_path, context_, file_path);
+    shader_modules.insert({file_path, &*module});
+    ref_counted_modules.push_back(std::move(module));
+  }
+  return BuildWithShaderModules(shader_modules);
 }
 
 void PipelineBuilder::SetLayout(
@@ -184,9 +164,8 @@ void PipelineBuilder::SetLayout(
   });
 }
 
-GraphicsPipelineBuilder::GraphicsPipelineBuilder(
-    SharedBasicContext context, std::optional<int> max_cache_size)
-    : PipelineBuilder{std::move(FATAL_IF_NULL(context)), max_cache_size} {
+GraphicsPipelineBuilder::GraphicsPipelineBuilder(SharedBasicContext context)
+    : PipelineBuilder{std::move(FATAL_IF_NULL(context))} {
   input_assembly_info_ = {
       VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
       /*pNext=*/nullptr,
@@ -349,7 +328,17 @@ GraphicsPipelineBuilder& GraphicsPipelineBuilder::SetShader(
   return *this;
 }
 
-std::unique_ptr<Pipeline> GraphicsPipelineBuilder::Build() const {
+std::vector<std::string> GraphicsPipelineBuilder::GetShaderFilePaths() const {
+  std::vector<std::string> file_paths;
+  file_paths.reserve(shader_file_path_map_.size());
+  for (const auto& [stage, file_path] : shader_file_path_map_) {
+    file_paths.push_back(file_path);
+  }
+  return file_paths;
+}
+
+std::unique_ptr<Pipeline> GraphicsPipelineBuilder::BuildWithShaderModules(
+    const ShaderModuleMap& shader_modules) const {
   ASSERT_TRUE(has_pipeline_layout_info(), "Pipeline layout is not set");
   ASSERT_HAS_VALUE(viewport_info_, "Viewport is not set");
   ASSERT_HAS_VALUE(render_pass_info_, "Render pass is not set");
@@ -361,11 +350,8 @@ std::unique_ptr<Pipeline> GraphicsPipelineBuilder::Build() const {
   const auto color_blend_info = CreateColorBlendInfo(color_blend_states_);
   const auto vertex_input_info = CreateVertexInputInfo(binding_descriptions_,
                                                        attribute_descriptions_);
-  // Shader modules can be destroyed to save the host memory after the pipeline
-  // is created.
-  const auto shader_stages =
-      CreateShaderStages(context(), shader_file_path_map_);
-  const auto shader_stage_infos = CreateShaderStageInfos(shader_stages);
+  const auto shader_stage_infos =
+      CreateShaderStageInfos(shader_file_path_map_, shader_modules);
 
   VkPipelineLayout pipeline_layout;
   ASSERT_SUCCESS(
@@ -400,7 +386,8 @@ std::unique_ptr<Pipeline> GraphicsPipelineBuilder::Build() const {
   VkPipeline pipeline;
   ASSERT_SUCCESS(
       vkCreateGraphicsPipelines(
-          *context()->device(), /*pipelineCache=*/VK_NULL_HANDLE,
+          *context()->device(),
+          context()->pipeline_cache().GetCacheForCurrentThread(),
           /*createInfoCount=*/1, &pipeline_info, *context()->allocator(),
           &pipeline),
       "Failed to create graphics pipeline");
@@ -429,16 +416,20 @@ ComputePipelineBuilder& ComputePipelineBuilder::SetShader(
   return *this;
 }
 
-std::unique_ptr<Pipeline> ComputePipelineBuilder::Build() const {
+std::vector<std::string> ComputePipelineBuilder::GetShaderFilePaths() const {
+  ASSERT_HAS_VALUE(shader_file_path_, "Shader is not set");
+  return {shader_file_path_.value()};
+}
+
+std::unique_ptr<Pipeline> ComputePipelineBuilder::BuildWithShaderModules(
+    const ShaderModuleMap& shader_modules) const {
   ASSERT_TRUE(has_pipeline_layout_info(), "Pipeline layout is not set");
   ASSERT_HAS_VALUE(shader_file_path_, "Shader is not set");
 
-  // Shader modules can be destroyed to save the host memory after the pipeline
-  // is created.
-  const auto shader_stages = CreateShaderStages(
-      context(), /*shader_file_path_map=*/{
-          {VK_SHADER_STAGE_COMPUTE_BIT, shader_file_path_.value()}});
-  const auto shader_stage_infos = CreateShaderStageInfos(shader_stages);
+  const auto shader_stage_infos = CreateShaderStageInfos(
+      /*shader_file_path_map=*/{
+          {VK_SHADER_STAGE_COMPUTE_BIT, shader_file_path_.value()}},
+      shader_modules);
   ASSERT_TRUE(shader_stage_infos.size() == 1, "Only expect one shader stage");
 
   VkPipelineLayout pipeline_layout;
@@ -462,7 +453,8 @@ std::unique_ptr<Pipeline> ComputePipelineBuilder::Build() const {
   VkPipeline pipeline;
   ASSERT_SUCCESS(
       vkCreateComputePipelines(
-          *context()->device(), /*pipelineCache=*/VK_NULL_HANDLE,
+          *context()->device(),
+          context()->pipeline_cache().GetCacheForCurrentThread(),
           /*createInfoCount=*/1, &pipeline_info, *context()->allocator(),
           &pipeline),
       "Failed to create compute pipeline");
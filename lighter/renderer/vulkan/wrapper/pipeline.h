@@ -70,17 +70,29 @@ class PipelineBuilder {
   PipelineBuilder(const PipelineBuilder&) = delete;
   PipelineBuilder& operator=(const PipelineBuilder&) = delete;
 
-  virtual ~PipelineBuilder() {
-    vkDestroyPipelineCache(*context_->device(), pipeline_cache_,
-                           *context_->allocator());
-  }
+  virtual ~PipelineBuilder() = default;
+
+  // Maps shader file paths to loaded shader modules.
+  using ShaderModuleMap =
+      absl::flat_hash_map<std::string, const ShaderModule*>;
 
   // Builds a pipeline. This can be called multiple times.
-  virtual std::unique_ptr<Pipeline> Build() const = 0;
+  std::unique_ptr<Pipeline> Build() const;
+
+  // Returns file paths of all shaders used in this pipeline.
+  virtual std::vector<std::string> GetShaderFilePaths() const = 0;
+
+  // Builds a pipeline with 'shader_modules', which must contain all shaders
+  // returned by GetShaderFilePaths(). Unlike Build(), this does not touch the
+  // pool of reference counted shader modules, hence it can be called on
+  // multiple threads simultaneously, as long as internal states are not
+  // modified meanwhile.
+  virtual std::unique_ptr<Pipeline> BuildWithShaderModules(
+      const ShaderModuleMap& shader_modules) const = 0;
 
  protected:
-  PipelineBuilder(SharedBasicContext context,
-                  std::optional<int> max_cache_size);
+  explicit PipelineBuilder(SharedBasicContext context)
+      : context_{std::move(FATAL_IF_NULL(context))} {}
 
   // Sets the name for the pipeline.
   void SetName(std::string&& name) { name_ = std::move(name); }
@@ -103,9 +115,6 @@ class PipelineBuilder {
   // Pointer to context.
   const SharedBasicContext context_;
 
-  // Opaque pipeline cache object.
-  VkPipelineCache pipeline_cache_;
-
   // Name of the pipeline (used for debugging).
   std::string name_;
 
@@ -130,9 +139,7 @@ class GraphicsPipelineBuilder : public PipelineBuilder {
 
   // Internal states will be filled with default settings, unless they are of
   // std::optional or std::vector types.
-  explicit GraphicsPipelineBuilder(
-      SharedBasicContext context,
-      std::optional<int> max_cache_size = std::nullopt);
+  explicit GraphicsPipelineBuilder(SharedBasicContext context);
 
   // This class is neither copyable nor movable.
   GraphicsPipelineBuilder(const GraphicsPipelineBuilder&) = delete;
@@ -197,7 +204,9 @@ class GraphicsPipelineBuilder : public PipelineBuilder {
                                      std::string&& file_path);
 
   // Overrides.
-  std::unique_ptr<Pipeline> Build() const override;
+  std::vector<std::string> GetShaderFilePaths() const override;
+  std::unique_ptr<Pipeline> BuildWithShaderModules(
+      const ShaderModuleMap& shader_modules) const override;
 
  private:
   // Refers to a subpass within a render pass.
@@ -246,10 +255,8 @@ class GraphicsPipelineBuilder : public PipelineBuilder {
 // can be changed by the user. See class comments of ShaderModule.
 class ComputePipelineBuilder : public PipelineBuilder {
  public:
-  explicit ComputePipelineBuilder(
-      SharedBasicContext context,
-      std::optional<int> max_cache_size = std::nullopt)
-      : PipelineBuilder{std::move(FATAL_IF_NULL(context)), max_cache_size} {}
+  explicit ComputePipelineBuilder(SharedBasicContext context)
+      : PipelineBuilder{std::move(FATAL_IF_NULL(context))} {}
 
   // This class is neither copyable nor movable.
   ComputePipelineBuilder(const ComputePipelineBuilder&) = delete;
@@ -270,7 +277,9 @@ class ComputePipelineBuilder : public PipelineBuilder {
   ComputePipelineBuilder& SetShader(std::string&& file_path);
 
   // Overrides.
-  std::unique_ptr<Pipeline> Build() const override;
+  std::vector<std::string> GetShaderFilePaths() const override;
+  std::unique_ptr<Pipeline> BuildWithShaderModules(
+      const ShaderModuleMap& shader_modules) const override;
 
  private:
   // Path to shader file.
@@ -306,8 +315,8 @@ class Pipeline {
   VkPipelineBindPoint binding_point() const { return binding_point_; }
 
  private:
-  friend std::unique_ptr<Pipeline> GraphicsPipelineBuilder::Build() const;
-  friend std::unique_ptr<Pipeline> ComputePipelineBuilder::Build() const;
+  friend class GraphicsPipelineBuilder;
+  friend class ComputePipelineBuilder;
 
   Pipeline(SharedBasicContext context,
            std::string name,
@@ -0,0 +1,68 @@
+//
+//  pipeline_build_jobs.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/pipeline_build_jobs.h"
+
+#include <utility>
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+PipelineBuildJobs::PipelineBuildJobs(SharedBasicContext context,
+                                     common::ThreadPool* thread_pool)
+    : context_{std::move(FATAL_IF_NULL(context))},
+      thread_pool_{thread_pool != nullptr ? *thread_pool
+                                          : common::GetSharedThreadPool()} {
+  // Shader modules register the auto release pool when constructed. Do it here
+  // so that worker threads never race for the first registration.
+  context_->RegisterAutoReleasePool<ShaderModule::RefCountedShaderModule>(
+      "shader");
+}
+
+PipelineHandle PipelineBuildJobs::Add(
+    std::shared_ptr<const PipelineBuilder> builder) {
+  FATAL_IF_NULL(builder);
+  std::vector<std::pair<std::string, std::shared_ptr<ShaderEntry>>> shaders;
+  for (auto& file_path : builder->GetShaderFilePaths()) {
+    auto& entry = shaders_[file_path];
+    if (entry == nullptr) {
+      entry = std::make_shared<ShaderEntry>();
+    }
+    shaders.push_back({std::move(file_path), entry});
+  }
+
+  // If another job is loading the same shader, std::call_once() blocks until
+  // it is done. That job is already running, hence this never deadlocks.
+  auto future = thread_pool_.Submit(
+      [context = context_, builder = std::move(builder),
+       shaders = std::move(shaders)]() -> std::shared_ptr<const Pipeline> {
+        PipelineBuilder::ShaderModuleMap shader_modules;
+        for (const auto& shader : shaders) {
+          const std::string& file_path = shader.first;
+          ShaderEntry& entry = *shader.second;
+          std::call_once(entry.once_flag, [&context, &file_path, &entry]() {
+            entry.module = std::make_unique<ShaderModule>(context, file_path);
+          });
+          shader_modules.insert({file_path, entry.module.get()});
+        }
+        return builder->BuildWithShaderModules(shader_modules);
+      });
+  futures_.push_back(future.share());
+  return PipelineHandle{futures_.back()};
+}
+
+void PipelineBuildJobs::Wait() {
+  for (const auto& future : futures_) {
+    future.wait();
+  }
+  context_->pipeline_cache().MergeThreadCaches();
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
@@ -0,0 +1,123 @@
+//
+//  pipeline_build_jobs.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_BUILD_JOBS_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_BUILD_JOBS_H
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lighter/common/thread_pool.h"
+#include "lighter/common/util.h"
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/pipeline.h"
+#include "third_party/absl/container/flat_hash_map.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Refers to a pipeline that may still be being built. Accessing the pipeline
+// blocks until it is built, and rethrows the exception if the build failed.
+// After that, accessing it no longer blocks. This class is copyable, and all
+// copies refer to the same pipeline.
+class PipelineHandle {
+ public:
+  PipelineHandle() = default;
+
+  explicit PipelineHandle(
+      std::shared_future<std::shared_ptr<const Pipeline>> future)
+      : future_{std::move(future)} {}
+
+  // Returns whether this handle refers to a pipeline.
+  bool is_valid() const { return future_.valid(); }
+
+  // Returns whether the pipeline has been built (or failed to build). This
+  // never blocks.
+  bool is_ready() const {
+    return future_.wait_for(std::chrono::seconds{0}) ==
+           std::future_status::ready;
+  }
+
+  // Overloads.
+  const Pipeline& operator*() const { return *GetPipeline(); }
+  const Pipeline* operator->() const { return GetPipeline(); }
+
+ private:
+  // Returns the pipeline. This blocks if it has not been built yet.
+  const Pipeline* GetPipeline() const {
+    ASSERT_TRUE(future_.valid(), "Pipeline handle is empty");
+    return future_.get().get();
+  }
+
+  // Resolves to the built pipeline.
+  std::shared_future<std::shared_ptr<const Pipeline>> future_;
+};
+
+// This class builds pipelines on worker threads. Each shader is loaded at most
+// once by all jobs added to the same instance, and shaders are loaded
+// concurrently as part of the jobs that first need them. Since each worker
+// thread uses its own pipeline cache (see PipelineCache), pipeline creation is
+// not serialized by the driver.
+// Jobs own builders and shader modules, hence handles stay valid after this
+// object is destructed, and the destructor does not block. However, states of
+// builders must not be modified until the handle is ready, and objects that
+// builders refer to, such as descriptor set layouts and render passes, must
+// outlive the jobs.
+// This class is not thread-safe. It is meant to be used on the thread that
+// constructs the context, which can then do other work, such as uploading
+// textures, while pipelines are being built.
+class PipelineBuildJobs {
+ public:
+  // If 'thread_pool' is nullptr, common::GetSharedThreadPool() will be used.
+  // Otherwise, it must outlive all jobs.
+  explicit PipelineBuildJobs(SharedBasicContext context,
+                             common::ThreadPool* thread_pool = nullptr);
+
+  // This class is neither copyable nor movable.
+  PipelineBuildJobs(const PipelineBuildJobs&) = delete;
+  PipelineBuildJobs& operator=(const PipelineBuildJobs&) = delete;
+
+  // Schedules building a pipeline with 'builder', and returns a handle to it.
+  PipelineHandle Add(std::shared_ptr<const PipelineBuilder> builder);
+
+  // Blocks until all jobs added so far finish, and merges per-thread pipeline
+  // caches into the main cache, so that rebuilding these pipelines on the
+  // calling thread later, e.g. on swapchain recreation, hits the cache.
+  // Exceptions thrown by jobs are not rethrown here, but when accessing the
+  // pipelines through handles.
+  void Wait();
+
+ private:
+  // Loads the shader module at most once.
+  struct ShaderEntry {
+    std::once_flag once_flag;
+    std::unique_ptr<ShaderModule> module;
+  };
+
+  // Pointer to context.
+  const SharedBasicContext context_;
+
+  // Thread pool that runs jobs.
+  common::ThreadPool& thread_pool_;
+
+  // Maps shader file paths to shaders used by jobs.
+  absl::flat_hash_map<std::string, std::shared_ptr<ShaderEntry>> shaders_;
+
+  // Results of all jobs.
+  std::vector<std::shared_future<std::shared_ptr<const Pipeline>>> futures_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_BUILD_JOBS_H */
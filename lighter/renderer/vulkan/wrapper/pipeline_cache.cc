@@ -0,0 +1,212 @@
+//
+//  pipeline_cache.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/pipeline_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "lighter/common/file.h"
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/strings/str_format.h"
+
+ABSL_FLAG(bool, use_pipeline_cache, true,
+          "Share a pipeline cache across pipelines, and persist it on disk");
+ABSL_FLAG(std::string, pipeline_cache_dir, "",
+          "Directory to store pipeline cache files. If empty, a directory in "
+          "the system temporary directory will be used");
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+namespace stdfs = std::filesystem;
+
+// Size of the header of VK_PIPELINE_CACHE_HEADER_VERSION_ONE, which consists of
+// the header size, header version, vendor ID, device ID and cache UUID.
+constexpr size_t kHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+// Returns the 32-bit value stored at 'bytes'. The pipeline cache header is
+// always written with the least significant byte first.
+uint32_t ReadUint32(const char* bytes) {
+  uint32_t value = 0;
+  for (int i = sizeof(value) - 1; i >= 0; --i) {
+    value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+  }
+  return value;
+}
+
+// Returns the path to the cache file for 'properties'. Different devices use
+// different files, so that they don't overwrite each other.
+std::string GetCachePath(const VkPhysicalDeviceProperties& properties) {
+  stdfs::path directory{absl::GetFlag(FLAGS_pipeline_cache_dir)};
+  if (directory.empty()) {
+    directory = stdfs::temp_directory_path() / "lighter_pipeline_cache";
+  }
+  return (directory / absl::StrFormat("%04x_%04x.bin", properties.vendorID,
+                                      properties.deviceID)).string();
+}
+
+// Returns whether 'data' is produced by the driver and device described by
+// 'properties'. Otherwise, the driver may reject or even misuse it.
+bool IsCompatible(const std::string& data,
+                  const VkPhysicalDeviceProperties& properties) {
+  if (data.size() < kHeaderSize) {
+    return false;
+  }
+  const char* header = data.data();
+  const uint32_t header_size = ReadUint32(header);
+  const uint32_t header_version = ReadUint32(header + 4);
+  const uint32_t vendor_id = ReadUint32(header + 8);
+  const uint32_t device_id = ReadUint32(header + 12);
+  return header_size >= kHeaderSize && header_size <= data.size() &&
+         header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         vendor_id == properties.vendorID &&
+         device_id == properties.deviceID &&
+         std::memcmp(header + 16, properties.pipelineCacheUUID,
+                     VK_UUID_SIZE) == 0;
+}
+
+// Returns the content of the cache file at 'path' if it is compatible with
+// 'properties'. Otherwise, returns an empty string.
+std::string LoadCacheFile(const std::string& path,
+                          const VkPhysicalDeviceProperties& properties) {
+  std::ifstream file{path, std::ios::in | std::ios::binary};
+  if (!file) {
+    return {};
+  }
+  std::string data{std::istreambuf_iterator<char>{file},
+                   std::istreambuf_iterator<char>{}};
+  if (!IsCompatible(data, properties)) {
+    LOG_INFO << absl::StreamFormat(
+        "Discarding incompatible pipeline cache file '%s'", path);
+    return {};
+  }
+  return data;
+}
+
+// Writes 'data' to the cache file at 'path'.
+void WriteCacheFile(const std::string& path, const std::string& data) {
+  if (!common::file::WriteFileAtomically(path, data)) {
+    LOG_ERROR << absl::StreamFormat(
+        "Failed to write pipeline cache file '%s'", path);
+  }
+}
+
+} /* namespace */
+
+PipelineCache::PipelineCache(const BasicContext* context)
+    : context_{FATAL_IF_NULL(context)},
+      main_thread_id_{std::this_thread::get_id()} {
+  if (!absl::GetFlag(FLAGS_use_pipeline_cache)) {
+    return;
+  }
+  const auto& properties = context_->physical_device_properties();
+  file_path_ = GetCachePath(properties);
+  main_cache_ = CreateCache(LoadCacheFile(file_path_.value(), properties));
+}
+
+PipelineCache::~PipelineCache() {
+  if (main_cache_ == VK_NULL_HANDLE) {
+    return;
+  }
+  Save();
+  const VkDevice& device = *context_->device();
+  for (const auto& [thread_id, cache] : thread_caches_) {
+    vkDestroyPipelineCache(device, cache, *context_->allocator());
+  }
+  vkDestroyPipelineCache(device, main_cache_, *context_->allocator());
+}
+
+const VkPipelineCache& PipelineCache::GetCacheForCurrentThread() {
+  const auto thread_id = std::this_thread::get_id();
+  if (main_cache_ == VK_NULL_HANDLE || thread_id == main_thread_id_) {
+    return main_cache_;
+  }
+
+  const std::lock_guard<std::mutex> lock{mutex_};
+  auto iter = thread_caches_.find(thread_id);
+  if (iter == thread_caches_.end()) {
+    iter = thread_caches_.insert(
+        {thread_id, CreateCache(GetCacheData(main_cache_))}).first;
+  }
+  return iter->second;
+}
+
+void PipelineCache::MergeThreadCaches() {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  if (main_cache_ == VK_NULL_HANDLE || thread_caches_.empty()) {
+    return;
+  }
+
+  std::vector<VkPipelineCache> src_caches;
+  src_caches.reserve(thread_caches_.size());
+  for (const auto& [thread_id, cache] : thread_caches_) {
+    src_caches.push_back(cache);
+  }
+  if (vkMergePipelineCaches(*context_->device(), main_cache_,
+                            CONTAINER_SIZE(src_caches),
+                            src_caches.data()) != VK_SUCCESS) {
+    LOG_ERROR << "Failed to merge pipeline caches";
+  }
+}
+
+void PipelineCache::Save() {
+  if (main_cache_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  MergeThreadCaches();
+  const std::string data = GetCacheData(main_cache_);
+  if (!data.empty()) {
+    WriteCacheFile(file_path_.value(), data);
+  }
+}
+
+std::string PipelineCache::GetCacheData(const VkPipelineCache& cache) const {
+  const VkDevice& device = *context_->device();
+  size_t data_size = 0;
+  if (vkGetPipelineCacheData(device, cache, &data_size, /*pData=*/nullptr)
+          != VK_SUCCESS) {
+    LOG_ERROR << "Failed to query pipeline cache size";
+    return {};
+  }
+  std::string data(data_size, '\0');
+  if (vkGetPipelineCacheData(device, cache, &data_size, data.data())
+          != VK_SUCCESS) {
+    LOG_ERROR << "Failed to get pipeline cache data";
+    return {};
+  }
+  data.resize(data_size);
+  return data;
+}
+
+VkPipelineCache PipelineCache::CreateCache(
+    const std::string& initial_data) const {
+  const VkPipelineCacheCreateInfo cache_info{
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+      initial_data.size(),
+      initial_data.empty() ? nullptr : initial_data.data(),
+  };
+  VkPipelineCache cache;
+  ASSERT_SUCCESS(vkCreatePipelineCache(*context_->device(), &cache_info,
+                                       *context_->allocator(), &cache),
+                 "Failed to create pipeline cache");
+  return cache;
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
@@ -0,0 +1,90 @@
+//
+//  pipeline_cache.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_CACHE_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_CACHE_H
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Forward declarations.
+class BasicContext;
+
+// This class holds the device-wide VkPipelineCache shared by all pipeline
+// builders, so that pipelines are not compiled from scratch whenever they are
+// rebuilt, for example on swapchain recreation. The cache is loaded from disk
+// when constructed, and written back when destructed. Cache data produced by
+// another driver or device is discarded.
+// The thread that constructs this class uses the main cache. Each other thread
+// gets its own cache, which is initialized with the data of the main cache and
+// merged back into it before saving, so that threads don't contend for it.
+// If the cache is disabled via flags, VK_NULL_HANDLE will be used instead.
+class PipelineCache {
+ public:
+  explicit PipelineCache(const BasicContext* context);
+
+  // This class is neither copyable nor movable.
+  PipelineCache(const PipelineCache&) = delete;
+  PipelineCache& operator=(const PipelineCache&) = delete;
+
+  // Saves the cache and destroys all VkPipelineCache objects.
+  ~PipelineCache();
+
+  // Returns the cache to use when creating pipelines on the calling thread.
+  // This is thread-safe.
+  const VkPipelineCache& GetCacheForCurrentThread();
+
+  // Merges caches of other threads into the main cache, so that pipelines
+  // created on those threads can be reused by any thread. The main cache must
+  // not be used simultaneously by other threads.
+  void MergeThreadCaches();
+
+  // Merges caches of other threads and writes the main cache to disk. The write
+  // is atomic, hence other processes never see a partially written file. The
+  // main cache must not be used simultaneously by other threads.
+  void Save();
+
+ private:
+  // Returns the data of 'cache'.
+  std::string GetCacheData(const VkPipelineCache& cache) const;
+
+  // Returns a new VkPipelineCache initialized with 'initial_data'.
+  VkPipelineCache CreateCache(const std::string& initial_data) const;
+
+  // Pointer to context.
+  const BasicContext* context_;
+
+  // Path to the cache file. This has no value if the cache is disabled.
+  std::optional<std::string> file_path_;
+
+  // Thread that constructs this class.
+  const std::thread::id main_thread_id_;
+
+  // Opaque pipeline cache object used by the main thread.
+  VkPipelineCache main_cache_ = VK_NULL_HANDLE;
+
+  // Maps thread IDs to caches used by threads other than the main thread.
+  std::unordered_map<std::thread::id, VkPipelineCache> thread_caches_;
+
+  // Guards 'thread_caches_'.
+  std::mutex mutex_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_PIPELINE_CACHE_H */
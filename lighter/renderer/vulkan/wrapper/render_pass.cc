@@ -300,6 +300,55 @@ void RenderPass::Run(const VkCommandBuffer& command_buffer,
                               "rendering operations are provided",
                               num_subpasses_, render_ops.size()));
 
+  Begin(command_buffer, framebuffer_index, VK_SUBPASS_CONTENTS_INLINE);
+  for (int i = 0; i < render_ops.size(); ++i) {
+    if (i != 0) {
+      vkCmdNextSubpass(command_buffer, VK_SUBPASS_CONTENTS_INLINE);
+    }
+    render_ops[i](command_buffer);
+  }
+  vkCmdEndRenderPass(command_buffer);
+}
+
+void RenderPass::RunWithSecondaryCommands(
+    const VkCommandBuffer& command_buffer, int framebuffer_index,
+    absl::Span<const RecordSubpass> record_subpasses) const {
+  ASSERT_TRUE(record_subpasses.size() == num_subpasses_,
+              absl::StrFormat("Render pass contains %d subpasses, but %d "
+                              "rendering operations are provided",
+                              num_subpasses_, record_subpasses.size()));
+
+  constexpr VkSubpassContents kContents =
+      VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
+  Begin(command_buffer, framebuffer_index, kContents);
+  for (int i = 0; i < record_subpasses.size(); ++i) {
+    if (i != 0) {
+      vkCmdNextSubpass(command_buffer, kContents);
+    }
+    const VkCommandBufferInheritanceInfo inheritance_info{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        /*pNext=*/nullptr,
+        render_pass_,
+        /*subpass=*/static_cast<uint32_t>(i),
+        framebuffers_[framebuffer_index],
+        /*occlusionQueryEnable=*/VK_FALSE,
+        /*queryFlags=*/nullflag,
+        /*pipelineStatistics=*/nullflag,
+    };
+    const auto secondary_command_buffers =
+        record_subpasses[i](inheritance_info);
+    if (!secondary_command_buffers.empty()) {
+      vkCmdExecuteCommands(command_buffer,
+                           CONTAINER_SIZE(secondary_command_buffers),
+                           secondary_command_buffers.data());
+    }
+  }
+  vkCmdEndRenderPass(command_buffer);
+}
+
+void RenderPass::Begin(const VkCommandBuffer& command_buffer,
+                       int framebuffer_index,
+                       VkSubpassContents contents) const {
   const VkRenderPassBeginInfo begin_info{
       VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
       /*pNext=*/nullptr,
@@ -313,14 +362,7 @@ void RenderPass::Run(const VkCommandBuffer& command_buffer,
       clear_values_.data(),
   };
 
-  vkCmdBeginRenderPass(command_buffer, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
-  for (int i = 0; i < render_ops.size(); ++i) {
-    if (i != 0) {
-      vkCmdNextSubpass(command_buffer, VK_SUBPASS_CONTENTS_INLINE);
-    }
-    render_ops[i](command_buffer);
-  }
-  vkCmdEndRenderPass(command_buffer);
+  vkCmdBeginRenderPass(command_buffer, &begin_info, contents);
 }
 
 RenderPass::~RenderPass() {
@@ -227,6 +227,12 @@ class RenderPass {
   // Specifies rendering operations to perform in one subpass.
   using RenderOp = std::function<void(const VkCommandBuffer& command_buffer)>;
 
+  // Records rendering operations of one subpass into secondary command buffers
+  // that inherit 'inheritance_info', and returns them. They will be executed in
+  // the returned order.
+  using RecordSubpass = std::function<std::vector<VkCommandBuffer>(
+      const VkCommandBufferInheritanceInfo& inheritance_info)>;
+
   // This class is neither copyable nor movable.
   RenderPass(const RenderPass&) = delete;
   RenderPass& operator=(const RenderPass&) = delete;
@@ -240,6 +246,14 @@ class RenderPass {
   void Run(const VkCommandBuffer& command_buffer,
            int framebuffer_index, absl::Span<const RenderOp> render_ops) const;
 
+  // Similar to Run(), but operations of each subpass are recorded into
+  // secondary command buffers by the element of 'record_subpasses' with the
+  // same index, and then executed by 'command_buffer'. This allows the user to
+  // record one subpass on multiple threads.
+  void RunWithSecondaryCommands(
+      const VkCommandBuffer& command_buffer, int framebuffer_index,
+      absl::Span<const RecordSubpass> record_subpasses) const;
+
   // Overloads.
   const VkRenderPass& operator*() const { return render_pass_; }
 
@@ -267,6 +281,11 @@ class RenderPass {
         framebuffers_{std::move(framebuffers)},
         num_color_attachments_{std::move(num_color_attachments)} {}
 
+  // Begins this render pass with the framebuffer at 'framebuffer_index', and
+  // declares how commands of the first subpass are provided with 'contents'.
+  void Begin(const VkCommandBuffer& command_buffer, int framebuffer_index,
+             VkSubpassContents contents) const;
+
   // Pointer to context.
   const SharedBasicContext context_;
 
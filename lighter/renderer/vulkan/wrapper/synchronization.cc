@@ -7,6 +7,8 @@
 
 #include "lighter/renderer/vulkan/wrapper/synchronization.h"
 
+#include <limits>
+
 #include "lighter/renderer/vulkan/wrapper/util.h"
 
 namespace lighter {
@@ -21,6 +23,8 @@ constexpr VkSemaphoreCreateInfo kSemaInfo{
     /*flags=*/nullflag,
 };
 
+constexpr auto kTimeoutForever = std::numeric_limits<uint64_t>::max();
+
 // Used to create a fence which is initially signaled.
 constexpr VkFenceCreateInfo kSignaledFenceInfo{
     VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
@@ -69,6 +73,59 @@ Fences::~Fences() {
   }
 }
 
+TimelineSemaphore::TimelineSemaphore(SharedBasicContext context,
+                                     uint64_t initial_value)
+    : context_{std::move(FATAL_IF_NULL(context))} {
+  ASSERT_TRUE(context_->device().timeline_semaphore_enabled(),
+              "Timeline semaphore is not enabled");
+  const VkDevice& device = *context_->device();
+  get_counter_value_func_ =
+      util::LoadDeviceFunction<PFN_vkGetSemaphoreCounterValueKHR>(
+          device, "vkGetSemaphoreCounterValueKHR");
+  wait_semaphores_func_ = util::LoadDeviceFunction<PFN_vkWaitSemaphoresKHR>(
+      device, "vkWaitSemaphoresKHR");
+
+  const VkSemaphoreTypeCreateInfoKHR type_info{
+      VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+      /*pNext=*/nullptr,
+      VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+      initial_value,
+  };
+  const VkSemaphoreCreateInfo sema_info{
+      VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      &type_info,
+      /*flags=*/nullflag,
+  };
+  ASSERT_SUCCESS(vkCreateSemaphore(device, &sema_info, *context_->allocator(),
+                                   &sema_),
+                 "Failed to create timeline semaphore");
+}
+
+TimelineSemaphore::~TimelineSemaphore() {
+  vkDestroySemaphore(*context_->device(), sema_, *context_->allocator());
+}
+
+uint64_t TimelineSemaphore::GetValue() const {
+  uint64_t value;
+  ASSERT_SUCCESS(get_counter_value_func_(*context_->device(), sema_, &value),
+                 "Failed to get timeline semaphore value");
+  return value;
+}
+
+void TimelineSemaphore::Wait(uint64_t value) const {
+  const VkSemaphoreWaitInfoKHR wait_info{
+      VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+      /*semaphoreCount=*/1,
+      &sema_,
+      &value,
+  };
+  ASSERT_SUCCESS(
+      wait_semaphores_func_(*context_->device(), &wait_info, kTimeoutForever),
+      "Failed to wait for timeline semaphore");
+}
+
 } /* namespace vulkan */
 } /* namespace renderer */
 } /* namespace lighter */
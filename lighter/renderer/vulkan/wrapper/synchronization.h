@@ -8,6 +8,7 @@
 #ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_SYNCHRONIZATION_H
 #define LIGHTER_RENDERER_VULKAN_WRAPPER_SYNCHRONIZATION_H
 
+#include <cstdint>
 #include <vector>
 
 #include "lighter/renderer/vulkan/wrapper/basic_context.h"
@@ -62,6 +63,42 @@ class Fences {
   std::vector<VkFence> fences_;
 };
 
+// Synchronization between the host and device, or within the device, with a
+// counter that only increases. The device signals a value on submission, and
+// the host can wait for the counter to reach a value, hence one timeline
+// semaphore can replace a set of fences. This requires the device to enable
+// VK_KHR_timeline_semaphore. See Device::timeline_semaphore_enabled().
+class TimelineSemaphore {
+ public:
+  TimelineSemaphore(SharedBasicContext context, uint64_t initial_value);
+
+  // This class is neither copyable nor movable.
+  TimelineSemaphore(const TimelineSemaphore&) = delete;
+  TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+
+  ~TimelineSemaphore();
+
+  // Returns the current counter value without blocking.
+  uint64_t GetValue() const;
+
+  // Blocks host until the counter value is greater than or equal to 'value'.
+  void Wait(uint64_t value) const;
+
+  // Overloads.
+  const VkSemaphore& operator*() const { return sema_; }
+
+ private:
+  // Pointer to context.
+  const SharedBasicContext context_;
+
+  // Functions provided by VK_KHR_timeline_semaphore.
+  PFN_vkGetSemaphoreCounterValueKHR get_counter_value_func_;
+  PFN_vkWaitSemaphoresKHR wait_semaphores_func_;
+
+  // Opaque semaphore object.
+  VkSemaphore sema_;
+};
+
 } /* namespace vulkan */
 } /* namespace renderer */
 } /* namespace lighter */
@@ -0,0 +1,342 @@
+//
+//  uploader.cc
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "lighter/renderer/vulkan/wrapper/uploader.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "lighter/renderer/vulkan/wrapper/basic_context.h"
+#include "lighter/renderer/vulkan/wrapper/util.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+namespace {
+
+constexpr auto kTimeoutForever = std::numeric_limits<uint64_t>::max();
+
+// Staging ranges are aligned to this, which satisfies the texel size of all
+// uncompressed formats.
+constexpr VkDeviceSize kMinAlignment = 16;
+
+// Rounds 'value' up to a multiple of 'alignment', which is a power of two.
+inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Creates a buffer of 'size' that can be used as transfer source, and binds
+// host visible memory to it.
+VkBuffer CreateStagingBuffer(const BasicContext& context, VkDeviceSize size,
+                             DeviceMemoryAllocation* device_memory) {
+  const auto queue_usage = context.queues().GetTransferQueueUsage();
+  const VkBufferCreateInfo buffer_info{
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      /*pNext=*/nullptr,
+      /*flags=*/nullflag,
+      size,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      queue_usage.sharing_mode(),
+      queue_usage.unique_family_indices_count(),
+      queue_usage.unique_family_indices(),
+  };
+
+  VkBuffer buffer;
+  ASSERT_SUCCESS(vkCreateBuffer(*context.device(), &buffer_info,
+                                *context.allocator(), &buffer),
+                 "Failed to create staging buffer");
+
+  VkMemoryRequirements memory_requirements;
+  vkGetBufferMemoryRequirements(*context.device(), buffer,
+                                &memory_requirements);
+  *device_memory = context.device_memory_allocator().Allocate(
+      memory_requirements, kHostVisibleMemory,
+      DeviceMemoryAllocator::ResourceType::kBuffer);
+  vkBindBufferMemory(*context.device(), buffer, device_memory->memory,
+                     device_memory->offset);
+  return buffer;
+}
+
+} /* namespace */
+
+StagingUploader::StagingUploader(const BasicContext* context,
+                                 VkDeviceSize ring_size)
+    : context_{FATAL_IF_NULL(context)},
+      alignment_{std::max(
+          kMinAlignment,
+          context_->physical_device_limits().optimalBufferCopyOffsetAlignment)},
+      ring_size_{ring_size} {
+  ring_buffer_ = CreateStagingBuffer(*context_, ring_size_, &ring_memory_);
+
+  const VkCommandPoolCreateInfo pool_info{
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      /*pNext=*/nullptr,
+      VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+      context_->queues().transfer_queue().family_index,
+  };
+  ASSERT_SUCCESS(vkCreateCommandPool(*context_->device(), &pool_info,
+                                     *context_->allocator(), &command_pool_),
+                 "Failed to create command pool");
+}
+
+StagingUploader::~StagingUploader() {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  while (!submitted_batches_.empty()) {
+    RetireOldestBatch();
+  }
+  if (current_batch_.has_value()) {
+    free_batches_.push_back(std::move(current_batch_.value()));
+  }
+
+  const VkDevice& device = *context_->device();
+  for (const auto& batch : free_batches_) {
+    for (const auto& dedicated_buffer : batch.dedicated_buffers) {
+      vkDestroyBuffer(device, dedicated_buffer.buffer, *context_->allocator());
+      context_->device_memory_allocator().Free(dedicated_buffer.device_memory);
+    }
+    vkDestroyFence(device, batch.fence, *context_->allocator());
+  }
+  // Command buffers are implicitly freed with the pool.
+  vkDestroyCommandPool(device, command_pool_, *context_->allocator());
+  vkDestroyBuffer(device, ring_buffer_, *context_->allocator());
+  context_->device_memory_allocator().Free(ring_memory_);
+}
+
+void StagingUploader::Upload(VkDeviceSize size, const OnWrite& on_write,
+                             const OnRecord& on_record) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  if (size > ring_size_) {
+    DedicatedBuffer dedicated_buffer = CreateDedicatedBuffer(size);
+    on_write(dedicated_buffer.device_memory.mapped_data);
+    Batch& batch = GetCurrentBatch();
+    on_record(batch.command_buffer, dedicated_buffer.buffer,
+              /*staging_offset=*/0);
+    batch.dedicated_buffers.push_back(std::move(dedicated_buffer));
+    return;
+  }
+
+  // Make room by submitting the current batch and retiring earlier ones.
+  std::optional<VkDeviceSize> offset = AllocateFromRing(size);
+  while (!offset.has_value()) {
+    if (current_batch_.has_value() && current_batch_->uses_ring) {
+      SubmitCurrentBatch(/*signal_semaphores=*/{});
+    }
+    ASSERT_NON_EMPTY(submitted_batches_, "Failed to allocate staging memory");
+    RetireOldestBatch();
+    offset = AllocateFromRing(size);
+  }
+
+  on_write(static_cast<char*>(ring_memory_.mapped_data) + offset.value());
+  Batch& batch = GetCurrentBatch();
+  on_record(batch.command_buffer, ring_buffer_, offset.value());
+  batch.ring_end = ring_head_;
+  batch.uses_ring = true;
+}
+
+void StagingUploader::Record(
+    const std::function<void(const VkCommandBuffer&)>& on_record) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  on_record(GetCurrentBatch().command_buffer);
+}
+
+std::optional<StagingUploader::Ticket> StagingUploader::Submit(
+    absl::Span<const VkSemaphore> signal_semaphores) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  if (!current_batch_.has_value()) {
+    if (signal_semaphores.empty()) {
+      return last_ticket_ == 0 ? std::nullopt
+                               : std::optional<Ticket>{last_ticket_};
+    }
+    GetCurrentBatch();
+  }
+  return SubmitCurrentBatch(signal_semaphores);
+}
+
+bool StagingUploader::IsComplete(Ticket ticket) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  ASSERT_TRUE(ticket <= last_ticket_,
+              absl::StrFormat("Batch %d has not been submitted", ticket));
+  for (const auto& batch : submitted_batches_) {
+    if (batch.ticket == ticket) {
+      return vkGetFenceStatus(*context_->device(), batch.fence) == VK_SUCCESS;
+    }
+  }
+  return true;
+}
+
+void StagingUploader::Wait(Ticket ticket) {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  ASSERT_TRUE(ticket <= last_ticket_,
+              absl::StrFormat("Batch %d has not been submitted", ticket));
+  while (!submitted_batches_.empty() &&
+         submitted_batches_.front().ticket <= ticket) {
+    RetireOldestBatch();
+  }
+}
+
+void StagingUploader::Flush() {
+  if (const auto ticket = Submit(); ticket.has_value()) {
+    Wait(ticket.value());
+  }
+}
+
+std::optional<VkDeviceSize> StagingUploader::AllocateFromRing(
+    VkDeviceSize size) {
+  if (is_ring_empty_) {
+    ring_head_ = ring_tail_ = 0;
+  }
+
+  VkDeviceSize offset = AlignUp(ring_head_, alignment_);
+  if (is_ring_empty_ || ring_head_ > ring_tail_) {
+    // Wrap around if there is not enough space at the end.
+    if (offset + size > ring_size_) {
+      if (is_ring_empty_ || size > ring_tail_) {
+        return std::nullopt;
+      }
+      offset = 0;
+    }
+  } else if (offset + size > ring_tail_) {
+    return std::nullopt;
+  }
+
+  ring_head_ = offset + size;
+  is_ring_empty_ = false;
+  return offset;
+}
+
+StagingUploader::Batch& StagingUploader::GetCurrentBatch() {
+  if (current_batch_.has_value()) {
+    return current_batch_.value();
+  }
+
+  if (!free_batches_.empty()) {
+    current_batch_ = std::move(free_batches_.back());
+    free_batches_.pop_back();
+  } else {
+    current_batch_.emplace();
+    const VkCommandBufferAllocateInfo buffer_info{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        /*pNext=*/nullptr,
+        command_pool_,
+        VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        /*commandBufferCount=*/1,
+    };
+    ASSERT_SUCCESS(
+        vkAllocateCommandBuffers(*context_->device(), &buffer_info,
+                                 &current_batch_->command_buffer),
+        "Failed to allocate command buffer");
+
+    const VkFenceCreateInfo fence_info{
+        VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        /*pNext=*/nullptr,
+        /*flags=*/nullflag,
+    };
+    ASSERT_SUCCESS(vkCreateFence(*context_->device(), &fence_info,
+                                 *context_->allocator(),
+                                 &current_batch_->fence),
+                   "Failed to create fence");
+  }
+
+  const VkCommandBufferBeginInfo begin_info{
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      /*pNext=*/nullptr,
+      VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      /*pInheritanceInfo=*/nullptr,
+  };
+  ASSERT_SUCCESS(
+      vkBeginCommandBuffer(current_batch_->command_buffer, &begin_info),
+      "Failed to begin recording command buffer");
+  return current_batch_.value();
+}
+
+StagingUploader::Ticket StagingUploader::SubmitCurrentBatch(
+    absl::Span<const VkSemaphore> signal_semaphores) {
+  Batch batch = std::move(current_batch_.value());
+  current_batch_.reset();
+
+  // Make transfer writes visible to all commands submitted later.
+  const VkMemoryBarrier barrier{
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      /*pNext=*/nullptr,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_MEMORY_READ_BIT,
+  };
+  vkCmdPipelineBarrier(batch.command_buffer,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                       /*dependencyFlags=*/0,
+                       /*memoryBarrierCount=*/1, &barrier,
+                       /*bufferMemoryBarrierCount=*/0,
+                       /*pBufferMemoryBarriers=*/nullptr,
+                       /*imageMemoryBarrierCount=*/0,
+                       /*pImageMemoryBarriers=*/nullptr);
+  ASSERT_SUCCESS(vkEndCommandBuffer(batch.command_buffer),
+                 "Failed to end recording command buffer");
+
+  const VkSubmitInfo submit_info{
+      VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      /*pNext=*/nullptr,
+      /*waitSemaphoreCount=*/0,
+      /*pWaitSemaphores=*/nullptr,
+      /*pWaitDstStageMask=*/nullptr,
+      /*commandBufferCount=*/1,
+      &batch.command_buffer,
+      CONTAINER_SIZE(signal_semaphores),
+      signal_semaphores.data(),
+  };
+  ASSERT_SUCCESS(
+      context_->queues().transfer_queue().Submit(submit_info, batch.fence),
+      "Failed to submit uploads");
+
+  batch.ticket = ++last_ticket_;
+  submitted_batches_.push_back(std::move(batch));
+  return last_ticket_;
+}
+
+void StagingUploader::RetireOldestBatch() {
+  Batch batch = std::move(submitted_batches_.front());
+  submitted_batches_.pop_front();
+
+  const VkDevice& device = *context_->device();
+  vkWaitForFences(device, /*fenceCount=*/1, &batch.fence, /*waitAll=*/VK_TRUE,
+                  kTimeoutForever);
+  vkResetFences(device, /*fenceCount=*/1, &batch.fence);
+  vkResetCommandBuffer(batch.command_buffer, /*flags=*/0);
+
+  if (batch.uses_ring) {
+    ring_tail_ = batch.ring_end;
+  }
+  const bool is_ring_used_by_others =
+      (current_batch_.has_value() && current_batch_->uses_ring) ||
+      std::any_of(submitted_batches_.begin(), submitted_batches_.end(),
+                  [](const Batch& other) { return other.uses_ring; });
+  if (!is_ring_used_by_others) {
+    is_ring_empty_ = true;
+  }
+
+  for (const auto& dedicated_buffer : batch.dedicated_buffers) {
+    vkDestroyBuffer(device, dedicated_buffer.buffer, *context_->allocator());
+    context_->device_memory_allocator().Free(dedicated_buffer.device_memory);
+  }
+  batch.dedicated_buffers.clear();
+  batch.ring_end = 0;
+  batch.uses_ring = false;
+  free_batches_.push_back(std::move(batch));
+}
+
+StagingUploader::DedicatedBuffer StagingUploader::CreateDedicatedBuffer(
+    VkDeviceSize size) const {
+  DedicatedBuffer dedicated_buffer;
+  dedicated_buffer.buffer = CreateStagingBuffer(
+      *context_, size, &dedicated_buffer.device_memory);
+  return dedicated_buffer;
+}
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
@@ -0,0 +1,180 @@
+//
+//  uploader.h
+//
+//  Created by agent on 10/16/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef LIGHTER_RENDERER_VULKAN_WRAPPER_UPLOADER_H
+#define LIGHTER_RENDERER_VULKAN_WRAPPER_UPLOADER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "lighter/renderer/vulkan/wrapper/device_memory.h"
+#include "third_party/absl/types/span.h"
+#include "third_party/vulkan/vulkan.h"
+
+namespace lighter {
+namespace renderer {
+namespace vulkan {
+
+// Forward declarations.
+class BasicContext;
+
+// This class transfers data from the host to device local buffers and images.
+// Data is first written to a persistently mapped staging ring buffer, and
+// transfer commands are recorded into a batch, so that many uploads share one
+// command buffer and one submission to the transfer queue. Each submitted batch
+// is tracked by a fence, and the range of the ring it used is reused once the
+// fence is signaled. Uploads larger than the ring use a temporary staging
+// buffer that is destroyed in the same manner.
+//
+// Since the transfer queue is the graphics queue in this renderer, each batch
+// ends with a memory barrier, which makes uploaded data visible to commands
+// submitted to the queue later. Hence, the user only needs to make sure the
+// batch is submitted before the commands that consume the data, which is done
+// by OneTimeCommand and PerFrameCommand automatically. If the host needs to
+// know when uploads finish, it can wait on the ticket returned by Submit(), and
+// the batch can also signal semaphores for other queues.
+// This class is thread-safe. Batches are submitted with
+// Queues::Queue::Submit(), which serializes them with other submissions to the
+// same queue.
+class StagingUploader {
+ public:
+  // Identifies a submitted batch. Tickets are increasing in submission order.
+  using Ticket = uint64_t;
+
+  // Writes data to 'dst', which is a host pointer to the staging memory.
+  using OnWrite = std::function<void(void* dst)>;
+
+  // Records transfer commands into 'command_buffer', which copy data from
+  // 'staging_buffer' starting at 'staging_offset'.
+  using OnRecord = std::function<void(const VkCommandBuffer& command_buffer,
+                                      const VkBuffer& staging_buffer,
+                                      VkDeviceSize staging_offset)>;
+
+  // Default size of the staging ring.
+  static constexpr VkDeviceSize kDefaultRingSize = VkDeviceSize{32} << 20;
+
+  explicit StagingUploader(const BasicContext* context,
+                           VkDeviceSize ring_size = kDefaultRingSize);
+
+  // This class is neither copyable nor movable.
+  StagingUploader(const StagingUploader&) = delete;
+  StagingUploader& operator=(const StagingUploader&) = delete;
+
+  // Waits for all submitted batches to finish. Recorded uploads that have not
+  // been submitted are discarded.
+  ~StagingUploader();
+
+  // Reserves 'size' bytes of staging memory, calls 'on_write' to fill it, and
+  // then calls 'on_record' to record commands that consume it into the current
+  // batch. If the ring does not have enough space, the current batch may be
+  // submitted, and this may wait for earlier batches to finish.
+  void Upload(VkDeviceSize size, const OnWrite& on_write,
+              const OnRecord& on_record);
+
+  // Records commands that do not read staging memory into the current batch,
+  // such as layout transitions.
+  void Record(const std::function<void(const VkCommandBuffer&)>& on_record);
+
+  // Submits the current batch to the transfer queue, and signals
+  // 'signal_semaphores' once it finishes. If nothing has been recorded and no
+  // semaphore needs to be signaled, returns the ticket of the last submitted
+  // batch, which may be std::nullopt if nothing was ever submitted.
+  std::optional<Ticket> Submit(
+      absl::Span<const VkSemaphore> signal_semaphores = {});
+
+  // Returns true if the batch with 'ticket' has finished.
+  bool IsComplete(Ticket ticket);
+
+  // Blocks until the batch with 'ticket' finishes.
+  void Wait(Ticket ticket);
+
+  // Submits the current batch and waits for all batches to finish.
+  void Flush();
+
+ private:
+  // Staging buffer created for one upload that does not fit in the ring.
+  struct DedicatedBuffer {
+    VkBuffer buffer;
+    DeviceMemoryAllocation device_memory;
+  };
+
+  // A command buffer and the resources used by it.
+  struct Batch {
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    Ticket ticket = 0;
+
+    // Offset in the ring right after the last range used by this batch.
+    VkDeviceSize ring_end = 0;
+    bool uses_ring = false;
+
+    std::vector<DedicatedBuffer> dedicated_buffers;
+  };
+
+  // Returns the offset of 'size' bytes in the ring, or std::nullopt if there is
+  // not enough space.
+  std::optional<VkDeviceSize> AllocateFromRing(VkDeviceSize size);
+
+  // Returns the current batch, starting to record a new one if necessary.
+  Batch& GetCurrentBatch();
+
+  // Submits the current batch. Expects 'current_batch_' to have value.
+  Ticket SubmitCurrentBatch(absl::Span<const VkSemaphore> signal_semaphores);
+
+  // Waits for the oldest submitted batch to finish, and releases resources
+  // used by it. Expects 'submitted_batches_' to be non-empty.
+  void RetireOldestBatch();
+
+  // Returns a new staging buffer of 'size' bytes.
+  DedicatedBuffer CreateDedicatedBuffer(VkDeviceSize size) const;
+
+  // Pointer to context.
+  const BasicContext* context_;
+
+  // Alignment of ranges in the ring.
+  const VkDeviceSize alignment_;
+
+  // Staging ring.
+  const VkDeviceSize ring_size_;
+  VkBuffer ring_buffer_;
+  DeviceMemoryAllocation ring_memory_;
+
+  // Ranges of the ring that are in use start from 'ring_tail_' and end before
+  // 'ring_head_', possibly wrapping around. If they are equal, the ring is
+  // either empty or full, which is distinguished by 'is_ring_empty_'.
+  VkDeviceSize ring_head_ = 0;
+  VkDeviceSize ring_tail_ = 0;
+  bool is_ring_empty_ = true;
+
+  // Command buffers are allocated from this pool on the transfer queue.
+  VkCommandPool command_pool_;
+
+  // Batch that is being recorded.
+  std::optional<Batch> current_batch_;
+
+  // Batches that have been submitted but not retired, in submission order.
+  std::deque<Batch> submitted_batches_;
+
+  // Retired batches, whose command buffers and fences can be reused.
+  std::vector<Batch> free_batches_;
+
+  // Ticket of the last submitted batch.
+  Ticket last_ticket_ = 0;
+
+  // Guards all members above.
+  std::mutex mutex_;
+};
+
+} /* namespace vulkan */
+} /* namespace renderer */
+} /* namespace lighter */
+
+#endif /* LIGHTER_RENDERER_VULKAN_WRAPPER_UPLOADER_H */
@@ -28,7 +28,8 @@ layout(binding = 2) uniform sampler2D aurora_paths_sampler;
 // Higher value means greater distance to the closest point on aurora paths.
 layout(binding = 3) uniform sampler2D distance_field_sampler;
 // Y coordinate corresponds to the cosine value of angle between camera up
-// vector and the direction of view ray.
+// vector and the direction of view ray. X coordinate corresponds to the height
+// of camera from 0km (ground) to 75km (top of atmosphere).
 layout(binding = 4) uniform sampler2D air_transmit_sampler;
 layout(binding = 5) uniform samplerCube universe_skybox_sampler;
 
@@ -37,6 +38,7 @@ const float earth_radius = 6378.1;
 const float km = 1.0 / earth_radius;
 const float aurora_min_height = 85.0 * km;
 const float aurora_max_height = 300.0 * km;
+const float air_max_height = 75.0 * km;
 // Sampling rate for aurora. Fine sampling takes longer time.
 const float min_dt = 2.0 * km;
 // Scaling factor for sampled aurora color.
@@ -132,8 +134,10 @@ void main() {
       SampleAurora(ray, SpanT(aurora_min_t, aurora_max_t));
 
   // We need to take atmosphere (i.e. thinkness of air) into consideration.
-  const float air_transmit = texture(air_transmit_sampler,
-                                     vec2(0.5, abs(cos_angle))).r;
+  const float camera_height = length(vec3(render_info.camera_pos)) - 1.0;
+  const float air_transmit = texture(
+      air_transmit_sampler,
+      vec2(camera_height / air_max_height, abs(cos_angle))).r;
   const vec3 foreground = air_transmit * aurora_color +
                           (1.0 - air_transmit) * air_color;
   const vec3 background = texture(universe_skybox_sampler, normalized_dir).rgb;
@@ -10,8 +10,10 @@
 #include <algorithm>
 #include <exception>
 #include <optional>
+#include <system_error>
 #include <vector>
 
+#include "third_party/absl/strings/numbers.h"
 #include "third_party/absl/strings/str_format.h"
 #include "third_party/absl/strings/str_split.h"
 
@@ -23,11 +25,46 @@ using common::api::GraphicsApi;
 
 constexpr char kRecordFileName[] = ".compilation_record";
 
+// Should be bumped whenever the format of record file changes.
+constexpr char kRecordFormatVersion[] = "v3";
+
+// Returns the expected header of record file.
+std::string GetRecordFileHeader(OptimizationLevel opt_level,
+                                std::string_view compiler_version) {
+  return absl::StrFormat("%s %s %s", kRecordFormatVersion,
+                         util::OptLevelToText(opt_level), compiler_version);
+}
+
 }  // namespace
 
+std::optional<CompilationRecordHandler::FileStamp>
+CompilationRecordHandler::FileStamp::Create(const stdfs::path& path) {
+  std::error_code error_code;
+  const uintmax_t size = stdfs::file_size(path, error_code);
+  if (error_code) {
+    return std::nullopt;
+  }
+  const stdfs::file_time_type time = stdfs::last_write_time(path, error_code);
+  if (error_code) {
+    return std::nullopt;
+  }
+  return FileStamp{path, size, static_cast<int64_t>(
+                                   time.time_since_epoch().count())};
+}
+
+bool CompilationRecordHandler::Record::IsUpToDate() const {
+  return std::all_of(
+      file_stamps.begin(), file_stamps.end(),
+      [](const FileStamp& stamp) {
+        const std::optional<FileStamp> current = FileStamp::Create(stamp.path);
+        return current.has_value() && current.value() == stamp;
+      });
+}
+
 std::pair<CompilationRecordReader, CompilationRecordWriter>
 CompilationRecordHandler::CreateHandlers(
-    const std::filesystem::path& shader_dir, OptimizationLevel opt_level) {
+    const std::filesystem::path& shader_dir, OptimizationLevel opt_level,
+    std::string_view compiler_version) {
   stdfs::path record_file_path = shader_dir / kRecordFileName;
   if (stdfs::exists(record_file_path) &&
       !stdfs::is_regular_file(record_file_path)) {
@@ -35,8 +72,10 @@ CompilationRecordHandler::CreateHandlers(
                           stdfs::absolute(record_file_path).string()));
   }
 
-  CompilationRecordReader reader{record_file_path, opt_level};
-  CompilationRecordWriter writer{std::move(record_file_path), opt_level};
+  CompilationRecordReader reader{record_file_path, opt_level,
+                                 compiler_version};
+  CompilationRecordWriter writer{std::move(record_file_path), opt_level,
+                                 compiler_version};
   return {std::move(reader), std::move(writer)};
 }
 
@@ -64,7 +103,8 @@ int CompilationRecordHandler::ApiToIndex(GraphicsApi graphics_api) {
 }
 
 CompilationRecordReader::CompilationRecordReader(
-    const stdfs::path& record_file_path, OptimizationLevel opt_level) {
+    const stdfs::path& record_file_path, OptimizationLevel opt_level,
+    std::string_view compiler_version) {
   if (!stdfs::exists(record_file_path)) {
     LOG_INFO << "No compilation record file found";
     return;
@@ -73,55 +113,62 @@ CompilationRecordReader::CompilationRecordReader(
   ASSERT_TRUE(record_file,
               absl::StrFormat("Failed to open '%s'",
                               record_file_path.string()));
-  ParseRecordFile(record_file, opt_level);
+  ParseRecordFile(record_file,
+                  GetRecordFileHeader(opt_level, compiler_version));
 }
 
-void CompilationRecordReader::ParseRecordFile(std::ifstream& record_file,
-                                              OptimizationLevel opt_level) {
+void CompilationRecordReader::ParseRecordFile(
+    std::ifstream& record_file, const std::string& expected_header) {
   enum RecordSegmentIndex {
     kGraphicsApiIndex = 0,
     kSourceFilePathIndex,
-    kSourceFileHashIndex,
-    kCompiledFileHashIndex,
-    kNumSegments,
+    kCacheKeyIndex,
+    kFirstFileStampIndex,
+  };
+  enum FileStampSegmentIndex {
+    kFilePathIndex = 0,
+    kFileSizeIndex,
+    kFileTimeIndex,
+    kNumFileStampSegments,
   };
 
   std::string line;
-  int line_num = 1;
+  if (!std::getline(record_file, line) || line != expected_header) {
+    LOG_INFO << "Record format, optimization level or compiler version has "
+                "changed, discarding old records";
+    return;
+  }
+
+  int line_num = 2;
   try {
     for (; std::getline(record_file, line); ++line_num) {
-      if (line_num == 1) {
-        const std::optional<OptimizationLevel> opt_level_in_record =
-            util::OptLevelFromText(line);
-        ASSERT_HAS_VALUE(opt_level_in_record,
-                         "Unrecognized optimization level");
-        if (opt_level_in_record.value() != opt_level) {
-          LOG_INFO << "Optimization level has changed, discarding old records";
-          break;
-        } else {
-          continue;
-        }
-      }
-
       std::vector<std::string> segments = absl::StrSplit(line, ' ');
-      ASSERT_TRUE(segments.size() == kNumSegments,
-                  absl::StrFormat("Expected %d segments, get %d",
-                                  kNumSegments, segments.size()));
+      ASSERT_TRUE(segments.size() >= kFirstFileStampIndex &&
+                      (segments.size() - kFirstFileStampIndex) %
+                          kNumFileStampSegments == 0,
+                  absl::StrFormat("Unexpected number of segments: %d",
+                                  segments.size()));
 
       const std::string& api_abbreviation = segments[kGraphicsApiIndex];
       auto& api_specific_map =
-          file_hash_maps_[ApiAbbreviationToIndex(api_abbreviation)];
+          record_maps_[ApiAbbreviationToIndex(api_abbreviation)];
       stdfs::path source_file_path{std::move(segments[kSourceFilePathIndex])};
       ASSERT_FALSE(api_specific_map.contains(source_file_path),
                    "Duplicated entry");
 
-      api_specific_map.insert({
-          std::move(source_file_path),
-          FileHash{
-              std::move(segments[kSourceFileHashIndex]),
-              std::move(segments[kCompiledFileHashIndex]),
-          },
-      });
+      Record record{std::move(segments[kCacheKeyIndex]), /*file_stamps=*/{}};
+      for (int i = kFirstFileStampIndex; i < segments.size();
+           i += kNumFileStampSegments) {
+        FileStamp stamp{std::move(segments[i + kFilePathIndex]),
+                        /*size=*/0, /*modification_time=*/0};
+        ASSERT_TRUE(
+            absl::SimpleAtoi(segments[i + kFileSizeIndex], &stamp.size) &&
+            absl::SimpleAtoi(segments[i + kFileTimeIndex],
+                             &stamp.modification_time),
+            "Invalid file stamp");
+        record.file_stamps.push_back(std::move(stamp));
+      }
+      api_specific_map.insert({std::move(source_file_path), std::move(record)});
     }
   } catch (const std::exception& e) {
     FATAL(absl::StrFormat("Failed to parse line %d: %s\n%s",
@@ -138,24 +185,30 @@ int CompilationRecordReader::ApiAbbreviationToIndex(
   return index.value();
 }
 
-const CompilationRecordHandler::FileHash* CompilationRecordReader::GetFileHash(
+const CompilationRecordHandler::Record* CompilationRecordReader::GetRecord(
     GraphicsApi graphics_api, const stdfs::path& source_file_path) const {
   ASSERT_TRUE(source_file_path.is_relative(),
               "Source file path is assumed to be a relative path");
-  const auto& api_specific_map = file_hash_maps_[ApiToIndex(graphics_api)];
+  const auto& api_specific_map = record_maps_[ApiToIndex(graphics_api)];
   const auto iter = api_specific_map.find(source_file_path);
   return iter != api_specific_map.end() ? &iter->second : nullptr;
 }
 
-void CompilationRecordWriter::RegisterFileHash(GraphicsApi graphics_api,
-                                               stdfs::path&& source_file_path,
-                                               FileHash&& file_hash) {
-  auto& api_specific_map = file_hash_maps_[ApiToIndex(graphics_api)];
+CompilationRecordWriter::CompilationRecordWriter(
+    stdfs::path&& record_file_path, OptimizationLevel opt_level,
+    std::string_view compiler_version)
+    : record_file_path_{std::move(record_file_path)},
+      header_{GetRecordFileHeader(opt_level, compiler_version)} {}
+
+void CompilationRecordWriter::RegisterRecord(GraphicsApi graphics_api,
+                                             stdfs::path&& source_file_path,
+                                             Record&& record) {
+  auto& api_specific_map = record_maps_[ApiToIndex(graphics_api)];
   ASSERT_FALSE(api_specific_map.contains(source_file_path),
                absl::StrFormat("%s: Duplicated entry for '%s'",
                                GetApiAbbreviations()[ApiToIndex(graphics_api)],
                                source_file_path.string()));
-  api_specific_map.insert({std::move(source_file_path), std::move(file_hash)});
+  api_specific_map.insert({std::move(source_file_path), std::move(record)});
 }
 
 void CompilationRecordWriter::WriteAll() const {
@@ -166,17 +219,22 @@ void CompilationRecordWriter::WriteAll() const {
                               record_file_path_.string()));
 
   // Write header.
-  record_file << absl::StreamFormat("%s\n", util::OptLevelToText(opt_level_));
+  record_file << absl::StreamFormat("%s\n", header_);
 
   // Write body.
   for (int api_index = 0; api_index < kNumApis; ++api_index) {
     const std::string& api_abbreviation = GetApiAbbreviations()[api_index];
-    const auto& api_specific_map = file_hash_maps_[api_index];
-    for (const auto& [source_file_path, file_hash] : api_specific_map) {
+    const auto& api_specific_map = record_maps_[api_index];
+    for (const auto& [source_file_path, record] : api_specific_map) {
       record_file << absl::StreamFormat(
-          "%s %s %s %s\n",
-          api_abbreviation, source_file_path.string(),
-          file_hash.source_file_hash, file_hash.compiled_file_hash);
+          "%s %s %s", api_abbreviation, source_file_path.string(),
+          record.cache_key);
+      for (const auto& stamp : record.file_stamps) {
+        record_file << absl::StreamFormat(
+            " %s %d %d", stamp.path.string(), stamp.size,
+            stamp.modification_time);
+      }
+      record_file << "\n";
     }
   }
 }
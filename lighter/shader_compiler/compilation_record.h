@@ -9,11 +9,14 @@
 #define LIGHTER_SHADER_COMPILATION_RECORD_H
 
 #include <array>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "lighter/common/graphics_api.h"
 #include "lighter/common/util.h"
@@ -27,26 +30,51 @@ class CompilationRecordReader;
 class CompilationRecordWriter;
 
 // This is the base class of readers and writers of the compilation record file.
-// Each line in the record file would have such a format:
-// <graphics API> <source file path> <source file hash> <compiled file hash>
+// The first line of the record file is the format version, optimization level
+// and compiler version. Each following line would have such a format:
+// <graphics API> <source file path> <cache key> [<path> <size> <time>]...
+// where the file stamps are of the source file, the compiled file, and then
+// all files included by the source file.
 class CompilationRecordHandler {
  public:
-  // Stores hash values of source and compiled files.
-  struct FileHash {
-    std::string source_file_hash;
-    std::string compiled_file_hash;
+  // Size and last modification time of a file, which are used for detecting
+  // changes without reading the file.
+  struct FileStamp {
+    // Returns the stamp of file at 'path', or std::nullopt if it does not
+    // exist.
+    static std::optional<FileStamp> Create(const std::filesystem::path& path);
+
+    bool operator==(const FileStamp& other) const {
+      return path == other.path && size == other.size &&
+             modification_time == other.modification_time;
+    }
+
+    std::filesystem::path path;
+    uintmax_t size;
+    int64_t modification_time;
+  };
+
+  // Stores the key of compiled file in the compilation cache, and stamps of
+  // files that were used when compiling.
+  struct Record {
+    // Returns true if no file has changed since the record is created.
+    bool IsUpToDate() const;
+
+    std::string cache_key;
+    std::vector<FileStamp> file_stamps;
   };
 
   static std::pair<CompilationRecordReader, CompilationRecordWriter>
   CreateHandlers(const std::filesystem::path& shader_dir,
-                 OptimizationLevel opt_level);
+                 OptimizationLevel opt_level,
+                 std::string_view compiler_version);
 
   virtual ~CompilationRecordHandler() = default;
 
  protected:
-  // Maps the source file path to hash values of source and compiled files.
-  using FileHashValueMap = absl::flat_hash_map<std::filesystem::path, FileHash,
-                                               common::util::PathHash>;
+  // Maps the source file path to the compilation record.
+  using RecordMap = absl::flat_hash_map<std::filesystem::path, Record,
+                                        common::util::PathHash>;
 
   enum ApiIndex {
     kOpenglIndex = 0,
@@ -69,70 +97,73 @@ class CompilationRecordHandler {
 class CompilationRecordReader : public CompilationRecordHandler {
  public:
   CompilationRecordReader(const std::filesystem::path& record_file_path,
-                          OptimizationLevel opt_level);
+                          OptimizationLevel opt_level,
+                          std::string_view compiler_version);
 
   // This class is only movable.
   CompilationRecordReader(CompilationRecordReader&&) noexcept = default;
   CompilationRecordReader& operator=(CompilationRecordReader&&) noexcept
       = default;
 
-  // Returns a pointer to 'FileHash' if it is in the compilation record file.
+  // Returns a pointer to 'Record' if it is in the compilation record file.
   // Otherwise, returns nullptr.
-  const FileHash* GetFileHash(
+  const Record* GetRecord(
       common::api::GraphicsApi graphics_api,
       const std::filesystem::path& source_file_path) const;
 
  private:
-  // Parses the compilation record file and populates 'file_hash_maps_'.
+  // Parses the compilation record file and populates 'record_maps_'. If the
+  // record file is in an old format, or records a different optimization level
+  // or compiler version, all records are discarded.
   void ParseRecordFile(std::ifstream& record_file,
-                       OptimizationLevel opt_level);
+                       const std::string& expected_header);
 
   // Converts a graphics API name abbreviation to the index into
-  // 'file_hash_maps_'.
+  // 'record_maps_'.
   int ApiAbbreviationToIndex(std::string_view abbreviation) const;
 
-  // Maps the source file path to hash values of source and compiled files.
-  FileHashValueMap file_hash_maps_[kNumApis];
+  // Maps the source file path to the compilation record.
+  RecordMap record_maps_[kNumApis];
 };
 
-// This class collects hash values of files before/after compilation, and writes
-// them to the compilation record file.
+// This class collects compilation records, and writes them to the compilation
+// record file.
 class CompilationRecordWriter : public CompilationRecordHandler {
  public:
   CompilationRecordWriter(std::filesystem::path&& record_file_path,
-                          OptimizationLevel opt_level)
-      : record_file_path_{std::move(record_file_path)},
-        opt_level_{opt_level} {}
+                          OptimizationLevel opt_level,
+                          std::string_view compiler_version);
 
   // This class is only movable.
   CompilationRecordWriter(CompilationRecordWriter&&) noexcept = default;
   CompilationRecordWriter& operator=(CompilationRecordWriter&&) noexcept
       = default;
 
-  // Registers file hash values, and throws a runtime exception if this file has
+  // Registers a record, and throws a runtime exception if this file has
   // already been registered with the same graphics API.
-  void RegisterFileHash(common::api::GraphicsApi graphics_api,
-                        std::filesystem::path&& source_file_path,
-                        FileHash&& file_hash);
+  void RegisterRecord(common::api::GraphicsApi graphics_api,
+                      std::filesystem::path&& source_file_path,
+                      Record&& record);
 
-  // Writes all registered file hash values to the compilation record file.
+  // Writes all registered records to the compilation record file.
   static void WriteAll(CompilationRecordWriter&& writer) {
     writer.WriteAll();
   }
 
  private:
-  // Writes all registered file hash values to the compilation record file.
+  // Writes all registered records to the compilation record file.
   // This should only be called once.
   void WriteAll() const;
 
   // Path to compilation record file.
   std::filesystem::path record_file_path_;
 
-  // Optimization level is part of the record file header.
-  OptimizationLevel opt_level_;
+  // Header of the record file, which contains the optimization level and
+  // compiler version.
+  std::string header_;
 
-  // Maps the source file path to hash values of source and compiled files.
-  FileHashValueMap file_hash_maps_[kNumApis];
+  // Maps the source file path to the compilation record.
+  RecordMap record_maps_[kNumApis];
 };
 
 }  // namespace lighter::shader_compiler
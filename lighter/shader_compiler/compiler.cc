@@ -7,6 +7,9 @@
 
 #include "lighter/shader_compiler/compiler.h"
 
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/vulkan/vulkan_core.h"
+
 namespace lighter::shader_compiler {
 namespace {
 
@@ -22,6 +25,16 @@ shaderc_optimization_level GetOptimizationLevelFlag(OptimizationLevel level) {
   }
 }
 
+// Checks the compilation status of 'result', and throws a runtime exception
+// with 'shader_tag' and the error message if failed.
+void AssertSuccess(const std::string& shader_tag,
+                   const CompilationResult& result) {
+  if (const char* error_message = result.GetErrorIfFailed()) {
+    FATAL(absl::StrFormat("Failed to compile %s: %s",
+                          shader_tag, error_message));
+  }
+}
+
 }  // namespace
 
 const Compiler::ShaderKindMap Compiler::shader_kind_map_ = {
@@ -39,6 +52,21 @@ std::optional<shaderc_shader_kind> Compiler::GetShaderKind(
   return std::nullopt;
 }
 
+std::string Compiler::GetVersion() {
+  unsigned int version, revision;
+  shaderc_get_spv_version(&version, &revision);
+
+  // shaderc does not expose the version of itself or glslang. It is linked
+  // from the Vulkan SDK, hence we use the version of headers shipped with the
+  // same SDK, which is a compile-time constant and is not affected by
+  // relinking this executable.
+  return absl::StrFormat("shaderc-spv-%u.%u-vulkan-sdk-%u.%u.%u",
+                         version, revision,
+                         VK_VERSION_MAJOR(VK_HEADER_VERSION_COMPLETE),
+                         VK_VERSION_MINOR(VK_HEADER_VERSION_COMPLETE),
+                         VK_VERSION_PATCH(VK_HEADER_VERSION_COMPLETE));
+}
+
 std::unique_ptr<CompilationResult> Compiler::Compile(
     const std::string& shader_tag,
     shaderc_shader_kind shader_kind,
@@ -50,13 +78,75 @@ std::unique_ptr<CompilationResult> Compiler::Compile(
           shader_tag.data(), shader_compiler::kShaderEntryPoint,
           *compiler_options)
   );
-  if (const char* error_message = result->GetErrorIfFailed()) {
-    FATAL(absl::StrFormat("Failed to compile %s: %s",
-                          shader_tag, error_message));
-  }
+  AssertSuccess(shader_tag, *result);
+  return result;
+}
+
+std::unique_ptr<CompilationResult> Compiler::Preprocess(
+    const std::string& shader_tag,
+    shaderc_shader_kind shader_kind,
+    absl::Span<const char> shader_source,
+    const CompilerOptions& compiler_options) const {
+  auto result = std::make_unique<CompilationResult>(
+      shaderc_compile_into_preprocessed_text(
+          compiler_, shader_source.data(), shader_source.size(), shader_kind,
+          shader_tag.data(), shader_compiler::kShaderEntryPoint,
+          *compiler_options)
+  );
+  AssertSuccess(shader_tag, *result);
   return result;
 }
 
+std::vector<std::filesystem::path> IncludeResolver::GetIncludedPaths() const {
+  std::vector<std::filesystem::path> paths = included_paths_;
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+  return paths;
+}
+
+shaderc_include_result* IncludeResolver::Resolve(
+    void* user_data, const char* requested_source, int type,
+    const char* requesting_source, size_t include_depth) {
+  auto* resolver = static_cast<IncludeResolver*>(user_data);
+  auto* included_file = new IncludedFile{};
+
+  std::vector<std::filesystem::path> candidates;
+  if (type == shaderc_include_type_relative) {
+    candidates.push_back(
+        std::filesystem::path{requesting_source}.parent_path() /
+        requested_source);
+  }
+  candidates.push_back(requested_source);
+  for (const auto& candidate : candidates) {
+    std::optional<std::string> content = ReadFile(candidate);
+    if (content.has_value()) {
+      const std::filesystem::path path = candidate.lexically_normal();
+      resolver->included_paths_.push_back(path);
+      included_file->source_name = path.string();
+      included_file->content = std::move(content).value();
+      break;
+    }
+  }
+  if (included_file->source_name.empty()) {
+    // An empty source name signals an error to shaderc.
+    included_file->content = absl::StrFormat(
+        "Failed to find '%s' included by '%s'",
+        requested_source, requesting_source);
+  }
+
+  included_file->result = shaderc_include_result{
+      included_file->source_name.data(), included_file->source_name.size(),
+      included_file->content.data(), included_file->content.size(),
+      /*user_data=*/included_file,
+  };
+  return &included_file->result;
+}
+
+void IncludeResolver::Release(void* user_data,
+                              shaderc_include_result* result) {
+  delete static_cast<IncludedFile*>(result->user_data);
+}
+
 CompilerOptions& CompilerOptions::SetOptimizationLevel(
     OptimizationLevel level) {
   shaderc_compile_options_set_optimization_level(
@@ -73,6 +163,14 @@ CompilerOptions& CompilerOptions::AddMacroDefinition(
   return *this;
 }
 
+CompilerOptions& CompilerOptions::SetIncludeResolver(
+    IncludeResolver* resolver) {
+  shaderc_compile_options_set_include_callbacks(
+      options_, &IncludeResolver::Resolve, &IncludeResolver::Release,
+      FATAL_IF_NULL(resolver));
+  return *this;
+}
+
 const char* CompilationResult::GetErrorIfFailed() const {
   if (shaderc_result_get_compilation_status(result_) !=
       shaderc_compilation_status_success) {
@@ -8,9 +8,12 @@
 #ifndef LIGHTER_SHADER_COMPILER_H
 #define LIGHTER_SHADER_COMPILER_H
 
+#include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "lighter/common/util.h"
 #include "lighter/shader_compiler/util.h"
@@ -24,7 +27,8 @@ namespace lighter::shader_compiler {
 class CompilationResult;
 class CompilerOptions;
 
-// Wraps shaderc_compiler.
+// Wraps shaderc_compiler. This is thread-safe, but each worker thread is
+// expected to own one instance to avoid contention inside shaderc.
 class Compiler {
  public:
   explicit Compiler()
@@ -41,14 +45,27 @@ class Compiler {
   static std::optional<shaderc_shader_kind> GetShaderKind(
       std::string_view file_extension);
 
-  // Compiles a shader. 'shader_tag' is only used for cases like emitting error
-  // messages, and it does not need to be a unique identifier.
+  // Returns a string that identifies the version of shaderc and SPIR-V. Since
+  // shaderc does not report its own version, this includes the version of the
+  // Vulkan SDK that provides shaderc. This is cheap to call.
+  static std::string GetVersion();
+
+  // Compiles a shader. 'shader_tag' is used for emitting error messages, and
+  // resolving relative #include directives.
   std::unique_ptr<CompilationResult> Compile(
       const std::string& shader_tag,
       shaderc_shader_kind shader_kind,
       absl::Span<const char> shader_source,
       const CompilerOptions& compiler_options) const;
 
+  // Same as Compile(), except that only the preprocessor is run, and the result
+  // contains preprocessed text.
+  std::unique_ptr<CompilationResult> Preprocess(
+      const std::string& shader_tag,
+      shaderc_shader_kind shader_kind,
+      absl::Span<const char> shader_source,
+      const CompilerOptions& compiler_options) const;
+
  private:
   // Maps file extensions to shader kinds.
   using ShaderKindMap = absl::flat_hash_map<std::string, shaderc_shader_kind>;
@@ -58,6 +75,44 @@ class Compiler {
   shaderc_compiler_t compiler_;
 };
 
+// Resolves #include directives. Files included with quotes are looked up
+// relative to the including file first, and then relative to the current
+// working directory, while files included with angle brackets are only looked
+// up in the latter. Paths to all included files are recorded. Since the
+// recorded paths are updated during compilation, one instance should only be
+// used by one compilation at a time.
+class IncludeResolver {
+ public:
+  IncludeResolver() = default;
+
+  // This class is neither copyable nor movable.
+  IncludeResolver(const IncludeResolver&) = delete;
+  IncludeResolver& operator=(const IncludeResolver&) = delete;
+
+  // Returns paths to all included files, which are sorted and deduplicated.
+  std::vector<std::filesystem::path> GetIncludedPaths() const;
+
+ private:
+  friend class CompilerOptions;
+
+  // Holds the content of an included file, or an error message if failed to
+  // resolve it.
+  struct IncludedFile {
+    std::string source_name;
+    std::string content;
+    shaderc_include_result result;
+  };
+
+  // Callbacks to be registered with shaderc.
+  static shaderc_include_result* Resolve(
+      void* user_data, const char* requested_source, int type,
+      const char* requesting_source, size_t include_depth);
+  static void Release(void* user_data, shaderc_include_result* result);
+
+  // Paths to included files, which may contain duplicates.
+  std::vector<std::filesystem::path> included_paths_;
+};
+
 // Wraps shaderc_compile_options.
 class CompilerOptions {
  public:
@@ -80,6 +135,10 @@ class CompilerOptions {
       const std::string& key,
       const std::optional<std::string>& value = std::nullopt);
 
+  // Resolves #include directives with 'resolver', which must outlive all
+  // compilations using these options.
+  CompilerOptions& SetIncludeResolver(IncludeResolver* resolver);
+
   // Overloads.
   const shaderc_compile_options_t& operator*() const { return options_; }
 
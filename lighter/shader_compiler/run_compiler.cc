@@ -8,19 +8,22 @@
 #include "lighter/shader_compiler/run_compiler.h"
 
 #include <array>
-#include <fstream>
+#include <exception>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "lighter/common/data.h"
 #include "lighter/common/file.h"
 #include "lighter/common/graphics_api.h"
+#include "lighter/common/thread_pool.h"
 #include "lighter/common/timer.h"
 #include "lighter/common/util.h"
 #include "lighter/shader_compiler/compilation_record.h"
 #include "lighter/shader_compiler/compiler.h"
+#include "third_party/absl/strings/str_cat.h"
 #include "third_party/absl/strings/str_format.h"
 #include "third_party/absl/types/span.h"
 #include "third_party/picosha2/picosha2.h"
@@ -31,7 +34,14 @@ namespace {
 namespace stdfs = std::filesystem;
 
 using common::api::GraphicsApi;
-using FileHash = CompilationRecordHandler::FileHash;
+using FileStamp = CompilationRecordHandler::FileStamp;
+using Record = CompilationRecordHandler::Record;
+
+// Compiled shaders are stored in this directory, and named after cache keys.
+constexpr char kCacheDirName[] = ".shader_cache";
+
+// Should be bumped whenever the way of computing cache keys changes.
+constexpr char kCacheKeyVersion[] = "1";
 
 // Returns the API specific macro that is used for shader compilation.
 const char* GetTargetMacro(GraphicsApi graphics_api) {
@@ -43,22 +53,41 @@ const char* GetTargetMacro(GraphicsApi graphics_api) {
   }
 }
 
-// Returns the SHA256 of the file at 'path'.
-std::string ComputeFileSha256(const stdfs::path& path) {
-  std::ifstream file{path, std::ios::in | std::ios::binary};
-  ASSERT_TRUE(file, absl::StrFormat("Failed to open file '%s'",
-                                    stdfs::absolute(path).string()));
-  static auto* buffer = new std::array<unsigned char, picosha2::k_digest_size>;
-  picosha2::hash256(file, buffer->begin(), buffer->end());
-  return picosha2::bytes_to_hex_string(*buffer);
+// Returns the compiler owned by the calling thread.
+const Compiler& GetThreadLocalCompiler() {
+  thread_local const auto compiler = std::make_unique<Compiler>();
+  return *compiler;
 }
 
-// Returns the SHA256 of 'data'.
-std::string ComputeDataSha256(absl::Span<const char> data) {
-  return picosha2::hash256_hex_string(data);
+// Returns the stamp of file at 'path', which must exist.
+FileStamp GetFileStamp(const stdfs::path& path) {
+  std::optional<FileStamp> stamp = FileStamp::Create(path);
+  ASSERT_HAS_VALUE(stamp, absl::StrFormat("Failed to stat file '%s'",
+                                          stdfs::absolute(path).string()));
+  return std::move(stamp).value();
 }
 
+// Writes 'data' to the file at 'path' atomically, since other threads or
+// processes may compile the same shader concurrently.
+void WriteFile(const stdfs::path& path, absl::Span<const char> data) {
+  ASSERT_TRUE(common::file::WriteFileAtomically(path, data),
+              absl::StrFormat("Failed to write file '%s'", path.string()));
+}
+
+// A shader file to compile.
+struct ShaderFile {
+  stdfs::path path;
+  shaderc_shader_kind shader_kind;
+};
+
 // Helper class to config compiler options and invoke the compiler.
+// Shaders are compiled in parallel, where each worker thread owns a compiler.
+// Compiled shaders are stored in a content-addressed cache, keyed by the
+// preprocessed source code, which covers all included files, and compiler
+// settings. A shader is not compiled again if its cache key is found in the
+// cache. If none of the source file, included files and the compiled file has
+// changed since the last run, and the compiler version is the same, the shader
+// is skipped without even reading them.
 class CompilerRunner {
  public:
   CompilerRunner(std::filesystem::path&& shader_dir,
@@ -74,15 +103,18 @@ class CompilerRunner {
  private:
   static constexpr int kNumApis = common::api::kNumSupportedApis;
 
-  // Returns the reason why the file needs to be compiled, or std::nullopt if
-  // not needed.
-  std::optional<std::string> NeedsCompilation(
-      int api_index, const stdfs::path& source_path) const;
+  // Returns the compilation record of 'shader_file'. The shader will not be
+  // compiled if the existing record is up to date, or the compiled file can be
+  // found in the cache. This is thread-safe.
+  Record CompileIfNeeded(int api_index, const ShaderFile& shader_file) const;
+
+  // Returns compiler options for the graphics API at 'api_index'.
+  std::unique_ptr<CompilerOptions> CreateOptions(
+      int api_index, IncludeResolver* include_resolver) const;
 
-  // Returns file hash values. The shader will not be compiled if the hash
-  // values of existing files match the existing compilation record.
-  FileHash CompileIfNeeded(int api_index, const stdfs::path& source_path,
-                           shaderc_shader_kind shader_kind) const;
+  // Returns the cache key of a shader, given its preprocessed source code.
+  std::string ComputeCacheKey(int api_index, shaderc_shader_kind shader_kind,
+                              absl::Span<const char> preprocessed_source) const;
 
   // Accessors.
   const CompilationRecordReader& record_reader() const {
@@ -91,29 +123,27 @@ class CompilerRunner {
   CompilationRecordWriter& record_writer() { return record_handlers_.second; }
 
   const std::filesystem::path shader_dir_;
+  const OptimizationLevel opt_level_;
+  const std::string compiler_version_;
   std::pair<CompilationRecordReader, CompilationRecordWriter> record_handlers_;
   const std::array<GraphicsApi, kNumApis> all_apis_;
-  const Compiler compiler_;
-  std::array<std::unique_ptr<CompilerOptions>, kNumApis> options_array_;
 };
 
 CompilerRunner::CompilerRunner(std::filesystem::path&& shader_dir,
                                OptimizationLevel opt_level)
     : shader_dir_{std::move(shader_dir)},
+      opt_level_{opt_level},
+      compiler_version_{Compiler::GetVersion()},
       record_handlers_{
-          CompilationRecordHandler::CreateHandlers(shader_dir_, opt_level)},
-      all_apis_{common::api::GetAllApis()} {
-  for (int api_index = 0; api_index < all_apis_.size(); ++api_index) {
-    auto options = std::make_unique<CompilerOptions>();
-    (*options)
-        .SetOptimizationLevel(opt_level)
-        .AddMacroDefinition(GetTargetMacro(all_apis_[api_index]));
-    options_array_[api_index] = std::move(options);
-  }
-}
+          CompilationRecordHandler::CreateHandlers(shader_dir_, opt_level,
+                                                   compiler_version_)},
+      all_apis_{common::api::GetAllApis()} {}
 
 void CompilerRunner::Run() {
   stdfs::current_path(shader_dir_);
+  stdfs::create_directories(kCacheDirName);
+
+  std::vector<ShaderFile> shader_files;
   for (const stdfs::directory_entry& entry :
            stdfs::recursive_directory_iterator(".")) {
     const stdfs::path& path = entry.path();
@@ -125,78 +155,114 @@ void CompilerRunner::Run() {
     if (!shader_kind.has_value()) {
       continue;
     }
-    LOG_INFO << absl::StreamFormat("Found shader file '%s'",
-                                   stdfs::absolute(path).string());
-
-    for (int api_index = 0; api_index < all_apis_.size(); ++api_index) {
-      record_writer().RegisterFileHash(
-          all_apis_[api_index], stdfs::path{path},
-          CompileIfNeeded(api_index, path, shader_kind.value()));
-    }
+    shader_files.push_back({path, shader_kind.value()});
   }
-  CompilationRecordWriter::WriteAll(std::move(record_writer()));
-}
-
-std::optional<std::string> CompilerRunner::NeedsCompilation(
-    int api_index, const stdfs::path& source_path) const {
-  const GraphicsApi api = all_apis_[api_index];
-  const stdfs::path compiled_path = util::GetShaderBinaryPath(api, source_path);
-  if (!stdfs::exists(compiled_path)) {
-    return "compiled file does not exist";
+  LOG_INFO << absl::StreamFormat("Found %d shader files", shader_files.size());
+
+  // Each task handles one shader file for one graphics API. Exceptions must
+  // not escape from tasks running on worker threads, hence they are rethrown
+  // on this thread.
+  const int num_tasks = static_cast<int>(shader_files.size()) * kNumApis;
+  std::vector<std::optional<Record>> records(num_tasks);
+  std::vector<std::exception_ptr> exceptions(num_tasks);
+  common::ThreadPool thread_pool;
+  thread_pool.ParallelFor(num_tasks, [&](int task_index) {
+    try {
+      records[task_index] = CompileIfNeeded(
+          task_index % kNumApis, shader_files[task_index / kNumApis]);
+    } catch (...) {
+      exceptions[task_index] = std::current_exception();
+    }
+  });
+  for (const auto& exception : exceptions) {
+    if (exception != nullptr) {
+      std::rethrow_exception(exception);
+    }
   }
 
-  const FileHash* file_hash = record_reader().GetFileHash(api, source_path);
-  if (file_hash == nullptr) {
-    return "no compilation record";
-  }
-  if (ComputeFileSha256(source_path) != file_hash->source_file_hash) {
-    return "source file hash mismatch";
-  }
-  if (ComputeFileSha256(compiled_path) != file_hash->compiled_file_hash) {
-    return "compiled file hash mismatch";
+  for (int task_index = 0; task_index < num_tasks; ++task_index) {
+    record_writer().RegisterRecord(
+        all_apis_[task_index % kNumApis],
+        stdfs::path{shader_files[task_index / kNumApis].path},
+        std::move(records[task_index]).value());
   }
-
-  return std::nullopt;
+  CompilationRecordWriter::WriteAll(std::move(record_writer()));
 }
 
-FileHash CompilerRunner::CompileIfNeeded(
-    int api_index, const stdfs::path& source_path,
-    shaderc_shader_kind shader_kind) const {
+Record CompilerRunner::CompileIfNeeded(int api_index,
+                                       const ShaderFile& shader_file) const {
   const GraphicsApi api = all_apis_[api_index];
-  const std::optional<std::string> reason =
-      NeedsCompilation(api_index, source_path);
   const char* api_name = common::api::GetApiFullName(api);
-  if (!reason.has_value()) {
-    LOG_INFO << absl::StreamFormat("\tSkip compilation for %s", api_name);
-    return *record_reader().GetFileHash(api, source_path);
-  } else {
-    LOG_INFO << absl::StreamFormat("\tNeed to compile for %s: %s",
-                                   api_name, reason.value());
+  const stdfs::path& source_path = shader_file.path;
+  if (const Record* record = record_reader().GetRecord(api, source_path);
+      record != nullptr && record->IsUpToDate()) {
+    LOG_INFO << absl::StreamFormat("Skip compiling '%s' for %s",
+                                   source_path.string(), api_name);
+    return *record;
   }
 
-  // Compile shader.
-  const common::Data source_data =
-      common::file::LoadDataFromFile(source_path.string());
+  // Preprocess the shader to find included files and compute the cache key.
+  const common::MappedData source_data{source_path.string()};
   const auto source_data_span = absl::MakeSpan(source_data.data<char>(),
                                                source_data.size());
-  const std::unique_ptr<CompilationResult> result = compiler_.Compile(
-      /*shader_tag=*/source_path.filename().string(), shader_kind,
-      source_data_span, *options_array_[api_index]);
-  const auto result_data_span = result->GetDataSpan();
-
-  // Write shader binary to disk.
+  const std::string shader_tag = source_path.string();
+  const Compiler& compiler = GetThreadLocalCompiler();
+  IncludeResolver include_resolver;
+  const std::unique_ptr<CompilerOptions> options =
+      CreateOptions(api_index, &include_resolver);
+  const std::string cache_key = ComputeCacheKey(
+      api_index, shader_file.shader_kind,
+      compiler.Preprocess(shader_tag, shader_file.shader_kind,
+                          source_data_span, *options)->GetDataSpan());
+
+  const stdfs::path cache_path =
+      stdfs::path{kCacheDirName} / absl::StrCat(cache_key, ".spv");
   const stdfs::path compiled_path = util::GetShaderBinaryPath(api, source_path);
   stdfs::create_directories(compiled_path.parent_path());
-  std::ofstream file{compiled_path,
-                     std::ios::out | std::ios::binary | std::ios::trunc};
-  ASSERT_TRUE(file, absl::StrFormat("Failed to open file '%s'",
-                                    compiled_path.string()));
-  file.write(result_data_span.data(), result_data_span.size());
-
-  return FileHash {
-      ComputeDataSha256(source_data_span),
-      ComputeDataSha256(result_data_span),
-  };
+  if (stdfs::is_regular_file(cache_path)) {
+    LOG_INFO << absl::StreamFormat("Found '%s' for %s in cache",
+                                   source_path.string(), api_name);
+    stdfs::copy_file(cache_path, compiled_path,
+                     stdfs::copy_options::overwrite_existing);
+  } else {
+    LOG_INFO << absl::StreamFormat("Compiling '%s' for %s",
+                                   source_path.string(), api_name);
+    const std::unique_ptr<CompilationResult> result = compiler.Compile(
+        shader_tag, shader_file.shader_kind, source_data_span, *options);
+    WriteFile(cache_path, result->GetDataSpan());
+    WriteFile(compiled_path, result->GetDataSpan());
+  }
+
+  Record record{cache_key,
+                {GetFileStamp(source_path), GetFileStamp(compiled_path)}};
+  for (const auto& included_path : include_resolver.GetIncludedPaths()) {
+    record.file_stamps.push_back(GetFileStamp(included_path));
+  }
+  return record;
+}
+
+std::unique_ptr<CompilerOptions> CompilerRunner::CreateOptions(
+    int api_index, IncludeResolver* include_resolver) const {
+  auto options = std::make_unique<CompilerOptions>();
+  (*options)
+      .SetOptimizationLevel(opt_level_)
+      .AddMacroDefinition(GetTargetMacro(all_apis_[api_index]))
+      .SetIncludeResolver(include_resolver);
+  return options;
+}
+
+std::string CompilerRunner::ComputeCacheKey(
+    int api_index, shaderc_shader_kind shader_kind,
+    absl::Span<const char> preprocessed_source) const {
+  const std::string settings = absl::StrFormat(
+      "%s|%s|%s|%s|%d|", kCacheKeyVersion, compiler_version_,
+      GetTargetMacro(all_apis_[api_index]), util::OptLevelToText(opt_level_),
+      static_cast<int>(shader_kind));
+  picosha2::hash256_one_by_one hasher;
+  hasher.process(settings.begin(), settings.end());
+  hasher.process(preprocessed_source.begin(), preprocessed_source.end());
+  hasher.finish();
+  return picosha2::get_hash_hex_string(hasher);
 }
 
 }  // namespace